@@ -36,6 +36,7 @@ See the @{$datasets$Importing Data} Programmer's Guide for an overview.
 @@make_csv_dataset
 @@make_saveable_from_iterator
 @@map_and_batch
+@@optimize
 @@padded_batch_and_drop_remainder
 @@parallel_interleave
 @@prefetch_to_device
@@ -73,6 +74,7 @@ from tensorflow.contrib.data.python.ops.interleave_ops import parallel_interleav
 from tensorflow.contrib.data.python.ops.interleave_ops import sample_from_datasets
 from tensorflow.contrib.data.python.ops.interleave_ops import sloppy_interleave
 from tensorflow.contrib.data.python.ops.iterator_ops import make_saveable_from_iterator
+from tensorflow.contrib.data.python.ops.optimization import optimize
 from tensorflow.contrib.data.python.ops.prefetching_ops import prefetch_to_device
 from tensorflow.contrib.data.python.ops.readers import make_batched_features_dataset
 from tensorflow.contrib.data.python.ops.readers import make_csv_dataset
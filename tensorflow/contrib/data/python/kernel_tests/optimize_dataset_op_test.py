@@ -0,0 +1,67 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the experimental input pipeline ops."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.contrib.data.python.ops import optimization
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import errors
+from tensorflow.python.platform import test
+
+
+class OptimizeDatasetTest(test.TestCase):
+
+  def _assertProduces(self, dataset, expected):
+    iterator = dataset.make_one_shot_iterator()
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      for element in expected:
+        self.assertAllEqual(element, sess.run(get_next))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+  def testDefaultOptimizations(self):
+    dataset = dataset_ops.Dataset.range(10).map(lambda x: x * x).map(
+        lambda x: x + 1).skip(0).batch(5).apply(optimization.optimize())
+    self._assertProduces(
+        dataset, [[1, 2, 5, 10, 17], [26, 37, 50, 65, 82]])
+
+  def testMapAndBatchFusion(self):
+    dataset = dataset_ops.Dataset.range(10).map(lambda x: x * x).batch(
+        10).apply(optimization.optimize(["map_and_batch_fusion"]))
+    self._assertProduces(dataset, [[x * x for x in range(10)]])
+
+  def testShuffleAndRepeatFusion(self):
+    dataset = dataset_ops.Dataset.range(10).shuffle(10).repeat(2).apply(
+        optimization.optimize(["shuffle_and_repeat_fusion"]))
+    iterator = dataset.make_one_shot_iterator()
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      results = [sess.run(get_next) for _ in range(20)]
+      self.assertAllEqual(sorted(list(range(10)) * 2), sorted(results))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+  def testNoOptimizations(self):
+    dataset = dataset_ops.Dataset.range(5).apply(optimization.optimize([]))
+    self._assertProduces(dataset, range(5))
+
+
+if __name__ == "__main__":
+  test.main()
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include "tensorflow/contrib/lite/arena_planner.h"
+#include <algorithm>
+#include <limits>
 #include <utility>
 
 namespace tflite {
@@ -23,6 +25,11 @@ namespace {
 constexpr const int kDefaultArenaAlignment = 64;
 constexpr const int kDefaultTensorAlignment = 4;
 
+size_t AlignTo(size_t alignment, size_t offset) {
+  return offset % alignment == 0 ? offset
+                                 : offset + (alignment - offset % alignment);
+}
+
 }  // namespace
 
 struct AllocationInfo {
@@ -34,10 +41,28 @@ struct AllocationInfo {
   enum { ALLOC, DEALLOC } type;
 };
 
+// The interval during which a kTfLiteArenaRw tensor occupies the arena, in
+// positions of a list of AllocationInfo: it is allocated at `first` and
+// deallocated at `last`. Tensors allocated in earlier intervals of nodes have
+// a `first` of -1, and tensors that outlive the list have a `last` past its
+// end.
+struct TensorLifetime {
+  int tensor;
+  int first;
+  int last;
+  size_t size;
+  // Whether the tensor was placed in an earlier interval of nodes, at
+  // `offset`.
+  bool placed;
+  size_t offset;
+};
+
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
-                           std::unique_ptr<GraphInfo> graph_info)
+                           std::unique_ptr<GraphInfo> graph_info,
+                           ArenaPlanningStrategy strategy)
     : context_(context),
       graph_info_(std::move(graph_info)),
+      strategy_(strategy),
       arena_(kDefaultArenaAlignment),
       persistent_arena_(kDefaultArenaAlignment) {}
 
@@ -53,17 +78,37 @@ int64_t ArenaPlanner::BasePointer(TfLiteAllocationType type) {
   return 0;
 }
 
+size_t ArenaPlanner::ArenaBytes() const { return arena_.HighWaterMark(); }
+
+size_t ArenaPlanner::PersistentArenaBytes() const {
+  return persistent_arena_.HighWaterMark();
+}
+
 TfLiteStatus ArenaPlanner::ResetAllocations() {
   TF_LITE_ENSURE_STATUS(arena_.Clear());
   TF_LITE_ENSURE_STATUS(persistent_arena_.Clear());
   allocs_.clear();
   allocs_.resize(graph_info_->num_tensors());
+  ideal_arena_bytes_ = 0;
   return kTfLiteOk;
 }
 
+void ArenaPlanner::UseAllocationPlanCache(bool enable, int max_cached_plans) {
+  plan_cache_enabled_ = enable;
+  max_cached_plans_ = max_cached_plans;
+  if (!enable) {
+    plan_cache_.clear();
+  }
+  while (max_cached_plans_ > 0 && plan_cache_.size() > max_cached_plans_) {
+    plan_cache_.pop_back();
+  }
+}
+
 TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Invalidate any existing data.
   TF_LITE_ENSURE_STATUS(ResetAllocations());
+  // The cached plans were made for another graph.
+  plan_cache_.clear();
 
   // Keeps track of references to each tensor.
   std::vector<int> refcounts(graph_info_->num_tensors(), 0);
@@ -134,7 +179,21 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   TF_LITE_ENSURE(context_, graph_info_->num_tensors() >= allocs_.size());
   allocs_.resize(graph_info_->num_tensors());
 
-  TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+  // Only the plans of the whole graph are cached: with dynamic tensors the
+  // nodes are planned in several intervals, as the sizes become known.
+  const bool cacheable = plan_cache_enabled_ && first_node == 0 &&
+                         last_node + 1 >= graph_info_->num_nodes();
+  std::vector<int64_t> key;
+  uint64_t hash = 0;
+  if (cacheable) {
+    PlanCacheKey(&key, &hash);
+  }
+  if (!cacheable || !RestoreCachedPlan(key, hash)) {
+    TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+    if (cacheable) {
+      CachePlan(std::move(key), hash);
+    }
+  }
   TF_LITE_ENSURE_STATUS(Commit());
 
   for (int i = 0; i < graph_info_->num_tensors(); ++i) {
@@ -148,6 +207,60 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   return kTfLiteOk;
 }
 
+void ArenaPlanner::PlanCacheKey(std::vector<int64_t>* key,
+                                uint64_t* hash) const {
+  key->clear();
+  key->reserve(2 * graph_info_->num_tensors() + graph_info_->num_nodes());
+  for (int i = 0; i < graph_info_->num_tensors(); ++i) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(i);
+    const bool in_arena = tensor.allocation_type == kTfLiteArenaRw ||
+                          tensor.allocation_type == kTfLiteArenaRwPersistent;
+    key->push_back(tensor.allocation_type);
+    key->push_back(in_arena ? tensor.bytes : 0);
+  }
+  // The temporaries are added by the ops in Prepare, so they may differ for
+  // the same tensor sizes.
+  for (int i = 0; i < graph_info_->num_nodes(); ++i) {
+    const TfLiteIntArray* node_temporaries = graph_info_->node(i).temporaries;
+    key->push_back(node_temporaries->size);
+    for (int j = 0; j < node_temporaries->size; ++j) {
+      key->push_back(node_temporaries->data[j]);
+    }
+  }
+
+  // FNV-1a, so that most mismatching plans are told apart without comparing
+  // their keys.
+  *hash = 14695981039346656037ull;
+  for (int64_t value : *key) {
+    *hash = (*hash ^ static_cast<uint64_t>(value)) * 1099511628211ull;
+  }
+}
+
+bool ArenaPlanner::RestoreCachedPlan(const std::vector<int64_t>& key,
+                                     uint64_t hash) {
+  for (auto it = plan_cache_.begin(); it != plan_cache_.end(); ++it) {
+    if (it->hash != hash || it->key != key) continue;
+    plan_cache_.splice(plan_cache_.begin(), plan_cache_, it);
+    const CachedPlan& plan = plan_cache_.front();
+    allocs_ = plan.allocs;
+    arena_.ReserveHighWaterMark(plan.arena_bytes);
+    persistent_arena_.ReserveHighWaterMark(plan.persistent_arena_bytes);
+    ideal_arena_bytes_ = std::max(ideal_arena_bytes_, plan.ideal_arena_bytes);
+    ++num_plan_cache_hits_;
+    return true;
+  }
+  return false;
+}
+
+void ArenaPlanner::CachePlan(std::vector<int64_t> key, uint64_t hash) {
+  plan_cache_.push_front({hash, std::move(key), allocs_, arena_.HighWaterMark(),
+                          persistent_arena_.HighWaterMark(),
+                          ideal_arena_bytes_});
+  if (max_cached_plans_ > 0 && plan_cache_.size() > max_cached_plans_) {
+    plan_cache_.pop_back();
+  }
+}
+
 TfLiteStatus ArenaPlanner::Commit() {
   TF_LITE_ENSURE_STATUS(arena_.Commit(context_));
   TF_LITE_ENSURE_STATUS(persistent_arena_.Commit(context_));
@@ -155,6 +268,58 @@ TfLiteStatus ArenaPlanner::Commit() {
 }
 
 TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
+  std::vector<AllocationInfo> allocations;
+  CollectAllocations(first_node, last_node, &allocations);
+
+  std::vector<TensorLifetime> lifetimes;
+  std::vector<int> lifetime_of_allocation;
+  TF_LITE_ENSURE_STATUS(CalculateLifetimes(first_node, allocations, &lifetimes,
+                                           &lifetime_of_allocation));
+
+  // Update the lower bound of the arena size: the largest total size of the
+  // tensors alive at any position of `allocations`. Positions are shifted by
+  // one to account for the tensors allocated earlier. The sizes are not
+  // aligned, since the arena ends right after its last tensor.
+  std::vector<int64_t> size_change(allocations.size() + 2, 0);
+  for (const TensorLifetime& lifetime : lifetimes) {
+    size_change[lifetime.first + 1] += lifetime.size;
+    size_change[lifetime.last + 1] -= lifetime.size;
+  }
+  int64_t alive_bytes = 0;
+  for (int64_t change : size_change) {
+    alive_bytes += change;
+    ideal_arena_bytes_ =
+        std::max(ideal_arena_bytes_, static_cast<size_t>(alive_bytes));
+  }
+
+  if (strategy_ == ArenaPlanningStrategy::kSizeOrdered) {
+    return CalculateSizeOrderedAllocations(allocations, &lifetimes,
+                                           lifetime_of_allocation);
+  }
+  for (const auto& alloc_info : allocations) {
+    if (alloc_info.type == AllocationInfo::ALLOC) {
+      TF_LITE_ENSURE_STATUS(CalculateTensorAllocation(alloc_info.tensor));
+    } else {
+      TF_LITE_ENSURE_STATUS(CalculateTensorDeallocation(alloc_info.tensor));
+    }
+  }
+  return kTfLiteOk;
+}
+
+void ArenaPlanner::CollectAllocations(
+    int first_node, int last_node, std::vector<AllocationInfo>* allocations) {
+  auto add_internal_tensors = [this, allocations](int node_index, bool alloc) {
+    if (node_index < graph_info_->num_nodes()) {
+      const TfLiteNode& node = graph_info_->node(node_index);
+      TfLiteIntArray* node_temporaries = node.temporaries;
+      for (int i = 0; i < node_temporaries->size; ++i) {
+        allocations->push_back(
+            {node_index, node_temporaries->data[i],
+             alloc ? AllocationInfo::ALLOC : AllocationInfo::DEALLOC});
+      }
+    }
+  };
+
   int active_node = first_node;
   // When dynamic tensors are present this method is called multiple times.
   // The items in the alloc_queue_ referring to nodes before first_node were
@@ -167,24 +332,143 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
       // This is the first allocation/deallocation for a given node.  It is
       // time to deallocate the previous temporaries and allocate new ones.
       if (active_node != first_node) {
-        TF_LITE_ENSURE_STATUS(
-            CalculateDeallocationOfInternalTensors(active_node - 1));
+        add_internal_tensors(active_node - 1, /*alloc=*/false);
       }
-      TF_LITE_ENSURE_STATUS(CalculateAllocationOfInternalTensors(active_node));
+      add_internal_tensors(active_node, /*alloc=*/true);
       ++active_node;
     }
     // Handle the current item.
+    allocations->push_back(alloc_info);
+  }
+
+  // Don't forget to deallocate temporaries of last node.
+  add_internal_tensors(active_node - 1, /*alloc=*/false);
+}
+
+TfLiteStatus ArenaPlanner::CalculateLifetimes(
+    int first_node, const std::vector<AllocationInfo>& allocations,
+    std::vector<TensorLifetime>* lifetimes,
+    std::vector<int>* lifetime_of_allocation) {
+  const int end = allocations.size();
+  auto in_arena = [this](int tensor_index) {
+    return graph_info_->tensor(tensor_index)->allocation_type ==
+           kTfLiteArenaRw;
+  };
+
+  // Replay the allocations of the nodes before first_node to find the
+  // tensors that are still in the arena. Their internal tensors were all
+  // deallocated.
+  std::vector<bool> allocated_before(graph_info_->num_tensors(), false);
+  for (const auto& alloc_info : alloc_queue_) {
+    if (alloc_info.node >= first_node) break;
+    allocated_before[alloc_info.tensor] =
+        alloc_info.type == AllocationInfo::ALLOC;
+  }
+
+  // The index in `lifetimes` of the tensors currently alive, or -1.
+  std::vector<int> alive(graph_info_->num_tensors(), -1);
+  for (int i = 0; i < allocated_before.size(); ++i) {
+    if (allocated_before[i] && in_arena(i)) {
+      alive[i] = lifetimes->size();
+      lifetimes->push_back(
+          {i, -1, end, allocs_[i].size, /*placed=*/true, allocs_[i].offset});
+    }
+  }
+
+  lifetime_of_allocation->assign(allocations.size(), -1);
+  for (int i = 0; i < end; ++i) {
+    const AllocationInfo& alloc_info = allocations[i];
+    const int tensor_index = alloc_info.tensor;
+    if (!in_arena(tensor_index)) continue;
+    // A tensor that is allocated again is considered deallocated first.
+    if (alive[tensor_index] != -1) {
+      (*lifetimes)[alive[tensor_index]].last = i;
+      alive[tensor_index] = -1;
+    }
     if (alloc_info.type == AllocationInfo::ALLOC) {
-      TF_LITE_ENSURE_STATUS(CalculateTensorAllocation(alloc_info.tensor));
-    } else {
-      TF_LITE_ENSURE_STATUS(CalculateTensorDeallocation(alloc_info.tensor));
+      alive[tensor_index] = lifetimes->size();
+      (*lifetime_of_allocation)[i] = lifetimes->size();
+      lifetimes->push_back({tensor_index, i, end,
+                            graph_info_->tensor(tensor_index)->bytes,
+                            /*placed=*/false, 0});
     }
   }
+  return kTfLiteOk;
+}
 
-  // Don't forget to deallocate temporaries of last node.
-  TF_LITE_ENSURE_STATUS(
-      CalculateDeallocationOfInternalTensors(active_node - 1));
+TfLiteStatus ArenaPlanner::CalculateSizeOrderedAllocations(
+    const std::vector<AllocationInfo>& allocations,
+    std::vector<TensorLifetime>* lifetimes,
+    const std::vector<int>& lifetime_of_allocation) {
+  std::vector<int> placed;
+  std::vector<int> to_place;
+  for (int i = 0; i < lifetimes->size(); ++i) {
+    ((*lifetimes)[i].placed ? placed : to_place).push_back(i);
+  }
+  std::stable_sort(to_place.begin(), to_place.end(), [lifetimes](int a, int b) {
+    return (*lifetimes)[a].size > (*lifetimes)[b].size;
+  });
+
+  // Zero-sized tensors take one byte here, so that no two tensors alive at
+  // the same time share an offset.
+  auto end_of = [](const TensorLifetime& lifetime) {
+    return lifetime.offset + std::max<size_t>(lifetime.size, 1);
+  };
+
+  std::vector<int> overlapping;
+  for (int index : to_place) {
+    TensorLifetime& lifetime = (*lifetimes)[index];
+    overlapping.clear();
+    for (int other : placed) {
+      const TensorLifetime& other_lifetime = (*lifetimes)[other];
+      if (other_lifetime.first < lifetime.last &&
+          lifetime.first < other_lifetime.last) {
+        overlapping.push_back(other);
+      }
+    }
+    std::sort(overlapping.begin(), overlapping.end(), [lifetimes](int a, int b) {
+      return (*lifetimes)[a].offset < (*lifetimes)[b].offset;
+    });
+
+    // Take the smallest gap between the overlapping tensors that fits, or
+    // else go after all of them.
+    const size_t size = std::max<size_t>(lifetime.size, 1);
+    size_t best_offset = 0;
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t current_offset = 0;
+    for (int other : overlapping) {
+      const TensorLifetime& other_lifetime = (*lifetimes)[other];
+      const size_t aligned_offset =
+          AlignTo(kDefaultTensorAlignment, current_offset);
+      if (aligned_offset + size <= other_lifetime.offset &&
+          other_lifetime.offset - current_offset < best_gap) {
+        best_offset = aligned_offset;
+        best_gap = other_lifetime.offset - current_offset;
+      }
+      current_offset = std::max(current_offset, end_of(other_lifetime));
+    }
+    if (best_gap == std::numeric_limits<size_t>::max()) {
+      best_offset = AlignTo(kDefaultTensorAlignment, current_offset);
+    }
+    lifetime.offset = best_offset;
+    lifetime.placed = true;
+    placed.push_back(index);
+  }
 
+  // Replay the allocations so that the arenas know about them.
+  for (int i = 0; i < allocations.size(); ++i) {
+    const AllocationInfo& alloc_info = allocations[i];
+    const int tensor_index = alloc_info.tensor;
+    if (lifetime_of_allocation[i] != -1) {
+      const TensorLifetime& lifetime = (*lifetimes)[lifetime_of_allocation[i]];
+      TF_LITE_ENSURE_STATUS(arena_.AllocateAt(
+          context_, lifetime.offset, lifetime.size, &allocs_[tensor_index]));
+    } else if (alloc_info.type == AllocationInfo::ALLOC) {
+      TF_LITE_ENSURE_STATUS(CalculateTensorAllocation(tensor_index));
+    } else {
+      TF_LITE_ENSURE_STATUS(CalculateTensorDeallocation(tensor_index));
+    }
+  }
   return kTfLiteOk;
 }
 
@@ -228,30 +512,4 @@ TfLiteStatus ArenaPlanner::CalculateTensorDeallocation(int tensor_index) {
   return kTfLiteOk;
 }
 
-TfLiteStatus ArenaPlanner::CalculateAllocationOfInternalTensors(
-    int node_index) {
-  if (node_index < graph_info_->num_nodes()) {
-    const TfLiteNode& node = graph_info_->node(node_index);
-    TfLiteIntArray* node_temporaries = node.temporaries;
-    for (int i = 0; i < node_temporaries->size; ++i) {
-      int tensor_index = node_temporaries->data[i];
-      TF_LITE_ENSURE_STATUS(CalculateTensorAllocation(tensor_index));
-    }
-  }
-  return kTfLiteOk;
-}
-
-TfLiteStatus ArenaPlanner::CalculateDeallocationOfInternalTensors(
-    int node_index) {
-  if (node_index < graph_info_->num_nodes()) {
-    const TfLiteNode& node = graph_info_->node(node_index);
-    TfLiteIntArray* node_temporaries = node.temporaries;
-    for (int i = 0; i < node_temporaries->size; ++i) {
-      int tensor_index = node_temporaries->data[i];
-      TF_LITE_ENSURE_STATUS(CalculateTensorDeallocation(tensor_index));
-    }
-  }
-  return kTfLiteOk;
-}
-
 }  // namespace tflite
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_LITE_ARENA_PLANNER_H_
 #define TENSORFLOW_CONTRIB_LITE_ARENA_PLANNER_H_
 
+#include <list>
 #include <memory>
 #include <vector>
 
@@ -26,6 +27,20 @@ limitations under the License.
 namespace tflite {
 
 struct AllocationInfo;
+struct TensorLifetime;
+
+// How an ArenaPlanner assigns offsets to the tensors of its arena.
+enum class ArenaPlanningStrategy {
+  // Tensors are placed in execution order, each one in the smallest gap left
+  // by the tensors deallocated so far that can hold it.
+  kFirstFit,
+  // The lifetimes of all the tensors are computed first, and the tensors are
+  // then placed from the largest to the smallest, each one in the smallest
+  // gap left by the tensors placed so far whose lifetimes overlap its own.
+  // This usually gets closer to the ideal arena size, because the large
+  // tensors are not scattered by the small ones.
+  kSizeOrdered,
+};
 
 // A memory planner that makes all the allocations using arenas.
 //
@@ -44,7 +59,8 @@ class ArenaPlanner : public MemoryPlanner {
  public:
   // Ownership of 'context' is not taken and it must remain util the
   // ArenaPlanner is destroyed.
-  ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info);
+  ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
+               ArenaPlanningStrategy strategy = ArenaPlanningStrategy::kFirstFit);
   ~ArenaPlanner() override;
   ArenaPlanner(const ArenaPlanner&) = delete;
   ArenaPlanner& operator=(const ArenaPlanner&) = delete;
@@ -56,7 +72,56 @@ class ArenaPlanner : public MemoryPlanner {
   // Returns the base arena location for a given allocation type.
   int64_t BasePointer(TfLiteAllocationType type);
 
+  // Returns the number of bytes of the arena holding the kTfLiteArenaRw
+  // tensors.
+  size_t ArenaBytes() const;
+
+  // Returns the lower bound of ArenaBytes() for the planned tensors: the
+  // largest total size of the kTfLiteArenaRw tensors that are alive at the
+  // same time.
+  size_t IdealArenaBytes() const { return ideal_arena_bytes_; }
+
+  // Returns the number of bytes of the arena holding the
+  // kTfLiteArenaRwPersistent tensors.
+  size_t PersistentArenaBytes() const;
+
+  // Enables or disables the cache of the plans of the whole graph. A plan is
+  // keyed by the allocation types and sizes of all the tensors, so that
+  // coming back to tensor sizes planned before, e.g. after resizing the inputs
+  // to shapes seen earlier, restores the offsets of the tensors instead of
+  // planning them again. At most `max_cached_plans` plans are kept, the least
+  // recently used one being evicted first; 0 means no bound.
+  void UseAllocationPlanCache(bool enable, int max_cached_plans = 0);
+
+  // Returns the number of plans in the cache.
+  int NumCachedPlans() const { return plan_cache_.size(); }
+
+  // Returns the number of times a cached plan was restored instead of
+  // planning the tensors again.
+  int64_t NumPlanCacheHits() const { return num_plan_cache_hits_; }
+
  private:
+  // The offsets of the tensors of the whole graph, for one set of tensor
+  // sizes.
+  struct CachedPlan {
+    uint64_t hash;
+    std::vector<int64_t> key;
+    std::vector<ArenaAlloc> allocs;
+    size_t arena_bytes;
+    size_t persistent_arena_bytes;
+    size_t ideal_arena_bytes;
+  };
+
+  // Computes the key of the plan of the current tensors, and its hash.
+  void PlanCacheKey(std::vector<int64_t>* key, uint64_t* hash) const;
+
+  // Restores the cached plan with the given key, if any, and makes it the
+  // most recently used one. Returns true if there was one.
+  bool RestoreCachedPlan(const std::vector<int64_t>& key, uint64_t hash);
+
+  // Adds the current plan to the cache under the given key.
+  void CachePlan(std::vector<int64_t> key, uint64_t hash);
+
   // Make sure all the arenas have reserved enough memory to store all their
   // tensors.
   TfLiteStatus Commit();
@@ -65,6 +130,28 @@ class ArenaPlanner : public MemoryPlanner {
   // for all tensors affected by ops in the interval [first_node, last_node].
   TfLiteStatus CalculateAllocations(int first_node, int last_node);
 
+  // Lists, in order, the allocations and deallocations of all tensors
+  // affected by ops in the interval [first_node, last_node], including the
+  // internal tensors of the ops.
+  void CollectAllocations(int first_node, int last_node,
+                          std::vector<AllocationInfo>* allocations);
+
+  // Computes the lifetimes, within `allocations`, of the kTfLiteArenaRw
+  // tensors that are alive during the interval starting at `first_node`.
+  // `lifetime_of_allocation[i]` is set to the index in `lifetimes` started
+  // by allocations[i], or -1.
+  TfLiteStatus CalculateLifetimes(
+      int first_node, const std::vector<AllocationInfo>& allocations,
+      std::vector<TensorLifetime>* lifetimes,
+      std::vector<int>* lifetime_of_allocation);
+
+  // Assigns offsets in `arena_` to the tensors started in `lifetimes` using
+  // the kSizeOrdered strategy, and replays `allocations` in the arenas.
+  TfLiteStatus CalculateSizeOrderedAllocations(
+      const std::vector<AllocationInfo>& allocations,
+      std::vector<TensorLifetime>* lifetimes,
+      const std::vector<int>& lifetime_of_allocation);
+
   // Assign absolute memory location to a tensor, based on its relative
   // position inside the corresponding arena buffer.
   TfLiteStatus ResolveTensorAllocation(int tensor_index);
@@ -75,16 +162,9 @@ class ArenaPlanner : public MemoryPlanner {
   // Register a deallocation for the given tensor.
   TfLiteStatus CalculateTensorDeallocation(int tensor_index);
 
-  // Register an allocation for all internal (temporary) tensors of
-  // 'node_index'.
-  TfLiteStatus CalculateAllocationOfInternalTensors(int node_index);
-
-  // Register a deallocation for all internal (temporary) tensors of
-  // 'node_index'.
-  TfLiteStatus CalculateDeallocationOfInternalTensors(int node_index);
-
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
+  ArenaPlanningStrategy strategy_;
 
   // Stores allocation data for all tensors.
   std::vector<ArenaAlloc> allocs_;
@@ -100,6 +180,16 @@ class ArenaPlanner : public MemoryPlanner {
   // Raw memory buffer that is allocated for persistent tensors that are
   // declared as kTfLiteArenaRwPersistent.
   SimpleMemoryArena persistent_arena_;
+
+  // The largest total size of the kTfLiteArenaRw tensors alive at the same
+  // time since the last ResetAllocations().
+  size_t ideal_arena_bytes_ = 0;
+
+  // The cached plans, the most recently used first.
+  bool plan_cache_enabled_ = false;
+  int max_cached_plans_ = 0;
+  std::list<CachedPlan> plan_cache_;
+  int64_t num_plan_cache_hits_ = 0;
 };
 
 }  // namespace tflite
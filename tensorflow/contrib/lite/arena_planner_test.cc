@@ -142,11 +142,13 @@ void ReportError(TfLiteContext* context, const char* format, ...) {
 
 class ArenaPlannerTest : public ::testing::Test {
  protected:
-  void SetGraph(TestGraph* graph) {
+  void SetGraph(TestGraph* graph, ArenaPlanningStrategy strategy =
+                                       ArenaPlanningStrategy::kFirstFit) {
     graph_ = graph;
     context_.ReportError = ReportError;
     planner_.reset(new ArenaPlanner(
-        &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph))));
+        &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph)),
+        strategy));
     CHECK(planner_->ResetAllocations() == kTfLiteOk);
     CHECK(planner_->PlanAllocations() == kTfLiteOk);
   }
@@ -331,6 +333,9 @@ TEST_F(ArenaPlannerTest, SimpleGraphWithPersistentTensor) {
   EXPECT_EQ(GetOffset(5), GetOffsetAfter(2));
   EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
   EXPECT_EQ(GetOffset(3), 0);
+
+  // Only #1 is in the persistent arena.
+  EXPECT_EQ(planner_->PersistentArenaBytes(), (*graph.tensors())[1].bytes);
 }
 
 TEST_F(ArenaPlannerTest, SimpleGraphWithDynamicTensor) {
@@ -458,6 +463,198 @@ TEST_F(ArenaPlannerTest, LargerGraphAndStepwiseAllocation) {
   EXPECT_EQ(GetOffset(10), 0);
 }
 
+TEST_F(ArenaPlannerTest, SizeOrderedPlanning) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2, 3}, {}},
+                      {{2, 0}, {4, 5}, {6}},
+                      {{1, -1}, {7}, {}},
+                      {{7, 3}, {8}, {9}},
+                      {{4, 5, 8}, {10}, {}},
+                  },
+                  {10});
+  SetGraph(&graph);
+  Execute(0, 10);
+  const size_t first_fit_bytes = planner_->ArenaBytes();
+
+  SetGraph(&graph, ArenaPlanningStrategy::kSizeOrdered);
+  Execute(0, 10);
+
+  // Allocation order, with sizes:
+  //   Op0: +0(3) +1(6) +2(9) +3(12)
+  //   Op1: +6(21) +4(15) +5(18) -6 -0 -2
+  //   Op2: +7(24) -1
+  //   Op3: +9(30) +8(27) -9 -3 -7
+  //   Op4: +10(33) -4 -5 -8
+  // The largest tensors go first, each at the lowest place that fits among
+  // the tensors placed so far that are alive at the same time.
+  EXPECT_EQ(GetOffset(10), 0);
+  EXPECT_EQ(GetOffset(9), 0);
+  EXPECT_EQ(GetOffset(8), GetOffsetAfter(10));
+  EXPECT_EQ(GetOffset(7), GetOffsetAfter(8));
+  EXPECT_EQ(GetOffset(6), 0);
+  EXPECT_EQ(GetOffset(5), GetOffsetAfter(7));
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(4));
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(6));
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffset(0), GetOffsetAfter(1));
+
+  // The peak is during Op3: #3, #4, #5, #7, #8 and #9 add up to 126 bytes.
+  EXPECT_EQ(planner_->IdealArenaBytes(), 126);
+  EXPECT_GE(planner_->ArenaBytes(), planner_->IdealArenaBytes());
+  EXPECT_LT(planner_->ArenaBytes(), first_fit_bytes);
+}
+
+TEST_F(ArenaPlannerTest, SizeOrderedStepwisePlanning) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2, 3}, {}},
+                      {{2, 0}, {4, 5}, {6}},
+                      {{1, -1}, {7}, {}},
+                      {{7, 3}, {8}, {9}},
+                      {{4, 5, 8}, {10}, {}},
+                  },
+                  {10});
+  SetGraph(&graph, ArenaPlanningStrategy::kSizeOrdered);
+
+  // Only the tensors of the planned ops are placed, and they stay in place
+  // when the following ops are planned.
+  Execute(0, 0);
+  EXPECT_EQ(GetOffset(3), 0);
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(3));
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffset(0), GetOffsetAfter(1));
+  EXPECT_TRUE((*graph.tensors())[4].data.raw == nullptr);
+
+  Execute(1, 1);
+  EXPECT_EQ(GetOffset(3), 0);
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(3));
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffset(0), GetOffsetAfter(1));
+  EXPECT_EQ(GetOffset(6), GetOffsetAfter(0));
+  EXPECT_EQ(GetOffset(5), GetOffsetAfter(6));
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+
+  Execute(2, 4);
+  EXPECT_EQ(GetOffset(3), 0);
+  EXPECT_EQ(GetOffset(6), GetOffsetAfter(0));
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+  // #10 only overlaps #4, #5 and #8, all of which are above it.
+  EXPECT_EQ(GetOffset(10), 0);
+  EXPECT_EQ(planner_->IdealArenaBytes(), 126);
+  EXPECT_GE(planner_->ArenaBytes(), planner_->IdealArenaBytes());
+}
+
+TEST_F(ArenaPlannerTest, PlanCache) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2, 3}, {}},
+                      {{2, 0}, {4, 5}, {6}},
+                      {{1, -1}, {7}, {}},
+                      {{7, 3}, {8}, {9}},
+                      {{4, 5, 8}, {10}, {}},
+                  },
+                  {10});
+  auto offsets = [this]() {
+    std::vector<int64_t> result;
+    for (int i = 0; i <= 10; ++i) result.push_back(GetOffset(i));
+    return result;
+  };
+  auto reallocate = [this]() {
+    CHECK(planner_->ResetAllocations() == kTfLiteOk);
+    Execute(0, 10);
+  };
+
+  // The plans of the two sizes of #0, without the cache.
+  SetGraph(&graph);
+  Execute(0, 10);
+  const std::vector<int64_t> small_offsets = offsets();
+  const size_t small_bytes = planner_->ArenaBytes();
+  (*graph.tensors())[0].bytes = 300;
+  reallocate();
+  const std::vector<int64_t> large_offsets = offsets();
+  const size_t large_bytes = planner_->ArenaBytes();
+  EXPECT_NE(small_offsets, large_offsets);
+
+  (*graph.tensors())[0].bytes = 3;
+  SetGraph(&graph);
+  planner_->UseAllocationPlanCache(true);
+  // Only the plans of the whole graph are cached.
+  Execute(0, 1);
+  EXPECT_EQ(planner_->NumCachedPlans(), 0);
+  reallocate();
+  EXPECT_EQ(planner_->NumCachedPlans(), 1);
+  EXPECT_EQ(planner_->NumPlanCacheHits(), 0);
+  EXPECT_EQ(offsets(), small_offsets);
+
+  (*graph.tensors())[0].bytes = 300;
+  reallocate();
+  EXPECT_EQ(planner_->NumCachedPlans(), 2);
+  EXPECT_EQ(planner_->NumPlanCacheHits(), 0);
+  EXPECT_EQ(offsets(), large_offsets);
+
+  // Going back and forth restores the cached plans.
+  for (int i = 0; i < 2; ++i) {
+    (*graph.tensors())[0].bytes = 3;
+    reallocate();
+    EXPECT_EQ(planner_->NumCachedPlans(), 2);
+    EXPECT_EQ(planner_->NumPlanCacheHits(), 2 * i + 1);
+    EXPECT_EQ(offsets(), small_offsets);
+    EXPECT_EQ(planner_->ArenaBytes(), small_bytes);
+
+    (*graph.tensors())[0].bytes = 300;
+    reallocate();
+    EXPECT_EQ(planner_->NumCachedPlans(), 2);
+    EXPECT_EQ(planner_->NumPlanCacheHits(), 2 * i + 2);
+    EXPECT_EQ(offsets(), large_offsets);
+    EXPECT_EQ(planner_->ArenaBytes(), large_bytes);
+  }
+
+  // Planning the graph again drops the cached plans.
+  CHECK(planner_->PlanAllocations() == kTfLiteOk);
+  EXPECT_EQ(planner_->NumCachedPlans(), 0);
+}
+
+TEST_F(ArenaPlannerTest, PlanCacheEvictsLeastRecentlyUsed) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2, 3}, {}},
+                      {{2, 0}, {4, 5}, {6}},
+                      {{4, 5}, {7}, {}},
+                  },
+                  {7});
+  SetGraph(&graph);
+  planner_->UseAllocationPlanCache(true, /*max_cached_plans=*/2);
+  auto allocate_with_size = [this, &graph](size_t bytes) {
+    (*graph.tensors())[0].bytes = bytes;
+    CHECK(planner_->ResetAllocations() == kTfLiteOk);
+    Execute(0, 10);
+    return GetOffset(1);
+  };
+
+  const int64_t offset_a = allocate_with_size(3);
+  const int64_t offset_b = allocate_with_size(100);
+  EXPECT_EQ(planner_->NumCachedPlans(), 2);
+  // Uses the plan of `a`, so that `b` is the one evicted by `c`.
+  EXPECT_EQ(allocate_with_size(3), offset_a);
+  const int64_t offset_c = allocate_with_size(200);
+  EXPECT_EQ(planner_->NumCachedPlans(), 2);
+
+  EXPECT_EQ(allocate_with_size(3), offset_a);
+  EXPECT_EQ(allocate_with_size(200), offset_c);
+  EXPECT_EQ(planner_->NumCachedPlans(), 2);
+  EXPECT_EQ(allocate_with_size(100), offset_b);
+  EXPECT_EQ(planner_->NumCachedPlans(), 2);
+
+  planner_->UseAllocationPlanCache(false);
+  EXPECT_EQ(planner_->NumCachedPlans(), 0);
+}
+
 }  // namespace
 }  // namespace tflite
 
@@ -60,6 +60,20 @@ TfLiteIntArray* TfLiteIntArrayCopy(TfLiteIntArray* src) {
 
 void TfLiteIntArrayFree(TfLiteIntArray* a) { free(a); }
 
+int TfLiteFloatArrayGetSizeInBytes(int size) {
+  static TfLiteFloatArray dummy;
+  return sizeof(dummy) + sizeof(dummy.data[0]) * size;
+}
+
+TfLiteFloatArray* TfLiteFloatArrayCreate(int size) {
+  TfLiteFloatArray* ret =
+      (TfLiteFloatArray*)malloc(TfLiteFloatArrayGetSizeInBytes(size));
+  ret->size = size;
+  return ret;
+}
+
+void TfLiteFloatArrayFree(TfLiteFloatArray* a) { free(a); }
+
 void TfLiteTensorDataFree(TfLiteTensor* t) {
   if (t->allocation_type == kTfLiteDynamic && t->data.raw) {
     free(t->data.raw);
@@ -67,10 +81,32 @@ void TfLiteTensorDataFree(TfLiteTensor* t) {
   t->data.raw = NULL;
 }
 
+void TfLiteTensorAffineQuantizationFree(TfLiteTensor* t) {
+  TfLiteAffineQuantization* quantization = t->affine_quantization;
+  if (quantization) {
+    if (quantization->scale) TfLiteFloatArrayFree(quantization->scale);
+    if (quantization->zero_point) TfLiteIntArrayFree(quantization->zero_point);
+    free(quantization);
+  }
+  t->affine_quantization = NULL;
+}
+
+void TfLiteTensorSparsityFree(TfLiteTensor* t) {
+  TfLiteSparsity* sparsity = t->sparsity;
+  if (sparsity) {
+    if (sparsity->row_segments) TfLiteIntArrayFree(sparsity->row_segments);
+    if (sparsity->col_indices) TfLiteIntArrayFree(sparsity->col_indices);
+    free(sparsity);
+  }
+  t->sparsity = NULL;
+}
+
 void TfLiteTensorFree(TfLiteTensor* t) {
   TfLiteTensorDataFree(t);
   if (t->dims) TfLiteIntArrayFree(t->dims);
   t->dims = NULL;
+  TfLiteTensorAffineQuantizationFree(t);
+  TfLiteTensorSparsityFree(t);
 }
 
 void TfLiteTensorReset(TfLiteType type, const char* name, TfLiteIntArray* dims,
@@ -20,6 +20,7 @@ limitations under the License.
 // TF_LITE_ENSURE - Self-sufficient error checking
 // TfLiteStatus - Status reporting
 // TfLiteIntArray - stores tensor shapes (dims),
+// TfLiteFloatArray - stores per-channel quantization scales,
 // TfLiteContext - allows an op to access the tensors
 // TfLiteTensor - tensor (a multidimensional array)
 // TfLiteNode - a single node or operation
@@ -77,6 +78,30 @@ TfLiteIntArray* TfLiteIntArrayCopy(TfLiteIntArray* src);
 // Free memory of array `v`.
 void TfLiteIntArrayFree(TfLiteIntArray* v);
 
+// Fixed size list of floats. Used for per-channel quantization scales.
+typedef struct {
+  int size;
+// gcc 6.1+ have a bug where flexible members aren't properly handled
+// https://github.com/google/re2/commit/b94b7cd42e9f02673cd748c1ac1d16db4052514c
+#if !defined(__clang__) && defined(__GNUC__) && __GNUC__ == 6 && \
+    __GNUC_MINOR__ >= 1
+  float data[0];
+#else
+  float data[];
+#endif
+} TfLiteFloatArray;
+
+// Given the size (number of elements) in a TfLiteFloatArray, calculate its
+// size in bytes.
+int TfLiteFloatArrayGetSizeInBytes(int size);
+
+// Create a array of a given `size` (uninitialized entries).
+// This returns a pointer, that you must free using TfLiteFloatArrayFree().
+TfLiteFloatArray* TfLiteFloatArrayCreate(int size);
+
+// Free memory of array `a`.
+void TfLiteFloatArrayFree(TfLiteFloatArray* a);
+
 // Since we must not depend on any libraries, define a minimal subset of
 // error macros while avoiding names that have pre-conceived meanings like
 // assert and check.
@@ -138,6 +163,7 @@ typedef enum {
   kTfLiteInt64 = 4,
   kTfLiteString = 5,
   kTfLiteBool = 6,
+  kTfLiteInt8 = 7,
 } TfLiteType;
 
 // Parameters for asymmetric quantization. Quantized values can be converted
@@ -148,6 +174,32 @@ typedef struct {
   int32_t zero_point;
 } TfLiteQuantizationParams;
 
+// Parameters for quantization along one dimension of a tensor, usually the
+// output channels of the weights of a convolution. The slice at index i of
+// `quantized_dimension` converts back to float using scale->data[i] and
+// zero_point->data[i], which is 0 for symmetric quantization. Both arrays
+// have as many entries as that dimension has elements.
+typedef struct {
+  TfLiteFloatArray* scale;
+  TfLiteIntArray* zero_point;
+  int32_t quantized_dimension;
+} TfLiteAffineQuantization;
+
+// Describes a constant tensor that only stores its non-zero blocks. The
+// tensor is viewed as a matrix whose columns are its last dimension and whose
+// rows are all its other dimensions, split into blocks of
+// block_rows x block_cols values. `data` holds the blocks that have a non-zero
+// value, row of blocks after row of blocks and in increasing column order
+// within a row, each block in row-major order. The blocks of row of blocks i
+// are blocks row_segments->data[i] to row_segments->data[i + 1] - 1, and block
+// j is in column of blocks col_indices->data[j].
+typedef struct {
+  int block_rows;
+  int block_cols;
+  TfLiteIntArray* row_segments;
+  TfLiteIntArray* col_indices;
+} TfLiteSparsity;
+
 // A union of points that points to memory for a given tensor.
 typedef union {
   int* i32;
@@ -157,6 +209,7 @@ typedef union {
   const char* raw_const;
   uint8_t* uint8;
   bool* b;
+  int8_t* int8;
 } TfLitePtrUnion;
 
 // Memory allocation strategies. kTfLiteMmapRo is for read-only memory-mapped
@@ -223,6 +276,15 @@ typedef struct {
   // delegate buffer.
   // WARNING: This is an // experimental interface that is subject to change.
   bool data_is_stale;
+
+  // Per-channel quantization information, or NULL when `params` applies to
+  // the whole tensor. Owned by the tensor.
+  TfLiteAffineQuantization* affine_quantization;
+
+  // The block sparse layout of `data`, or NULL when it holds all the values
+  // of the tensor. `dims` is the shape of the whole tensor, and `bytes` the
+  // size of the stored blocks. Owned by the tensor.
+  TfLiteSparsity* sparsity;
 } TfLiteTensor;
 
 // Free data memory of tensor `t`;
@@ -231,6 +293,12 @@ void TfLiteTensorDataFree(TfLiteTensor* t);
 // Free memory of tensor `t`;
 void TfLiteTensorFree(TfLiteTensor* t);
 
+// Free the per-channel quantization information of tensor `t`, if any.
+void TfLiteTensorAffineQuantizationFree(TfLiteTensor* t);
+
+// Free the sparse layout of tensor `t`, if any.
+void TfLiteTensorSparsityFree(TfLiteTensor* t);
+
 // Set all of a tensor's fields (and free any previously allocated data).
 void TfLiteTensorReset(TfLiteType type, const char* name, TfLiteIntArray* dims,
                        TfLiteQuantizationParams quantization, char* buffer,
@@ -334,6 +402,9 @@ typedef struct TfLiteContext {
   // library-global objects.
   void* gemm_context;
   void* eigen_context;
+  // The thread pool the ops split their work on (see
+  // kernels/thread_pool_support.h).
+  void* thread_pool_context;
 } TfLiteContext;
 
 typedef struct _TfLiteRegistration {
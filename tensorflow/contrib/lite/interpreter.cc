@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/contrib/lite/interpreter.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdarg>
 #include <cstdint>
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/graph_info.h"
 #include "tensorflow/contrib/lite/kernels/eigen_support.h"
 #include "tensorflow/contrib/lite/kernels/gemm_support.h"
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
 #include "tensorflow/contrib/lite/memory_planner.h"
 #include "tensorflow/contrib/lite/nnapi_delegate.h"
 #include "tensorflow/contrib/lite/profiling/profiler.h"
@@ -98,6 +100,7 @@ Interpreter::Interpreter(ErrorReporter* error_reporter)
   context_.tensors_size = 0;
   context_.eigen_context = nullptr;
   context_.gemm_context = nullptr;
+  context_.thread_pool_context = nullptr;
   context_.recommended_num_threads = -1;
 
   // Invalid to call these these except from TfLiteDelegate
@@ -340,10 +343,13 @@ TfLiteStatus Interpreter::BytesRequired(TfLiteType type, const int* dims,
     case kTfLiteBool:
       *bytes = sizeof(bool) * count;
       break;
+    case kTfLiteInt8:
+      *bytes = sizeof(int8_t) * count;
+      break;
     default:
       ReportError(
           &context_,
-          "Only float32, int32, int64, uint8, bool supported currently.");
+          "Only float32, int32, int64, uint8, int8, bool supported currently.");
       return kTfLiteError;
   }
   return kTfLiteOk;
@@ -439,14 +445,21 @@ TfLiteStatus Interpreter::ResizeInputTensor(int tensor_index,
                 "ResizeInputTensor is disallowed when graph is immutable.");
     return kTfLiteError;
   }
-  state_ = kStateUninvokable;
 
   // TODO(aselle): All bounds checks can be implemented as one-sided bounds
   // checks by casting to unsigned for efficiency. Profile before doing this.
   TF_LITE_ENSURE(&context_,
                  tensor_index < context_.tensors_size && tensor_index >= 0);
+  TfLiteTensor* tensor = &context_.tensors[tensor_index];
+  // Keep the current allocations if the shape does not change.
+  if (tensor->dims && state_ != kStateUninvokable &&
+      tensor->dims->size == dims.size() &&
+      std::equal(dims.begin(), dims.end(), tensor->dims->data)) {
+    return kTfLiteOk;
+  }
+  state_ = kStateUninvokable;
   TfLiteIntArray* dims_lite = ConvertVectorToTfLiteIntArray(dims);
-  return ResizeTensorImpl(&context_.tensors[tensor_index], dims_lite);
+  return ResizeTensorImpl(tensor, dims_lite);
 }
 
 // Returns true if at least one tensor in the given list is kTfLiteDynamic.
@@ -461,6 +474,17 @@ bool HasDynamicTensor(const TfLiteContext& context,
   return false;
 }
 
+// Returns true if the op of `registration` has a kernel for a sparse tensor
+// (see TfLiteSparsity) as its input number `input_index`. Other ops would read
+// the stored blocks as the whole dense tensor, past the end of its buffer.
+bool SupportsSparseInput(const TfLiteRegistration& registration,
+                         int input_index) {
+  // Only the weights of FullyConnected and Conv2D.
+  return input_index == 1 &&
+         (registration.builtin_code == BuiltinOperator_FULLY_CONNECTED ||
+          registration.builtin_code == BuiltinOperator_CONV_2D);
+}
+
 TfLiteStatus Interpreter::PrepareOpsStartingAt(
     int first_execution_plan_index, int* last_execution_plan_index_prepared) {
   for (int execution_plan_index = first_execution_plan_index;
@@ -469,6 +493,18 @@ TfLiteStatus Interpreter::PrepareOpsStartingAt(
     TfLiteNode& node = nodes_and_registration_[node_index].first;
     const TfLiteRegistration& registration =
         nodes_and_registration_[node_index].second;
+    for (int i = 0; i < node.inputs->size; ++i) {
+      const int tensor_index = node.inputs->data[i];
+      if (tensor_index != kOptionalTensor &&
+          context_.tensors[tensor_index].sparsity &&
+          !SupportsSparseInput(registration, i)) {
+        ReportError(&context_,
+                    "Node %d does not support the sparse tensor %d as its "
+                    "input %d.",
+                    node_index, tensor_index, i);
+        return kTfLiteError;
+      }
+    }
     EnsureTensorsVectorCapacity();
     if (OpPrepare(registration, &node) == kTfLiteError) {
       return kTfLiteError;
@@ -489,7 +525,11 @@ TfLiteStatus Interpreter::PrepareOpsStartingAt(
 TfLiteStatus Interpreter::PrepareOpsAndTensors() {
   if (!memory_planner_) {
     memory_planner_.reset(new ArenaPlanner(
-        &context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this))));
+        &context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this)),
+        size_ordered_arena_planning_ ? ArenaPlanningStrategy::kSizeOrdered
+                                     : ArenaPlanningStrategy::kFirstFit));
+    memory_planner_->UseAllocationPlanCache(allocation_plan_cache_,
+                                            max_cached_allocation_plans_);
     memory_planner_->PlanAllocations();
   }
 
@@ -668,7 +708,7 @@ TfLiteStatus Interpreter::SetTensorParametersReadOnly(
   }
 
   TfLiteTensor& tensor = context_.tensors[tensor_index];
-  if (type == tensor.type &&
+  if (type == tensor.type && !tensor.sparsity &&
       EqualArrayAndTfLiteIntArray(tensor.dims, rank, dims)) {
     // Fast path which does not invalidate the invokable property.
     TfLiteTensorDataFree(&tensor);
@@ -686,6 +726,69 @@ TfLiteStatus Interpreter::SetTensorParametersReadOnly(
   return kTfLiteOk;
 }
 
+TfLiteStatus Interpreter::SetTensorParametersReadOnlySparse(
+    int tensor_index, TfLiteType type, const char* name,
+    const std::vector<int>& dims, TfLiteQuantizationParams quantization,
+    int block_rows, int block_cols, const std::vector<int>& row_segments,
+    const std::vector<int>& col_indices, const char* buffer, size_t bytes,
+    const Allocation* allocation) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(&context_,
+                "SetTensorParametersReadOnlySparse is disallowed when graph "
+                "is immutable.");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE(&context_,
+                 tensor_index < context_.tensors_size && tensor_index >= 0);
+  TF_LITE_ENSURE(&context_, type != kTfLiteString);
+  TF_LITE_ENSURE(&context_, !dims.empty());
+  TF_LITE_ENSURE(&context_, block_rows > 0 && block_cols > 0);
+
+  // The blocks must tile the tensor viewed as a matrix.
+  const int cols = dims.back();
+  int rows = 1;
+  for (int i = 0; i < dims.size() - 1; ++i) rows *= dims[i];
+  TF_LITE_ENSURE_EQ(&context_, rows % block_rows, 0);
+  TF_LITE_ENSURE_EQ(&context_, cols % block_cols, 0);
+  const int block_grid_rows = rows / block_rows;
+  const int block_grid_cols = cols / block_cols;
+
+  // Every row of blocks must list increasing columns of blocks.
+  TF_LITE_ENSURE_EQ(&context_, row_segments.size(), block_grid_rows + 1);
+  TF_LITE_ENSURE_EQ(&context_, row_segments.front(), 0);
+  TF_LITE_ENSURE_EQ(&context_, row_segments.back(), col_indices.size());
+  for (int i = 0; i < block_grid_rows; ++i) {
+    TF_LITE_ENSURE(&context_, row_segments[i] <= row_segments[i + 1]);
+    for (int j = row_segments[i]; j < row_segments[i + 1]; ++j) {
+      TF_LITE_ENSURE(&context_,
+                     col_indices[j] >= 0 && col_indices[j] < block_grid_cols);
+      TF_LITE_ENSURE(&context_, j == row_segments[i] ||
+                                    col_indices[j - 1] < col_indices[j]);
+    }
+  }
+
+  const int block_dims[] = {static_cast<int>(col_indices.size()), block_rows,
+                            block_cols};
+  size_t required_bytes;
+  TF_LITE_ENSURE_OK(&context_,
+                    BytesRequired(type, block_dims, 3, &required_bytes));
+  TF_LITE_ENSURE_EQ(&context_, required_bytes, bytes);
+
+  TfLiteTensor& tensor = context_.tensors[tensor_index];
+  state_ = kStateUninvokable;
+  TfLiteTensorReset(type, name, ConvertVectorToTfLiteIntArray(dims),
+                    quantization, const_cast<char*>(buffer), bytes,
+                    kTfLiteMmapRo, allocation, &tensor);
+  auto* sparsity =
+      static_cast<TfLiteSparsity*>(malloc(sizeof(TfLiteSparsity)));
+  sparsity->block_rows = block_rows;
+  sparsity->block_cols = block_cols;
+  sparsity->row_segments = ConvertVectorToTfLiteIntArray(row_segments);
+  sparsity->col_indices = ConvertVectorToTfLiteIntArray(col_indices);
+  tensor.sparsity = sparsity;
+  return kTfLiteOk;
+}
+
 // Set description of inputs/outputs/data/fptrs for node `node_index`.
 // This variant assumes an external buffer has been allocated of size
 // bytes. The lifetime of buffer must be ensured to be greater or equal
@@ -718,6 +821,40 @@ TfLiteStatus Interpreter::SetTensorParametersReadWrite(
   return kTfLiteOk;
 }
 
+TfLiteStatus Interpreter::SetTensorPerChannelQuantization(
+    int tensor_index, const std::vector<float>& scales,
+    const std::vector<int>& zero_points, int quantized_dimension) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(&context_,
+                "SetTensorPerChannelQuantization is disallowed when graph is "
+                "immutable.");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE(&context_,
+                 tensor_index < context_.tensors_size && tensor_index >= 0);
+  TfLiteTensor& tensor = context_.tensors[tensor_index];
+  TF_LITE_ENSURE(&context_, tensor.dims != nullptr);
+  TF_LITE_ENSURE(&context_, quantized_dimension >= 0 &&
+                                quantized_dimension < tensor.dims->size);
+  const int num_channels = tensor.dims->data[quantized_dimension];
+  TF_LITE_ENSURE_EQ(&context_, scales.size(), num_channels);
+  TF_LITE_ENSURE_EQ(&context_, zero_points.size(), num_channels);
+
+  TfLiteTensorAffineQuantizationFree(&tensor);
+  auto* quantization = static_cast<TfLiteAffineQuantization*>(
+      malloc(sizeof(TfLiteAffineQuantization)));
+  quantization->scale = TfLiteFloatArrayCreate(num_channels);
+  quantization->zero_point = TfLiteIntArrayCreate(num_channels);
+  for (int i = 0; i < num_channels; ++i) {
+    quantization->scale->data[i] = scales[i];
+    quantization->zero_point->data[i] = zero_points[i];
+  }
+  quantization->quantized_dimension = quantized_dimension;
+  tensor.affine_quantization = quantization;
+  state_ = kStateUninvokable;
+  return kTfLiteOk;
+}
+
 TfLiteStatus Interpreter::SetExecutionPlan(const std::vector<int>& new_plan) {
   for (int node_index : new_plan) {
     TF_LITE_ENSURE(&context_, node_index >= 0 && node_index < nodes_size());
@@ -779,6 +916,48 @@ void Interpreter::SetNumThreads(int num_threads) {
   // be required in order to compile the framework.
   gemm_support::SetNumThreads(&context_, num_threads);
   eigen_support::SetNumThreads(&context_, num_threads);
+  thread_pool_support::SetNumThreads(&context_, num_threads);
+}
+
+TfLiteStatus Interpreter::UseSizeOrderedArenaPlanning(bool enable) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(&context_,
+                "UseSizeOrderedArenaPlanning is disallowed when graph is "
+                "immutable.");
+    return kTfLiteError;
+  }
+  if (enable != size_ordered_arena_planning_) {
+    size_ordered_arena_planning_ = enable;
+    // The tensors point into the arenas of the current planner.
+    memory_planner_.reset();
+    state_ = kStateUninvokable;
+  }
+  return kTfLiteOk;
+}
+
+void Interpreter::UseAllocationPlanCache(bool enable, int max_cached_plans) {
+  allocation_plan_cache_ = enable;
+  max_cached_allocation_plans_ = max_cached_plans;
+  if (memory_planner_) {
+    memory_planner_->UseAllocationPlanCache(enable, max_cached_plans);
+  }
+}
+
+void Interpreter::GetAllocationPlanCacheStats(int* num_cached_plans,
+                                              int64_t* num_hits) const {
+  *num_cached_plans = memory_planner_ ? memory_planner_->NumCachedPlans() : 0;
+  *num_hits = memory_planner_ ? memory_planner_->NumPlanCacheHits() : 0;
+}
+
+void Interpreter::GetArenaBytes(size_t* arena_bytes,
+                                size_t* ideal_arena_bytes) const {
+  *arena_bytes = memory_planner_ ? memory_planner_->ArenaBytes() : 0;
+  *ideal_arena_bytes =
+      memory_planner_ ? memory_planner_->IdealArenaBytes() : 0;
+}
+
+size_t Interpreter::GetPersistentArenaBytes() const {
+  return memory_planner_ ? memory_planner_->PersistentArenaBytes() : 0;
 }
 
 TfLiteStatus Interpreter::ModifyGraphWithDelegate(TfLiteDelegate* delegate,
@@ -22,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/contrib/lite/allocation.h"
+#include "tensorflow/contrib/lite/arena_planner.h"
 #include "tensorflow/contrib/lite/context.h"
 #include "tensorflow/contrib/lite/error_reporter.h"
 #include "tensorflow/contrib/lite/memory_planner.h"
@@ -54,6 +55,10 @@ template <>
 constexpr TfLiteType typeToTfLiteType<bool>() {
   return kTfLiteBool;
 }
+template <>
+constexpr TfLiteType typeToTfLiteType<int8_t>() {
+  return kTfLiteInt8;
+}
 
 // Forward declare since NNAPIDelegate uses Interpreter.
 class NNAPIDelegate;
@@ -154,6 +159,17 @@ class Interpreter {
       const int* dims, TfLiteQuantizationParams quantization,
       const char* buffer, size_t bytes, const Allocation* allocation = nullptr);
 
+  // Like SetTensorParametersReadOnly, for a tensor whose buffer only holds
+  // its non-zero blocks of block_rows x block_cols values, as described by
+  // `row_segments` and `col_indices` (see TfLiteSparsity). `dims` is the
+  // shape of the whole tensor, and `bytes` the size of the blocks.
+  TfLiteStatus SetTensorParametersReadOnlySparse(
+      int tensor_index, TfLiteType type, const char* name,
+      const std::vector<int>& dims, TfLiteQuantizationParams quantization,
+      int block_rows, int block_cols, const std::vector<int>& row_segments,
+      const std::vector<int>& col_indices, const char* buffer, size_t bytes,
+      const Allocation* allocation = nullptr);
+
   // Set description of inputs/outputs/data/fptrs for node `node_index`.
   // This variant assumes an external buffer has been allocated of size
   // bytes. The lifetime of buffer must be ensured to be greater or equal
@@ -168,6 +184,13 @@ class Interpreter {
       int tensor_index, TfLiteType type, const char* name, const int rank,
       const int* dims, TfLiteQuantizationParams quantization);
 
+  // Quantize tensor `tensor_index` per channel: the slice at index i of
+  // dimension `quantized_dimension` uses `scales[i]` and `zero_points[i]`.
+  // Setting the tensor parameters again clears it, so call this after them.
+  TfLiteStatus SetTensorPerChannelQuantization(
+      int tensor_index, const std::vector<float>& scales,
+      const std::vector<int>& zero_points, int quantized_dimension);
+
   // Functions to access tensor data
 
   // Read only access to list of inputs.
@@ -210,6 +233,13 @@ class Interpreter {
     return &context_.tensors[tensor_index];
   }
 
+  // Get an immutable tensor data structure.
+  const TfLiteTensor* tensor(int tensor_index) const {
+    if (tensor_index >= context_.tensors_size || tensor_index < 0)
+      return nullptr;
+    return &context_.tensors[tensor_index];
+  }
+
   // Get a pointer to an operation and registration data structure if in bounds.
   // TODO(aselle): Create a safe ArrayHandle interface to avoid exposing this
   // read/write access to structure
@@ -275,6 +305,38 @@ class Interpreter {
   // Set the number of threads available to the interpreter.
   void SetNumThreads(int num_threads);
 
+  // Enable or disable the size-ordered placement of the intermediate tensors
+  // in the arena (see ArenaPlanningStrategy). It often makes the arena
+  // smaller. Takes effect at the next AllocateTensors().
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus UseSizeOrderedArenaPlanning(bool enable);
+
+  // Enable or disable the cache of the arena plans, keyed by the sizes of the
+  // tensors. With it, AllocateTensors() after resizing the inputs back to
+  // shapes seen before reuses the offsets computed then. The ops are still
+  // prepared again. At most `max_cached_plans` plans are kept, the least
+  // recently used one being evicted first; 0 means no bound.
+  // WARNING: This is an experimental API and subject to change.
+  void UseAllocationPlanCache(bool enable, int max_cached_plans = 0);
+
+  // Returns the number of plans in the cache above, and the number of times
+  // AllocateTensors() restored one of them. Both are zero before
+  // AllocateTensors().
+  // WARNING: This is an experimental API and subject to change.
+  void GetAllocationPlanCacheStats(int* num_cached_plans,
+                                   int64_t* num_hits) const;
+
+  // Returns the size in bytes of the arena holding the intermediate tensors,
+  // and the smallest size any placement of these tensors could achieve, i.e.
+  // the largest total size of the tensors alive at the same time. Both are
+  // zero before AllocateTensors().
+  void GetArenaBytes(size_t* arena_bytes, size_t* ideal_arena_bytes) const;
+
+  // Returns the size in bytes of the arena holding the tensors that persist
+  // across invocations, such as the state of recurrent ops. Zero before
+  // AllocateTensors().
+  size_t GetPersistentArenaBytes() const;
+
   // Allow a delegate to look at the graph and modify the graph to handle
   // parts of the graph themselves. After this is called, the graph may
   // contain new nodes that replace 1 more nodes.
@@ -538,7 +600,14 @@ class Interpreter {
   // Whether to delegate to NN API
   std::unique_ptr<NNAPIDelegate> nnapi_delegate_;
 
-  std::unique_ptr<MemoryPlanner> memory_planner_;
+  std::unique_ptr<ArenaPlanner> memory_planner_;
+
+  // Whether `memory_planner_` uses ArenaPlanningStrategy::kSizeOrdered.
+  bool size_ordered_arena_planning_ = false;
+
+  // The settings of the plan cache of `memory_planner_`.
+  bool allocation_plan_cache_ = false;
+  int max_cached_allocation_plans_ = 0;
 
   bool allow_buffer_handle_output_ = false;
 
@@ -0,0 +1,90 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/interpreter_pool.h"
+
+namespace tflite {
+
+std::unique_ptr<InterpreterPool> InterpreterPool::Create(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    int num_interpreters, int max_waiting, int num_threads) {
+  ErrorReporter* error_reporter = model.error_reporter();
+  if (num_interpreters < 1 || max_waiting < 0) {
+    error_reporter->Report(
+        "InterpreterPool needs at least one interpreter, got %d, and a "
+        "non-negative number of waiting requests, got %d.",
+        num_interpreters, max_waiting);
+    return nullptr;
+  }
+
+  std::unique_ptr<InterpreterPool> pool(
+      new InterpreterPool(max_waiting, error_reporter));
+  InterpreterBuilder builder(model, op_resolver);
+  for (int i = 0; i < num_interpreters; ++i) {
+    std::unique_ptr<Interpreter> interpreter;
+    if (builder(&interpreter, num_threads) != kTfLiteOk) {
+      return nullptr;
+    }
+    if (interpreter->AllocateTensors() != kTfLiteOk) {
+      error_reporter->Report(
+          "Failed to allocate the tensors of interpreter %d.", i);
+      return nullptr;
+    }
+    pool->free_interpreters_.push_back(interpreter.get());
+    pool->interpreters_.push_back(std::move(interpreter));
+  }
+  return pool;
+}
+
+InterpreterPool::InterpreterPool(int max_waiting, ErrorReporter* error_reporter)
+    : max_waiting_(max_waiting), error_reporter_(error_reporter) {}
+
+InterpreterPool::~InterpreterPool() {}
+
+TfLiteStatus InterpreterPool::Run(
+    const std::function<TfLiteStatus(Interpreter*)>& request) {
+  Interpreter* interpreter;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (free_interpreters_.empty()) {
+      if (max_waiting_ > 0 && num_waiting_ >= max_waiting_) {
+        error_reporter_->Report(
+            "InterpreterPool has %d requests waiting already.", num_waiting_);
+        return kTfLiteError;
+      }
+      ++num_waiting_;
+      interpreter_freed_.wait(lock,
+                              [this] { return !free_interpreters_.empty(); });
+      --num_waiting_;
+    }
+    interpreter = free_interpreters_.back();
+    free_interpreters_.pop_back();
+  }
+
+  const TfLiteStatus status = request(interpreter);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_interpreters_.push_back(interpreter);
+  }
+  interpreter_freed_.notify_one();
+  return status;
+}
+
+int InterpreterPool::num_waiting() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_waiting_;
+}
+
+}  // namespace tflite
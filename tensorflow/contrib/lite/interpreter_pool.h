@@ -0,0 +1,94 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// A pool of interpreters of the same model, to run it from several threads.
+//
+// using namespace tflite;
+// auto model = FlatBufferModel::BuildFromFile("interesting_model.tflite");
+// ops::builtin::BuiltinOpResolver resolver;
+// auto pool = InterpreterPool::Create(*model, resolver, /*num_interpreters=*/4,
+//                                     /*max_waiting=*/16);
+// // From any thread:
+// pool->Run([](Interpreter* interpreter) {
+//   .. fill the inputs, Invoke() and read the outputs
+// });
+//
+// An Interpreter is not thread-safe, so each request gets an interpreter of
+// its own for as long as it runs. The interpreters only hold their own
+// intermediate tensors: the constant tensors point into the model, and the
+// kernels share the state they derive from them, such as packed weights.
+#ifndef TENSORFLOW_CONTRIB_LITE_INTERPRETER_POOL_H_
+#define TENSORFLOW_CONTRIB_LITE_INTERPRETER_POOL_H_
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "tensorflow/contrib/lite/error_reporter.h"
+#include "tensorflow/contrib/lite/interpreter.h"
+#include "tensorflow/contrib/lite/model.h"
+
+namespace tflite {
+
+class InterpreterPool {
+ public:
+  // Builds `num_interpreters` interpreters of `model` and allocates their
+  // tensors. Each interpreter uses `num_threads` threads, or the default
+  // number if -1. At most `max_waiting` requests wait for an interpreter, or
+  // any number if 0. Returns nullptr if an interpreter cannot be built.
+  // The caller retains ownership of `model` and `op_resolver`, which must
+  // outlive the pool.
+  static std::unique_ptr<InterpreterPool> Create(
+      const FlatBufferModel& model, const OpResolver& op_resolver,
+      int num_interpreters, int max_waiting = 0, int num_threads = -1);
+
+  ~InterpreterPool();
+
+  InterpreterPool(const InterpreterPool&) = delete;
+  InterpreterPool& operator=(const InterpreterPool&) = delete;
+
+  // Runs `request` with an interpreter no other request is using, waiting
+  // for one to be free, and returns its status. Fails without running
+  // `request` if `max_waiting` requests are already waiting. Thread-safe.
+  //
+  // The interpreter is in the state the previous request left it, so
+  // `request` should fill all the inputs it reads. It may resize them, in
+  // which case it must call AllocateTensors().
+  TfLiteStatus Run(const std::function<TfLiteStatus(Interpreter*)>& request);
+
+  // Returns the number of interpreters.
+  int size() const { return interpreters_.size(); }
+
+  // Returns the number of requests waiting for an interpreter.
+  int num_waiting() const;
+
+ private:
+  InterpreterPool(int max_waiting, ErrorReporter* error_reporter);
+
+  const int max_waiting_;
+  ErrorReporter* error_reporter_;
+  std::vector<std::unique_ptr<Interpreter>> interpreters_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable interpreter_freed_;
+  // The interpreters no request is using.
+  std::vector<Interpreter*> free_interpreters_;
+  int num_waiting_ = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_INTERPRETER_POOL_H_
@@ -0,0 +1,314 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/interpreter_pool.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <future>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/kernels/fully_connected.h"
+#include "tensorflow/contrib/lite/kernels/register.h"
+#include "tensorflow/contrib/lite/schema/schema_generated.h"
+#include "tensorflow/contrib/lite/testing/util.h"
+#include "tensorflow/contrib/lite/version.h"
+
+namespace tflite {
+namespace {
+
+// The model computes x = a + (b + c) and y = d + (b + c), all of shape
+// [1, 8, 8, 3].
+constexpr char kModelPath[] = "tensorflow/contrib/lite/testdata/multi_add.bin";
+constexpr int kNumElements = 8 * 8 * 3;
+
+class InterpreterPoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    model_ = FlatBufferModel::BuildFromFile(kModelPath);
+    ASSERT_TRUE(model_ != nullptr);
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+  ops::builtin::BuiltinOpResolver resolver_;
+};
+
+// Runs the model on inputs filled with `a`, `b`, `c` and `d`, and checks the
+// outputs.
+TfLiteStatus RunMultiAdd(Interpreter* interpreter, float a, float b, float c,
+                         float d) {
+  const float values[] = {a, b, c, d};
+  for (int i = 0; i < 4; ++i) {
+    float* input = interpreter->typed_input_tensor<float>(i);
+    std::fill(input, input + kNumElements, values[i]);
+  }
+  TF_LITE_ENSURE_STATUS(interpreter->Invoke());
+  const float* x = interpreter->typed_output_tensor<float>(0);
+  const float* y = interpreter->typed_output_tensor<float>(1);
+  for (int i = 0; i < kNumElements; ++i) {
+    EXPECT_EQ(x[i], a + b + c);
+    EXPECT_EQ(y[i], d + b + c);
+  }
+  return kTfLiteOk;
+}
+
+TEST_F(InterpreterPoolTest, InvalidArguments) {
+  EXPECT_TRUE(InterpreterPool::Create(*model_, resolver_, 0) == nullptr);
+  EXPECT_TRUE(InterpreterPool::Create(*model_, resolver_, 1, -1) == nullptr);
+}
+
+TEST_F(InterpreterPoolTest, ConcurrentRequests) {
+  auto pool = InterpreterPool::Create(*model_, resolver_,
+                                      /*num_interpreters=*/3);
+  ASSERT_TRUE(pool != nullptr);
+  EXPECT_EQ(pool->size(), 3);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&pool, t]() {
+      for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(pool->Run([t, i](Interpreter* interpreter) {
+          return RunMultiAdd(interpreter, t, i, 0.5f, -t);
+        }),
+                  kTfLiteOk);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(pool->num_waiting(), 0);
+}
+
+TEST_F(InterpreterPoolTest, ConcurrentRequestsHaveOwnTensors) {
+  auto pool = InterpreterPool::Create(*model_, resolver_,
+                                      /*num_interpreters=*/2);
+  ASSERT_TRUE(pool != nullptr);
+
+  // Hold both interpreters at once to compare them.
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::promise<Interpreter*> first;
+  std::thread holder([&]() {
+    pool->Run([&](Interpreter* interpreter) {
+      first.set_value(interpreter);
+      released.wait();
+      return kTfLiteOk;
+    });
+  });
+  Interpreter* first_interpreter = first.get_future().get();
+  EXPECT_EQ(pool->Run([first_interpreter](Interpreter* interpreter) {
+    EXPECT_NE(interpreter, first_interpreter);
+    for (int i = 0; i < interpreter->tensors_size(); ++i) {
+      EXPECT_NE(interpreter->tensor(i)->data.raw,
+                first_interpreter->tensor(i)->data.raw);
+    }
+    return kTfLiteOk;
+  }),
+            kTfLiteOk);
+  release.set_value();
+  holder.join();
+}
+
+TEST_F(InterpreterPoolTest, BoundedWaiting) {
+  auto pool = InterpreterPool::Create(*model_, resolver_,
+                                      /*num_interpreters=*/1,
+                                      /*max_waiting=*/1);
+  ASSERT_TRUE(pool != nullptr);
+
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::promise<void> started;
+  std::thread busy([&]() {
+    EXPECT_EQ(pool->Run([&](Interpreter* interpreter) {
+      started.set_value();
+      released.wait();
+      return RunMultiAdd(interpreter, 1, 2, 3, 4);
+    }),
+              kTfLiteOk);
+  });
+  started.get_future().wait();
+
+  std::thread waiting([&]() {
+    EXPECT_EQ(pool->Run([](Interpreter* interpreter) {
+      return RunMultiAdd(interpreter, 5, 6, 7, 8);
+    }),
+              kTfLiteOk);
+  });
+  while (pool->num_waiting() < 1) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  // The only interpreter is busy and one request waits for it already.
+  bool ran = false;
+  EXPECT_EQ(pool->Run([&ran](Interpreter*) {
+    ran = true;
+    return kTfLiteOk;
+  }),
+            kTfLiteError);
+  EXPECT_FALSE(ran);
+
+  release.set_value();
+  busy.join();
+  waiting.join();
+  EXPECT_EQ(pool->num_waiting(), 0);
+}
+
+TEST_F(InterpreterPoolTest, ReturnsRequestStatus) {
+  auto pool = InterpreterPool::Create(*model_, resolver_,
+                                      /*num_interpreters=*/1);
+  ASSERT_TRUE(pool != nullptr);
+  EXPECT_EQ(pool->Run([](Interpreter*) { return kTfLiteError; }),
+            kTfLiteError);
+  // The interpreter is back in the pool.
+  EXPECT_EQ(pool->Run([](Interpreter* interpreter) {
+    return RunMultiAdd(interpreter, 1, 1, 1, 1);
+  }),
+            kTfLiteOk);
+}
+
+// The tensors of the model built by BuildFullyConnectedModel().
+constexpr int kFcInput = 0;
+constexpr int kFcWeights = 1;
+constexpr int kFcBias = 2;
+constexpr int kFcOutput = 3;
+constexpr int kFcNumInputs = 8;
+constexpr int kFcNumUnits = 4;
+
+// Builds a model with a single fully connected op, of input [1, 8], constant
+// weights whose unit u holds u + 1 everywhere, and a constant bias of 0.5.
+void BuildFullyConnectedModel(flatbuffers::FlatBufferBuilder* builder) {
+  std::vector<float> weights;
+  for (int u = 0; u < kFcNumUnits; ++u) {
+    weights.insert(weights.end(), kFcNumInputs, static_cast<float>(u + 1));
+  }
+  const std::vector<float> bias(kFcNumUnits, 0.5f);
+  auto float_buffer = [builder](const std::vector<float>& values) {
+    return CreateBuffer(
+        *builder,
+        builder->CreateVector(reinterpret_cast<const uint8_t*>(values.data()),
+                              sizeof(float) * values.size()));
+  };
+  // Buffer 0 is the empty buffer of the tensors that are not constant.
+  const std::vector<flatbuffers::Offset<Buffer>> buffers = {
+      CreateBuffer(*builder, builder->CreateVector(std::vector<uint8_t>())),
+      float_buffer(weights), float_buffer(bias)};
+
+  const std::vector<flatbuffers::Offset<Tensor>> tensors = {
+      CreateTensor(*builder, builder->CreateVector<int>({1, kFcNumInputs}),
+                   TensorType_FLOAT32, /*buffer=*/0),
+      CreateTensor(*builder,
+                   builder->CreateVector<int>({kFcNumUnits, kFcNumInputs}),
+                   TensorType_FLOAT32, /*buffer=*/1),
+      CreateTensor(*builder, builder->CreateVector<int>({kFcNumUnits}),
+                   TensorType_FLOAT32, /*buffer=*/2),
+      CreateTensor(*builder, builder->CreateVector<int>({1, kFcNumUnits}),
+                   TensorType_FLOAT32, /*buffer=*/0)};
+  const std::vector<flatbuffers::Offset<Operator>> operators = {CreateOperator(
+      *builder, /*opcode_index=*/0,
+      builder->CreateVector<int32_t>({kFcInput, kFcWeights, kFcBias}),
+      builder->CreateVector<int32_t>({kFcOutput}),
+      BuiltinOptions_FullyConnectedOptions,
+      CreateFullyConnectedOptions(*builder).Union())};
+  const std::vector<flatbuffers::Offset<SubGraph>> subgraphs = {CreateSubGraph(
+      *builder, builder->CreateVector(tensors),
+      builder->CreateVector<int32_t>({kFcInput}),
+      builder->CreateVector<int32_t>({kFcOutput}),
+      builder->CreateVector(operators))};
+  const std::vector<flatbuffers::Offset<OperatorCode>> opcodes = {
+      CreateOperatorCode(*builder, BuiltinOperator_FULLY_CONNECTED)};
+  builder->Finish(CreateModel(*builder, TFLITE_SCHEMA_VERSION,
+                              builder->CreateVector(opcodes),
+                              builder->CreateVector(subgraphs),
+                              builder->CreateString("fully connected"),
+                              builder->CreateVector(buffers)));
+}
+
+// Runs the model of BuildFullyConnectedModel() on an input of ones, checks the
+// output and returns the weights of the op.
+const float* RunFullyConnected(Interpreter* interpreter) {
+  float* input = interpreter->typed_tensor<float>(kFcInput);
+  std::fill(input, input + kFcNumInputs, 1.0f);
+  EXPECT_EQ(interpreter->Invoke(), kTfLiteOk);
+  const float* output = interpreter->typed_tensor<float>(kFcOutput);
+  for (int u = 0; u < kFcNumUnits; ++u) {
+    EXPECT_EQ(output[u], kFcNumInputs * (u + 1) + 0.5f);
+  }
+  return interpreter->typed_tensor<float>(kFcWeights);
+}
+
+TEST(InterpreterPoolFullyConnectedTest, SharesPackedWeights) {
+  flatbuffers::FlatBufferBuilder builder;
+  BuildFullyConnectedModel(&builder);
+  auto model = FlatBufferModel::BuildFromBuffer(
+      reinterpret_cast<const char*>(builder.GetBufferPointer()),
+      builder.GetSize());
+  ASSERT_TRUE(model != nullptr);
+  ops::builtin::BuiltinOpResolver resolver;
+
+  auto pool = InterpreterPool::Create(*model, resolver,
+                                      /*num_interpreters=*/3);
+  ASSERT_TRUE(pool != nullptr);
+  const float* weights = nullptr;
+  for (int i = 0; i < pool->size(); ++i) {
+    EXPECT_EQ(pool->Run([&weights](Interpreter* interpreter) {
+      const float* interpreter_weights = RunFullyConnected(interpreter);
+      if (weights) EXPECT_EQ(interpreter_weights, weights);
+      weights = interpreter_weights;
+      return kTfLiteOk;
+    }),
+              kTfLiteOk);
+  }
+  ASSERT_TRUE(weights != nullptr);
+
+  // The ops of all the interpreters hold the same packed copy.
+  std::weak_ptr<const std::vector<float>> packed =
+      ops::builtin::fully_connected::GetPackedWeights(weights, kFcNumUnits,
+                                                      kFcNumInputs);
+  EXPECT_EQ(packed.use_count(), 3);
+
+  // An interpreter built outside of the pool holds it too, and keeps it once
+  // the pool is gone.
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(InterpreterBuilder(*model, resolver)(&interpreter), kTfLiteOk);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(packed.use_count(), 4);
+  pool.reset();
+  EXPECT_EQ(packed.use_count(), 1);
+  RunFullyConnected(interpreter.get());
+
+  // Once no op holds it, the weights are packed again for the next ones.
+  interpreter.reset();
+  EXPECT_TRUE(packed.expired());
+  pool = InterpreterPool::Create(*model, resolver, /*num_interpreters=*/2);
+  ASSERT_TRUE(pool != nullptr);
+  std::shared_ptr<const std::vector<float>> repacked =
+      ops::builtin::fully_connected::GetPackedWeights(weights, kFcNumUnits,
+                                                      kFcNumInputs);
+  EXPECT_EQ(repacked.use_count(), 3);
+  EXPECT_EQ(pool->Run([](Interpreter* interpreter) {
+    RunFullyConnected(interpreter);
+    return kTfLiteOk;
+  }),
+            kTfLiteOk);
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -253,6 +253,125 @@ TEST(BasicInterpreter, CheckArenaAllocation) {
   ASSERT_LT(interpreter.tensor(9)->data.raw, interpreter.tensor(5)->data.raw);
 }
 
+TEST(BasicInterpreter, CheckSizeOrderedArenaAllocation) {
+  auto arena_bytes = [](bool size_ordered, size_t* ideal_arena_bytes) {
+    Interpreter interpreter;
+    EXPECT_EQ(interpreter.AddTensors(10), kTfLiteOk);
+
+    TfLiteQuantizationParams quant;
+    TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+
+    std::vector<int> sizes{2048, 4096, 1023, 2047, 1021,
+                           2047, 1023, 2046, 1021, 2048};
+    for (int i = 0; i < sizes.size(); ++i) {
+      interpreter.SetTensorParametersReadWrite(i, kTfLiteUInt8, "", {sizes[i]},
+                                               quant);
+    }
+    interpreter.SetInputs({0, 1});
+    interpreter.SetOutputs({9, 4});
+    interpreter.AddNodeWithParameters({0, 1}, {2, 3}, nullptr, 0, nullptr,
+                                      &reg);
+    interpreter.AddNodeWithParameters({2, 1}, {4, 5}, nullptr, 0, nullptr,
+                                      &reg);
+    interpreter.AddNodeWithParameters({4, 3}, {6, 7}, nullptr, 0, nullptr,
+                                      &reg);
+    interpreter.AddNodeWithParameters({6, 5}, {8}, nullptr, 0, nullptr, &reg);
+    interpreter.AddNodeWithParameters({8, 7}, {9}, nullptr, 0, nullptr, &reg);
+
+    EXPECT_EQ(interpreter.UseSizeOrderedArenaPlanning(size_ordered),
+              kTfLiteOk);
+    EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+    size_t arena_bytes;
+    interpreter.GetArenaBytes(&arena_bytes, ideal_arena_bytes);
+    EXPECT_GE(arena_bytes, *ideal_arena_bytes);
+    // None of the tensors persist across invocations.
+    EXPECT_EQ(interpreter.GetPersistentArenaBytes(), 0);
+    return arena_bytes;
+  };
+
+  size_t first_fit_ideal_bytes;
+  size_t size_ordered_ideal_bytes;
+  const size_t first_fit_bytes = arena_bytes(false, &first_fit_ideal_bytes);
+  const size_t size_ordered_bytes =
+      arena_bytes(true, &size_ordered_ideal_bytes);
+  EXPECT_EQ(first_fit_ideal_bytes, size_ordered_ideal_bytes);
+  EXPECT_LE(size_ordered_bytes, first_fit_bytes);
+}
+
+TEST(BasicInterpreter, CheckAllocationPlanCache) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(3), kTfLiteOk);
+  TfLiteQuantizationParams quant;
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.invoke = [](TfLiteContext*, TfLiteNode*) { return kTfLiteOk; };
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {16}, quant),
+              kTfLiteOk);
+  }
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                              &reg),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr,
+                                              &reg),
+            kTfLiteOk);
+  interpreter.UseAllocationPlanCache(true, /*max_cached_plans=*/4);
+
+  // The offsets of the tensors, relative to the input.
+  auto offsets = [&interpreter]() {
+    return std::vector<int64_t>{
+        interpreter.tensor(1)->data.raw - interpreter.tensor(0)->data.raw,
+        interpreter.tensor(2)->data.raw - interpreter.tensor(0)->data.raw};
+  };
+  int num_cached_plans = -1;
+  int64_t num_hits = -1;
+
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {1}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  const std::vector<int64_t> small_offsets = offsets();
+  interpreter.GetAllocationPlanCacheStats(&num_cached_plans, &num_hits);
+  EXPECT_EQ(num_cached_plans, 1);
+  EXPECT_EQ(num_hits, 0);
+
+  // Resizing to the same shape keeps the tensors allocated.
+  char* input_data = interpreter.tensor(0)->data.raw;
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {1}), kTfLiteOk);
+  EXPECT_EQ(interpreter.tensor(0)->data.raw, input_data);
+  EXPECT_EQ(interpreter.Invoke(), kTfLiteOk);
+
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {256}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  const std::vector<int64_t> large_offsets = offsets();
+  EXPECT_NE(small_offsets, large_offsets);
+  interpreter.GetAllocationPlanCacheStats(&num_cached_plans, &num_hits);
+  EXPECT_EQ(num_cached_plans, 2);
+  EXPECT_EQ(num_hits, 0);
+
+  // Coming back to the shapes seen before restores their plans.
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {1}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(offsets(), small_offsets);
+  interpreter.GetAllocationPlanCacheStats(&num_cached_plans, &num_hits);
+  EXPECT_EQ(num_cached_plans, 2);
+  EXPECT_EQ(num_hits, 1);
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {256}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(offsets(), large_offsets);
+  interpreter.GetAllocationPlanCacheStats(&num_cached_plans, &num_hits);
+  EXPECT_EQ(num_cached_plans, 2);
+  EXPECT_EQ(num_hits, 2);
+
+  // A new shape is planned and cached.
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {64}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  interpreter.GetAllocationPlanCacheStats(&num_cached_plans, &num_hits);
+  EXPECT_EQ(num_cached_plans, 3);
+  EXPECT_EQ(num_hits, 2);
+}
+
 TEST(BasicInterpreter, BufferAccess) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(1), kTfLiteOk);
@@ -270,6 +389,149 @@ TEST(BasicInterpreter, BufferAccess) {
   ASSERT_EQ(interpreter.typed_tensor<float>(0), interpreter.tensor(0)->data.f);
 }
 
+TEST(BasicInterpreter, PerChannelQuantization) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(1), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(
+                0, kTfLiteInt8, "", {2, 3}, TfLiteQuantizationParams()),
+            kTfLiteOk);
+  EXPECT_EQ(interpreter.tensor(0)->affine_quantization, nullptr);
+
+  // The number of scales must be the size of the quantized dimension.
+  ASSERT_NE(interpreter.SetTensorPerChannelQuantization(
+                0, {0.5, 0.25}, {0, 0}, /*quantized_dimension=*/1),
+            kTfLiteOk);
+  ASSERT_NE(interpreter.SetTensorPerChannelQuantization(
+                0, {0.5, 0.25}, {0, 0}, /*quantized_dimension=*/2),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.SetTensorPerChannelQuantization(
+                0, {0.5, 0.25}, {0, 0}, /*quantized_dimension=*/0),
+            kTfLiteOk);
+
+  const TfLiteAffineQuantization* quantization =
+      interpreter.tensor(0)->affine_quantization;
+  ASSERT_NE(quantization, nullptr);
+  EXPECT_EQ(quantization->quantized_dimension, 0);
+  ASSERT_EQ(quantization->scale->size, 2);
+  EXPECT_EQ(quantization->scale->data[0], 0.5);
+  EXPECT_EQ(quantization->scale->data[1], 0.25);
+  ASSERT_EQ(quantization->zero_point->size, 2);
+  EXPECT_EQ(quantization->zero_point->data[0], 0);
+
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_NE(interpreter.typed_tensor<int8_t>(0), nullptr);
+
+  // Setting the parameters again clears the per-channel quantization.
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(
+                0, kTfLiteInt8, "", {2, 3}, TfLiteQuantizationParams()),
+            kTfLiteOk);
+  EXPECT_EQ(interpreter.tensor(0)->affine_quantization, nullptr);
+}
+
+TEST(BasicInterpreter, SparseTensor) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(1), kTfLiteOk);
+  // A 4x6 tensor of which two blocks of 2x3 values are stored.
+  static const float blocks[12] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+  const char* buffer = reinterpret_cast<const char*>(blocks);
+  auto set_sparse = [&](const std::vector<int>& dims, int block_rows,
+                        int block_cols, const std::vector<int>& row_segments,
+                        const std::vector<int>& col_indices, size_t bytes) {
+    return interpreter.SetTensorParametersReadOnlySparse(
+        0, kTfLiteFloat32, "", dims, TfLiteQuantizationParams(), block_rows,
+        block_cols, row_segments, col_indices, buffer, bytes);
+  };
+
+  // The blocks must tile the tensor.
+  EXPECT_NE(set_sparse({4, 5}, 2, 3, {0, 1, 2}, {0, 1}, sizeof(blocks)),
+            kTfLiteOk);
+  // There must be one more row segment than rows of blocks.
+  EXPECT_NE(set_sparse({4, 6}, 2, 3, {0, 2}, {0, 1}, sizeof(blocks)),
+            kTfLiteOk);
+  // The columns of blocks must be in range, and increase within a row.
+  EXPECT_NE(set_sparse({4, 6}, 2, 3, {0, 1, 2}, {0, 2}, sizeof(blocks)),
+            kTfLiteOk);
+  EXPECT_NE(set_sparse({4, 6}, 2, 3, {0, 2, 2}, {1, 0}, sizeof(blocks)),
+            kTfLiteOk);
+  // The buffer must hold the blocks.
+  EXPECT_NE(set_sparse({4, 6}, 2, 3, {0, 1, 2}, {0, 1}, 4 * 6 * sizeof(float)),
+            kTfLiteOk);
+
+  ASSERT_EQ(set_sparse({4, 6}, 2, 3, {0, 1, 2}, {0, 1}, sizeof(blocks)),
+            kTfLiteOk);
+  const TfLiteTensor* tensor = interpreter.tensor(0);
+  EXPECT_EQ(tensor->bytes, sizeof(blocks));
+  ASSERT_EQ(tensor->dims->size, 2);
+  EXPECT_EQ(tensor->dims->data[1], 6);
+  const TfLiteSparsity* sparsity = tensor->sparsity;
+  ASSERT_NE(sparsity, nullptr);
+  EXPECT_EQ(sparsity->block_rows, 2);
+  EXPECT_EQ(sparsity->block_cols, 3);
+  ASSERT_EQ(sparsity->row_segments->size, 3);
+  EXPECT_EQ(sparsity->row_segments->data[2], 2);
+  ASSERT_EQ(sparsity->col_indices->size, 2);
+  EXPECT_EQ(sparsity->col_indices->data[1], 1);
+
+  // Setting dense parameters clears the sparsity.
+  static const float values[24] = {0};
+  ASSERT_EQ(interpreter.SetTensorParametersReadOnly(
+                0, kTfLiteFloat32, "", {4, 6}, TfLiteQuantizationParams(),
+                reinterpret_cast<const char*>(values), sizeof(values)),
+            kTfLiteOk);
+  EXPECT_EQ(interpreter.tensor(0)->sparsity, nullptr);
+  EXPECT_EQ(interpreter.tensor(0)->bytes, sizeof(values));
+}
+
+// Builds a graph of one node with the given registration, reading the inputs
+// `inputs` among a dense [4, 6] tensor #0 and a sparse one #1.
+TfLiteStatus AllocateWithSparseInput(const TfLiteRegistration& reg,
+                                     const std::vector<int>& inputs) {
+  Interpreter interpreter;
+  TF_LITE_ENSURE_STATUS(interpreter.AddTensors(3));
+  TF_LITE_ENSURE_STATUS(interpreter.SetTensorParametersReadWrite(
+      0, kTfLiteFloat32, "", {4, 6}, TfLiteQuantizationParams()));
+  static const float blocks[6] = {1, 2, 3, 4, 5, 6};
+  TF_LITE_ENSURE_STATUS(interpreter.SetTensorParametersReadOnlySparse(
+      1, kTfLiteFloat32, "", {4, 6}, TfLiteQuantizationParams(), 2, 3,
+      {0, 1, 1}, {1}, reinterpret_cast<const char*>(blocks), sizeof(blocks)));
+  TF_LITE_ENSURE_STATUS(interpreter.SetTensorParametersReadWrite(
+      2, kTfLiteFloat32, "", {4, 6}, TfLiteQuantizationParams()));
+  TF_LITE_ENSURE_STATUS(interpreter.SetInputs({0}));
+  TF_LITE_ENSURE_STATUS(interpreter.SetOutputs({2}));
+  TF_LITE_ENSURE_STATUS(interpreter.AddNodeWithParameters(inputs, {2}, nullptr,
+                                                          0, nullptr, &reg));
+  return interpreter.AllocateTensors();
+}
+
+TEST(BasicInterpreter, SparseInputOnlyForSparseKernels) {
+  static int num_prepared;
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.prepare = [](TfLiteContext*, TfLiteNode*) {
+    ++num_prepared;
+    return kTfLiteOk;
+  };
+
+  // The ops without a sparse kernel are not even prepared.
+  num_prepared = 0;
+  reg.builtin_code = BuiltinOperator_ADD;
+  EXPECT_EQ(AllocateWithSparseInput(reg, {0, 1}), kTfLiteError);
+  reg.builtin_code = BuiltinOperator_CUSTOM;
+  EXPECT_EQ(AllocateWithSparseInput(reg, {1}), kTfLiteError);
+  EXPECT_EQ(num_prepared, 0);
+
+  // FullyConnected and Conv2D take sparse weights, and only weights.
+  for (BuiltinOperator op :
+       {BuiltinOperator_FULLY_CONNECTED, BuiltinOperator_CONV_2D}) {
+    reg.builtin_code = op;
+    num_prepared = 0;
+    EXPECT_EQ(AllocateWithSparseInput(reg, {0, 1, -1}), kTfLiteOk);
+    EXPECT_EQ(num_prepared, 1);
+    EXPECT_EQ(AllocateWithSparseInput(reg, {1, 0, -1}), kTfLiteError);
+    EXPECT_EQ(num_prepared, 1);
+  }
+}
+
 TEST(BasicInterpreter, NoOpInterpreter) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(1), kTfLiteOk);
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/kernels/internal/tensor.h"
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
 
 namespace tflite {
 namespace ops {
@@ -42,12 +43,14 @@ struct OpData {
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  thread_pool_support::IncrementUsageCounter(context);
   auto* data = new OpData;
   data->requires_broadcast = false;
   return data;
 }
 
 void Free(TfLiteContext* context, void* buffer) {
+  thread_pool_support::DecrementUsageCounter(context);
   delete reinterpret_cast<OpData*>(buffer);
 }
 
@@ -100,7 +103,16 @@ void EvalAddFloat(TfLiteContext* context, TfLiteNode* node,
     if (data->requires_broadcast) {
       TF_LITE_ADD(optimized_ops, BroadcastAdd);
     } else {
-      TF_LITE_ADD(optimized_ops, Add);
+      // Split the elements across the threads.
+      thread_pool_support::ParallelFor(
+          context, NumElements(output), /*cost_per_item=*/1,
+          [&](int start, int end) {
+            const Dims<4> dims = GetTensorDims({end - start});
+            optimized_ops::Add(GetTensorData<float>(input1) + start, dims,
+                               GetTensorData<float>(input2) + start, dims,
+                               output_activation_min, output_activation_max,
+                               GetTensorData<float>(output) + start, dims);
+          });
     }
   }
 #undef TF_LITE_ADD
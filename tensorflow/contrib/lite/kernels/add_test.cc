@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <gtest/gtest.h>
 #include "tensorflow/contrib/lite/interpreter.h"
 #include "tensorflow/contrib/lite/kernels/register.h"
@@ -122,6 +123,27 @@ TEST(FloatAddOpModel, WithBroadcast) {
   }
 }
 
+// Runs an Add of two 1x64x64x32 inputs, large enough for the optimized
+// kernel to split its elements across `num_threads` threads.
+std::vector<float> RunLargeAdd(int num_threads) {
+  const std::vector<int> shape = {1, 64, 64, 32};
+  FloatAddOpModel m({TensorType_FLOAT32, shape}, {TensorType_FLOAT32, shape},
+                    {TensorType_FLOAT32, {}},
+                    ActivationFunctionType_RELU_N1_TO_1);
+  m.SetNumThreads(num_threads);
+  std::vector<float> input = ArbitraryValues(64 * 64 * 32);
+  m.PopulateTensor(m.input1(), input);
+  std::reverse(input.begin(), input.end());
+  m.PopulateTensor(m.input2(), input);
+  m.Invoke();
+  return m.GetOutput();
+}
+
+TEST(FloatAddOpModel, MultithreadedMatchesSingleThreaded) {
+  EXPECT_THAT(RunLargeAdd(/*num_threads=*/4),
+              ElementsAreArray(ArrayFloatNear(RunLargeAdd(/*num_threads=*/1))));
+}
+
 TEST(QuantizedAddOpModel, QuantizedTestsNoActivation) {
   float kQuantizedTolerance = GetTolerance(-1.0, 1.0);
   std::vector<std::initializer_list<float>> inputs1 = {
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/context.h"
 #include "tensorflow/contrib/lite/kernels/activation_functor.h"
 #include "tensorflow/contrib/lite/kernels/internal/kernel_utils.h"
+#include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
 
 namespace tflite {
@@ -38,6 +39,19 @@ constexpr int kBiasTensor = 3;
 constexpr int KHiddenStateTensor = 0;
 constexpr int kOutputTensor = 1;
 
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  // The hybrid kernel needs three temporaries: the quantized input and hidden
+  // state, and the scaling factors. Their ids are consecutive, starting at the
+  // one stored in the user data.
+  auto* scratch_tensor_index = new int;
+  context->AddTensors(context, /*tensors_to_add=*/3, scratch_tensor_index);
+  return scratch_tensor_index;
+}
+
+void Free(TfLiteContext* context, void* buffer) {
+  delete reinterpret_cast<int*>(buffer);
+}
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // Check we have all the inputs and outputs we need.
   TF_LITE_ENSURE_EQ(context, node->inputs->size, 4);
@@ -80,22 +94,59 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context,
                     context->ResizeTensor(context, output, output_size_array));
 
+  // A float input with uint8 weights runs the hybrid kernel, where the weights
+  // hold symmetrically quantized int8 values.
+  const bool is_hybrid = input->type == kTfLiteFloat32 &&
+                         input_weights->type == kTfLiteUInt8;
+  if (is_hybrid) {
+    TF_LITE_ENSURE_EQ(context, recurrent_weights->type, kTfLiteUInt8);
+    TF_LITE_ENSURE_EQ(context, input_weights->params.zero_point, 0);
+    TF_LITE_ENSURE_EQ(context, recurrent_weights->params.zero_point, 0);
+    const int scratch_tensor_index =
+        *reinterpret_cast<int*>(node->user_data);
+    TfLiteIntArrayFree(node->temporaries);
+    node->temporaries = TfLiteIntArrayCreate(3);
+    // The int8 values of the quantized input and hidden state are stored in
+    // uint8 tensors.
+    node->temporaries->data[0] = scratch_tensor_index;
+    TfLiteTensor* input_quantized = GetTemporary(context, node, /*index=*/0);
+    input_quantized->type = kTfLiteUInt8;
+    input_quantized->allocation_type = kTfLiteArenaRw;
+    if (!TfLiteIntArrayEqual(input_quantized->dims, input->dims)) {
+      TfLiteIntArray* input_quantized_size = TfLiteIntArrayCopy(input->dims);
+      TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, input_quantized,
+                                                       input_quantized_size));
+    }
+    node->temporaries->data[1] = scratch_tensor_index + 1;
+    TfLiteTensor* hidden_state_quantized =
+        GetTemporary(context, node, /*index=*/1);
+    hidden_state_quantized->type = kTfLiteUInt8;
+    hidden_state_quantized->allocation_type = kTfLiteArenaRw;
+    if (!TfLiteIntArrayEqual(hidden_state_quantized->dims,
+                             hidden_state->dims)) {
+      TfLiteIntArray* hidden_state_quantized_size =
+          TfLiteIntArrayCopy(hidden_state->dims);
+      TF_LITE_ENSURE_OK(context,
+                        context->ResizeTensor(context, hidden_state_quantized,
+                                              hidden_state_quantized_size));
+    }
+    node->temporaries->data[2] = scratch_tensor_index + 2;
+    TfLiteTensor* scaling_factors = GetTemporary(context, node, /*index=*/2);
+    scaling_factors->type = kTfLiteFloat32;
+    scaling_factors->allocation_type = kTfLiteArenaRw;
+    TfLiteIntArray* scaling_factors_size = TfLiteIntArrayCreate(1);
+    scaling_factors_size->data[0] = batch_size;
+    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scaling_factors,
+                                                     scaling_factors_size));
+  }
+
   return kTfLiteOk;
 }
 
-TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
-  auto* params = reinterpret_cast<TfLiteRNNParams*>(node->builtin_data);
-
-  TfLiteTensor* input = &context->tensors[node->inputs->data[kInputTensor]];
-  TfLiteTensor* input_weights =
-      &context->tensors[node->inputs->data[kWeightsTensor]];
-  TfLiteTensor* recurrent_weights =
-      &context->tensors[node->inputs->data[kRecurrentWeightsTensor]];
-  TfLiteTensor* bias = &context->tensors[node->inputs->data[kBiasTensor]];
-  TfLiteTensor* hidden_state =
-      &context->tensors[node->outputs->data[KHiddenStateTensor]];
-  TfLiteTensor* output = &context->tensors[node->outputs->data[kOutputTensor]];
-
+TfLiteStatus EvalFloat(TfLiteTensor* input, TfLiteTensor* input_weights,
+                       TfLiteTensor* recurrent_weights, TfLiteTensor* bias,
+                       const TfLiteRNNParams* params,
+                       TfLiteTensor* hidden_state, TfLiteTensor* output) {
   // Initialize the pointer bias.
   const float* bias_ptr = bias->data.f;
 
@@ -119,11 +170,73 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   return kTfLiteOk;
 }
 
+TfLiteStatus EvalHybrid(TfLiteTensor* input, TfLiteTensor* input_weights,
+                        TfLiteTensor* recurrent_weights, TfLiteTensor* bias,
+                        const TfLiteRNNParams* params,
+                        TfLiteTensor* input_scratch,
+                        TfLiteTensor* hidden_state_scratch,
+                        TfLiteTensor* scaling_factors,
+                        TfLiteTensor* hidden_state, TfLiteTensor* output) {
+  const int batch_size = input->dims->data[0];
+  const int num_units = input_weights->dims->data[0];
+  const int input_size = input->dims->data[1];
+
+  // The weights and the quantized buffers hold int8 values in uint8 tensors.
+  const int8_t* input_weights_ptr =
+      reinterpret_cast<const int8_t*>(input_weights->data.uint8);
+  const int8_t* recurrent_weights_ptr =
+      reinterpret_cast<const int8_t*>(recurrent_weights->data.uint8);
+  int8_t* quantized_input_ptr =
+      reinterpret_cast<int8_t*>(input_scratch->data.uint8);
+  int8_t* quantized_hidden_state_ptr =
+      reinterpret_cast<int8_t*>(hidden_state_scratch->data.uint8);
+
+  kernel_utils::RnnBatchStep(
+      input->data.f, input_weights_ptr, input_weights->params.scale,
+      recurrent_weights_ptr, recurrent_weights->params.scale, bias->data.f,
+      input_size, num_units, batch_size, params->activation,
+      quantized_input_ptr, quantized_hidden_state_ptr, scaling_factors->data.f,
+      hidden_state->data.f, output->data.f);
+  return kTfLiteOk;
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  auto* params = reinterpret_cast<TfLiteRNNParams*>(node->builtin_data);
+
+  TfLiteTensor* input = &context->tensors[node->inputs->data[kInputTensor]];
+  TfLiteTensor* input_weights =
+      &context->tensors[node->inputs->data[kWeightsTensor]];
+  TfLiteTensor* recurrent_weights =
+      &context->tensors[node->inputs->data[kRecurrentWeightsTensor]];
+  TfLiteTensor* bias = &context->tensors[node->inputs->data[kBiasTensor]];
+  TfLiteTensor* hidden_state =
+      &context->tensors[node->outputs->data[KHiddenStateTensor]];
+  TfLiteTensor* output = &context->tensors[node->outputs->data[kOutputTensor]];
+
+  switch (input_weights->type) {
+    case kTfLiteFloat32:
+      return EvalFloat(input, input_weights, recurrent_weights, bias, params,
+                       hidden_state, output);
+    case kTfLiteUInt8: {
+      TfLiteTensor* input_quantized = GetTemporary(context, node, 0);
+      TfLiteTensor* hidden_state_quantized = GetTemporary(context, node, 1);
+      TfLiteTensor* scaling_factors = GetTemporary(context, node, 2);
+      return EvalHybrid(input, input_weights, recurrent_weights, bias, params,
+                        input_quantized, hidden_state_quantized,
+                        scaling_factors, hidden_state, output);
+    }
+    default:
+      context->ReportError(context, "Type not currently supported.");
+      return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
 }  // namespace rnn
 
 TfLiteRegistration* Register_RNN() {
-  static TfLiteRegistration r = {/*init=*/nullptr, /*free=*/nullptr,
-                                 rnn::Prepare, rnn::Eval};
+  static TfLiteRegistration r = {rnn::Init, rnn::Free, rnn::Prepare,
+                                 rnn::Eval};
   return &r;
 }
 
@@ -20,6 +20,7 @@ limitations under the License.
 #include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <vector>
 
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
@@ -34,6 +35,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
 #include "tensorflow/contrib/lite/kernels/padding.h"
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
 
 namespace tflite {
 namespace ops {
@@ -67,6 +69,13 @@ struct OpData {
   // be represented as a fixed point multiplier plus a left shift.
   int32_t output_multiplier;
   int output_shift;
+  // With a filter of symmetric int8 values, one multiplier and shift per
+  // output channel instead, and the sums of the filter rows.
+  std::vector<int32_t> per_channel_output_multiplier;
+  std::vector<int> per_channel_output_shift;
+  std::vector<int32_t> filter_sums;
+  // The constant filter buffer filter_sums were computed from, if any.
+  const char* filter_sums_source = nullptr;
   // The range of the fused activation layer. For example for kNone and
   // uint8_t these would be 0 and 255.
   int32_t output_activation_min;
@@ -77,6 +86,8 @@ struct OpData {
   int32_t hwcn_weights_index;
   bool need_hwcn_weights;
   bool have_weights_been_transposed;
+  // The constant filter buffer hwcn_weights was transposed from, if any.
+  const char* hwcn_weights_source = nullptr;
   bool need_im2col;
 
   bool run_multithreaded_kernel;
@@ -89,10 +100,12 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   auto* data = new OpData;
   gemm_support::IncrementUsageCounter(context);
   eigen_support::IncrementUsageCounter(context);
+  thread_pool_support::IncrementUsageCounter(context);
   return data;
 }
 
 void Free(TfLiteContext* context, void* buffer) {
+  thread_pool_support::DecrementUsageCounter(context);
   eigen_support::DecrementUsageCounter(context);
   gemm_support::DecrementUsageCounter(context);
   delete reinterpret_cast<OpData*>(buffer);
@@ -146,6 +159,12 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
   // we're running with that data type.
   data->need_hwcn_weights =
       (input->type == kTfLiteFloat32 && data->run_multithreaded_kernel);
+  // Sparse filters are only used by 1x1 convolutions, which are computed as
+  // a fully connected layer on the input pixels, without either.
+  if (filter->sparsity) {
+    data->need_im2col = false;
+    data->need_hwcn_weights = false;
+  }
 
   int temporaries_count = 0;
   if (data->need_im2col) {
@@ -196,7 +215,13 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context,
                  data_type == kTfLiteFloat32 || data_type == kTfLiteUInt8);
   TF_LITE_ENSURE_EQ(context, output->type, data_type);
-  TF_LITE_ENSURE_EQ(context, filter->type, data_type);
+  // Quantized convolutions may also have a filter of symmetric int8 values,
+  // usually quantized per output channel.
+  const bool per_channel =
+      data_type == kTfLiteUInt8 && filter->type == kTfLiteInt8;
+  if (!per_channel) {
+    TF_LITE_ENSURE_EQ(context, filter->type, data_type);
+  }
 
   TfLiteTensor* bias = nullptr;
 
@@ -249,9 +274,34 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   TF_LITE_ENSURE(context, hasBias);
 
+  // A filter that only stores its non-zero blocks is multiplied by every
+  // input pixel, which only works out for 1x1 float convolutions.
+  if (filter->sparsity) {
+    TF_LITE_ENSURE_EQ(context, data_type, kTfLiteFloat32);
+    TF_LITE_ENSURE_EQ(context, filter_width, 1);
+    TF_LITE_ENSURE_EQ(context, filter_height, 1);
+    TF_LITE_ENSURE_EQ(context, params->stride_width, 1);
+    TF_LITE_ENSURE_EQ(context, params->stride_height, 1);
+  }
+
   // Note that quantized inference requires that all tensors have their
   // parameters set. This is usually done during quantized training.
-  if (data_type != kTfLiteFloat32) {
+  if (per_channel) {
+    std::vector<double> real_multipliers;
+    TF_LITE_ENSURE_STATUS(GetPerChannelQuantizedConvolutionMultipliers(
+        context, input, filter, bias, output, /*channel_dim=*/0,
+        &real_multipliers));
+    data->per_channel_output_multiplier.resize(channels_out);
+    data->per_channel_output_shift.resize(channels_out);
+    for (int i = 0; i < channels_out; ++i) {
+      QuantizeMultiplier(real_multipliers[i],
+                         &data->per_channel_output_multiplier[i],
+                         &data->per_channel_output_shift[i]);
+    }
+    CalculateActivationRangeUint8(params->activation, output,
+                                  &data->output_activation_min,
+                                  &data->output_activation_max);
+  } else if (data_type != kTfLiteFloat32) {
     double real_multiplier = 0.0;
     TF_LITE_ENSURE_STATUS(GetQuantizedConvolutionMultipler(
         context, input, filter, bias, output, &real_multiplier));
@@ -304,6 +354,15 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
     TfLiteTensor* hwcn_weights =
         &context->tensors[node->temporaries->data[data->hwcn_weights_index]];
+    // Constant filters are transposed once, here, and kept across Prepare
+    // calls as long as they come from the same buffer.
+    if (IsConstantTensor(filter) && data->have_weights_been_transposed &&
+        data->hwcn_weights_source == filter->data.raw &&
+        hwcn_weights->data.raw &&
+        TfLiteIntArrayEqual(hwcn_weights->dims, hwcn_weights_size)) {
+      TfLiteIntArrayFree(hwcn_weights_size);
+      return kTfLiteOk;
+    }
     hwcn_weights->type = data_type;
     hwcn_weights->allocation_type = kTfLiteDynamic;
     // Make sure we release any previous allocations before we reallocate.
@@ -321,9 +380,13 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
         context->ResizeTensor(context, hwcn_weights, hwcn_weights_size);
     if (hwcn_weights_status != kTfLiteOk) return hwcn_weights_status;
 
-    // TODO(petewarden): If Resize() is called when the size hasn't actually
-    // changed, this will do extra redundant work.
     data->have_weights_been_transposed = false;
+    data->hwcn_weights_source = nullptr;
+    if (IsConstantTensor(filter)) {
+      TransposeFloatTensor(filter, hwcn_weights);
+      data->have_weights_been_transposed = true;
+      data->hwcn_weights_source = filter->data.raw;
+    }
   }
 
   return kTfLiteOk;
@@ -372,6 +435,74 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
   }
 }
 
+template <KernelType kernel_type>
+void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
+                             TfLiteConvParams* params, OpData* data,
+                             TfLiteTensor* input, TfLiteTensor* filter,
+                             TfLiteTensor* bias, TfLiteTensor* im2col,
+                             TfLiteTensor* output) {
+  const int32_t input_offset = -input->params.zero_point;
+  const int32_t output_offset = output->params.zero_point;
+
+  if (kernel_type == kReference) {
+    reference_ops::ConvPerChannel(
+        GetTensorData<uint8_t>(input), GetTensorDims(input), input_offset,
+        GetTensorData<int8_t>(filter), GetTensorDims(filter),
+        GetTensorData<int32_t>(bias), GetTensorDims(bias), params->stride_width,
+        params->stride_height, data->padding.width, data->padding.height,
+        output_offset, data->per_channel_output_multiplier.data(),
+        data->per_channel_output_shift.data(), data->output_activation_min,
+        data->output_activation_max, GetTensorData<uint8_t>(output),
+        GetTensorDims(output));
+    return;
+  }
+
+  // The sums of the filter rows are computed once for a constant filter.
+  const Dims<4> filter_dims = GetTensorDims(filter);
+  const int filter_rows = ArraySize(filter_dims, 3);
+  const int filter_cols = FlatSize(filter_dims) / filter_rows;
+  if (!IsConstantTensor(filter) ||
+      data->filter_sums_source != filter->data.raw) {
+    data->filter_sums.resize(filter_rows);
+    optimized_ops::Int8RowSums(GetTensorData<int8_t>(filter), filter_rows,
+                               filter_cols, data->filter_sums.data());
+    data->filter_sums_source =
+        IsConstantTensor(filter) ? filter->data.raw : nullptr;
+  }
+
+  // The output rows, and their part of the im2col buffer, are split across
+  // the threads.
+  const Dims<4> output_dims = GetTensorDims(output);
+  thread_pool_support::ParallelForOutputRows(
+      context, GetTensorDims(input), output_dims, params->stride_height,
+      data->padding.height, ArraySize(filter_dims, 2),
+      /*cost_per_output_row=*/ArraySize(output_dims, 1) * filter_rows *
+          filter_cols,
+      [&](const thread_pool_support::OutputRows& rows) {
+        uint8_t* im2col_data = nullptr;
+        Dims<4> im2col_dims;
+        if (im2col) {
+          const int output_pixel_offset = rows.output_offset / filter_rows;
+          im2col_data = GetTensorData<uint8_t>(im2col) +
+                        output_pixel_offset * filter_cols;
+          im2col_dims = GetTensorDims(
+              {1, ArraySize(rows.output_dims, 2),
+               ArraySize(rows.output_dims, 1), filter_cols});
+        }
+        optimized_ops::ConvPerChannel(
+            GetTensorData<uint8_t>(input) + rows.input_offset, rows.input_dims,
+            input_offset, GetTensorData<int8_t>(filter), filter_dims,
+            data->filter_sums.data(), GetTensorData<int32_t>(bias),
+            GetTensorDims(bias), params->stride_width, params->stride_height,
+            data->padding.width, rows.pad_height, output_offset,
+            data->per_channel_output_multiplier.data(),
+            data->per_channel_output_shift.data(),
+            data->output_activation_min, data->output_activation_max,
+            GetTensorData<uint8_t>(output) + rows.output_offset,
+            rows.output_dims, im2col_data, im2col_dims);
+      });
+}
+
 template <KernelType kernel_type>
 void EvalFloat(TfLiteContext* context, TfLiteNode* node,
                TfLiteConvParams* params, OpData* data, TfLiteTensor* input,
@@ -447,6 +578,51 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   }
 }
 
+template <KernelType kernel_type>
+void EvalSparse(TfLiteContext* context, TfLiteNode* node,
+                TfLiteConvParams* params, OpData* data, TfLiteTensor* input,
+                TfLiteTensor* filter, TfLiteTensor* bias,
+                TfLiteTensor* output) {
+  float output_activation_min, output_activation_max;
+  CalculateActivationRangeFloat(params->activation, &output_activation_min,
+                                &output_activation_max);
+  // A 1x1 convolution is a fully connected layer whose batches are the input
+  // pixels, which are split across the threads.
+  const TfLiteSparsity* sparsity = filter->sparsity;
+  const int input_depth = input->dims->data[3];
+  const int output_depth = output->dims->data[3];
+  const Dims<4> weights_dims = GetTensorDims({output_depth, input_depth});
+  const int num_pixels = NumElements(output) / output_depth;
+  const int cost_per_pixel =
+      sparsity->col_indices->size * sparsity->block_rows * sparsity->block_cols;
+  thread_pool_support::ParallelFor(
+      context, num_pixels, cost_per_pixel, [&](int start, int end) {
+        const float* input_data =
+            GetTensorData<float>(input) + start * input_depth;
+        float* output_data =
+            GetTensorData<float>(output) + start * output_depth;
+        const Dims<4> input_dims = GetTensorDims({end - start, input_depth});
+        const Dims<4> output_dims = GetTensorDims({end - start, output_depth});
+        if (kernel_type == kReference) {
+          reference_ops::SparseFullyConnected(
+              input_data, input_dims, GetTensorData<float>(filter),
+              weights_dims, sparsity->block_rows, sparsity->block_cols,
+              sparsity->row_segments->data, sparsity->col_indices->data,
+              GetTensorData<float>(bias), GetTensorDims(bias),
+              output_activation_min, output_activation_max, output_data,
+              output_dims);
+        } else {
+          optimized_ops::SparseFullyConnected(
+              input_data, input_dims, GetTensorData<float>(filter),
+              weights_dims, sparsity->block_rows, sparsity->block_cols,
+              sparsity->row_segments->data, sparsity->col_indices->data,
+              GetTensorData<float>(bias), GetTensorDims(bias),
+              output_activation_min, output_activation_max, output_data,
+              output_dims);
+        }
+      });
+}
+
 template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   auto* params = reinterpret_cast<TfLiteConvParams*>(node->builtin_data);
@@ -467,7 +643,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           ? &context->tensors[node->temporaries->data[data->hwcn_weights_index]]
           : nullptr;
 
-  if (data->need_hwcn_weights && !data->have_weights_been_transposed) {
+  // Filters that are not constant may change between invocations.
+  if (data->need_hwcn_weights &&
+      (!data->have_weights_been_transposed || !IsConstantTensor(filter))) {
     TransposeFloatTensor(filter, hwcn_weights);
     data->have_weights_been_transposed = true;
   }
@@ -476,7 +654,10 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   // separate ops to avoid dispatch overhead here.
   switch (input->type) {  // Already know in/outtypes are same.
     case kTfLiteFloat32:
-      if (data->run_multithreaded_kernel) {
+      if (filter->sparsity) {
+        EvalSparse<kernel_type>(context, node, params, data, input, filter,
+                                bias, output);
+      } else if (data->run_multithreaded_kernel) {
         EvalFloat<kernel_type>(context, node, params, data, input, filter, bias,
                                im2col, hwcn_weights, output);
       } else {
@@ -485,8 +666,13 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       }
       break;
     case kTfLiteUInt8:
-      EvalQuantized<kernel_type>(context, node, params, data, input, filter,
-                                 bias, im2col, hwcn_weights, output);
+      if (filter->type == kTfLiteInt8) {
+        EvalQuantizedPerChannel<kernel_type>(context, node, params, data, input,
+                                             filter, bias, im2col, output);
+      } else {
+        EvalQuantized<kernel_type>(context, node, params, data, input, filter,
+                                   bias, im2col, hwcn_weights, output);
+      }
       break;
     default:
       context->ReportError(context, "Type not currently supported.");
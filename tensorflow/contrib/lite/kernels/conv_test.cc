@@ -60,6 +60,10 @@ class BaseConvolutionOpModel : public SingleOpModel {
       // training.
       auto bias_scale = GetScale(input_) * GetScale(filter_);
       TensorData bias{TensorType_INT32, {bias_size}, 0, 0, bias_scale};
+      // A filter quantized per output channel has one bias scale per channel.
+      for (float filter_scale : filter.per_channel_scales) {
+        bias.per_channel_scales.push_back(GetScale(input_) * filter_scale);
+      }
       bias_ = AddInput(bias);
     }
 
@@ -376,6 +380,72 @@ TEST_P(ConvolutionOpTest, HandCalculatedValidFloat32) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray({312, 357}));
 }
 
+// A float 1x1 convolution whose constant filter only stores its non-zero
+// blocks.
+class SparseConvolutionOpModel : public SingleOpModel {
+ public:
+  SparseConvolutionOpModel(TfLiteRegistration* registration,
+                           std::initializer_list<int> input_shape,
+                           std::initializer_list<int> filter_shape,
+                           std::initializer_list<float> filter, int block_rows,
+                           int block_cols) {
+    input_ = AddInput({TensorType_FLOAT32, input_shape});
+    filter_ = AddSparseConstInput(filter, filter_shape, block_rows, block_cols);
+    bias_ = AddInput({TensorType_FLOAT32, {GetShape(filter_)[0]}});
+    output_ = AddOutput({TensorType_FLOAT32, {}});
+
+    SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(builder_, Padding_SAME, /*stride_w=*/1,
+                                     /*stride_h=*/1,
+                                     ActivationFunctionType_RELU)
+                     .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(BuiltinOperator_CONV_2D,
+                                                    registration);
+    BuildInterpreter({GetShape(input_), GetShape(filter_), GetShape(bias_)});
+  }
+
+  void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
+  void SetInput(std::initializer_list<float> f) { PopulateTensor(input_, f); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int input_;
+  int filter_;
+  int bias_;
+  int output_;
+};
+
+TEST_P(ConvolutionOpTest, SparseFilterFloat32) {
+  SparseConvolutionOpModel m(GetRegistration(), /*input_shape=*/{2, 1, 3, 4},
+                             /*filter_shape=*/{3, 1, 1, 4},
+                             {
+                                 1, -1, 0, 0,   // first output channel
+                                 0, 0, 0, 0,    // second output channel
+                                 0, 0, 2, 0.5,  // third output channel
+                             },
+                             /*block_rows=*/1, /*block_cols=*/2);
+  m.SetBias({1, -2, 0});
+  m.SetInput({
+      1, 2, 3, 4,      // b = 0, x = 0
+      0, 1, 0, 1,      // b = 0, x = 1
+      -1, -2, -3, -4,  // b = 0, x = 2
+      4, 3, 2, 1,      // b = 1, x = 0
+      2, 2, 2, 2,      // b = 1, x = 1
+      1, 0, -1, 0,     // b = 1, x = 2
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 0, 0, 8,    //
+                                 0, 0, 0.5,  //
+                                 2, 0, 0,    //
+                                 2, 0, 4.5,  //
+                                 1, 0, 5,    //
+                                 2, 0, 0,    //
+                             })));
+}
+
 class QuantizedConvolutionOpModel : public BaseConvolutionOpModel {
  public:
   using BaseConvolutionOpModel::BaseConvolutionOpModel;
@@ -441,6 +511,101 @@ TEST_P(ConvolutionOpTest, SimpleTestQuantized) {
                              }));
 }
 
+// A uint8 model whose int8 filter has one scale per output channel.
+class PerChannelQuantizedConvolutionOpModel
+    : public QuantizedConvolutionOpModel {
+ public:
+  using QuantizedConvolutionOpModel::QuantizedConvolutionOpModel;
+
+  void SetFilter(std::initializer_list<float> data) {
+    PerChannelQuantizeAndPopulate<int8_t>(filter_, data);
+  }
+
+  void SetBias(std::initializer_list<float> data) {
+    PerChannelQuantizeAndPopulate<int32_t>(bias_, data);
+  }
+};
+
+// The filter scales are chosen so that the filter is quantized exactly, and
+// the results match those of SimpleTestQuantized.
+TEST_P(ConvolutionOpTest, SimpleTestPerChannelQuantized) {
+  PerChannelQuantizedConvolutionOpModel m(
+      GetRegistration(), {TensorType_UINT8, {2, 2, 4, 1}, -63.5, 64},
+      {TensorType_INT8,
+       {3, 2, 2, 1},
+       0,
+       0,
+       0,
+       0,
+       /*per_channel_scales=*/{1.0f / 16, 1.0f / 64, 1.0f / 64},
+       /*quantized_dimension=*/0},
+      {TensorType_UINT8, {}, -127, 128});
+  m.SetInput({
+      // First batch
+      1, 1, 1, 1,  // row = 1
+      2, 2, 2, 2,  // row = 2
+      // Second batch
+      1, 2, 3, 4,  // row = 1
+      1, 2, 3, 4,  // row = 2
+  });
+  m.SetFilter({
+      1, 2, 3, 4,    // first 2x2 filter
+      -1, 1, -1, 1,  // second 2x2 filter
+      -1, -1, 1, 1,  // third 2x2 filter
+  });
+  m.SetBias({1, 2, 3});
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {
+                      18, 2, 5,  // first batch, left
+                      18, 2, 5,  // first batch, right
+                      17, 4, 3,  // second batch, left
+                      37, 4, 3,  // second batch, right
+                  },
+                  1e-5)));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({
+                                 145, 129, 132,  //
+                                 145, 129, 132,  //
+                                 144, 131, 130,  //
+                                 164, 131, 130,  //
+                             }));
+}
+
+// Stride 1 and SAME padding, where the input zero point pads the borders.
+TEST_P(ConvolutionOpTest, PerChannelQuantizedWithPadding) {
+  PerChannelQuantizedConvolutionOpModel m(
+      GetRegistration(), {TensorType_UINT8, {1, 2, 3, 1}, -63.5, 64},
+      {TensorType_INT8,
+       {2, 2, 2, 1},
+       0,
+       0,
+       0,
+       0,
+       /*per_channel_scales=*/{1.0f / 32, 1.0f / 8},
+       /*quantized_dimension=*/0},
+      {TensorType_UINT8, {}, -127, 128}, /*stride_width=*/1,
+      /*stride_height=*/1, Padding_SAME);
+  m.SetInput({
+      1, 2, 3,  // row = 1
+      4, 5, 6,  // row = 2
+  });
+  m.SetFilter({
+      1, 2, 3, 2,      // first 2x2 filter
+      -4, 8, 12, -16,  // second 2x2 filter
+  });
+  m.SetBias({1, -2});
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetDequantizedOutput(), ElementsAreArray(ArrayFloatNear({
+                                            28, -22, 36, -22, 22, 58,  //
+                                            15, 22, 18, 26, 7, -26,    //
+                                        })));
+}
+
 TEST_P(ConvolutionOpTest, SimpleTestQuantizedWithAnisotropicStrides) {
   QuantizedConvolutionOpModel m(GetRegistration(),
                                 {TensorType_UINT8, {1, 3, 6, 1}, -63.5, 64},
@@ -19,6 +19,7 @@ limitations under the License.
 #include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <vector>
 
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
 #include "tensorflow/contrib/lite/kernels/padding.h"
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
 
 namespace tflite {
 namespace ops {
@@ -55,6 +57,10 @@ struct OpData {
   // be represented as a fixed point multiplier plus a left shift.
   int32_t output_multiplier;
   int output_shift;
+  // With a filter of symmetric int8 values, one multiplier and shift per
+  // output channel instead.
+  std::vector<int32_t> per_channel_output_multiplier;
+  std::vector<int> per_channel_output_shift;
   // The range of the fused activation layer. For example for kNone and
   // uint8_t these would be 0 and 255.
   int32_t output_activation_min;
@@ -65,10 +71,12 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   // This is a builtin op, so we don't use the contents in 'buffer', if any.
   // Instead, we allocate a new object to carry information from Prepare() to
   // Eval().
+  thread_pool_support::IncrementUsageCounter(context);
   return new OpData;
 }
 
 void Free(TfLiteContext* context, void* buffer) {
+  thread_pool_support::DecrementUsageCounter(context);
   delete reinterpret_cast<OpData*>(buffer);
 }
 
@@ -103,7 +111,13 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context,
                  data_type == kTfLiteFloat32 || data_type == kTfLiteUInt8);
   TF_LITE_ENSURE_EQ(context, output->type, data_type);
-  TF_LITE_ENSURE_EQ(context, filter->type, data_type);
+  // Quantized convolutions may also have a filter of symmetric int8 values,
+  // usually quantized per output channel.
+  const bool per_channel =
+      data_type == kTfLiteUInt8 && filter->type == kTfLiteInt8;
+  if (!per_channel) {
+    TF_LITE_ENSURE_EQ(context, filter->type, data_type);
+  }
 
   if (hasBias) {
     bias = GetInput(context, node, kBiasTensor);
@@ -147,7 +161,22 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   // Note that quantized inference requires that all tensors have their
   // parameters set. This is usually done during quantized training.
-  if (data_type != kTfLiteFloat32) {
+  if (per_channel) {
+    std::vector<double> real_multipliers;
+    TF_LITE_ENSURE_STATUS(GetPerChannelQuantizedConvolutionMultipliers(
+        context, input, filter, bias, output, /*channel_dim=*/3,
+        &real_multipliers));
+    data->per_channel_output_multiplier.resize(channels_out);
+    data->per_channel_output_shift.resize(channels_out);
+    for (int i = 0; i < channels_out; ++i) {
+      QuantizeMultiplier(real_multipliers[i],
+                         &data->per_channel_output_multiplier[i],
+                         &data->per_channel_output_shift[i]);
+    }
+    CalculateActivationRangeUint8(params->activation, output,
+                                  &data->output_activation_min,
+                                  &data->output_activation_max);
+  } else if (data_type != kTfLiteFloat32) {
     double real_multiplier = 0.0;
     TF_LITE_ENSURE_STATUS(GetQuantizedConvolutionMultipler(
         context, input, filter, bias, output, &real_multiplier));
@@ -175,22 +204,37 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   CalculateActivationRangeFloat(params->activation, &output_activation_min,
                                 &output_activation_max);
 
-  void (*depthwise_conv)(const float*, const Dims<4>&, const float*,
-                         const Dims<4>&, const float*, const Dims<4>&, int, int,
-                         int, int, int, float, float, float*, const Dims<4>&);
   if (kernel_type == kReference) {
-    depthwise_conv = &reference_ops::DepthwiseConv;
-  } else {
-    depthwise_conv = &optimized_ops::DepthwiseConv;
+    reference_ops::DepthwiseConv(
+        GetTensorData<float>(input), GetTensorDims(input),
+        GetTensorData<float>(filter), GetTensorDims(filter),
+        GetTensorData<float>(bias), GetTensorDims(bias), params->stride_width,
+        params->stride_height, data->padding.width, data->padding.height,
+        params->depth_multiplier, output_activation_min, output_activation_max,
+        GetTensorData<float>(output), GetTensorDims(output));
+    return;
   }
 
-  depthwise_conv(
-      GetTensorData<float>(input), GetTensorDims(input),
-      GetTensorData<float>(filter), GetTensorDims(filter),
-      GetTensorData<float>(bias), GetTensorDims(bias), params->stride_width,
-      params->stride_height, data->padding.width, data->padding.height,
-      params->depth_multiplier, output_activation_min, output_activation_max,
-      GetTensorData<float>(output), GetTensorDims(output));
+  // The optimized kernel splits the output rows across the threads.
+  const Dims<4> output_dims = GetTensorDims(output);
+  const Dims<4> filter_dims = GetTensorDims(filter);
+  const int cost_per_output_row =
+      ArraySize(output_dims, 0) * ArraySize(output_dims, 1) *
+      ArraySize(filter_dims, 1) * ArraySize(filter_dims, 2);
+  thread_pool_support::ParallelForOutputRows(
+      context, GetTensorDims(input), output_dims, params->stride_height,
+      data->padding.height, ArraySize(filter_dims, 2), cost_per_output_row,
+      [&](const thread_pool_support::OutputRows& rows) {
+        optimized_ops::DepthwiseConv(
+            GetTensorData<float>(input) + rows.input_offset, rows.input_dims,
+            GetTensorData<float>(filter), filter_dims,
+            GetTensorData<float>(bias), GetTensorDims(bias),
+            params->stride_width, params->stride_height, data->padding.width,
+            rows.pad_height, params->depth_multiplier, output_activation_min,
+            output_activation_max,
+            GetTensorData<float>(output) + rows.output_offset,
+            rows.output_dims);
+      });
 }
 
 template <KernelType kernel_type>
@@ -223,6 +267,53 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
       GetTensorDims(output));
 }
 
+template <KernelType kernel_type>
+void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
+                             TfLiteDepthwiseConvParams* params, OpData* data,
+                             TfLiteTensor* input, TfLiteTensor* filter,
+                             TfLiteTensor* bias, TfLiteTensor* output) {
+  const int32_t input_offset = -input->params.zero_point;
+  const int32_t output_offset = output->params.zero_point;
+
+  if (kernel_type == kReference) {
+    reference_ops::DepthwiseConvPerChannel(
+        GetTensorData<uint8_t>(input), GetTensorDims(input), input_offset,
+        GetTensorData<int8_t>(filter), GetTensorDims(filter),
+        GetTensorData<int32_t>(bias), GetTensorDims(bias), params->stride_width,
+        params->stride_height, data->padding.width, data->padding.height,
+        params->depth_multiplier, output_offset,
+        data->per_channel_output_multiplier.data(),
+        data->per_channel_output_shift.data(), data->output_activation_min,
+        data->output_activation_max, GetTensorData<uint8_t>(output),
+        GetTensorDims(output));
+    return;
+  }
+
+  // As for floats, the optimized kernel splits the output rows across the
+  // threads.
+  const Dims<4> output_dims = GetTensorDims(output);
+  const Dims<4> filter_dims = GetTensorDims(filter);
+  const int cost_per_output_row =
+      ArraySize(output_dims, 0) * ArraySize(output_dims, 1) *
+      ArraySize(filter_dims, 1) * ArraySize(filter_dims, 2);
+  thread_pool_support::ParallelForOutputRows(
+      context, GetTensorDims(input), output_dims, params->stride_height,
+      data->padding.height, ArraySize(filter_dims, 2), cost_per_output_row,
+      [&](const thread_pool_support::OutputRows& rows) {
+        optimized_ops::DepthwiseConvPerChannel(
+            GetTensorData<uint8_t>(input) + rows.input_offset, rows.input_dims,
+            input_offset, GetTensorData<int8_t>(filter), filter_dims,
+            GetTensorData<int32_t>(bias), GetTensorDims(bias),
+            params->stride_width, params->stride_height, data->padding.width,
+            rows.pad_height, params->depth_multiplier, output_offset,
+            data->per_channel_output_multiplier.data(),
+            data->per_channel_output_shift.data(),
+            data->output_activation_min, data->output_activation_max,
+            GetTensorData<uint8_t>(output) + rows.output_offset,
+            rows.output_dims);
+      });
+}
+
 template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   auto* params =
@@ -243,8 +334,13 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                              output);
       break;
     case kTfLiteUInt8:
-      EvalQuantized<kernel_type>(context, node, params, data, input, filter,
-                                 bias, output);
+      if (filter->type == kTfLiteInt8) {
+        EvalQuantizedPerChannel<kernel_type>(context, node, params, data, input,
+                                             filter, bias, output);
+      } else {
+        EvalQuantized<kernel_type>(context, node, params, data, input, filter,
+                                   bias, output);
+      }
       break;
     default:
       context->ReportError(context, "Type not currently supported.");
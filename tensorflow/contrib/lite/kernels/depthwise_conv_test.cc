@@ -30,7 +30,9 @@ class BaseDepthwiseConvolutionOpModel : public SingleOpModel {
   // stride values.
   BaseDepthwiseConvolutionOpModel(const TensorData& input,
                                   const TensorData& filter,
-                                  const TensorData& output) {
+                                  const TensorData& output,
+                                  Padding padding = Padding_VALID,
+                                  int stride = 1) {
     input_ = AddInput(input);
     filter_ = AddInput(filter);
 
@@ -43,6 +45,10 @@ class BaseDepthwiseConvolutionOpModel : public SingleOpModel {
       // training.
       auto bias_scale = GetScale(input_) * GetScale(filter_);
       TensorData bias{TensorType_INT32, {bias_size}, 0, 0, bias_scale};
+      // A filter quantized per output channel has one bias scale per channel.
+      for (float filter_scale : filter.per_channel_scales) {
+        bias.per_channel_scales.push_back(GetScale(input_) * filter_scale);
+      }
       bias_ = AddInput(bias);
     }
 
@@ -61,8 +67,8 @@ class BaseDepthwiseConvolutionOpModel : public SingleOpModel {
     SetBuiltinOp(
         BuiltinOperator_DEPTHWISE_CONV_2D,
         BuiltinOptions_DepthwiseConv2DOptions,
-        CreateDepthwiseConv2DOptions(builder_, Padding_VALID, 1, 1, depth_mul,
-                                     ActivationFunctionType_NONE)
+        CreateDepthwiseConv2DOptions(builder_, padding, stride, stride,
+                                     depth_mul, ActivationFunctionType_NONE)
             .Union());
 
     BuildInterpreter({GetShape(input_), GetShape(filter_), GetShape(bias_)});
@@ -80,12 +86,17 @@ class DepthwiseConvolutionOpModel : public BaseDepthwiseConvolutionOpModel {
   using BaseDepthwiseConvolutionOpModel::BaseDepthwiseConvolutionOpModel;
 
   void SetFilter(std::initializer_list<float> f) { PopulateTensor(filter_, f); }
+  void SetFilter(const std::vector<float>& f) { PopulateTensor(filter_, f); }
 
   void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
+  void SetBias(const std::vector<float>& f) { PopulateTensor(bias_, f); }
 
   void SetInput(std::initializer_list<float> data) {
     PopulateTensor(input_, data);
   }
+  void SetInput(const std::vector<float>& data) {
+    PopulateTensor(input_, data);
+  }
 
   std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
 };
@@ -116,6 +127,35 @@ TEST(DepthwiseConvolutionOpTest, SimpleTest) {
                              }));
 }
 
+// Runs a 3x3 depthwise convolution of depth multiplier 2 on a 2x64x64x8 input,
+// large enough for the optimized kernel to split its output rows across
+// `num_threads` threads.
+std::vector<float> RunLargeDepthwiseConv(Padding padding, int stride,
+                                         int num_threads) {
+  DepthwiseConvolutionOpModel m({TensorType_FLOAT32, {2, 64, 64, 8}},
+                                {TensorType_FLOAT32, {1, 3, 3, 16}},
+                                {TensorType_FLOAT32, {}}, padding, stride);
+  m.SetNumThreads(num_threads);
+  m.SetInput(ArbitraryValues(2 * 64 * 64 * 8));
+  m.SetFilter(ArbitraryValues(3 * 3 * 16));
+  m.SetBias(ArbitraryValues(16));
+  m.Invoke();
+  return m.GetOutput();
+}
+
+TEST(DepthwiseConvolutionOpTest, MultithreadedMatchesSingleThreaded) {
+  // With SAME padding, the rows of the first thread are padded at the top and
+  // those of the last one at the bottom.
+  for (Padding padding : {Padding_VALID, Padding_SAME}) {
+    for (int stride : {1, 2}) {
+      EXPECT_THAT(RunLargeDepthwiseConv(padding, stride, /*num_threads=*/4),
+                  ElementsAreArray(ArrayFloatNear(RunLargeDepthwiseConv(
+                      padding, stride, /*num_threads=*/1))))
+          << EnumNamePadding(padding) << ", stride " << stride;
+    }
+  }
+}
+
 class QuantizedDepthwiseConvolutionOpModel
     : public BaseDepthwiseConvolutionOpModel {
  public:
@@ -176,6 +216,64 @@ TEST(QuantizedDepthwiseConvolutionOpTest, SimpleTestQuantized) {
                              }));
 }
 
+// A uint8 model whose int8 filter has one scale per output channel.
+class PerChannelQuantizedDepthwiseConvolutionOpModel
+    : public QuantizedDepthwiseConvolutionOpModel {
+ public:
+  using QuantizedDepthwiseConvolutionOpModel::
+      QuantizedDepthwiseConvolutionOpModel;
+
+  void SetFilter(std::initializer_list<float> data) {
+    PerChannelQuantizeAndPopulate<int8_t>(filter_, data);
+  }
+
+  void SetBias(std::initializer_list<float> data) {
+    PerChannelQuantizeAndPopulate<int32_t>(bias_, data);
+  }
+};
+
+// The filter scales are chosen so that the filter is quantized exactly, and
+// the results match those of SimpleTestQuantized.
+TEST(QuantizedDepthwiseConvolutionOpTest, SimpleTestPerChannelQuantized) {
+  PerChannelQuantizedDepthwiseConvolutionOpModel m(
+      {TensorType_UINT8, {1, 3, 2, 2}, -63.5, 64},
+      {TensorType_INT8,
+       {1, 2, 2, 4},
+       0,
+       0,
+       0,
+       0,
+       /*per_channel_scales=*/{1.0f / 8, 1.0f / 8, 1.0f / 8, 1.0f / 4},
+       /*quantized_dimension=*/3},
+      {TensorType_UINT8, {}, -127, 128});
+
+  m.SetInput({
+      1, 2, 7, 8,    // column 1
+      3, 4, 9, 10,   // column 2
+      5, 6, 11, 12,  // column 3
+  });
+  m.SetFilter({
+      1, 2, 3, 4,        //
+      -9, 10, -11, 12,   //
+      5, 6, 7, 8,        //
+      13, -14, 15, -16,  //
+  });
+  m.SetBias({1, 2, 3, 4});
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetDequantizedOutput(), ElementsAreArray(ArrayFloatNear(
+                                            {
+                                                71, -34, 99, -20,  //
+                                                91, -26, 127, -4,  //
+                                            },
+                                            1e-5)));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({
+                                 198, 93, 226, 107,   //
+                                 218, 101, 254, 123,  //
+                             }));
+}
+
 }  // namespace
 }  // namespace tflite
 
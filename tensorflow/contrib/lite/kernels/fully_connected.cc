@@ -20,10 +20,16 @@ limitations under the License.
 #include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <tuple>
+#include <vector>
 
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
 #include "tensorflow/contrib/lite/kernels/activation_functor.h"
+#include "tensorflow/contrib/lite/kernels/fully_connected.h"
 #include "tensorflow/contrib/lite/kernels/gemm_support.h"
 #include "tensorflow/contrib/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/quantization_util.h"
@@ -46,15 +52,33 @@ enum KernelType {
   kPie,  // Used by the PIE team
 };
 
+const int kTensorNotAllocated = -1;
+
 struct OpData {
   // The scaling factor from input to output (aka the 'real multiplier') can
   // be represented as a fixed point multiplier plus a left shift.
   int32_t output_multiplier;
   int output_shift;
+  // With weights of symmetric int8 values, one multiplier and shift per
+  // output unit instead, and the sums of the rows of the weights.
+  std::vector<int32_t> per_channel_output_multiplier;
+  std::vector<int> per_channel_output_shift;
+  std::vector<int32_t> filter_sums;
+  // The constant weights buffer filter_sums were computed from, if any.
+  const char* filter_sums_source = nullptr;
   // The range of the fused activation layer. For example for kNone and
   // uint8_t these would be 0 and 255.
   int32_t output_activation_min;
   int32_t output_activation_max;
+  // IDs of the temporaries of the hybrid kernel, which runs float inputs
+  // against symmetric int8 weights: the quantized input and the per-batch
+  // scaling factors.
+  int input_quantized_id = kTensorNotAllocated;
+  int scaling_factors_id = kTensorNotAllocated;
+  // Constant float weights, packed once in Prepare for the optimized kernels
+  // (see tensor_utils::PackMatrix), and the buffer they were packed from.
+  std::shared_ptr<const std::vector<float>> packed_weights;
+  const char* packed_weights_source = nullptr;
 };
 
 constexpr int kInputTensor = 0;
@@ -62,6 +86,38 @@ constexpr int kWeightsTensor = 1;
 constexpr int kBiasTensor = 2;
 constexpr int kOutputTensor = 0;
 
+// Beyond this batch size the GEMM based kernels are faster than multiplying
+// the packed weights by one input vector at a time.
+constexpr int kMaxBatchSizeForPackedWeights = 8;
+
+// Interpreters built from the same model map the same weights, so they share a
+// single packed copy instead of each packing its own.
+std::shared_ptr<const std::vector<float>> GetPackedWeights(
+    const float* weights, int rows, int cols) {
+  using Key = std::tuple<const float*, int, int>;
+  static std::mutex* mutex = new std::mutex;
+  static auto* cache =
+      new std::map<Key, std::weak_ptr<const std::vector<float>>>;
+  std::lock_guard<std::mutex> lock(*mutex);
+
+  std::weak_ptr<const std::vector<float>>& entry =
+      (*cache)[Key(weights, rows, cols)];
+  std::shared_ptr<const std::vector<float>> packed = entry.lock();
+  if (packed) return packed;
+
+  auto* new_packed =
+      new std::vector<float>(tensor_utils::PackedMatrixSize(rows, cols));
+  tensor_utils::PackMatrix(weights, rows, cols, new_packed->data());
+  packed.reset(new_packed);
+  entry = packed;
+
+  // Forget the weights no op uses anymore.
+  for (auto it = cache->begin(); it != cache->end();) {
+    it = it->second.expired() ? cache->erase(it) : std::next(it);
+  }
+  return packed;
+}
+
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   // This is a builtin op, so we don't use the contents in 'buffer', if any.
   // Instead, we allocate a new object to carry information from Prepare() to
@@ -75,6 +131,7 @@ void Free(TfLiteContext* context, void* buffer) {
   delete reinterpret_cast<OpData*>(buffer);
 }
 
+template <KernelType kernel_type>
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   auto* params =
       reinterpret_cast<TfLiteFullyConnectedParams*>(node->builtin_data);
@@ -107,10 +164,88 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumDimensions(filter), 2);
   TF_LITE_ENSURE_EQ(context, NumDimensions(bias), 1);
 
+  // Weights that only store their non-zero blocks run the sparse kernel,
+  // which only exists for floats.
+  if (filter->sparsity) {
+    TF_LITE_ENSURE_EQ(context, input->type, kTfLiteFloat32);
+    TF_LITE_ENSURE_EQ(context, filter->type, kTfLiteFloat32);
+  }
+
+  // A float input with uint8 or int8 weights runs the hybrid kernel. The
+  // weights hold symmetrically quantized int8 values, or their bit patterns,
+  // so their zero point must be 0. Int8 weights may be quantized per unit.
+  const bool is_hybrid =
+      input->type == kTfLiteFloat32 &&
+      (filter->type == kTfLiteUInt8 || filter->type == kTfLiteInt8);
+  if (is_hybrid) {
+    if (filter->affine_quantization) {
+      const TfLiteAffineQuantization* quantization =
+          filter->affine_quantization;
+      TF_LITE_ENSURE_EQ(context, quantization->quantized_dimension, 0);
+      TF_LITE_ENSURE_EQ(context, quantization->scale->size, num_units);
+      for (int i = 0; i < num_units; ++i) {
+        TF_LITE_ENSURE_EQ(context, quantization->zero_point->data[i], 0);
+      }
+    } else {
+      TF_LITE_ENSURE_EQ(context, filter->params.zero_point, 0);
+    }
+    TF_LITE_ENSURE_EQ(context, output->type, kTfLiteFloat32);
+    // Note: `context->AddTensors` might invalidate pointers to existing
+    // tensors, so fetch them again afterwards.
+    if (data->input_quantized_id == kTensorNotAllocated) {
+      context->AddTensors(context, 1, &data->input_quantized_id);
+    }
+    if (data->scaling_factors_id == kTensorNotAllocated) {
+      context->AddTensors(context, 1, &data->scaling_factors_id);
+    }
+    TfLiteIntArrayFree(node->temporaries);
+    node->temporaries = TfLiteIntArrayCreate(2);
+    node->temporaries->data[0] = data->input_quantized_id;
+    node->temporaries->data[1] = data->scaling_factors_id;
+
+    input = GetInput(context, node, kInputTensor);
+    filter = GetInput(context, node, kWeightsTensor);
+    output = GetOutput(context, node, kOutputTensor);
+
+    // The int8 values of the quantized input are stored in a uint8 tensor.
+    TfLiteTensor* input_quantized = GetTemporary(context, node, /*index=*/0);
+    input_quantized->type = kTfLiteUInt8;
+    input_quantized->allocation_type = kTfLiteArenaRw;
+    if (!TfLiteIntArrayEqual(input_quantized->dims, input->dims)) {
+      TfLiteIntArray* input_quantized_size = TfLiteIntArrayCopy(input->dims);
+      TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, input_quantized,
+                                                       input_quantized_size));
+    }
+    TfLiteTensor* scaling_factors = GetTemporary(context, node, /*index=*/1);
+    scaling_factors->type = kTfLiteFloat32;
+    scaling_factors->allocation_type = kTfLiteArenaRw;
+    TfLiteIntArray* scaling_factors_size = TfLiteIntArrayCreate(1);
+    scaling_factors_size->data[0] = batch_size;
+    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scaling_factors,
+                                                     scaling_factors_size));
+  }
+
   // Note that quantized inference requires that all tensors have their
   // parameters set. This is usually done during quantized training.
   TfLiteType data_type = input->type;
-  if (data_type != kTfLiteFloat32) {
+  const bool per_channel =
+      data_type == kTfLiteUInt8 && filter->type == kTfLiteInt8;
+  if (per_channel) {
+    std::vector<double> real_multipliers;
+    TF_LITE_ENSURE_STATUS(GetPerChannelQuantizedConvolutionMultipliers(
+        context, input, filter, bias, output, /*channel_dim=*/0,
+        &real_multipliers));
+    data->per_channel_output_multiplier.resize(num_units);
+    data->per_channel_output_shift.resize(num_units);
+    for (int i = 0; i < num_units; ++i) {
+      QuantizeMultiplier(real_multipliers[i],
+                         &data->per_channel_output_multiplier[i],
+                         &data->per_channel_output_shift[i]);
+    }
+    CalculateActivationRangeUint8(params->activation, output,
+                                  &data->output_activation_min,
+                                  &data->output_activation_max);
+  } else if (data_type != kTfLiteFloat32) {
     double real_multiplier = 0.0;
     TF_LITE_ENSURE_STATUS(GetQuantizedConvolutionMultipler(
         context, input, filter, bias, output, &real_multiplier));
@@ -121,6 +256,22 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                                   &data->output_activation_max);
   }
 
+  // Constant float weights are packed once, instead of having the GEMM re-pack
+  // them on every invocation. Weights are only constant if they are memory
+  // mapped from the model, but their buffer can still be replaced, hence the
+  // check of the source.
+  if (kernel_type != kReference && !is_hybrid && !filter->sparsity &&
+      filter->type == kTfLiteFloat32 && IsConstantTensor(filter)) {
+    if (data->packed_weights_source != filter->data.raw) {
+      data->packed_weights =
+          GetPackedWeights(filter->data.f, num_units, filter->dims->data[1]);
+      data->packed_weights_source = filter->data.raw;
+    }
+  } else {
+    data->packed_weights.reset();
+    data->packed_weights_source = nullptr;
+  }
+
   // Resize output.
   TfLiteIntArray* output_size_array = TfLiteIntArrayCreate(2);
   output_size_array->data[0] = batch_size;
@@ -163,6 +314,148 @@ TfLiteStatus EvalPie(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+TfLiteStatus EvalPacked(TfLiteContext* context, TfLiteNode* node,
+                        TfLiteFullyConnectedParams* params, OpData* data,
+                        TfLiteTensor* input, TfLiteTensor* filter,
+                        TfLiteTensor* bias, TfLiteTensor* output) {
+  int total_input_size = 1;
+  for (int i = 0; i < input->dims->size; i++) {
+    total_input_size *= input->dims->data[i];
+  }
+
+  const int input_size = filter->dims->data[1];
+  const int batch_size = total_input_size / filter->dims->data[1];
+  const int num_units = filter->dims->data[0];
+
+  // Output = bias if bias tensor exists.
+  if (bias) {
+    tensor_utils::VectorBatchVectorAssign(bias->data.f, num_units, batch_size,
+                                          output->data.f);
+  } else {
+    tensor_utils::ZeroVector(output->data.f, batch_size * num_units);
+  }
+
+  // Compute output += packed_weight * input
+  tensor_utils::PackedMatrixBatchVectorMultiplyAccumulate(
+      data->packed_weights->data(), num_units, input_size, input->data.f,
+      batch_size, output->data.f, /*result_stride=*/1);
+
+  // Apply activation function
+  tensor_utils::ApplyActivationToVector(output->data.f, batch_size * num_units,
+                                        params->activation, output->data.f);
+
+  return kTfLiteOk;
+}
+
+TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
+                        TfLiteFullyConnectedParams* params, OpData* data,
+                        TfLiteTensor* input, TfLiteTensor* filter,
+                        TfLiteTensor* bias, TfLiteTensor* input_quantized,
+                        TfLiteTensor* scaling_factors, TfLiteTensor* output) {
+  int total_input_size = 1;
+  for (int i = 0; i < input->dims->size; i++) {
+    total_input_size *= input->dims->data[i];
+  }
+
+  const int input_size = filter->dims->data[1];
+  const int batch_size = total_input_size / filter->dims->data[1];
+  const int num_units = filter->dims->data[0];
+
+  // Weights quantized per unit are scaled, and get their bias, after the
+  // multiplication.
+  const TfLiteAffineQuantization* per_unit_quantization =
+      filter->affine_quantization;
+
+  // Output = bias if bias tensor exists.
+  if (bias && !per_unit_quantization) {
+    tensor_utils::VectorBatchVectorAssign(bias->data.f, num_units, batch_size,
+                                          output->data.f);
+  } else {
+    tensor_utils::ZeroVector(output->data.f, batch_size * num_units);
+  }
+
+  // Quantize every batch of the input, and fold the scale of the weights into
+  // the scaling factor of the batch.
+  const float* input_ptr = input->data.f;
+  int8_t* quant_data = reinterpret_cast<int8_t*>(input_quantized->data.uint8);
+  float* scaling_factors_ptr = scaling_factors->data.f;
+  float unused_min, unused_max;
+  for (int b = 0; b < batch_size; ++b) {
+    const int offset = b * input_size;
+    tensor_utils::SymmetricQuantizeFloats(
+        input_ptr + offset, input_size, quant_data + offset, &unused_min,
+        &unused_max, &scaling_factors_ptr[b]);
+    if (!per_unit_quantization) {
+      scaling_factors_ptr[b] *= filter->params.scale;
+    }
+  }
+
+  // Compute output += weight * quantized_input
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      reinterpret_cast<int8_t*>(filter->data.raw), num_units, input_size,
+      quant_data, scaling_factors_ptr, batch_size, output->data.f,
+      /*result_stride=*/1);
+
+  if (per_unit_quantization) {
+    const float* unit_scales = per_unit_quantization->scale->data;
+    for (int b = 0; b < batch_size; ++b) {
+      float* output_ptr = output->data.f + b * num_units;
+      for (int i = 0; i < num_units; ++i) {
+        output_ptr[i] *= unit_scales[i];
+        if (bias) output_ptr[i] += bias->data.f[i];
+      }
+    }
+  }
+
+  // Apply activation function to floats.
+  tensor_utils::ApplyActivationToVector(output->data.f, batch_size * num_units,
+                                        params->activation, output->data.f);
+  return kTfLiteOk;
+}
+
+template <KernelType kernel_type>
+TfLiteStatus EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
+                                     TfLiteFullyConnectedParams* params,
+                                     OpData* data, TfLiteTensor* input,
+                                     TfLiteTensor* filter, TfLiteTensor* bias,
+                                     TfLiteTensor* output) {
+  const int32_t input_offset = -input->params.zero_point;
+  const int32_t output_offset = output->params.zero_point;
+  if (kernel_type == kReference) {
+    reference_ops::FullyConnectedPerChannel(
+        GetTensorData<uint8_t>(input), GetTensorDims(input), input_offset,
+        GetTensorData<int8_t>(filter), GetTensorDims(filter),
+        GetTensorData<int32_t>(bias), GetTensorDims(bias), output_offset,
+        data->per_channel_output_multiplier.data(),
+        data->per_channel_output_shift.data(), data->output_activation_min,
+        data->output_activation_max, GetTensorData<uint8_t>(output),
+        GetTensorDims(output));
+    return kTfLiteOk;
+  }
+
+  // The sums of the rows of the weights are computed once for constant
+  // weights.
+  const int num_units = filter->dims->data[0];
+  if (!IsConstantTensor(filter) ||
+      data->filter_sums_source != filter->data.raw) {
+    data->filter_sums.resize(num_units);
+    optimized_ops::Int8RowSums(GetTensorData<int8_t>(filter), num_units,
+                               filter->dims->data[1], data->filter_sums.data());
+    data->filter_sums_source =
+        IsConstantTensor(filter) ? filter->data.raw : nullptr;
+  }
+  optimized_ops::FullyConnectedPerChannel(
+      GetTensorData<uint8_t>(input), GetTensorDims(input), input_offset,
+      GetTensorData<int8_t>(filter), GetTensorDims(filter),
+      data->filter_sums.data(), GetTensorData<int32_t>(bias),
+      GetTensorDims(bias), output_offset,
+      data->per_channel_output_multiplier.data(),
+      data->per_channel_output_shift.data(), data->output_activation_min,
+      data->output_activation_max, GetTensorData<uint8_t>(output),
+      GetTensorDims(output));
+  return kTfLiteOk;
+}
+
 #define TF_LITE_MACRO_DISPATCH(macro_name, params, target_namespace) \
   if (params->activation == kTfLiteActNone) {                        \
     macro_name(target_namespace, kNone);                             \
@@ -206,11 +499,50 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+template <KernelType kernel_type>
+TfLiteStatus EvalSparse(TfLiteContext* context, TfLiteNode* node,
+                        TfLiteFullyConnectedParams* params, OpData* data,
+                        TfLiteTensor* input, TfLiteTensor* filter,
+                        TfLiteTensor* bias, TfLiteTensor* output) {
+  float output_activation_min, output_activation_max;
+  CalculateActivationRangeFloat(params->activation, &output_activation_min,
+                                &output_activation_max);
+  const TfLiteSparsity* sparsity = filter->sparsity;
+#define TF_LITE_SPARSE_FULLY_CONNECTED(type)                                \
+  type::SparseFullyConnected(                                               \
+      GetTensorData<float>(input), GetTensorDims(input),                    \
+      GetTensorData<float>(filter), GetTensorDims(filter),                  \
+      sparsity->block_rows, sparsity->block_cols,                           \
+      sparsity->row_segments->data, sparsity->col_indices->data,            \
+      GetTensorData<float>(bias), GetTensorDims(bias),                      \
+      output_activation_min, output_activation_max,                         \
+      GetTensorData<float>(output), GetTensorDims(output))
+  if (kernel_type == kReference) {
+    TF_LITE_SPARSE_FULLY_CONNECTED(reference_ops);
+  } else {
+    TF_LITE_SPARSE_FULLY_CONNECTED(optimized_ops);
+  }
+#undef TF_LITE_SPARSE_FULLY_CONNECTED
+  return kTfLiteOk;
+}
+
 template <KernelType kernel_type>
 TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
                        TfLiteFullyConnectedParams* params, OpData* data,
                        TfLiteTensor* input, TfLiteTensor* filter,
                        TfLiteTensor* bias, TfLiteTensor* output) {
+  if (filter->sparsity) {
+    return EvalSparse<kernel_type>(context, node, params, data, input, filter,
+                                   bias, output);
+  }
+  if (data->packed_weights_source == filter->data.raw) {
+    const int batch_size = NumElements(input) / filter->dims->data[1];
+    if (kernel_type == kPie || batch_size <= kMaxBatchSizeForPackedWeights) {
+      return EvalPacked(context, node, params, data, input, filter, bias,
+                        output);
+    }
+  }
+
   float output_activation_min, output_activation_max;
   CalculateActivationRangeFloat(params->activation, &output_activation_min,
                                 &output_activation_max);
@@ -247,9 +579,20 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 
   switch (input->type) {  // Already know in/out types are same.
     case kTfLiteFloat32:
+      if (filter->type == kTfLiteUInt8 || filter->type == kTfLiteInt8) {
+        TfLiteTensor* input_quantized = GetTemporary(context, node, 0);
+        TfLiteTensor* scaling_factors = GetTemporary(context, node, 1);
+        return EvalHybrid(context, node, params, data, input, filter, bias,
+                          input_quantized, scaling_factors, output);
+      }
       return EvalFloat<kernel_type>(context, node, params, data, input, filter,
                                     bias, output);
     case kTfLiteUInt8:
+      if (filter->type == kTfLiteInt8) {
+        return EvalQuantizedPerChannel<kernel_type>(context, node, params, data,
+                                                    input, filter, bias,
+                                                    output);
+      }
       return EvalQuantized<kernel_type>(context, node, params, data, input,
                                         filter, bias, output);
     default:
@@ -263,29 +606,33 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 
 TfLiteRegistration* Register_FULLY_CONNECTED_REF() {
   static TfLiteRegistration r = {
-      fully_connected::Init, fully_connected::Free, fully_connected::Prepare,
+      fully_connected::Init, fully_connected::Free,
+      fully_connected::Prepare<fully_connected::kReference>,
       fully_connected::Eval<fully_connected::kReference>};
   return &r;
 }
 
 TfLiteRegistration* Register_FULLY_CONNECTED_NEON_OPT() {
   static TfLiteRegistration r = {
-      fully_connected::Init, fully_connected::Free, fully_connected::Prepare,
+      fully_connected::Init, fully_connected::Free,
+      fully_connected::Prepare<fully_connected::kNeonOptimized>,
       fully_connected::Eval<fully_connected::kNeonOptimized>};
   return &r;
 }
 
 TfLiteRegistration* Register_FULLY_CONNECTED_GENERIC_OPT() {
   static TfLiteRegistration r = {
-      fully_connected::Init, fully_connected::Free, fully_connected::Prepare,
+      fully_connected::Init, fully_connected::Free,
+      fully_connected::Prepare<fully_connected::kGenericOptimized>,
       fully_connected::Eval<fully_connected::kGenericOptimized>};
   return &r;
 }
 
 TfLiteRegistration* Register_FULLY_CONNECTED_PIE() {
-  static TfLiteRegistration r = {fully_connected::Init, fully_connected::Free,
-                                 fully_connected::Prepare,
-                                 fully_connected::Eval<fully_connected::kPie>};
+  static TfLiteRegistration r = {
+      fully_connected::Init, fully_connected::Free,
+      fully_connected::Prepare<fully_connected::kPie>,
+      fully_connected::Eval<fully_connected::kPie>};
   return &r;
 }
 
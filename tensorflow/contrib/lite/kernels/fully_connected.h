@@ -0,0 +1,38 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_KERNELS_FULLY_CONNECTED_H_
+#define TENSORFLOW_CONTRIB_LITE_KERNELS_FULLY_CONNECTED_H_
+
+#include <memory>
+#include <vector>
+
+namespace tflite {
+namespace ops {
+namespace builtin {
+namespace fully_connected {
+
+// Returns the packed copy (see tensor_utils::PackMatrix) of the constant
+// `rows` x `cols` float weights at `weights`. The copy is shared by all the
+// ops holding it, across interpreters, and is packed again once none does.
+// Thread-safe.
+std::shared_ptr<const std::vector<float>> GetPackedWeights(
+    const float* weights, int rows, int cols);
+
+}  // namespace fully_connected
+}  // namespace builtin
+}  // namespace ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_KERNELS_FULLY_CONNECTED_H_
@@ -224,6 +224,181 @@ class QuantizedFullyConnectedOpModel : public BaseFullyConnectedOpModel {
   }
 };
 
+// A uint8 model whose int8 weights have one scale per output unit.
+class PerChannelQuantizedFullyConnectedOpModel : public SingleOpModel {
+ public:
+  PerChannelQuantizedFullyConnectedOpModel(
+      TfLiteRegistration* registration, int units, int batches,
+      const TensorData& input, const std::vector<float>& weights_scales,
+      const TensorData& output) {
+    const int input_size = input.shape.back();
+    input_ = AddInput(input);
+    weights_ = AddInput({TensorType_INT8, {units, input_size}, 0, 0, 0, 0,
+                         weights_scales, /*quantized_dimension=*/0});
+    TensorData bias{TensorType_INT32, {units}};
+    for (float weights_scale : weights_scales) {
+      bias.per_channel_scales.push_back(GetScale(input_) * weights_scale);
+    }
+    bias_ = AddInput(bias);
+    output_ = AddOutput(output);
+
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, ActivationFunctionType_RELU)
+            .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)});
+  }
+
+  void SetBias(std::initializer_list<float> data) {
+    PerChannelQuantizeAndPopulate<int32_t>(bias_, data);
+  }
+  void SetWeights(std::initializer_list<float> data) {
+    PerChannelQuantizeAndPopulate<int8_t>(weights_, data);
+  }
+  void SetInput(std::initializer_list<float> data) {
+    QuantizeAndPopulate<uint8_t>(input_, data);
+  }
+
+  std::vector<uint8_t> GetOutput() { return ExtractVector<uint8_t>(output_); }
+  std::vector<float> GetDequantizedOutput() {
+    return Dequantize<uint8_t>(ExtractVector<uint8_t>(output_),
+                               GetScale(output_), GetZeroPoint(output_));
+  }
+
+ private:
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+};
+
+// A float model whose weights are a constant of the model, which lets the
+// kernels pack them once at Prepare time.
+class ConstWeightsFullyConnectedOpModel : public SingleOpModel {
+ public:
+  ConstWeightsFullyConnectedOpModel(TfLiteRegistration* registration, int units,
+                                    int batches, int input_size,
+                                    std::initializer_list<float> weights) {
+    input_ = AddInput({TensorType_FLOAT32, {batches, input_size}});
+    weights_ =
+        AddConstInput(TensorType_FLOAT32, weights, {units, input_size});
+    bias_ = AddInput({TensorType_FLOAT32, {units}});
+    output_ = AddOutput({TensorType_FLOAT32});
+
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, ActivationFunctionType_RELU)
+            .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)});
+  }
+
+  void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
+  void SetInput(std::initializer_list<float> f) { PopulateTensor(input_, f); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+};
+
+// A float model whose constant weights only store their non-zero blocks.
+class SparseFullyConnectedOpModel : public SingleOpModel {
+ public:
+  SparseFullyConnectedOpModel(TfLiteRegistration* registration, int units,
+                              int batches, int input_size,
+                              std::initializer_list<float> weights,
+                              int block_rows, int block_cols) {
+    input_ = AddInput({TensorType_FLOAT32, {batches, input_size}});
+    weights_ = AddSparseConstInput(weights, {units, input_size}, block_rows,
+                                   block_cols);
+    bias_ = AddInput({TensorType_FLOAT32, {units}});
+    output_ = AddOutput({TensorType_FLOAT32});
+
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, ActivationFunctionType_RELU)
+            .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)});
+  }
+
+  void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
+  void SetInput(std::initializer_list<float> f) { PopulateTensor(input_, f); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  int GetWeightsBytes() { return interpreter_->tensor(weights_)->bytes; }
+
+ private:
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+};
+
+// In the hybrid model the weights are quantized (to uint8). But the bias,
+// input (and output) are expected to be in float precision.
+class HybridFullyConnectedOpModel : public SingleOpModel {
+ public:
+  HybridFullyConnectedOpModel(TfLiteRegistration* registration, int units,
+                              int batches, const TensorData& input,
+                              const TensorData& weights,
+                              const TensorData& output = {TensorType_FLOAT32})
+      : batches_(batches), units_(units) {
+    int total_input_size = 1;
+    for (int i = 0; i < input.shape.size(); ++i) {
+      total_input_size *= input.shape[i];
+    }
+    input_size_ = total_input_size / batches_;
+
+    input_ = AddInput(input);
+    weights_ = AddInput(weights);
+
+    TensorData bias{TensorType_FLOAT32, {units_}};
+    bias_ = AddInput(bias);
+
+    output_ = AddOutput(output);
+
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, ActivationFunctionType_RELU)
+            .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)});
+  }
+  void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
+  void SetWeights(std::initializer_list<float> data) {
+    SymmetricQuantizeAndPopulate(weights_, data);
+  }
+  // For int8 weights added with one scale per unit.
+  void SetPerChannelWeights(std::initializer_list<float> data) {
+    PerChannelQuantizeAndPopulate<int8_t>(weights_, data);
+  }
+
+  void SetInput(std::initializer_list<float> f) { PopulateTensor(input_, f); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+  int input_size() { return input_size_; }
+  int num_units() { return units_; }
+  int num_batches() { return batches_; }
+
+ protected:
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+
+  int batches_;
+  int units_;
+  int input_size_;
+};
+
 const auto kKernelMap = new std::map<string, TfLiteRegistration*>({
     {"Reference", ops::builtin::Register_FULLY_CONNECTED_REF()},
     {"NeonOptimized", ops::builtin::Register_FULLY_CONNECTED_NEON_OPT()},
@@ -288,6 +463,186 @@ TEST_P(FullyConnectedOpTest, SimpleTestQuantized) {
   EXPECT_THAT(m.GetOutput(), ElementsAre(151, 152, 153, 185, 186, 187));
 }
 
+// The weights scales are chosen so that the weights are quantized exactly,
+// and the results match those of SimpleTestQuantized.
+TEST_P(FullyConnectedOpTest, SimpleTestPerChannelQuantized) {
+  PerChannelQuantizedFullyConnectedOpModel m(
+      GetRegistration(), /*units=*/3, /*batches=*/2,
+      /*input=*/{TensorType_UINT8, {2, 10}, -63.5, 64},
+      /*weights_scales=*/{1.0f / 8, 1.0f / 4, 1.0f / 2},
+      /*output=*/{TensorType_UINT8, {}, -127, 128});
+
+  m.SetWeights({
+      1, 2, 3, 4, 5, 6, 7, 8, 9, 10,  // u = 0
+      1, 2, 3, 4, 5, 6, 7, 8, 9, 10,  // u = 1
+      1, 2, 3, 4, 5, 6, 7, 8, 9, 10,  // u = 2
+  });
+  m.SetBias({1, 2, 3});
+
+  m.SetInput({
+      1, 2, 3, 4, 5, 6, 7, 8,  -9, -10,  // b = 0
+      1, 2, 3, 4, 5, 6, 7, -8, 9,  -10,  // b = 1
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetDequantizedOutput(), ElementsAreArray(ArrayFloatNear({
+                                            24, 25, 26,  //
+                                            58, 59, 60,  //
+                                        })));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(151, 152, 153, 185, 186, 187));
+}
+
+TEST_P(FullyConnectedOpTest, SimpleTestConstantWeights) {
+  // 5 units do not fill a whole number of panels of packed weights.
+  ConstWeightsFullyConnectedOpModel m(GetRegistration(), /*units=*/5,
+                                      /*batches=*/2, /*input_size=*/10,
+                                      {
+                                          1, 2, 3, 4, 5, 6, 7, 8, 9, 10,  //
+                                          1, 2, 3, 4, 5, 6, 7, 8, 9, 10,  //
+                                          1, 2, 3, 4, 5, 6, 7, 8, 9, 10,  //
+                                          1, 1, 1, 1, 1, -1, -1, -1, -1, -1,
+                                          1, 0, 0, 0, 0, 0, 0, 0, 0, 0,  //
+                                      });
+  m.SetBias({1, 2, 3, 4, 5});
+
+  m.SetInput({
+      1, 2, 3, 4, 5, 6, 7, 8,  -9, -10,  // b = 0
+      1, 2, 3, 4, 5, 6, 7, -8, 9,  -10,  // b = 1
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                 {24, 25, 26, 17, 6, 58, 59, 60, 15, 6})));
+
+  // Running again reuses the packed weights.
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                 {24, 25, 26, 17, 6, 58, 59, 60, 15, 6})));
+}
+
+TEST_P(FullyConnectedOpTest, SimpleTestSparseWeights) {
+  SparseFullyConnectedOpModel m(GetRegistration(), /*units=*/3, /*batches=*/2,
+                                /*input_size=*/8,
+                                {
+                                    1, 2, 3, 4, 0, 0, 0, 0,    //
+                                    0, 0, 0, 0, 0, 0, 0, 0,    //
+                                    0, 0, 0, 0, 1, -1, 2, -3,  //
+                                },
+                                /*block_rows=*/1, /*block_cols=*/4);
+  // Only two of the six blocks are stored.
+  EXPECT_EQ(m.GetWeightsBytes(), 2 * 4 * sizeof(float));
+  m.SetBias({1, 2, 3});
+
+  m.SetInput({
+      1, 1, 1, 1, 1, 1, 1, 1,  // b = 0
+      1, 2, 3, 4, 5, 6, 7, 8,  // b = 1
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({11, 2, 2, 31, 2, 0})));
+}
+
+TEST_P(FullyConnectedOpTest, SparseWeightsWithSquareBlocks) {
+  // More batches than the optimized kernel processes at once.
+  SparseFullyConnectedOpModel m(GetRegistration(), /*units=*/4, /*batches=*/5,
+                                /*input_size=*/6,
+                                {
+                                    1, 2, 0, 0, 0, 1,    //
+                                    3, -1, 0, 0, 0, 0,   //
+                                    0, 0, 2, 0, 0, 0,    //
+                                    0, 0, 1, -2, 0, 0,   //
+                                },
+                                /*block_rows=*/2, /*block_cols=*/2);
+  EXPECT_EQ(m.GetWeightsBytes(), 3 * 2 * 2 * sizeof(float));
+  m.SetBias({0, 1, -1, 0.5});
+
+  m.SetInput({
+      1, 2, 3, 4, 5, 6,           // b = 0
+      -1, 0, 1, 0, -1, 0,         // b = 1
+      2, 2, 2, 2, 2, 2,           // b = 2
+      0.5, -0.5, 1, -1, 2, -2,    // b = 3
+      3, 1, 4, 1, 5, 9,           // b = 4
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 11, 2, 5, 0,     //
+                                 0, 0, 1, 1.5,    //
+                                 8, 5, 3, 0,      //
+                                 0, 3, 1, 3.5,    //
+                                 14, 9, 7, 2.5,   //
+                             })));
+}
+
+TEST_P(FullyConnectedOpTest, SimpleTestHybrid) {
+  HybridFullyConnectedOpModel m(
+      GetRegistration(), /*units=*/3, /*batches=*/2,
+      /*input=*/{TensorType_FLOAT32, {2, 10}},
+      /*weights=*/{TensorType_UINT8, {3, 10}});  // Hybrid
+
+  m.SetWeights({
+      1, 2, 3, 4, 5, 6, 7, 8, 9, 10,  // u = 0
+      1, 2, 3, 4, 5, 6, 7, 8, 9, 10,  // u = 1
+      1, 2, 3, 4, 5, 6, 7, 8, 9, 10,  // u = 2
+  });
+  m.SetBias({1, 2, 3});
+
+  m.SetInput({
+      1, 2, 3, 4, 5, 6, 7, 8,  -9, -10,  // b = 0
+      1, 2, 3, 4, 5, 6, 7, -8, 9,  -10,  // b = 1
+  });
+
+  m.Invoke();
+
+  // Both the weights and the input are quantized to 8 bits, so the result is
+  // only expected to be close to the float one.
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                 {
+                                     24, 25, 26,  //
+                                     58, 59, 60,  //
+                                 },
+                                 /*max_abs_error=*/1.3f)));
+}
+
+TEST_P(FullyConnectedOpTest, SimpleTestHybridPerChannel) {
+  HybridFullyConnectedOpModel m(
+      GetRegistration(), /*units=*/3, /*batches=*/2,
+      /*input=*/{TensorType_FLOAT32, {2, 10}},
+      /*weights=*/
+      {TensorType_INT8, {3, 10}, 0, 0, 0, 0,
+       /*per_channel_scales=*/{10.0f / 127, 1.0f / 127, 0.5f / 127},
+       /*quantized_dimension=*/0});
+
+  m.SetPerChannelWeights({
+      1,   2,   3,   4,   5,   6,   7,   8,   9,   10,   // u = 0
+      0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1,    // u = 1
+      0.5, 0.5, 0.5, 0.5, 0.5, -.5, -.5, -.5, -.5, -.5,  // u = 2
+  });
+  m.SetBias({1, 2, 3});
+
+  m.SetInput({
+      1, 2, 3, 4, 5, 6, 7, 8,  -9, -10,  // b = 0
+      1, 2, 3, 4, 5, 6, 7, -8, 9,  -10,  // b = 1
+  });
+
+  m.Invoke();
+
+  // Both the weights and the input are quantized to 8 bits, so the result is
+  // only expected to be close to the float one.
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                 {
+                                     24, 4.3, 9.5,  //
+                                     58, 7.7, 8.5,  //
+                                 },
+                                 /*max_abs_error=*/1.3f)));
+}
+
 TEST(FullyConnectedOpTest, SimpleTest4DInput) {
   // Note that it is not required that the first dimension be the number of
   // batches. All we care is that the input can be evenly distributed in
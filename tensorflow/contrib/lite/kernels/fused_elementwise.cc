@@ -0,0 +1,240 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <string>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/contrib/lite/context.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/contrib/lite/kernels/internal/reference/reference_ops.h"
+#include "tensorflow/contrib/lite/kernels/internal/tensor.h"
+#include "tensorflow/contrib/lite/kernels/kernel_util.h"
+#include "tensorflow/contrib/lite/kernels/op_macros.h"
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+
+// A chain of elementwise float operations, which toco fuses into a single op
+// to evaluate them in one pass, without intermediate tensors. The options are
+// three vectors with an entry per step: "operations", the names of the
+// operations (such as "MUL" or "LOGISTIC"), and "lhs" and "rhs", the operands
+// as described for FusedElementwiseStep. The inputs have either the shape of
+// the output or a single element, which is broadcast.
+namespace fused_elementwise {
+
+enum KernelType {
+  kReference,
+  kGenericOptimized,
+};
+
+constexpr int kOutputTensor = 0;
+
+struct OpData {
+  std::vector<FusedElementwiseStep> steps;
+  // The name of the first operation that isn't supported, if any.
+  std::string unsupported_operation;
+  // The estimated cost of evaluating the steps on one element.
+  int cost_per_item;
+};
+
+bool ParseOperation(const std::string& name,
+                    FusedElementwiseOperation* operation) {
+  static const struct {
+    const char* name;
+    FusedElementwiseOperation operation;
+  } kOperations[] = {
+      {"ADD", FusedElementwiseOperation::kAdd},
+      {"SUB", FusedElementwiseOperation::kSub},
+      {"MUL", FusedElementwiseOperation::kMul},
+      {"DIV", FusedElementwiseOperation::kDiv},
+      {"EXP", FusedElementwiseOperation::kExp},
+      {"LOGISTIC", FusedElementwiseOperation::kLogistic},
+      {"TANH", FusedElementwiseOperation::kTanh},
+      {"RELU", FusedElementwiseOperation::kRelu},
+      {"RELU_N1_TO_1", FusedElementwiseOperation::kRelu1},
+      {"RELU6", FusedElementwiseOperation::kRelu6},
+  };
+  for (const auto& entry : kOperations) {
+    if (name == entry.name) {
+      *operation = entry.operation;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IsBinary(FusedElementwiseOperation operation) {
+  return operation == FusedElementwiseOperation::kAdd ||
+         operation == FusedElementwiseOperation::kSub ||
+         operation == FusedElementwiseOperation::kMul ||
+         operation == FusedElementwiseOperation::kDiv;
+}
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  thread_pool_support::IncrementUsageCounter(context);
+  auto* data = new OpData;
+  data->cost_per_item = 0;
+  if (buffer == nullptr || length == 0) return data;
+
+  const uint8_t* buffer_t = reinterpret_cast<const uint8_t*>(buffer);
+  const flexbuffers::Map& m = flexbuffers::GetRoot(buffer_t, length).AsMap();
+  const auto operations = m["operations"].AsVector();
+  const auto lhs = m["lhs"].AsVector();
+  const auto rhs = m["rhs"].AsVector();
+  for (int i = 0; i < operations.size(); ++i) {
+    FusedElementwiseStep step;
+    const std::string name = operations[i].AsString().str();
+    if (!ParseOperation(name, &step.operation)) {
+      if (data->unsupported_operation.empty()) {
+        data->unsupported_operation = name;
+      }
+      continue;
+    }
+    step.lhs = i < lhs.size() ? lhs[i].AsInt32() : -1;
+    step.rhs = i < rhs.size() ? rhs[i].AsInt32() : -1;
+    data->steps.push_back(step);
+    // The transcendental functions cost about 64 of the other operations, as
+    // in toco's EstimateArithmeticOpsCount().
+    switch (step.operation) {
+      case FusedElementwiseOperation::kExp:
+      case FusedElementwiseOperation::kLogistic:
+      case FusedElementwiseOperation::kTanh:
+        data->cost_per_item += 64;
+        break;
+      default:
+        data->cost_per_item += 1;
+    }
+  }
+  return data;
+}
+
+void Free(TfLiteContext* context, void* buffer) {
+  thread_pool_support::DecrementUsageCounter(context);
+  delete reinterpret_cast<OpData*>(buffer);
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  OpData* data = reinterpret_cast<OpData*>(node->user_data);
+
+  TF_LITE_ENSURE(context, NumInputs(node) >= 1);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+
+  if (!data->unsupported_operation.empty()) {
+    context->ReportError(context,
+                         "Operation '%s' is not supported by FusedElementwise.",
+                         data->unsupported_operation.c_str());
+    return kTfLiteError;
+  }
+  const int num_inputs = NumInputs(node);
+  const int num_steps = data->steps.size();
+  TF_LITE_ENSURE(context, num_steps >= 1);
+  TF_LITE_ENSURE(context,
+                 num_steps <= optimized_ops::kFusedElementwiseMaxSteps);
+  for (int s = 0; s < num_steps; ++s) {
+    const FusedElementwiseStep& step = data->steps[s];
+    // Operands can only be inputs or the results of previous steps.
+    TF_LITE_ENSURE(context, step.lhs >= 0 && step.lhs < num_inputs + s);
+    if (IsBinary(step.operation)) {
+      TF_LITE_ENSURE(context, step.rhs >= 0 && step.rhs < num_inputs + s);
+    } else {
+      TF_LITE_ENSURE_EQ(context, step.rhs, -1);
+    }
+  }
+
+  // The output has the shape of the inputs that aren't broadcast.
+  TfLiteTensor* shape_input = GetInput(context, node, 0);
+  for (int i = 0; i < num_inputs; ++i) {
+    TfLiteTensor* input = GetInput(context, node, i);
+    TF_LITE_ENSURE_EQ(context, input->type, kTfLiteFloat32);
+    if (NumElements(input) == 1) continue;
+    if (NumElements(shape_input) == 1) {
+      shape_input = input;
+    } else {
+      TF_LITE_ENSURE(context, HaveSameShapes(input, shape_input));
+    }
+  }
+
+  TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+  TF_LITE_ENSURE_EQ(context, output->type, kTfLiteFloat32);
+  return context->ResizeTensor(context, output,
+                               TfLiteIntArrayCopy(shape_input->dims));
+}
+
+template <KernelType kernel_type>
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  OpData* data = reinterpret_cast<OpData*>(node->user_data);
+  TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+
+  const int num_inputs = NumInputs(node);
+  std::vector<const float*> input_data(num_inputs);
+  std::vector<int> input_sizes(num_inputs);
+  for (int i = 0; i < num_inputs; ++i) {
+    TfLiteTensor* input = GetInput(context, node, i);
+    input_data[i] = GetTensorData<float>(input);
+    input_sizes[i] = NumElements(input);
+  }
+
+  if (kernel_type == kReference) {
+    reference_ops::FusedElementwise(
+        input_data.data(), input_sizes.data(), num_inputs, data->steps.data(),
+        data->steps.size(), GetTensorData<float>(output), NumElements(output));
+  } else {
+    // Split the elements across the threads.
+    thread_pool_support::ParallelFor(
+        context, NumElements(output), data->cost_per_item,
+        [&](int start, int end) {
+          std::vector<const float*> shard_input_data(num_inputs);
+          std::vector<int> shard_input_sizes(num_inputs);
+          for (int i = 0; i < num_inputs; ++i) {
+            const bool broadcast = input_sizes[i] == 1;
+            shard_input_data[i] = input_data[i] + (broadcast ? 0 : start);
+            shard_input_sizes[i] = broadcast ? 1 : end - start;
+          }
+          optimized_ops::FusedElementwise(
+              shard_input_data.data(), shard_input_sizes.data(), num_inputs,
+              data->steps.data(), data->steps.size(),
+              GetTensorData<float>(output) + start, end - start);
+        });
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace fused_elementwise
+
+TfLiteRegistration* Register_FUSED_ELEMENTWISE_REF() {
+  static TfLiteRegistration r = {
+      fused_elementwise::Init, fused_elementwise::Free,
+      fused_elementwise::Prepare,
+      fused_elementwise::Eval<fused_elementwise::kReference>};
+  return &r;
+}
+
+TfLiteRegistration* Register_FUSED_ELEMENTWISE_GENERIC_OPT() {
+  static TfLiteRegistration r = {
+      fused_elementwise::Init, fused_elementwise::Free,
+      fused_elementwise::Prepare,
+      fused_elementwise::Eval<fused_elementwise::kGenericOptimized>};
+  return &r;
+}
+
+TfLiteRegistration* Register_FUSED_ELEMENTWISE() {
+  return Register_FUSED_ELEMENTWISE_GENERIC_OPT();
+}
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
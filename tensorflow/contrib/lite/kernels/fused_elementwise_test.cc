@@ -0,0 +1,170 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/contrib/lite/interpreter.h"
+#include "tensorflow/contrib/lite/kernels/register.h"
+#include "tensorflow/contrib/lite/kernels/test_util.h"
+#include "tensorflow/contrib/lite/model.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+
+TfLiteRegistration* Register_FUSED_ELEMENTWISE_REF();
+TfLiteRegistration* Register_FUSED_ELEMENTWISE_GENERIC_OPT();
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+struct Step {
+  std::string operation;
+  int lhs;
+  int rhs;
+};
+
+class FusedElementwiseOpModel : public SingleOpModel {
+ public:
+  FusedElementwiseOpModel(TfLiteRegistration* registration,
+                          const std::vector<std::vector<int>>& input_shapes,
+                          const std::vector<Step>& steps) {
+    for (int i = 0; i < input_shapes.size(); ++i) {
+      inputs_.push_back(AddInput({TensorType_FLOAT32, input_shapes[i]}));
+    }
+    output_ = AddOutput({TensorType_FLOAT32, {}});
+
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() {
+      fbb.Vector("operations", [&]() {
+        for (const Step& step : steps) fbb.String(step.operation);
+      });
+      fbb.Vector("lhs", [&]() {
+        for (const Step& step : steps) fbb.Int(step.lhs);
+      });
+      fbb.Vector("rhs", [&]() {
+        for (const Step& step : steps) fbb.Int(step.rhs);
+      });
+    });
+    fbb.Finish();
+    SetCustomOp("FusedElementwise", fbb.GetBuffer(),
+                [registration]() { return registration; });
+
+    BuildInterpreter(input_shapes);
+  }
+
+  int input(int i) { return inputs_[i]; }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ private:
+  std::vector<int> inputs_;
+  int output_;
+};
+
+const std::vector<TfLiteRegistration*>& Registrations() {
+  static const std::vector<TfLiteRegistration*> registrations = {
+      Register_FUSED_ELEMENTWISE_REF(),
+      Register_FUSED_ELEMENTWISE_GENERIC_OPT()};
+  return registrations;
+}
+
+float Logistic(float x) { return 1.f / (1.f + std::exp(-x)); }
+
+TEST(FusedElementwiseOpTest, GateChain) {
+  // relu(logistic(x + bias) * tanh(c)), with a single bias.
+  for (TfLiteRegistration* registration : Registrations()) {
+    FusedElementwiseOpModel m(registration, {{2, 3}, {2, 3}, {1}},
+                              {{"ADD", 0, 2},
+                               {"LOGISTIC", 3, -1},
+                               {"TANH", 1, -1},
+                               {"MUL", 4, 5},
+                               {"RELU", 6, -1}});
+    const std::vector<float> x = {-2, -1, 0, 1, 2, 3};
+    const std::vector<float> c = {1, -1, 0.5, 2, -0.5, 0};
+    m.PopulateTensor<float>(m.input(0), x);
+    m.PopulateTensor<float>(m.input(1), c);
+    m.PopulateTensor<float>(m.input(2), {0.5});
+    m.Invoke();
+
+    std::vector<float> expected;
+    for (int i = 0; i < x.size(); ++i) {
+      expected.push_back(
+          std::max(0.f, Logistic(x[i] + 0.5f) * std::tanh(c[i])));
+    }
+    EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+    EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(expected)));
+  }
+}
+
+// Checks min(6, max(0, exp((1 - x) / y) - 2 * x)) over `size` elements, which
+// the kernels evaluate in several blocks, on `num_threads` threads.
+void TestManyBlocks(int size, int num_threads) {
+  for (TfLiteRegistration* registration : Registrations()) {
+    FusedElementwiseOpModel m(registration, {{1}, {size}, {size}, {1}},
+                              {{"SUB", 0, 1},
+                               {"DIV", 4, 2},
+                               {"EXP", 5, -1},
+                               {"MUL", 3, 1},
+                               {"SUB", 6, 7},
+                               {"RELU6", 8, -1}});
+    m.SetNumThreads(num_threads);
+    std::vector<float> x(size), y(size);
+    for (int i = 0; i < size; ++i) {
+      x[i] = (i % 17) * 0.25f - 2.f;
+      y[i] = (i % 5) + 1.f;
+    }
+    m.PopulateTensor<float>(m.input(0), {1});
+    m.PopulateTensor<float>(m.input(1), x);
+    m.PopulateTensor<float>(m.input(2), y);
+    m.PopulateTensor<float>(m.input(3), {2});
+    m.Invoke();
+
+    std::vector<float> expected;
+    for (int i = 0; i < size; ++i) {
+      const float value = std::exp((1 - x[i]) / y[i]) - 2 * x[i];
+      expected.push_back(std::min(6.f, std::max(0.f, value)));
+    }
+    EXPECT_THAT(m.GetOutputShape(), ElementsAre(size));
+    EXPECT_THAT(m.GetOutput(),
+                ElementsAreArray(ArrayFloatNear(expected, 1e-4)));
+  }
+}
+
+TEST(FusedElementwiseOpTest, ManyBlocks) {
+  TestManyBlocks(/*size=*/1000, /*num_threads=*/1);
+}
+
+TEST(FusedElementwiseOpTest, ManyBlocksMultithreaded) {
+  // At a cost of 69 per element, enough work for the optimized kernel to
+  // split the elements across all the threads.
+  TestManyBlocks(/*size=*/4000, /*num_threads=*/4);
+}
+
+}  // namespace
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -40,6 +40,52 @@ void RnnBatchStep(const float* input_ptr_batch, const float* input_weights_ptr,
                                         hidden_state_ptr_batch);
 }
 
+void RnnBatchStep(const float* input_ptr_batch, const int8_t* input_weights_ptr,
+                  float input_weights_scale,
+                  const int8_t* recurrent_weights_ptr,
+                  float recurrent_weights_scale, const float* bias_ptr,
+                  int input_size, int num_units, int batch_size,
+                  TfLiteFusedActivation activation,
+                  int8_t* quantized_input_ptr_batch,
+                  int8_t* quantized_hidden_state_ptr_batch,
+                  float* scaling_factors, float* hidden_state_ptr_batch,
+                  float* output_ptr_batch) {
+  // Output = bias
+  tensor_utils::VectorBatchVectorAssign(bias_ptr, num_units, batch_size,
+                                        output_ptr_batch);
+  float unused_min, unused_max;
+  // Output += input * input_weights
+  for (int b = 0; b < batch_size; ++b) {
+    const int offset = b * input_size;
+    tensor_utils::SymmetricQuantizeFloats(
+        input_ptr_batch + offset, input_size,
+        quantized_input_ptr_batch + offset, &unused_min, &unused_max,
+        &scaling_factors[b]);
+    scaling_factors[b] *= input_weights_scale;
+  }
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      input_weights_ptr, num_units, input_size, quantized_input_ptr_batch,
+      scaling_factors, batch_size, output_ptr_batch, /*result_stride=*/1);
+  // Output += recurrent_weights * hidden_state
+  for (int b = 0; b < batch_size; ++b) {
+    const int offset = b * num_units;
+    tensor_utils::SymmetricQuantizeFloats(
+        hidden_state_ptr_batch + offset, num_units,
+        quantized_hidden_state_ptr_batch + offset, &unused_min, &unused_max,
+        &scaling_factors[b]);
+    scaling_factors[b] *= recurrent_weights_scale;
+  }
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      recurrent_weights_ptr, num_units, num_units,
+      quantized_hidden_state_ptr_batch, scaling_factors, batch_size,
+      output_ptr_batch, /*result_stride=*/1);
+  // Output = activation(Output) and update hidden_state
+  tensor_utils::ApplyActivationToVector(
+      output_ptr_batch, num_units * batch_size, activation, output_ptr_batch);
+  tensor_utils::VectorBatchVectorAssign(output_ptr_batch, num_units, batch_size,
+                                        hidden_state_ptr_batch);
+}
+
 void LstmStep(
     const float* input_ptr_batch, const float* input_to_input_weights_ptr,
     const float* input_to_forget_weights_ptr,
@@ -1935,6 +1935,100 @@ inline void DepthwiseConv(const uint8* input_data, const Dims<4>& input_dims,
   }
 }
 
+// Quantized DepthwiseConv whose filter holds symmetric int8 values quantized
+// per output channel, with one output multiplier and shift per channel. Each
+// output pixel is accumulated over the filter taps with the channels
+// innermost, where the input, the filter and the accumulators are all
+// contiguous.
+inline void DepthwiseConvPerChannel(
+    const uint8* input_data, const Dims<4>& input_dims, int32 input_offset,
+    const int8* filter_data, const Dims<4>& filter_dims,
+    const int32* bias_data, const Dims<4>& bias_dims, int stride_width,
+    int stride_height, int pad_width, int pad_height, int depth_multiplier,
+    int32 output_offset, const int32* output_multiplier,
+    const int* output_shift, int32 output_activation_min,
+    int32 output_activation_max, uint8* output_data,
+    const Dims<4>& output_dims) {
+  gemmlowp::ScopedProfilingLabel label("DepthwiseConvPerChannel/8bit");
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+
+  const int batches = MatchingArraySize(input_dims, 3, output_dims, 3);
+  const int output_depth = MatchingArraySize(filter_dims, 0, output_dims, 0);
+  const int input_height = ArraySize(input_dims, 2);
+  const int input_width = ArraySize(input_dims, 1);
+  const int input_depth = ArraySize(input_dims, 0);
+  const int filter_height = ArraySize(filter_dims, 2);
+  const int filter_width = ArraySize(filter_dims, 1);
+  const int output_height = ArraySize(output_dims, 2);
+  const int output_width = ArraySize(output_dims, 1);
+  TFLITE_DCHECK(output_depth == input_depth * depth_multiplier);
+
+  static const int kAccBufferMaxSize = 2048;
+  int32 acc_buffer[kAccBufferMaxSize];
+  for (int b = 0; b < batches; ++b) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin = (out_y * stride_height) - pad_height;
+      const int filter_y_start = std::max(0, -in_y_origin);
+      const int filter_y_end =
+          std::min(filter_height, input_height - in_y_origin);
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin = (out_x * stride_width) - pad_width;
+        const int filter_x_start = std::max(0, -in_x_origin);
+        const int filter_x_end =
+            std::min(filter_width, input_width - in_x_origin);
+        uint8* output_ptr =
+            output_data + Offset(output_dims, 0, out_x, out_y, b);
+        // Deep outputs go through the accumulators in several chunks.
+        for (int oc_start = 0; oc_start < output_depth;
+             oc_start += kAccBufferMaxSize) {
+          const int oc_end =
+              std::min(output_depth, oc_start + kAccBufferMaxSize);
+          const int num_channels = oc_end - oc_start;
+          if (bias_data) {
+            memcpy(acc_buffer, bias_data + oc_start,
+                   num_channels * sizeof(acc_buffer[0]));
+          } else {
+            memset(acc_buffer, 0, num_channels * sizeof(acc_buffer[0]));
+          }
+          for (int filter_y = filter_y_start; filter_y < filter_y_end;
+               ++filter_y) {
+            const int in_y = in_y_origin + filter_y;
+            for (int filter_x = filter_x_start; filter_x < filter_x_end;
+                 ++filter_x) {
+              const int in_x = in_x_origin + filter_x;
+              const uint8* input_ptr =
+                  input_data + Offset(input_dims, 0, in_x, in_y, b);
+              const int8* filter_ptr =
+                  filter_data + Offset(filter_dims, 0, filter_x, filter_y, 0);
+              if (depth_multiplier == 1) {
+                for (int oc = oc_start; oc < oc_end; ++oc) {
+                  acc_buffer[oc - oc_start] +=
+                      filter_ptr[oc] * (input_ptr[oc] + input_offset);
+                }
+              } else {
+                for (int oc = oc_start; oc < oc_end; ++oc) {
+                  acc_buffer[oc - oc_start] +=
+                      filter_ptr[oc] *
+                      (input_ptr[oc / depth_multiplier] + input_offset);
+                }
+              }
+            }
+          }
+          for (int oc = oc_start; oc < oc_end; ++oc) {
+            int32 acc = MultiplyByQuantizedMultiplier(
+                acc_buffer[oc - oc_start], output_multiplier[oc],
+                output_shift[oc]);
+            acc += output_offset;
+            acc = std::max(acc, output_activation_min);
+            acc = std::min(acc, output_activation_max);
+            output_ptr[oc] = static_cast<uint8>(acc);
+          }
+        }
+      }
+    }
+  }
+}
+
 // Legacy, for compatibility with old checked-in code.
 template <FusedActivationFunctionType Ac>
 void DepthwiseConv(const uint8* input_data, const Dims<4>& input_dims,
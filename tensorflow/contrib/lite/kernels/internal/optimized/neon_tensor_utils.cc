@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include <string.h>
+#include <algorithm>
 
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/kernels/internal/common.h"
@@ -23,6 +24,7 @@ limitations under the License.
 #ifdef USE_NEON
 
 #define kFloatWeightsPerNeonLane 4
+#define kInt8ValuesPerNeonVector 16
 
 namespace tflite {
 namespace tensor_utils {
@@ -113,6 +115,86 @@ void NeonMatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
   delete[] vector_cache_float32x4;
 }
 
+void NeonMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* matrix, int m_rows, int m_cols, const int8_t* vectors,
+    const float* scaling_factors, int n_batch, float* result,
+    int result_stride) {
+  // The main loop handles 16 columns at a time, and then the postamble handles
+  // the rest sequentially.
+  const int postamble_start = m_cols - (m_cols & (kInt8ValuesPerNeonVector - 1));
+
+  for (int b = 0; b < n_batch; ++b, vectors += m_cols) {
+    const float batch_scaling_factor = scaling_factors[b];
+    const int8_t* row_ptr = matrix;
+    for (int r = 0; r < m_rows; ++r, result += result_stride) {
+      int32x4_t dotprod = vmovq_n_s32(0);
+      int c = 0;
+      for (; c < postamble_start; c += kInt8ValuesPerNeonVector) {
+        const int8x16_t s1_8x16 = vld1q_s8(vectors + c);
+        const int8x16_t s2_8x16 = vld1q_s8(row_ptr + c);
+        // A single product of int8 values fits in 16 bits, but the sum of two
+        // may not, e.g. 2 * (-128 * -128). So each half is pairwise added into
+        // the 32-bit accumulators on its own.
+        const int16x8_t low_prod_16x8 =
+            vmull_s8(vget_low_s8(s1_8x16), vget_low_s8(s2_8x16));
+        dotprod = vpadalq_s16(dotprod, low_prod_16x8);
+        const int16x8_t high_prod_16x8 =
+            vmull_s8(vget_high_s8(s1_8x16), vget_high_s8(s2_8x16));
+        dotprod = vpadalq_s16(dotprod, high_prod_16x8);
+      }
+      int32_t postamble_sum = 0;
+      for (; c < m_cols; ++c) {
+        postamble_sum += row_ptr[c] * vectors[c];
+      }
+      const int64x2_t pairwise_added = vpaddlq_s32(dotprod);
+      const int32_t neon_sum =
+          vgetq_lane_s64(pairwise_added, 0) + vgetq_lane_s64(pairwise_added, 1);
+      *result += (neon_sum + postamble_sum) * batch_scaling_factor;
+      row_ptr += m_cols;
+    }
+  }
+}
+
+void NeonPackedMatrixBatchVectorMultiplyAccumulate(
+    const float* packed_matrix, int m_rows, int m_cols, const float* vector,
+    int n_batch, float* result, int result_stride) {
+  // PortablePackMatrix interleaves panels of kFloatWeightsPerNeonLane rows, so
+  // that a column of a panel is exactly one NEON register.
+  float* result_in_batch = result;
+  for (int b = 0; b < n_batch; ++b) {
+    const float* vector_in_batch = vector + b * m_cols;
+    const float* panel_ptr = packed_matrix;
+    for (int panel_row = 0; panel_row < m_rows;
+         panel_row += kFloatWeightsPerNeonLane) {
+      // Two accumulators hide the latency of the multiply-accumulates.
+      float32x4_t acc0_32x4 = vmovq_n_f32(0.0);
+      float32x4_t acc1_32x4 = vmovq_n_f32(0.0);
+      int c = 0;
+      for (; c + 1 < m_cols; c += 2) {
+        acc0_32x4 =
+            vmlaq_n_f32(acc0_32x4, vld1q_f32(panel_ptr), vector_in_batch[c]);
+        acc1_32x4 = vmlaq_n_f32(acc1_32x4,
+                                vld1q_f32(panel_ptr + kFloatWeightsPerNeonLane),
+                                vector_in_batch[c + 1]);
+        panel_ptr += 2 * kFloatWeightsPerNeonLane;
+      }
+      if (c < m_cols) {
+        acc0_32x4 =
+            vmlaq_n_f32(acc0_32x4, vld1q_f32(panel_ptr), vector_in_batch[c]);
+        panel_ptr += kFloatWeightsPerNeonLane;
+      }
+      float acc[kFloatWeightsPerNeonLane];
+      vst1q_f32(acc, vaddq_f32(acc0_32x4, acc1_32x4));
+      const int rows_in_panel =
+          std::min(kFloatWeightsPerNeonLane, m_rows - panel_row);
+      for (int r = 0; r < rows_in_panel; ++r) {
+        *result_in_batch += acc[r];
+        result_in_batch += result_stride;
+      }
+    }
+  }
+}
+
 void NeonVectorVectorCwiseProduct(const float* vector1, const float* vector2,
                                   int v_size, float* result) {
   // If v_size is not divisible by kWeightsPerNeonLane, we cannot use the main
@@ -24,6 +24,13 @@ limitations under the License.
 namespace tflite {
 namespace tensor_utils {
 
+void SymmetricQuantizeFloats(const float* values, const int size,
+                             int8_t* quantized_values, float* min, float* max,
+                             float* scaling_factor) {
+  PortableSymmetricQuantizeFloats(values, size, quantized_values, min, max,
+                                  scaling_factor);
+}
+
 void MatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
                                          int m_cols, const float* vector,
                                          int n_batch, float* result,
@@ -32,6 +39,33 @@ void MatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
                    vector, n_batch, result, result_stride);
 }
 
+void MatrixBatchVectorMultiplyAccumulate(const int8_t* matrix, int m_rows,
+                                         int m_cols, const int8_t* vectors,
+                                         const float* scaling_factors,
+                                         int n_batch, float* result,
+                                         int result_stride) {
+  NEON_OR_PORTABLE(MatrixBatchVectorMultiplyAccumulate, matrix, m_rows, m_cols,
+                   vectors, scaling_factors, n_batch, result, result_stride);
+}
+
+int PackedMatrixSize(int m_rows, int m_cols) {
+  return PortablePackedMatrixSize(m_rows, m_cols);
+}
+
+void PackMatrix(const float* matrix, int m_rows, int m_cols,
+                float* packed_matrix) {
+  PortablePackMatrix(matrix, m_rows, m_cols, packed_matrix);
+}
+
+void PackedMatrixBatchVectorMultiplyAccumulate(const float* packed_matrix,
+                                               int m_rows, int m_cols,
+                                               const float* vector,
+                                               int n_batch, float* result,
+                                               int result_stride) {
+  NEON_OR_PORTABLE(PackedMatrixBatchVectorMultiplyAccumulate, packed_matrix,
+                   m_rows, m_cols, vector, n_batch, result, result_stride);
+}
+
 void VectorVectorCwiseProduct(const float* vector1, const float* vector2,
                               int v_size, float* result) {
   NEON_OR_PORTABLE(VectorVectorCwiseProduct, vector1, vector2, v_size, result);
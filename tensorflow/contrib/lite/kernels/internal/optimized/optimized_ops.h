@@ -854,6 +854,83 @@ inline void FullyConnected(const float* input_data, const Dims<4>& input_dims,
                                    output_activation_max);
 }
 
+// FullyConnected whose weights only hold their non-zero blocks, in the
+// format of reference_ops::SparseFullyConnected. Each row of weights is
+// applied to several batches at once, so that the stored blocks are read once
+// per group of batches rather than once per batch.
+inline void SparseFullyConnected(
+    const float* input_data, const Dims<4>& input_dims,
+    const float* weights_data, const Dims<4>& weights_dims, int block_rows,
+    int block_cols, const int* row_segments, const int* col_indices,
+    const float* bias_data, const Dims<4>& bias_dims,
+    float output_activation_min, float output_activation_max,
+    float* output_data, const Dims<4>& output_dims) {
+  gemmlowp::ScopedProfilingLabel label("SparseFullyConnected");
+  const int batches = ArraySize(output_dims, 1) * ArraySize(output_dims, 2) *
+                      ArraySize(output_dims, 3);
+  const int output_depth = MatchingArraySize(weights_dims, 1, output_dims, 0);
+  const int accum_depth = ArraySize(weights_dims, 0);
+  TFLITE_DCHECK(IsPackedWithoutStrides(input_dims));
+  TFLITE_DCHECK_EQ(output_depth % block_rows, 0);
+  TFLITE_DCHECK_EQ(accum_depth % block_cols, 0);
+  const int block_size = block_rows * block_cols;
+
+  static constexpr int kBatchesPerGroup = 4;
+  for (int b = 0; b < batches; b += kBatchesPerGroup) {
+    const int group_size = std::min(kBatchesPerGroup, batches - b);
+    const float* group_input = input_data + b * accum_depth;
+    float* group_output = output_data + b * output_depth;
+    for (int out_c = 0; out_c < output_depth; ++out_c) {
+      const int block_row = out_c / block_rows;
+      const int row_in_block = out_c % block_rows;
+      float totals[kBatchesPerGroup] = {0.f, 0.f, 0.f, 0.f};
+      int k = row_segments[block_row];
+      const int end = row_segments[block_row + 1];
+#ifdef USE_NEON
+      if (block_cols % 4 == 0) {
+        float32x4_t acc[kBatchesPerGroup];
+        for (int i = 0; i < kBatchesPerGroup; ++i) acc[i] = vdupq_n_f32(0.f);
+        for (; k < end; ++k) {
+          const float* weights_row =
+              weights_data + k * block_size + row_in_block * block_cols;
+          const float* input_row = group_input + col_indices[k] * block_cols;
+          for (int d = 0; d < block_cols; d += 4) {
+            const float32x4_t weights = vld1q_f32(weights_row + d);
+            for (int i = 0; i < group_size; ++i) {
+              acc[i] = vmlaq_f32(acc[i], weights,
+                                 vld1q_f32(input_row + i * accum_depth + d));
+            }
+          }
+        }
+        for (int i = 0; i < group_size; ++i) {
+          const float32x2_t sum =
+              vadd_f32(vget_low_f32(acc[i]), vget_high_f32(acc[i]));
+          totals[i] = vget_lane_f32(vpadd_f32(sum, sum), 0);
+        }
+      }
+#endif
+      for (; k < end; ++k) {
+        const float* weights_row =
+            weights_data + k * block_size + row_in_block * block_cols;
+        const float* input_row = group_input + col_indices[k] * block_cols;
+        for (int i = 0; i < group_size; ++i) {
+          float total = 0.f;
+          for (int d = 0; d < block_cols; ++d) {
+            total += input_row[i * accum_depth + d] * weights_row[d];
+          }
+          totals[i] += total;
+        }
+      }
+      const float bias_value = bias_data ? bias_data[out_c] : 0.f;
+      for (int i = 0; i < group_size; ++i) {
+        group_output[i * output_depth + out_c] = ActivationFunctionWithMinMax(
+            totals[i] + bias_value, output_activation_min,
+            output_activation_max);
+      }
+    }
+  }
+}
+
 // legacy, for compatibility with old checked-in code
 template <FusedActivationFunctionType Ac>
 void FullyConnected(const float* input_data, const Dims<4>& input_dims,
@@ -1102,6 +1179,32 @@ inline void FullyConnected(const uint8* input_data, const Dims<4>& input_dims,
       input_offset, output_pipeline);
 }
 
+// Quantized FullyConnected whose weights hold symmetric int8 values
+// quantized per output row. 'filter_sums' holds the sums of the rows of the
+// weights, as in PerChannelQuantizedMatMul().
+inline void FullyConnectedPerChannel(
+    const uint8* input_data, const Dims<4>& input_dims, int32 input_offset,
+    const int8* filter_data, const Dims<4>& filter_dims,
+    const int32* filter_sums, const int32* bias_data,
+    const Dims<4>& bias_dims, int32 output_offset,
+    const int32* output_multiplier, const int* output_shift,
+    int32 output_activation_min, int32 output_activation_max,
+    uint8* output_data, const Dims<4>& output_dims) {
+  gemmlowp::ScopedProfilingLabel label("FullyConnectedPerChannel/8bit");
+  const int batches = ArraySize(output_dims, 1) * ArraySize(output_dims, 2) *
+                      ArraySize(output_dims, 3);
+  const int output_depth = MatchingArraySize(filter_dims, 1, output_dims, 0);
+  const int accum_depth = ArraySize(filter_dims, 0);
+  TFLITE_DCHECK(IsPackedWithoutStrides(input_dims));
+  TFLITE_DCHECK(IsPackedWithoutStrides(filter_dims));
+  TFLITE_DCHECK_EQ(bias_dims.sizes[0], output_depth);
+  PerChannelQuantizedMatMul(filter_data, filter_sums, output_depth, accum_depth,
+                            input_data, input_offset, batches, bias_data,
+                            output_offset, output_multiplier, output_shift,
+                            output_activation_min, output_activation_max,
+                            output_data);
+}
+
 inline void FullyConnected(
     const uint8* input_data, const Dims<4>& input_dims, int32 input_offset,
     const uint8* filter_data, const Dims<4>& filter_dims, int32 filter_offset,
@@ -1705,6 +1808,153 @@ inline void Conv(const uint8* input_data, const Dims<4>& input_dims,
       input_offset, output_pipeline);
 }
 
+// Returns the dot product of 'size' int8 and uint8 values.
+inline int32 Int8Uint8DotProduct(const int8* a, const uint8* b, int size) {
+  int i = 0;
+  int32 result = 0;
+#ifdef USE_NEON
+  int32x4_t acc = vdupq_n_s32(0);
+  for (; i <= size - 16; i += 16) {
+    const int8x16_t a_s8 = vld1q_s8(a + i);
+    const uint8x16_t b_u8 = vld1q_u8(b + i);
+    // Both operands widen to int16, and their products accumulate in int32.
+    const int16x8_t a_low = vmovl_s8(vget_low_s8(a_s8));
+    const int16x8_t a_high = vmovl_s8(vget_high_s8(a_s8));
+    const int16x8_t b_low = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(b_u8)));
+    const int16x8_t b_high =
+        vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(b_u8)));
+    acc = vmlal_s16(acc, vget_low_s16(a_low), vget_low_s16(b_low));
+    acc = vmlal_s16(acc, vget_high_s16(a_low), vget_high_s16(b_low));
+    acc = vmlal_s16(acc, vget_low_s16(a_high), vget_low_s16(b_high));
+    acc = vmlal_s16(acc, vget_high_s16(a_high), vget_high_s16(b_high));
+  }
+  const int64x2_t pairwise = vpaddlq_s32(acc);
+  result = static_cast<int32>(vgetq_lane_s64(pairwise, 0) +
+                              vgetq_lane_s64(pairwise, 1));
+#endif  // USE_NEON
+  for (; i < size; ++i) {
+    result += a[i] * b[i];
+  }
+  return result;
+}
+
+// Computes the sum of each of the 'rows' rows of 'cols' values of 'matrix'.
+inline void Int8RowSums(const int8* matrix, int rows, int cols, int32* sums) {
+  for (int row = 0; row < rows; ++row) {
+    int32 sum = 0;
+    for (int col = 0; col < cols; ++col) {
+      sum += matrix[row * cols + col];
+    }
+    sums[row] = sum;
+  }
+}
+
+// Multiplies the 'output_depth' x 'depth' row-major matrix 'filter_data' of
+// symmetric int8 values with 'num_columns' columns of 'depth' uint8 values,
+// stored one after the other, and requantizes the result into 'num_columns'
+// columns of 'output_depth' uint8 values with one multiplier and shift per
+// row. 'filter_sums' holds the sums of the rows of the filter (see
+// Int8RowSums()), so that the input offset costs one multiply-add per output
+// rather than one per input value.
+inline void PerChannelQuantizedMatMul(
+    const int8* filter_data, const int32* filter_sums, int output_depth,
+    int depth, const uint8* input_data, int32 input_offset, int num_columns,
+    const int32* bias_data, int32 output_offset,
+    const int32* output_multiplier, const int* output_shift,
+    int32 output_activation_min, int32 output_activation_max,
+    uint8* output_data) {
+  gemmlowp::ScopedProfilingLabel label("PerChannelQuantizedMatMul");
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  // The rows are taken in blocks small enough to stay in the cache while all
+  // the columns go through them.
+  const int kRowBlockBytes = 64 * 1024;
+  const int row_block = std::max(1, kRowBlockBytes / std::max(1, depth));
+  for (int row_start = 0; row_start < output_depth; row_start += row_block) {
+    const int row_end = std::min(output_depth, row_start + row_block);
+    for (int col = 0; col < num_columns; ++col) {
+      const uint8* input_column = input_data + col * depth;
+      uint8* output_column = output_data + col * output_depth;
+      for (int row = row_start; row < row_end; ++row) {
+        int32 acc =
+            Int8Uint8DotProduct(filter_data + row * depth, input_column, depth);
+        acc += input_offset * filter_sums[row];
+        if (bias_data) {
+          acc += bias_data[row];
+        }
+        acc = MultiplyByQuantizedMultiplier(acc, output_multiplier[row],
+                                            output_shift[row]);
+        acc += output_offset;
+        acc = std::max(acc, output_activation_min);
+        acc = std::min(acc, output_activation_max);
+        output_column[row] = static_cast<uint8>(acc);
+      }
+    }
+  }
+}
+
+// Quantized Conv whose filter holds symmetric int8 values quantized per
+// output channel. Like the uint8 Conv, it runs a matrix multiplication on the
+// im2col buffer, with the per-channel requantization folded into it.
+inline void ConvPerChannel(
+    const uint8* input_data, const Dims<4>& input_dims, int32 input_offset,
+    const int8* filter_data, const Dims<4>& filter_dims,
+    const int32* filter_sums, const int32* bias_data,
+    const Dims<4>& bias_dims, int stride_width, int stride_height,
+    int pad_width, int pad_height, int32 output_offset,
+    const int32* output_multiplier, const int* output_shift,
+    int32 output_activation_min, int32 output_activation_max,
+    uint8* output_data, const Dims<4>& output_dims, uint8* im2col_data,
+    const Dims<4>& im2col_dims) {
+  gemmlowp::ScopedProfilingLabel label("ConvPerChannel/8bit");
+
+  TFLITE_DCHECK(IsPackedWithoutStrides(input_dims));
+  TFLITE_DCHECK(IsPackedWithoutStrides(filter_dims));
+  TFLITE_DCHECK(IsPackedWithoutStrides(output_dims));
+
+  const uint8* gemm_input_data = nullptr;
+  const Dims<4>* gemm_input_dims = nullptr;
+  const int filter_width = ArraySize(filter_dims, 1);
+  const int filter_height = ArraySize(filter_dims, 2);
+  const bool need_im2col = stride_width != 1 || stride_height != 1 ||
+                           filter_width != 1 || filter_height != 1;
+  if (need_im2col) {
+    TFLITE_DCHECK(im2col_data);
+    // Padding with the input zero point makes the padded values contribute
+    // nothing once the input offset is applied.
+    const int input_zero_point = -input_offset;
+    TFLITE_DCHECK_GE(input_zero_point, 0);
+    TFLITE_DCHECK_LE(input_zero_point, 255);
+    Im2col(input_data, input_dims, stride_width, stride_height, pad_width,
+           pad_height, filter_height, filter_width, input_zero_point,
+           im2col_data, im2col_dims);
+    gemm_input_data = im2col_data;
+    gemm_input_dims = &im2col_dims;
+  } else {
+    gemm_input_data = input_data;
+    gemm_input_dims = &input_dims;
+  }
+
+  const int gemm_input_rows = gemm_input_dims->sizes[0];
+  const int gemm_input_cols = gemm_input_dims->sizes[1] *
+                              gemm_input_dims->sizes[2] *
+                              gemm_input_dims->sizes[3];
+  const int filter_rows = filter_dims.sizes[3];
+  const int filter_cols =
+      filter_dims.sizes[0] * filter_dims.sizes[1] * filter_dims.sizes[2];
+  const int output_rows = output_dims.sizes[0];
+  const int output_cols =
+      output_dims.sizes[1] * output_dims.sizes[2] * output_dims.sizes[3];
+  TFLITE_DCHECK_EQ(output_rows, filter_rows);
+  TFLITE_DCHECK_EQ(output_cols, gemm_input_cols);
+  TFLITE_DCHECK_EQ(filter_cols, gemm_input_rows);
+  TFLITE_DCHECK_EQ(bias_dims.sizes[0], output_rows);
+  PerChannelQuantizedMatMul(filter_data, filter_sums, filter_rows, filter_cols,
+                            gemm_input_data, input_offset, gemm_input_cols,
+                            bias_data, output_offset, output_multiplier,
+                            output_shift, output_activation_min,
+                            output_activation_max, output_data);
+}
+
 // legacy, for compatibility with old checked-in code
 template <FusedActivationFunctionType Ac>
 inline void Conv(const uint8* input_data, const Dims<4>& input_dims,
@@ -4613,6 +4863,121 @@ inline void Tanh(const float* input_data, const Dims<4>& input_dims,
   output_map.array() = input_map.array().tanh();
 }
 
+// FusedElementwise() evaluates the steps on blocks of this many elements, so
+// that the results of the steps of a block stay in the L1 cache, and handles
+// up to that many steps.
+constexpr int kFusedElementwiseBlockSize = 256;
+constexpr int kFusedElementwiseMaxSteps = 16;
+
+template <typename Lhs>
+void FusedElementwiseUnaryStep(FusedElementwiseOperation operation,
+                               const Lhs& lhs, VectorMap<float>* result) {
+  switch (operation) {
+    case FusedElementwiseOperation::kExp:
+      result->array() = lhs.exp();
+      break;
+    case FusedElementwiseOperation::kLogistic:
+      result->array() =
+          lhs.unaryExpr(Eigen::internal::scalar_sigmoid_op<float>());
+      break;
+    case FusedElementwiseOperation::kTanh:
+      result->array() = lhs.tanh();
+      break;
+    case FusedElementwiseOperation::kRelu:
+      result->array() = lhs.max(0.f);
+      break;
+    case FusedElementwiseOperation::kRelu1:
+      result->array() = lhs.max(-1.f).min(1.f);
+      break;
+    case FusedElementwiseOperation::kRelu6:
+      result->array() = lhs.max(0.f).min(6.f);
+      break;
+    default:
+      TFLITE_DCHECK(false);
+  }
+}
+
+template <typename Lhs, typename Rhs>
+void FusedElementwiseBinaryStep(FusedElementwiseOperation operation,
+                                const Lhs& lhs, const Rhs& rhs,
+                                VectorMap<float>* result) {
+  switch (operation) {
+    case FusedElementwiseOperation::kAdd:
+      result->array() = lhs + rhs;
+      break;
+    case FusedElementwiseOperation::kSub:
+      result->array() = lhs - rhs;
+      break;
+    case FusedElementwiseOperation::kMul:
+      result->array() = lhs * rhs;
+      break;
+    case FusedElementwiseOperation::kDiv:
+      result->array() = lhs / rhs;
+      break;
+    default:
+      TFLITE_DCHECK(false);
+  }
+}
+
+// Evaluates the chain of 'steps' on each element and writes the result of the
+// last step, one block at a time, instead of making a pass over the whole
+// arrays for each step. Each input has either 'size' elements or a single
+// one, which is broadcast.
+inline void FusedElementwise(const float* const* input_data,
+                             const int* input_sizes, int num_inputs,
+                             const FusedElementwiseStep* steps, int num_steps,
+                             float* output_data, int size) {
+  gemmlowp::ScopedProfilingLabel label("FusedElementwise");
+  TFLITE_DCHECK_GE(num_steps, 1);
+  TFLITE_DCHECK_LE(num_steps, kFusedElementwiseMaxSteps);
+  // The results of the steps but the last, which go to 'output_data'.
+  float scratch[kFusedElementwiseMaxSteps - 1][kFusedElementwiseBlockSize];
+
+  for (int start = 0; start < size; start += kFusedElementwiseBlockSize) {
+    const int block_size = std::min(kFusedElementwiseBlockSize, size - start);
+    auto is_broadcast = [&](int index) {
+      return index < num_inputs && input_sizes[index] == 1;
+    };
+    auto block = [&](int index) {
+      const float* data = index < num_inputs ? input_data[index] + start
+                                             : scratch[index - num_inputs];
+      return VectorMap<const float>(data, block_size, 1);
+    };
+    auto broadcast = [&](int index) {
+      return Eigen::ArrayXf::Constant(block_size, input_data[index][0]);
+    };
+
+    for (int s = 0; s < num_steps; ++s) {
+      const FusedElementwiseStep& step = steps[s];
+      VectorMap<float> result(
+          s == num_steps - 1 ? output_data + start : scratch[s], block_size, 1);
+      if (step.rhs < 0) {
+        if (is_broadcast(step.lhs)) {
+          FusedElementwiseUnaryStep(step.operation, broadcast(step.lhs),
+                                    &result);
+        } else {
+          FusedElementwiseUnaryStep(step.operation, block(step.lhs).array(),
+                                    &result);
+        }
+      } else if (is_broadcast(step.lhs)) {
+        if (is_broadcast(step.rhs)) {
+          FusedElementwiseBinaryStep(step.operation, broadcast(step.lhs),
+                                     broadcast(step.rhs), &result);
+        } else {
+          FusedElementwiseBinaryStep(step.operation, broadcast(step.lhs),
+                                     block(step.rhs).array(), &result);
+        }
+      } else if (is_broadcast(step.rhs)) {
+        FusedElementwiseBinaryStep(step.operation, block(step.lhs).array(),
+                                   broadcast(step.rhs), &result);
+      } else {
+        FusedElementwiseBinaryStep(step.operation, block(step.lhs).array(),
+                                   block(step.rhs).array(), &result);
+      }
+    }
+  }
+}
+
 inline void Tanh(const uint8* input_data, const Dims<4>& input_dims,
                  int32 input_zero_point, int32 input_range_radius,
                  int32 input_multiplier, int input_left_shift,
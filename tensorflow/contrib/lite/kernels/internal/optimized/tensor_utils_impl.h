@@ -40,6 +40,34 @@ void NeonMatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
                                              int n_batch, float* result,
                                              int result_stride);
 
+// Multiply a symmetrically quantized matrix by a symmetrically quantized batch
+// vector, and accumulate the rescaled results in a batch-size vector.
+void PortableMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* matrix, int m_rows, int m_cols, const int8_t* vectors,
+    const float* scaling_factors, int n_batch, float* result,
+    int result_stride);
+void NeonMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* matrix, int m_rows, int m_cols, const int8_t* vectors,
+    const float* scaling_factors, int n_batch, float* result,
+    int result_stride);
+
+// Pack a matrix into panels of rows, and multiply such a packed matrix by a
+// batch vector.
+int PortablePackedMatrixSize(int m_rows, int m_cols);
+void PortablePackMatrix(const float* matrix, int m_rows, int m_cols,
+                        float* packed_matrix);
+void PortablePackedMatrixBatchVectorMultiplyAccumulate(
+    const float* packed_matrix, int m_rows, int m_cols, const float* vector,
+    int n_batch, float* result, int result_stride);
+void NeonPackedMatrixBatchVectorMultiplyAccumulate(
+    const float* packed_matrix, int m_rows, int m_cols, const float* vector,
+    int n_batch, float* result, int result_stride);
+
+// Symmetrically quantize a vector to 8-bit signed integers.
+void PortableSymmetricQuantizeFloats(const float* values, const int size,
+                                     int8_t* quantized_values, float* min,
+                                     float* max, float* scaling_factor);
+
 // Cwise product of two vectors.
 void PortableVectorVectorCwiseProduct(const float* vector1,
                                       const float* vector2, int v_size,
@@ -13,20 +13,55 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include <string.h>
+#include <algorithm>
+#include <cmath>
 
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/kernels/activation_functor.h"
+#include "tensorflow/contrib/lite/kernels/internal/round.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
 
 namespace tflite {
 namespace tensor_utils {
 
+// Number of consecutive rows interleaved in a panel of a packed matrix. The
+// NEON kernel relies on it matching the number of floats in a NEON register.
+constexpr int kPackedMatrixPanelRows = 4;
+
 float PortableClip(float f, float abs_limit) {
   float result = (abs_limit < f) ? abs_limit : f;
   result = (-abs_limit > result) ? -abs_limit : result;
   return result;
 }
 
+void PortableSymmetricQuantizeFloats(const float* values, const int size,
+                                     int8_t* quantized_values, float* min,
+                                     float* max, float* scaling_factor) {
+  if (size == 0) {
+    *min = *max = 0;
+    *scaling_factor = 1;
+    return;
+  }
+  auto minmax = std::minmax_element(values, values + size);
+  *min = *minmax.first;
+  *max = *minmax.second;
+  const int kScale = 127;
+  const float range = std::max(std::abs(*min), std::abs(*max));
+  if (range == 0) {
+    memset(quantized_values, 0, size * sizeof(int8_t));
+    *scaling_factor = 1;
+    return;
+  }
+  *scaling_factor = range / kScale;
+  const float scaling_factor_inv = kScale / range;
+  for (int i = 0; i < size; ++i) {
+    const int32_t quantized_value =
+        static_cast<int32_t>(TfLiteRound(values[i] * scaling_factor_inv));
+    // Clamp: just in case some odd numeric offset.
+    quantized_values[i] = std::min(kScale, std::max(-kScale, quantized_value));
+  }
+}
+
 void PortableMatrixBatchVectorMultiplyAccumulate(const float* matrix,
                                                  int m_rows, int m_cols,
                                                  const float* vector,
@@ -45,6 +80,69 @@ void PortableMatrixBatchVectorMultiplyAccumulate(const float* matrix,
   }
 }
 
+void PortableMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* matrix, int m_rows, int m_cols, const int8_t* vectors,
+    const float* scaling_factors, int n_batch, float* result,
+    int result_stride) {
+  for (int b = 0; b < n_batch; ++b, vectors += m_cols) {
+    const float batch_scaling_factor = scaling_factors[b];
+    const int8_t* row_ptr = matrix;
+    for (int r = 0; r < m_rows; ++r, result += result_stride) {
+      // Accumulate in 32 bits: each product fits in 15 bits.
+      int32_t dotprod = 0;
+      for (int c = 0; c < m_cols; ++c, ++row_ptr) {
+        dotprod += (*row_ptr) * vectors[c];
+      }
+      *result += dotprod * batch_scaling_factor;
+    }
+  }
+}
+
+int PortablePackedMatrixSize(int m_rows, int m_cols) {
+  const int num_panels =
+      (m_rows + kPackedMatrixPanelRows - 1) / kPackedMatrixPanelRows;
+  return num_panels * kPackedMatrixPanelRows * m_cols;
+}
+
+void PortablePackMatrix(const float* matrix, int m_rows, int m_cols,
+                        float* packed_matrix) {
+  for (int panel_row = 0; panel_row < m_rows;
+       panel_row += kPackedMatrixPanelRows) {
+    for (int c = 0; c < m_cols; ++c) {
+      for (int r = 0; r < kPackedMatrixPanelRows; ++r) {
+        const int row = panel_row + r;
+        *packed_matrix++ = row < m_rows ? matrix[row * m_cols + c] : 0.0f;
+      }
+    }
+  }
+}
+
+void PortablePackedMatrixBatchVectorMultiplyAccumulate(
+    const float* packed_matrix, int m_rows, int m_cols, const float* vector,
+    int n_batch, float* result, int result_stride) {
+  float* result_in_batch = result;
+  for (int b = 0; b < n_batch; ++b) {
+    const float* vector_in_batch = vector + b * m_cols;
+    const float* panel_ptr = packed_matrix;
+    for (int panel_row = 0; panel_row < m_rows;
+         panel_row += kPackedMatrixPanelRows) {
+      float acc[kPackedMatrixPanelRows] = {0.0f};
+      for (int c = 0; c < m_cols; ++c) {
+        const float value = vector_in_batch[c];
+        for (int r = 0; r < kPackedMatrixPanelRows; ++r) {
+          acc[r] += *panel_ptr++ * value;
+        }
+      }
+      const int rows_in_panel =
+          std::min(kPackedMatrixPanelRows, m_rows - panel_row);
+      for (int r = 0; r < rows_in_panel; ++r) {
+        *result_in_batch += acc[r];
+        result_in_batch += result_stride;
+      }
+    }
+  }
+}
+
 void PortableVectorVectorCwiseProduct(const float* vector1,
                                       const float* vector2, int v_size,
                                       float* result) {
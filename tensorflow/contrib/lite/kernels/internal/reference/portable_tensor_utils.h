@@ -33,6 +33,27 @@ void PortableMatrixBatchVectorMultiplyAccumulate(const float* matrix,
                                                  int n_batch, float* result,
                                                  int result_stride);
 
+// Multiply a symmetrically quantized matrix by a symmetrically quantized batch
+// vector, and accumulate the rescaled results in a batch-size vector.
+void PortableMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* matrix, int m_rows, int m_cols, const int8_t* vectors,
+    const float* scaling_factors, int n_batch, float* result,
+    int result_stride);
+
+// Pack a matrix into panels of rows, and multiply such a packed matrix by a
+// batch vector.
+int PortablePackedMatrixSize(int m_rows, int m_cols);
+void PortablePackMatrix(const float* matrix, int m_rows, int m_cols,
+                        float* packed_matrix);
+void PortablePackedMatrixBatchVectorMultiplyAccumulate(
+    const float* packed_matrix, int m_rows, int m_cols, const float* vector,
+    int n_batch, float* result, int result_stride);
+
+// Symmetrically quantize a vector to 8-bit signed integers.
+void PortableSymmetricQuantizeFloats(const float* values, const int size,
+                                     int8_t* quantized_values, float* min,
+                                     float* max, float* scaling_factor);
+
 // Cwise product of two vectors.
 void PortableVectorVectorCwiseProduct(const float* vector1,
                                       const float* vector2, int v_size,
@@ -103,6 +124,13 @@ void PortableReductionSumVector(const float* input_vector, float* output_vector,
 
 float Clip(float f, float abs_limit) { return PortableClip(f, abs_limit); }
 
+void SymmetricQuantizeFloats(const float* values, const int size,
+                             int8_t* quantized_values, float* min, float* max,
+                             float* scaling_factor) {
+  PortableSymmetricQuantizeFloats(values, size, quantized_values, min, max,
+                                  scaling_factor);
+}
+
 void MatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
                                          int m_cols, const float* vector,
                                          int n_batch, float* result,
@@ -111,6 +139,34 @@ void MatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
                                               n_batch, result, result_stride);
 }
 
+void MatrixBatchVectorMultiplyAccumulate(const int8_t* matrix, int m_rows,
+                                         int m_cols, const int8_t* vectors,
+                                         const float* scaling_factors,
+                                         int n_batch, float* result,
+                                         int result_stride) {
+  PortableMatrixBatchVectorMultiplyAccumulate(matrix, m_rows, m_cols, vectors,
+                                              scaling_factors, n_batch, result,
+                                              result_stride);
+}
+
+int PackedMatrixSize(int m_rows, int m_cols) {
+  return PortablePackedMatrixSize(m_rows, m_cols);
+}
+
+void PackMatrix(const float* matrix, int m_rows, int m_cols,
+                float* packed_matrix) {
+  PortablePackMatrix(matrix, m_rows, m_cols, packed_matrix);
+}
+
+void PackedMatrixBatchVectorMultiplyAccumulate(const float* packed_matrix,
+                                               int m_rows, int m_cols,
+                                               const float* vector,
+                                               int n_batch, float* result,
+                                               int result_stride) {
+  PortablePackedMatrixBatchVectorMultiplyAccumulate(
+      packed_matrix, m_rows, m_cols, vector, n_batch, result, result_stride);
+}
+
 void VectorVectorCwiseProduct(const float* vector1, const float* vector2,
                               int v_size, float* result) {
   PortableVectorVectorCwiseProduct(vector1, vector2, v_size, result);
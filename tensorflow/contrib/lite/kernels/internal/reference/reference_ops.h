@@ -332,6 +332,71 @@ inline void Conv(const uint8* input_data, const Dims<4>& input_dims,
   }
 }
 
+// Quantized Conv whose filter holds symmetric int8 values quantized per
+// output channel. 'output_multiplier' and 'output_shift' have one entry per
+// output channel, the shifts being positive for a left shift as produced by
+// QuantizeMultiplier().
+inline void ConvPerChannel(
+    const uint8* input_data, const Dims<4>& input_dims, int32 input_offset,
+    const int8* filter_data, const Dims<4>& filter_dims,
+    const int32* bias_data, const Dims<4>& bias_dims, int stride_width,
+    int stride_height, int pad_width, int pad_height, int32 output_offset,
+    const int32* output_multiplier, const int* output_shift,
+    int32 output_activation_min, int32 output_activation_max,
+    uint8* output_data, const Dims<4>& output_dims) {
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  const int batches = MatchingArraySize(input_dims, 3, output_dims, 3);
+  const int input_depth = MatchingArraySize(input_dims, 0, filter_dims, 0);
+  const int output_depth =
+      MatchingArraySize(filter_dims, 3, bias_dims, 0, output_dims, 0);
+  const int input_height = ArraySize(input_dims, 2);
+  const int input_width = ArraySize(input_dims, 1);
+  const int filter_height = ArraySize(filter_dims, 2);
+  const int filter_width = ArraySize(filter_dims, 1);
+  const int output_height = ArraySize(output_dims, 2);
+  const int output_width = ArraySize(output_dims, 1);
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
+          const int in_x_origin = (out_x * stride_width) - pad_width;
+          const int in_y_origin = (out_y * stride_height) - pad_height;
+          int32 acc = 0;
+          for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+            for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+              for (int in_channel = 0; in_channel < input_depth; ++in_channel) {
+                const int in_x = in_x_origin + filter_x;
+                const int in_y = in_y_origin + filter_y;
+                // If the location is outside the bounds of the input image,
+                // use zero as a default value.
+                if ((in_x >= 0) && (in_x < input_width) && (in_y >= 0) &&
+                    (in_y < input_height)) {
+                  int32 input_val = input_data[Offset(input_dims, in_channel,
+                                                      in_x, in_y, batch)];
+                  int32 filter_val =
+                      filter_data[Offset(filter_dims, in_channel, filter_x,
+                                         filter_y, out_channel)];
+                  acc += filter_val * (input_val + input_offset);
+                }
+              }
+            }
+          }
+          if (bias_data) {
+            acc += bias_data[Offset(bias_dims, out_channel, 0, 0, 0)];
+          }
+          acc = MultiplyByQuantizedMultiplier(
+              acc, output_multiplier[out_channel], output_shift[out_channel]);
+          acc += output_offset;
+          acc = std::max(acc, output_activation_min);
+          acc = std::min(acc, output_activation_max);
+          output_data[Offset(output_dims, out_channel, out_x, out_y, batch)] =
+              static_cast<uint8>(acc);
+        }
+      }
+    }
+  }
+}
+
 // legacy, for compatibility with old checked-in code
 template <FusedActivationFunctionType Ac>
 inline void Conv(const uint8* input_data, const Dims<4>& input_dims,
@@ -497,6 +562,51 @@ inline void FullyConnected(const float* input_data, const Dims<4>& input_dims,
   }
 }
 
+// FullyConnected whose weights only hold their non-zero blocks of
+// block_rows x block_cols values, in block compressed sparse row format:
+// the blocks of row of blocks i are the blocks row_segments[i] to
+// row_segments[i + 1] - 1 of 'weights_data', and block k is in column of
+// blocks col_indices[k]. 'weights_dims' are those of the whole weights.
+inline void SparseFullyConnected(
+    const float* input_data, const Dims<4>& input_dims,
+    const float* weights_data, const Dims<4>& weights_dims, int block_rows,
+    int block_cols, const int* row_segments, const int* col_indices,
+    const float* bias_data, const Dims<4>& bias_dims,
+    float output_activation_min, float output_activation_max,
+    float* output_data, const Dims<4>& output_dims) {
+  const int batches = ArraySize(output_dims, 1) * ArraySize(output_dims, 2) *
+                      ArraySize(output_dims, 3);
+  const int output_depth = MatchingArraySize(weights_dims, 1, output_dims, 0);
+  const int accum_depth = ArraySize(weights_dims, 0);
+  TFLITE_DCHECK(IsPackedWithoutStrides(input_dims));
+  TFLITE_DCHECK_EQ(output_depth % block_rows, 0);
+  TFLITE_DCHECK_EQ(accum_depth % block_cols, 0);
+  const int block_size = block_rows * block_cols;
+  for (int b = 0; b < batches; ++b) {
+    for (int out_c = 0; out_c < output_depth; ++out_c) {
+      const int block_row = out_c / block_rows;
+      const int row_in_block = out_c % block_rows;
+      float total = 0.f;
+      for (int k = row_segments[block_row]; k < row_segments[block_row + 1];
+           ++k) {
+        const float* weights_row =
+            weights_data + k * block_size + row_in_block * block_cols;
+        const float* input_row =
+            input_data + b * accum_depth + col_indices[k] * block_cols;
+        for (int d = 0; d < block_cols; ++d) {
+          total += input_row[d] * weights_row[d];
+        }
+      }
+      float bias_value = 0.0f;
+      if (bias_data) {
+        bias_value = bias_data[Offset(bias_dims, out_c, 0, 0, 0)];
+      }
+      output_data[out_c + output_depth * b] = ActivationFunctionWithMinMax(
+          total + bias_value, output_activation_min, output_activation_max);
+    }
+  }
+}
+
 // legacy, for compatibility with old checked-in code
 template <FusedActivationFunctionType Ac>
 void FullyConnected(const float* input_data, const Dims<4>& input_dims,
@@ -553,6 +663,44 @@ inline void FullyConnected(const uint8* input_data, const Dims<4>& input_dims,
   }
 }
 
+// Quantized FullyConnected whose weights hold symmetric int8 values quantized
+// per output row, with one output multiplier and shift per row as in
+// ConvPerChannel.
+inline void FullyConnectedPerChannel(
+    const uint8* input_data, const Dims<4>& input_dims, int32 input_offset,
+    const int8* filter_data, const Dims<4>& filter_dims,
+    const int32* bias_data, const Dims<4>& bias_dims, int32 output_offset,
+    const int32* output_multiplier, const int* output_shift,
+    int32 output_activation_min, int32 output_activation_max,
+    uint8* output_data, const Dims<4>& output_dims) {
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  const int batches = ArraySize(output_dims, 1) * ArraySize(output_dims, 2) *
+                      ArraySize(output_dims, 3);
+  const int output_depth = MatchingArraySize(filter_dims, 1, output_dims, 0);
+  const int accum_depth = ArraySize(filter_dims, 0);
+  TFLITE_DCHECK(IsPackedWithoutStrides(input_dims));
+  TFLITE_DCHECK(IsPackedWithoutStrides(filter_dims));
+  for (int b = 0; b < batches; ++b) {
+    for (int out_c = 0; out_c < output_depth; ++out_c) {
+      int32 acc = 0;
+      for (int d = 0; d < accum_depth; ++d) {
+        int32 input_val = input_data[b * accum_depth + d];
+        int32 filter_val = filter_data[out_c * accum_depth + d];
+        acc += filter_val * (input_val + input_offset);
+      }
+      if (bias_data) {
+        acc += bias_data[Offset(bias_dims, out_c, 0, 0, 0)];
+      }
+      acc = MultiplyByQuantizedMultiplier(acc, output_multiplier[out_c],
+                                          output_shift[out_c]);
+      acc += output_offset;
+      acc = std::max(acc, output_activation_min);
+      acc = std::min(acc, output_activation_max);
+      output_data[out_c + output_depth * b] = static_cast<uint8>(acc);
+    }
+  }
+}
+
 inline void FullyConnected(const uint8* input_data, const Dims<4>& input_dims,
                            int32 input_offset, const uint8* filter_data,
                            const Dims<4>& filter_dims, int32 filter_offset,
@@ -2688,6 +2836,61 @@ inline void Tanh(const float* input_data, const Dims<4>& input_dims,
   }
 }
 
+// Evaluates the chain of 'steps' on each element and writes the result of the
+// last step. Each input has either 'size' elements or a single one, which is
+// broadcast.
+inline void FusedElementwise(const float* const* input_data,
+                             const int* input_sizes, int num_inputs,
+                             const FusedElementwiseStep* steps, int num_steps,
+                             float* output_data, int size) {
+  std::vector<float> values(num_inputs + num_steps);
+  for (int i = 0; i < size; ++i) {
+    for (int j = 0; j < num_inputs; ++j) {
+      values[j] = input_data[j][input_sizes[j] == 1 ? 0 : i];
+    }
+    for (int s = 0; s < num_steps; ++s) {
+      const FusedElementwiseStep& step = steps[s];
+      const float lhs = values[step.lhs];
+      const float rhs = step.rhs >= 0 ? values[step.rhs] : 0.f;
+      float result = 0.f;
+      switch (step.operation) {
+        case FusedElementwiseOperation::kAdd:
+          result = lhs + rhs;
+          break;
+        case FusedElementwiseOperation::kSub:
+          result = lhs - rhs;
+          break;
+        case FusedElementwiseOperation::kMul:
+          result = lhs * rhs;
+          break;
+        case FusedElementwiseOperation::kDiv:
+          result = lhs / rhs;
+          break;
+        case FusedElementwiseOperation::kExp:
+          result = std::exp(lhs);
+          break;
+        case FusedElementwiseOperation::kLogistic:
+          result = 1.f / (1.f + std::exp(-lhs));
+          break;
+        case FusedElementwiseOperation::kTanh:
+          result = std::tanh(lhs);
+          break;
+        case FusedElementwiseOperation::kRelu:
+          result = std::max(0.f, lhs);
+          break;
+        case FusedElementwiseOperation::kRelu1:
+          result = std::min(1.f, std::max(-1.f, lhs));
+          break;
+        case FusedElementwiseOperation::kRelu6:
+          result = std::min(6.f, std::max(0.f, lhs));
+          break;
+      }
+      values[num_inputs + s] = result;
+    }
+    output_data[i] = values[num_inputs + num_steps - 1];
+  }
+}
+
 inline void Tanh(const uint8* input_data, const Dims<4>& input_dims,
                  int32 input_zero_point, int32 input_range_radius,
                  int32 input_multiplier, int input_left_shift,
@@ -23,6 +23,14 @@ namespace tensor_utils {
 // Limit a float input f between +abs_limit and -abs_limit.
 float Clip(float f, float abs_limit);
 
+// Quantizes a buffer of floating point values symmetrically (i.e. linearly,
+// without an offset) to 8-bit signed integers in [-127, 127]. Also outputs the
+// range (min, max) of the floating point buffer, and the scaling factor such
+// that values[i] ~= quantized_values[i] * scaling_factor.
+void SymmetricQuantizeFloats(const float* values, const int size,
+                             int8_t* quantized_values, float* min, float* max,
+                             float* scaling_factor);
+
 // Multiply a matrix by a batch vector, and store results in a batch-size
 // vector using a stride value provided in result_stride. 'result_stride' shows
 // how the number of elements between consecutive result values. For example
@@ -34,6 +42,38 @@ void MatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
                                          int n_batch, float* result,
                                          int result_stride);
 
+// Same as the function above, but the matrix and the batch vectors are
+// symmetrically quantized 8-bit integers (see SymmetricQuantizeFloats). Any
+// int8 value is handled, including the -128 that weights stored in uint8
+// buffers may hold. The integer product of each batch is multiplied by
+// scaling_factors[batch] before being accumulated in 'result'.
+void MatrixBatchVectorMultiplyAccumulate(const int8_t* matrix, int m_rows,
+                                         int m_cols, const int8_t* vectors,
+                                         const float* scaling_factors,
+                                         int n_batch, float* result,
+                                         int result_stride);
+
+// Returns the number of floats needed to hold an m_rows x m_cols matrix in the
+// packed layout of PackMatrix.
+int PackedMatrixSize(int m_rows, int m_cols);
+
+// Packs a row-major m_rows x m_cols matrix into panels of a few consecutive
+// rows, in which the values of the same column are contiguous. The last panel
+// is padded with zeros. 'packed_matrix' must hold PackedMatrixSize() floats.
+// Meant for constant matrices, which are packed once and multiplied many
+// times.
+void PackMatrix(const float* matrix, int m_rows, int m_cols,
+                float* packed_matrix);
+
+// Same as MatrixBatchVectorMultiplyAccumulate, but the matrix is in the layout
+// produced by PackMatrix. This reads every vector value once per panel instead
+// of once per row, and needs no horizontal reduction of the accumulators.
+void PackedMatrixBatchVectorMultiplyAccumulate(const float* packed_matrix,
+                                               int m_rows, int m_cols,
+                                               const float* vector,
+                                               int n_batch, float* result,
+                                               int result_stride);
+
 // Cwise product of two vectors.
 void VectorVectorCwiseProduct(const float* vector1, const float* vector2,
                               int v_size, float* result);
@@ -32,6 +32,82 @@ TEST(uKernels, ClipTest) {
                   {0.0, -0.5, 1.0, -1.5, 2.0, -2.0, 2.0, -2.0, 2.0, -2.0})));
 }
 
+TEST(uKernels, SymmetricQuantizeFloatsTest) {
+  constexpr int kVectorSize = 9;
+  static float input[kVectorSize] = {-640, -635.0, -630, 10.0,  2.0,
+                                     -5.0, -10.0,  0.0,  1000.0};
+
+  int8_t output[kVectorSize];
+  float min, max, scaling_factor;
+  SymmetricQuantizeFloats(input, kVectorSize, output, &min, &max,
+                          &scaling_factor);
+
+  EXPECT_EQ(min, -640);
+  EXPECT_EQ(max, 1000);
+  // The range is [-1000, 1000], mapped to [-127, 127].
+  EXPECT_NEAR(scaling_factor, 1000.0 / 127, 1e-6);
+  EXPECT_THAT(output,
+              testing::ElementsAreArray({-81, -81, -80, 1, 0, -1, -1, 0, 127}));
+}
+
+TEST(uKernels, SymmetricQuantizeFloatsAllZerosTest) {
+  constexpr int kVectorSize = 9;
+  static float input[kVectorSize] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+  int8_t output[kVectorSize];
+  float min, max, scaling_factor;
+  SymmetricQuantizeFloats(input, kVectorSize, output, &min, &max,
+                          &scaling_factor);
+
+  EXPECT_EQ(min, 0);
+  EXPECT_EQ(max, 0);
+  EXPECT_EQ(scaling_factor, 1);
+  EXPECT_THAT(output, testing::ElementsAreArray({0, 0, 0, 0, 0, 0, 0, 0, 0}));
+}
+
+TEST(uKernels, QuantizedMatrixBatchVectorMultiplyAccumulateTest) {
+  // Use more than 16 columns so that the vectorized loops run too.
+  constexpr int kRow = 3;
+  constexpr int kCol = 18;
+  constexpr int kBatch = 2;
+  static int8_t matrix[kRow * kCol] = {
+      1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, 16, 17, 18,
+      -1, -2, -3, -4, -5, -6, -7, -8, -9, -10, -11, -12, -13, -14, -15, -16,
+      -17, -18,  //
+      1,  -2, 3,  -4, 5,  -6, 7,  -8, 9,  -10, 11, -12, 13, -14, 15, -16, 17,
+      -18};
+  static int8_t vectors[kCol * kBatch] = {
+      1,  -1, 1,  -1, 1,  -1, 1,  -1, 1,  -1, 1,  -1, 1,  -1, 1,  -1, 1,  -1,
+      127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127,
+      127, 127, 127};
+  static float scaling_factors[kBatch] = {1.0, 0.5};
+  std::vector<float> output(kRow * kBatch, 3.0);
+  MatrixBatchVectorMultiplyAccumulate(matrix, kRow, kCol, vectors,
+                                      scaling_factors, kBatch, output.data(),
+                                      /*result_stride=*/1);
+  // Row sums are 171, -171 and -9.
+  EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear(
+                          {3 - 9, 3 + 9, 3 + 171,  //
+                           3 + 0.5 * 127 * 171, 3 - 0.5 * 127 * 171,
+                           3 - 0.5 * 127 * 9})));
+}
+
+TEST(uKernels, QuantizedMatrixBatchVectorMultiplyAccumulateMinValuesTest) {
+  // -128 * -128 fits in 16 bits, but not the sum of two such products.
+  constexpr int kRow = 2;
+  constexpr int kCol = 32;
+  std::vector<int8_t> matrix(kRow * kCol, -128);
+  for (int c = 0; c < kCol; c += 2) matrix[kCol + c] = 127;
+  std::vector<int8_t> vector(kCol, -128);
+  const float scaling_factor = 1.0;
+  std::vector<float> output(kRow, 0.0);
+  MatrixBatchVectorMultiplyAccumulate(matrix.data(), kRow, kCol, vector.data(),
+                                      &scaling_factor, /*n_batch=*/1,
+                                      output.data(), /*result_stride=*/1);
+  EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear(
+                          {32 * 128 * 128, 16 * 128 * 128 - 16 * 127 * 128})));
+}
+
 TEST(uKernels, MatrixBatchVectorMultiplyAccumulateTest) {
   constexpr int kRow = 3;
   constexpr int kCol = 4;
@@ -58,6 +134,40 @@ TEST(uKernels, MatrixBatchVectorMultiplyAccumulateTest) {
                                                -1., 3., 7., 3., 23., 3.})));
 }
 
+TEST(uKernels, PackedMatrixBatchVectorMultiplyAccumulateTest) {
+  // An odd number of rows and columns, so that the last panel is padded and
+  // the column loop has a remainder.
+  constexpr int kRow = 5;
+  constexpr int kCol = 3;
+  constexpr int kBatch = 2;
+  static float matrix[kRow * kCol] = {1.0,  2.0,  3.0,   //
+                                      -1.0, -2.0, -3.0,  //
+                                      1.0,  -2.0, 3.0,   //
+                                      0.5,  0.0,  -0.5,  //
+                                      4.0,  5.0,  6.0};
+  static float vector[kCol * kBatch] = {1.0, -1.0, 1.0,  //
+                                        2.0, -2.0, 3.0};
+  std::vector<float> packed_matrix(PackedMatrixSize(kRow, kCol));
+  PackMatrix(matrix, kRow, kCol, packed_matrix.data());
+
+  std::vector<float> output(kRow * kBatch, 3.0);
+  PackedMatrixBatchVectorMultiplyAccumulate(packed_matrix.data(), kRow, kCol,
+                                            vector, kBatch, output.data(),
+                                            /*result_stride=*/1);
+  EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear({5., 1., 9., 3., 8.,  //
+                                                       10., -4., 18., 2.5,
+                                                       19.})));
+
+  std::vector<float> output_with_stride2(kRow * kBatch * 2, 3.0);
+  PackedMatrixBatchVectorMultiplyAccumulate(
+      packed_matrix.data(), kRow, kCol, vector, kBatch,
+      output_with_stride2.data(), /*result_stride=*/2);
+  EXPECT_THAT(output_with_stride2,
+              ElementsAreArray(ArrayFloatNear(
+                  {5., 3., 1., 3., 9., 3., 3., 3., 8., 3.,  //
+                   10., 3., -4., 3., 18., 3., 2.5, 3., 19., 3.})));
+}
+
 TEST(uKernels, VectorVectorCwiseProductTest) {
   constexpr int kVectorSize = 10;
   static float input1[kVectorSize] = {0.0,  -0.5, 1.0,  -1.5, 2.0,
@@ -21,6 +21,28 @@ namespace tflite {
 
 enum class FusedActivationFunctionType : uint8 { kNone, kRelu6, kRelu1, kRelu };
 
+enum class FusedElementwiseOperation : uint8 {
+  kAdd,
+  kSub,
+  kMul,
+  kDiv,
+  kExp,
+  kLogistic,
+  kTanh,
+  kRelu,
+  kRelu1,
+  kRelu6,
+};
+
+// One step of a chain of fused elementwise operations. The operands index
+// values numbered as follows: the inputs of the chain first, then the results
+// of the previous steps. 'rhs' is -1 for unary operations.
+struct FusedElementwiseStep {
+  FusedElementwiseOperation operation;
+  int lhs;
+  int rhs;
+};
+
 // Quantization parameters, determining the mapping of quantized values
 // to real values (i.e. determining how quantized values are mathematically
 // interpreted).
@@ -41,6 +41,57 @@ TfLiteStatus GetQuantizedConvolutionMultipler(
   return kTfLiteOk;
 }
 
+TfLiteStatus GetPerChannelQuantizedConvolutionMultipliers(
+    TfLiteContext* context, const TfLiteTensor* input,
+    const TfLiteTensor* filter, const TfLiteTensor* bias,
+    const TfLiteTensor* output, int channel_dim,
+    std::vector<double>* multipliers) {
+  TF_LITE_ENSURE_EQ(context, filter->type, kTfLiteInt8);
+  TF_LITE_ENSURE(context, channel_dim < NumDimensions(filter));
+  const int num_channels = SizeOfDimension(filter, channel_dim);
+  const TfLiteAffineQuantization* filter_quantization =
+      filter->affine_quantization;
+  if (filter_quantization) {
+    TF_LITE_ENSURE_EQ(context, filter_quantization->quantized_dimension,
+                      channel_dim);
+    TF_LITE_ENSURE_EQ(context, filter_quantization->scale->size, num_channels);
+  } else {
+    TF_LITE_ENSURE_EQ(context, filter->params.zero_point, 0);
+  }
+  const TfLiteAffineQuantization* bias_quantization =
+      bias ? bias->affine_quantization : nullptr;
+  if (bias_quantization) {
+    TF_LITE_ENSURE_EQ(context, bias_quantization->scale->size, num_channels);
+  }
+  const double output_scale = output->params.scale;
+  TF_LITE_ENSURE(context, output_scale > 0);
+
+  multipliers->resize(num_channels);
+  for (int channel = 0; channel < num_channels; ++channel) {
+    const double filter_scale = filter_quantization
+                                    ? filter_quantization->scale->data[channel]
+                                    : filter->params.scale;
+    if (filter_quantization) {
+      TF_LITE_ENSURE_EQ(context, filter_quantization->zero_point->data[channel],
+                        0);
+    }
+    const double input_product_scale = input->params.scale * filter_scale;
+    TF_LITE_ENSURE(context, input_product_scale >= 0);
+    if (bias) {
+      const double bias_scale = bias_quantization
+                                    ? bias_quantization->scale->data[channel]
+                                    : bias->params.scale;
+      TF_LITE_ENSURE(context,
+                     std::abs(input_product_scale - bias_scale) <=
+                         1e-6 * std::min(input_product_scale, bias_scale));
+    }
+    // Unlike a per-tensor multiplier, these may exceed one for channels of
+    // small weights.
+    (*multipliers)[channel] = input_product_scale / output_scale;
+  }
+  return kTfLiteOk;
+}
+
 void CalculateActivationRangeUint8(TfLiteFusedActivation activation,
                                    TfLiteTensor* output, int32_t* act_min,
                                    int32_t* act_max) {
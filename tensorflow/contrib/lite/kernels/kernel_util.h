@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_LITE_KERNELS_KERNEL_UTIL_H_
 #define TENSORFLOW_CONTRIB_LITE_KERNELS_KERNEL_UTIL_H_
 
+#include <vector>
+
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
 
@@ -32,6 +34,10 @@ inline TfLiteTensor* GetOutput(TfLiteContext* context, TfLiteNode* node,
                                int index) {
   return &context->tensors[node->outputs->data[index]];
 }
+inline TfLiteTensor* GetTemporary(TfLiteContext* context, TfLiteNode* node,
+                                  int index) {
+  return &context->tensors[node->temporaries->data[index]];
+}
 inline int NumInputs(const TfLiteNode* node) { return node->inputs->size; }
 inline int NumOutputs(const TfLiteNode* node) { return node->outputs->size; }
 
@@ -78,6 +84,18 @@ TfLiteStatus GetQuantizedConvolutionMultipler(
     TfLiteContext* context, TfLiteTensor* input, TfLiteTensor* filter,
     TfLiteTensor* bias, TfLiteTensor* output, double* multiplier);
 
+// Calculates the multiplication factors of a quantized convolution, depthwise
+// convolution or fully connected op whose filter holds symmetric int8 values,
+// one per output channel: the channels are the elements of the filter's
+// dimension `channel_dim`. The filter may be quantized per channel along that
+// dimension, or per tensor. Returns an error if the scales of the tensors are
+// not compatible.
+TfLiteStatus GetPerChannelQuantizedConvolutionMultipliers(
+    TfLiteContext* context, const TfLiteTensor* input,
+    const TfLiteTensor* filter, const TfLiteTensor* bias,
+    const TfLiteTensor* output, int channel_dim,
+    std::vector<double>* multipliers);
+
 // Calculates the useful range of an activation layer given its activation
 // tensor.
 void CalculateActivationRangeUint8(TfLiteFusedActivation activation,
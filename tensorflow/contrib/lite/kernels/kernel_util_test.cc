@@ -32,6 +32,10 @@ class KernelUtilTest : public ::testing::Test {
     tensor2_.dims = nullptr;
     tensor1_.allocation_type = kTfLiteMmapRo;
     tensor2_.allocation_type = kTfLiteMmapRo;
+    tensor1_.affine_quantization = nullptr;
+    tensor2_.affine_quantization = nullptr;
+    tensor1_.sparsity = nullptr;
+    tensor2_.sparsity = nullptr;
   }
   ~KernelUtilTest() {
     TfLiteTensorFree(&tensor1_);
@@ -142,6 +146,56 @@ TEST_F(KernelUtilTest, BroadcastShapeDifferentSizes) {
   TfLiteIntArrayFree(output);
 }
 
+TEST_F(KernelUtilTest, PerChannelQuantizedConvolutionMultipliers) {
+  TfLiteTensor input, output;
+  input.params.scale = 0.5;
+  output.params.scale = 0.1;
+
+  // The filter has two output channels along the first dimension.
+  SetShape(&tensor1_, {2, 1, 1, 1});
+  tensor1_.type = kTfLiteInt8;
+  tensor1_.affine_quantization = reinterpret_cast<TfLiteAffineQuantization*>(
+      malloc(sizeof(TfLiteAffineQuantization)));
+  tensor1_.affine_quantization->scale = TfLiteFloatArrayCreate(2);
+  tensor1_.affine_quantization->scale->data[0] = 0.5;
+  tensor1_.affine_quantization->scale->data[1] = 0.25;
+  tensor1_.affine_quantization->zero_point = TfLiteIntArrayCreate(2);
+  tensor1_.affine_quantization->zero_point->data[0] = 0;
+  tensor1_.affine_quantization->zero_point->data[1] = 0;
+  tensor1_.affine_quantization->quantized_dimension = 0;
+
+  SetShape(&tensor2_, {2});
+  tensor2_.type = kTfLiteInt32;
+  tensor2_.affine_quantization = reinterpret_cast<TfLiteAffineQuantization*>(
+      malloc(sizeof(TfLiteAffineQuantization)));
+  tensor2_.affine_quantization->scale = TfLiteFloatArrayCreate(2);
+  tensor2_.affine_quantization->scale->data[0] = 0.25;
+  tensor2_.affine_quantization->scale->data[1] = 0.125;
+  tensor2_.affine_quantization->zero_point = TfLiteIntArrayCreate(2);
+  tensor2_.affine_quantization->zero_point->data[0] = 0;
+  tensor2_.affine_quantization->zero_point->data[1] = 0;
+  tensor2_.affine_quantization->quantized_dimension = 0;
+
+  std::vector<double> multipliers;
+  EXPECT_EQ(kTfLiteOk, GetPerChannelQuantizedConvolutionMultipliers(
+                           &context_, &input, &tensor1_, &tensor2_, &output,
+                           /*channel_dim=*/0, &multipliers));
+  EXPECT_THAT(multipliers,
+              ::testing::ElementsAre(::testing::DoubleNear(2.5, 1e-6),
+                                     ::testing::DoubleNear(1.25, 1e-6)));
+
+  // The channels must be along the quantized dimension.
+  EXPECT_EQ(kTfLiteError, GetPerChannelQuantizedConvolutionMultipliers(
+                              &context_, &input, &tensor1_, &tensor2_, &output,
+                              /*channel_dim=*/3, &multipliers));
+
+  // The bias scales must be the products of the input and filter scales.
+  tensor2_.affine_quantization->scale->data[1] = 0.25;
+  EXPECT_EQ(kTfLiteError, GetPerChannelQuantizedConvolutionMultipliers(
+                              &context_, &input, &tensor1_, &tensor2_, &output,
+                              /*channel_dim=*/0, &multipliers));
+}
+
 }  // namespace
 }  // namespace tflite
 
@@ -250,6 +250,16 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // Check that input tensor dimensions matches with each other.
   CheckInputTensorDimensions(context, node, n_input, n_output, n_cell);
 
+  // Unlike FullyConnected and RNN, LSTM has no hybrid kernel for uint8
+  // weights yet, and toco's --quantize_weights leaves its weights in float.
+  TF_LITE_ENSURE_EQ(context, input->type, kTfLiteFloat32);
+  for (int i = kInputToInputWeightsTensor; i <= kProjectionBiasTensor; ++i) {
+    TfLiteTensor* tensor = GetOptionalInputTensor(context, node, i);
+    if (tensor) {
+      TF_LITE_ENSURE_EQ(context, tensor->type, kTfLiteFloat32);
+    }
+  }
+
   // Get the pointer to output, state and scratch buffer tensors.
   TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
   TfLiteTensor* output_state = GetOutput(context, node, kOutputStateTensor);
@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <gtest/gtest.h>
 #include "tensorflow/contrib/lite/interpreter.h"
 #include "tensorflow/contrib/lite/kernels/register.h"
@@ -125,6 +126,27 @@ TEST(FloatMulOpTest, WithBroadcast) {
   }
 }
 
+// Runs a Mul of two 1x64x64x32 inputs, large enough for the optimized
+// kernel to split its elements across `num_threads` threads.
+std::vector<float> RunLargeMul(int num_threads) {
+  const std::vector<int> shape = {1, 64, 64, 32};
+  FloatMulOpModel m({TensorType_FLOAT32, shape}, {TensorType_FLOAT32, shape},
+                    {TensorType_FLOAT32, {}},
+                    ActivationFunctionType_RELU_N1_TO_1);
+  m.SetNumThreads(num_threads);
+  std::vector<float> input = ArbitraryValues(64 * 64 * 32);
+  m.PopulateTensor(m.input1(), input);
+  std::reverse(input.begin(), input.end());
+  m.PopulateTensor(m.input2(), input);
+  m.Invoke();
+  return m.GetOutput();
+}
+
+TEST(FloatMulOpTest, MultithreadedMatchesSingleThreaded) {
+  EXPECT_THAT(RunLargeMul(/*num_threads=*/4),
+              ElementsAreArray(ArrayFloatNear(RunLargeMul(/*num_threads=*/1))));
+}
+
 TEST(QuantizedMulOpTest, NoActivation) {
   QuantizedMulOpModel m({TensorType_UINT8, {1, 2, 2, 1}, -1.0, 1.0},
                         {TensorType_UINT8, {1, 2, 2, 1}, -1.0, 1.0},
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
 #include "tensorflow/contrib/lite/kernels/padding.h"
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
 
 namespace tflite {
 namespace ops {
@@ -54,10 +55,12 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   // This is a builtin op, so we don't use the contents in 'buffer', if any.
   // Instead, we allocate a new object to carry information from Prepare() to
   // Eval().
+  thread_pool_support::IncrementUsageCounter(context);
   return new OpData;
 }
 
 void Free(TfLiteContext* context, void* buffer) {
+  thread_pool_support::DecrementUsageCounter(context);
   delete reinterpret_cast<OpData*>(buffer);
 }
 
@@ -119,6 +122,33 @@ TfLiteStatus GenericPrepare(TfLiteContext* context, TfLiteNode* node) {
   return context->ResizeTensor(context, output, outputSize);
 }
 
+using FloatPoolFunction = void (*)(const float*, const Dims<4>&, int, int, int,
+                                  int, int, int, float, float, float*,
+                                  const Dims<4>&);
+
+// Runs an optimized float pooling, splitting the output rows across the
+// threads.
+void ParallelPoolFloat(TfLiteContext* context, TfLitePoolParams* params,
+                       OpData* data, TfLiteTensor* input, TfLiteTensor* output,
+                       float activation_min, float activation_max,
+                       FloatPoolFunction pool) {
+  const Dims<4> output_dims = GetTensorDims(output);
+  const int cost_per_output_row = ArraySize(output_dims, 0) *
+                                  ArraySize(output_dims, 1) *
+                                  params->filter_width * params->filter_height;
+  thread_pool_support::ParallelForOutputRows(
+      context, GetTensorDims(input), output_dims, params->stride_height,
+      data->padding.height, params->filter_height, cost_per_output_row,
+      [&](const thread_pool_support::OutputRows& rows) {
+        pool(GetTensorData<float>(input) + rows.input_offset, rows.input_dims,
+             params->stride_width, params->stride_height, data->padding.width,
+             rows.pad_height, params->filter_width, params->filter_height,
+             activation_min, activation_max,
+             GetTensorData<float>(output) + rows.output_offset,
+             rows.output_dims);
+      });
+}
+
 template <KernelType kernel_type>
 void AverageEvalFloat(TfLiteContext* context, TfLiteNode* node,
                       TfLitePoolParams* params, OpData* data,
@@ -135,7 +165,8 @@ void AverageEvalFloat(TfLiteContext* context, TfLiteNode* node,
   if (kernel_type == kReference) {
     TF_LITE_AVERAGE_POOL(reference_ops);
   } else {
-    TF_LITE_AVERAGE_POOL(optimized_ops);
+    ParallelPoolFloat(context, params, data, input, output, activation_min,
+                      activation_max, &optimized_ops::AveragePool);
   }
 #undef TF_LITE_AVERAGE_POOL
 }
@@ -179,7 +210,8 @@ void MaxEvalFloat(TfLiteContext* context, TfLiteNode* node,
   if (kernel_type == kReference) {
     TF_LITE_MAX_POOL(reference_ops);
   } else {
-    TF_LITE_MAX_POOL(optimized_ops);
+    ParallelPoolFloat(context, params, data, input, output, activation_min,
+                      activation_max, &optimized_ops::MaxPool);
   }
 #undef TF_LITE_MAX_POOL
 }
@@ -223,7 +255,8 @@ void L2EvalFloat(TfLiteContext* context, TfLiteNode* node,
   if (kernel_type == kReference) {
     TF_LITE_L2_POOL(reference_ops);
   } else {
-    TF_LITE_L2_POOL(optimized_ops);
+    ParallelPoolFloat(context, params, data, input, output, activation_min,
+                      activation_max, &optimized_ops::L2Pool);
   }
 #undef TF_LITE_L2_POOL
 }
@@ -30,13 +30,14 @@ class BasePoolingOpModel : public SingleOpModel {
   // stride values.
   BasePoolingOpModel(BuiltinOperator type, const TensorData& input,
                      int filter_width, int filter_height,
-                     const TensorData& output) {
+                     const TensorData& output, Padding padding = Padding_VALID,
+                     int stride = 2) {
     input_ = AddInput(input);
     output_ = AddOutput(output);
 
     SetBuiltinOp(
         type, BuiltinOptions_Pool2DOptions,
-        CreatePool2DOptions(builder_, Padding_VALID, 2, 2, filter_width,
+        CreatePool2DOptions(builder_, padding, stride, stride, filter_width,
                             filter_height, ActivationFunctionType_NONE)
             .Union());
 
@@ -55,6 +56,9 @@ class FloatPoolingOpModel : public BasePoolingOpModel {
   void SetInput(std::initializer_list<float> data) {
     PopulateTensor(input_, data);
   }
+  void SetInput(const std::vector<float>& data) {
+    PopulateTensor(input_, data);
+  }
 
   std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
 };
@@ -151,6 +155,38 @@ TEST(FloatPoolingOpTest, L2Pool) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray({3.5, 6.5}));
 }
 
+// Runs a 3x3 pooling on a 2x64x64x16 input, large enough for the optimized
+// kernels to split their output rows across `num_threads` threads.
+std::vector<float> RunLargePooling(BuiltinOperator type, Padding padding,
+                                   int stride, int num_threads) {
+  FloatPoolingOpModel m(type,
+                        /*input=*/{TensorType_FLOAT32, {2, 64, 64, 16}},
+                        /*filter_width=*/3, /*filter_height=*/3,
+                        /*output=*/{TensorType_FLOAT32, {}}, padding, stride);
+  m.SetNumThreads(num_threads);
+  m.SetInput(ArbitraryValues(2 * 64 * 64 * 16));
+  m.Invoke();
+  return m.GetOutput();
+}
+
+TEST(FloatPoolingOpTest, MultithreadedMatchesSingleThreaded) {
+  // With SAME padding, the rows of the first thread are padded at the top and
+  // those of the last one at the bottom.
+  for (BuiltinOperator type :
+       {BuiltinOperator_AVERAGE_POOL_2D, BuiltinOperator_MAX_POOL_2D,
+        BuiltinOperator_L2_POOL_2D}) {
+    for (Padding padding : {Padding_VALID, Padding_SAME}) {
+      for (int stride : {1, 2}) {
+        EXPECT_THAT(RunLargePooling(type, padding, stride, /*num_threads=*/4),
+                    ElementsAreArray(ArrayFloatNear(RunLargePooling(
+                        type, padding, stride, /*num_threads=*/1))))
+            << EnumNameBuiltinOperator(type) << ", "
+            << EnumNamePadding(padding) << ", stride " << stride;
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace tflite
 
@@ -21,6 +21,7 @@ namespace ops {
 namespace custom {
 
 TfLiteRegistration* Register_AUDIO_SPECTROGRAM();
+TfLiteRegistration* Register_FUSED_ELEMENTWISE();
 TfLiteRegistration* Register_MFCC();
 
 }  // namespace custom
@@ -147,6 +148,8 @@ BuiltinOpResolver::BuiltinOpResolver() {
   AddCustom("Mfcc", tflite::ops::custom::Register_MFCC());
   AddCustom("AudioSpectrogram",
             tflite::ops::custom::Register_AUDIO_SPECTROGRAM());
+  AddCustom("FusedElementwise",
+            tflite::ops::custom::Register_FUSED_ELEMENTWISE());
 }
 
 TfLiteRegistration* BuiltinOpResolver::FindOp(
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/contrib/lite/kernels/test_util.h"
 
+#include <algorithm>
+
+#include "tensorflow/contrib/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/contrib/lite/version.h"
 #include "tensorflow/core/platform/logging.h"
 
@@ -49,7 +52,16 @@ std::vector<Matcher<float>> ArrayFloatNear(const std::vector<float>& values,
   return matchers;
 }
 
-int SingleOpModel::AddTensor(TensorData t, std::initializer_list<int> data) {
+std::vector<float> ArbitraryValues(int size) {
+  std::vector<float> values(size);
+  for (int i = 0; i < size; ++i) {
+    values[i] = (i * 37 % 101) / 50.0f - 1.0f;
+  }
+  return values;
+}
+
+template <typename T>
+int SingleOpModel::AddTensor(TensorData t, std::initializer_list<T> data) {
   int id = tensors_.size();
 
   // This is slightly different depending on whether we are adding a
@@ -58,7 +70,13 @@ int SingleOpModel::AddTensor(TensorData t, std::initializer_list<int> data) {
 
   flatbuffers::Offset<QuantizationParameters> q_params = 0;
 
-  if (is_quantized) {
+  if (!t.per_channel_scales.empty()) {
+    std::vector<int64_t> zero_points(t.per_channel_scales.size(), 0);
+    q_params = CreateQuantizationParameters(
+        builder_, /*min=*/0, /*max=*/0,
+        builder_.CreateVector<float>(t.per_channel_scales),
+        builder_.CreateVector<int64_t>(zero_points), t.quantized_dimension);
+  } else if (is_quantized) {
     if (t.min != 0 || t.max != 0) {
       if (t.type == TensorType_UINT8) {
         std::tie(t.scale, t.zero_point) =
@@ -89,7 +107,7 @@ int SingleOpModel::AddTensor(TensorData t, std::initializer_list<int> data) {
     buffer_id = buffers_.size();
     auto data_buffer =
         builder_.CreateVector(reinterpret_cast<const uint8_t*>(data.begin()),
-                              sizeof(int) * data.size());
+                              sizeof(T) * data.size());
     buffers_.push_back(CreateBuffer(builder_, data_buffer));
   }
 
@@ -102,8 +120,23 @@ int SingleOpModel::AddTensor(TensorData t, std::initializer_list<int> data) {
   return id;
 }
 
+void SingleOpModel::SymmetricQuantizeAndPopulate(
+    int index, std::initializer_list<float> data) {
+  TfLiteTensor* t = interpreter_->tensor(index);
+  std::vector<float> values(data);
+  const int length = values.size();
+  std::vector<int8_t> q(length);
+  float min, max, scaling_factor;
+  tensor_utils::SymmetricQuantizeFloats(values.data(), length, q.data(), &min,
+                                        &max, &scaling_factor);
+  t->params.scale = scaling_factor;
+  t->params.zero_point = 0;
+  PopulateTensor(index, /*offset=*/0, reinterpret_cast<uint8_t*>(q.data()),
+                 reinterpret_cast<uint8_t*>(q.data() + q.size()));
+}
+
 int SingleOpModel::AddInput(const TensorData& t) {
-  int id = AddTensor(t, {});
+  int id = AddTensor<int>(t, {});
   inputs_.push_back(id);
   return id;
 }
@@ -116,6 +149,71 @@ int SingleOpModel::AddConstInput(TensorType type,
   return id;
 }
 
+int SingleOpModel::AddConstInput(TensorType type,
+                                 std::initializer_list<float> data,
+                                 std::initializer_list<int> shape) {
+  int id = AddTensor(TensorData{type, shape}, data);
+  inputs_.push_back(id);
+  return id;
+}
+
+int SingleOpModel::AddSparseConstInput(std::initializer_list<float> data,
+                                       std::initializer_list<int> shape,
+                                       int block_rows, int block_cols) {
+  const std::vector<float> values(data);
+  const std::vector<int> dims(shape);
+  const int cols = dims.back();
+  const int rows = values.size() / cols;
+  CHECK_EQ(rows % block_rows, 0);
+  CHECK_EQ(cols % block_cols, 0);
+
+  // Keep the blocks that have a non-zero value, row of blocks by row of
+  // blocks.
+  std::vector<float> blocks;
+  std::vector<int> row_segments = {0};
+  std::vector<int> col_indices;
+  for (int block_row = 0; block_row < rows / block_rows; ++block_row) {
+    for (int block_col = 0; block_col < cols / block_cols; ++block_col) {
+      std::vector<float> block;
+      for (int r = 0; r < block_rows; ++r) {
+        const int row_start = (block_row * block_rows + r) * cols;
+        for (int c = 0; c < block_cols; ++c) {
+          block.push_back(values[row_start + block_col * block_cols + c]);
+        }
+      }
+      if (std::any_of(block.begin(), block.end(),
+                      [](float value) { return value != 0; })) {
+        blocks.insert(blocks.end(), block.begin(), block.end());
+        col_indices.push_back(block_col);
+      }
+    }
+    row_segments.push_back(col_indices.size());
+  }
+
+  int buffer_id = 0;
+  if (!blocks.empty()) {
+    if (buffers_.empty()) {
+      buffers_.push_back(CreateBuffer(builder_, builder_.CreateVector({})));
+    }
+    buffer_id = buffers_.size();
+    buffers_.push_back(CreateBuffer(
+        builder_,
+        builder_.CreateVector(reinterpret_cast<const uint8_t*>(blocks.data()),
+                              sizeof(float) * blocks.size())));
+  }
+  auto sparsity = CreateSparsityParameters(
+      builder_, block_rows, block_cols, builder_.CreateVector(row_segments),
+      builder_.CreateVector(col_indices));
+
+  int id = tensors_.size();
+  tensors_.push_back(CreateTensor(builder_, builder_.CreateVector<int>(dims),
+                                  TensorType_FLOAT32, buffer_id, /*name=*/0,
+                                  /*quantization=*/0, sparsity));
+  tensor_data_[id] = TensorData{TensorType_FLOAT32, dims};
+  inputs_.push_back(id);
+  return id;
+}
+
 int SingleOpModel::AddNullInput() {
   int id = kOptionalTensor;
   inputs_.push_back(id);
@@ -123,7 +221,7 @@ int SingleOpModel::AddNullInput() {
 }
 
 int SingleOpModel::AddOutput(const TensorData& t) {
-  int id = AddTensor(t, {});
+  int id = AddTensor<int>(t, {});
   outputs_.push_back(id);
   return id;
 }
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_LITE_KERNELS_TEST_UTIL_H_
 #define TENSORFLOW_CONTRIB_LITE_KERNELS_TEST_UTIL_H_
 
+#include <algorithm>
 #include <vector>
 
 #include <gmock/gmock.h>
@@ -34,6 +35,10 @@ namespace tflite {
 std::vector<::testing::Matcher<float>> ArrayFloatNear(
     const std::vector<float>& values, float max_abs_error = 1e-5);
 
+// Returns `size` arbitrary but deterministic values in [-1, 1], to fill the
+// tensors of larger tests.
+std::vector<float> ArbitraryValues(int size);
+
 template <typename T>
 inline std::vector<T> Quantize(const std::vector<float>& data, float scale,
                                int32_t zero_point) {
@@ -83,6 +88,10 @@ struct TensorData {
   float max;
   float scale;
   int32_t zero_point;
+  // When not empty, the tensor is quantized symmetrically along dimension
+  // 'quantized_dimension', with one scale per index of that dimension.
+  std::vector<float> per_channel_scales;
+  int quantized_dimension;
 };
 
 class SingleOpResolver : public OpResolver {
@@ -118,6 +127,15 @@ class SingleOpModel {
   // Add a Tensor containing const data and return the tensor id.
   int AddConstInput(TensorType type, std::initializer_list<int> data,
                     std::initializer_list<int> shape);
+  int AddConstInput(TensorType type, std::initializer_list<float> data,
+                    std::initializer_list<int> shape);
+
+  // Add a float Tensor containing const data, of which only the blocks of
+  // block_rows x block_cols values that are not all zeros are stored (see
+  // SparsityParameters), and return the tensor id. `data` holds all the values.
+  int AddSparseConstInput(std::initializer_list<float> data,
+                          std::initializer_list<int> shape, int block_rows,
+                          int block_cols);
 
   // Add a null input tensor (optional input) and return kOptionalTensor.
   int AddNullInput();
@@ -133,6 +151,36 @@ class SingleOpModel {
     PopulateTensor(index, 0, q.data(), q.data() + q.size());
   }
 
+  // Quantizes `data` symmetrically into int8 values, stores their bit
+  // patterns in the uint8 tensor `index` and sets its scale accordingly, with
+  // a zero point of 0. This is how hybrid kernels expect their weights.
+  void SymmetricQuantizeAndPopulate(int index,
+                                    std::initializer_list<float> data);
+
+  // Quantizes `data` into the tensor `index`, which must have been added with
+  // per-channel scales, using the scale of the channel of each element.
+  template <typename T>
+  void PerChannelQuantizeAndPopulate(int index,
+                                     std::initializer_list<float> data) {
+    const TensorData& t = tensor_data_.at(index);
+    int inner_size = 1;
+    for (int i = t.quantized_dimension + 1; i < t.shape.size(); ++i) {
+      inner_size *= t.shape[i];
+    }
+    const int num_channels = t.per_channel_scales.size();
+    std::vector<T> q;
+    int i = 0;
+    for (float f : data) {
+      const float scale = t.per_channel_scales[(i++ / inner_size) %
+                                               num_channels];
+      const float rounded = std::round(f / scale);
+      q.push_back(static_cast<T>(std::max<float>(
+          std::numeric_limits<T>::min(),
+          std::min<float>(std::numeric_limits<T>::max(), rounded))));
+    }
+    PopulateTensor(index, 0, q.data(), q.data() + q.size());
+  }
+
   const std::vector<int>& GetShape(int id) { return tensor_data_.at(id).shape; }
 
   float GetScale(int id) { return tensor_data_.at(id).scale; }
@@ -151,6 +199,12 @@ class SingleOpModel {
 
   void Invoke();
 
+  // Set the number of threads of the interpreter, and so of the thread pools
+  // of the kernels.
+  void SetNumThreads(int num_threads) {
+    interpreter_->SetNumThreads(num_threads);
+  }
+
   void PopulateStringTensor(int index, const std::vector<string>& content) {
     auto tensor = interpreter_->tensor(index);
     DynamicBuffer buf;
@@ -171,6 +225,14 @@ class SingleOpModel {
     }
   }
 
+  // Populate the tensor given its index, from a vector.
+  template <typename T>
+  void PopulateTensor(int index, const std::vector<T>& data) {
+    T* v = interpreter_->typed_tensor<T>(index);
+    CHECK(v) << "No tensor with index '" << index << "'.";
+    std::copy(data.begin(), data.end(), v);
+  }
+
   // Partially populate the tensor, starting at the given offset.
   template <typename T>
   void PopulateTensor(int index, int offset, T* begin, T* end) {
@@ -207,7 +269,8 @@ class SingleOpModel {
   std::unique_ptr<OpResolver> resolver_;
 
  private:
-  int AddTensor(TensorData t, std::initializer_list<int> data);
+  template <typename T>
+  int AddTensor(TensorData t, std::initializer_list<T> data);
 
   std::map<int, TensorData> tensor_data_;
   std::vector<int32_t> inputs_;
@@ -0,0 +1,242 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
+
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "tensorflow/contrib/lite/kernels/op_macros.h"
+
+namespace tflite {
+namespace thread_pool_support {
+namespace {
+
+// The smallest cost, in multiply-adds, worth running on another thread.
+constexpr int kMinCostPerShard = 1 << 15;
+
+// Runs the shards of one job at a time on its workers and the calling thread.
+class ThreadPool {
+ public:
+  explicit ThreadPool(int num_threads) : num_threads_(num_threads) {
+    for (int i = 1; i < num_threads; ++i) {
+      workers_.emplace_back([this]() { WorkerLoop(); });
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    work_available_.notify_all();
+    for (auto& worker : workers_) worker.join();
+  }
+
+  int num_threads() const { return num_threads_; }
+
+  // Calls 'fn(shard)' for every shard in [0, num_shards).
+  void Run(int num_shards, const std::function<void(int)>& fn) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    job_ = &fn;
+    num_shards_ = num_shards;
+    next_shard_ = 0;
+    num_pending_shards_ = num_shards;
+    ++generation_;
+    work_available_.notify_all();
+    RunShards(&lock);
+    job_done_.wait(lock, [this]() { return num_pending_shards_ == 0; });
+    job_ = nullptr;
+  }
+
+ private:
+  void WorkerLoop() {
+    int generation = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      work_available_.wait(lock, [this, generation]() {
+        return stop_ || generation_ != generation;
+      });
+      if (stop_) return;
+      generation = generation_;
+      RunShards(&lock);
+    }
+  }
+
+  // Runs the shards no thread has started yet. 'lock' holds 'mutex_'.
+  void RunShards(std::unique_lock<std::mutex>* lock) {
+    while (next_shard_ < num_shards_) {
+      const int shard = next_shard_++;
+      lock->unlock();
+      (*job_)(shard);
+      lock->lock();
+      if (--num_pending_shards_ == 0) job_done_.notify_all();
+    }
+  }
+
+  const int num_threads_;
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable job_done_;
+  bool stop_ = false;
+  // Incremented for every job, so that the workers can tell a new job.
+  int generation_ = 0;
+  const std::function<void(int)>* job_ = nullptr;
+  int num_shards_ = 0;
+  int next_shard_ = 0;
+  int num_pending_shards_ = 0;
+};
+
+struct RefCountedThreadPool {
+  // Null when the ops run on the calling thread only.
+  std::unique_ptr<ThreadPool> thread_pool_;
+  int num_references_ = 0;
+};
+
+void ResetThreadPool(RefCountedThreadPool* ptr, int num_threads) {
+  if (num_threads > 1) {
+    ptr->thread_pool_.reset(new ThreadPool(num_threads));
+  } else {
+    ptr->thread_pool_.reset();
+  }
+}
+
+ThreadPool* GetThreadPool(TfLiteContext* context) {
+  auto* ptr =
+      reinterpret_cast<RefCountedThreadPool*>(context->thread_pool_context);
+  if (ptr == nullptr) {
+    TF_LITE_FATAL(
+        "Call to ParallelFor() not preceded by IncrementUsageCounter()");
+  }
+  return ptr->thread_pool_.get();
+}
+
+}  // namespace
+
+void IncrementUsageCounter(TfLiteContext* context) {
+  auto* ptr =
+      reinterpret_cast<RefCountedThreadPool*>(context->thread_pool_context);
+  if (ptr == nullptr) {
+    ptr = new RefCountedThreadPool;
+    ResetThreadPool(ptr, context->recommended_num_threads);
+    ptr->num_references_ = 0;
+    context->thread_pool_context = ptr;
+  }
+  ptr->num_references_++;
+}
+
+void DecrementUsageCounter(TfLiteContext* context) {
+  auto* ptr =
+      reinterpret_cast<RefCountedThreadPool*>(context->thread_pool_context);
+  if (ptr == nullptr) {
+    TF_LITE_FATAL(
+        "Call to DecrementUsageCounter() not preceded by "
+        "IncrementUsageCounter()");
+  }
+  if (--ptr->num_references_ == 0) {
+    delete ptr;
+    context->thread_pool_context = nullptr;
+  }
+}
+
+void SetNumThreads(TfLiteContext* context, int num_threads) {
+  context->recommended_num_threads = num_threads;
+  auto* ptr =
+      reinterpret_cast<RefCountedThreadPool*>(context->thread_pool_context);
+  // Otherwise the thread pool is created when an op first needs it.
+  if (ptr == nullptr) return;
+  const int current_num_threads =
+      ptr->thread_pool_ ? ptr->thread_pool_->num_threads() : 1;
+  if (std::max(num_threads, 1) != current_num_threads) {
+    ResetThreadPool(ptr, num_threads);
+  }
+}
+
+void ParallelFor(TfLiteContext* context, int size, int cost_per_item,
+                 const std::function<void(int start, int end)>& fn) {
+  ThreadPool* thread_pool = GetThreadPool(context);
+  const int64_t total_cost =
+      static_cast<int64_t>(size) * std::max(cost_per_item, 1);
+  const int num_shards =
+      thread_pool == nullptr
+          ? 1
+          : static_cast<int>(std::min<int64_t>(
+                {thread_pool->num_threads(), total_cost / kMinCostPerShard,
+                 static_cast<int64_t>(size)}));
+  if (num_shards <= 1) {
+    if (size > 0) fn(0, size);
+    return;
+  }
+  thread_pool->Run(num_shards, [size, num_shards, &fn](int shard) {
+    const int start = static_cast<int64_t>(size) * shard / num_shards;
+    const int end = static_cast<int64_t>(size) * (shard + 1) / num_shards;
+    fn(start, end);
+  });
+}
+
+void ParallelForOutputRows(TfLiteContext* context, const Dims<4>& input_dims,
+                           const Dims<4>& output_dims, int stride_height,
+                           int pad_height, int filter_height,
+                           int cost_per_output_row,
+                           const std::function<void(const OutputRows&)>& fn) {
+  const int batches = output_dims.sizes[3];
+  const int input_height = input_dims.sizes[2];
+  const int output_height = output_dims.sizes[2];
+  ParallelFor(
+      context, batches * output_height, cost_per_output_row,
+      [&](int start, int end) {
+        // Ranges do not span batches, so that each one is contiguous.
+        for (int row = start; row < end;) {
+          const int batch = row / output_height;
+          const int out_y_start = row % output_height;
+          const int out_y_end =
+              std::min(output_height, out_y_start + (end - row));
+          // The input rows read by the output rows, within the input.
+          const int in_y_start =
+              std::max(0, out_y_start * stride_height - pad_height);
+          const int in_y_end =
+              std::min(input_height, (out_y_end - 1) * stride_height -
+                                         pad_height + filter_height);
+
+          OutputRows rows;
+          rows.input_offset = batch * input_dims.strides[3] +
+                              in_y_start * input_dims.strides[2];
+          rows.input_dims = input_dims;
+          rows.input_dims.sizes[2] = std::max(0, in_y_end - in_y_start);
+          rows.input_dims.sizes[3] = 1;
+          rows.input_dims.strides[3] =
+              input_dims.strides[2] * rows.input_dims.sizes[2];
+          rows.pad_height =
+              pad_height + in_y_start - out_y_start * stride_height;
+          rows.output_offset = batch * output_dims.strides[3] +
+                               out_y_start * output_dims.strides[2];
+          rows.output_dims = output_dims;
+          rows.output_dims.sizes[2] = out_y_end - out_y_start;
+          rows.output_dims.sizes[3] = 1;
+          rows.output_dims.strides[3] =
+              output_dims.strides[2] * rows.output_dims.sizes[2];
+          fn(rows);
+          row += out_y_end - out_y_start;
+        }
+      });
+}
+
+}  // namespace thread_pool_support
+}  // namespace tflite
@@ -0,0 +1,83 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_KERNELS_THREAD_POOL_SUPPORT_H_
+#define TENSORFLOW_CONTRIB_LITE_KERNELS_THREAD_POOL_SUPPORT_H_
+
+#include <functional>
+
+#include "tensorflow/contrib/lite/context.h"
+#include "tensorflow/contrib/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace thread_pool_support {
+
+// Let the framework know that the thread pool stored in 'context' will be
+// used by an op. If necessary a new thread pool, with
+// 'context->recommended_num_threads' threads, is created and placed in
+// 'context'. For example, in the implementation of an op:
+//   void* Init(TfLiteContext* context, const char*, size_t) {
+//     thread_pool_support::IncrementUsageCounter(context);
+//     return nullptr;
+//   }
+//   void Free(TfLiteContext* context, void*) {
+//     thread_pool_support::DecrementUsageCounter(context);
+//   }
+//   TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+//     thread_pool_support::ParallelFor(context, size, cost, ...);
+//   }
+void IncrementUsageCounter(TfLiteContext* context);
+
+// Let the framework know that the op stopped using the thread pool stored in
+// 'context'. If there are no more usages the thread pool will be deleted.
+void DecrementUsageCounter(TfLiteContext* context);
+
+// Set the number of threads of the thread pool, the calling thread included,
+// and 'context->recommended_num_threads'. With -1 or 1, the ops run on the
+// calling thread only.
+void SetNumThreads(TfLiteContext* context, int num_threads);
+
+// Calls 'fn(start, end)' on consecutive shards of [0, size), concurrently on
+// the threads of the pool stored in 'context', and returns once all of them
+// are done. Each item costs about 'cost_per_item' multiply-adds: shards get
+// enough items to be worth handing to another thread, so small ops run on
+// the calling thread only. 'fn' must be thread-safe.
+void ParallelFor(TfLiteContext* context, int size, int cost_per_item,
+                 const std::function<void(int start, int end)>& fn);
+
+// A range of the output rows of one batch of a windowed op, such as a
+// convolution or a pooling, and the input rows it reads. The dims describe a
+// batch of one, starting at the given offsets into the full arrays, and the
+// padding is that of the first input row.
+struct OutputRows {
+  int input_offset;
+  Dims<4> input_dims;
+  int pad_height;
+  int output_offset;
+  Dims<4> output_dims;
+};
+
+// Splits the output of a windowed op into ranges of output rows and calls
+// 'fn' on them with ParallelFor(). 'cost_per_output_row' is the cost of one
+// row of the output.
+void ParallelForOutputRows(TfLiteContext* context, const Dims<4>& input_dims,
+                           const Dims<4>& output_dims, int stride_height,
+                           int pad_height, int filter_height,
+                           int cost_per_output_row,
+                           const std::function<void(const OutputRows&)>& fn);
+
+}  // namespace thread_pool_support
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_KERNELS_THREAD_POOL_SUPPORT_H_
@@ -0,0 +1,195 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
+
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <set>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/kernels/internal/reference/depthwiseconv_float.h"
+#include "tensorflow/contrib/lite/kernels/internal/tensor.h"
+#include "tensorflow/contrib/lite/testing/util.h"
+
+namespace tflite {
+namespace thread_pool_support {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+class ThreadPoolSupportTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    context_.thread_pool_context = nullptr;
+    context_.recommended_num_threads = -1;
+  }
+
+  void TearDown() override {
+    EXPECT_TRUE(context_.thread_pool_context == nullptr);
+  }
+
+  // Returns the items covered by each call of ParallelFor(), and the threads
+  // the calls ran on.
+  std::vector<std::pair<int, int>> Shards(int size, int cost_per_item,
+                                          std::set<std::thread::id>* threads) {
+    std::mutex mutex;
+    std::vector<std::pair<int, int>> shards;
+    ParallelFor(&context_, size, cost_per_item, [&](int start, int end) {
+      std::lock_guard<std::mutex> lock(mutex);
+      shards.emplace_back(start, end);
+      threads->insert(std::this_thread::get_id());
+    });
+    std::sort(shards.begin(), shards.end());
+    return shards;
+  }
+
+  TfLiteContext context_;
+};
+
+TEST_F(ThreadPoolSupportTest, RunsOnCallingThreadByDefault) {
+  IncrementUsageCounter(&context_);
+  std::set<std::thread::id> threads;
+  EXPECT_THAT(Shards(100, 1 << 20, &threads),
+              ElementsAreArray({std::make_pair(0, 100)}));
+  EXPECT_THAT(threads, ElementsAreArray({std::this_thread::get_id()}));
+  DecrementUsageCounter(&context_);
+}
+
+TEST_F(ThreadPoolSupportTest, SplitsLargeWork) {
+  context_.recommended_num_threads = 4;
+  IncrementUsageCounter(&context_);
+  std::set<std::thread::id> threads;
+  EXPECT_THAT(Shards(10, 1 << 20, &threads),
+              ElementsAreArray({std::make_pair(0, 2), std::make_pair(2, 5),
+                                std::make_pair(5, 7), std::make_pair(7, 10)}));
+  EXPECT_GE(threads.size(), 1);
+  EXPECT_LE(threads.size(), 4);
+
+  // Fewer items than threads.
+  EXPECT_THAT(Shards(2, 1 << 20, &threads),
+              ElementsAreArray({std::make_pair(0, 1), std::make_pair(1, 2)}));
+  EXPECT_TRUE(Shards(0, 1 << 20, &threads).empty());
+  DecrementUsageCounter(&context_);
+}
+
+TEST_F(ThreadPoolSupportTest, KeepsSmallWorkOnOneThread) {
+  context_.recommended_num_threads = 4;
+  IncrementUsageCounter(&context_);
+  std::set<std::thread::id> threads;
+  EXPECT_THAT(Shards(1000, 1, &threads),
+              ElementsAreArray({std::make_pair(0, 1000)}));
+  // Only enough work for two shards.
+  EXPECT_THAT(Shards(64 * 1024, 1, &threads),
+              ElementsAreArray({std::make_pair(0, 32 * 1024),
+                                std::make_pair(32 * 1024, 64 * 1024)}));
+  DecrementUsageCounter(&context_);
+}
+
+TEST_F(ThreadPoolSupportTest, SetNumThreads) {
+  IncrementUsageCounter(&context_);
+  std::set<std::thread::id> threads;
+  SetNumThreads(&context_, 3);
+  EXPECT_EQ(context_.recommended_num_threads, 3);
+  EXPECT_EQ(Shards(9, 1 << 20, &threads).size(), 3);
+  SetNumThreads(&context_, 1);
+  EXPECT_EQ(Shards(9, 1 << 20, &threads).size(), 1);
+  DecrementUsageCounter(&context_);
+}
+
+TEST_F(ThreadPoolSupportTest, ManyJobs) {
+  context_.recommended_num_threads = 8;
+  IncrementUsageCounter(&context_);
+  std::vector<std::atomic<int>> counts(64);
+  for (int job = 0; job < 1000; ++job) {
+    ParallelFor(&context_, counts.size(), 1 << 20, [&](int start, int end) {
+      for (int i = start; i < end; ++i) counts[i]++;
+    });
+  }
+  for (const auto& count : counts) {
+    EXPECT_EQ(count, 1000);
+  }
+  DecrementUsageCounter(&context_);
+}
+
+// Computes a depthwise convolution with ParallelForOutputRows(), which must
+// give the same result as computing it at once.
+std::vector<float> DepthwiseConv(TfLiteContext* context, int stride,
+                                 int pad_height, bool shard) {
+  const int batches = 2, height = 9, width = 5, depth = 3, filter_size = 3;
+  const int output_height = (height + 2 * pad_height - filter_size) / stride + 1;
+  const int output_width = (width - filter_size) / stride + 1;
+  const Dims<4> input_dims = GetTensorDims({batches, height, width, depth});
+  const Dims<4> filter_dims =
+      GetTensorDims({1, filter_size, filter_size, depth});
+  const Dims<4> bias_dims = GetTensorDims({depth});
+  const Dims<4> output_dims =
+      GetTensorDims({batches, output_height, output_width, depth});
+
+  std::vector<float> input(FlatSize(input_dims));
+  for (int i = 0; i < input.size(); ++i) input[i] = (i * 7 % 11) - 5;
+  std::vector<float> filter(FlatSize(filter_dims));
+  for (int i = 0; i < filter.size(); ++i) filter[i] = (i * 5 % 7) - 3;
+  const std::vector<float> bias = {1, -1, 0.5};
+  std::vector<float> output(FlatSize(output_dims));
+
+  auto depthwise_conv = [&](const float* input_data, const Dims<4>& input_dims,
+                            int pad_height, float* output_data,
+                            const Dims<4>& output_dims) {
+    reference_ops::DepthwiseConv(
+        input_data, input_dims, filter.data(), filter_dims, bias.data(),
+        bias_dims, stride, stride, /*pad_width=*/0, pad_height,
+        /*depth_multiplier=*/1, -100.f, 100.f, output_data, output_dims);
+  };
+  if (shard) {
+    ParallelForOutputRows(
+        context, input_dims, output_dims, stride, pad_height, filter_size,
+        /*cost_per_output_row=*/1 << 20, [&](const OutputRows& rows) {
+          depthwise_conv(input.data() + rows.input_offset, rows.input_dims,
+                         rows.pad_height, output.data() + rows.output_offset,
+                         rows.output_dims);
+        });
+  } else {
+    depthwise_conv(input.data(), input_dims, pad_height, output.data(),
+                   output_dims);
+  }
+  return output;
+}
+
+TEST_F(ThreadPoolSupportTest, ParallelForOutputRows) {
+  context_.recommended_num_threads = 3;
+  IncrementUsageCounter(&context_);
+  for (int stride : {1, 2}) {
+    for (int pad_height : {0, 1, 2}) {
+      EXPECT_THAT(DepthwiseConv(&context_, stride, pad_height, /*shard=*/true),
+                  ElementsAreArray(DepthwiseConv(&context_, stride, pad_height,
+                                                 /*shard=*/false)))
+          << "stride " << stride << " pad " << pad_height;
+    }
+  }
+  DecrementUsageCounter(&context_);
+}
+
+}  // namespace
+}  // namespace thread_pool_support
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -60,6 +60,9 @@ TfLiteStatus ConvertTensorType(TensorType tensor_type, TfLiteType* type,
     case TensorType_BOOL:
       *type = kTfLiteBool;
       break;
+    case TensorType_INT8:
+      *type = kTfLiteInt8;
+      break;
     default:
       error_reporter->Report("Unimplemented data type %s (%d) in tensor\n",
                              EnumNameTensorType(tensor_type), tensor_type);
@@ -750,32 +753,44 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
     TfLiteQuantizationParams quantization;
     quantization.scale = 0;
     quantization.zero_point = 0;
+    // Tensors quantized along one of their dimensions have a scale and a zero
+    // point per index of that dimension instead.
+    std::vector<float> per_channel_scales;
+    std::vector<int> per_channel_zero_points;
+    int quantized_dimension = 0;
     auto* q_params = tensor->quantization();
     if (q_params) {
-      // Note that the schema could hold per-channel quantization parameters
-      // but we really only support one value for the whole tensor.
       // TODO(aselle): This breaks as well if these are nullptr's.
-      // TODO(aselle): This assumes non per-channel quantization.
-
-      if (q_params->scale()) {
-        if (q_params->scale()->size() != 1) {
+      const int num_scales = q_params->scale() ? q_params->scale()->size() : 0;
+      const int num_zero_points =
+          q_params->zero_point() ? q_params->zero_point()->size() : 0;
+      if (num_scales > 1) {
+        if (num_zero_points != num_scales) {
           error_reporter_->Report(
-              "QuantizationParam has %d scale values (only 1 is supported).",
-              q_params->scale()->size());
+              "QuantizationParam has %d scale values but %d zero_point "
+              "values.",
+              num_scales, num_zero_points);
           return kTfLiteError;
         }
-        quantization.scale = q_params->scale()->Get(0);
-      }
-
-      if (q_params->zero_point()) {
-        if (q_params->zero_point()->size() != 1) {
+        for (int j = 0; j < num_scales; ++j) {
+          per_channel_scales.push_back(q_params->scale()->Get(j));
+          per_channel_zero_points.push_back(q_params->zero_point()->Get(j));
+        }
+        quantized_dimension = q_params->quantized_dimension();
+      } else {
+        if (num_zero_points > 1) {
           error_reporter_->Report(
               "QuantizationParam has %d zero_point values"
-              " (only 1 is supported).",
-              q_params->zero_point()->size());
+              " but only %d scale values.",
+              num_zero_points, num_scales);
           return kTfLiteError;
         }
-        quantization.zero_point = q_params->zero_point()->Get(0);
+        if (num_scales == 1) {
+          quantization.scale = q_params->scale()->Get(0);
+        }
+        if (num_zero_points == 1) {
+          quantization.zero_point = q_params->zero_point()->Get(0);
+        }
       }
     }
 
@@ -812,7 +827,23 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
     const char* buffer_ptr;
     TF_LITE_ENSURE_STATUS(get_readonly_data(&buffer_ptr, &buffer_size));
 
-    if (buffer_ptr) {
+    // Sparse tensors only store their non-zero blocks, possibly none.
+    if (auto* sparsity = tensor->sparsity()) {
+      auto to_vector = [](const flatbuffers::Vector<int32_t>* indices) {
+        return indices ? FlatBufferIntArrayToVector(indices)
+                       : std::vector<int>();
+      };
+      if (interpreter->SetTensorParametersReadOnlySparse(
+              i, type, get_name(tensor), dims, quantization,
+              sparsity->block_rows(), sparsity->block_cols(),
+              to_vector(sparsity->row_segments()),
+              to_vector(sparsity->col_indices()), buffer_ptr, buffer_size,
+              allocation_) != kTfLiteOk) {
+        error_reporter_->Report("Tensor %d has invalid sparsity in schema.\n",
+                                i);
+        status = kTfLiteError;
+      }
+    } else if (buffer_ptr) {
       if (interpreter->SetTensorParametersReadOnly(
               i, type, get_name(tensor), dims, quantization, buffer_ptr,
               buffer_size, allocation_) != kTfLiteOk) {
@@ -828,6 +859,14 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
         status = kTfLiteError;
       }
     }
+    if (!per_channel_scales.empty() &&
+        interpreter->SetTensorPerChannelQuantization(
+            i, per_channel_scales, per_channel_zero_points,
+            quantized_dimension) != kTfLiteOk) {
+      error_reporter_->Report(
+          "Tensor %d has invalid per-channel quantization in schema.\n", i);
+      status = kTfLiteError;
+    }
   }
 
   return status;
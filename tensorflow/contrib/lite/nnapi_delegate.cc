@@ -100,6 +100,9 @@ uint32_t addTensorOperands(tflite::Interpreter* interpreter,
       default:
         FATAL("Unsupported type.");
     }
+    if (tensor->sparsity) {
+      FATAL("Sparse tensors are not supported.");
+    }
     // TODO(aselle): Note, many of these are intermediate results. Do I need
     // to ever specify these sizes. I am currently below doing setValue
     // on all of them, but I shouldn't in the future.
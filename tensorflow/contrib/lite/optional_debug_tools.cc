@@ -50,6 +50,8 @@ const char* TensorTypeName(TfLiteType type) {
       return "kTfLiteString";
     case kTfLiteBool:
       return "kTfLiteBool";
+    case kTfLiteInt8:
+      return "kTfLiteInt8";
   }
   return "(invalid)";
 }
@@ -78,6 +80,12 @@ void PrintInterpreterState(Interpreter* interpreter) {
   PrintIntVector(interpreter->inputs());
   printf("Outputs:");
   PrintIntVector(interpreter->outputs());
+  size_t arena_bytes;
+  size_t ideal_arena_bytes;
+  interpreter->GetArenaBytes(&arena_bytes, &ideal_arena_bytes);
+  printf("Arena: %zu bytes (%4.1f MB), ideal %zu bytes (%4.1f MB)\n",
+         arena_bytes, float(arena_bytes) / float(1 << 20), ideal_arena_bytes,
+         float(ideal_arena_bytes) / float(1 << 20));
   printf("\n");
   for (int tensor_index = 0; tensor_index < interpreter->tensors_size();
        tensor_index++) {
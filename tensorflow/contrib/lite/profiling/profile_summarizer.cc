@@ -0,0 +1,361 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/profiling/profile_summarizer.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+#include "tensorflow/contrib/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+std::string OpType(const TfLiteRegistration& registration) {
+  if (registration.builtin_code == BuiltinOperator_CUSTOM ||
+      registration.builtin_code == BuiltinOperator_DELEGATE) {
+    if (registration.custom_name) return registration.custom_name;
+  }
+  const char* name = EnumNameBuiltinOperator(
+      static_cast<BuiltinOperator>(registration.builtin_code));
+  return name ? name : "UNKNOWN";
+}
+
+std::string NodeName(const Interpreter& interpreter, const TfLiteNode& node) {
+  if (node.outputs->size == 0) return "";
+  const TfLiteTensor* output = interpreter.tensor(node.outputs->data[0]);
+  return output && output->name ? output->name : "";
+}
+
+int64_t PeakRssBytes() {
+#if defined(__linux__) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#if defined(__APPLE__)
+  return usage.ru_maxrss;
+#else
+  // Linux reports kilobytes.
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+  return -1;
+#endif
+}
+
+std::ostream& InitField(std::ostream& stream, int width) {
+  stream << "\t" << std::right << std::setw(width) << std::fixed
+         << std::setprecision(3);
+  return stream;
+}
+
+// Quotes 'value' for a CSV field when needed.
+std::string CsvField(const std::string& value) {
+  if (value.find_first_of(",\"\n") == std::string::npos) return value;
+  std::string quoted = "\"";
+  for (char c : value) {
+    if (c == '"') quoted += '"';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+}  // namespace
+
+MemoryUsage GetMemoryUsage(const Interpreter& interpreter) {
+  MemoryUsage usage;
+  interpreter.GetArenaBytes(&usage.arena_bytes, &usage.ideal_arena_bytes);
+  usage.persistent_arena_bytes = interpreter.GetPersistentArenaBytes();
+  for (int i = 0; i < interpreter.tensors_size(); ++i) {
+    const TfLiteTensor* tensor = interpreter.tensor(i);
+    if (tensor->allocation_type == kTfLiteDynamic) {
+      usage.dynamic_bytes += tensor->bytes;
+    } else if (tensor->allocation_type == kTfLiteMmapRo) {
+      usage.read_only_bytes += tensor->bytes;
+    }
+  }
+  usage.peak_rss_bytes = PeakRssBytes();
+  return usage;
+}
+
+double ProfileSummarizer::Timings::Average() const {
+  if (durations_us.empty()) return 0;
+  return static_cast<double>(Sum()) / durations_us.size();
+}
+
+int64_t ProfileSummarizer::Timings::Percentile(double percentile) const {
+  if (durations_us.empty()) return 0;
+  std::vector<int64_t> sorted(durations_us);
+  std::sort(sorted.begin(), sorted.end());
+  // The nearest rank.
+  const int rank =
+      static_cast<int>(std::ceil(percentile / 100.0 * sorted.size()));
+  return sorted[std::min(std::max(rank, 1), static_cast<int>(sorted.size())) -
+                1];
+}
+
+int64_t ProfileSummarizer::Timings::Min() const {
+  if (durations_us.empty()) return 0;
+  return *std::min_element(durations_us.begin(), durations_us.end());
+}
+
+int64_t ProfileSummarizer::Timings::Max() const {
+  if (durations_us.empty()) return 0;
+  return *std::max_element(durations_us.begin(), durations_us.end());
+}
+
+int64_t ProfileSummarizer::Timings::Sum() const {
+  return std::accumulate(durations_us.begin(), durations_us.end(),
+                         static_cast<int64_t>(0));
+}
+
+void ProfileSummarizer::ProcessProfiles(
+    const std::vector<const ProfileEvent*>& profile_events,
+    const Interpreter& interpreter) {
+  int64_t run_start_us = 0;
+  bool has_start = false;
+  for (const ProfileEvent* event : profile_events) {
+    if (event->event_type != ProfileEvent::EventType::OPERATOR_INVOKE_EVENT) {
+      continue;
+    }
+    if (!has_start || event->begin_timestamp_ms < run_start_us) {
+      run_start_us = event->begin_timestamp_ms;
+      has_start = true;
+    }
+  }
+  if (!has_start) return;
+
+  // The durations of this run, by node and by op type.
+  std::map<int, int64_t> node_durations_us;
+  std::map<int, int64_t> node_starts_us;
+  std::map<std::string, int64_t> op_type_durations_us;
+  std::map<std::string, int> op_type_num_nodes;
+  int64_t run_total_us = 0;
+  for (const ProfileEvent* event : profile_events) {
+    if (event->event_type != ProfileEvent::EventType::OPERATOR_INVOKE_EVENT) {
+      continue;
+    }
+    const int node_index = event->event_metadata;
+    const auto* node_and_registration =
+        interpreter.node_and_registration(node_index);
+    // Skip the events of other interpreters, and those that never ended
+    // because the buffer overflowed.
+    if (node_and_registration == nullptr ||
+        event->end_timestamp_ms < event->begin_timestamp_ms) {
+      continue;
+    }
+    const int64_t duration_us =
+        event->end_timestamp_ms - event->begin_timestamp_ms;
+
+    NodeStats& node = nodes_[node_index];
+    if (node.op_type.empty()) {
+      node.op_type = OpType(node_and_registration->second);
+      node.name = NodeName(interpreter, node_and_registration->first);
+    }
+    if (node_starts_us.count(node_index) == 0) {
+      node_starts_us[node_index] = event->begin_timestamp_ms - run_start_us;
+      ++op_type_num_nodes[node.op_type];
+    }
+    node_durations_us[node_index] += duration_us;
+    op_type_durations_us[node.op_type] += duration_us;
+    run_total_us += duration_us;
+  }
+
+  for (const auto& duration : node_durations_us) {
+    NodeStats& node = nodes_[duration.first];
+    node.sum_start_us += node_starts_us[duration.first];
+    node.durations_us.push_back(duration.second);
+  }
+  for (const auto& duration : op_type_durations_us) {
+    OpTypeStats& op_type = op_types_[duration.first];
+    op_type.num_nodes =
+        std::max(op_type.num_nodes, op_type_num_nodes[duration.first]);
+    op_type.durations_us.push_back(duration.second);
+  }
+  run_total_us_.push_back(run_total_us);
+}
+
+std::vector<ProfileSummarizer::Timings> ProfileSummarizer::GetNodeTimings()
+    const {
+  std::vector<Timings> timings;
+  for (const auto& entry : nodes_) {
+    const NodeStats& node = entry.second;
+    Timings node_timings;
+    node_timings.op_type = node.op_type;
+    node_timings.name = node.name;
+    node_timings.node_index = entry.first;
+    node_timings.num_nodes = 1;
+    node_timings.avg_start_us =
+        static_cast<double>(node.sum_start_us) / node.durations_us.size();
+    node_timings.durations_us = node.durations_us;
+    timings.push_back(node_timings);
+  }
+  std::stable_sort(timings.begin(), timings.end(),
+                   [](const Timings& a, const Timings& b) {
+                     return a.avg_start_us < b.avg_start_us;
+                   });
+  return timings;
+}
+
+std::vector<ProfileSummarizer::Timings> ProfileSummarizer::GetOpTypeTimings()
+    const {
+  std::vector<Timings> timings;
+  for (const auto& entry : op_types_) {
+    Timings op_type_timings;
+    op_type_timings.op_type = entry.first;
+    op_type_timings.num_nodes = entry.second.num_nodes;
+    op_type_timings.durations_us = entry.second.durations_us;
+    timings.push_back(op_type_timings);
+  }
+  std::stable_sort(timings.begin(), timings.end(),
+                   [](const Timings& a, const Timings& b) {
+                     return a.Sum() > b.Sum();
+                   });
+  return timings;
+}
+
+std::string ProfileSummarizer::TimingsTable(const std::string& title,
+                                            const std::vector<Timings>& timings,
+                                            int limit) const {
+  const int64_t total_us = std::accumulate(
+      run_total_us_.begin(), run_total_us_.end(), static_cast<int64_t>(0));
+  std::stringstream stream;
+  stream << "============================== " << title
+         << " ==============================" << std::endl;
+  InitField(stream, 24) << "[node type]";
+  InitField(stream, 9) << "[start]";
+  InitField(stream, 9) << "[first]";
+  InitField(stream, 9) << "[avg ms]";
+  InitField(stream, 9) << "[p50 ms]";
+  InitField(stream, 9) << "[p90 ms]";
+  InitField(stream, 9) << "[p99 ms]";
+  InitField(stream, 8) << "[%]";
+  InitField(stream, 8) << "[cdf%]";
+  InitField(stream, 9) << "[nodes]";
+  stream << "\t"
+         << "[Name]" << std::endl;
+
+  int64_t cumulative_us = 0;
+  int num_rows = 0;
+  for (const Timings& row : timings) {
+    if (limit > 0 && num_rows++ >= limit) break;
+    cumulative_us += row.Sum();
+    const double percentage = total_us ? row.Sum() * 100.0 / total_us : 0;
+    const double cdf_percentage =
+        total_us ? cumulative_us * 100.0 / total_us : 0;
+    InitField(stream, 24) << row.op_type;
+    InitField(stream, 9) << row.avg_start_us / 1000.0;
+    InitField(stream, 9) << row.durations_us.front() / 1000.0;
+    InitField(stream, 9) << row.Average() / 1000.0;
+    InitField(stream, 9) << row.Percentile(50) / 1000.0;
+    InitField(stream, 9) << row.Percentile(90) / 1000.0;
+    InitField(stream, 9) << row.Percentile(99) / 1000.0;
+    InitField(stream, 7) << percentage << "%";
+    InitField(stream, 7) << cdf_percentage << "%";
+    InitField(stream, 9) << row.num_nodes;
+    stream << "\t";
+    if (row.node_index >= 0) stream << row.node_index << ":" << row.name;
+    stream << std::endl;
+  }
+  stream << std::endl;
+  return stream.str();
+}
+
+std::string ProfileSummarizer::GetOutputString() const {
+  std::stringstream stream;
+  if (num_runs() > 0) {
+    const std::vector<Timings> node_timings = GetNodeTimings();
+    stream << TimingsTable("Run Order", node_timings, 0);
+
+    std::vector<Timings> slowest_nodes(node_timings);
+    std::stable_sort(slowest_nodes.begin(), slowest_nodes.end(),
+                     [](const Timings& a, const Timings& b) {
+                       return a.Sum() > b.Sum();
+                     });
+    stream << TimingsTable("Top by Computation Time", slowest_nodes, 10);
+    stream << TimingsTable("Summary by node type", GetOpTypeTimings(), 0);
+
+    Timings run_timings;
+    run_timings.durations_us = run_total_us_;
+    stream << "Timings (microseconds): count=" << num_runs()
+           << " min=" << run_timings.Min() << " max=" << run_timings.Max()
+           << " avg=" << run_timings.Average()
+           << " p50=" << run_timings.Percentile(50)
+           << " p90=" << run_timings.Percentile(90)
+           << " p99=" << run_timings.Percentile(99) << std::endl;
+    stream << nodes_.size() << " nodes observed" << std::endl;
+  }
+  if (has_memory_usage_) {
+    stream << "Memory (bytes): arena=" << memory_usage_.arena_bytes
+           << " ideal_arena=" << memory_usage_.ideal_arena_bytes
+           << " persistent_arena=" << memory_usage_.persistent_arena_bytes
+           << " dynamic=" << memory_usage_.dynamic_bytes
+           << " read_only=" << memory_usage_.read_only_bytes;
+    if (memory_usage_.peak_rss_bytes >= 0) {
+      stream << " peak_rss=" << memory_usage_.peak_rss_bytes;
+    }
+    stream << std::endl;
+  }
+  return stream.str();
+}
+
+std::string ProfileSummarizer::GetCsvString() const {
+  std::stringstream stream;
+  stream << "kind,node_index,name,op_type,nodes,runs,start_us,first_us,avg_us,"
+            "min_us,max_us,p50_us,p90_us,p99_us,bytes"
+         << std::endl;
+  auto add_timings = [&stream](const std::string& kind, const Timings& row) {
+    stream << kind << ",";
+    if (row.node_index >= 0) stream << row.node_index;
+    stream << "," << CsvField(row.name) << "," << CsvField(row.op_type) << ","
+           << row.num_nodes << "," << row.durations_us.size() << ","
+           << row.avg_start_us << "," << row.durations_us.front() << ","
+           << row.Average() << "," << row.Min() << "," << row.Max() << ","
+           << row.Percentile(50) << "," << row.Percentile(90) << ","
+           << row.Percentile(99) << "," << std::endl;
+  };
+  for (const Timings& row : GetNodeTimings()) add_timings("node", row);
+  for (const Timings& row : GetOpTypeTimings()) add_timings("op_type", row);
+  if (!run_total_us_.empty()) {
+    Timings run_timings;
+    run_timings.op_type = "run";
+    run_timings.durations_us = run_total_us_;
+    add_timings("run", run_timings);
+  }
+
+  if (has_memory_usage_) {
+    auto add_bytes = [&stream](const std::string& name, int64_t bytes) {
+      stream << "memory,," << name << ",,,,,,,,,,,," << bytes << std::endl;
+    };
+    add_bytes("arena", memory_usage_.arena_bytes);
+    add_bytes("ideal_arena", memory_usage_.ideal_arena_bytes);
+    add_bytes("persistent_arena", memory_usage_.persistent_arena_bytes);
+    add_bytes("dynamic", memory_usage_.dynamic_bytes);
+    add_bytes("read_only", memory_usage_.read_only_bytes);
+    if (memory_usage_.peak_rss_bytes >= 0) {
+      add_bytes("peak_rss", memory_usage_.peak_rss_bytes);
+    }
+  }
+  return stream.str();
+}
+
+}  // namespace profiling
+}  // namespace tflite
@@ -0,0 +1,147 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_PROFILING_PROFILE_SUMMARIZER_H_
+#define TENSORFLOW_CONTRIB_LITE_PROFILING_PROFILE_SUMMARIZER_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/contrib/lite/interpreter.h"
+#include "tensorflow/contrib/lite/profiling/profile_buffer.h"
+
+namespace tflite {
+namespace profiling {
+
+// The memory used by an interpreter, in bytes.
+struct MemoryUsage {
+  // The arena of the intermediate tensors, and its lower bound.
+  size_t arena_bytes = 0;
+  size_t ideal_arena_bytes = 0;
+  // The arena of the tensors that persist across invocations.
+  size_t persistent_arena_bytes = 0;
+  // The tensors allocated by the ops themselves.
+  size_t dynamic_bytes = 0;
+  // The constant tensors, which usually point into the model.
+  size_t read_only_bytes = 0;
+  // The peak resident set size of the process, or -1 where unknown.
+  int64_t peak_rss_bytes = -1;
+};
+
+// Returns the memory used by 'interpreter' after AllocateTensors(), and the
+// peak resident set size of the process so far.
+MemoryUsage GetMemoryUsage(const Interpreter& interpreter);
+
+// Aggregates the operator invocation events of several runs of an
+// interpreter by node and by op type, like tensorflow::StatSummarizer does for
+// the StepStats of a TensorFlow graph. For example:
+//   Profiler profiler(interpreter->nodes_size());
+//   interpreter->SetProfiler(&profiler);
+//   ProfileSummarizer summarizer;
+//   for (int i = 0; i < num_runs; ++i) {
+//     profiler.Reset();
+//     profiler.StartProfiling();
+//     interpreter->Invoke();
+//     profiler.StopProfiling();
+//     summarizer.ProcessProfiles(profiler.GetProfileEvents(), *interpreter);
+//   }
+//   std::cout << summarizer.GetOutputString();
+// The events are only collected when TFLITE_PROFILING_ENABLED is defined.
+class ProfileSummarizer {
+ public:
+  ProfileSummarizer() {}
+
+  // Adds the events of one run of 'interpreter'. Events other than operator
+  // invocations are ignored.
+  void ProcessProfiles(const std::vector<const ProfileEvent*>& profile_events,
+                       const Interpreter& interpreter);
+
+  // Sets the memory usage reported along with the timings.
+  void SetMemoryUsage(const MemoryUsage& memory_usage) {
+    memory_usage_ = memory_usage;
+    has_memory_usage_ = true;
+  }
+
+  // Returns the timings of the nodes in run order and the slowest first, the
+  // timings by op type, and the memory usage, as tables of tab-separated
+  // columns.
+  std::string GetOutputString() const;
+
+  // Returns the same timings and memory usage as comma-separated values, with
+  // a header line, for a spreadsheet.
+  std::string GetCsvString() const;
+
+  // Returns the number of runs processed so far.
+  int num_runs() const { return static_cast<int>(run_total_us_.size()); }
+
+  // The timings of a node or of the nodes of an op type, in microseconds.
+  // Durations are per run: the sum over the nodes of an op type.
+  struct Timings {
+    std::string op_type;
+    // The name of the first output of the node, or empty for an op type.
+    std::string name;
+    int node_index = -1;
+    // The number of nodes per run, for an op type.
+    int num_nodes = 0;
+    // Average offset of the beginning of the node from that of the run.
+    double avg_start_us = 0;
+    std::vector<int64_t> durations_us;
+
+    double Average() const;
+    // Returns the duration that 'percentile' percents of the runs did not
+    // exceed.
+    int64_t Percentile(double percentile) const;
+    int64_t Min() const;
+    int64_t Max() const;
+    int64_t Sum() const;
+  };
+
+  // Returns the timings of the nodes in run order.
+  std::vector<Timings> GetNodeTimings() const;
+
+  // Returns the timings of the op types, the slowest first.
+  std::vector<Timings> GetOpTypeTimings() const;
+
+ private:
+  struct NodeStats {
+    std::string op_type;
+    std::string name;
+    int64_t sum_start_us = 0;
+    std::vector<int64_t> durations_us;
+  };
+
+  struct OpTypeStats {
+    int num_nodes = 0;
+    std::vector<int64_t> durations_us;
+  };
+
+  std::string TimingsTable(const std::string& title,
+                           const std::vector<Timings>& timings,
+                           int limit) const;
+
+  // By node index, so that iterating gives the run order.
+  std::map<int, NodeStats> nodes_;
+  std::map<std::string, OpTypeStats> op_types_;
+  // The sum of the durations of the nodes in each run.
+  std::vector<int64_t> run_total_us_;
+  MemoryUsage memory_usage_;
+  bool has_memory_usage_ = false;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_PROFILING_PROFILE_SUMMARIZER_H_
@@ -0,0 +1,214 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/profiling/profile_summarizer.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/schema/schema_generated.h"
+#include "tensorflow/contrib/lite/testing/util.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+class ProfileSummarizerTest : public ::testing::Test {
+ protected:
+  // Builds a graph of three nodes: ADD, MUL and ADD, with outputs named
+  // "a", "b" and "c".
+  void SetUp() override {
+    ASSERT_EQ(interpreter_.AddTensors(4), kTfLiteOk);
+    TfLiteQuantizationParams quant;
+    const char* names[] = {"in", "a", "b", "c"};
+    for (int i = 0; i < 4; ++i) {
+      interpreter_.SetTensorParametersReadWrite(i, kTfLiteFloat32, names[i],
+                                                {2}, quant);
+    }
+    interpreter_.SetInputs({0});
+    interpreter_.SetOutputs({3});
+    TfLiteRegistration add = {nullptr, nullptr, nullptr, nullptr};
+    add.builtin_code = BuiltinOperator_ADD;
+    TfLiteRegistration mul = {nullptr, nullptr, nullptr, nullptr};
+    mul.builtin_code = BuiltinOperator_MUL;
+    interpreter_.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &add);
+    interpreter_.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr, &mul);
+    interpreter_.AddNodeWithParameters({2}, {3}, nullptr, 0, nullptr, &add);
+    ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  }
+
+  // Adds a run starting at 'start_us' in which the nodes take the given
+  // durations, one after the other.
+  void AddRun(int64_t start_us, const std::vector<int64_t>& durations_us) {
+    std::vector<ProfileEvent> events;
+    int64_t time_us = start_us;
+    for (int i = 0; i < durations_us.size(); ++i) {
+      ProfileEvent event;
+      event.tag = "OpInvoke";
+      event.begin_timestamp_ms = time_us;
+      event.end_timestamp_ms = time_us + durations_us[i];
+      event.event_type = ProfileEvent::EventType::OPERATOR_INVOKE_EVENT;
+      event.event_metadata = i;
+      events.push_back(event);
+      time_us += durations_us[i];
+    }
+    // Events of other kinds are ignored.
+    ProfileEvent other = events.front();
+    other.event_type = ProfileEvent::EventType::DEFAULT;
+    other.end_timestamp_ms += 1000;
+    events.push_back(other);
+
+    std::vector<const ProfileEvent*> event_pointers;
+    for (const ProfileEvent& event : events) event_pointers.push_back(&event);
+    summarizer_.ProcessProfiles(event_pointers, interpreter_);
+  }
+
+  Interpreter interpreter_;
+  ProfileSummarizer summarizer_;
+};
+
+TEST_F(ProfileSummarizerTest, NoRuns) {
+  EXPECT_EQ(summarizer_.num_runs(), 0);
+  EXPECT_TRUE(summarizer_.GetNodeTimings().empty());
+  EXPECT_TRUE(summarizer_.GetOutputString().empty());
+  summarizer_.ProcessProfiles({}, interpreter_);
+  EXPECT_EQ(summarizer_.num_runs(), 0);
+}
+
+TEST_F(ProfileSummarizerTest, TimingsByNode) {
+  for (int run = 0; run < 10; ++run) {
+    AddRun(run * 1000, {10 + run, 100, 1});
+  }
+  EXPECT_EQ(summarizer_.num_runs(), 10);
+
+  const auto timings = summarizer_.GetNodeTimings();
+  ASSERT_EQ(timings.size(), 3);
+  EXPECT_EQ(timings[0].op_type, "ADD");
+  EXPECT_EQ(timings[0].name, "a");
+  EXPECT_EQ(timings[0].node_index, 0);
+  EXPECT_EQ(timings[0].avg_start_us, 0);
+  EXPECT_EQ(timings[0].durations_us.size(), 10);
+  EXPECT_EQ(timings[0].Min(), 10);
+  EXPECT_EQ(timings[0].Max(), 19);
+  EXPECT_EQ(timings[0].Average(), 14.5);
+  EXPECT_EQ(timings[0].Percentile(50), 14);
+  EXPECT_EQ(timings[0].Percentile(90), 18);
+  EXPECT_EQ(timings[0].Percentile(99), 19);
+
+  EXPECT_EQ(timings[1].op_type, "MUL");
+  EXPECT_EQ(timings[1].name, "b");
+  EXPECT_EQ(timings[1].avg_start_us, 14.5);
+  EXPECT_EQ(timings[1].Average(), 100);
+  EXPECT_EQ(timings[2].op_type, "ADD");
+  EXPECT_EQ(timings[2].name, "c");
+  EXPECT_EQ(timings[2].Average(), 1);
+}
+
+TEST_F(ProfileSummarizerTest, TimingsByOpType) {
+  AddRun(0, {10, 100, 1});
+  AddRun(1000, {20, 200, 2});
+
+  const auto timings = summarizer_.GetOpTypeTimings();
+  ASSERT_EQ(timings.size(), 2);
+  // The slowest first.
+  EXPECT_EQ(timings[0].op_type, "MUL");
+  EXPECT_EQ(timings[0].num_nodes, 1);
+  EXPECT_THAT(timings[0].durations_us, ElementsAre(100, 200));
+  // Both ADD nodes add up in each run.
+  EXPECT_EQ(timings[1].op_type, "ADD");
+  EXPECT_EQ(timings[1].num_nodes, 2);
+  EXPECT_THAT(timings[1].durations_us, ElementsAre(11, 22));
+}
+
+TEST_F(ProfileSummarizerTest, OutputString) {
+  AddRun(0, {10, 100, 1});
+  summarizer_.SetMemoryUsage(GetMemoryUsage(interpreter_));
+  const std::string output = summarizer_.GetOutputString();
+  EXPECT_THAT(output, HasSubstr("Run Order"));
+  EXPECT_THAT(output, HasSubstr("Top by Computation Time"));
+  EXPECT_THAT(output, HasSubstr("Summary by node type"));
+  EXPECT_THAT(output, HasSubstr("1:b"));
+  EXPECT_THAT(output, HasSubstr("count=1 min=111 max=111"));
+  EXPECT_THAT(output, HasSubstr("3 nodes observed"));
+  EXPECT_THAT(output, HasSubstr("Memory (bytes): arena="));
+}
+
+TEST_F(ProfileSummarizerTest, CsvString) {
+  AddRun(0, {10, 100, 1});
+  AddRun(1000, {30, 100, 1});
+  MemoryUsage memory_usage;
+  memory_usage.arena_bytes = 256;
+  memory_usage.peak_rss_bytes = -1;
+  summarizer_.SetMemoryUsage(memory_usage);
+
+  std::vector<std::string> lines;
+  std::istringstream stream(summarizer_.GetCsvString());
+  for (std::string line; std::getline(stream, line);) lines.push_back(line);
+  ASSERT_EQ(lines.size(), 12);
+  EXPECT_EQ(lines[0],
+            "kind,node_index,name,op_type,nodes,runs,start_us,first_us,avg_us,"
+            "min_us,max_us,p50_us,p90_us,p99_us,bytes");
+  EXPECT_EQ(lines[1], "node,0,a,ADD,1,2,0,10,20,10,30,10,30,30,");
+  EXPECT_EQ(lines[4], "op_type,,,MUL,1,2,0,100,100,100,100,100,100,100,");
+  EXPECT_EQ(lines[5], "op_type,,,ADD,2,2,0,11,21,11,31,11,31,31,");
+  EXPECT_EQ(lines[6], "run,,,run,0,2,0,111,121,111,131,111,131,131,");
+  EXPECT_EQ(lines[7], "memory,,arena,,,,,,,,,,,,256");
+  // No peak RSS line.
+  EXPECT_EQ(lines[11], "memory,,read_only,,,,,,,,,,,,0");
+}
+
+TEST(GetMemoryUsageTest, CountsTensorsByAllocationType) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(3), kTfLiteOk);
+  TfLiteQuantizationParams quant;
+  static const float weights[4] = {1, 2, 3, 4};
+  interpreter.SetTensorParametersReadOnly(
+      0, kTfLiteFloat32, "weights", {4}, quant,
+      reinterpret_cast<const char*>(weights), sizeof(weights));
+  interpreter.SetTensorParametersReadWrite(1, kTfLiteFloat32, "in", {8},
+                                           quant);
+  interpreter.SetTensorParametersReadWrite(2, kTfLiteFloat32, "out", {8},
+                                           quant);
+  interpreter.SetInputs({1});
+  interpreter.SetOutputs({2});
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  interpreter.AddNodeWithParameters({1, 0}, {2}, nullptr, 0, nullptr, &reg);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  const MemoryUsage usage = GetMemoryUsage(interpreter);
+  EXPECT_GE(usage.arena_bytes, 2 * 8 * sizeof(float));
+  EXPECT_EQ(usage.ideal_arena_bytes, 2 * 8 * sizeof(float));
+  EXPECT_EQ(usage.persistent_arena_bytes, 0);
+  EXPECT_EQ(usage.dynamic_bytes, 0);
+  EXPECT_EQ(usage.read_only_bytes, sizeof(weights));
+#if defined(__linux__) || defined(__APPLE__)
+  EXPECT_GT(usage.peak_rss_bytes, 0);
+#endif
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -77,7 +77,11 @@ class ScopedOperatorProfile;
 //
 class Profiler {
  public:
-  Profiler() : buffer_(1024, false) {}
+  Profiler() : Profiler(1024) {}
+  // Keeps the latest `max_num_entries` events. A run of an interpreter adds
+  // an event per node.
+  explicit Profiler(uint32_t max_num_entries)
+      : buffer_(max_num_entries, false) {}
 
   void StartProfiling() { buffer_.SetEnabled(true); }
   void StopProfiling() { buffer_.SetEnabled(false); }
@@ -117,7 +121,7 @@ class ScopedProfile {
   }
 
  private:
-  ProfileBuffer* buffer_;
+  ProfileBuffer* buffer_ = nullptr;
   int32_t event_handle_;
 };
 
@@ -141,7 +145,7 @@ class ScopedOperatorProfile {
   }
 
  private:
-  ProfileBuffer* buffer_;
+  ProfileBuffer* buffer_ = nullptr;
   int32_t event_handle_;
 };
 
@@ -159,6 +163,7 @@ namespace profiling {
 class Profiler {
  public:
   Profiler() {}
+  explicit Profiler(uint32_t max_num_entries) {}
   void StartProfiling() {}
   void StopProfiling() {}
   void Reset() {}
@@ -73,6 +73,30 @@ TfLiteStatus SimpleMemoryArena::Allocate(TfLiteContext* context,
   return kTfLiteOk;
 }
 
+TfLiteStatus SimpleMemoryArena::AllocateAt(TfLiteContext* context,
+                                           size_t offset, size_t size,
+                                           ArenaAlloc* new_alloc) {
+  // Keep the allocs sorted by offset.
+  auto insertion_it = allocs_.begin();
+  while (insertion_it != allocs_.end() && insertion_it->offset < offset) {
+    TF_LITE_ENSURE(context,
+                   insertion_it->offset + insertion_it->size <= offset);
+    ++insertion_it;
+  }
+  if (insertion_it != allocs_.end()) {
+    TF_LITE_ENSURE(context, offset + size <= insertion_it->offset);
+    TF_LITE_ENSURE(context, offset != insertion_it->offset);
+  }
+
+  high_water_mark_ = std::max(high_water_mark_, offset + size);
+
+  new_alloc->offset = offset;
+  new_alloc->size = size;
+  allocs_.insert(insertion_it, *new_alloc);
+
+  return kTfLiteOk;
+}
+
 TfLiteStatus SimpleMemoryArena::Deallocate(TfLiteContext* context,
                                            const ArenaAlloc& alloc) {
   int erased_allocs_count = 0;
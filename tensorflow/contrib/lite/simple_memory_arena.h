@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_LITE_SIMPLE_MEMORY_ARENA_H_
 #define TENSORFLOW_CONTRIB_LITE_SIMPLE_MEMORY_ARENA_H_
 
+#include <algorithm>
 #include <list>
 #include <memory>
 #include "tensorflow/contrib/lite/context.h"
@@ -52,6 +53,11 @@ class SimpleMemoryArena {
   TfLiteStatus Allocate(TfLiteContext* context, size_t alignment, size_t size,
                         ArenaAlloc* new_alloc);
 
+  // Allocates `size` bytes at the given offset, which must not overlap any
+  // current allocation.
+  TfLiteStatus AllocateAt(TfLiteContext* context, size_t offset, size_t size,
+                          ArenaAlloc* new_alloc);
+
   TfLiteStatus Deallocate(TfLiteContext* context, const ArenaAlloc& alloc);
 
   inline size_t RequiredBufferSize() {
@@ -61,6 +67,15 @@ class SimpleMemoryArena {
     return arena_alignment_ + high_water_mark_ + padding;
   }
 
+  // Returns the end of the highest allocation since the last Clear().
+  size_t HighWaterMark() const { return high_water_mark_; }
+
+  // Makes room for allocations, up to `high_water_mark`, whose offsets were
+  // planned elsewhere and which are therefore not tracked by the arena.
+  void ReserveHighWaterMark(size_t high_water_mark) {
+    high_water_mark_ = std::max(high_water_mark_, high_water_mark);
+  }
+
   TfLiteStatus Commit(TfLiteContext* context);
 
   TfLiteStatus ResolveAlloc(TfLiteContext* context, const ArenaAlloc& alloc,
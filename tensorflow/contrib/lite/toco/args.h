@@ -241,6 +241,10 @@ struct ParsedTocoFlags {
   Arg<bool> drop_control_dependency = Arg<bool>(false);
   Arg<bool> propagate_fake_quant_num_bits = Arg<bool>(false);
   Arg<bool> allow_nudging_weights_to_use_fast_gemm_kernel = Arg<bool>(false);
+  Arg<bool> quantize_weights = Arg<bool>(false);
+  Arg<bool> per_channel_weights = Arg<bool>(false);
+  Arg<float> sparse_weights_threshold = Arg<float>(0.f);
+  Arg<bool> fuse_elementwise_ops = Arg<bool>(false);
 };
 
 }  // namespace toco
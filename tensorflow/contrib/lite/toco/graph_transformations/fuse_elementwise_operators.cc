@@ -0,0 +1,230 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/model.h"
+#include "tensorflow/contrib/lite/toco/tooling_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace toco {
+
+namespace {
+
+// The most steps that the FusedElementwise kernel of TF Lite evaluates.
+constexpr int kMaxFusedSteps = 16;
+
+// The inputs and steps of a chain of elementwise operators, as in
+// FusedElementwiseOperator.
+struct Chain {
+  std::vector<string> inputs;
+  std::vector<FusedElementwiseOperator::Step> steps;
+};
+
+int NumInputsOfFusableType(OperatorType type) {
+  switch (type) {
+    case OperatorType::kAdd:
+    case OperatorType::kSub:
+    case OperatorType::kMul:
+    case OperatorType::kDiv:
+      return 2;
+    case OperatorType::kExp:
+    case OperatorType::kLogistic:
+    case OperatorType::kTanh:
+    case OperatorType::kRelu:
+    case OperatorType::kRelu1:
+    case OperatorType::kRelu6:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+// Returns true if 'op' can be part of a chain: a float elementwise operator
+// whose inputs have the shape of its output or a single value.
+bool IsFusable(const Model& model, const Operator& op) {
+  if (op.type != OperatorType::kFusedElementwise &&
+      NumInputsOfFusableType(op.type) != op.inputs.size()) {
+    return false;
+  }
+  if (op.outputs.size() != 1) {
+    return false;
+  }
+  const auto& output_array = model.GetArray(op.outputs[0]);
+  if (output_array.data_type != ArrayDataType::kFloat ||
+      !output_array.has_shape() ||
+      RequiredBufferSizeForShape(output_array.shape()) <= 1) {
+    return false;
+  }
+  for (const string& input : op.inputs) {
+    const auto& input_array = model.GetArray(input);
+    if (input_array.data_type != ArrayDataType::kFloat ||
+        !input_array.has_shape()) {
+      return false;
+    }
+    if (input_array.shape() != output_array.shape() &&
+        RequiredBufferSizeForShape(input_array.shape()) != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Chain ToChain(const Operator& op) {
+  Chain chain;
+  chain.inputs = op.inputs;
+  if (op.type == OperatorType::kFusedElementwise) {
+    chain.steps = static_cast<const FusedElementwiseOperator&>(op).steps;
+  } else {
+    FusedElementwiseOperator::Step step;
+    step.type = op.type;
+    step.lhs = 0;
+    step.rhs = op.inputs.size() > 1 ? 1 : -1;
+    chain.steps.push_back(step);
+  }
+  if (op.fused_activation_function != FusedActivationFunctionType::kNone) {
+    FusedElementwiseOperator::Step step;
+    switch (op.fused_activation_function) {
+      case FusedActivationFunctionType::kRelu:
+        step.type = OperatorType::kRelu;
+        break;
+      case FusedActivationFunctionType::kRelu1:
+        step.type = OperatorType::kRelu1;
+        break;
+      case FusedActivationFunctionType::kRelu6:
+        step.type = OperatorType::kRelu6;
+        break;
+      default:
+        LOG(FATAL) << "Unhandled activation function type";
+    }
+    step.lhs = chain.inputs.size() + chain.steps.size() - 1;
+    chain.steps.push_back(step);
+  }
+  return chain;
+}
+
+// Returns the chain that computes 'producer' then 'consumer', where the
+// result of 'producer' is the array 'intermediate' among the inputs of
+// 'consumer'. Inputs used by both chains are only inputs once.
+Chain Merge(const Chain& producer, const Chain& consumer,
+            const string& intermediate) {
+  Chain merged;
+  auto add_input = [&merged](const string& input) {
+    for (int i = 0; i < merged.inputs.size(); ++i) {
+      if (merged.inputs[i] == input) return i;
+    }
+    merged.inputs.push_back(input);
+    return static_cast<int>(merged.inputs.size()) - 1;
+  };
+  std::vector<int> producer_inputs;
+  for (const string& input : producer.inputs) {
+    producer_inputs.push_back(add_input(input));
+  }
+  std::vector<int> consumer_inputs;
+  for (const string& input : consumer.inputs) {
+    consumer_inputs.push_back(input == intermediate ? -1 : add_input(input));
+  }
+
+  // The steps of 'producer' come first, then those of 'consumer'.
+  const int num_inputs = merged.inputs.size();
+  const int producer_result = num_inputs + producer.steps.size() - 1;
+  auto producer_value = [&](int value) {
+    if (value < 0) return value;
+    if (value < producer.inputs.size()) return producer_inputs[value];
+    return num_inputs + value - static_cast<int>(producer.inputs.size());
+  };
+  auto consumer_value = [&](int value) {
+    if (value < 0) return value;
+    if (value < consumer.inputs.size()) {
+      return consumer_inputs[value] < 0 ? producer_result
+                                        : consumer_inputs[value];
+    }
+    return num_inputs + static_cast<int>(producer.steps.size()) + value -
+           static_cast<int>(consumer.inputs.size());
+  };
+  for (auto step : producer.steps) {
+    step.lhs = producer_value(step.lhs);
+    step.rhs = producer_value(step.rhs);
+    merged.steps.push_back(step);
+  }
+  for (auto step : consumer.steps) {
+    step.lhs = consumer_value(step.lhs);
+    step.rhs = consumer_value(step.rhs);
+    merged.steps.push_back(step);
+  }
+  return merged;
+}
+
+// Returns true if 'op' is the only operator that reads 'array_name'.
+bool IsOnlyConsumer(const Model& model, const string& array_name,
+                    const Operator& op) {
+  for (const auto& other_op : model.operators) {
+    if (other_op.get() == &op) continue;
+    for (const string& input : other_op->inputs) {
+      if (input == array_name) return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+// Fuses an elementwise float operator, or an already fused chain, into the
+// following one when it is its only consumer. Running to a fixed point
+// collapses each maximal chain into a single FusedElementwise operator, which
+// TF Lite evaluates in one pass over blocks of the arrays instead of one pass
+// per operator, with no intermediate arrays.
+bool FuseElementwiseOperators::Run(Model* model, std::size_t op_index) {
+  const auto op_it = model->operators.begin() + op_index;
+  const Operator* op = op_it->get();
+  if (!IsFusable(*model, *op)) {
+    return false;
+  }
+  const auto& output_shape = model->GetArray(op->outputs[0]).shape();
+
+  for (const string& input : op->inputs) {
+    const Operator* producer = GetOpWithOutput(*model, input);
+    if (!producer || !IsFusable(*model, *producer)) {
+      continue;
+    }
+    // The intermediate array must not be broadcast, nor needed elsewhere.
+    if (model->GetArray(input).shape() != output_shape ||
+        !IsDiscardableArray(*model, input) ||
+        !IsOnlyConsumer(*model, input, *op)) {
+      continue;
+    }
+    const string intermediate = input;
+    const Chain chain = Merge(ToChain(*producer), ToChain(*op), intermediate);
+    if (chain.steps.size() > kMaxFusedSteps) {
+      continue;
+    }
+
+    AddMessageF("Fusing %s into the following %s", LogName(*producer),
+                LogName(*op));
+    auto* fused_op = new FusedElementwiseOperator;
+    fused_op->inputs = chain.inputs;
+    fused_op->outputs = op->outputs;
+    fused_op->steps = chain.steps;
+    op_it->reset(fused_op);
+    model->operators.erase(FindOp(*model, producer));
+    model->EraseArray(intermediate);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace toco
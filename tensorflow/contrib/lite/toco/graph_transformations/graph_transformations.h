@@ -121,6 +121,7 @@ DECLARE_GRAPH_TRANSFORMATION(ConvertTrivialTransposeToReshape)
 DECLARE_GRAPH_TRANSFORMATION(ConvertReorderAxes)
 DECLARE_GRAPH_TRANSFORMATION(EnsureBiasVectors)
 DECLARE_GRAPH_TRANSFORMATION(FuseActivationFunctions)
+DECLARE_GRAPH_TRANSFORMATION(FuseElementwiseOperators)
 DECLARE_GRAPH_TRANSFORMATION(FuseBinaryIntoFollowingAffine)
 DECLARE_GRAPH_TRANSFORMATION(FuseBinaryIntoPrecedingAffine)
 DECLARE_GRAPH_TRANSFORMATION(IdentifyL2Normalization)
@@ -138,7 +139,6 @@ DECLARE_GRAPH_TRANSFORMATION(PropagateArrayDataTypes)
 DECLARE_GRAPH_TRANSFORMATION(PropagateFakeQuantNumBits);
 DECLARE_GRAPH_TRANSFORMATION(PropagateFixedSizes)
 DECLARE_GRAPH_TRANSFORMATION(HardcodeMinMax)
-DECLARE_GRAPH_TRANSFORMATION(Quantize)
 DECLARE_GRAPH_TRANSFORMATION(RemoveFinalDequantizeOp)
 DECLARE_GRAPH_TRANSFORMATION(RemoveTensorFlowAssert)
 DECLARE_GRAPH_TRANSFORMATION(RemoveTensorFlowIdentity)
@@ -189,6 +189,7 @@ DECLARE_GRAPH_TRANSFORMATION(ResolveMultiplyByZero)
 DECLARE_GRAPH_TRANSFORMATION(Dequantize)
 DECLARE_GRAPH_TRANSFORMATION(UnpartitionEmbeddingLookup)
 DECLARE_GRAPH_TRANSFORMATION(ExperimentalShuffleFCWeights)
+DECLARE_GRAPH_TRANSFORMATION(QuantizeWeights)
 
 class PropagateDefaultMinMax : public GraphTransformation {
  public:
@@ -259,6 +260,35 @@ class EnsureUint8WeightsSafeForFastInt8Kernels : public GraphTransformation {
   bool allow_nudging_weights_ = false;
 };
 
+class Quantize : public GraphTransformation {
+ public:
+  bool Run(Model* model, std::size_t op_index) override;
+  const char* Name() const override { return "Quantize"; }
+
+  // Whether to quantize the weights of Conv, DepthwiseConv and FullyConnected
+  // ops to symmetric int8 values with one scale per output channel, and their
+  // biases accordingly, instead of to uint8 values with a single scale.
+  bool per_channel_weights() const { return per_channel_weights_; }
+  void set_per_channel_weights(bool val) { per_channel_weights_ = val; }
+
+ private:
+  bool per_channel_weights_ = false;
+};
+
+class SparsifyWeights : public GraphTransformation {
+ public:
+  bool Run(Model* model, std::size_t op_index) override;
+  const char* Name() const override { return "SparsifyWeights"; }
+
+  // The fraction of all-zero blocks at or above which the float weights of
+  // FullyConnected and 1x1 Conv ops are stored as sparse blocks.
+  float threshold() const { return threshold_; }
+  void set_threshold(float val) { threshold_ = val; }
+
+ private:
+  float threshold_ = 0.5f;
+};
+
 #undef DECLARE_GRAPH_TRANSFORMATION
 
 }  // end namespace toco
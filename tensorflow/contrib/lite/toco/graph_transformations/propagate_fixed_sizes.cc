@@ -552,6 +552,31 @@ void ProcessSimpleBinaryOperator(Model* model, Operator* op) {
                                   &output_array);
 }
 
+void ProcessFusedElementwiseOperator(Model* model,
+                                     FusedElementwiseOperator* op) {
+  // Yield until all input dims have been resolved.
+  for (const auto& input : op->inputs) {
+    if (!model->GetArray(input).has_shape()) {
+      return;
+    }
+  }
+  auto& output_array = model->GetArray(op->outputs[0]);
+  if (output_array.has_shape()) {
+    return;
+  }
+
+  // The output has the shape of the inputs that aren't broadcast.
+  const Shape* output_shape = &model->GetArray(op->inputs[0]).shape();
+  for (const auto& input : op->inputs) {
+    const Shape& input_shape = model->GetArray(input).shape();
+    if (RequiredBufferSizeForShape(input_shape) > 1) {
+      output_shape = &input_shape;
+      break;
+    }
+  }
+  output_array.copy_shape(*output_shape);
+}
+
 void ProcessAddNOperator(Model* model, Operator* op) {
   // Yield until all input dims have been resolved.
   //
@@ -1594,6 +1619,10 @@ bool PropagateFixedSizes::Run(Model* model, std::size_t op_index) {
     case OperatorType::kAddN:
       ProcessAddNOperator(model, op);
       break;
+    case OperatorType::kFusedElementwise:
+      ProcessFusedElementwiseOperator(
+          model, static_cast<FusedElementwiseOperator*>(op));
+      break;
     case OperatorType::kConv:
       ProcessConvOperator(model, static_cast<ConvOperator*>(op));
       break;
@@ -12,7 +12,10 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
 #include "tensorflow/contrib/lite/toco/graph_transformations/quantization_util.h"
@@ -165,8 +168,105 @@ void QuantizeArray(GraphTransformation* transformation, Model* model,
       quantization_params.scale);
 }
 
+template <ArrayDataType A>
+std::unique_ptr<GenericBuffer> QuantizeBufferPerChannel(
+    const Array& array,
+    const PerChannelQuantizationParams& per_channel_params) {
+  const auto& float_data = array.GetBuffer<ArrayDataType::kFloat>().data;
+  const auto& dims = array.shape().dims();
+  int inner_size = 1;
+  for (int i = per_channel_params.quantized_dimension + 1; i < dims.size();
+       ++i) {
+    inner_size *= dims[i];
+  }
+  const int num_channels = per_channel_params.scales.size();
+  auto* quantized_buffer = new Buffer<A>;
+  quantized_buffer->data.resize(float_data.size());
+  for (std::size_t i = 0; i < float_data.size(); i++) {
+    const double scale =
+        per_channel_params.scales[(i / inner_size) % num_channels];
+    double scaled_val = 0;
+    if (scale == 0) {
+      CHECK_EQ(float_data[i], 0) << "The quantization scale for this channel "
+                                 << "is 0, so all its values should be 0.";
+    } else {
+      scaled_val = float_data[i] / scale;
+    }
+    quantized_buffer->data[i] =
+        tflite::SafeCast<DataType<A>>(std::round(scaled_val));
+  }
+  return std::unique_ptr<GenericBuffer>(quantized_buffer);
+}
+
+template <ArrayDataType A>
+void QuantizeArrayPerChannel(
+    GraphTransformation* transformation, Model* model, const string& name,
+    const PerChannelQuantizationParams& per_channel_params) {
+  auto& array = model->GetArray(name);
+  CHECK(array.data_type == ArrayDataType::kFloat);
+  CHECK(array.buffer);
+  CHECK(!array.quantization_params);
+  CHECK_LT(per_channel_params.quantized_dimension,
+           array.shape().dimensions_count());
+  CHECK_EQ(per_channel_params.scales.size(),
+           array.shape().dims(per_channel_params.quantized_dimension));
+  array.buffer = QuantizeBufferPerChannel<A>(array, per_channel_params);
+  array.GetOrCreatePerChannelQuantizationParams() = per_channel_params;
+  auto& quantization_params = array.GetOrCreateQuantizationParams();
+  quantization_params.scale = *std::max_element(
+      per_channel_params.scales.begin(), per_channel_params.scales.end());
+  quantization_params.zero_point = 0;
+  array.data_type = A;
+  array.final_data_type = A;
+  transformation->AddMessageF(
+      "Quantized array %s to %s with %d scales along dimension %d", name,
+      ArrayDataTypeName(array.data_type),
+      static_cast<int>(per_channel_params.scales.size()),
+      per_channel_params.quantized_dimension);
+}
+
 }  // namespace
 
+void ChooseSymmetricPerChannelScales(const Array& array,
+                                     int quantized_dimension,
+                                     std::vector<double>* scales) {
+  const auto& float_data = array.GetBuffer<ArrayDataType::kFloat>().data;
+  const auto& dims = array.shape().dims();
+  CHECK_LT(quantized_dimension, dims.size());
+  const int num_channels = dims[quantized_dimension];
+  int inner_size = 1;
+  for (int i = quantized_dimension + 1; i < dims.size(); ++i) {
+    inner_size *= dims[i];
+  }
+  std::vector<double> max_abs(num_channels, 0.);
+  for (std::size_t i = 0; i < float_data.size(); i++) {
+    double& channel_max_abs = max_abs[(i / inner_size) % num_channels];
+    channel_max_abs =
+        std::max<double>(channel_max_abs, std::abs(float_data[i]));
+  }
+  // Channels of zeros get a scale of 1, which lets their bias be quantized.
+  scales->clear();
+  for (double channel_max_abs : max_abs) {
+    scales->push_back(channel_max_abs > 0 ? channel_max_abs / 127. : 1.);
+  }
+}
+
+void QuantizeArrayPerChannel(
+    GraphTransformation* transformation, Model* model, const string& name,
+    ArrayDataType quantized_data_type,
+    const PerChannelQuantizationParams& per_channel_params) {
+  switch (quantized_data_type) {
+    case ArrayDataType::kInt8:
+      return QuantizeArrayPerChannel<ArrayDataType::kInt8>(
+          transformation, model, name, per_channel_params);
+    case ArrayDataType::kInt32:
+      return QuantizeArrayPerChannel<ArrayDataType::kInt32>(
+          transformation, model, name, per_channel_params);
+    default:
+      LOG(FATAL) << "Unhandled case.";
+  }
+}
+
 void QuantizeArray(GraphTransformation* transformation, Model* model,
                    const string& name, ArrayDataType quantized_data_type,
                    const QuantizationParams& quantization_params) {
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_LITE_TOCO_GRAPH_TRANSFORMATIONS_QUANTIZATION_UTIL_H_
 #define TENSORFLOW_CONTRIB_LITE_TOCO_GRAPH_TRANSFORMATIONS_QUANTIZATION_UTIL_H_
 
+#include <vector>
+
 #include "tensorflow/contrib/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
 #include "tensorflow/contrib/lite/toco/model.h"
@@ -60,6 +62,21 @@ void QuantizeArray(GraphTransformation* transformation, Model* model,
                    const string& name, ArrayDataType quantized_data_type,
                    const QuantizationParams& quantization_params);
 
+// Sets 'scales' to the scales that quantize each channel of the constant float
+// array 'array' symmetrically to [-127, 127], along its dimension
+// 'quantized_dimension'.
+void ChooseSymmetricPerChannelScales(const Array& array,
+                                     int quantized_dimension,
+                                     std::vector<double>* scales);
+
+// Quantizes a constant array symmetrically, with one scale per channel, by
+// setting its data type and quantizing all values in the array. The array also
+// gets per-tensor quantization params with the largest of the scales.
+void QuantizeArrayPerChannel(
+    GraphTransformation* transformation, Model* model, const string& name,
+    ArrayDataType quantized_data_type,
+    const PerChannelQuantizationParams& per_channel_params);
+
 // Returns true if the given array, when quantized, contains only values between
 // the provided clamp min/max.
 // Either clamp_min or clamp_max may be +/-infinity to indicate that the value
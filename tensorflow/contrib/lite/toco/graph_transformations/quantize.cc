@@ -183,6 +183,14 @@ bool ChooseQuantizationForOperatorInput(
           "Input array %s is a bias vector but has no qparams", input);
       return false;
     }
+    if (input_weights.per_channel_quantization_params) {
+      // A single bias scale would only match the weights of one channel.
+      transformation->AddMessageF(
+          "Input array %s is a bias vector of weights quantized per channel, "
+          "so it can't be quantized per tensor",
+          input);
+      return false;
+    }
     const auto input_activations_scale =
         input_activations.quantization_params->scale;
     const auto input_weights_scale = input_weights.quantization_params->scale;
@@ -217,6 +225,100 @@ bool ChooseQuantizationForOperatorInput(
   return true;
 }
 
+// Returns the dimension of the output channels of the weights of 'op', its
+// input 1, or -1 if 'op' does not support weights quantized per channel.
+int GetWeightsChannelDimension(const Operator& op) {
+  switch (op.type) {
+    case OperatorType::kConv:
+    case OperatorType::kFullyConnected:
+      return 0;
+    case OperatorType::kDepthwiseConv:
+      return 3;
+    default:
+      return -1;
+  }
+}
+
+// Returns true if 'op' has no bias vector, or one that can be quantized with
+// one scale per output channel of weights of 'num_channels' channels.
+bool CanQuantizeBiasPerChannel(const Model& model, const Operator& op,
+                               int num_channels) {
+  if (op.inputs.size() < 3) {
+    return true;
+  }
+  const auto& bias = model.GetArray(op.inputs[2]);
+  return bias.data_type == ArrayDataType::kFloat &&
+         IsConstantParameterArray(model, op.inputs[2]) && bias.has_shape() &&
+         bias.shape().dimensions_count() == 1 &&
+         bias.shape().dims(0) == num_channels;
+}
+
+// Chooses symmetric int8 quantization with one scale per output channel for
+// constant weights, and int32 quantization with matching scales for the bias
+// vectors that go with them. Returns false for other inputs, which get the
+// usual per-tensor quantization. As the per-channel kernels expect the scale
+// of each bias value to match its channel, weights whose bias can't be
+// quantized per channel are quantized per tensor too.
+bool ChoosePerChannelQuantizationForOperatorInput(
+    GraphTransformation* transformation, Model* model, const Operator& op,
+    std::size_t input_index, ArrayDataType* quantized_data_type,
+    PerChannelQuantizationParams* per_channel_params) {
+  const int channel_dimension = GetWeightsChannelDimension(op);
+  if (channel_dimension < 0 || (input_index != 1 && input_index != 2)) {
+    return false;
+  }
+  const auto& input = op.inputs[input_index];
+  const auto& array = model->GetArray(input);
+  if (array.data_type != ArrayDataType::kFloat ||
+      !IsConstantParameterArray(*model, input) || !array.has_shape()) {
+    return false;
+  }
+
+  if (input_index == 1) {
+    if (!CanQuantizeBiasPerChannel(*model, op,
+                                   array.shape().dims(channel_dimension))) {
+      transformation->AddMessageF(
+          "Not quantizing weights array %s per channel, because its bias "
+          "vector can't be",
+          input);
+      return false;
+    }
+    *quantized_data_type = ArrayDataType::kInt8;
+    per_channel_params->quantized_dimension = channel_dimension;
+    ChooseSymmetricPerChannelScales(array, channel_dimension,
+                                    &per_channel_params->scales);
+    transformation->AddMessageF(
+        "Input array %s is a weights array. Choosing int8 quantization with "
+        "one scale per output channel.",
+        input);
+    return true;
+  }
+
+  // The bias vector. Its scales are the products of the scale of the input
+  // activations and of the scales of the weights.
+  const auto& input_activations = model->GetArray(op.inputs[0]);
+  const auto& input_weights = model->GetArray(op.inputs[1]);
+  if (!input_activations.quantization_params ||
+      !input_weights.per_channel_quantization_params) {
+    return false;
+  }
+  const double input_activations_scale =
+      input_activations.quantization_params->scale;
+  per_channel_params->quantized_dimension = 0;
+  per_channel_params->scales.clear();
+  for (double weights_scale :
+       input_weights.per_channel_quantization_params->scales) {
+    per_channel_params->scales.push_back(input_activations_scale *
+                                         weights_scale);
+  }
+  *quantized_data_type = ArrayDataType::kInt32;
+  transformation->AddMessageF(
+      "Input array %s is a bias vector of weights quantized per channel. "
+      "Choosing quantization params accordingly.",
+      input);
+  return true;
+}
+
 bool IsExactlyRepresentable(double real_value, ArrayDataType data_type,
                             const QuantizationParams& quantization_params) {
   const double scaled_value =
@@ -478,6 +580,16 @@ bool Quantize::Run(Model* model, std::size_t op_index) {
   for (std::size_t input_index = 0; input_index < op.inputs.size();
        input_index++) {
     ArrayDataType quantized_data_type;
+    PerChannelQuantizationParams per_channel_params;
+    if (per_channel_weights_ &&
+        ChoosePerChannelQuantizationForOperatorInput(
+            this, model, op, input_index, &quantized_data_type,
+            &per_channel_params)) {
+      QuantizeArrayPerChannel(this, model, op.inputs[input_index],
+                              quantized_data_type, per_channel_params);
+      changed = true;
+      continue;
+    }
     QuantizationParams quantization_params;
     if (ChooseQuantizationForOperatorInput(this, model, op, input_index,
                                            &quantized_data_type,
@@ -0,0 +1,116 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/model.h"
+#include "tensorflow/contrib/lite/toco/tooling_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace toco {
+
+namespace {
+
+// Smaller weight arrays are left in float: the time spent quantizing the
+// activations on the fly would not be made up for by the integer GEMM.
+constexpr int kMinWeightsSizeToQuantize = 1024;
+
+// Returns true if every consumer of `array_name` is a FullyConnected operator
+// using it as its weights.
+bool IsOnlyUsedAsFullyConnectedWeights(const Model& model,
+                                       const string& array_name) {
+  for (const auto& op : model.operators) {
+    for (int i = 0; i < op->inputs.size(); ++i) {
+      if (op->inputs[i] != array_name) continue;
+      if (op->type != OperatorType::kFullyConnected || i != 1) return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+// Quantizes the constant float weights of FullyConnected operators with
+// float activations to symmetric int8 values, for the hybrid runtime kernels.
+// The RNN kernel also runs hybrid, but LSTM does not, so the weights of the
+// recurrent ops are left in float.
+// As TF Lite has no int8 tensor type, the int8 values are stored in a uint8
+// array with a zero_point of 0, and the runtime reinterprets them as int8.
+bool QuantizeWeights::Run(Model* model, std::size_t op_index) {
+  const auto& op = *model->operators[op_index];
+  if (op.type != OperatorType::kFullyConnected) {
+    return false;
+  }
+  const auto& fc_op = static_cast<const FullyConnectedOperator&>(op);
+  if (fc_op.experimental_shuffled_weights) {
+    return false;
+  }
+  const auto& input_array = model->GetArray(op.inputs[0]);
+  if (input_array.data_type != ArrayDataType::kFloat) {
+    return false;
+  }
+  const string& weights_name = op.inputs[1];
+  if (!IsConstantParameterArray(*model, weights_name)) {
+    return false;
+  }
+  auto& weights_array = model->GetArray(weights_name);
+  if (weights_array.data_type != ArrayDataType::kFloat ||
+      weights_array.quantization_params) {
+    return false;
+  }
+  const auto& float_data =
+      weights_array.GetBuffer<ArrayDataType::kFloat>().data;
+  if (float_data.size() < kMinWeightsSizeToQuantize) {
+    return false;
+  }
+  if (!IsOnlyUsedAsFullyConnectedWeights(*model, weights_name)) {
+    return false;
+  }
+
+  float max_abs = 0.f;
+  for (float value : float_data) {
+    max_abs = std::max(max_abs, std::abs(value));
+  }
+  const double scale = max_abs == 0.f ? 1. : max_abs / 127.;
+
+  std::vector<uint8> quantized_data(float_data.size());
+  for (int i = 0; i < float_data.size(); ++i) {
+    const int32 q = static_cast<int32>(std::round(float_data[i] / scale));
+    const int8 clamped = static_cast<int8>(std::min(127, std::max(-127, q)));
+    quantized_data[i] = static_cast<uint8>(clamped);
+  }
+
+  weights_array.buffer = nullptr;
+  weights_array.data_type = ArrayDataType::kUint8;
+  weights_array.final_data_type = ArrayDataType::kUint8;
+  weights_array.GetMutableBuffer<ArrayDataType::kUint8>().data =
+      std::move(quantized_data);
+  auto& quantization_params = weights_array.GetOrCreateQuantizationParams();
+  quantization_params.scale = scale;
+  quantization_params.zero_point = 0;
+  // The array is not a regular asymmetric uint8 array any more, so its
+  // min/max would only be misleading.
+  weights_array.minmax = nullptr;
+
+  AddMessageF("Quantized the weights %s of %s to int8 with scale %g",
+              weights_name, LogName(op), scale);
+  return true;
+}
+
+}  // namespace toco
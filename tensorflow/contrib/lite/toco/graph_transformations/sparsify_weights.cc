@@ -0,0 +1,148 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/model.h"
+#include "tensorflow/contrib/lite/toco/tooling_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace toco {
+
+namespace {
+
+// Returns true if the TF Lite runtime has a sparse kernel for 'op', which
+// takes its weights as input 1: FullyConnected, and Conv with a 1x1 filter
+// and a stride of 1, which is a FullyConnected over the pixels.
+bool HasSparseKernel(const Model& model, const Operator& op) {
+  if (op.type == OperatorType::kFullyConnected) {
+    return !static_cast<const FullyConnectedOperator&>(op)
+                .experimental_shuffled_weights;
+  }
+  if (op.type != OperatorType::kConv) {
+    return false;
+  }
+  const auto& conv_op = static_cast<const ConvOperator&>(op);
+  if (conv_op.stride_width != 1 || conv_op.stride_height != 1) {
+    return false;
+  }
+  const auto& weights_array = model.GetArray(op.inputs[1]);
+  if (!weights_array.has_shape()) {
+    return false;
+  }
+  const auto& weights_shape = weights_array.shape();
+  return weights_shape.dimensions_count() == 4 && weights_shape.dims(1) == 1 &&
+         weights_shape.dims(2) == 1;
+}
+
+// Returns true if every consumer of 'array_name' is an op with a sparse
+// kernel using it as its weights.
+bool IsOnlyUsedAsSparseKernelWeights(const Model& model,
+                                     const string& array_name) {
+  for (const auto& op : model.operators) {
+    for (int i = 0; i < op->inputs.size(); ++i) {
+      if (op->inputs[i] != array_name) continue;
+      if (i != 1 || !HasSparseKernel(model, *op)) return false;
+    }
+  }
+  return true;
+}
+
+// Returns the number of blocks of block_rows x block_cols of 'data', a
+// row-major matrix with 'cols' columns, whose values are all zero.
+int CountZeroBlocks(const std::vector<float>& data, int cols, int block_rows,
+                    int block_cols) {
+  const int rows = data.size() / cols;
+  int num_zero_blocks = 0;
+  for (int r = 0; r < rows; r += block_rows) {
+    for (int c = 0; c < cols; c += block_cols) {
+      bool is_zero = true;
+      for (int i = 0; i < block_rows && is_zero; ++i) {
+        for (int j = 0; j < block_cols && is_zero; ++j) {
+          is_zero = data[(r + i) * cols + c + j] == 0.f;
+        }
+      }
+      if (is_zero) ++num_zero_blocks;
+    }
+  }
+  return num_zero_blocks;
+}
+
+}  // namespace
+
+// Marks the constant float weights of FullyConnected and 1x1 Conv ops whose
+// blocks are mostly zero as sparse, for the tflite exporter to store only the
+// non-zero blocks and for the runtime to skip the zero ones. The blocks span
+// one output channel and as many input channels as the SIMD kernels handle at
+// once, so that pruned rows and groups of input channels both become blocks.
+bool SparsifyWeights::Run(Model* model, std::size_t op_index) {
+  const auto& op = *model->operators[op_index];
+  if (!HasSparseKernel(*model, op)) {
+    return false;
+  }
+  const auto& input_array = model->GetArray(op.inputs[0]);
+  if (input_array.data_type != ArrayDataType::kFloat) {
+    return false;
+  }
+  const string& weights_name = op.inputs[1];
+  if (!IsConstantParameterArray(*model, weights_name)) {
+    return false;
+  }
+  auto& weights_array = model->GetArray(weights_name);
+  if (weights_array.data_type != ArrayDataType::kFloat ||
+      weights_array.quantization_params || weights_array.sparsity_params ||
+      !weights_array.has_shape()) {
+    return false;
+  }
+  if (!IsOnlyUsedAsSparseKernelWeights(*model, weights_name)) {
+    return false;
+  }
+
+  const auto& float_data =
+      weights_array.GetBuffer<ArrayDataType::kFloat>().data;
+  const int cols = weights_array.shape().dims().back();
+  if (cols == 0 || float_data.empty()) {
+    return false;
+  }
+  const int block_rows = 1;
+  int block_cols = 1;
+  for (int candidate : {4, 2}) {
+    if (cols % candidate == 0) {
+      block_cols = candidate;
+      break;
+    }
+  }
+  const int num_blocks = float_data.size() / (block_rows * block_cols);
+  const int num_zero_blocks =
+      CountZeroBlocks(float_data, cols, block_rows, block_cols);
+  const float zero_fraction = static_cast<float>(num_zero_blocks) / num_blocks;
+  if (num_zero_blocks == 0 || zero_fraction < threshold_) {
+    return false;
+  }
+
+  auto& sparsity_params = weights_array.GetOrCreateSparsityParams();
+  sparsity_params.block_rows = block_rows;
+  sparsity_params.block_cols = block_cols;
+  AddMessageF(
+      "Stored the weights %s of %s as sparse blocks of %dx%d, %d of %d of "
+      "which are zero",
+      weights_name, LogName(op), block_rows, block_cols, num_zero_blocks,
+      num_blocks);
+  return true;
+}
+
+}  // namespace toco
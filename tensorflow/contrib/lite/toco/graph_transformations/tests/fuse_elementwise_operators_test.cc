@@ -0,0 +1,139 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/model.h"
+#include "tensorflow/contrib/lite/toco/tooling_util.h"
+
+namespace toco {
+
+namespace {
+
+using ::testing::ElementsAre;
+
+class FuseElementwiseOperatorsTest : public ::testing::Test {
+ protected:
+  void CreateArray(const string& name, const std::vector<int>& shape) {
+    Array& array = model_.GetOrCreateArray(name);
+    array.data_type = ArrayDataType::kFloat;
+    *array.mutable_shape()->mutable_dims() = shape;
+  }
+
+  template <typename T>
+  T* CreateOperator(const std::vector<string>& inputs, const string& output) {
+    auto* op = new T;
+    op->inputs = inputs;
+    op->outputs = {output};
+    model_.operators.emplace_back(op);
+    return op;
+  }
+
+  // Runs the transformation on every operator until it no longer applies.
+  void Fuse() {
+    FuseElementwiseOperators fuse;
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (int i = 0; i < model_.operators.size(); ++i) {
+        if (fuse.Run(&model_, i)) {
+          changed = true;
+          break;
+        }
+      }
+    }
+  }
+
+  // Returns the steps of the FusedElementwise operator of the model as
+  // (type, lhs, rhs) tuples.
+  std::vector<std::tuple<OperatorType, int, int>> Steps(const Operator& op) {
+    EXPECT_EQ(op.type, OperatorType::kFusedElementwise);
+    std::vector<std::tuple<OperatorType, int, int>> steps;
+    for (const auto& step :
+         static_cast<const FusedElementwiseOperator&>(op).steps) {
+      steps.emplace_back(step.type, step.lhs, step.rhs);
+    }
+    return steps;
+  }
+
+  Model model_;
+};
+
+TEST_F(FuseElementwiseOperatorsTest, FusesChain) {
+  // output = logistic(x + bias) * x, with a scalar bias and a fused Relu6.
+  CreateArray("x", {2, 8});
+  CreateArray("bias", {1});
+  CreateArray("sum", {2, 8});
+  CreateArray("gate", {2, 8});
+  CreateArray("output", {2, 8});
+  CreateOperator<AddOperator>({"x", "bias"}, "sum");
+  CreateOperator<LogisticOperator>({"sum"}, "gate");
+  CreateOperator<MulOperator>({"gate", "x"}, "output")
+      ->fused_activation_function = FusedActivationFunctionType::kRelu6;
+
+  Fuse();
+  ASSERT_EQ(model_.operators.size(), 1);
+  const Operator& op = *model_.operators[0];
+  EXPECT_THAT(op.inputs, ElementsAre("x", "bias"));
+  EXPECT_THAT(op.outputs, ElementsAre("output"));
+  EXPECT_EQ(op.fused_activation_function, FusedActivationFunctionType::kNone);
+  EXPECT_THAT(Steps(op),
+              ElementsAre(std::make_tuple(OperatorType::kAdd, 0, 1),
+                          std::make_tuple(OperatorType::kLogistic, 2, -1),
+                          std::make_tuple(OperatorType::kMul, 3, 0),
+                          std::make_tuple(OperatorType::kRelu6, 4, -1)));
+  EXPECT_FALSE(model_.HasArray("sum"));
+  EXPECT_FALSE(model_.HasArray("gate"));
+}
+
+TEST_F(FuseElementwiseOperatorsTest, KeepsSharedIntermediate) {
+  // 'sum' is also read by a second Tanh, so it must stay.
+  CreateArray("x", {4});
+  CreateArray("y", {4});
+  CreateArray("sum", {4});
+  CreateArray("a", {4});
+  CreateArray("b", {4});
+  CreateOperator<AddOperator>({"x", "y"}, "sum");
+  CreateOperator<ExpOperator>({"sum"}, "a");
+  CreateOperator<TanhOperator>({"sum"}, "b");
+
+  Fuse();
+  EXPECT_EQ(model_.operators.size(), 3);
+  EXPECT_TRUE(model_.HasArray("sum"));
+}
+
+TEST_F(FuseElementwiseOperatorsTest, KeepsBroadcast) {
+  // The Add broadcasts 'row' along the first dimension, which the fused op
+  // does not support.
+  CreateArray("x", {3, 4});
+  CreateArray("row", {4});
+  CreateArray("sum", {3, 4});
+  CreateArray("output", {3, 4});
+  CreateOperator<AddOperator>({"x", "row"}, "sum");
+  CreateOperator<TanhOperator>({"sum"}, "output");
+
+  Fuse();
+  ASSERT_EQ(model_.operators.size(), 2);
+  EXPECT_EQ(model_.operators[0]->type, OperatorType::kAdd);
+  EXPECT_EQ(model_.operators[1]->type, OperatorType::kTanh);
+}
+
+}  // namespace
+}  // namespace toco
@@ -0,0 +1,140 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/model.h"
+#include "tensorflow/contrib/lite/toco/tooling_util.h"
+
+namespace toco {
+
+namespace {
+
+using ::testing::DoubleNear;
+using ::testing::ElementsAre;
+
+class QuantizeTest : public ::testing::Test {
+ protected:
+  // Builds the graph Dequantize -> Conv, where the Conv has two output
+  // channels of very different magnitudes. Returns the index of the Conv.
+  int BuildConvModel() {
+    Array& input = model_.GetOrCreateArray("input");
+    input.data_type = ArrayDataType::kUint8;
+    input.copy_shape(Shape({1, 2, 2, 1}));
+    input.GetOrCreateQuantizationParams().zero_point = 128;
+    input.GetOrCreateQuantizationParams().scale = 0.5;
+
+    Array& dequantized = model_.GetOrCreateArray("input_dequantized");
+    dequantized.data_type = ArrayDataType::kFloat;
+    dequantized.copy_shape(Shape({1, 2, 2, 1}));
+    dequantized.GetOrCreateMinMax() = {-64, 63.5};
+
+    CreateConstantArray("weights", {2, 1, 1, 1}, {1.f, -0.01f});
+    CreateConstantArray("bias", {2}, {1.f, 2.f});
+
+    Array& output = model_.GetOrCreateArray("output");
+    output.data_type = ArrayDataType::kFloat;
+    output.copy_shape(Shape({1, 2, 2, 2}));
+    output.GetOrCreateMinMax() = {-10, 10};
+
+    auto* dequantize_op = new DequantizeOperator;
+    dequantize_op->inputs = {"input"};
+    dequantize_op->outputs = {"input_dequantized"};
+    model_.operators.emplace_back(dequantize_op);
+    auto* conv_op = new ConvOperator;
+    conv_op->inputs = {"input_dequantized", "weights", "bias"};
+    conv_op->outputs = {"output"};
+    model_.operators.emplace_back(conv_op);
+    return 1;
+  }
+
+  void CreateConstantArray(const string& name, const std::vector<int>& shape,
+                           const std::vector<float>& data) {
+    Array& array = model_.GetOrCreateArray(name);
+    array.data_type = ArrayDataType::kFloat;
+    *array.mutable_shape()->mutable_dims() = shape;
+    array.GetMutableBuffer<ArrayDataType::kFloat>().data = data;
+  }
+
+  Model model_;
+};
+
+TEST_F(QuantizeTest, PerTensorWeights) {
+  const int conv_index = BuildConvModel();
+  Quantize quantize;
+  EXPECT_TRUE(quantize.Run(&model_, conv_index));
+
+  const Array& weights = model_.GetArray("weights");
+  EXPECT_EQ(weights.data_type, ArrayDataType::kUint8);
+  EXPECT_FALSE(weights.per_channel_quantization_params);
+  EXPECT_FALSE(model_.GetArray("bias").per_channel_quantization_params);
+}
+
+TEST_F(QuantizeTest, PerChannelWeights) {
+  const int conv_index = BuildConvModel();
+  Quantize quantize;
+  quantize.set_per_channel_weights(true);
+  EXPECT_TRUE(quantize.Run(&model_, conv_index));
+
+  // Each output channel of the weights uses the whole int8 range.
+  const Array& weights = model_.GetArray("weights");
+  EXPECT_EQ(weights.data_type, ArrayDataType::kInt8);
+  EXPECT_THAT(weights.GetBuffer<ArrayDataType::kInt8>().data,
+              ElementsAre(127, -127));
+  ASSERT_TRUE(weights.per_channel_quantization_params);
+  EXPECT_EQ(weights.per_channel_quantization_params->quantized_dimension, 0);
+  EXPECT_THAT(weights.per_channel_quantization_params->scales,
+              ElementsAre(DoubleNear(1. / 127, 1e-9),
+                          DoubleNear(0.01 / 127, 1e-9)));
+  EXPECT_EQ(weights.GetQuantizationParams().zero_point, 0);
+
+  // The bias scales are those of the weights times that of the input.
+  const Array& bias = model_.GetArray("bias");
+  EXPECT_EQ(bias.data_type, ArrayDataType::kInt32);
+  ASSERT_TRUE(bias.per_channel_quantization_params);
+  EXPECT_THAT(bias.per_channel_quantization_params->scales,
+              ElementsAre(DoubleNear(0.5 / 127, 1e-9),
+                          DoubleNear(0.005 / 127, 1e-9)));
+  EXPECT_THAT(bias.GetBuffer<ArrayDataType::kInt32>().data,
+              ElementsAre(254, 50800));
+
+  EXPECT_EQ(model_.GetArray("output").data_type, ArrayDataType::kUint8);
+}
+
+TEST_F(QuantizeTest, PerTensorWeightsWhenBiasCantBePerChannel) {
+  const int conv_index = BuildConvModel();
+  // Without a shape, the bias can't be split into channels.
+  model_.GetArray("bias").clear_shape();
+  Quantize quantize;
+  quantize.set_per_channel_weights(true);
+  EXPECT_TRUE(quantize.Run(&model_, conv_index));
+
+  // The weights fall back to one scale, which the bias scale matches.
+  const Array& weights = model_.GetArray("weights");
+  EXPECT_EQ(weights.data_type, ArrayDataType::kUint8);
+  EXPECT_FALSE(weights.per_channel_quantization_params);
+  const Array& bias = model_.GetArray("bias");
+  EXPECT_EQ(bias.data_type, ArrayDataType::kInt32);
+  EXPECT_FALSE(bias.per_channel_quantization_params);
+  EXPECT_DOUBLE_EQ(bias.GetQuantizationParams().scale,
+                   0.5 * weights.GetQuantizationParams().scale);
+}
+
+}  // namespace
+}  // namespace toco
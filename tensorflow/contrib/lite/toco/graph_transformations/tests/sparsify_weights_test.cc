@@ -0,0 +1,138 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/model.h"
+#include "tensorflow/contrib/lite/toco/tooling_util.h"
+
+namespace toco {
+
+namespace {
+
+class SparsifyWeightsTest : public ::testing::Test {
+ protected:
+  // Adds a FullyConnected op with the given 2x8 weights. Returns its index.
+  int AddFullyConnected(const string& weights_name,
+                        const std::vector<float>& weights) {
+    CreateArray("input", {1, 8});
+    CreateConstantArray(weights_name, {2, 8}, weights);
+    CreateArray(weights_name + "_output", {1, 2});
+    auto* fc_op = new FullyConnectedOperator;
+    fc_op->inputs = {"input", weights_name};
+    fc_op->outputs = {weights_name + "_output"};
+    model_.operators.emplace_back(fc_op);
+    return model_.operators.size() - 1;
+  }
+
+  // Adds a Conv op with the given weights. Returns its index.
+  int AddConv(const std::vector<int>& weights_shape, int stride) {
+    CreateArray("conv_input", {1, 2, 2, weights_shape[3]});
+    Shape shape;
+    *shape.mutable_dims() = weights_shape;
+    std::vector<float> weights(RequiredBufferSizeForShape(shape), 0.f);
+    weights[0] = 1.f;
+    CreateConstantArray("conv_weights", weights_shape, weights);
+    CreateArray("conv_output", {1, 2, 2, weights_shape[0]});
+    auto* conv_op = new ConvOperator;
+    conv_op->inputs = {"conv_input", "conv_weights"};
+    conv_op->outputs = {"conv_output"};
+    conv_op->stride_width = stride;
+    conv_op->stride_height = stride;
+    model_.operators.emplace_back(conv_op);
+    return model_.operators.size() - 1;
+  }
+
+  void CreateArray(const string& name, const std::vector<int>& shape) {
+    Array& array = model_.GetOrCreateArray(name);
+    array.data_type = ArrayDataType::kFloat;
+    *array.mutable_shape()->mutable_dims() = shape;
+  }
+
+  void CreateConstantArray(const string& name, const std::vector<int>& shape,
+                           const std::vector<float>& data) {
+    CreateArray(name, shape);
+    model_.GetArray(name).GetMutableBuffer<ArrayDataType::kFloat>().data =
+        data;
+  }
+
+  Model model_;
+};
+
+TEST_F(SparsifyWeightsTest, FullyConnected) {
+  // Three of the four blocks of 1x4 are zero.
+  const int fc_index =
+      AddFullyConnected("weights", {0, 0, 0, 0, 1, 0, 0, 2,  //
+                                    0, 0, 0, 0, 0, 0, 0, 0});
+  SparsifyWeights sparsify_weights;
+  sparsify_weights.set_threshold(0.75f);
+  EXPECT_TRUE(sparsify_weights.Run(&model_, fc_index));
+
+  const Array& weights = model_.GetArray("weights");
+  ASSERT_TRUE(weights.sparsity_params);
+  EXPECT_EQ(weights.sparsity_params->block_rows, 1);
+  EXPECT_EQ(weights.sparsity_params->block_cols, 4);
+  // The buffer stays dense until export.
+  EXPECT_EQ(weights.GetBuffer<ArrayDataType::kFloat>().data.size(), 16);
+
+  // Already sparse.
+  EXPECT_FALSE(sparsify_weights.Run(&model_, fc_index));
+}
+
+TEST_F(SparsifyWeightsTest, BelowThreshold) {
+  const int fc_index =
+      AddFullyConnected("weights", {0, 0, 0, 0, 1, 0, 0, 2,  //
+                                    3, 0, 0, 0, 0, 0, 0, 0});
+  SparsifyWeights sparsify_weights;
+  sparsify_weights.set_threshold(0.75f);
+  EXPECT_FALSE(sparsify_weights.Run(&model_, fc_index));
+  EXPECT_FALSE(model_.GetArray("weights").sparsity_params);
+
+  sparsify_weights.set_threshold(0.5f);
+  EXPECT_TRUE(sparsify_weights.Run(&model_, fc_index));
+}
+
+TEST_F(SparsifyWeightsTest, WeightsUsedByAnotherOp) {
+  const int fc_index = AddFullyConnected("weights", std::vector<float>(16));
+  auto* add_op = new AddOperator;
+  add_op->inputs = {"weights", "weights"};
+  add_op->outputs = {"sum"};
+  model_.operators.emplace_back(add_op);
+  SparsifyWeights sparsify_weights;
+  EXPECT_FALSE(sparsify_weights.Run(&model_, fc_index));
+}
+
+TEST_F(SparsifyWeightsTest, Conv) {
+  SparsifyWeights sparsify_weights;
+  // Only 1x1 filters with a stride of 1 have a sparse kernel.
+  EXPECT_FALSE(sparsify_weights.Run(&model_, AddConv({4, 3, 3, 6}, 1)));
+  model_.operators.clear();
+  EXPECT_FALSE(sparsify_weights.Run(&model_, AddConv({4, 1, 1, 6}, 2)));
+  model_.operators.clear();
+  EXPECT_TRUE(sparsify_weights.Run(&model_, AddConv({4, 1, 1, 6}, 1)));
+
+  // Six input channels make blocks of 1x2.
+  const Array& weights = model_.GetArray("conv_weights");
+  ASSERT_TRUE(weights.sparsity_params);
+  EXPECT_EQ(weights.sparsity_params->block_rows, 1);
+  EXPECT_EQ(weights.sparsity_params->block_cols, 2);
+}
+
+}  // namespace
+}  // namespace toco
@@ -123,6 +123,9 @@ enum class OperatorType {
   kTopK_V2,
   kDynamicPartition,
   kDynamicStitch,
+  // A chain of elementwise operators, fused by FuseElementwiseOperators to be
+  // evaluated in a single pass.
+  kFusedElementwise,
   // An unsupported TF operation. It's only needed to be able to represent TF
   // graph internally and is expected to be dropped by graph transformations.
   kTensorFlowUnsupported,
@@ -737,6 +740,25 @@ inline bool operator==(const MinMax& m1, const MinMax& m2) {
   return m1.min == m2.min && m1.max == m2.max;
 }
 
+// Quantization parameters of an array quantized symmetrically per channel,
+// such as the weights of a convolution: the real value of an element is its
+// quantized value times scales[i], where i is its index along the dimension
+// 'quantized_dimension'.
+struct PerChannelQuantizationParams {
+  std::vector<double> scales;
+  int quantized_dimension = 0;
+};
+
+// Requests that a constant array be stored sparsely when exported, keeping
+// only its blocks of block_rows x block_cols elements that are not all zeros.
+// The array is viewed as a matrix whose columns are its last dimension and
+// whose rows are all its other dimensions, which the blocks must tile. The
+// buffer of the array itself stays dense.
+struct SparsityParams {
+  int block_rows = 1;
+  int block_cols = 1;
+};
+
 // Fake-quantization operator. This does two things:
 //   - Annotate its input and output arrays with MinMax information,
 //   - Arithmetic-wise, this operator rounds incoming activation values
@@ -966,6 +988,31 @@ struct ExpOperator : Operator {
   ExpOperator() : Operator(OperatorType::kExp) {}
 };
 
+// A chain of elementwise float operators evaluated in a single pass, as
+// fused by FuseElementwiseOperators.
+//
+// Inputs:
+//   inputs[0..n-1]: required: arrays of the shape of the output, or with a
+//   single value, which is broadcast.
+//
+// Each step applies one operator, such as kMul or kLogistic, to operands that
+// index values numbered as follows: the inputs first, then the results of the
+// previous steps. The output is the result of the last step.
+//
+// TensorFlow equivalent: none. TF Lite: the FusedElementwise custom op.
+struct FusedElementwiseOperator : Operator {
+  FusedElementwiseOperator() : Operator(OperatorType::kFusedElementwise) {}
+  struct Step {
+    // One of kAdd, kSub, kMul, kDiv, kExp, kLogistic, kTanh, kRelu, kRelu1
+    // and kRelu6.
+    OperatorType type = OperatorType::kNone;
+    int lhs = -1;
+    // -1 for unary operators.
+    int rhs = -1;
+  };
+  std::vector<Step> steps;
+};
+
 // Given a tensor input, this operation inserts a dimension of 1 at the
 // dimension index axis of input's shape. The dimension index axis starts at
 // zero; if you specify a negative number for axis it is counted backward from
@@ -1648,6 +1695,20 @@ struct Array {
     DCHECK(quantization_params);
     return *quantization_params;
   }
+  PerChannelQuantizationParams& GetOrCreatePerChannelQuantizationParams() {
+    if (!per_channel_quantization_params) {
+      per_channel_quantization_params =
+          std::unique_ptr<PerChannelQuantizationParams>(
+              new PerChannelQuantizationParams);
+    }
+    return *per_channel_quantization_params;
+  }
+  SparsityParams& GetOrCreateSparsityParams() {
+    if (!sparsity_params) {
+      sparsity_params = std::unique_ptr<SparsityParams>(new SparsityParams);
+    }
+    return *sparsity_params;
+  }
 
   // The data type of the actual elements of this array, that is:
   //  - If there is a buffer (see 'buffer' member), it must be of the same
@@ -1733,6 +1794,12 @@ struct Array {
   // If this is non-null, then these quantization parameters are to be used
   // to assign a meaning as real numbers to the elements of this array.
   std::unique_ptr<QuantizationParams> quantization_params;
+  // Optional scales of the channels of a symmetrically quantized array. When
+  // set, they override the scale of 'quantization_params', which then holds
+  // the largest of them and a zero point of 0.
+  std::unique_ptr<PerChannelQuantizationParams> per_channel_quantization_params;
+  // Optional block sparse layout of a constant array in the exported model.
+  std::unique_ptr<SparsityParams> sparsity_params;
 
  private:
   std::unique_ptr<Shape> array_shape;
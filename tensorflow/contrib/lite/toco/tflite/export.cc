@@ -55,6 +55,12 @@ details::OperatorKey GetOperatorKey(const ::toco::Operator& op) {
   return details::OperatorKey(op.type, custom_code);
 }
 
+// Returns true for the custom ops that TF Lite's BuiltinOpResolver registers,
+// which are not custom implementations to be provided by the user.
+bool IsRegisteredCustomOp(const string& name) {
+  return name == "FusedElementwise";
+}
+
 }  // Anonymous namespace.
 
 namespace details {
@@ -121,19 +127,38 @@ Offset<Vector<Offset<Tensor>>> ExportTensors(
       max = builder->CreateVector(
           std::vector<float>{static_cast<float>(array.minmax->max)});
     }
-    if (array.quantization_params) {
+    int quantized_dimension = 0;
+    if (array.per_channel_quantization_params) {
+      const auto& per_channel = *array.per_channel_quantization_params;
+      scale = builder->CreateVector(std::vector<float>(
+          per_channel.scales.begin(), per_channel.scales.end()));
+      zero_point = builder->CreateVector(
+          std::vector<int64_t>(per_channel.scales.size(), 0));
+      quantized_dimension = per_channel.quantized_dimension;
+    } else if (array.quantization_params) {
       scale = builder->CreateVector(std::vector<float>{
           static_cast<float>(array.quantization_params->scale)});
       zero_point = builder->CreateVector(
           std::vector<int64_t>{array.quantization_params->zero_point});
     }
-    auto q_param = ::tflite::CreateQuantizationParameters(*builder, min, max,
-                                                          scale, zero_point);
+    auto q_param = ::tflite::CreateQuantizationParameters(
+        *builder, min, max, scale, zero_point, quantized_dimension);
+
+    Offset<::tflite::SparsityParameters> sparsity;
+    if (array.sparsity_params && array.buffer) {
+      std::vector<int> row_segments;
+      std::vector<int> col_indices;
+      std::vector<float> values;
+      SparseBuffer::Compress(array, &row_segments, &col_indices, &values);
+      sparsity = ::tflite::CreateSparsityParametersDirect(
+          *builder, array.sparsity_params->block_rows,
+          array.sparsity_params->block_cols, &row_segments, &col_indices);
+    }
 
     int index = tensors_map.at(tensor_name);
     ordered_tensors[index] =
         CreateTensor(*builder, builder->CreateVector(shape), type, buffer_index,
-                     builder->CreateString(tensor_name), q_param);
+                     builder->CreateString(tensor_name), q_param, sparsity);
   }
 
   std::vector<Offset<Tensor>> tensor_vector;
@@ -208,7 +233,7 @@ Offset<Vector<Offset<OperatorCode>>> ExportOperatorCodes(
       }
       // Either way, this is an operator that is not supported by TF Lite,
       // so we output it as a custom op and add it to the error summary.
-      if (error_summary) {
+      if (error_summary && !IsRegisteredCustomOp(name)) {
         error_summary->insert(name);
       }
       ordered_opcodes[op_index] = CreateOperatorCode(
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/contrib/lite/toco/tflite/import.h"
 
+#include <algorithm>
+
 #include "flatbuffers/flexbuffers.h"
 #include "tensorflow/contrib/lite/model.h"
 #include "tensorflow/contrib/lite/schema/schema_generated.h"
@@ -77,8 +79,8 @@ void ImportTensors(const ::tflite::Model& input_model, Model* model) {
 
     auto quantization = input_tensor->quantization();
     if (quantization) {
-      // Note that tf.mini only supports a single quantization parameters for
-      // the whole array.
+      // Note that tf.mini only supports a single min/max and zero point for
+      // the whole array, and scales per channel for symmetric quantization.
       if (quantization->min() && quantization->max()) {
         CHECK_EQ(1, quantization->min()->Length());
         CHECK_EQ(1, quantization->max()->Length());
@@ -86,7 +88,23 @@ void ImportTensors(const ::tflite::Model& input_model, Model* model) {
         minmax.min = quantization->min()->Get(0);
         minmax.max = quantization->max()->Get(0);
       }
-      if (quantization->scale() && quantization->zero_point()) {
+      if (quantization->scale() && quantization->zero_point() &&
+          quantization->scale()->Length() > 1) {
+        CHECK_EQ(quantization->scale()->Length(),
+                 quantization->zero_point()->Length());
+        PerChannelQuantizationParams& per_channel =
+            array.GetOrCreatePerChannelQuantizationParams();
+        per_channel.quantized_dimension = quantization->quantized_dimension();
+        double max_scale = 0;
+        for (int i = 0; i < quantization->scale()->Length(); ++i) {
+          CHECK_EQ(0, quantization->zero_point()->Get(i));
+          per_channel.scales.push_back(quantization->scale()->Get(i));
+          max_scale = std::max(max_scale, per_channel.scales.back());
+        }
+        QuantizationParams& q = array.GetOrCreateQuantizationParams();
+        q.scale = max_scale;
+        q.zero_point = 0;
+      } else if (quantization->scale() && quantization->zero_point()) {
         CHECK_EQ(1, quantization->scale()->Length());
         CHECK_EQ(1, quantization->zero_point()->Length());
         QuantizationParams& q = array.GetOrCreateQuantizationParams();
@@ -94,6 +112,14 @@ void ImportTensors(const ::tflite::Model& input_model, Model* model) {
         q.zero_point = quantization->zero_point()->Get(0);
       }
     }
+
+    auto sparsity = input_tensor->sparsity();
+    if (sparsity) {
+      // The buffer was made dense again by DataBuffer::Deserialize().
+      SparsityParams& sparsity_params = array.GetOrCreateSparsityParams();
+      sparsity_params.block_rows = sparsity->block_rows();
+      sparsity_params.block_cols = sparsity->block_cols();
+    }
   }
 }
 
@@ -58,10 +58,17 @@ class ImportTest : public ::testing::Test {
         ::tflite::CreateTensor(builder_, builder_.CreateVector<int>({1, 2, 2}),
                                ::tflite::TensorType_FLOAT32, 1,
                                builder_.CreateString("tensor_one"), q);
+    // One scale per index of the first dimension.
+    auto per_channel_q = ::tflite::CreateQuantizationParameters(
+        builder_, /*min=*/0, /*max=*/0,
+        /*scale=*/builder_.CreateVector<float>({0.5f, 0.25f}),
+        /*zero_point=*/builder_.CreateVector<int64_t>({0ll, 0ll}),
+        /*quantized_dimension=*/0);
     auto t2 =
         ::tflite::CreateTensor(builder_, builder_.CreateVector<int>({2, 1}),
                                ::tflite::TensorType_FLOAT32, 2,
-                               builder_.CreateString("tensor_two"), q);
+                               builder_.CreateString("tensor_two"),
+                               per_channel_q);
     return builder_.CreateVector(
         std::vector<Offset<::tflite::Tensor>>({t1, t2}));
   }
@@ -180,6 +187,17 @@ TEST_F(ImportTest, Tensors) {
   ASSERT_TRUE(q.get());
   EXPECT_FLOAT_EQ(0.3, q->scale);
   EXPECT_EQ(100, q->zero_point);
+  EXPECT_FALSE(a1.per_channel_quantization_params);
+
+  Array& a2 = model->GetArray("tensor_two");
+  const auto& per_channel_q = a2.per_channel_quantization_params;
+  ASSERT_TRUE(per_channel_q.get());
+  EXPECT_THAT(per_channel_q->scales, ElementsAre(0.5, 0.25));
+  EXPECT_EQ(0, per_channel_q->quantized_dimension);
+  // The per-tensor parameters hold the largest scale.
+  ASSERT_TRUE(a2.quantization_params.get());
+  EXPECT_FLOAT_EQ(0.5, a2.quantization_params->scale);
+  EXPECT_EQ(0, a2.quantization_params->zero_point);
 }
 
 TEST_F(ImportTest, NoBuffers) {
@@ -276,6 +276,70 @@ class FakeQuant : public CustomOperator<FakeQuantOperator> {
   }
 };
 
+class FusedElementwise : public CustomOperator<FusedElementwiseOperator> {
+ public:
+  using CustomOperator::CustomOperator;
+  void WriteOptions(const TocoOperator& op,
+                    flexbuffers::Builder* fbb) const override {
+    fbb->Vector("operations", [&]() {
+      for (const auto& step : op.steps) fbb->String(StepName(step.type));
+    });
+    fbb->Vector("lhs", [&]() {
+      for (const auto& step : op.steps) fbb->Int(step.lhs);
+    });
+    fbb->Vector("rhs", [&]() {
+      for (const auto& step : op.steps) fbb->Int(step.rhs);
+    });
+  }
+  void ReadOptions(const flexbuffers::Map& m, TocoOperator* op) const override {
+    const auto operations = m["operations"].AsVector();
+    const auto lhs = m["lhs"].AsVector();
+    const auto rhs = m["rhs"].AsVector();
+    CHECK_EQ(operations.size(), lhs.size());
+    CHECK_EQ(operations.size(), rhs.size());
+    for (int i = 0; i < operations.size(); ++i) {
+      FusedElementwiseOperator::Step step;
+      step.type = StepType(operations[i].AsString().str());
+      step.lhs = lhs[i].AsInt32();
+      step.rhs = rhs[i].AsInt32();
+      op->steps.push_back(step);
+    }
+  }
+
+ private:
+  // The names of the operators in the TF Lite kernel, those of the builtin
+  // ops that compute them.
+  static const std::vector<std::pair<OperatorType, string>>& StepNames() {
+    static const auto* step_names =
+        new std::vector<std::pair<OperatorType, string>>({
+            {OperatorType::kAdd, "ADD"},
+            {OperatorType::kSub, "SUB"},
+            {OperatorType::kMul, "MUL"},
+            {OperatorType::kDiv, "DIV"},
+            {OperatorType::kExp, "EXP"},
+            {OperatorType::kLogistic, "LOGISTIC"},
+            {OperatorType::kTanh, "TANH"},
+            {OperatorType::kRelu, "RELU"},
+            {OperatorType::kRelu1, "RELU_N1_TO_1"},
+            {OperatorType::kRelu6, "RELU6"},
+        });
+    return *step_names;
+  }
+  static string StepName(OperatorType type) {
+    for (const auto& step_name : StepNames()) {
+      if (step_name.first == type) return step_name.second;
+    }
+    LOG(FATAL) << "Unhandled FusedElementwise operator type "
+               << static_cast<int>(type);
+  }
+  static OperatorType StepType(const string& name) {
+    for (const auto& step_name : StepNames()) {
+      if (step_name.second == name) return step_name.first;
+    }
+    LOG(FATAL) << "Unhandled FusedElementwise operation " << name;
+  }
+};
+
 class FullyConnected
     : public BuiltinOperator<FullyConnectedOperator,
                              ::tflite::FullyConnectedOptions,
@@ -865,6 +929,8 @@ std::vector<std::unique_ptr<BaseOperator>> BuildOperatorList() {
   ops.emplace_back(
       new DepthToSpace("DEPTH_TO_SPACE", OperatorType::kDepthToSpace));
   ops.emplace_back(new FakeQuant("FAKE_QUANT", OperatorType::kFakeQuant));
+  ops.emplace_back(new FusedElementwise("FusedElementwise",
+                                        OperatorType::kFusedElementwise));
   ops.emplace_back(new TensorFlowUnsupported(
       "TENSORFLOW_UNSUPPORTED", OperatorType::kTensorFlowUnsupported));
 
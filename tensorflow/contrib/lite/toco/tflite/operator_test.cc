@@ -175,6 +175,25 @@ TEST_F(OperatorTest, CustomFakeQuant) {
   EXPECT_EQ(op.num_bits, output_toco_op->num_bits);
 }
 
+TEST_F(OperatorTest, CustomFusedElementwise) {
+  FusedElementwiseOperator op;
+  op.steps.resize(2);
+  op.steps[0].type = OperatorType::kMul;
+  op.steps[0].lhs = 0;
+  op.steps[0].rhs = 1;
+  op.steps[1].type = OperatorType::kRelu1;
+  op.steps[1].lhs = 2;
+  auto output_toco_op = SerializeAndDeserialize(
+      GetOperator("FusedElementwise", OperatorType::kFusedElementwise), op);
+  ASSERT_EQ(output_toco_op->steps.size(), 2);
+  EXPECT_EQ(output_toco_op->steps[0].type, OperatorType::kMul);
+  EXPECT_EQ(output_toco_op->steps[0].lhs, 0);
+  EXPECT_EQ(output_toco_op->steps[0].rhs, 1);
+  EXPECT_EQ(output_toco_op->steps[1].type, OperatorType::kRelu1);
+  EXPECT_EQ(output_toco_op->steps[1].lhs, 2);
+  EXPECT_EQ(output_toco_op->steps[1].rhs, -1);
+}
+
 TEST_F(OperatorTest, CustomFullyConnected) {
   FullyConnectedOperator op;
   op.fused_activation_function = FusedActivationFunctionType::kRelu6;
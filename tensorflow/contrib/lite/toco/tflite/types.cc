@@ -55,6 +55,8 @@ void CopyBuffer(const ::tflite::Buffer& buffer, Array* array) {
       return ::tflite::TensorType_INT64;
     case ArrayDataType::kUint8:
       return ::tflite::TensorType_UINT8;
+    case ArrayDataType::kInt8:
+      return ::tflite::TensorType_INT8;
     case ArrayDataType::kString:
       return ::tflite::TensorType_STRING;
     default:
@@ -76,6 +78,8 @@ ArrayDataType DataType::Deserialize(int tensor_type) {
       return ArrayDataType::kString;
     case ::tflite::TensorType_UINT8:
       return ArrayDataType::kUint8;
+    case ::tflite::TensorType_INT8:
+      return ArrayDataType::kInt8;
     default:
       LOG(FATAL) << "Unhandled tensor type '" << tensor_type << "'.";
   }
@@ -85,6 +89,16 @@ flatbuffers::Offset<flatbuffers::Vector<uint8_t>> DataBuffer::Serialize(
     const Array& array, flatbuffers::FlatBufferBuilder* builder) {
   if (!array.buffer) return 0;  // an empty buffer, usually an output.
 
+  if (array.sparsity_params) {
+    std::vector<int> row_segments;
+    std::vector<int> col_indices;
+    std::vector<float> values;
+    SparseBuffer::Compress(array, &row_segments, &col_indices, &values);
+    return builder->CreateVector(
+        reinterpret_cast<const uint8_t*>(values.data()),
+        values.size() * sizeof(float));
+  }
+
   switch (array.data_type) {
     case ArrayDataType::kFloat:
       return CopyBuffer<ArrayDataType::kFloat>(array, builder);
@@ -96,6 +110,8 @@ flatbuffers::Offset<flatbuffers::Vector<uint8_t>> DataBuffer::Serialize(
       return CopyBuffer<ArrayDataType::kString>(array, builder);
     case ArrayDataType::kUint8:
       return CopyBuffer<ArrayDataType::kUint8>(array, builder);
+    case ArrayDataType::kInt8:
+      return CopyBuffer<ArrayDataType::kInt8>(array, builder);
     default:
       LOG(FATAL) << "Unhandled array data type.";
   }
@@ -106,6 +122,10 @@ void DataBuffer::Deserialize(const ::tflite::Tensor& tensor,
   if (tensor.buffer() == 0) return;      // an empty buffer, usually an output.
   if (buffer.data() == nullptr) return;  // a non-defined buffer.
 
+  if (tensor.sparsity()) {
+    return SparseBuffer::Expand(tensor, buffer, array);
+  }
+
   switch (tensor.type()) {
     case ::tflite::TensorType_FLOAT32:
       return CopyBuffer<ArrayDataType::kFloat>(buffer, array);
@@ -117,11 +137,95 @@ void DataBuffer::Deserialize(const ::tflite::Tensor& tensor,
       return CopyBuffer<ArrayDataType::kString>(buffer, array);
     case ::tflite::TensorType_UINT8:
       return CopyBuffer<ArrayDataType::kUint8>(buffer, array);
+    case ::tflite::TensorType_INT8:
+      return CopyBuffer<ArrayDataType::kInt8>(buffer, array);
     default:
       LOG(FATAL) << "Unhandled tensor type.";
   }
 }
 
+void SparseBuffer::Compress(const Array& array,
+                            std::vector<int>* row_segments,
+                            std::vector<int>* col_indices,
+                            std::vector<float>* values) {
+  CHECK(array.data_type == ArrayDataType::kFloat)
+      << "Only float arrays can be sparse.";
+  const auto& dims = array.shape().dims();
+  CHECK(!dims.empty());
+  const int cols = dims.back();
+  int rows = 1;
+  for (int i = 0; i + 1 < dims.size(); ++i) rows *= dims[i];
+  const int block_rows = array.sparsity_params->block_rows;
+  const int block_cols = array.sparsity_params->block_cols;
+  CHECK_EQ(rows % block_rows, 0);
+  CHECK_EQ(cols % block_cols, 0);
+
+  const auto& data = array.GetBuffer<ArrayDataType::kFloat>().data;
+  row_segments->assign(1, 0);
+  col_indices->clear();
+  values->clear();
+  for (int r = 0; r < rows; r += block_rows) {
+    for (int c = 0; c < cols; c += block_cols) {
+      bool is_zero = true;
+      for (int i = 0; i < block_rows && is_zero; ++i) {
+        for (int j = 0; j < block_cols; ++j) {
+          if (data[(r + i) * cols + c + j] != 0.f) {
+            is_zero = false;
+            break;
+          }
+        }
+      }
+      if (is_zero) continue;
+      col_indices->push_back(c / block_cols);
+      for (int i = 0; i < block_rows; ++i) {
+        for (int j = 0; j < block_cols; ++j) {
+          values->push_back(data[(r + i) * cols + c + j]);
+        }
+      }
+    }
+    row_segments->push_back(col_indices->size());
+  }
+}
+
+void SparseBuffer::Expand(const ::tflite::Tensor& tensor,
+                          const ::tflite::Buffer& buffer, Array* array) {
+  CHECK_EQ(tensor.type(), ::tflite::TensorType_FLOAT32)
+      << "Only float tensors can be sparse.";
+  const auto* sparsity = tensor.sparsity();
+  CHECK(tensor.shape() && tensor.shape()->Length() > 0);
+  CHECK(sparsity->row_segments() && sparsity->col_indices());
+  const int cols = tensor.shape()->Get(tensor.shape()->Length() - 1);
+  int size = 1;
+  for (int d : *tensor.shape()) size *= d;
+  const int block_rows = sparsity->block_rows();
+  const int block_cols = sparsity->block_cols();
+  const int block_size = block_rows * block_cols;
+  const auto& row_segments = *sparsity->row_segments();
+  const auto& col_indices = *sparsity->col_indices();
+  CHECK_EQ(row_segments.Length(), size / cols / block_rows + 1);
+  CHECK_EQ(buffer.data()->size(),
+           col_indices.Length() * block_size * sizeof(float));
+  const float* values = reinterpret_cast<const float*>(buffer.data()->data());
+
+  std::vector<float>* data =
+      &array->GetMutableBuffer<ArrayDataType::kFloat>().data;
+  data->assign(size, 0.f);
+  for (int block_row = 0; block_row + 1 < row_segments.Length(); ++block_row) {
+    for (int b = row_segments.Get(block_row);
+         b < row_segments.Get(block_row + 1); ++b) {
+      const float* block = values + b * block_size;
+      const int r = block_row * block_rows;
+      const int c = col_indices.Get(b) * block_cols;
+      CHECK_LE(c + block_cols, cols);
+      for (int i = 0; i < block_rows; ++i) {
+        for (int j = 0; j < block_cols; ++j) {
+          (*data)[(r + i) * cols + c + j] = block[i * block_cols + j];
+        }
+      }
+    }
+  }
+}
+
 ::tflite::Padding Padding::Serialize(PaddingType padding_type) {
   switch (padding_type) {
     case PaddingType::kSame:
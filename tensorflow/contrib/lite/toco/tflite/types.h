@@ -40,6 +40,20 @@ struct DataBuffer {
                           const ::tflite::Buffer& buffer, Array* array);
 };
 
+// The blocks of a float array that has sparsity_params, in the layout of
+// ::tflite::SparsityParameters: the array is viewed as a matrix whose columns
+// are its last dimension, and only the blocks with a non-zero value are kept,
+// row of blocks by row of blocks.
+struct SparseBuffer {
+  // Returns the kept blocks of 'array' in 'values', each block row-major.
+  static void Compress(const Array& array, std::vector<int>* row_segments,
+                       std::vector<int>* col_indices,
+                       std::vector<float>* values);
+  // Fills the dense float buffer of 'array' from the blocks of 'tensor'.
+  static void Expand(const ::tflite::Tensor& tensor,
+                     const ::tflite::Buffer& buffer, Array* array);
+};
+
 struct Padding {
   static ::tflite::Padding Serialize(PaddingType padding_type);
   static PaddingType Deserialize(int padding);
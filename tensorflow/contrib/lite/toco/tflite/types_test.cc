@@ -69,6 +69,7 @@ Array ToFlatBufferAndBack(std::initializer_list<::toco::DataType<T>> items) {
 TEST(DataType, SupportedTypes) {
   std::vector<std::pair<ArrayDataType, ::tflite::TensorType>> testdata = {
       {ArrayDataType::kUint8, ::tflite::TensorType_UINT8},
+      {ArrayDataType::kInt8, ::tflite::TensorType_INT8},
       {ArrayDataType::kInt32, ::tflite::TensorType_INT32},
       {ArrayDataType::kInt64, ::tflite::TensorType_INT64},
       {ArrayDataType::kFloat, ::tflite::TensorType_FLOAT32}};
@@ -139,12 +140,59 @@ TEST(DataBuffer, Float) {
               ::testing::ElementsAre(1.0f, 2.0f));
 }
 
+TEST(DataBuffer, SparseFloat) {
+  Array src;
+  src.data_type = ArrayDataType::kFloat;
+  src.copy_shape(Shape({2, 4}));
+  src.GetMutableBuffer<ArrayDataType::kFloat>().data = {0, 0, 1, 2,  //
+                                                        0, 0, 0, 0};
+  SparsityParams& sparsity_params = src.GetOrCreateSparsityParams();
+  sparsity_params.block_rows = 1;
+  sparsity_params.block_cols = 2;
+
+  // Only the one non-zero block is stored.
+  std::vector<int> row_segments;
+  std::vector<int> col_indices;
+  std::vector<float> values;
+  SparseBuffer::Compress(src, &row_segments, &col_indices, &values);
+  EXPECT_THAT(row_segments, ::testing::ElementsAre(0, 1, 1));
+  EXPECT_THAT(col_indices, ::testing::ElementsAre(1));
+  EXPECT_THAT(values, ::testing::ElementsAre(1.0f, 2.0f));
+
+  flatbuffers::FlatBufferBuilder builder;
+  builder.Finish(::tflite::CreateTensor(
+      builder, builder.CreateVector<int>({2, 4}),
+      ::tflite::TensorType_FLOAT32, /*buffer=*/1, /*name=*/0,
+      /*quantization=*/0,
+      ::tflite::CreateSparsityParametersDirect(builder, 1, 2, &row_segments,
+                                               &col_indices)));
+  flatbuffers::FlatBufferBuilder buffer_builder;
+  buffer_builder.Finish(::tflite::CreateBuffer(
+      buffer_builder, DataBuffer::Serialize(src, &buffer_builder)));
+  auto* tensor =
+      flatbuffers::GetRoot<::tflite::Tensor>(builder.GetBufferPointer());
+  auto* buffer =
+      flatbuffers::GetRoot<::tflite::Buffer>(buffer_builder.GetBufferPointer());
+  EXPECT_EQ(buffer->data()->size(), 2 * sizeof(float));
+
+  Array recovered;
+  DataBuffer::Deserialize(*tensor, *buffer, &recovered);
+  EXPECT_THAT(recovered.GetBuffer<ArrayDataType::kFloat>().data,
+              ::testing::ElementsAre(0, 0, 1, 2, 0, 0, 0, 0));
+}
+
 TEST(DataBuffer, Uint8) {
   Array recovered = ToFlatBufferAndBack<ArrayDataType::kUint8>({127, 244});
   EXPECT_THAT(recovered.GetBuffer<ArrayDataType::kUint8>().data,
               ::testing::ElementsAre(127, 244));
 }
 
+TEST(DataBuffer, Int8) {
+  Array recovered = ToFlatBufferAndBack<ArrayDataType::kInt8>({-127, 100});
+  EXPECT_THAT(recovered.GetBuffer<ArrayDataType::kInt8>().data,
+              ::testing::ElementsAre(-127, 100));
+}
+
 TEST(DataBuffer, Int32) {
   Array recovered = ToFlatBufferAndBack<ArrayDataType::kInt32>({1, 1 << 30});
   EXPECT_THAT(recovered.GetBuffer<ArrayDataType::kInt32>().data,
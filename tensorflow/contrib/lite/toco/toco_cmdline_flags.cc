@@ -148,6 +148,26 @@ bool ParseTocoFlagsFromCommandLineFlags(
            "Some fast uint8 GEMM kernels require uint8 weights to avoid the "
            "value 0. This flag allows nudging them to 1 to allow proceeding, "
            "with moderate inaccuracy."),
+      Flag("quantize_weights", parsed_flags.quantize_weights.bind(),
+           parsed_flags.quantize_weights.default_value(),
+           "If true and the inference type is float, store the large "
+           "FullyConnected weights as int8, to be run by the hybrid TF Lite "
+           "kernels."),
+      Flag("per_channel_weights", parsed_flags.per_channel_weights.bind(),
+           parsed_flags.per_channel_weights.default_value(),
+           "If true and the inference type is quantized, quantize the weights "
+           "of Conv, DepthwiseConv and FullyConnected ops to int8 with one "
+           "scale per output channel."),
+      Flag("sparse_weights_threshold",
+           parsed_flags.sparse_weights_threshold.bind(),
+           parsed_flags.sparse_weights_threshold.default_value(),
+           "If set and the inference type is float, store the weights of "
+           "FullyConnected and 1x1 Conv ops as sparse blocks when at least "
+           "this fraction of their blocks are all zero."),
+      Flag("fuse_elementwise_ops", parsed_flags.fuse_elementwise_ops.bind(),
+           parsed_flags.fuse_elementwise_ops.default_value(),
+           "If true and the inference type is float, fuse chains of "
+           "elementwise ops into single FusedElementwise ops."),
   };
   bool asked_for_help =
       *argc == 2 && (!strcmp(argv[1], "--help") || !strcmp(argv[1], "-help"));
@@ -239,6 +259,10 @@ void ReadTocoFlagsFromCommandLineFlags(const ParsedTocoFlags& parsed_toco_flags,
   READ_TOCO_FLAG(propagate_fake_quant_num_bits, FlagRequirement::kNone);
   READ_TOCO_FLAG(allow_nudging_weights_to_use_fast_gemm_kernel,
                  FlagRequirement::kNone);
+  READ_TOCO_FLAG(quantize_weights, FlagRequirement::kNone);
+  READ_TOCO_FLAG(per_channel_weights, FlagRequirement::kNone);
+  READ_TOCO_FLAG(sparse_weights_threshold, FlagRequirement::kNone);
+  READ_TOCO_FLAG(fuse_elementwise_ops, FlagRequirement::kNone);
 
   // Deprecated flag handling.
   if (parsed_toco_flags.input_type.specified()) {
@@ -321,11 +321,13 @@ void Transform(const TocoFlags& toco_flags, Model* model) {
         new EnsureUint8WeightsSafeForFastInt8Kernels;
     ensure_safe_for_int8_kernels->set_allow_nudging_weights(
         toco_flags.allow_nudging_weights_to_use_fast_gemm_kernel());
+    auto* quantize = new Quantize;
+    quantize->set_per_channel_weights(toco_flags.per_channel_weights());
     RunGraphTransformations(model, "quantization graph transformations",
                             {
                                 new RemoveTrivialQuantizedActivationFunc,
                                 new RemoveTrivialQuantizedMinMax,
-                                new Quantize,
+                                quantize,
                                 new RemoveFinalDequantizeOp,
                                 ensure_safe_for_int8_kernels,
                             });
@@ -339,6 +341,24 @@ void Transform(const TocoFlags& toco_flags, Model* model) {
 
     RunGraphTransformations(model, "dequantization graph transformations",
                             dequantization_transformations);
+
+    if (toco_flags.quantize_weights() && output_format == TFLITE) {
+      RunGraphTransformations(model,
+                              "weights quantization graph transformations",
+                              {new QuantizeWeights});
+    }
+    if (toco_flags.has_sparse_weights_threshold() && output_format == TFLITE) {
+      auto* sparsify_weights = new SparsifyWeights;
+      sparsify_weights->set_threshold(toco_flags.sparse_weights_threshold());
+      RunGraphTransformations(model,
+                              "weights sparsification graph transformations",
+                              {sparsify_weights});
+    }
+    if (toco_flags.fuse_elementwise_ops() && output_format == TFLITE) {
+      RunGraphTransformations(model,
+                              "elementwise fusion graph transformations",
+                              {new FuseElementwiseOperators});
+    }
   }
 
   if (output_format == TENSORFLOW_GRAPHDEF) {
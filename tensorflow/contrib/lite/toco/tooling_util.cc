@@ -368,6 +368,7 @@ const char* OperatorTypeName(OperatorType type) {
     HANDLE_OPERATORTYPENAME_CASE(Exp)
     HANDLE_OPERATORTYPENAME_CASE(DynamicPartition)
     HANDLE_OPERATORTYPENAME_CASE(DynamicStitch)
+    HANDLE_OPERATORTYPENAME_CASE(FusedElementwise)
     default:
       LOG(FATAL) << "Unhandled op type";
 #undef HANDLE_OPERATORTYPENAME_CASE
@@ -451,6 +452,18 @@ void LogArray(int log_level, const Model& model, const string& name) {
                     << static_cast<int>(array.quantization_params->zero_point)
                     << ", scale=" << array.quantization_params->scale;
   }
+  if (array.per_channel_quantization_params) {
+    VLOG(log_level) << "  PerChannelQuantizationParams: "
+                    << array.per_channel_quantization_params->scales.size()
+                    << " scales along dimension "
+                    << array.per_channel_quantization_params
+                           ->quantized_dimension;
+  }
+  if (array.sparsity_params) {
+    VLOG(log_level) << "  SparsityParams: blocks of "
+                    << array.sparsity_params->block_rows << "x"
+                    << array.sparsity_params->block_cols;
+  }
 }
 
 void DumpGraphvizVideoFrame(const Model& model) {
@@ -1090,6 +1103,13 @@ void CopyArrayAttribs(const Array& source_array, Array* target_array) {
   } else {
     target_array->quantization_params.reset();
   }
+
+  if (source_array.per_channel_quantization_params) {
+    target_array->GetOrCreatePerChannelQuantizationParams() =
+        *source_array.per_channel_quantization_params;
+  } else {
+    target_array->per_channel_quantization_params.reset();
+  }
 }
 }  // namespace
 
@@ -1668,6 +1688,25 @@ bool EstimateArithmeticOpsCount(const Model& model, int64* result) {
         total += 64 * RequiredBufferSizeForShape(output_array.shape());
         break;
       }
+      case OperatorType::kFusedElementwise: {
+        const auto& output_array = model.GetArray(op->outputs[0]);
+        if (!output_array.has_shape()) {
+          return false;
+        }
+        // The same ballpark as the unfused operators, which the
+        // FusedElementwise kernel also uses to split its work across threads.
+        int64 cost_per_element = 0;
+        for (const auto& step :
+             static_cast<const FusedElementwiseOperator&>(*op).steps) {
+          const bool is_math_function = step.type == OperatorType::kExp ||
+                                        step.type == OperatorType::kLogistic ||
+                                        step.type == OperatorType::kTanh;
+          cost_per_element += is_math_function ? 64 : 1;
+        }
+        total += cost_per_element *
+                 RequiredBufferSizeForShape(output_array.shape());
+        break;
+      }
       case OperatorType::kMaxPool: {
         const auto& maxpool = *static_cast<const MaxPoolOperator*>(op.get());
         const auto& output_array = model.GetArray(op->outputs[0]);
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <cstdarg>
 #include <cstdlib>
 #include <iostream>
@@ -23,6 +24,8 @@ limitations under the License.
 
 #include "tensorflow/contrib/lite/kernels/register.h"
 #include "tensorflow/contrib/lite/model.h"
+#include "tensorflow/contrib/lite/profiling/profile_summarizer.h"
+#include "tensorflow/contrib/lite/profiling/profiler.h"
 #include "tensorflow/contrib/lite/string_util.h"
 #include "tensorflow/contrib/lite/tools/mutable_op_resolver.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -342,6 +345,39 @@ bool TimeMultipleRuns(Interpreter* interpreter, double sleep_seconds,
   return true;
 }
 
+// Runs the model 'num_runs' times with a profiler attached, and adds the
+// timings of the nodes to 'summarizer'.
+bool ProfileMultipleRuns(Interpreter* interpreter, int num_runs,
+                         profiling::ProfileSummarizer* summarizer) {
+  std::cout << "Profiling " << num_runs << " iterations." << std::endl;
+
+  // The profile buffer must hold at least one event, even for a model
+  // without nodes.
+  profiling::Profiler profiler(
+      std::max<size_t>(1, interpreter->nodes_size()));
+  interpreter->SetProfiler(&profiler);
+  bool run_status = true;
+  for (int i = 0; i < num_runs && run_status; ++i) {
+    profiler.Reset();
+    profiler.StartProfiling();
+    run_status = interpreter->Invoke() == kTfLiteOk;
+    profiler.StopProfiling();
+    if (!run_status) {
+      std::cout << "Failed on run " << i << std::endl;
+    } else {
+      summarizer->ProcessProfiles(profiler.GetProfileEvents(), *interpreter);
+    }
+  }
+  interpreter->SetProfiler(nullptr);
+
+  if (run_status && summarizer->num_runs() == 0) {
+    std::cout << "No op profiles were collected. Build with "
+              << "--copt=-DTFLITE_PROFILING_ENABLED to profile the ops."
+              << std::endl;
+  }
+  return run_status;
+}
+
 int Main(int argc, char** argv) {
   using tensorflow::Flag;
   using tensorflow::Flags;
@@ -359,6 +395,8 @@ int Main(int argc, char** argv) {
   string output_prefix = "";
   int warmup_runs = 1;
   bool use_nnapi = false;
+  bool enable_op_profiling = false;
+  string profiling_output_csv_file = "";
 
   std::vector<Flag> flag_list = {
       Flag("graph", &graph, "graph file name"),
@@ -377,6 +415,10 @@ int Main(int argc, char** argv) {
       Flag("output_prefix", &output_prefix, "benchmark output prefix"),
       Flag("warmup_runs", &warmup_runs, "how many runs to initialize model"),
       Flag("use_nnapi", &use_nnapi, "use nnapi api"),
+      Flag("enable_op_profiling", &enable_op_profiling,
+           "report the timings of each op over num_runs more runs"),
+      Flag("profiling_output_csv_file", &profiling_output_csv_file,
+           "file to write the op timings and memory usage to, as CSV"),
   };
   string usage = Flags::Usage(argv[0], flag_list);
   const bool parse_result = Flags::Parse(&argc, argv, flag_list);
@@ -407,6 +449,12 @@ int Main(int argc, char** argv) {
   }
   std::cout << "Warmup runs: [" << warmup_runs << "]" << std::endl;
   std::cout << "Use nnapi : [" << use_nnapi << "]" << std::endl;
+  std::cout << "Enable op profiling: [" << enable_op_profiling << "]"
+            << std::endl;
+  if (!profiling_output_csv_file.empty()) {
+    std::cout << "CSV output file: [" << profiling_output_csv_file << "]"
+              << std::endl;
+  }
 
   if (graph.empty()) {
     std::cout
@@ -467,6 +515,27 @@ int Main(int argc, char** argv) {
             << (warmup_runs > 0 ? warmup_time_us / warmup_runs : 0) << ", "
             << std::endl;
 
+  // Profile the ops separately, since collecting their timings adds to the
+  // overall inference time.
+  profiling::ProfileSummarizer summarizer;
+  if (enable_op_profiling &&
+      !ProfileMultipleRuns(interpreter.get(), num_runs, &summarizer)) {
+    std::cerr << "Profiling failed." << std::endl;
+    return -1;
+  }
+  summarizer.SetMemoryUsage(profiling::GetMemoryUsage(*interpreter));
+  std::cout << summarizer.GetOutputString();
+
+  if (!profiling_output_csv_file.empty()) {
+    const tensorflow::Status status = tensorflow::WriteStringToFile(
+        Env::Default(), profiling_output_csv_file, summarizer.GetCsvString());
+    if (!status.ok()) {
+      std::cerr << "Failed to write " << profiling_output_csv_file << ": "
+                << status << std::endl;
+      return -1;
+    }
+  }
+
   return 0;
 }
 
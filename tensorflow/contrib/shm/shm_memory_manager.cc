@@ -0,0 +1,188 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_memory_manager.h"
+
+#include <cstring>
+
+#include "tensorflow/contrib/shm/shm.pb.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+// Tensor buffer aliasing a block of a sender's ring.  Destroying it hands
+// the block back to the sender.
+class ShmTensorBuffer : public TensorBuffer {
+ public:
+  static Tensor MakeTensor(DataType dtype, const TensorShape& shape,
+                           SharedMemorySegment* segment, uint64 offset) {
+    auto* buffer = new ShmTensorBuffer(
+        segment, offset, shape.num_elements() * DataTypeSize(dtype));
+    Tensor t(dtype, shape, buffer);
+    buffer->Unref();
+    return t;
+  }
+
+  void* data() const override { return segment_->base() + offset_; }
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("shm");
+  }
+
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  ShmTensorBuffer(SharedMemorySegment* segment, uint64 offset, size_t size)
+      : segment_(segment), offset_(offset), size_(size) {
+    segment_->Ref();
+  }
+
+  ~ShmTensorBuffer() override {
+    ShmRing::Release(segment_->base(), offset_);
+    segment_->Unref();
+  }
+
+  SharedMemorySegment* const segment_;
+  const uint64 offset_;
+  const size_t size_;
+};
+
+SharedMemoryManager::SharedMemoryManager(size_t ring_bytes,
+                                         size_t min_tensor_bytes,
+                                         int64 lease_micros)
+    : ring_bytes_(ring_bytes),
+      min_tensor_bytes_(min_tensor_bytes),
+      lease_micros_(lease_micros) {}
+
+SharedMemoryManager::~SharedMemoryManager() {
+  ring_.reset();
+  if (probe_ != nullptr) probe_->Unref();
+  for (auto& it : peer_segments_) {
+    it.second->Unref();
+  }
+}
+
+Status SharedMemoryManager::Init() {
+  SharedMemorySegment* segment;
+  TF_RETURN_IF_ERROR(
+      SharedMemorySegment::Create("tf_shm_ring", ring_bytes_, &segment));
+  ring_.reset(new ShmRing(segment, lease_micros_));
+  segment->Unref();
+  return SharedMemorySegment::Create("tf_shm_probe", 1, &probe_);
+}
+
+void SharedMemoryManager::RequestOptions(
+    ::google::protobuf::Any* mutable_transport_options) {
+  SharedMemoryRequest request;
+  request.set_probe_segment(probe_->name());
+  mutable_transport_options->PackFrom(request);
+}
+
+bool SharedMemoryManager::SharesNamespaceWith(const string& probe_segment) {
+  {
+    mutex_lock l(mu_);
+    auto it = shares_namespace_.find(probe_segment);
+    if (it != shares_namespace_.end()) return it->second;
+  }
+  const bool shares = SharedMemorySegment::CanOpen(probe_segment);
+  VLOG(1) << "Shared memory " << (shares ? "is" : "is not")
+          << " available to the owner of " << probe_segment;
+  mutex_lock l(mu_);
+  shares_namespace_[probe_segment] = shares;
+  return shares;
+}
+
+bool SharedMemoryManager::TransportOptionsFromTensor(
+    const ::google::protobuf::Any& request_options, const Tensor& tensor,
+    ::google::protobuf::Any* mutable_transport_options) {
+  SharedMemoryRequest request;
+  if (!request_options.UnpackTo(&request) ||
+      tensor.TotalBytes() < min_tensor_bytes_ ||
+      !DMAHelper::CanUseDMA(&tensor) ||
+      !SharesNamespaceWith(request.probe_segment())) {
+    return false;
+  }
+  uint64 lease;
+  const int64 offset = ring_->Allocate(tensor.TotalBytes(), &lease);
+  if (offset < 0) {
+    VLOG(1) << "Shared memory ring is full, sending " << tensor.TotalBytes()
+            << " bytes in the response";
+    return false;
+  }
+  memcpy(ring_->segment()->base() + offset, DMAHelper::base(&tensor),
+         tensor.TotalBytes());
+
+  SharedMemoryRegion region;
+  region.set_segment(ring_->segment()->name());
+  region.set_offset(offset);
+  region.set_lease(lease);
+  region.set_dtype(tensor.dtype());
+  tensor.shape().AsProto(region.mutable_tensor_shape());
+  mutable_transport_options->PackFrom(region);
+  return true;
+}
+
+Status SharedMemoryManager::GetPeerSegment(const string& name,
+                                           SharedMemorySegment** segment) {
+  mutex_lock l(mu_);
+  auto it = peer_segments_.find(name);
+  if (it == peer_segments_.end()) {
+    SharedMemorySegment* mapped;
+    TF_RETURN_IF_ERROR(SharedMemorySegment::Open(name, &mapped));
+    it = peer_segments_.emplace(name, mapped).first;
+  }
+  *segment = it->second;
+  (*segment)->Ref();
+  return Status::OK();
+}
+
+Status SharedMemoryManager::TensorFromTransportOptions(
+    const ::google::protobuf::Any& transport_options, Tensor* tensor) {
+  SharedMemoryRegion region;
+  if (!transport_options.UnpackTo(&region)) {
+    return errors::Internal("Cannot parse shared memory region from ",
+                            transport_options.type_url());
+  }
+  TF_RETURN_IF_ERROR(TensorShape::IsValidShape(region.tensor_shape()));
+  const TensorShape shape(region.tensor_shape());
+  SharedMemorySegment* segment;
+  TF_RETURN_IF_ERROR(GetPeerSegment(region.segment(), &segment));
+  const uint64 num_bytes = shape.num_elements() * DataTypeSize(region.dtype());
+  Status s;
+  if (region.offset() < ShmRing::kAlignment ||
+      region.offset() % ShmRing::kAlignment != 0 ||
+      region.offset() + num_bytes > segment->size()) {
+    s = errors::Internal("Shared memory region at ", region.offset(), " of ",
+                         num_bytes, " bytes is outside of ", region.segment());
+  } else if (!ShmRing::Claim(segment->base(), region.offset(),
+                             region.lease())) {
+    s = errors::Aborted("Shared memory region at ", region.offset(), " of ",
+                        region.segment(), " was reclaimed by the sender");
+  } else {
+    *tensor = ShmTensorBuffer::MakeTensor(region.dtype(), shape, segment,
+                                          region.offset());
+  }
+  segment->Unref();
+  return s;
+}
+
+}  // namespace tensorflow
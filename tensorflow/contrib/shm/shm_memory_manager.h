@@ -0,0 +1,98 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHM_MEMORY_MANAGER_H_
+#define SHM_MEMORY_MANAGER_H_
+
+#include <memory>
+#include <unordered_map>
+
+#include "google/protobuf/any.pb.h"
+#include "tensorflow/contrib/shm/shm_ring.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+// Moves tensors between worker processes that share a POSIX shared memory
+// namespace, typically because they run on the same host.
+//
+// The receiver names a probe segment of its own in the RecvTensorRequest.
+// A sender that can open it copies the tensor content into its ring and
+// only returns the location in the RecvTensorResponse.  The receiver maps
+// the sender's segment once and builds the tensor on top of the block
+// without copying it; the block goes back to the sender when the tensor is
+// destroyed.  If the receiver does not get to the block within a lease,
+// e.g. because the RPC failed, the sender takes it back.
+//
+// The transport options are encoded into the protocol buffers of shm.proto.
+// See RecvTensorRequest in tensorflow/core/protobuf/worker.proto
+class SharedMemoryManager {
+ public:
+  // Tensors of fewer than min_tensor_bytes are left to the RPC, which is
+  // cheaper for them than a trip through shared memory.  Receivers must map
+  // a tensor within lease_micros of it being sent.
+  SharedMemoryManager(size_t ring_bytes, size_t min_tensor_bytes,
+                      int64 lease_micros);
+  ~SharedMemoryManager();
+
+  // Creates the ring and probe segments.
+  Status Init();
+
+  // Receiver side: describes this process in the transport options of a
+  // RecvTensorRequest.
+  void RequestOptions(::google::protobuf::Any* mutable_transport_options);
+
+  // Sender side: copies the content of tensor into the ring and encodes its
+  // location in mutable_transport_options, if the receiver that sent
+  // request_options can read it.  Returns false if the tensor must be sent
+  // in the response instead.
+  bool TransportOptionsFromTensor(
+      const ::google::protobuf::Any& request_options, const Tensor& tensor,
+      ::google::protobuf::Any* mutable_transport_options);
+
+  // Receiver side: sets *tensor to the tensor encoded in transport_options,
+  // in the sender's shared memory.  Fails if the sender took the block back
+  // because its lease ended.
+  Status TensorFromTransportOptions(
+      const ::google::protobuf::Any& transport_options, Tensor* tensor);
+
+ private:
+  // Returns true if this process can open the probe segment of a receiver.
+  bool SharesNamespaceWith(const string& probe_segment);
+
+  // Returns a reference on the mapping of a sender's segment.
+  Status GetPeerSegment(const string& name, SharedMemorySegment** segment);
+
+  const size_t ring_bytes_;
+  const size_t min_tensor_bytes_;
+  const int64 lease_micros_;
+
+  SharedMemorySegment* probe_ = nullptr;
+  std::unique_ptr<ShmRing> ring_;
+
+  mutex mu_;
+  // Results of SharesNamespaceWith(), by probe segment.
+  std::unordered_map<string, bool> shares_namespace_ GUARDED_BY(mu_);
+  // Mappings of the segments of senders, by name.
+  std::unordered_map<string, SharedMemorySegment*> peer_segments_
+      GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedMemoryManager);
+};
+
+}  // namespace tensorflow
+
+#endif  // SHM_MEMORY_MANAGER_H_
@@ -0,0 +1,158 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_memory_manager.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Tensors of 512 floats take 2048 bytes, so the ring holds one at a time.
+constexpr size_t kRingBytes = 4096;
+constexpr size_t kMinTensorBytes = 16;
+constexpr int64 kLeaseMicros = 60 * 1000 * 1000;
+
+class SharedMemoryManagerTest : public ::testing::Test {
+ protected:
+  SharedMemoryManagerTest()
+      : sender_(kRingBytes, kMinTensorBytes, kLeaseMicros),
+        receiver_(kRingBytes, kMinTensorBytes, kLeaseMicros) {}
+
+  void SetUp() override {
+    TF_ASSERT_OK(sender_.Init());
+    TF_ASSERT_OK(receiver_.Init());
+    receiver_.RequestOptions(&request_options_);
+  }
+
+  // Sends tensor from sender_ to receiver_ through shared memory. Returns
+  // false if the sender falls back to the response.
+  bool Transfer(const Tensor& tensor, Tensor* received) {
+    ::google::protobuf::Any transport_options;
+    if (!sender_.TransportOptionsFromTensor(request_options_, tensor,
+                                            &transport_options)) {
+      return false;
+    }
+    TF_CHECK_OK(
+        receiver_.TensorFromTransportOptions(transport_options, received));
+    return true;
+  }
+
+  SharedMemoryManager sender_;
+  SharedMemoryManager receiver_;
+  ::google::protobuf::Any request_options_;
+};
+
+TEST_F(SharedMemoryManagerTest, RoundTrip) {
+  Tensor tensor(DT_FLOAT, TensorShape({2, 256}));
+  test::FillIota<float>(&tensor, 0.5f);
+  Tensor received;
+  ASSERT_TRUE(Transfer(tensor, &received));
+  test::ExpectTensorEqual<float>(tensor, received);
+
+  // Once the first tensor is released, the ring takes the next one.
+  Tensor other(DT_INT32, TensorShape({16}));
+  test::FillIota<int32>(&other, 3);
+  received = Tensor();
+  Tensor received_other;
+  ASSERT_TRUE(Transfer(other, &received_other));
+  test::ExpectTensorEqual<int32>(other, received_other);
+}
+
+TEST_F(SharedMemoryManagerTest, ReleasesBlockWithTensor) {
+  Tensor tensor(DT_FLOAT, TensorShape({512}));
+  test::FillFn<float>(&tensor, [](int i) { return i; });
+  Tensor received;
+  ASSERT_TRUE(Transfer(tensor, &received));
+
+  // The ring is full as long as the received tensor holds its block.
+  Tensor copy = received;
+  received = Tensor();
+  Tensor second;
+  EXPECT_FALSE(Transfer(tensor, &second));
+
+  // Destroying the last reference hands the block back to the sender.
+  copy = Tensor();
+  ASSERT_TRUE(Transfer(tensor, &second));
+  test::ExpectTensorEqual<float>(tensor, second);
+}
+
+TEST_F(SharedMemoryManagerTest, ReclaimsBlockOfDroppedResponse) {
+  // With no lease, a block is taken back as soon as the ring needs room.
+  SharedMemoryManager sender(kRingBytes, kMinTensorBytes, 0);
+  TF_ASSERT_OK(sender.Init());
+  Tensor tensor(DT_FLOAT, TensorShape({512}));
+  test::FillIota<float>(&tensor, 1);
+
+  // The response naming the first block never reaches the receiver.
+  ::google::protobuf::Any dropped;
+  ASSERT_TRUE(
+      sender.TransportOptionsFromTensor(request_options_, tensor, &dropped));
+
+  // The ring still takes the next tensor.
+  ::google::protobuf::Any delivered;
+  ASSERT_TRUE(
+      sender.TransportOptionsFromTensor(request_options_, tensor, &delivered));
+  Tensor received;
+  TF_ASSERT_OK(receiver_.TensorFromTransportOptions(delivered, &received));
+  test::ExpectTensorEqual<float>(tensor, received);
+
+  // A late response can't read the block, which holds another tensor now.
+  Tensor late;
+  EXPECT_EQ(error::ABORTED,
+            receiver_.TensorFromTransportOptions(dropped, &late).code());
+}
+
+TEST_F(SharedMemoryManagerTest, FallsBackToResponse) {
+  Tensor received;
+  // Too small to be worth it.
+  Tensor small(DT_FLOAT, TensorShape({2}));
+  test::FillIota<float>(&small, 0);
+  EXPECT_FALSE(Transfer(small, &received));
+
+  // Larger than the ring.
+  Tensor large(DT_FLOAT, TensorShape({2048}));
+  test::FillIota<float>(&large, 0);
+  EXPECT_FALSE(Transfer(large, &received));
+
+  // Strings can't be copied as bytes.
+  Tensor strings(DT_STRING, TensorShape({64}));
+  for (int i = 0; i < 64; ++i) {
+    strings.vec<string>()(i) = "a string that is long enough to count";
+  }
+  EXPECT_FALSE(Transfer(strings, &received));
+
+  // The receiver did not ask for shared memory.
+  Tensor tensor(DT_FLOAT, TensorShape({64}));
+  test::FillIota<float>(&tensor, 0);
+  ::google::protobuf::Any transport_options;
+  EXPECT_FALSE(sender_.TransportOptionsFromTensor(
+      ::google::protobuf::Any(), tensor, &transport_options));
+
+  // The receiver's probe segment is gone, as for a process on another host.
+  ::google::protobuf::Any other_host;
+  {
+    SharedMemoryManager other(kRingBytes, kMinTensorBytes, kLeaseMicros);
+    TF_ASSERT_OK(other.Init());
+    other.RequestOptions(&other_host);
+  }
+  EXPECT_FALSE(sender_.TransportOptionsFromTensor(other_host, tensor,
+                                                  &transport_options));
+}
+
+}  // namespace
+}  // namespace tensorflow
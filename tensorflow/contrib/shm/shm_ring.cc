@@ -0,0 +1,241 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_ring.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// A block goes from leased to claimed to free, or from leased to free if
+// the writer takes it back.
+enum BlockState : uint64 {
+  kBlockFree = 0,
+  kBlockLeased = 1,
+  kBlockClaimed = 2,
+};
+constexpr int kBlockStateBits = 2;
+constexpr uint64 kBlockStateMask = (1 << kBlockStateBits) - 1;
+
+// The state word of a block holds its BlockState in the low bits and its
+// lease above them, so that a late reader can't claim the next block
+// written at the same offset.
+uint64 StateWord(uint64 lease, BlockState state) {
+  return (lease << kBlockStateBits) | state;
+}
+
+// Header at the start of every block.  It is padded to kAlignment bytes so
+// that the data after it stays aligned.
+struct BlockHeader {
+  std::atomic<uint64> state;
+  uint64 size;  // Bytes in the block, header included.
+  // Only read by the writer, whose clock it is on.
+  uint64 lease_end_micros;
+};
+static_assert(sizeof(BlockHeader) <= ShmRing::kAlignment,
+              "BlockHeader must fit in the block alignment");
+
+BlockHeader* HeaderAt(char* base, size_t offset) {
+  return reinterpret_cast<BlockHeader*>(base + offset);
+}
+
+size_t RoundUp(size_t n) {
+  return (n + ShmRing::kAlignment - 1) & ~(ShmRing::kAlignment - 1);
+}
+
+Status Map(const string& name, int fd, size_t num_bytes, char** base) {
+  void* addr =
+      mmap(nullptr, num_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    return errors::Internal("Cannot map shared memory segment ", name, ": ",
+                            strerror(errno));
+  }
+  *base = static_cast<char*>(addr);
+  return Status::OK();
+}
+
+}  // namespace
+
+constexpr size_t ShmRing::kAlignment;
+
+/* static */
+Status SharedMemorySegment::Create(const string& prefix, size_t num_bytes,
+                                   SharedMemorySegment** segment) {
+  const string name =
+      strings::StrCat("/", prefix, "_", getpid(), "_", random::New64());
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return errors::Internal("Cannot create shared memory segment ", name,
+                            ": ", strerror(errno));
+  }
+  Status s;
+  if (ftruncate(fd, num_bytes) != 0) {
+    s = errors::ResourceExhausted("Cannot size shared memory segment ", name,
+                                  " to ", num_bytes, " bytes: ",
+                                  strerror(errno));
+  }
+  char* base = nullptr;
+  if (s.ok()) s = Map(name, fd, num_bytes, &base);
+  close(fd);
+  if (!s.ok()) {
+    shm_unlink(name.c_str());
+    return s;
+  }
+  *segment = new SharedMemorySegment(name, base, num_bytes, true);
+  return Status::OK();
+}
+
+/* static */
+Status SharedMemorySegment::Open(const string& name,
+                                 SharedMemorySegment** segment) {
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    return errors::NotFound("Cannot open shared memory segment ", name, ": ",
+                            strerror(errno));
+  }
+  struct stat st;
+  Status s;
+  if (fstat(fd, &st) != 0) {
+    s = errors::Internal("Cannot stat shared memory segment ", name, ": ",
+                         strerror(errno));
+  }
+  char* base = nullptr;
+  if (s.ok()) s = Map(name, fd, st.st_size, &base);
+  close(fd);
+  TF_RETURN_IF_ERROR(s);
+  *segment = new SharedMemorySegment(name, base, st.st_size, false);
+  return Status::OK();
+}
+
+/* static */
+bool SharedMemorySegment::CanOpen(const string& name) {
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) return false;
+  close(fd);
+  return true;
+}
+
+SharedMemorySegment::~SharedMemorySegment() {
+  munmap(base_, size_);
+  if (owned_) shm_unlink(name_.c_str());
+}
+
+ShmRing::ShmRing(SharedMemorySegment* segment, int64 lease_micros)
+    : segment_(segment),
+      capacity_(segment->size() & ~(kAlignment - 1)),
+      lease_micros_(lease_micros) {
+  segment_->Ref();
+}
+
+ShmRing::~ShmRing() { segment_->Unref(); }
+
+int64 ShmRing::Allocate(size_t num_bytes, uint64* lease) {
+  const size_t block_bytes = kAlignment + RoundUp(num_bytes);
+  if (block_bytes > capacity_) return -1;
+  mutex_lock l(mu_);
+  Reclaim();
+  if (used_ == 0) {
+    // Start over at the beginning to get the largest contiguous space.
+    head_ = tail_ = 0;
+  }
+  if (tail_ >= head_ && used_ < capacity_) {
+    // The free space is [tail_, capacity_) followed by [0, head_).
+    if (capacity_ - tail_ < block_bytes) {
+      if (head_ < block_bytes) return -1;
+      // Skip the end of the segment with a block that is already free.
+      Append(capacity_ - tail_, 0);
+    }
+  } else if (head_ - tail_ < block_bytes) {
+    // The free space is [tail_, head_), or nothing if the ring is full.
+    return -1;
+  }
+  const size_t offset = tail_;
+  *lease = next_lease_++;
+  Append(block_bytes, *lease);
+  return offset + kAlignment;
+}
+
+void ShmRing::Append(size_t block_bytes, uint64 lease) {
+  BlockHeader* header = HeaderAt(segment_->base(), tail_);
+  header->size = block_bytes;
+  if (lease != 0) {
+    header->lease_end_micros = Env::Default()->NowMicros() + lease_micros_;
+  }
+  header->state.store(lease != 0 ? StateWord(lease, kBlockLeased) : kBlockFree,
+                      std::memory_order_release);
+  used_ += block_bytes;
+  tail_ += block_bytes;
+  if (tail_ == capacity_) tail_ = 0;
+}
+
+void ShmRing::Reclaim() {
+  uint64 now_micros = 0;
+  while (used_ > 0) {
+    BlockHeader* header = HeaderAt(segment_->base(), head_);
+    uint64 state = header->state.load(std::memory_order_acquire);
+    if ((state & kBlockStateMask) == kBlockLeased) {
+      if (now_micros == 0) now_micros = Env::Default()->NowMicros();
+      // Take the block back unless the reader claims it first.
+      if (now_micros >= header->lease_end_micros &&
+          header->state.compare_exchange_strong(state, kBlockFree,
+                                                std::memory_order_acq_rel)) {
+        VLOG(1) << "Reclaiming a shared memory block of " << header->size
+                << " bytes that was never claimed";
+        state = kBlockFree;
+      }
+    }
+    if (state != kBlockFree) break;
+    used_ -= header->size;
+    head_ += header->size;
+    if (head_ == capacity_) head_ = 0;
+  }
+}
+
+/* static */
+bool ShmRing::Claim(char* base, uint64 offset, uint64 lease) {
+  uint64 state = StateWord(lease, kBlockLeased);
+  return HeaderAt(base, offset - kAlignment)
+      ->state.compare_exchange_strong(state, StateWord(lease, kBlockClaimed),
+                                      std::memory_order_acq_rel);
+}
+
+/* static */
+void ShmRing::Release(char* base, uint64 offset) {
+  HeaderAt(base, offset - kAlignment)
+      ->state.store(kBlockFree, std::memory_order_release);
+}
+
+size_t ShmRing::BytesInUse() {
+  mutex_lock l(mu_);
+  Reclaim();
+  return used_;
+}
+
+}  // namespace tensorflow
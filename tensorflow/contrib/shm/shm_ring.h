@@ -0,0 +1,133 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHM_RING_H_
+#define SHM_RING_H_
+
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A POSIX shared memory segment mapped read-write into this process.
+//
+// The process that creates a segment unlinks its name when the last
+// reference goes away; mappings held by other processes stay valid.
+class SharedMemorySegment : public core::RefCounted {
+ public:
+  // Creates a new segment of num_bytes, named after prefix and made unique
+  // with the process id and a random number.
+  static Status Create(const string& prefix, size_t num_bytes,
+                       SharedMemorySegment** segment);
+
+  // Maps the existing segment called name.
+  static Status Open(const string& name, SharedMemorySegment** segment);
+
+  // Returns true if this process can open the segment called name, i.e. it
+  // shares the shared memory namespace of the process that created it.
+  static bool CanOpen(const string& name);
+
+  const string& name() const { return name_; }
+  char* base() const { return base_; }
+  size_t size() const { return size_; }
+
+ private:
+  SharedMemorySegment(const string& name, char* base, size_t size, bool owned)
+      : name_(name), base_(base), size_(size), owned_(owned) {}
+  ~SharedMemorySegment() override;
+
+  const string name_;
+  char* const base_;
+  const size_t size_;
+  const bool owned_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedMemorySegment);
+};
+
+// ShmRing hands out the bytes of a segment, in order, to tensors that
+// another process will read in place.
+//
+// Each block starts with a header that holds its size and its state.  A new
+// block is leased to the reader, which must Claim() it before the lease
+// ends and clears it, with Release(), once it no longer needs the block.
+// The writer reclaims released blocks, and unclaimed blocks whose lease has
+// ended, from the oldest one on.  So a reader that never gets to a block,
+// e.g. because the response naming it was lost, only holds the ring up for
+// the lease, but a claimed block that is held for long keeps the ring from
+// reusing the blocks written after it; Allocate() then fails and the caller
+// must send the tensor another way.
+class ShmRing {
+ public:
+  // The data of every block is aligned to kAlignment bytes.
+  static constexpr size_t kAlignment = 64;
+
+  // Takes a reference on segment, whose whole size is used for the ring.
+  // Blocks must be claimed within lease_micros of their allocation.
+  ShmRing(SharedMemorySegment* segment, int64 lease_micros);
+  ~ShmRing();
+
+  // Returns the offset in the segment of a block of num_bytes, or -1 if
+  // there is no room for it.  Sets *lease to the id the reader claims the
+  // block with.
+  int64 Allocate(size_t num_bytes, uint64* lease);
+
+  // Claims the block leased as lease, whose data is at offset in the segment
+  // mapped at base.  Returns false if its lease has ended and the writer
+  // took it back, in which case its content must not be read.  Safe to call
+  // from any process mapping the segment.
+  static bool Claim(char* base, uint64 offset, uint64 lease);
+
+  // Releases the block whose data is at offset in the segment mapped at
+  // base.  Safe to call from any process mapping the segment.
+  static void Release(char* base, uint64 offset);
+
+  SharedMemorySegment* segment() const { return segment_; }
+
+  // Number of bytes in blocks that are not reclaimed yet, headers included.
+  size_t BytesInUse();
+
+ private:
+  // Advances head_ past the released blocks and the unclaimed blocks whose
+  // lease has ended.
+  void Reclaim() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Writes the header of a block of block_bytes at tail_ and advances
+  // tail_ past it.  The block is leased as lease from now on, or free if
+  // lease is 0.
+  void Append(size_t block_bytes, uint64 lease) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  SharedMemorySegment* const segment_;
+  const size_t capacity_;
+  const int64 lease_micros_;
+
+  mutex mu_;
+  // Offset of the oldest block that has not been reclaimed.
+  size_t head_ GUARDED_BY(mu_) = 0;
+  // Offset at which the next block goes.
+  size_t tail_ GUARDED_BY(mu_) = 0;
+  size_t used_ GUARDED_BY(mu_) = 0;
+  // Id of the next lease; 0 marks free blocks.
+  uint64 next_lease_ GUARDED_BY(mu_) = 1;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShmRing);
+};
+
+}  // namespace tensorflow
+
+#endif  // SHM_RING_H_
@@ -0,0 +1,143 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_ring.h"
+
+#include <cstring>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Long enough for the blocks of most tests never to expire.
+constexpr int64 kLeaseMicros = 60 * 1000 * 1000;
+
+class ShmRingTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    TF_ASSERT_OK(SharedMemorySegment::Create("tf_shm_ring_test", 1024,
+                                             &segment_));
+    // A second mapping of the same segment stands in for the reader.
+    TF_ASSERT_OK(SharedMemorySegment::Open(segment_->name(), &reader_));
+    ring_.reset(new ShmRing(segment_, kLeaseMicros));
+  }
+
+  void TearDown() override {
+    ring_.reset();
+    if (reader_ != nullptr) reader_->Unref();
+    if (segment_ != nullptr) segment_->Unref();
+  }
+
+  int64 Allocate(size_t num_bytes) {
+    uint64 lease;
+    return ring_->Allocate(num_bytes, &lease);
+  }
+
+  bool Claim(int64 offset, uint64 lease) {
+    return ShmRing::Claim(reader_->base(), offset, lease);
+  }
+
+  void Release(int64 offset) { ShmRing::Release(reader_->base(), offset); }
+
+  SharedMemorySegment* segment_ = nullptr;
+  SharedMemorySegment* reader_ = nullptr;
+  std::unique_ptr<ShmRing> ring_;
+};
+
+TEST_F(ShmRingTest, ReaderSeesWrites) {
+  const int64 offset = Allocate(6);
+  ASSERT_GE(offset, 0);
+  EXPECT_EQ(0, offset % ShmRing::kAlignment);
+  memcpy(segment_->base() + offset, "hello", 6);
+  EXPECT_STREQ("hello", reader_->base() + offset);
+  EXPECT_TRUE(SharedMemorySegment::CanOpen(segment_->name()));
+  EXPECT_FALSE(SharedMemorySegment::CanOpen("/tf_shm_ring_test_missing"));
+}
+
+TEST_F(ShmRingTest, ReclaimsInOrder) {
+  // Each block takes a header and 192 bytes of data, so four fill the ring.
+  std::vector<int64> offsets;
+  for (int i = 0; i < 4; ++i) {
+    offsets.push_back(Allocate(150));
+    ASSERT_GE(offsets.back(), 0);
+  }
+  EXPECT_EQ(1024, ring_->BytesInUse());
+  EXPECT_EQ(-1, Allocate(1));
+
+  // A block released out of order is not reclaimed before the older ones.
+  Release(offsets[1]);
+  EXPECT_EQ(1024, ring_->BytesInUse());
+  EXPECT_EQ(-1, Allocate(1));
+  Release(offsets[0]);
+  EXPECT_EQ(512, ring_->BytesInUse());
+
+  // The next block wraps around to the start of the segment.
+  EXPECT_EQ(offsets[0], Allocate(150));
+  EXPECT_EQ(offsets[1], Allocate(150));
+  EXPECT_EQ(-1, Allocate(1));
+}
+
+TEST_F(ShmRingTest, SkipsTheEndWhenWrapping) {
+  const int64 first = Allocate(300);  // Takes 384 bytes.
+  const int64 second = Allocate(300);
+  ASSERT_GE(second, 0);
+  // 256 bytes are left at the end, not enough for another block this size.
+  Release(first);
+  EXPECT_EQ(first, Allocate(300));
+  EXPECT_EQ(1024, ring_->BytesInUse());
+  Release(second);
+  EXPECT_EQ(384, ring_->BytesInUse());
+}
+
+TEST_F(ShmRingTest, StartsOverWhenEmpty) {
+  const int64 first = Allocate(100);
+  Release(Allocate(100));
+  Release(first);
+  EXPECT_EQ(0, ring_->BytesInUse());
+  // The whole segment is available again, not just what follows the tail.
+  EXPECT_EQ(ShmRing::kAlignment, Allocate(1024 - ShmRing::kAlignment));
+  EXPECT_EQ(-1, Allocate(2048));
+}
+
+TEST_F(ShmRingTest, ReclaimsExpiredLeases) {
+  // Blocks that are not claimed right away expire.
+  ring_.reset(new ShmRing(segment_, 0));
+  int64 offsets[4];
+  uint64 leases[4];
+  offsets[0] = ring_->Allocate(150, &leases[0]);
+  ASSERT_TRUE(Claim(offsets[0], leases[0]));
+  // Behind the claimed block, the reader never gets to the others.
+  for (int i = 1; i < 4; ++i) {
+    offsets[i] = ring_->Allocate(150, &leases[i]);
+    ASSERT_GE(offsets[i], 0);
+  }
+  EXPECT_EQ(-1, Allocate(1));
+
+  // Once the claimed block is released, the expired ones go with it.
+  Release(offsets[0]);
+  EXPECT_EQ(0, ring_->BytesInUse());
+  EXPECT_FALSE(Claim(offsets[1], leases[1]));
+
+  // A late reader can't claim the block written next at the same offset.
+  uint64 lease;
+  EXPECT_EQ(offsets[0], ring_->Allocate(150, &lease));
+  EXPECT_FALSE(Claim(offsets[0], leases[0]));
+  EXPECT_TRUE(Claim(offsets[0], lease));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,99 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_server_lib.h"
+
+#include "grpc/support/alloc.h"
+#include "tensorflow/contrib/shm/shm_rendezvous_mgr.h"
+#include "tensorflow/contrib/shm/shm_worker.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Size of the ring that holds the tensors sent by this process.  The
+// segment is sparse: pages are only backed once a tensor is written there.
+const size_t kRingBytes = 256 << 20;
+
+// Smaller tensors are sent in the RecvTensor response.
+const size_t kMinTensorBytes = 4096;
+
+// Time a receiver has to map a tensor after it is sent.  Past it, the block
+// is taken back, so a lost response does not hold up the ring for good.
+const int64 kLeaseMicros = 60 * 1000 * 1000;
+
+}  // namespace
+
+ShmServer::ShmServer(const ServerDef& server_def, Env* env)
+    : GrpcServer(server_def, env),
+      shared_memory_manager_(
+          new SharedMemoryManager(kRingBytes, kMinTensorBytes, kLeaseMicros)) {}
+
+ShmServer::~ShmServer() {}
+
+Status ShmServer::Init() {
+  TF_RETURN_IF_ERROR(shared_memory_manager_->Init());
+  RendezvousMgrCreationFunction rendezvous_mgr_func =
+      [this](const WorkerEnv* env) {
+        return new ShmRendezvousMgr(env, shared_memory_manager_.get());
+      };
+  WorkerCreationFunction worker_func = [this](WorkerEnv* env) {
+    return std::unique_ptr<ShmWorker>(
+        new ShmWorker(env, shared_memory_manager_.get()));
+  };
+  return GrpcServer::Init(nullptr, rendezvous_mgr_func, worker_func);
+}
+
+/* static */
+Status ShmServer::Create(const ServerDef& server_def, Env* env,
+                         std::unique_ptr<ServerInterface>* out_server) {
+  std::unique_ptr<ShmServer> ret(
+      new ShmServer(server_def, env == nullptr ? Env::Default() : env));
+  TF_RETURN_IF_ERROR(ret->Init());
+  *out_server = std::move(ret);
+  return Status::OK();
+}
+
+namespace {
+
+class ShmServerFactory : public ServerFactory {
+ public:
+  bool AcceptsOptions(const ServerDef& server_def) override {
+    return server_def.protocol() == "grpc+shm";
+  }
+
+  Status NewServer(const ServerDef& server_def,
+                   std::unique_ptr<ServerInterface>* out_server) override {
+    return ShmServer::Create(server_def, Env::Default(), out_server);
+  }
+};
+
+// Registers a `ServerFactory` for `ShmServer` instances.
+class ShmServerRegistrar {
+ public:
+  ShmServerRegistrar() {
+    gpr_allocation_functions alloc_fns;
+    memset(&alloc_fns, 0, sizeof(alloc_fns));
+    alloc_fns.malloc_fn = port::Malloc;
+    alloc_fns.realloc_fn = port::Realloc;
+    alloc_fns.free_fn = port::Free;
+    gpr_set_allocation_functions(alloc_fns);
+    ServerFactory::Register("SHM_SERVER", new ShmServerFactory());
+  }
+};
+static ShmServerRegistrar registrar;
+
+}  // namespace
+}  // namespace tensorflow
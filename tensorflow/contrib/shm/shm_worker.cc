@@ -0,0 +1,149 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_worker.h"
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#if GOOGLE_CUDA
+#include "tensorflow/core/common_runtime/gpu/gpu_util.h"
+#endif  // GOOGLE_CUDA
+#include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/tracing.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Encodes val into response, in shared memory if possible.
+void EncodeHostTensor(SharedMemoryManager* shared_memory_manager,
+                      const ::google::protobuf::Any& request_options,
+                      bool is_dead, const Tensor& val,
+                      ::grpc::ByteBuffer* response) {
+  if (!is_dead) {
+    RecvTensorResponse proto;
+    if (shared_memory_manager->TransportOptionsFromTensor(
+            request_options, val, proto.mutable_transport_options())) {
+      proto.set_send_start_micros(Env::Default()->NowMicros());
+      // The content is in shared memory: an empty tensor of the right type
+      // keeps the receiver from allocating a buffer for it.
+      TensorProto* tensor_proto = proto.mutable_tensor();
+      tensor_proto->set_dtype(val.dtype());
+      tensor_proto->mutable_tensor_shape()->add_dim()->set_size(0);
+      grpc::EncodeRecvTensorResponseToByteBuffer(proto, response);
+      return;
+    }
+  }
+  grpc::EncodeTensorToByteBuffer(is_dead, val, response);
+}
+
+}  // namespace
+
+ShmWorker::ShmWorker(WorkerEnv* worker_env,
+                     SharedMemoryManager* shared_memory_manager)
+    : GrpcWorker(worker_env),
+      shared_memory_manager_(shared_memory_manager),
+      recv_tensor_recent_request_ids_(100000) {}
+
+void ShmWorker::GrpcRecvTensorAsync(CallOptions* opts,
+                                    const RecvTensorRequest* request,
+                                    ::grpc::ByteBuffer* response,
+                                    StatusCallback done) {
+  if (!request->has_transport_options()) {
+    GrpcWorker::GrpcRecvTensorAsync(opts, request, response, std::move(done));
+    return;
+  }
+  Status s = recv_tensor_recent_request_ids_.TrackUnique(
+      request->request_id(), "RecvTensor (ShmWorker)", *request);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+
+  const int64 step_id = request->step_id();
+  const string& key = request->rendezvous_key();
+  TRACEPRINTF("RecvTensor: %lld %s", step_id, key.c_str());
+  Rendezvous::ParsedKey parsed;
+  s = Rendezvous::ParseKey(key, &parsed);
+  Device* src_dev = nullptr;
+  if (s.ok()) {
+    s = PrepareRecvTensor(parsed, &src_dev);
+  }
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+
+  // Request the tensor associated with the rendezvous key. Any time
+  // while waiting for the tensor to be produced, up until the start
+  // of execution of the callback lambda body below, an RPC
+  // cancellation should abort the rendezvous.
+  opts->SetCancelCallback([this, step_id]() { AbortStep(step_id); });
+  const ::google::protobuf::Any request_options = request->transport_options();
+  SharedMemoryManager* shared_memory_manager = shared_memory_manager_;
+  env_->rendezvous_mgr->RecvLocalAsync(
+      step_id, parsed,
+      [opts, response, done, src_dev, request_options, shared_memory_manager](
+          const Status& status, const Rendezvous::Args& send_args,
+          const Rendezvous::Args&, const Tensor& val, const bool is_dead) {
+        opts->ClearCancelCallback();
+        if (!status.ok()) {
+          done(status);
+          return;
+        }
+        const bool on_host = send_args.alloc_attrs.on_host();
+        if (src_dev->tensorflow_gpu_device_info() && (!on_host)) {
+#if GOOGLE_CUDA
+          const DeviceContext* send_dev_context = send_args.device_context;
+          AllocatorAttributes alloc_attrs;
+          alloc_attrs.set_gpu_compatible(true);
+          alloc_attrs.set_on_host(true);
+          Allocator* alloc = src_dev->GetAllocator(alloc_attrs);
+          Tensor* copy = new Tensor(alloc, val.dtype(), val.shape());
+          CHECK(send_dev_context)
+              << "send dev name: " << src_dev->name()
+              << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
+          // "val" is on a GPU. Uses GPUUtil to fill the copy on host.
+          StatusCallback copy_ready = [response, done, copy, is_dead,
+                                       request_options,
+                                       shared_memory_manager](const Status& s) {
+            // The value is now ready to be returned.
+            if (s.ok()) {
+              EncodeHostTensor(shared_memory_manager, request_options,
+                               is_dead, *copy, response);
+            }
+            done(s);
+            delete copy;
+          };
+
+          GPUUtil::CopyGPUTensorToCPU(src_dev, send_dev_context, &val, copy,
+                                      copy_ready);
+#else
+          done(errors::Internal("No GPU device in process"));
+#endif  // GOOGLE_CUDA
+        } else {
+          EncodeHostTensor(shared_memory_manager, request_options, is_dead,
+                           val, response);
+          done(Status::OK());
+        }
+      });
+}
+
+}  // namespace tensorflow
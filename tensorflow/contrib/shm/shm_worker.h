@@ -0,0 +1,46 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHM_WORKER_H_
+#define SHM_WORKER_H_
+
+#include "tensorflow/contrib/shm/shm_memory_manager.h"
+
+#include "tensorflow/core/distributed_runtime/recent_request_ids.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
+
+namespace tensorflow {
+
+class ShmWorker : public GrpcWorker {
+ public:
+  ShmWorker(WorkerEnv* env, SharedMemoryManager* shared_memory_manager);
+
+  // Serve the RecvTensorRequest but omit the tensor content and place it in
+  // shared memory whenever the receiver can read it there.
+  // Otherwise, or if the request does not offer shared memory, it falls
+  // back to gRPC in-band tensor transport.
+  // The RecvTensorResponse will carry the location of the tensor content.
+  void GrpcRecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
+                           ::grpc::ByteBuffer* response,
+                           StatusCallback done) override;
+
+ private:
+  SharedMemoryManager* shared_memory_manager_;  // Not owned
+  RecentRequestIds recv_tensor_recent_request_ids_;
+};
+
+}  // namespace tensorflow
+
+#endif  // SHM_WORKER_H_
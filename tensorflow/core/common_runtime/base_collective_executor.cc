@@ -18,7 +18,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/recursive_halving_doubling_reducer.h"
 #include "tensorflow/core/common_runtime/ring_reducer.h"
 #include "tensorflow/core/lib/core/notification.h"
 
@@ -104,6 +106,16 @@ class CollectiveAdapterImpl : public CollectiveAdapter {
     return chunk_end - chunk_start;
   }
 
+  // Number of T elements in the chunks [begin, end).
+  inline int64 ChunkRangeElts(int begin, int end) const {
+    DCHECK_LE(begin, end);
+    DCHECK_LE(end, num_chunks_);
+    const T* range_start =
+        std::min(data_end_, data_start_ + begin * chunk_elts_);
+    const T* range_end = std::min(data_end_, data_start_ + end * chunk_elts_);
+    return range_end - range_start;
+  }
+
   int64 ChunkBytes(int i) const override { return sizeof(T) * ChunkElts(i); }
 
   // Returns a new Tensor that aliases the required chunk.
@@ -117,11 +129,24 @@ class CollectiveAdapterImpl : public CollectiveAdapter {
                           : output_.Slice(0, 0);
   }
 
+  Tensor ChunkRangeAlias(int begin, int end) override {
+    int64 start = chunk_elts_ * begin;
+    int64 num_elts = ChunkRangeElts(begin, end);
+    // As in ChunkAlias, take empty slices from the front of the tensor.
+    return (num_elts > 0) ? output_.Slice(start, start + num_elts)
+                          : output_.Slice(0, 0);
+  }
+
   Tensor TempChunk(int i) const override {
     AllocationAttributes empty;
     return Tensor(allocator_, dt_, {ChunkElts(i)}, empty);
   }
 
+  Tensor TempChunkRange(int begin, int end) const override {
+    AllocationAttributes empty;
+    return Tensor(allocator_, dt_, {ChunkRangeElts(begin, end)}, empty);
+  }
+
   string DebugString() const override {
     return strings::StrCat(
         "base addr ", reinterpret_cast<int64>(DMAHelper::base(&output_)),
@@ -217,7 +242,7 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
       // TODO(tucker): support other reduction algorithms,
       // e.g. tree-reduce, hybrid tree/ring, delegate-to-NCCL, etc.
       const Tensor* input = &ctx->input(0);
-      RingReducer* reducer =
+      CollectiveImplementationInterface* reducer =
           CreateReducer(ctx, CtxParams(ctx), col_params, exec_key, step_id_,
                         input, output, &error);
       if (!reducer) {
@@ -258,7 +283,7 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
   }
 }
 
-RingReducer* BaseCollectiveExecutor::CreateReducer(
+CollectiveImplementationInterface* BaseCollectiveExecutor::CreateReducer(
     OpKernelContext* ctx, OpKernelContext::Params* params,
     const CollectiveParams& col_params, const string& exec_key, int64 step_id,
     const Tensor* input, Tensor* output, string* error) {
@@ -274,8 +299,20 @@ RingReducer* BaseCollectiveExecutor::CreateReducer(
     case DT_FLOAT:
     case DT_DOUBLE:
     case DT_INT64:
-      return new RingReducer(this, dev_mgr_, ctx, params, col_params, exec_key,
-                             step_id, input, output);
+      switch (col_params.instance.impl_details.reduction_algorithm) {
+        case RECURSIVE_HALVING_DOUBLING_REDUCTION:
+          return new RecursiveHalvingDoublingReducer(this, dev_mgr_, ctx,
+                                                     params, col_params,
+                                                     exec_key, step_id, input,
+                                                     output);
+        case HIERARCHICAL_REDUCTION:
+          return new HierarchicalReducer(this, dev_mgr_, ctx, params,
+                                         col_params, exec_key, step_id, input,
+                                         output);
+        default:
+          return new RingReducer(this, dev_mgr_, ctx, params, col_params,
+                                 exec_key, step_id, input, output);
+      }
       break;
     default:
       *error = strings::StrCat("Collective Reduce does not support datatype ",
@@ -23,7 +23,16 @@ limitations under the License.
 namespace tensorflow {
 class Broadcaster;
 class DeviceMgr;
-class RingReducer;
+
+// Interface of an object that carries out a single collective operation
+// on behalf of one device, e.g. one specific all-reduce algorithm.
+class CollectiveImplementationInterface {
+ public:
+  virtual ~CollectiveImplementationInterface() {}
+
+  // Executes the collective, invoking done on completion.
+  virtual void Run(StatusCallback done) = 0;
+};
 
 // Helper interface that aliases regular subfields of a Tensor as separate
 // Tensors for in-place update.
@@ -42,11 +51,18 @@ class CollectiveAdapter {
   // Returns tensor for chunk i which aliases the backing buffer.
   virtual Tensor ChunkAlias(int i) = 0;
 
+  // Returns tensor for the contiguous chunks [begin, end) which aliases
+  // the backing buffer.
+  virtual Tensor ChunkRangeAlias(int begin, int end) = 0;
+
   // Returns tensor allocated on the same device but with its own
   // separate backing buffer.  Will have same type and size as
   // chunk i.
   virtual Tensor TempChunk(int i) const = 0;
 
+  // Like TempChunk, but sized to hold the chunks [begin, end).
+  virtual Tensor TempChunkRange(int begin, int end) const = 0;
+
   // Bytes in chunk i
   virtual int64 ChunkBytes(int i) const = 0;
 
@@ -133,12 +149,10 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
   std::unique_ptr<PerStepCollectiveRemoteAccess> remote_access_;
 
  private:
-  RingReducer* CreateReducer(OpKernelContext* ctx,
-                             OpKernelContext::Params* params,
-                             const CollectiveParams& col_params,
-                             const string& exec_key, int64 step_id,
-                             const Tensor* input, Tensor* output,
-                             string* error);
+  CollectiveImplementationInterface* CreateReducer(
+      OpKernelContext* ctx, OpKernelContext::Params* params,
+      const CollectiveParams& col_params, const string& exec_key, int64 step_id,
+      const Tensor* input, Tensor* output, string* error);
 
   Broadcaster* CreateBroadcaster(OpKernelContext* ctx,
                                  OpKernelContext::Params* params,
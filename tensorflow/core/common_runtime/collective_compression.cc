@@ -0,0 +1,230 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_compression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "tensorflow/core/framework/numeric_types.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace {
+
+// Number of values kept by TOP_K_COMPRESSION.
+int64 TopK(float top_k_fraction, int64 num_elements) {
+  if (num_elements == 0) return 0;
+  const int64 k = static_cast<int64>(std::ceil(top_k_fraction * num_elements));
+  return std::min(num_elements, std::max<int64>(1, k));
+}
+
+template <typename T>
+void EncodeHalfWidth(const float* values, int64 n, uint8* out) {
+  for (int64 i = 0; i < n; ++i) {
+    const T v = static_cast<T>(values[i]);
+    std::memcpy(out + i * sizeof(T), &v, sizeof(T));
+  }
+}
+
+template <typename T>
+void DecodeHalfWidth(const uint8* in, int64 n, float* values) {
+  for (int64 i = 0; i < n; ++i) {
+    T v;
+    std::memcpy(&v, in + i * sizeof(T), sizeof(T));
+    values[i] = static_cast<float>(v);
+  }
+}
+
+void EncodeBfloat16(const float* values, int64 n, uint8* out) {
+  for (int64 i = 0; i < n; ++i) {
+    const bfloat16 v = bfloat16::round_to_bfloat16(values[i]);
+    std::memcpy(out + i * sizeof(bfloat16), &v, sizeof(bfloat16));
+  }
+}
+
+void EncodeInt8(const float* values, int64 n, uint8* out) {
+  float max_abs = 0.0f;
+  for (int64 i = 0; i < n; ++i) {
+    max_abs = std::max(max_abs, std::abs(values[i]));
+  }
+  const float scale = max_abs / 127.0f;
+  std::memcpy(out, &scale, sizeof(scale));
+  int8* q = reinterpret_cast<int8*>(out + sizeof(scale));
+  if (scale == 0.0f) {
+    std::fill(q, q + n, 0);
+    return;
+  }
+  const float inv_scale = 1.0f / scale;
+  for (int64 i = 0; i < n; ++i) {
+    const float r = std::round(values[i] * inv_scale);
+    q[i] = static_cast<int8>(std::min(127.0f, std::max(-127.0f, r)));
+  }
+}
+
+void DecodeInt8(const uint8* in, int64 n, float* values) {
+  float scale;
+  std::memcpy(&scale, in, sizeof(scale));
+  const int8* q = reinterpret_cast<const int8*>(in + sizeof(scale));
+  for (int64 i = 0; i < n; ++i) {
+    values[i] = q[i] * scale;
+  }
+}
+
+void EncodeTopK(const float* values, int64 n, int64 k, uint8* out) {
+  std::vector<int32> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::nth_element(order.begin(), order.begin() + (k - 1), order.end(),
+                   [values](int32 a, int32 b) {
+                     return std::abs(values[a]) > std::abs(values[b]);
+                   });
+  // Sorted indices make decoding a forward scan.
+  std::sort(order.begin(), order.begin() + k);
+  int32* indices = reinterpret_cast<int32*>(out);
+  float* kept = reinterpret_cast<float*>(out + k * sizeof(int32));
+  for (int64 i = 0; i < k; ++i) {
+    indices[i] = order[i];
+    kept[i] = values[order[i]];
+  }
+}
+
+void DecodeTopK(const uint8* in, int64 n, int64 k, float* values) {
+  const int32* indices = reinterpret_cast<const int32*>(in);
+  const float* kept = reinterpret_cast<const float*>(in + k * sizeof(int32));
+  std::fill(values, values + n, 0.0f);
+  for (int64 i = 0; i < k; ++i) {
+    values[indices[i]] = kept[i];
+  }
+}
+
+Status Decode(CollectiveCompression compression, float top_k_fraction,
+              const uint8* in, int64 n, float* values) {
+  switch (compression) {
+    case FP16_COMPRESSION:
+      DecodeHalfWidth<Eigen::half>(in, n, values);
+      break;
+    case BFLOAT16_COMPRESSION:
+      DecodeHalfWidth<bfloat16>(in, n, values);
+      break;
+    case INT8_COMPRESSION:
+      DecodeInt8(in, n, values);
+      break;
+    case TOP_K_COMPRESSION:
+      DecodeTopK(in, n, TopK(top_k_fraction, n), values);
+      break;
+    default:
+      return errors::InvalidArgument("Unsupported collective compression ",
+                                     compression);
+  }
+  return Status::OK();
+}
+
+Status CheckTensors(CollectiveCompression compression, float top_k_fraction,
+                    const Tensor& values, const Tensor& encoded) {
+  if (values.dtype() != DT_FLOAT) {
+    return errors::InvalidArgument(
+        "Collective compression requires DT_FLOAT values, got ",
+        DataTypeString(values.dtype()));
+  }
+  const int64 num_bytes =
+      CompressedBytes(compression, top_k_fraction, values.NumElements());
+  if (encoded.dtype() != DT_UINT8 || encoded.NumElements() != num_bytes) {
+    return errors::Internal("Compressed chunk of ", values.NumElements(),
+                            " values must be DT_UINT8 of ", num_bytes,
+                            " elements, got ", encoded.DebugString());
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+int64 CompressedBytes(CollectiveCompression compression, float top_k_fraction,
+                      int64 num_elements) {
+  switch (compression) {
+    case FP16_COMPRESSION:
+      return num_elements * sizeof(Eigen::half);
+    case BFLOAT16_COMPRESSION:
+      return num_elements * sizeof(bfloat16);
+    case INT8_COMPRESSION:
+      return sizeof(float) + num_elements;
+    case TOP_K_COMPRESSION:
+      return TopK(top_k_fraction, num_elements) *
+             (sizeof(int32) + sizeof(float));
+    default:
+      return num_elements * sizeof(float);
+  }
+}
+
+Status CompressChunk(CollectiveCompression compression, float top_k_fraction,
+                     const Tensor& values, Tensor* residual, Tensor* encoded) {
+  TF_RETURN_IF_ERROR(
+      CheckTensors(compression, top_k_fraction, values, *encoded));
+  const int64 n = values.NumElements();
+  const float* in = values.flat<float>().data();
+  std::vector<float> corrected;
+  if (residual != nullptr) {
+    if (residual->dtype() != DT_FLOAT || residual->NumElements() != n) {
+      return errors::Internal("Residual ", residual->DebugString(),
+                              " does not match ", values.DebugString());
+    }
+    const float* r = residual->flat<float>().data();
+    corrected.resize(n);
+    for (int64 i = 0; i < n; ++i) {
+      corrected[i] = in[i] + r[i];
+    }
+    in = corrected.data();
+  }
+
+  uint8* out = encoded->flat<uint8>().data();
+  switch (compression) {
+    case FP16_COMPRESSION:
+      EncodeHalfWidth<Eigen::half>(in, n, out);
+      break;
+    case BFLOAT16_COMPRESSION:
+      EncodeBfloat16(in, n, out);
+      break;
+    case INT8_COMPRESSION:
+      EncodeInt8(in, n, out);
+      break;
+    case TOP_K_COMPRESSION:
+      if (n > 0) EncodeTopK(in, n, TopK(top_k_fraction, n), out);
+      break;
+    default:
+      return errors::InvalidArgument("Unsupported collective compression ",
+                                     compression);
+  }
+
+  if (residual != nullptr) {
+    // The error is what the receiver will not see.
+    float* r = residual->flat<float>().data();
+    TF_RETURN_IF_ERROR(Decode(compression, top_k_fraction, out, n, r));
+    for (int64 i = 0; i < n; ++i) {
+      r[i] = in[i] - r[i];
+    }
+  }
+  return Status::OK();
+}
+
+Status DecompressChunk(CollectiveCompression compression, float top_k_fraction,
+                       const Tensor& encoded, Tensor* values) {
+  TF_RETURN_IF_ERROR(
+      CheckTensors(compression, top_k_fraction, *values, encoded));
+  return Decode(compression, top_k_fraction, encoded.flat<uint8>().data(),
+                values->NumElements(), values->flat<float>().data());
+}
+
+}  // namespace tensorflow
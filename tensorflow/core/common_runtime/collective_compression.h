@@ -0,0 +1,58 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_COMPRESSION_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_COMPRESSION_H_
+
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+// Encoders for the chunks that a compressed reduction sends between
+// devices.  Values are DT_FLOAT and encodings are DT_UINT8 vectors whose
+// size depends only on the number of values, so that a receiver can
+// allocate a buffer for a chunk it has not seen yet.
+//
+// Encodings:
+//   FP16_COMPRESSION, BFLOAT16_COMPRESSION: 2 bytes per value.
+//   INT8_COMPRESSION: a float scale followed by 1 byte per value, each the
+//     value divided by the scale and rounded.  The scale maps the largest
+//     magnitude of the chunk to 127.
+//   TOP_K_COMPRESSION: k int32 indices followed by the k float values at
+//     those indices; all other values decode to zero.  k is top_k_fraction
+//     of the number of values, rounded up.
+
+// Returns the number of bytes in the encoding of num_elements values.
+int64 CompressedBytes(CollectiveCompression compression, float top_k_fraction,
+                      int64 num_elements);
+
+// Encodes values into *encoded, which must hold
+// CompressedBytes(compression, top_k_fraction, values.NumElements()) bytes.
+//
+// If residual is not null it must have as many elements as values.  Its
+// contents are added to values before encoding and it is then overwritten
+// with the encoding error.  Passing the same residual to the next encoding of
+// the corresponding values feeds the error back, so that it is not lost but
+// only delayed.
+Status CompressChunk(CollectiveCompression compression, float top_k_fraction,
+                     const Tensor& values, Tensor* residual, Tensor* encoded);
+
+// Decodes encoded, produced by CompressChunk, into *values.
+Status DecompressChunk(CollectiveCompression compression, float top_k_fraction,
+                       const Tensor& encoded, Tensor* values);
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_COMPRESSION_H_
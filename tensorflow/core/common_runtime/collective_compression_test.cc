@@ -0,0 +1,179 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_compression.h"
+
+#include <cmath>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor Encoding(CollectiveCompression compression, float top_k_fraction,
+                int64 num_elements) {
+  return Tensor(DT_UINT8,
+                TensorShape({CompressedBytes(compression, top_k_fraction,
+                                             num_elements)}));
+}
+
+Tensor RoundTrip(CollectiveCompression compression, float top_k_fraction,
+                 const Tensor& values) {
+  Tensor encoded =
+      Encoding(compression, top_k_fraction, values.NumElements());
+  TF_CHECK_OK(
+      CompressChunk(compression, top_k_fraction, values, nullptr, &encoded));
+  Tensor decoded(DT_FLOAT, values.shape());
+  TF_CHECK_OK(
+      DecompressChunk(compression, top_k_fraction, encoded, &decoded));
+  return decoded;
+}
+
+TEST(CollectiveCompressionTest, CompressedBytes) {
+  EXPECT_EQ(400, CompressedBytes(NO_COMPRESSION, 0.01f, 100));
+  EXPECT_EQ(200, CompressedBytes(FP16_COMPRESSION, 0.01f, 100));
+  EXPECT_EQ(200, CompressedBytes(BFLOAT16_COMPRESSION, 0.01f, 100));
+  EXPECT_EQ(104, CompressedBytes(INT8_COMPRESSION, 0.01f, 100));
+  EXPECT_EQ(8, CompressedBytes(TOP_K_COMPRESSION, 0.01f, 100));
+  EXPECT_EQ(80, CompressedBytes(TOP_K_COMPRESSION, 0.1f, 95));
+  // At least one value is kept.
+  EXPECT_EQ(8, CompressedBytes(TOP_K_COMPRESSION, 0.01f, 3));
+}
+
+TEST(CollectiveCompressionTest, HalfWidthRoundTrip) {
+  // These values are exact in both fp16 and bfloat16.
+  Tensor values = test::AsTensor<float>({0.0f, 1.0f, -2.5f, 0.125f, 96.0f});
+  test::ExpectTensorEqual<float>(values,
+                                 RoundTrip(FP16_COMPRESSION, 0.01f, values));
+  test::ExpectTensorEqual<float>(
+      values, RoundTrip(BFLOAT16_COMPRESSION, 0.01f, values));
+}
+
+TEST(CollectiveCompressionTest, Int8RoundTrip) {
+  Tensor values = test::AsTensor<float>({0.0f, 1.0f, -2.54f, 0.3f, 1.27f});
+  Tensor decoded = RoundTrip(INT8_COMPRESSION, 0.01f, values);
+  // The scale is 2.54 / 127 = 0.02, so each value is off by at most 0.01.
+  for (int i = 0; i < values.NumElements(); ++i) {
+    EXPECT_NEAR(values.flat<float>()(i), decoded.flat<float>()(i), 0.0101f);
+  }
+  EXPECT_FLOAT_EQ(-2.54f, decoded.flat<float>()(2));
+
+  // All zeros do not divide by a zero scale.
+  Tensor zeros = test::AsTensor<float>({0.0f, 0.0f});
+  test::ExpectTensorEqual<float>(zeros,
+                                 RoundTrip(INT8_COMPRESSION, 0.01f, zeros));
+}
+
+TEST(CollectiveCompressionTest, TopKRoundTrip) {
+  Tensor values =
+      test::AsTensor<float>({0.1f, -5.0f, 0.2f, 3.0f, -0.3f, 0.0f, 1.0f});
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({0.0f, -5.0f, 0.0f, 3.0f, 0.0f, 0.0f, 0.0f}),
+      RoundTrip(TOP_K_COMPRESSION, 0.25f, values));
+}
+
+TEST(CollectiveCompressionTest, RejectsMismatchedTensors) {
+  Tensor values = test::AsTensor<float>({1.0f, 2.0f});
+  Tensor too_small(DT_UINT8, TensorShape({3}));
+  EXPECT_FALSE(
+      CompressChunk(FP16_COMPRESSION, 0.01f, values, nullptr, &too_small)
+          .ok());
+  Tensor ints = test::AsTensor<int32>({1, 2});
+  Tensor encoded = Encoding(FP16_COMPRESSION, 0.01f, 2);
+  EXPECT_FALSE(
+      CompressChunk(FP16_COMPRESSION, 0.01f, ints, nullptr, &encoded).ok());
+  Tensor residual = test::AsTensor<float>({0.0f});
+  EXPECT_FALSE(
+      CompressChunk(FP16_COMPRESSION, 0.01f, values, &residual, &encoded)
+          .ok());
+}
+
+// Encodes the same values repeatedly, feeding back the residual, and checks
+// that the decoded values add up to the sum of the inputs less the residual
+// still held back, which stays bounded.
+void CheckErrorFeedback(CollectiveCompression compression,
+                        float top_k_fraction, float max_residual) {
+  const int64 kNumElements = 64;
+  const int kSteps = 50;
+  random::PhiloxRandom philox(17, 17);
+  random::SimplePhilox rnd(&philox);
+  Tensor values(DT_FLOAT, TensorShape({kNumElements}));
+  for (int64 i = 0; i < kNumElements; ++i) {
+    values.flat<float>()(i) = rnd.RandFloat() * 2.0f - 1.0f;
+  }
+  Tensor residual(DT_FLOAT, TensorShape({kNumElements}));
+  residual.flat<float>().setZero();
+  Tensor encoded = Encoding(compression, top_k_fraction, kNumElements);
+  Tensor decoded(DT_FLOAT, TensorShape({kNumElements}));
+  std::vector<double> sum(kNumElements, 0.0);
+  for (int step = 0; step < kSteps; ++step) {
+    TF_ASSERT_OK(CompressChunk(compression, top_k_fraction, values, &residual,
+                               &encoded));
+    TF_ASSERT_OK(
+        DecompressChunk(compression, top_k_fraction, encoded, &decoded));
+    for (int64 i = 0; i < kNumElements; ++i) {
+      sum[i] += decoded.flat<float>()(i);
+    }
+  }
+  for (int64 i = 0; i < kNumElements; ++i) {
+    const double expected = kSteps * values.flat<float>()(i);
+    EXPECT_NEAR(expected - residual.flat<float>()(i), sum[i], 1e-3) << i;
+    EXPECT_LE(std::abs(residual.flat<float>()(i)), max_residual) << i;
+  }
+}
+
+TEST(CollectiveCompressionTest, ErrorFeedback) {
+  CheckErrorFeedback(FP16_COMPRESSION, 0.01f, 1e-3f);
+  CheckErrorFeedback(BFLOAT16_COMPRESSION, 0.01f, 1e-2f);
+  CheckErrorFeedback(INT8_COMPRESSION, 0.01f, 1e-2f);
+  // Every value is sent once its residual outgrows the others, so none of
+  // them is held back for more than a few multiples of 1 / top_k_fraction.
+  CheckErrorFeedback(TOP_K_COMPRESSION, 0.25f, 8.0f);
+}
+
+static void BM_CompressChunk(int iters, int compression, int num_elements) {
+  testing::StopTiming();
+  const CollectiveCompression c =
+      static_cast<CollectiveCompression>(compression);
+  Tensor values(DT_FLOAT, TensorShape({num_elements}));
+  values.flat<float>().setRandom();
+  Tensor residual(DT_FLOAT, TensorShape({num_elements}));
+  residual.flat<float>().setZero();
+  Tensor encoded = Encoding(c, 0.01f, num_elements);
+  Tensor decoded(DT_FLOAT, TensorShape({num_elements}));
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(CompressChunk(c, 0.01f, values, &residual, &encoded));
+    TF_CHECK_OK(DecompressChunk(c, 0.01f, encoded, &decoded));
+  }
+  testing::StopTiming();
+  testing::BytesProcessed(static_cast<int64>(iters) * num_elements *
+                          sizeof(float));
+  testing::SetLabel(strings::StrCat("wire_bytes=", encoded.NumElements(),
+                                    " raw_bytes=",
+                                    num_elements * sizeof(float)));
+}
+BENCHMARK(BM_CompressChunk)
+    ->ArgPair(FP16_COMPRESSION, 1 << 20)
+    ->ArgPair(BFLOAT16_COMPRESSION, 1 << 20)
+    ->ArgPair(INT8_COMPRESSION, 1 << 20)
+    ->ArgPair(TOP_K_COMPRESSION, 1 << 20);
+
+}  // namespace
+}  // namespace tensorflow
@@ -413,6 +413,36 @@ void GenerateSubdivPerms(const string& device, int source_rank,
   }
 }
 
+// Reductions of tensors up to this many bytes are latency-bound, so they
+// use recursive halving-doubling, which needs O(log(group_size)) rather
+// than O(group_size) sequential steps.
+constexpr int64 kRecursiveHalvingDoublingMaxBytes = 64 << 10;
+// Up to this many bytes, reductions spanning several tasks that each hold
+// several devices reduce within each task first, so that only one device
+// per task communicates across tasks.  Larger tensors are bandwidth-bound
+// and use a ring.
+constexpr int64 kHierarchicalMaxBytes = 4 << 20;
+
+// Picks the reduction algorithm for cp from its tensor size and topology.
+// Requires cp->group and cp->instance to be complete.
+CollectiveReductionAlgorithm ChooseReductionAlgorithm(
+    const CollectiveParams& cp) {
+  // Only the ring encodes what it sends.
+  if (cp.instance.compression != NO_COMPRESSION) {
+    return RING_REDUCTION;
+  }
+  const int64 num_bytes =
+      cp.instance.shape.num_elements() * DataTypeSize(cp.instance.data_type);
+  if (num_bytes <= kRecursiveHalvingDoublingMaxBytes) {
+    return RECURSIVE_HALVING_DOUBLING_REDUCTION;
+  }
+  if (cp.group.num_tasks > 1 && cp.group.group_size > cp.group.num_tasks &&
+      num_bytes <= kHierarchicalMaxBytes) {
+    return HIERARCHICAL_REDUCTION;
+  }
+  return RING_REDUCTION;
+}
+
 }  // namespace
 
 void CollectiveParamResolverLocal::CompleteTaskIsLocal(const string& task_name,
@@ -472,6 +502,10 @@ Status CollectiveParamResolverLocal::InitInstanceSharedParams(
   note.WaitForNotification();
   if (status.ok()) {
     CompleteDefaultRanking(gr, cp, ir, localities);
+    if (ir->shared.instance.type == REDUCTION_COLLECTIVE) {
+      ir->shared.instance.impl_details.reduction_algorithm =
+          ChooseReductionAlgorithm(ir->shared);
+    }
   }
   return status;
 }
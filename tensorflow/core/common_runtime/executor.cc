@@ -571,6 +571,47 @@ char* GraphView::InitializeNode(char* ptr, const Node* n) {
     output_types[i] = static_cast<uint8>(n->output_type(i));
     DCHECK_EQ(item->output_type(i), n->output_type(i));
   }
+
+  // Record the outputs that a graph rewrite, e.g. the ScopedAllocator
+  // optimizer, pinned to a ScopedAllocator or to the buffer of an input.
+  {
+    std::vector<int> forward_input;
+    Status fwd_status =
+        GetNodeAttr(n->attrs(), "_forward_input", &forward_input);
+    std::vector<int> scoped_allocator_attrs;
+    Status sa_status =
+        GetNodeAttr(n->attrs(), "_scoped_allocator", &scoped_allocator_attrs);
+
+    int* forward_from = item->forward_from_base();
+    for (int i = 0; i < num_outputs; ++i) {
+      forward_from[i] = OpKernelContext::Params::kNoReservation;
+    }
+    if (sa_status.ok()) {
+      // The attr holds (output_index, scope_id) pairs.  Such an output must
+      // be allocated from the ScopedAllocator, so it may never reuse the
+      // buffer of an input.
+      for (size_t i = 0; i + 1 < scoped_allocator_attrs.size(); i += 2) {
+        const int output_index = scoped_allocator_attrs[i];
+        if (output_index < 0 || output_index >= num_outputs) continue;
+        forward_from[output_index] = OpKernelContext::Params::kNeverForward;
+        output_attrs[output_index].scope_id = scoped_allocator_attrs[i + 1];
+      }
+    }
+    if (fwd_status.ok()) {
+      // The attr holds (input_index, output_index) pairs, each reserving the
+      // input buffer for that output.
+      for (size_t i = 0; i + 1 < forward_input.size(); i += 2) {
+        const int output_index = forward_input[i + 1];
+        if (output_index < 0 || output_index >= num_outputs ||
+            forward_from[output_index] ==
+                OpKernelContext::Params::kNeverForward) {
+          continue;
+        }
+        forward_from[output_index] = forward_input[i];
+      }
+    }
+  }
+
   return ptr;
 }
 
@@ -1614,7 +1655,7 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
       params.frame_iter = FrameAndIter(input_frame->frame_id, input_iter);
       params.is_input_dead = is_input_dead;
       params.output_attr_array = item.output_attrs();
-      params.forward_from_array = nullptr;  // later: item.forward_from();
+      params.forward_from_array = item.forward_from();
 
       if (item.kernel_is_async) {
         // Asynchronous computes.
@@ -0,0 +1,111 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <unordered_set>
+
+namespace tensorflow {
+
+HierarchicalReducer::HierarchicalReducer(
+    CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+    OpKernelContext* ctx, OpKernelContext::Params* op_params,
+    const CollectiveParams& col_params, const string& exec_key, int64 step_id,
+    const Tensor* input, Tensor* output)
+    : RecursiveHalvingDoublingReducer(col_exec, dev_mgr, ctx, op_params,
+                                      col_params, exec_key, step_id, input,
+                                      output),
+      local_rank_(-1) {
+  // The leader of each task is its first device in default rank order, and
+  // only the leaders take part in the inter-task all-reduce.
+  const std::vector<string>& task_names = col_params.instance.task_names;
+  const string& my_task = task_names[col_params.default_rank];
+  std::unordered_set<string> seen_tasks;
+  peers_.clear();
+  peer_rank_ = -1;
+  for (int i = 0; i < group_size_; ++i) {
+    if (seen_tasks.insert(task_names[i]).second) {
+      if (i == col_params.default_rank) {
+        peer_rank_ = static_cast<int>(peers_.size());
+      }
+      peers_.push_back(i);
+    }
+    if (task_names[i] == my_task) {
+      if (i == col_params.default_rank) {
+        local_rank_ = static_cast<int>(local_devices_.size());
+      }
+      local_devices_.push_back(i);
+    }
+  }
+  CHECK_GE(local_rank_, 0);
+}
+
+Status HierarchicalReducer::RunReduction() {
+  const int num_local = static_cast<int>(local_devices_.size());
+  const int my_dev = local_devices_[local_rank_];
+  const int num_chunks = LargestPowerOfTwo(peers_.size());
+  Tensor whole = ca_->ChunkRangeAlias(0, num_chunks);
+
+  // Reduce onto the leader along a binomial tree: at distance d the device
+  // at local rank r + d hands its partial value to the one at rank r, for
+  // each r that is a multiple of 2 * d.
+  int step = 0;
+  Tensor tmp;
+  for (int dist = 1; dist < num_local; dist *= 2, ++step) {
+    if ((local_rank_ % (2 * dist)) == dist) {
+      const int parent = local_devices_[local_rank_ - dist];
+      TF_RETURN_IF_ERROR(SendRecv(parent,
+                                  BufKey("local_reduce", step, my_dev, parent),
+                                  &whole, -1, "", nullptr));
+      break;
+    } else if ((local_rank_ % (2 * dist)) == 0 &&
+               (local_rank_ + dist) < num_local) {
+      const int child = local_devices_[local_rank_ + dist];
+      if (!tmp.IsInitialized()) tmp = ca_->TempChunkRange(0, num_chunks);
+      TF_RETURN_IF_ERROR(SendRecv(-1, "", nullptr, child,
+                                  BufKey("local_reduce", step, child, my_dev),
+                                  &tmp));
+      if (tmp.NumElements() > 0) {
+        TF_RETURN_IF_ERROR(Reduce(&whole, &tmp));
+      }
+    }
+  }
+
+  // The leaders, which now hold their task's partial value, all-reduce it
+  // among themselves.
+  if (local_rank_ == 0) {
+    TF_RETURN_IF_ERROR(AllReduceAmongPeers());
+  }
+
+  // Broadcast the final value back down the same tree.
+  int top_dist = 1;
+  while (top_dist < num_local) top_dist *= 2;
+  for (int dist = top_dist / 2; dist >= 1; dist /= 2) {
+    if ((local_rank_ % (2 * dist)) == dist) {
+      const int parent = local_devices_[local_rank_ - dist];
+      TF_RETURN_IF_ERROR(SendRecv(-1, "", nullptr, parent,
+                                  BufKey("local_bcast", dist, parent, my_dev),
+                                  &whole));
+    } else if ((local_rank_ % (2 * dist)) == 0 &&
+               (local_rank_ + dist) < num_local) {
+      const int child = local_devices_[local_rank_ + dist];
+      TF_RETURN_IF_ERROR(SendRecv(child,
+                                  BufKey("local_bcast", dist, my_dev, child),
+                                  &whole, -1, "", nullptr));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
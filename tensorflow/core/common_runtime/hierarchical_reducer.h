@@ -0,0 +1,54 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/recursive_halving_doubling_reducer.h"
+
+namespace tensorflow {
+
+// Two-level implementation of collective all-reduce.
+//
+// The devices of each task first reduce their values onto the task's
+// leader, its first device in default rank order, along a binomial tree.
+// The leaders then all-reduce among themselves by recursive
+// halving-doubling, and finally each leader broadcasts the result back
+// down its tree.  Only one device per task sends data between tasks,
+// which cuts the number of messages on the slower inter-task links.
+class HierarchicalReducer : public RecursiveHalvingDoublingReducer {
+ public:
+  HierarchicalReducer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+                      OpKernelContext* ctx, OpKernelContext::Params* op_params,
+                      const CollectiveParams& col_params,
+                      const string& exec_key, int64 step_id,
+                      const Tensor* input, Tensor* output);
+
+  ~HierarchicalReducer() override {}
+
+ protected:
+  Status RunReduction() override;
+
+ private:
+  // Indices into col_params_.instance.device_names of the devices in this
+  // device's task, in default rank order; local_devices_[local_rank_] is
+  // this device.
+  std::vector<int> local_devices_;
+  int local_rank_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
@@ -0,0 +1,333 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/recursive_halving_doubling_reducer.h"
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace {
+
+// Runs 'op' on 'device' in place on 'output', with 'input' as its second
+// argument, using an OpKernelContext derived from that of the collective.
+Status ComputeBinOp(OpKernelContext* ctx, OpKernelContext::Params* params,
+                    Device* device, OpKernel* op, Tensor* output,
+                    Tensor* input) {
+  OpKernelContext::Params sub_params(*params);
+  gtl::InlinedVector<TensorValue, 4> sub_inputs({output, input});
+  gtl::InlinedVector<AllocatorAttributes, 4> sub_input_attr(
+      {ctx->input_alloc_attr(0), ctx->input_alloc_attr(0)});
+  gtl::InlinedVector<DeviceContext*, 4> sub_input_dc(
+      {ctx->input_device_context(0), ctx->input_device_context(0)});
+  sub_params.op_kernel = op;
+  sub_params.inputs = &sub_inputs;
+  sub_params.input_alloc_attrs = &sub_input_attr;
+  sub_params.input_device_contexts = &sub_input_dc;
+  sub_params.eigen_gpu_device = nullptr;
+  sub_params.ensure_eigen_gpu_device();
+  OpKernelContext sub_ctx(&sub_params, 1);
+  device->Compute(op, &sub_ctx);
+  return sub_ctx.status();
+}
+
+}  // namespace
+
+RecursiveHalvingDoublingReducer::RecursiveHalvingDoublingReducer(
+    CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+    OpKernelContext* ctx, OpKernelContext::Params* op_params,
+    const CollectiveParams& col_params, const string& exec_key, int64 step_id,
+    const Tensor* input, Tensor* output)
+    : col_exec_(col_exec),
+      dev_mgr_(dev_mgr),
+      ctx_(ctx),
+      op_params_(op_params),
+      col_params_(col_params),
+      exec_key_(exec_key),
+      input_(input),
+      output_(output),
+      step_id_(step_id),
+      group_size_(col_params.group.group_size),
+      device_name_(col_params.instance.device_names[col_params.default_rank]),
+      device_(nullptr),
+      peer_rank_(col_params.default_rank) {
+  CHECK_GT(group_size_, 0);
+  peers_.reserve(group_size_);
+  for (int i = 0; i < group_size_; ++i) {
+    peers_.push_back(i);
+  }
+}
+
+/*static*/
+int RecursiveHalvingDoublingReducer::LargestPowerOfTwo(int n) {
+  DCHECK_GT(n, 0);
+  int p = 1;
+  while (p <= n / 2) p *= 2;
+  return p;
+}
+
+void RecursiveHalvingDoublingReducer::Run(StatusCallback done) {
+  CHECK(dev_mgr_);
+  Status s = dev_mgr_->LookupDevice(device_name_, &device_);
+  if (!s.ok()) {
+    LOG(ERROR) << "Failed to find device " << device_name_;
+    done(s);
+    return;
+  }
+  device_locality_ = device_->attributes().locality();
+
+  VLOG(1) << this << " default_rank " << col_params_.default_rank << " cp "
+          << &col_params_ << ": " << col_params_.ToString();
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((input_ != output_) &&
+      (DMAHelper::base(input_) != DMAHelper::base(output_))) {
+    Notification note;
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        ctx_->input_device_context(0), ctx_->op_device_context(), device_,
+        device_, ctx_->input_alloc_attr(0), ctx_->output_alloc_attr(0), input_,
+        output_, [&note, &s](const Status& copy_status) {
+          s = copy_status;
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!s.ok()) {
+      done(s);
+      return;
+    }
+  }
+
+  AllocatorAttributes attr = ctx_->output_alloc_attr(0);
+  ca_.reset(MakeCollectiveAdapter(output_, LargestPowerOfTwo(peers_.size()),
+                                  device_->GetAllocator(attr)));
+  s = PrepareFinalOp();
+  if (s.ok()) {
+    s = RunReduction();
+  }
+  // Recover the output from the adaptor.
+  ca_->ConsumeFinalValue(output_);
+  {
+    // Report the first error, which may have come from another device.
+    mutex_lock l(status_mu_);
+    if (!status_.ok()) s = status_;
+  }
+  done(s);
+}
+
+Status RecursiveHalvingDoublingReducer::PrepareFinalOp() {
+  if (!col_params_.final_op) return Status::OK();
+  // Create an on-device scalar value from group_size_ for use as the
+  // final_op divisor.
+  Tensor group_size_val = ca_->Scalar(group_size_);
+  if (col_params_.group.device_type == "CPU") {
+    group_size_tensor_ = group_size_val;
+    return Status::OK();
+  }
+  group_size_tensor_ =
+      ca_->Scalar(device_->GetAllocator(ctx_->input_alloc_attr(0)));
+  Notification note;
+  Status s;
+  ctx_->op_device_context()->CopyCPUTensorToDevice(
+      &group_size_val, device_, &group_size_tensor_,
+      [&note, &s](const Status& copy_status) {
+        s = copy_status;
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return s;
+}
+
+Status RecursiveHalvingDoublingReducer::RunReduction() {
+  return AllReduceAmongPeers();
+}
+
+Status RecursiveHalvingDoublingReducer::AllReduceAmongPeers() {
+  if (peer_rank_ < 0) return Status::OK();
+  const int num_peers = static_cast<int>(peers_.size());
+  const int num_chunks = LargestPowerOfTwo(num_peers);
+  const int num_extra = num_peers - num_chunks;
+  const int my_dev = peers_[peer_rank_];
+  Tensor whole = ca_->ChunkRangeAlias(0, num_chunks);
+
+  // Fold the excess devices in: among the first 2 * num_extra peers each
+  // even one hands its value to the next odd one and sits out until the
+  // final value comes back.
+  int vrank;
+  if (peer_rank_ < 2 * num_extra) {
+    if ((peer_rank_ % 2) == 0) {
+      const int partner = peers_[peer_rank_ + 1];
+      TF_RETURN_IF_ERROR(SendRecv(partner, BufKey("fold", 0, my_dev, partner),
+                                  &whole, -1, "", nullptr));
+      return SendRecv(-1, "", nullptr, partner,
+                      BufKey("fold", 1, partner, my_dev), &whole);
+    }
+    const int partner = peers_[peer_rank_ - 1];
+    Tensor tmp = ca_->TempChunkRange(0, num_chunks);
+    TF_RETURN_IF_ERROR(SendRecv(-1, "", nullptr, partner,
+                                BufKey("fold", 0, partner, my_dev), &tmp));
+    if (tmp.NumElements() > 0) {
+      TF_RETURN_IF_ERROR(Reduce(&whole, &tmp));
+    }
+    vrank = peer_rank_ / 2;
+  } else {
+    vrank = peer_rank_ - num_extra;
+  }
+  // Maps a rank among the num_chunks remaining participants to a device.
+  auto vrank_dev = [this, num_extra](int r) {
+    return peers_[(r < num_extra) ? (2 * r + 1) : (r + num_extra)];
+  };
+
+  // Recursive halving: reduce-scatter so that chunk vrank ends up fully
+  // reduced on this device.
+  int step = 0;
+  int lo = 0;
+  int hi = num_chunks;
+  for (int dist = num_chunks / 2; dist >= 1; dist /= 2, ++step) {
+    const int partner = vrank_dev(vrank ^ dist);
+    const int mid = lo + (hi - lo) / 2;
+    const bool keep_upper = (vrank & dist) != 0;
+    const int keep_lo = keep_upper ? mid : lo;
+    const int keep_hi = keep_upper ? hi : mid;
+    const int send_lo = keep_upper ? lo : mid;
+    const int send_hi = keep_upper ? mid : hi;
+    Tensor send_chunk = ca_->ChunkRangeAlias(send_lo, send_hi);
+    Tensor keep_chunk = ca_->ChunkRangeAlias(keep_lo, keep_hi);
+    Tensor tmp = ca_->TempChunkRange(keep_lo, keep_hi);
+    TF_RETURN_IF_ERROR(SendRecv(partner, BufKey("rs", step, my_dev, partner),
+                                &send_chunk, partner,
+                                BufKey("rs", step, partner, my_dev), &tmp));
+    if (tmp.NumElements() > 0) {
+      TF_RETURN_IF_ERROR(Reduce(&keep_chunk, &tmp));
+    }
+    lo = keep_lo;
+    hi = keep_hi;
+  }
+  DCHECK_EQ(lo, vrank);
+  Tensor my_chunk = ca_->ChunkRangeAlias(lo, hi);
+  if (my_chunk.NumElements() > 0) {
+    TF_RETURN_IF_ERROR(Finalize(&my_chunk));
+  }
+
+  // Recursive doubling: all-gather the fully reduced chunks.
+  for (int dist = 1; dist < num_chunks; dist *= 2, ++step) {
+    const int partner_vrank = vrank ^ dist;
+    const int partner = vrank_dev(partner_vrank);
+    const int my_lo = (vrank / dist) * dist;
+    const int partner_lo = (partner_vrank / dist) * dist;
+    Tensor send_chunk = ca_->ChunkRangeAlias(my_lo, my_lo + dist);
+    Tensor recv_chunk = ca_->ChunkRangeAlias(partner_lo, partner_lo + dist);
+    TF_RETURN_IF_ERROR(SendRecv(partner, BufKey("ag", step, my_dev, partner),
+                                &send_chunk, partner,
+                                BufKey("ag", step, partner, my_dev),
+                                &recv_chunk));
+  }
+
+  // Return the final value to a folded-in partner.
+  if (peer_rank_ < 2 * num_extra) {
+    const int partner = peers_[peer_rank_ - 1];
+    TF_RETURN_IF_ERROR(SendRecv(partner, BufKey("fold", 1, my_dev, partner),
+                                &whole, -1, "", nullptr));
+  }
+  return Status::OK();
+}
+
+Status RecursiveHalvingDoublingReducer::SendRecv(int send_to,
+                                                 const string& send_key,
+                                                 const Tensor* send_tensor,
+                                                 int recv_from,
+                                                 const string& recv_key,
+                                                 Tensor* recv_tensor) {
+  const bool do_send = (send_to >= 0) && (send_tensor->NumElements() > 0);
+  const bool do_recv = (recv_from >= 0) && (recv_tensor->NumElements() > 0);
+  BlockingCounter pending(static_cast<int>(do_send) +
+                          static_cast<int>(do_recv));
+  mutex mu;
+  Status status;
+  auto done = [&pending, &mu, &status](const Status& s) {
+    {
+      mutex_lock l(mu);
+      status.Update(s);
+    }
+    pending.DecrementCount();
+  };
+  if (do_send) {
+    VLOG(3) << "SendRecv " << device_name_ << " send key " << send_key;
+    col_exec_->PostToPeer(col_params_.instance.device_names[send_to],
+                          col_params_.instance.task_names[send_to], send_key,
+                          device_, ctx_->op_device_context(),
+                          ctx_->output_alloc_attr(0), send_tensor,
+                          device_locality_, done);
+  }
+  if (do_recv) {
+    VLOG(3) << "SendRecv " << device_name_ << " recv key " << recv_key;
+    col_exec_->RecvFromPeer(col_params_.instance.device_names[recv_from],
+                            col_params_.instance.task_names[recv_from],
+                            col_params_.task.is_local[recv_from], recv_key,
+                            device_, ctx_->op_device_context(),
+                            ctx_->output_alloc_attr(0), recv_tensor,
+                            device_locality_, done);
+  }
+  pending.Wait();
+  if (!status.ok()) {
+    StartAbort(status);
+  }
+  return status;
+}
+
+Status RecursiveHalvingDoublingReducer::Reduce(Tensor* output, Tensor* input) {
+  Status s = ComputeBinOp(ctx_, op_params_, device_,
+                          col_params_.merge_op.get(), output, input);
+  if (!s.ok()) StartAbort(s);
+  return s;
+}
+
+Status RecursiveHalvingDoublingReducer::Finalize(Tensor* chunk) {
+  if (!col_params_.final_op) return Status::OK();
+  Status s = ComputeBinOp(ctx_, op_params_, device_,
+                          col_params_.final_op.get(), chunk,
+                          &group_size_tensor_);
+  if (!s.ok()) StartAbort(s);
+  return s;
+}
+
+string RecursiveHalvingDoublingReducer::BufKey(const string& tag, int step,
+                                               int from_dev,
+                                               int to_dev) const {
+  return strings::StrCat(exec_key_, ":", tag, ":", step, ":", from_dev, ":",
+                         to_dev);
+}
+
+void RecursiveHalvingDoublingReducer::StartAbort(const Status& s) {
+  // Only the first error starts an abort on the CollectiveExecutor, which
+  // in turn cancels the outstanding transfers of every device.
+  bool abort_started = false;
+  {
+    mutex_lock l(status_mu_);
+    if (status_.ok()) {
+      LOG(ERROR) << "Aborting RecursiveHalvingDoublingReduce with " << s;
+      abort_started = true;
+      status_.Update(s);
+    }
+  }
+  if (abort_started) {
+    col_exec_->StartAbort(s);
+  }
+}
+
+}  // namespace tensorflow
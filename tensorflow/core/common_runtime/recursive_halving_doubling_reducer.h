@@ -0,0 +1,119 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_RECURSIVE_HALVING_DOUBLING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_RECURSIVE_HALVING_DOUBLING_REDUCER_H_
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
+
+namespace tensorflow {
+class DeviceMgr;
+
+// Recursive halving-doubling implementation of collective all-reduce.
+//
+// With P a power of two, the tensor is divided into P chunks.  In each of
+// log2(P) halving steps a device exchanges half of the chunks it is still
+// responsible for with a partner and reduces the half it keeps, so that
+// afterwards it holds one fully reduced chunk.  The same partners are then
+// visited in reverse order, doubling the fully reduced range at each step.
+// That is 2 * log2(P) steps against the 2 * (P - 1) steps of RingReducer,
+// which matters for small, latency-bound tensors.  When the number of
+// devices is not a power of two the excess devices first fold their values
+// into a partner and receive the final value from it at the end.
+class RecursiveHalvingDoublingReducer
+    : public CollectiveImplementationInterface {
+ public:
+  RecursiveHalvingDoublingReducer(CollectiveExecutor* col_exec,
+                                  const DeviceMgr* dev_mgr,
+                                  OpKernelContext* ctx,
+                                  OpKernelContext::Params* op_params,
+                                  const CollectiveParams& col_params,
+                                  const string& exec_key, int64 step_id,
+                                  const Tensor* input, Tensor* output);
+
+  ~RecursiveHalvingDoublingReducer() override {}
+
+  void Run(StatusCallback done) override;
+
+  // Returns the largest power of two that is <= n, for n > 0.
+  static int LargestPowerOfTwo(int n);
+
+ protected:
+  // Reduces the value held by ca_ in place.  The default implementation
+  // all-reduces among every device in the group; subclasses may compose
+  // AllReduceAmongPeers with other data movement.
+  virtual Status RunReduction();
+
+  // All-reduces the value held by ca_ among the devices in peers_, which
+  // are indices into col_params_.instance.device_names.  This device must
+  // be peers_[peer_rank_].
+  Status AllReduceAmongPeers();
+
+  // Posts send_tensor to the device with index send_to and receives
+  // recv_tensor from the device with index recv_from, concurrently, and
+  // blocks until both complete.  Either half is skipped if its device
+  // index is negative or its tensor is empty.
+  Status SendRecv(int send_to, const string& send_key,
+                  const Tensor* send_tensor, int recv_from,
+                  const string& recv_key, Tensor* recv_tensor);
+
+  // Merges input into output in place with col_params_.merge_op.
+  Status Reduce(Tensor* output, Tensor* input);
+
+  // Applies col_params_.final_op, if any, to chunk in place.
+  Status Finalize(Tensor* chunk);
+
+  // Returns the BufRendezvous key for a transfer from device index
+  // from_dev to device index to_dev, unique to tag and step.
+  string BufKey(const string& tag, int step, int from_dev, int to_dev) const;
+
+  // Called when a bad status is received that implies we should terminate
+  // execution and return a bad status.
+  void StartAbort(const Status& s);
+
+  CollectiveExecutor* col_exec_;        // Not owned
+  const DeviceMgr* dev_mgr_;            // Not owned
+  OpKernelContext* ctx_;                // Not owned
+  OpKernelContext::Params* op_params_;  // Not owned
+  const CollectiveParams& col_params_;
+  const string exec_key_;
+  const Tensor* input_;  // Not owned
+  Tensor* output_;       // Not owned
+  const int64 step_id_;
+  const int group_size_;
+  const string device_name_;
+  Device* device_;  // The device for which this instance labors
+  DeviceLocality device_locality_;
+  std::unique_ptr<CollectiveAdapter> ca_;
+  Tensor group_size_tensor_;
+
+  // Devices taking part in AllReduceAmongPeers, and the position of this
+  // device among them, or -1 if it does not take part.  The tensor is
+  // divided into LargestPowerOfTwo(peers_.size()) chunks.
+  std::vector<int> peers_;
+  int peer_rank_;
+
+ private:
+  Status PrepareFinalOp();
+
+  mutex status_mu_;
+  Status status_ GUARDED_BY(status_mu_);
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_RECURSIVE_HALVING_DOUBLING_REDUCER_H_
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/ring_reducer.h"
 
+#include "tensorflow/core/common_runtime/collective_compression.h"
 #include "tensorflow/core/common_runtime/collective_rma_local.h"
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -147,6 +148,15 @@ void RingReducer::Run(StatusCallback done) {
   }
   CHECK(device_);
   device_locality_ = device_->attributes().locality();
+  if (compressing() && (col_params_.instance.data_type != DT_FLOAT ||
+                        col_params_.group.device_type != "CPU")) {
+    done_(errors::Unimplemented(
+        "Compressed collective reduction requires DT_FLOAT values on CPU "
+        "devices, got ",
+        DataTypeString(col_params_.instance.data_type), " on ",
+        col_params_.group.device_type.type()));
+    return;
+  }
 
   VLOG(1) << this << " default_rank " << col_params_.default_rank << " cp "
           << &col_params_ << ": " << col_params_.ToString();
@@ -174,6 +184,18 @@ void RingReducer::ContinueAfterInputCopy() {
   AllocatorAttributes attr = ctx_->output_alloc_attr(0);
   ca_.reset(MakeCollectiveAdapter(output_, group_size_ * num_subdivs_,
                                   device_->GetAllocator(attr)));
+  if (compressing() && col_params_.residual != nullptr) {
+    if (col_params_.residual->shape() != output_->shape()) {
+      done_(errors::Internal("Residual shape ",
+                             col_params_.residual->shape().DebugString(),
+                             " does not match ",
+                             output_->shape().DebugString()));
+      return;
+    }
+    residual_ca_.reset(MakeCollectiveAdapter(col_params_.residual,
+                                             group_size_ * num_subdivs_,
+                                             device_->GetAllocator(attr)));
+  }
 
   if (col_params_.final_op) {
     // Create an on-device scalar value from group_size_ that may be needed
@@ -310,6 +332,19 @@ void RingReducer::InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
     rf->tmp_chunk = ca_->TempChunk(rf->sc_idx);
     CHECK(rf->tmp_chunk.IsAligned()) << rf->DebugString();
   }
+  if (compressing() && (rf->do_send || rf->do_recv)) {
+    // The same buffer serves every transfer of the field, which never
+    // overlap.
+    rf->wire = Tensor(device_->GetAllocator(ctx_->output_alloc_attr(0)),
+                      DT_UINT8,
+                      TensorShape({CompressedBytes(
+                          col_params_.instance.compression,
+                          col_params_.instance.top_k_fraction,
+                          rf->chunk.NumElements())}));
+    if (residual_ca_) {
+      rf->residual = residual_ca_->ChunkAlias(rf->sc_idx);
+    }
+  }
   VLOG(2) << this << " InitRingField " << rf->DebugString() << " chunk "
           << ca_->TBounds(rf->chunk);
 }
@@ -346,6 +381,28 @@ string RingReducer::RingField::DebugString() const {
 
 void RingReducer::DispatchSend(RingField* rf, const StatusCallback& done) {
   CHECK(rf->do_send);
+  const Tensor* send_tensor = &rf->chunk;
+  if (compressing()) {
+    // In the second pass a device that received the field forwards the
+    // encoding as it came, the others encode their own value.
+    if (!rf->second_pass || !rf->do_recv) {
+      const CollectiveCompression compression =
+          col_params_.instance.compression;
+      const float top_k_fraction = col_params_.instance.top_k_fraction;
+      Status s = CompressChunk(
+          compression, top_k_fraction, rf->chunk,
+          rf->residual.IsInitialized() ? &rf->residual : nullptr, &rf->wire);
+      if (s.ok() && rf->second_pass) {
+        // Keep the value that the other devices will decode.
+        s = DecompressChunk(compression, top_k_fraction, rf->wire, &rf->chunk);
+      }
+      if (!s.ok()) {
+        done(s);
+        return;
+      }
+    }
+    send_tensor = &rf->wire;
+  }
   string send_buf_key =
       RingReduceBufKey(exec_key_, rf->second_pass, rf->sc_idx, rf->rank);
   VLOG(3) << "DispatchSend rank=" << col_params_.default_rank << " send key "
@@ -357,10 +414,16 @@ void RingReducer::DispatchSend(RingField* rf, const StatusCallback& done) {
   col_exec_->PostToPeer(col_params_.instance.device_names[send_to_dev_idx],
                         col_params_.instance.task_names[send_to_dev_idx],
                         send_buf_key, device_, ctx_->op_device_context(),
-                        ctx_->output_alloc_attr(0), &rf->chunk,
+                        ctx_->output_alloc_attr(0), send_tensor,
                         device_locality_, done);
 }
 
+Tensor* RingReducer::RecvDestination(RingField* rf) {
+  return (!rf->second_pass && (col_params_.merge_op != nullptr))
+             ? &rf->tmp_chunk
+             : &rf->chunk;
+}
+
 void RingReducer::DispatchRecv(RingField* rf, const StatusCallback& done) {
   CHECK(rf->do_recv);
   string recv_buf_key =
@@ -369,9 +432,7 @@ void RingReducer::DispatchRecv(RingField* rf, const StatusCallback& done) {
   VLOG(3) << "DispatchRecv rank=" << col_params_.default_rank << " recv key "
           << recv_buf_key << " chunk " << ca_->TBounds(rf->chunk) << " into "
           << ((col_params_.merge_op != nullptr) ? "tmp_chunk" : "chunk");
-  Tensor* dst_tensor = (!rf->second_pass && (col_params_.merge_op != nullptr))
-                           ? &rf->tmp_chunk
-                           : &rf->chunk;
+  Tensor* dst_tensor = compressing() ? &rf->wire : RecvDestination(rf);
   col_exec_->RecvFromPeer(col_params_.instance.device_names[rf->recv_dev_idx],
                           col_params_.instance.task_names[rf->recv_dev_idx],
                           col_params_.task.is_local[rf->recv_dev_idx],
@@ -451,6 +512,15 @@ bool RingReducer::RunAsyncParts() {
         case RF_RECV:
           CHECK_GT(recv_pending_count, 0);
           --recv_pending_count;
+          if (compressing()) {
+            Status s = DecompressChunk(col_params_.instance.compression,
+                                       col_params_.instance.top_k_fraction,
+                                       rf->wire, RecvDestination(rf));
+            if (!s.ok()) {
+              aborted = true;
+              StartAbort(s);
+            }
+          }
           if (!rf->second_pass) {
             rf->action = RF_REDUCE;
             Status s = ComputeBinOp(device_, col_params_.merge_op.get(),
@@ -25,16 +25,24 @@ namespace tensorflow {
 class DeviceMgr;
 
 // Ring-algorithm implementation of collective all-reduce.
-class RingReducer {
+//
+// If col_params.instance.compression is set, chunks are encoded before they
+// are sent and decoded when received, see collective_compression.h.  Each
+// device encodes the partial sums it sends in the first pass and the final
+// values it owns at the start of the second pass, feeding the encoding error
+// back through col_params.residual when it is provided; the second pass
+// forwards the encodings it receives unchanged, so that every device ends
+// with the same value.
+class RingReducer : public CollectiveImplementationInterface {
  public:
   RingReducer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
               OpKernelContext* ctx, OpKernelContext::Params* op_params,
               const CollectiveParams& col_params, const string& exec_key,
               int64 step_id, const Tensor* input, Tensor* output);
 
-  virtual ~RingReducer() {}
+  ~RingReducer() override {}
 
-  void Run(StatusCallback done);
+  void Run(StatusCallback done) override;
 
  private:
   // Called when a bad status is received that implies we should terminate
@@ -45,6 +53,9 @@ class RingReducer {
   Status ComputeBinOp(Device* device, OpKernel* op, Tensor* output,
                       Tensor* input);
   bool RunAsyncParts();
+  bool compressing() const {
+    return col_params_.instance.compression != NO_COMPRESSION;
+  }
 
   // Used for executing a sub-operation, e.g. a merge_op instance, with
   // an OpKernelContext based on the one passed into this Op.
@@ -90,6 +101,8 @@ class RingReducer {
     bool is_final = false;  // is the last field in the pass for this rank
     Tensor chunk;           // alias to field values
     Tensor tmp_chunk;
+    Tensor wire;      // encoding of the field sent or received, if compressing
+    Tensor residual;  // alias to the field's error-feedback residual
     Status status;
     string DebugString() const;
   };
@@ -98,6 +111,8 @@ class RingReducer {
                      int field_idx);
   void DispatchSend(RingField* rf, const StatusCallback& done);
   void DispatchRecv(RingField* rf, const StatusCallback& done);
+  // Returns the tensor into which the value received for rf is placed.
+  Tensor* RecvDestination(RingField* rf);
 
   // For constructing log messages for debugging.
   string FieldState();
@@ -131,6 +146,8 @@ class RingReducer {
   Tensor group_size_tensor_;
   Notification group_size_tensor_ready_;
   std::unique_ptr<CollectiveAdapter> ca_;
+  // Chunks col_params_.residual the same way as the output, if compressing.
+  std::unique_ptr<CollectiveAdapter> residual_ca_;
   StatusCallback done_;
   Device* device_;  // The device for which this instance labors
   const string device_name_;
@@ -349,6 +349,45 @@ class RingReducerTest : public ::testing::Test {
     }
   }
 
+  // Reduces small float values with the given compression and checks that
+  // every device ends up with the same result, within tolerance of the
+  // uncompressed one.
+  void RunCompressedTest(CollectiveCompression compression,
+                         float top_k_fraction, bool use_residual,
+                         int num_workers, int num_devices, int num_subdivs,
+                         int tensor_len, float tolerance) {
+    col_params_.instance.compression = compression;
+    col_params_.instance.top_k_fraction = top_k_fraction;
+    use_residual_ = use_residual;
+    Init(num_workers, num_devices, DT_FLOAT, DEVICE_CPU, num_subdivs, 0);
+    std::vector<float> expected(tensor_len, 0.0);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      instances_[di]->InitTensor(
+          DT_FLOAT, TensorShape({tensor_len}), [&expected, di](Tensor* t) {
+            for (size_t i = 0; i < t->NumElements(); ++i) {
+              float value = ((i * 7 + di * 13) % 100) / 100.0f;
+              t->flat<float>()(i) = value;
+              expected[i] += value;
+            }
+          });
+    }
+    Reduce();
+    const Tensor& first = instances_[0]->tensor_;
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      TF_EXPECT_OK(instances_[di]->status_);
+      const Tensor& actual = instances_[di]->tensor_;
+      for (int i = 0; i < tensor_len; ++i) {
+        EXPECT_NEAR(expected[i] / (num_workers * num_devices),
+                    actual.flat<float>()(i), tolerance)
+            << "Mismatch at device " << di << " index " << i;
+        // The owner of each chunk decodes its own encoding, so that the
+        // devices agree exactly.
+        EXPECT_EQ(first.flat<float>()(i), actual.flat<float>()(i))
+            << "Disagreement at device " << di << " index " << i;
+      }
+    }
+  }
+
   std::unique_ptr<OpKernel> GetCollectiveReduce(const CollectiveParams& params,
                                                 Tensor* input,
                                                 const DeviceType& device_type,
@@ -480,6 +519,13 @@ class RingReducerTest : public ::testing::Test {
                                                        &output_tensor_ptr));
       CHECK_EQ(output_tensor_ptr, ctx.mutable_output(0));
 
+      if (col_params_.instance.compression != NO_COMPRESSION &&
+          parent_->use_residual_) {
+        residual_ = Tensor(DT_FLOAT, tensor_.shape());
+        residual_.flat<float>().setZero();
+        col_params_.residual = &residual_;
+      }
+
       // Prepare a RingReducer instance.
       string exec_key =
           strings::StrCat(col_params_.instance.instance_key, ":0:0");
@@ -508,6 +554,7 @@ class RingReducerTest : public ::testing::Test {
     DeviceType device_type_;
     int rank_;
     Tensor tensor_;
+    Tensor residual_;
     Device* device_;
     CollectiveParams col_params_;
     std::unique_ptr<CollectiveAdapter> ca_;
@@ -516,6 +563,7 @@ class RingReducerTest : public ::testing::Test {
   };
 
   bool stop_ = false;
+  bool use_residual_ = false;
   DeviceType device_type_;
   TestCollectiveExecutorMgr col_exec_mgr_;
   CollectiveExecutor* col_exec_;
@@ -575,6 +623,39 @@ DEF_TEST(INT64, CPU, 2, 8, 3, 4095, 0)
 // Failure tests
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 7)
 DEF_TEST(FLOAT, CPU, 2, 8, 2, 9408, 11)
+
+// Compression tests
+TEST_F(RingReducerTest, CompressFp16) {
+  RunCompressedTest(FP16_COMPRESSION, 0.01f, true, 2, 4, 1, 1001, 5e-3f);
+}
+TEST_F(RingReducerTest, CompressBfloat16) {
+  RunCompressedTest(BFLOAT16_COMPRESSION, 0.01f, true, 2, 4, 2, 1001, 3e-2f);
+}
+TEST_F(RingReducerTest, CompressInt8) {
+  RunCompressedTest(INT8_COMPRESSION, 0.01f, true, 2, 4, 1, 4096, 5e-2f);
+}
+TEST_F(RingReducerTest, CompressInt8WithoutResidual) {
+  RunCompressedTest(INT8_COMPRESSION, 0.01f, false, 1, 2, 1, 16, 5e-2f);
+}
+TEST_F(RingReducerTest, CompressTopKKeepingAll) {
+  // Keeping every value makes the encoding lossless.
+  RunCompressedTest(TOP_K_COMPRESSION, 1.0f, true, 2, 4, 1, 1001, 1e-6f);
+}
+TEST_F(RingReducerTest, CompressTopK) {
+  RunCompressedTest(TOP_K_COMPRESSION, 0.1f, true, 1, 4, 1, 1001, 1.0f);
+}
+TEST_F(RingReducerTest, CompressRequiresFloat) {
+  col_params_.instance.compression = FP16_COMPRESSION;
+  Init(1, 2, DT_INT32, DEVICE_CPU, 1, 0);
+  for (auto di : instances_) {
+    di->InitTensor(DT_INT32, TensorShape({8}),
+                   [](Tensor* t) { t->flat<int32>().setZero(); });
+  }
+  Reduce();
+  for (auto di : instances_) {
+    EXPECT_EQ(error::UNIMPLEMENTED, di->status_.code());
+  }
+}
 #endif
 
 #ifdef GOOGLE_CUDA
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/rpc_metrics.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/types.h"
@@ -149,6 +150,21 @@ static bool IsLocalDevice(const StringPiece worker_name,
   return str_util::StartsWith(device_name, worker_name);
 }
 
+// Returns a callback that records the time until it is called as a wait of
+// the given kind, then calls "done".
+static Rendezvous::DoneCallback RecordWait(rpc_metrics::RendezvousWait kind,
+                                           Rendezvous::DoneCallback done) {
+  const int64 start_micros = Env::Default()->NowMicros();
+  return [kind, start_micros, done](const Status& s,
+                                    const Rendezvous::Args& send_args,
+                                    const Rendezvous::Args& recv_args,
+                                    const Tensor& val, bool is_dead) {
+    rpc_metrics::RecordRendezvousWait(kind, start_micros,
+                                      Env::Default()->NowMicros());
+    done(s, send_args, recv_args, val, is_dead);
+  };
+}
+
 Status BaseRemoteRendezvous::Initialize(WorkerSession* session) {
   CHECK_NE(session, nullptr) << "session must not be null!";
   std::vector<DeferredCall> deferred_calls;
@@ -305,26 +321,31 @@ void BaseRemoteRendezvous::RecvAsync(const ParsedKey& parsed,
     // Recv the tensor from local_.
     local_->RecvAsync(
         parsed, recv_args,
-        [this, parsed, done](
-            const Status& status, const Rendezvous::Args& send_args,
-            const Rendezvous::Args& recv_args, const Tensor& in, bool is_dead) {
-          Tensor* out = new Tensor;
-          StatusCallback final_callback = [done, send_args, recv_args, out,
-                                           is_dead](const Status& s) {
-            done(s, send_args, recv_args, *out, is_dead);
-            delete out;
-          };
-
-          if (status.ok()) {
-            SameWorkerRecvDone(parsed, send_args, recv_args, in, out,
-                               std::move(final_callback));
-          } else {
-            final_callback(status);
-          }
-        });
+        RecordWait(
+            rpc_metrics::RendezvousWait::kLocal,
+            [this, parsed, done](const Status& status,
+                                 const Rendezvous::Args& send_args,
+                                 const Rendezvous::Args& recv_args,
+                                 const Tensor& in, bool is_dead) {
+              Tensor* out = new Tensor;
+              StatusCallback final_callback = [done, send_args, recv_args, out,
+                                               is_dead](const Status& s) {
+                done(s, send_args, recv_args, *out, is_dead);
+                delete out;
+              };
+
+              if (status.ok()) {
+                SameWorkerRecvDone(parsed, send_args, recv_args, in, out,
+                                   std::move(final_callback));
+              } else {
+                final_callback(status);
+              }
+            }));
     return;
   } else {
-    RecvFromRemoteAsync(parsed, recv_args, std::move(done));
+    RecvFromRemoteAsync(
+        parsed, recv_args,
+        RecordWait(rpc_metrics::RendezvousWait::kRemote, std::move(done)));
   }
 }
 
@@ -355,7 +376,9 @@ void BaseRemoteRendezvous::RecvLocalAsyncInternal(const ParsedKey& parsed,
     done(s, Args(), Args(), Tensor(), false);
     return;
   }
-  local_->RecvAsync(parsed, Args(), std::move(done));
+  local_->RecvAsync(
+      parsed, Args(),
+      RecordWait(rpc_metrics::RendezvousWait::kServe, std::move(done)));
 }
 
 void BaseRemoteRendezvous::StartAbort(const Status& s) {
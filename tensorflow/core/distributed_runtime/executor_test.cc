@@ -22,10 +22,12 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/graph_constructor.h"
+#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -410,4 +412,89 @@ TEST_F(ExecutorTest, RecvInvalidRefDtype) {
   rendez->Unref();
 }
 
+// Outputs its input, and as "info" the scope id of the allocator attributes
+// of its first output and whether the buffer of its input could be
+// forwarded to that output.
+REGISTER_OP("ForwardProbe")
+    .Input("x: float")
+    .Output("y: float")
+    .Output("info: int32");
+
+class ForwardProbeOp : public OpKernel {
+ public:
+  explicit ForwardProbeOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& x = ctx->input(0);
+    std::unique_ptr<Tensor> forwarded =
+        ctx->forward_input(0, 0, DT_FLOAT, x.shape(), DEVICE_MEMORY,
+                           ctx->output_alloc_attr(0));
+    Tensor* info = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(1, TensorShape({2}), &info));
+    info->vec<int32>()(0) = ctx->output_alloc_attr(0).scope_id;
+    info->vec<int32>()(1) = forwarded != nullptr;
+    ctx->set_output(0, x);
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("ForwardProbe").Device(DEVICE_CPU),
+                        ForwardProbeOp);
+
+class ForwardProbeTest : public ExecutorTest {
+ protected:
+  // Runs a ForwardProbe with the given attrs on a received tensor, and
+  // returns its "info" output.
+  std::vector<int32> RunProbe(
+      const std::vector<std::pair<string, std::vector<int>>>& attrs) {
+    std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+    Node* in = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+    NodeBuilder builder(g->NewName("n"), "ForwardProbe");
+    builder.Input(in);
+    for (const auto& attr : attrs) {
+      builder.Attr(attr.first, attr.second);
+    }
+    Node* probe;
+    TF_CHECK_OK(builder.Finalize(g.get(), &probe));
+    test::graph::Send(g.get(), test::graph::Identity(g.get(), probe, 1),
+                      "info", BOB, 1, ALICE);
+    Create(std::move(g));
+
+    // The test keeps a reference to the input, so its buffer may only be
+    // forwarded if the executor reserved it for the output.
+    const Tensor a = V(1.0);
+    Rendezvous::Args args;
+    TF_CHECK_OK(
+        rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, a, false));
+    TF_CHECK_OK(Run(rendez_));
+    Tensor info;
+    bool is_dead = false;
+    TF_CHECK_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "info"), args,
+                              &info, &is_dead));
+    return {info.vec<int32>()(0), info.vec<int32>()(1)};
+  }
+};
+
+TEST_F(ForwardProbeTest, NoAttrs) {
+  EXPECT_EQ(std::vector<int32>({0, 0}), RunProbe({}));
+}
+
+TEST_F(ForwardProbeTest, ForwardInput) {
+  // Input 0 is reserved for output 0.
+  EXPECT_EQ(std::vector<int32>({0, 1}), RunProbe({{"_forward_input", {0, 0}}}));
+}
+
+TEST_F(ForwardProbeTest, ScopedAllocator) {
+  // Output 0 is allocated with scope id 7, and never forwarded, even when
+  // a reservation asks for it.
+  EXPECT_EQ(std::vector<int32>({7, 0}),
+            RunProbe({{"_scoped_allocator", {0, 7}},
+                      {"_forward_input", {0, 0}}}));
+}
+
+TEST_F(ForwardProbeTest, IgnoresOutOfRangeOutputs) {
+  EXPECT_EQ(std::vector<int32>({0, 0}),
+            RunProbe({{"_scoped_allocator", {5, 7}},
+                      {"_forward_input", {0, 5}}}));
+}
+
 }  // namespace tensorflow
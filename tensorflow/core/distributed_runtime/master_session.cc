@@ -1554,6 +1554,7 @@ Status MasterSession::DoPartialRun(CallOptions* opts,
                                    const RunStepRequestWrapper& req,
                                    MutableRunStepResponseWrapper* resp) {
   auto cleanup = gtl::MakeCleanup([this] { MarkRunCompletion(); });
+  TF_RETURN_IF_ERROR(WaitForPipelinedSteps());
   const string& prun_handle = req.partial_run_handle();
   RunState* run_state = nullptr;
   {
@@ -1771,6 +1772,66 @@ Status MasterSession::PostRunCleanup(MasterSession::ReffedClientGraph* rcg,
   return s;
 }
 
+Status MasterSession::WaitForPipelinedSteps() {
+  mutex_lock l(mu_);
+  while (num_pipelined_steps_ > 0) {
+    pipelined_step_done_.wait(l);
+  }
+  Status s = pipelined_status_;
+  pipelined_status_ = Status::OK();
+  return s;
+}
+
+Status MasterSession::ReservePipelinedStep(int32 pipeline_depth) {
+  mutex_lock l(mu_);
+  while (num_pipelined_steps_ >= pipeline_depth) {
+    pipelined_step_done_.wait(l);
+  }
+  Status s = pipelined_status_;
+  pipelined_status_ = Status::OK();
+  if (s.ok()) {
+    ++num_pipelined_steps_;
+  }
+  return s;
+}
+
+void MasterSession::EndPipelinedStep(const Status& s) {
+  mutex_lock l(mu_);
+  if (!s.ok() && pipelined_status_.ok()) {
+    pipelined_status_ = s;
+  }
+  --num_pipelined_steps_;
+  pipelined_step_done_.notify_all();
+}
+
+void MasterSession::StartPipelinedStep(ReffedClientGraph* rcg, uint64 step_id,
+                                       int64 count, const PerStepState& pss,
+                                       const RunStepRequestWrapper& req) {
+  // The feeds are copied, as the client may reuse `req` once Run() returns.
+  std::shared_ptr<RunStepRequest> step_req(new RunStepRequest(req.ToProto()));
+  std::shared_ptr<PerStepState> step_pss(new PerStepState(pss));
+  Ref();
+  rcg->Ref();
+  SchedClosure([this, rcg, step_id, count, step_req, step_pss]() {
+    ProtoRunStepRequest wrapped_req(step_req.get());
+    OwnedProtoRunStepResponse resp;
+    CallOptions opts;
+    std::unique_ptr<ProfileHandler> ph;
+    Status s = rcg->RunPartitions(env_, step_id, count, step_pss.get(), &opts,
+                                  wrapped_req, &resp, &cancellation_manager_,
+                                  false);
+    s = PostRunCleanup(rcg, step_id, step_req->options(), step_pss.get(), ph,
+                       s, resp.mutable_metadata());
+    if (!s.ok()) {
+      s = Status(s.code(), strings::StrCat("Pipelined step ", step_id,
+                                           " failed: ", s.error_message()));
+    }
+    EndPipelinedStep(s);
+    rcg->Unref();
+    Unref();
+  });
+}
+
 Status MasterSession::DoRunWithLocalExecution(
     CallOptions* opts, const RunStepRequestWrapper& req,
     MutableRunStepResponseWrapper* resp) {
@@ -1779,6 +1840,20 @@ Status MasterSession::DoRunWithLocalExecution(
   pss.start_micros = Env::Default()->NowMicros();
   auto cleanup = gtl::MakeCleanup([this] { MarkRunCompletion(); });
 
+  // A pipelined step may start while others are running; any other step
+  // waits for them to end.
+  const int32 pipeline_depth = req.options().pipeline_depth();
+  const bool pipelined = pipeline_depth > 0 && req.num_fetches() == 0;
+  if (pipelined) {
+    TF_RETURN_IF_ERROR(ReservePipelinedStep(pipeline_depth));
+  } else {
+    TF_RETURN_IF_ERROR(WaitForPipelinedSteps());
+  }
+  // Ends the reserved step if it does not run in the background after all.
+  auto end_pipelined_step = gtl::MakeCleanup([this, pipelined] {
+    if (pipelined) EndPipelinedStep(Status::OK());
+  });
+
   // Prepare.
   BuildGraphOptions bgopts;
   BuildBuildGraphOptions(req, &bgopts);
@@ -1806,6 +1881,16 @@ Status MasterSession::DoRunWithLocalExecution(
   std::unique_ptr<ProfileHandler> ph;
   FillPerStepState(rcg, req.options(), step_id, count, &pss, &ph);
 
+  // Steps that report statistics or tensors to the debugger run to their
+  // end, as their RunMetadata goes back to the client.
+  if (pipelined && debugger_state == nullptr && !pss.collect_timeline &&
+      !pss.collect_costs && !pss.collect_partition_graphs) {
+    cleanup.release();  // MarkRunCompletion called in PostRunCleanup().
+    end_pipelined_step.release();  // Ended by the background step.
+    StartPipelinedStep(rcg, step_id, count, pss, req);
+    return Status::OK();
+  }
+
   Status s = rcg->RunPartitions(env_, step_id, count, &pss, opts, req, resp,
                                 &cancellation_manager_, false);
   cleanup.release();  // MarkRunCompletion called in PostRunCleanup().
@@ -1860,6 +1945,7 @@ Status MasterSession::DoRunCallable(CallOptions* opts, ReffedClientGraph* rcg,
   PerStepState pss;
   pss.start_micros = Env::Default()->NowMicros();
   auto cleanup = gtl::MakeCleanup([this] { MarkRunCompletion(); });
+  TF_RETURN_IF_ERROR(WaitForPipelinedSteps());
 
   // Prepare.
   int64 count = rcg->get_and_increment_execution_count();
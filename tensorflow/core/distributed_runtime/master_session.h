@@ -195,6 +195,13 @@ class MasterSession : public core::RefCounted {
   condition_variable num_running_is_zero_;
   int32 num_running_ GUARDED_BY(mu_) = 0;
 
+  // RunStep calls that returned before their step ended, see
+  // RunOptions.pipeline_depth.
+  condition_variable pipelined_step_done_;
+  int32 num_pipelined_steps_ GUARDED_BY(mu_) = 0;
+  // First error of the pipelined steps that is not yet returned.
+  Status pipelined_status_ GUARDED_BY(mu_);
+
   bool closed_ GUARDED_BY(mu_) = false;
   bool garbage_collected_ GUARDED_BY(mu_) = false;
 
@@ -236,6 +243,27 @@ class MasterSession : public core::RefCounted {
   Status DoRunCallable(CallOptions* opts, ReffedClientGraph* rcg,
                        const RunCallableRequest& req,
                        RunCallableResponse* resp);
+  // Waits until no pipelined step is running, and returns the first error of
+  // the ended ones that is not yet returned.
+  Status WaitForPipelinedSteps();
+
+  // Waits until fewer than `pipeline_depth` pipelined steps are running and
+  // counts one more, in the same critical section, so that concurrent calls
+  // never exceed the depth. Returns the first error of the ended steps that
+  // is not yet returned, in which case no step is counted. The step must be
+  // ended with EndPipelinedStep().
+  Status ReservePipelinedStep(int32 pipeline_depth);
+
+  // Ends a step counted by ReservePipelinedStep(). Its error, if any, is
+  // reported by the next step that waits for the pipelined ones.
+  void EndPipelinedStep(const Status& s);
+
+  // Runs the step of `req` in the background, in a slot reserved with
+  // ReservePipelinedStep(), which it ends.
+  void StartPipelinedStep(ReffedClientGraph* rcg, uint64 step_id, int64 count,
+                          const PerStepState& pss,
+                          const RunStepRequestWrapper& req);
+
   Status PostRunCleanup(MasterSession::ReffedClientGraph* rcg, uint64 step_id,
                         const RunOptions& run_options, PerStepState* pss,
                         const std::unique_ptr<ProfileHandler>& ph,
@@ -359,6 +359,41 @@ TEST_F(MasterTest, ConcurrentExtendAndRun) {
   TF_ASSERT_OK(CloseSession(handle));
 }
 
+TEST_F(MasterTest, PipelinedSteps) {
+  Graph graph(OpRegistry::Global());
+  Tensor a_tensor(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&a_tensor, {3, 2, -1, 0});
+  Node* a_node = test::graph::Constant(&graph, a_tensor);
+  Tensor x_tensor(DT_FLOAT, TensorShape({2, 1}));
+  test::FillValues<float>(&x_tensor, {2, 1});
+  Node* x_node = test::graph::Constant(&graph, x_tensor);
+  Node* y_node = test::graph::Matmul(&graph, a_node, x_node, false, false);
+  GraphDef def;
+  test::graph::ToGraphDef(&graph, &def);
+
+  string handle;
+  int64 initial_version;
+  TF_CHECK_OK(CreateSession(def, &handle, &initial_version));
+
+  // Steps that only run targets return before they end.
+  for (int i = 0; i < 10; ++i) {
+    ::grpc::ClientContext ctx;
+    RunStepRequest req;
+    req.set_session_handle(handle);
+    req.add_target(y_node->name());
+    req.mutable_options()->set_pipeline_depth(3);
+    RunStepResponse resp;
+    TF_EXPECT_OK(FromGrpcStatus(master_->RunStep(&ctx, req, &resp)));
+  }
+
+  // A step that fetches waits for them.
+  Tensor y(DT_FLOAT, TensorShape({2, 1}));
+  TF_EXPECT_OK(RunStep(handle, {}, {{y_node->name() + ":0", &y}}));
+  test::ExpectTensorEqual<float>(
+      y, test::AsTensor<float>({8, -2}, TensorShape({2, 1})));
+  TF_EXPECT_OK(CloseSession(handle));
+}
+
 TEST_F(MasterTest, EigenProblem) {
   // A = [3 2; -1 0]; x = rand(2, 1);
   // for i=1:100; x = A * x; end
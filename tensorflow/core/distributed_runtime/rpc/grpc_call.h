@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CALL_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CALL_H_
 
+#include <deque>
+
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 
@@ -52,6 +55,11 @@ namespace tensorflow {
 //   `Call` type, in order to access its state, and invoke its
 //   `SendResponse()` method.
 //
+// * `ServerStreamingCall<Service, GrpcService, Req, Resp>`: Like
+//   `Call`, but for a method that returns a stream of responses, which
+//   are either all passed to its `SendResponses()` method, or passed one
+//   at a time to `WriteResponse()` followed by `Finish()`.
+//
 // The lifecycle of a call object is as follows.
 //
 // 1. A `Service` creates a `Call` for a particular method and
@@ -95,13 +103,22 @@ class UntypedCall : public core::RefCounted {
   // the `grpc::ServerContext` associated with the request.
   virtual void RequestCancelled(Service* service, bool ok) = 0;
 
+  // This method will be called when a response of a streaming call has been
+  // written, and `ok` is false if the stream is broken.
+  virtual void ResponseWritten(Service* service, bool ok) {}
+
   // Associates a tag in a `::grpc::CompletionQueue` with a callback
   // for an incoming RPC.  An active Tag owns a reference on the corresponding
   // Call object.
   class Tag {
    public:
     // One enum value per supported callback.
-    enum Callback { kRequestReceived, kResponseSent, kCancelled };
+    enum Callback {
+      kRequestReceived,
+      kResponseWritten,
+      kResponseSent,
+      kCancelled
+    };
 
     Tag(UntypedCall* call, Callback cb) : call_(call), callback_(cb) {}
 
@@ -113,6 +130,9 @@ class UntypedCall : public core::RefCounted {
         case kRequestReceived:
           call_->RequestReceived(service, ok);
           break;
+        case kResponseWritten:
+          call_->ResponseWritten(service, ok);
+          break;
         case kResponseSent:
           // No special handling needed apart from the Unref below.
           break;
@@ -263,6 +283,202 @@ class Call : public UntypedCall<Service> {
   std::function<void()> cancel_callback_ GUARDED_BY(mu_);
 };
 
+// Represents a pending call with known request and response message
+// types, and a known request-handling method, that returns a stream of
+// responses.
+template <class Service, class GrpcService, class RequestMessage,
+          class ResponseMessage>
+class ServerStreamingCall : public UntypedCall<Service> {
+ public:
+  // Represents the generic signature of a `Service::HandleFoo()`
+  // method, where `Foo` is the name of an RPC method.
+  using HandleRequestFunction = void (Service::*)(
+      ServerStreamingCall<Service, GrpcService, RequestMessage,
+                          ResponseMessage>*);
+
+  ServerStreamingCall(HandleRequestFunction handle_request_function)
+      : handle_request_function_(handle_request_function), writer_(&ctx_) {}
+
+  virtual ~ServerStreamingCall() {}
+
+  void RequestReceived(Service* service, bool ok) override {
+    if (ok) {
+      this->Ref();
+      (service->*handle_request_function_)(this);
+    }
+  }
+
+  // Writes `responses` one after the other, then finishes the call with
+  // `status`.  The responses are dropped if `status` is not OK, and the
+  // remaining ones if the stream breaks.
+  void SendResponses(std::vector<ResponseMessage> responses,
+                     ::grpc::Status status) {
+    if (status.ok()) {
+      for (ResponseMessage& response : responses) {
+        WriteResponse(std::move(response));
+      }
+    }
+    Finish(std::move(status));
+  }
+
+  // Writes `response` after the responses passed to the previous calls.
+  // Unlike SendResponses(), this may be called from several threads, each
+  // time a response becomes available.  The response is dropped if the
+  // stream has broken.
+  //
+  // REQUIRES: Finish() has not been called.
+  void WriteResponse(ResponseMessage response) {
+    mutex_lock l(write_mu_);
+    DCHECK(!finish_requested_);
+    if (broken_) return;
+    pending_responses_.push_back(std::move(response));
+    StartNextOperation();
+  }
+
+  // Finishes the call with `status` once the responses passed to
+  // WriteResponse() have been written.
+  void Finish(::grpc::Status status) {
+    bool finished;
+    {
+      mutex_lock l(write_mu_);
+      finish_requested_ = true;
+      status_ = std::move(status);
+      finished = StartNextOperation();
+    }
+    if (finished) {
+      this->Unref();  // Ref taken in RequestReceived().
+    }
+  }
+
+  void ResponseWritten(Service* service, bool ok) override {
+    bool finished;
+    {
+      mutex_lock l(write_mu_);
+      write_in_flight_ = false;
+      if (!ok) {
+        broken_ = true;
+        pending_responses_.clear();
+      }
+      finished = StartNextOperation();
+    }
+    if (finished) {
+      this->Unref();  // Ref taken in RequestReceived().
+    }
+  }
+
+  void RequestCancelled(Service* service, bool ok) override {
+    if (ctx_.IsCancelled()) {
+      mutex_lock l(mu_);
+      if (cancel_callback_) {
+        cancel_callback_();
+      }
+    }
+  }
+
+  // Registers `callback` as the function that should be called if and when this
+  // call is canceled by the client.
+  void SetCancelCallback(std::function<void()> callback) {
+    mutex_lock l(mu_);
+    cancel_callback_ = std::move(callback);
+  }
+
+  // Clears any cancellation callback that has been registered for this call.
+  void ClearCancelCallback() {
+    mutex_lock l(mu_);
+    cancel_callback_ = nullptr;
+  }
+
+  // Enqueues a new request for the given service on the given
+  // completion queue, using the given `method_id`.
+  //
+  // The request will be handled with the given
+  // `handle_request_function`.
+  static void EnqueueRequestForMethod(
+      GrpcService* grpc_service, ::grpc::ServerCompletionQueue* cq,
+      int method_id, HandleRequestFunction handle_request_function,
+      bool supports_cancel) {
+    auto call = new ServerStreamingCall<Service, GrpcService, RequestMessage,
+                                        ResponseMessage>(
+        handle_request_function);
+    if (supports_cancel) {
+      call->RegisterCancellationHandler();
+    }
+
+    // Initial ref for call handed to grpc; released in Tag callback.
+    grpc_service->RequestAsyncServerStreaming(
+        method_id, &call->ctx_, &call->request, &call->writer_, cq, cq,
+        &call->request_received_tag_);
+  }
+
+  RequestMessage request;
+
+  const std::multimap<::grpc::string_ref, ::grpc::string_ref>& client_metadata()
+      const {
+    return ctx_.client_metadata();
+  }
+
+ private:
+  // Creates a completion queue tag for handling cancellation by the client.
+  // NOTE: This method must be called before this call is enqueued on a
+  // completion queue.
+  void RegisterCancellationHandler() {
+    this->Ref();  // Ref for grpc; released in Tag callback.
+    ctx_.AsyncNotifyWhenDone(&cancelled_tag_);
+  }
+
+  // Writes the next pending response, or finishes the call once none is
+  // left and Finish() has been called.  gRPC allows a single outstanding
+  // write, so nothing is started while a write is in flight.  Returns true
+  // if the call was finished, in which case the caller must release the
+  // reference taken in RequestReceived() after unlocking `write_mu_`.
+  bool StartNextOperation() EXCLUSIVE_LOCKS_REQUIRED(write_mu_) {
+    if (write_in_flight_ || finished_) return false;
+    if (!pending_responses_.empty()) {
+      current_response_ = std::move(pending_responses_.front());
+      pending_responses_.pop_front();
+      write_in_flight_ = true;
+      this->Ref();  // Ref for grpc; released in Tag callback.
+      writer_.Write(current_response_, &response_written_tag_);
+      return false;
+    }
+    if (!finish_requested_) return false;
+    if (broken_) {
+      status_ = ::grpc::Status(::grpc::StatusCode::CANCELLED,
+                               "Response stream broken");
+    }
+    finished_ = true;
+    this->Ref();  // Ref for grpc; released in Tag callback.
+    writer_.Finish(status_, &response_sent_tag_);
+    return true;
+  }
+
+  HandleRequestFunction handle_request_function_;
+  ::grpc::ServerContext ctx_;
+  ::grpc::ServerAsyncWriter<ResponseMessage> writer_;
+
+  mutex write_mu_;
+  std::deque<ResponseMessage> pending_responses_ GUARDED_BY(write_mu_);
+  // The response being written, kept alive until its write completes.
+  ResponseMessage current_response_ GUARDED_BY(write_mu_);
+  bool write_in_flight_ GUARDED_BY(write_mu_) = false;
+  // Set once a write has failed; the remaining responses are dropped.
+  bool broken_ GUARDED_BY(write_mu_) = false;
+  bool finish_requested_ GUARDED_BY(write_mu_) = false;
+  bool finished_ GUARDED_BY(write_mu_) = false;
+  ::grpc::Status status_ GUARDED_BY(write_mu_);
+
+  // Used as void* completion markers from grpc to indicate different
+  // events of interest for a ServerStreamingCall.
+  typedef typename UntypedCall<Service>::Tag Tag;
+  Tag request_received_tag_{this, Tag::kRequestReceived};
+  Tag response_written_tag_{this, Tag::kResponseWritten};
+  Tag response_sent_tag_{this, Tag::kResponseSent};
+  Tag cancelled_tag_{this, Tag::kCancelled};
+
+  mutex mu_;
+  std::function<void()> cancel_callback_ GUARDED_BY(mu_);
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CALL_H_
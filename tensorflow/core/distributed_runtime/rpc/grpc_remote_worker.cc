@@ -34,9 +34,240 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Object allocated per active RecvTensorStream call.
+//
+// The first response allocates the destination tensor, and each following
+// one is copied into it as soon as it has been read, while the rest of the
+// tensor is still on the wire.  The responses are read one at a time, so
+// the whole tensor is never buffered by gRPC.
+class RecvTensorStreamState : public GrpcClientCQTag {
+ public:
+  RecvTensorStreamState(::grpc::GenericStub* stub, ::grpc::CompletionQueue* cq,
+                        const ::grpc::string& method,
+                        const RecvTensorRequest& request,
+                        TensorResponse* response, StatusCallback done,
+                        CallOptions* call_opts)
+      : call_opts_(call_opts), response_(response), done_(std::move(done)) {
+    context_.set_fail_fast(false);
+    if (call_opts) {
+      call_opts->SetCancelCallback([this]() { context_.TryCancel(); });
+    }
+    ::grpc::Status s = GrpcMaybeUnparseProto(request, &request_buf_);
+    if (!s.ok()) {
+      LOG(ERROR) << "GrpcMaybeUnparseProto returned with non-ok status: "
+                 << s.error_message();
+    }
+    call_ = stub->PrepareCall(&context_, method, cq);
+    call_->StartCall(this);
+  }
+
+  void OnCompleted(bool ok) override {
+    switch (state_) {
+      case kStarting:
+        if (!ok) break;
+        state_ = kWriting;
+        call_->WriteLast(request_buf_, ::grpc::WriteOptions(), this);
+        return;
+      case kWriting:
+        if (!ok) break;
+        state_ = kReading;
+        call_->Read(&response_buf_, this);
+        return;
+      case kReading:
+        // !ok means that there are no responses left.
+        if (!ok) break;
+        parse_status_ = ParseResponse();
+        if (!parse_status_.ok()) {
+          context_.TryCancel();
+          break;
+        }
+        call_->Read(&response_buf_, this);
+        return;
+      case kFinishing:
+        Done();
+        return;
+    }
+    state_ = kFinishing;
+    call_->Finish(&status_, this);
+  }
+
+ private:
+  Status ParseResponse() {
+    GrpcByteSource source(&response_buf_);
+    Status s;
+    if (num_responses_ == 0) {
+      s = response_->ParseFrom(&source);
+    } else if (response_->metadata().content_chunk_bytes() > 0) {
+      s = response_->ParseChunkFrom(&source, &content_offset_);
+    } else {
+      s = errors::Internal("Unexpected response in RecvTensorStream");
+    }
+    ++num_responses_;
+    response_buf_.Clear();
+    return s;
+  }
+
+  void Done() {
+    if (call_opts_) {
+      call_opts_->ClearCancelCallback();
+    }
+    Status s = parse_status_.ok() ? FromGrpcStatus(status_) : parse_status_;
+    if (s.ok()) {
+      const bool chunked = response_->metadata().content_chunk_bytes() > 0;
+      if (num_responses_ == 0 ||
+          (chunked &&
+           content_offset_ != response_->tensor().TotalBytes())) {
+        s = errors::Internal("RecvTensorStream ended after ", num_responses_,
+                             " responses and ", content_offset_,
+                             " bytes of tensor content");
+      }
+    }
+    if (!s.ok()) {
+      VLOG(2) << "Call returned with non-ok status: " << s;
+    }
+    done_(s);
+    delete this;
+  }
+
+  enum State { kStarting, kWriting, kReading, kFinishing };
+  State state_ = kStarting;
+
+  CallOptions* call_opts_;
+  ::grpc::ClientContext context_;
+  std::unique_ptr<::grpc::GenericClientAsyncReaderWriter> call_;
+  TensorResponse* response_;
+  ::grpc::ByteBuffer request_buf_;
+  ::grpc::ByteBuffer response_buf_;
+  int num_responses_ = 0;
+  int64 content_offset_ = 0;
+  Status parse_status_;
+  ::grpc::Status status_;
+  StatusCallback done_;
+};
+
+// Object allocated per active RecvTensorBatch call.
+//
+// The server streams one RecvTensorBatchResponse per tensor, as soon as
+// that tensor is available.  Each is parsed in place into the
+// TensorResponse of its tensor, which is reported done right away.
+class RecvTensorBatchState : public GrpcClientCQTag {
+ public:
+  RecvTensorBatchState(::grpc::GenericStub* stub, ::grpc::CompletionQueue* cq,
+                       const ::grpc::string& method,
+                       const RecvTensorBatchRequest& request,
+                       std::vector<TensorResponse*>* responses,
+                       std::function<void(int, const Status&)> tensor_done,
+                       StatusCallback done, CallOptions* call_opts)
+      : call_opts_(call_opts),
+        pending_(*responses),
+        num_pending_(responses->size()),
+        tensor_done_(std::move(tensor_done)),
+        done_(std::move(done)) {
+    context_.set_fail_fast(false);
+    if (call_opts) {
+      call_opts->SetCancelCallback([this]() { context_.TryCancel(); });
+    }
+    ::grpc::Status s = GrpcMaybeUnparseProto(request, &request_buf_);
+    if (!s.ok()) {
+      LOG(ERROR) << "GrpcMaybeUnparseProto returned with non-ok status: "
+                 << s.error_message();
+    }
+    call_ = stub->PrepareCall(&context_, method, cq);
+    call_->StartCall(this);
+  }
+
+  void OnCompleted(bool ok) override {
+    switch (state_) {
+      case kStarting:
+        if (!ok) break;
+        state_ = kWriting;
+        call_->WriteLast(request_buf_, ::grpc::WriteOptions(), this);
+        return;
+      case kWriting:
+        if (!ok) break;
+        state_ = kReading;
+        call_->Read(&response_buf_, this);
+        return;
+      case kReading:
+        // !ok means that there are no responses left.
+        if (!ok) break;
+        parse_status_ = ParseResponse();
+        if (!parse_status_.ok()) {
+          context_.TryCancel();
+          break;
+        }
+        call_->Read(&response_buf_, this);
+        return;
+      case kFinishing:
+        Done();
+        return;
+    }
+    state_ = kFinishing;
+    call_->Finish(&status_, this);
+  }
+
+ private:
+  // Parses the response of one tensor, and reports that tensor done.
+  Status ParseResponse() {
+    int index;
+    const bool parsed = GrpcMaybeParseProto(&response_buf_, &pending_, &index);
+    response_buf_.Clear();
+    if (!parsed) {
+      return errors::Internal("Unexpected response in RecvTensorBatch");
+    }
+    // The TensorResponse now belongs to the caller, which may reuse it.
+    pending_[index] = nullptr;
+    --num_pending_;
+    tensor_done_(index, Status::OK());
+    return Status::OK();
+  }
+
+  void Done() {
+    if (call_opts_) {
+      call_opts_->ClearCancelCallback();
+    }
+    Status s = parse_status_.ok() ? FromGrpcStatus(status_) : parse_status_;
+    if (s.ok() && num_pending_ > 0) {
+      s = errors::Internal("RecvTensorBatch ended with ", num_pending_, " of ",
+                           pending_.size(), " tensors missing");
+    }
+    if (!s.ok()) {
+      VLOG(2) << "Call returned with non-ok status: " << s;
+    }
+    for (size_t i = 0; i < pending_.size(); ++i) {
+      if (pending_[i] != nullptr) {
+        tensor_done_(i, s);
+      }
+    }
+    done_(s);
+    delete this;
+  }
+
+  enum State { kStarting, kWriting, kReading, kFinishing };
+  State state_ = kStarting;
+
+  CallOptions* call_opts_;
+  ::grpc::ClientContext context_;
+  std::unique_ptr<::grpc::GenericClientAsyncReaderWriter> call_;
+  // The TensorResponses of the tensors not received yet, or null.
+  std::vector<TensorResponse*> pending_;
+  int num_pending_;
+  ::grpc::ByteBuffer request_buf_;
+  ::grpc::ByteBuffer response_buf_;
+  Status parse_status_;
+  ::grpc::Status status_;
+  std::function<void(int, const Status&)> tensor_done_;
+  StatusCallback done_;
+};
+
+}  // namespace
+
 class GrpcRemoteWorker : public WorkerInterface {
  public:
   explicit GrpcRemoteWorker(SharedGrpcChannelPtr channel,
@@ -54,9 +285,19 @@ class GrpcRemoteWorker : public WorkerInterface {
         cleanupgraph_(Method(GrpcWorkerMethod::kCleanupGraph)),
         cleanupall_(Method(GrpcWorkerMethod::kCleanupAll)),
         recvtensor_(Method(GrpcWorkerMethod::kRecvTensor)),
+        recvtensorstream_(Method(GrpcWorkerMethod::kRecvTensorStream)),
+        recvtensorbatch_(Method(GrpcWorkerMethod::kRecvTensorBatch)),
         logging_(Method(GrpcWorkerMethod::kLogging)),
         tracing_(Method(GrpcWorkerMethod::kTracing)),
-        logger_(logger) {}
+        logger_(logger) {
+    // Large tensors are received in pieces if TF_GRPC_RECV_TENSOR_STREAM
+    // is set.  The servers must know the RecvTensorStream method.
+    Status s = ReadBoolFromEnvVar("TF_GRPC_RECV_TENSOR_STREAM", false,
+                                  &use_recv_tensor_stream_);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+    }
+  }
 
   ~GrpcRemoteWorker() override {}
 
@@ -170,9 +411,30 @@ class GrpcRemoteWorker : public WorkerInterface {
       cb_to_use = &wrapper_done;
     }
 
+    // The pieces of a streamed tensor are copied straight into its host
+    // memory, and requests that negotiate another transport for the tensor
+    // content keep using RecvTensor.
+    if (use_recv_tensor_stream_ && response->on_host() &&
+        !request->dma_ok() && !request->has_transport_options()) {
+      new RecvTensorStreamState(&stub_, cq_, recvtensorstream_, *request,
+                                response, *cb_to_use, call_opts);
+      return;
+    }
     IssueRequest(request, response, recvtensor_, *cb_to_use, call_opts);
   }
 
+  void RecvTensorBatchAsync(CallOptions* call_opts,
+                            const RecvTensorBatchRequest* request,
+                            std::vector<TensorResponse*>* responses,
+                            std::function<void(int, const Status&)> tensor_done,
+                            StatusCallback done) override {
+    VLOG(1) << "RecvTensorBatchAsync req: " << request->DebugString();
+    CHECK_EQ(request->request_size(), responses->size());
+    new RecvTensorBatchState(&stub_, cq_, recvtensorbatch_, *request,
+                             responses, std::move(tensor_done),
+                             std::move(done), call_opts);
+  }
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override {
     IssueRequest(request, response, logging_, done);
@@ -215,12 +477,16 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string cleanupgraph_;
   const ::grpc::string cleanupall_;
   const ::grpc::string recvtensor_;
+  const ::grpc::string recvtensorstream_;
+  const ::grpc::string recvtensorbatch_;
   const ::grpc::string logging_;
   const ::grpc::string tracing_;
 
   // Support for logging.
   WorkerCacheLogger* logger_;
 
+  bool use_recv_tensor_stream_ = false;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcRemoteWorker);
 };
 
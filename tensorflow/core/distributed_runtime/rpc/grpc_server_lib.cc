@@ -330,6 +330,7 @@ Status GrpcServer::Start() {
       worker_thread_.reset(
           env_->StartThread(ThreadOptions(), "TF_worker_service",
                             [this] { worker_service_->HandleRPCsLoop(); }));
+      metrics_exporter_ = rpc_metrics::MaybeCreateExporterFromEnv(env_);
       state_ = STARTED;
       LOG(INFO) << "Started server with target: " << target();
       return Status::OK();
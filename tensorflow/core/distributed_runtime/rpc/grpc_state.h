@@ -24,7 +24,9 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/distributed_runtime/rpc_metrics.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/notification.h"
 
 namespace tensorflow {
@@ -45,7 +47,10 @@ class RPCState : public GrpcClientCQTag {
            const ::grpc::string& method, const Request& request,
            Response* response, StatusCallback done, CallOptions* call_opts,
            bool fail_fast, int64 timeout_in_ms)
-      : call_opts_(call_opts), done_(std::move(done)) {
+      : call_opts_(call_opts),
+        method_(method),
+        start_micros_(Env::Default()->NowMicros()),
+        done_(std::move(done)) {
     context_.set_fail_fast(fail_fast);
     if (timeout_in_ms > 0) {
       context_.set_deadline(gpr_time_from_millis(timeout_in_ms, GPR_TIMESPAN));
@@ -77,6 +82,10 @@ class RPCState : public GrpcClientCQTag {
       // to Finish for client-side unary calls, ok should never be false
       s.Update(errors::Internal("unexpected ok value at rpc completion"));
     }
+    rpc_metrics::RecordClientCall(method_, context_.peer(), start_micros_,
+                                  Env::Default()->NowMicros(),
+                                  request_buf_.Length(),
+                                  response_buf_.Length());
     if (s.ok() && !GrpcMaybeParseProto(&response_buf_, response_)) {
       s.Update(errors::Internal("could not parse rpc response"));
     }
@@ -89,6 +98,8 @@ class RPCState : public GrpcClientCQTag {
 
  private:
   CallOptions* call_opts_;
+  const ::grpc::string method_;
+  const int64 start_micros_;
   ::grpc::ClientContext context_;
   std::unique_ptr<::grpc::GenericClientAsyncResponseReader> call_;
   Response* response_;
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
+
+#include <algorithm>
+
 #include "grpc++/support/byte_buffer.h"
 #include "grpc++/support/slice.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -133,6 +136,19 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 #endif
 }
 
+// Returns a grpc::Slice holding "num_bytes" bytes of the data of "val",
+// starting at byte "offset", that shares the backing store of "val" and
+// keeps it alive as long as needed.
+static ::grpc::Slice SharedTensorDataSlice(const Tensor& val, size_t offset,
+                                           size_t num_bytes) {
+  const TensorBuffer* buf = DMAHelper::buffer(&val);
+  buf->Ref();
+  return ::grpc::Slice(
+      const_cast<char*>(val.tensor_data().data()) + offset, num_bytes,
+      [](void* backing) { static_cast<TensorBuffer*>(backing)->Unref(); },
+      const_cast<TensorBuffer*>(buf));
+}
+
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
                               ::grpc::ByteBuffer* result) {
   const int kLargeTensorBytes = 1024;
@@ -214,13 +230,7 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
 
     if (tensor_data_is_large) {
       // (E) Encode tensor data, but by sharing backing store
-      const TensorBuffer* buf = DMAHelper::buffer(&val);
-      buf->Ref();
-      slices[1] = ::grpc::Slice(
-          const_cast<void*>(static_cast<const void*>(tdata.data())),
-          tdata.size(),
-          [](void* backing) { static_cast<TensorBuffer*>(backing)->Unref(); },
-          const_cast<TensorBuffer*>(buf));
+      slices[1] = SharedTensorDataSlice(val, 0, tdata.size());
       num_slices += 1;
     }
     size_t total_bytes = 0;
@@ -234,5 +244,78 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
   }
 }
 
+// The first ByteBuffer holds the RecvTensorResponse without the tensor
+// content, and every following one a RecvTensorResponse encoded as:
+//
+// B1:  <tag encoding for RecvTensorResponse::tensor>
+// B2:  <varint32 length of the tensor sub message>
+// D1:  <tag encoding for TensorProto::tensor_content>
+// D2:  <varint32 length of the piece of tensor content>
+// E:   <piece of val's tensor content>
+//
+// where E shares the backing store of "val", like large tensors do in
+// EncodeTensorToByteBuffer().
+void EncodeTensorToByteBuffers(bool is_dead, const Tensor& val,
+                               int64 chunk_bytes,
+                               std::vector<::grpc::ByteBuffer>* result) {
+  result->clear();
+  StringPiece tdata = val.tensor_data();
+  if (is_dead || !DataTypeCanUseMemcpy(val.dtype()) ||
+      static_cast<int64>(tdata.size()) <= chunk_bytes) {
+    result->emplace_back();
+    EncodeTensorToByteBuffer(is_dead, val, &result->back());
+    return;
+  }
+
+  RecvTensorResponse response;
+  response.set_send_start_micros(Env::Default()->NowMicros());
+  response.set_content_chunk_bytes(chunk_bytes);
+  response.mutable_tensor()->set_dtype(val.dtype());
+  val.shape().AsProto(response.mutable_tensor()->mutable_tensor_shape());
+  result->emplace_back();
+  EncodeRecvTensorResponseToByteBuffer(response, &result->back());
+
+  for (size_t offset = 0; offset < tdata.size(); offset += chunk_bytes) {
+    const size_t num_bytes =
+        std::min(static_cast<size_t>(chunk_bytes), tdata.size() - offset);
+    char space[32];
+    io::ProtoEncodeHelper e(space, sizeof(space));
+    // (B1) & (B2)
+    e.WriteVarlengthBeginning(
+        RecvTensorResponse::kTensorFieldNumber,
+        VarLengthEncodingSize(TensorProto::kTensorContentFieldNumber,
+                              num_bytes));
+    // (D1) & (D2)
+    e.WriteVarlengthBeginning(TensorProto::kTensorContentFieldNumber,
+                              num_bytes);
+
+    ::grpc::Slice slices[2];
+    slices[0] = ::grpc::Slice(e.data(), e.size());
+    // (E)
+    slices[1] = SharedTensorDataSlice(val, offset, num_bytes);
+    result->emplace_back(&slices[0], 2);
+  }
+}
+
+void EncodeRecvTensorBatchResponseToByteBuffer(int index,
+                                               ::grpc::ByteBuffer* response,
+                                               ::grpc::ByteBuffer* result) {
+  char space[32];
+  io::ProtoEncodeHelper e(space, sizeof(space));
+  e.WriteUint64(RecvTensorBatchResponse::kIndexFieldNumber, index);
+  e.WriteVarlengthBeginning(RecvTensorBatchResponse::kResponseFieldNumber,
+                            response->Length());
+  std::vector<::grpc::Slice> slices;
+  slices.emplace_back(e.data(), e.size());
+  std::vector<::grpc::Slice> response_slices;
+  (void)response->Dump(&response_slices);
+  for (::grpc::Slice& slice : response_slices) {
+    slices.push_back(std::move(slice));
+  }
+  response->Clear();
+  ::grpc::ByteBuffer tmp(slices.data(), slices.size());
+  result->Swap(&tmp);
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
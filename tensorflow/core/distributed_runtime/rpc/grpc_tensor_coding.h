@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
+
 namespace grpc {
 class ByteBuffer;
 }  // namespace grpc
@@ -51,6 +55,32 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
                               ::grpc::ByteBuffer* result);
 
+// Encode a Tensor into one or more byte buffers, the responses of a
+// RecvTensorStream call.
+//
+// If the content of "val" is at most "chunk_bytes" long, or "val" is dead
+// or cannot be memcpy'd, the result is the single buffer produced by
+// EncodeTensorToByteBuffer().  Otherwise, the first buffer holds a
+// RecvTensorResponse with "content_chunk_bytes" set and no tensor content,
+// and each following buffer a RecvTensorResponse holding the next (at most)
+// "chunk_bytes" bytes of "tensor.tensor_content".  None of the buffers
+// copies the tensor content.
+//
+// Discards original contents of *result.
+void EncodeTensorToByteBuffers(bool is_dead, const Tensor& val,
+                               int64 chunk_bytes,
+                               std::vector<::grpc::ByteBuffer>* result);
+
+// Encode "*response", a byte buffer holding an encoded RecvTensorResponse,
+// into a byte buffer in a format that is parseable as a
+// RecvTensorBatchResponse for the tensor at position "index" of the batch.
+// The data of "*response" is shared, not copied.
+//
+// Clears "*response" and discards original contents of *result.
+void EncodeRecvTensorBatchResponseToByteBuffer(int index,
+                                               ::grpc::ByteBuffer* response,
+                                               ::grpc::ByteBuffer* result);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
@@ -52,6 +52,51 @@ class GrpcTensorCodingTest : public ::testing::Test {
     EXPECT_EQ(t.DebugString(), result_tensor.DebugString());
   }
 
+  void ValidateChunks(const Tensor& t, int64 chunk_bytes) {
+    std::vector<::grpc::ByteBuffer> bufs;
+    grpc::EncodeTensorToByteBuffers(false, t, chunk_bytes, &bufs);
+    ASSERT_FALSE(bufs.empty());
+
+    std::vector<RecvTensorResponse> responses;
+    for (auto& buf : bufs) {
+      std::vector<::grpc::Slice> slices;
+      (void)buf.Dump(&slices);
+      string tmp;
+      for (const auto& s : slices) {
+        tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+      }
+      responses.emplace_back();
+      EXPECT_TRUE(responses.back().ParseFromString(tmp));
+    }
+
+    // Reassemble the content of the chunked responses.
+    TensorProto proto = responses[0].tensor();
+    const int64 total_bytes = t.tensor_data().size();
+    if (total_bytes <= chunk_bytes) {
+      EXPECT_EQ(1, responses.size());
+      EXPECT_EQ(0, responses[0].content_chunk_bytes());
+    } else {
+      EXPECT_EQ(chunk_bytes, responses[0].content_chunk_bytes());
+      EXPECT_TRUE(proto.tensor_content().empty());
+      EXPECT_EQ(1 + (total_bytes + chunk_bytes - 1) / chunk_bytes,
+                responses.size());
+      for (int i = 1; i < responses.size(); ++i) {
+        const RecvTensorResponse& chunk = responses[i];
+        EXPECT_FALSE(chunk.is_dead());
+        EXPECT_FALSE(chunk.tensor().has_tensor_shape());
+        EXPECT_LE(chunk.tensor().tensor_content().size(), chunk_bytes);
+        proto.mutable_tensor_content()->append(
+            chunk.tensor().tensor_content());
+      }
+    }
+
+    Tensor result_tensor;
+    EXPECT_TRUE(result_tensor.FromProto(proto));
+    EXPECT_EQ(t.dtype(), result_tensor.dtype());
+    EXPECT_EQ(t.shape().DebugString(), result_tensor.shape().DebugString());
+    EXPECT_EQ(t.tensor_data(), result_tensor.tensor_data());
+  }
+
   template <typename T>
   void DoTest(DataType dt) {
     gtl::InlinedVector<T, 4> v;
@@ -100,4 +145,55 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(GrpcTensorCodingTest, Chunks) {
+  for (int64 elems : {0, 1, 255, 256, 257, 1000, 10000}) {
+    Tensor a(DT_FLOAT, TensorShape({elems}));
+    for (int64 i = 0; i < elems; ++i) {
+      a.flat<float>()(i) = i;
+    }
+    ValidateChunks(a, 1024);
+  }
+}
+
+TEST_F(GrpcTensorCodingTest, Batch) {
+  std::vector<Tensor> tensors;
+  tensors.push_back(test::AsTensor<float>({1.0, 2.0, 3.0}));
+  tensors.push_back(test::AsTensor<string>({"a", "bc"}));
+  Tensor large(DT_INT64, TensorShape({1000}));
+  large.flat<int64>().setConstant(7);
+  tensors.push_back(large);
+
+  for (int i = 0; i < tensors.size(); ++i) {
+    ::grpc::ByteBuffer tensor_buf;
+    grpc::EncodeTensorToByteBuffer(i == 1, tensors[i], &tensor_buf);
+    ::grpc::ByteBuffer buf;
+    grpc::EncodeRecvTensorBatchResponseToByteBuffer(i, &tensor_buf, &buf);
+    EXPECT_EQ(0, tensor_buf.Length());
+
+    std::vector<::grpc::Slice> slices;
+    (void)buf.Dump(&slices);
+    string tmp;
+    for (const auto& s : slices) {
+      tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+    }
+    RecvTensorBatchResponse response;
+    ASSERT_TRUE(response.ParseFromString(tmp));
+    EXPECT_EQ(i, response.index());
+    EXPECT_EQ(i == 1, response.response().is_dead());
+    Tensor result_tensor;
+    EXPECT_TRUE(result_tensor.FromProto(response.response().tensor()));
+    EXPECT_EQ(tensors[i].DebugString(), result_tensor.DebugString());
+  }
+}
+
+TEST_F(GrpcTensorCodingTest, ChunksForStrings) {
+  Tensor a(DT_STRING, TensorShape({1000}));
+  for (int i = 0; i < 1000; ++i) {
+    a.flat<string>()(i) = strings::StrCat("This is string ", i);
+  }
+  std::vector<::grpc::ByteBuffer> bufs;
+  grpc::EncodeTensorToByteBuffers(false, a, 16, &bufs);
+  EXPECT_EQ(1, bufs.size());
+}
+
 }  // namespace tensorflow
@@ -48,6 +48,56 @@ bool GrpcMaybeParseProto(::grpc::ByteBuffer* src, TensorResponse* dst) {
   return s.ok();
 }
 
+protobuf::io::ZeroCopyInputStream* GrpcByteRangeSource::contents() {
+  range_.reset();
+  reader_.reset(new ::grpc::ProtoBufferReader(buffer_));
+  reader_->Skip(offset_);
+  range_.reset(new protobuf::io::LimitingInputStream(reader_.get(), length_));
+  return range_.get();
+}
+
+// Overload of GrpcParseProto so we can decode a streamed
+// RecvTensorBatchResponse into the TensorResponse of its tensor without
+// extra copying.
+bool GrpcMaybeParseProto(::grpc::ByteBuffer* src,
+                         std::vector<TensorResponse*>* dst, int* index) {
+  // Find where the response is encoded, then parse it in place.  A zero
+  // index may be omitted, as for any proto3 field.
+  int tensor_index = 0;
+  int offset = -1;
+  uint32 length = 0;
+  {
+    ::grpc::ProtoBufferReader reader(src);
+    protobuf::io::CodedInputStream input(&reader);
+    input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
+    for (uint32 tag = input.ReadTag(); tag != 0; tag = input.ReadTag()) {
+      if (tag == ((RecvTensorBatchResponse::kIndexFieldNumber << 3) |
+                  0 /* WIRETYPE_VARINT */)) {
+        uint32 value;
+        if (!input.ReadVarint32(&value)) return false;
+        tensor_index = static_cast<int32>(value);
+      } else if (tag == ((RecvTensorBatchResponse::kResponseFieldNumber << 3) |
+                         2 /* WIRETYPE_LENGTH_DELIMITED */)) {
+        if (!input.ReadVarint32(&length)) return false;
+        offset = input.CurrentPosition();
+        if (!input.Skip(length)) return false;
+      } else {
+        return false;
+      }
+    }
+  }
+  if (offset < 0 || tensor_index < 0 ||
+      tensor_index >= static_cast<int>(dst->size())) {
+    return false;
+  }
+  GrpcByteRangeSource source(src, offset, length);
+  if (!(*dst)[tensor_index]->ParseFrom(&source).ok()) {
+    return false;
+  }
+  *index = tensor_index;
+  return true;
+}
+
 // GrpcMaybeParseProto into a string simply copies bytes into the string.
 bool GrpcMaybeParseProto(grpc::ByteBuffer* src, string* dst) {
   dst->clear();
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_UTIL_H_
 
 #include <memory>
+#include <vector>
 
 #include "grpc++/grpc++.h"
 #include "grpc++/impl/codegen/proto_utils.h"
@@ -56,6 +57,23 @@ class GrpcByteSource : public TensorResponse::Source {
   char space_[sizeof(Reader)];
 };
 
+// Provides "length" bytes of "buffer", starting at "offset", to
+// TensorResponse, e.g. a RecvTensorResponse embedded in a larger message.
+class GrpcByteRangeSource : public TensorResponse::Source {
+ public:
+  GrpcByteRangeSource(::grpc::ByteBuffer* buffer, int offset, int length)
+      : buffer_(buffer), offset_(offset), length_(length) {}
+
+  protobuf::io::ZeroCopyInputStream* contents() override;
+
+ private:
+  ::grpc::ByteBuffer* buffer_;  // Not owned
+  const int offset_;
+  const int length_;
+  std::unique_ptr<::grpc::ProtoBufferReader> reader_;
+  std::unique_ptr<protobuf::io::LimitingInputStream> range_;
+};
+
 constexpr char kStreamRemovedMessage[] = "Stream removed";
 
 // Identify if the given grpc::Status corresponds to an HTTP stream removed
@@ -115,6 +133,12 @@ bool GrpcMaybeParseProto(::grpc::ByteBuffer* src, protobuf::Message* dst);
 // Specialization for TensorResponse
 bool GrpcMaybeParseProto(::grpc::ByteBuffer* src, TensorResponse* dst);
 
+// Specialization for a streamed RecvTensorBatchResponse, decoded into the
+// TensorResponse (*dst)[*index], where *index is set to the index the
+// message holds.  Fails if that index is not one of *dst.
+bool GrpcMaybeParseProto(::grpc::ByteBuffer* src,
+                         std::vector<TensorResponse*>* dst, int* index);
+
 // Copy string src to grpc buffer *dst.
 ::grpc::Status GrpcMaybeUnparseProto(const string& src,
                                      ::grpc::ByteBuffer* dst);
@@ -14,6 +14,11 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
@@ -60,6 +65,22 @@ CleanupAllRequest MakeProto(int size) {
   }
   return proto;
 }
+
+class DummyDevice : public DeviceBase {
+ public:
+  explicit DummyDevice(Env* env) : DeviceBase(env) {
+    attr_.set_device_type("CPU");
+  }
+
+  const DeviceAttributes& attributes() const override { return attr_; }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    return cpu_allocator();
+  }
+
+ private:
+  DeviceAttributes attr_;
+};
 }  // namespace
 
 TEST(GrpcProto, Unparse) {
@@ -134,6 +155,88 @@ TEST(GrpcProto, ParseFromString) {
   }
 }
 
+TEST(GrpcByteRangeSource, Offsets) {
+  RecvTensorResponse proto;
+  test::AsTensor<float>({1.0, 2.0, 3.0, 4.0})
+      .AsProtoTensorContent(proto.mutable_tensor());
+  const string encoded = proto.SerializeAsString();
+  DummyDevice cpu_device(Env::Default());
+  struct Case {
+    int prefix;
+    int suffix;
+    int slices;
+  };
+  for (Case c : std::vector<Case>{
+           {0, 0, 1},
+           {1, 0, 1},
+           {0, 1, 1},
+           {7, 13, 1},
+           {7, 13, 3},
+           {100, 100, 50},
+       }) {
+    ::grpc::ByteBuffer src = MakeBuffer(
+        string(c.prefix, 'x') + encoded + string(c.suffix, 'y'), c.slices);
+    GrpcByteRangeSource source(&src, c.prefix, encoded.size());
+    // Each call starts over at the beginning of the range.
+    for (int i = 0; i < 2; ++i) {
+      protobuf::io::ZeroCopyInputStream* input = source.contents();
+      string contents;
+      const void* data;
+      int size;
+      while (input->Next(&data, &size)) {
+        contents.append(static_cast<const char*>(data), size);
+      }
+      EXPECT_EQ(encoded, contents)
+          << c.prefix << " " << c.suffix << " " << c.slices;
+    }
+    TensorResponse response;
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    TF_ASSERT_OK(response.ParseFrom(&source));
+    test::ExpectTensorEqual<float>(test::AsTensor<float>({1.0, 2.0, 3.0, 4.0}),
+                                   response.tensor());
+  }
+}
+
+TEST(GrpcProto, ParseRecvTensorBatchResponse) {
+  std::vector<Tensor> tensors = {test::AsTensor<float>({1.0, 2.0, 3.0}),
+                                 test::AsTensor<float>({4.0, 5.0})};
+  DummyDevice cpu_device(Env::Default());
+  std::vector<TensorResponse> storage(tensors.size());
+  std::vector<TensorResponse*> dst;
+  for (TensorResponse& response : storage) {
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    dst.push_back(&response);
+  }
+  // The responses arrive in the order the tensors become available.
+  for (int i : {1, 0}) {
+    RecvTensorBatchResponse proto;
+    proto.set_index(i);
+    proto.mutable_response()->set_is_dead(i == 1);
+    tensors[i].AsProtoTensorContent(proto.mutable_response()->mutable_tensor());
+    ::grpc::ByteBuffer src = MakeBuffer(proto.SerializeAsString(), 3);
+    int index = -1;
+    ASSERT_TRUE(GrpcMaybeParseProto(&src, &dst, &index));
+    EXPECT_EQ(i, index);
+    EXPECT_EQ(i == 1, storage[i].metadata().is_dead());
+    test::ExpectTensorEqual<float>(tensors[i], storage[i].tensor());
+  }
+
+  // An index out of range, or a message without a response, is rejected.
+  for (int i : {-1, 2}) {
+    RecvTensorBatchResponse proto;
+    proto.set_index(i);
+    tensors[0].AsProtoTensorContent(proto.mutable_response()->mutable_tensor());
+    ::grpc::ByteBuffer src = MakeBuffer(proto.SerializeAsString(), 1);
+    int index = -1;
+    EXPECT_FALSE(GrpcMaybeParseProto(&src, &dst, &index)) << i;
+  }
+  RecvTensorBatchResponse proto;
+  proto.set_index(1);
+  ::grpc::ByteBuffer src = MakeBuffer(proto.SerializeAsString(), 1);
+  int index = -1;
+  EXPECT_FALSE(GrpcMaybeParseProto(&src, &dst, &index));
+}
+
 static void BM_UnparseGrpc(int iters, int size) {
   testing::StopTiming();
   auto proto = MakeProto(size);
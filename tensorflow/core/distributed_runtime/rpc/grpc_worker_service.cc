@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
+#include "tensorflow/core/distributed_runtime/rpc_metrics.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
@@ -45,22 +46,82 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+// Pieces in which RecvTensorStream splits the content of large tensors.
+const int64 kRecvTensorChunkBytes = 1 << 20;
+
+// Number of requests of each method that a thread polling all the methods
+// keeps outstanding on its completion queue.
+std::vector<int> DefaultQueueDepths() {
+  std::vector<int> depths(kGrpcNumWorkerMethods, 1);
+  depths[static_cast<int>(GrpcWorkerMethod::kRecvTensor)] = 1000;
+  depths[static_cast<int>(GrpcWorkerMethod::kRecvTensorStream)] = 100;
+  depths[static_cast<int>(GrpcWorkerMethod::kRecvTensorBatch)] = 100;
+  depths[static_cast<int>(GrpcWorkerMethod::kRunGraph)] = 100;
+  depths[static_cast<int>(GrpcWorkerMethod::kCleanupGraph)] = 100;
+  return depths;
+}
+
+// The GrpcWorkerService is configured by the following environment
+// variables:
+//
+// TF_GRPC_WORKER_SERVICE_THREADS: number of threads, each polling its own
+//   completion queue, that serve all the methods (default 8).
+// TF_GRPC_WORKER_SERVICE_RECV_TENSOR_THREADS: if positive, the RecvTensor,
+//   RecvTensorStream and RecvTensorBatch methods are served by that many
+//   threads of their own instead, so that tensor transfers and the other
+//   methods do not wait for each other (default 0).
+// TF_GRPC_WORKER_INLINE_RECV_TENSOR: see GrpcWorker::recv_tensor_inline().
 class GrpcWorkerService : public AsyncServiceInterface {
-  // TODO(ncteisen): consider adding a config var or flag for this
-  static constexpr const size_t kGrpcWorkerServiceThreadCount = 8;
+  static constexpr const int64 kGrpcWorkerServiceThreadCount = 8;
 
  public:
   GrpcWorkerService(GrpcWorker* worker, ::grpc::ServerBuilder* builder)
       : is_shutdown_(false) {
     builder->RegisterService(&worker_service_);
-    for (int i = 0; i < kGrpcWorkerServiceThreadCount; i++) {
+
+    int64 num_threads;
+    Status s = ReadInt64FromEnvVar("TF_GRPC_WORKER_SERVICE_THREADS",
+                                   kGrpcWorkerServiceThreadCount, &num_threads);
+    if (!s.ok() || num_threads < 1) {
+      LOG(WARNING) << "Invalid TF_GRPC_WORKER_SERVICE_THREADS, using "
+                   << kGrpcWorkerServiceThreadCount << " threads. " << s;
+      num_threads = kGrpcWorkerServiceThreadCount;
+    }
+    int64 num_recv_tensor_threads;
+    s = ReadInt64FromEnvVar("TF_GRPC_WORKER_SERVICE_RECV_TENSOR_THREADS", 0,
+                            &num_recv_tensor_threads);
+    if (!s.ok()) {
+      LOG(WARNING) << s;
+      num_recv_tensor_threads = 0;
+    }
+    const bool inline_recv_tensor = worker->recv_tensor_inline();
+
+    std::vector<int> queue_depths = DefaultQueueDepths();
+    if (num_recv_tensor_threads > 0) {
+      std::vector<int> recv_tensor_queue_depths(kGrpcNumWorkerMethods, 0);
+      for (GrpcWorkerMethod method :
+           {GrpcWorkerMethod::kRecvTensor, GrpcWorkerMethod::kRecvTensorStream,
+            GrpcWorkerMethod::kRecvTensorBatch}) {
+        const int i = static_cast<int>(method);
+        recv_tensor_queue_depths[i] = queue_depths[i];
+        queue_depths[i] = 0;
+      }
+      for (int i = 0; i < num_recv_tensor_threads; i++) {
+        threads_.emplace_back(new GrpcWorkerServiceThread(
+            worker, builder, &worker_service_, recv_tensor_queue_depths,
+            inline_recv_tensor));
+      }
+    }
+    for (int i = 0; i < num_threads; i++) {
       threads_.emplace_back(
-          new GrpcWorkerServiceThread(worker, builder, &worker_service_));
+          new GrpcWorkerServiceThread(worker, builder, &worker_service_,
+                                      queue_depths, inline_recv_tensor));
     }
   }
 
@@ -120,11 +181,15 @@ class GrpcWorkerService : public AsyncServiceInterface {
   // CompletionQueue.
   class GrpcWorkerServiceThread {
    public:
+    // The thread serves the methods with a positive `queue_depths` entry.
     explicit GrpcWorkerServiceThread(
         GrpcWorker* worker, ::grpc::ServerBuilder* builder,
-        grpc::WorkerService::AsyncService* worker_service)
+        grpc::WorkerService::AsyncService* worker_service,
+        const std::vector<int>& queue_depths, bool inline_recv_tensor)
         : worker_(worker),
           worker_service_(worker_service),
+          queue_depths_(queue_depths),
+          inline_recv_tensor_(inline_recv_tensor),
           is_shutdown_(false) {
       cq_ = builder->AddCompletionQueue();
     }
@@ -147,30 +212,50 @@ class GrpcWorkerService : public AsyncServiceInterface {
 
    private:
     void HandleRPCsLoop() {
-      // TODO(ncteisen): This may require performance engineering. We can
-      // change the number of threads, the number of handlers per thread,
-      // or even decide to specialize certain threads to certain methods.
-      ENQUEUE_REQUEST(GetStatus, false);
-      ENQUEUE_REQUEST(CreateWorkerSession, false);
-      ENQUEUE_REQUEST(DeleteWorkerSession, false);
-      ENQUEUE_REQUEST(CleanupAll, false);
-      ENQUEUE_REQUEST(RegisterGraph, false);
-      ENQUEUE_REQUEST(DeregisterGraph, false);
-
-      // TODO(ncteisen): Determine a better policy for enqueuing the
-      // appropriate number of each request type.
-      for (int i = 0; i < 1000; ++i) {
+      for (int i = 0; i < QueueDepth(GrpcWorkerMethod::kGetStatus); ++i) {
+        ENQUEUE_REQUEST(GetStatus, false);
+      }
+      for (int i = 0; i < QueueDepth(GrpcWorkerMethod::kCreateWorkerSession);
+           ++i) {
+        ENQUEUE_REQUEST(CreateWorkerSession, false);
+      }
+      for (int i = 0; i < QueueDepth(GrpcWorkerMethod::kDeleteWorkerSession);
+           ++i) {
+        ENQUEUE_REQUEST(DeleteWorkerSession, false);
+      }
+      for (int i = 0; i < QueueDepth(GrpcWorkerMethod::kCleanupAll); ++i) {
+        ENQUEUE_REQUEST(CleanupAll, false);
+      }
+      for (int i = 0; i < QueueDepth(GrpcWorkerMethod::kRegisterGraph); ++i) {
+        ENQUEUE_REQUEST(RegisterGraph, false);
+      }
+      for (int i = 0; i < QueueDepth(GrpcWorkerMethod::kDeregisterGraph);
+           ++i) {
+        ENQUEUE_REQUEST(DeregisterGraph, false);
+      }
+      for (int i = 0; i < QueueDepth(GrpcWorkerMethod::kRecvTensor); ++i) {
         EnqueueRecvTensorRequestRaw();
       }
-      for (int i = 0; i < 100; ++i) {
+      for (int i = 0; i < QueueDepth(GrpcWorkerMethod::kRecvTensorStream);
+           ++i) {
+        EnqueueRecvTensorStreamRequestRaw();
+      }
+      for (int i = 0; i < QueueDepth(GrpcWorkerMethod::kRecvTensorBatch);
+           ++i) {
+        EnqueueRecvTensorBatchRequestRaw();
+      }
+      for (int i = 0; i < QueueDepth(GrpcWorkerMethod::kRunGraph); ++i) {
         ENQUEUE_REQUEST(RunGraph, true);
       }
-      for (int i = 0; i < 100; ++i) {
+      for (int i = 0; i < QueueDepth(GrpcWorkerMethod::kCleanupGraph); ++i) {
         ENQUEUE_REQUEST(CleanupGraph, false);
       }
-
-      ENQUEUE_REQUEST(Logging, false);
-      ENQUEUE_REQUEST(Tracing, false);
+      for (int i = 0; i < QueueDepth(GrpcWorkerMethod::kLogging); ++i) {
+        ENQUEUE_REQUEST(Logging, false);
+      }
+      for (int i = 0; i < QueueDepth(GrpcWorkerMethod::kTracing); ++i) {
+        ENQUEUE_REQUEST(Tracing, false);
+      }
 
       void* tag;
       bool ok;
@@ -184,8 +269,29 @@ class GrpcWorkerService : public AsyncServiceInterface {
     }
 
    private:
-    void Schedule(std::function<void()> f) {
-      worker_->env()->compute_pool->Schedule(std::move(f));
+    int QueueDepth(GrpcWorkerMethod method) const {
+      return queue_depths_[static_cast<int>(method)];
+    }
+
+    // Schedules `f`, the handler of a call of `method` that just arrived.
+    void Schedule(GrpcWorkerMethod method, std::function<void()> f) {
+      const int64 arrival_micros = Env::Default()->NowMicros();
+      worker_->env()->compute_pool->Schedule(
+          [method, arrival_micros, f]() {
+            rpc_metrics::RecordServerQueueing(GrpcWorkerMethodName(method),
+                                              arrival_micros,
+                                              Env::Default()->NowMicros());
+            f();
+          });
+    }
+
+    // Runs `f`, the handler of a call of `method` that just arrived, on this
+    // thread.  The call is recorded like a scheduled one that did not queue.
+    void RunInline(GrpcWorkerMethod method, const std::function<void()>& f) {
+      const int64 start_micros = Env::Default()->NowMicros();
+      rpc_metrics::RecordServerQueueing(GrpcWorkerMethodName(method),
+                                        start_micros, start_micros);
+      f();
     }
 
     // The following section contains one request handler method per
@@ -202,7 +308,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
 
     void GetStatusHandler(
         WorkerCall<GetStatusRequest, GetStatusResponse>* call) {
-      Schedule([this, call]() {
+      Schedule(GrpcWorkerMethod::kGetStatus, [this, call]() {
         Status s = worker_->GetStatus(&call->request, &call->response);
         call->SendResponse(ToGrpcStatus(s));
       });
@@ -212,7 +318,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
     void CreateWorkerSessionHandler(
         WorkerCall<CreateWorkerSessionRequest, CreateWorkerSessionResponse>*
             call) {
-      Schedule([this, call]() {
+      Schedule(GrpcWorkerMethod::kCreateWorkerSession, [this, call]() {
         Status s =
             worker_->CreateWorkerSession(&call->request, &call->response);
         call->SendResponse(ToGrpcStatus(s));
@@ -223,7 +329,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
     void DeleteWorkerSessionHandler(
         WorkerCall<DeleteWorkerSessionRequest, DeleteWorkerSessionResponse>*
             call) {
-      Schedule([this, call]() {
+      Schedule(GrpcWorkerMethod::kDeleteWorkerSession, [this, call]() {
         Status s =
             worker_->DeleteWorkerSession(&call->request, &call->response);
         call->SendResponse(ToGrpcStatus(s));
@@ -233,7 +339,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
 
     void CleanupAllHandler(
         WorkerCall<CleanupAllRequest, CleanupAllResponse>* call) {
-      Schedule([this, call]() {
+      Schedule(GrpcWorkerMethod::kCleanupAll, [this, call]() {
         Status s = worker_->CleanupAll(&call->request, &call->response);
         call->SendResponse(ToGrpcStatus(s));
       });
@@ -242,7 +348,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
 
     void RegisterGraphHandler(
         WorkerCall<RegisterGraphRequest, RegisterGraphResponse>* call) {
-      Schedule([this, call]() {
+      Schedule(GrpcWorkerMethod::kRegisterGraph, [this, call]() {
         Status s = worker_->RegisterGraph(&call->request, &call->response);
         call->SendResponse(ToGrpcStatus(s));
       });
@@ -251,7 +357,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
 
     void DeregisterGraphHandler(
         WorkerCall<DeregisterGraphRequest, DeregisterGraphResponse>* call) {
-      Schedule([this, call]() {
+      Schedule(GrpcWorkerMethod::kDeregisterGraph, [this, call]() {
         Status s = worker_->DeregisterGraph(&call->request, &call->response);
         call->SendResponse(ToGrpcStatus(s));
       });
@@ -259,7 +365,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
     }
 
     void RunGraphHandler(WorkerCall<RunGraphRequest, RunGraphResponse>* call) {
-      Schedule([this, call]() {
+      Schedule(GrpcWorkerMethod::kRunGraph, [this, call]() {
         CallOptions* call_opts = new CallOptions;
         ProtoRunGraphRequest* wrapped_request =
             new ProtoRunGraphRequest(&call->request);
@@ -281,7 +387,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
 
     void RecvTensorHandlerRaw(
         WorkerCall<RecvTensorRequest, ::grpc::ByteBuffer>* call) {
-      Schedule([this, call]() {
+      auto handle = [this, call]() {
         CallOptions* call_opts = new CallOptions;
         call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
         worker_->GrpcRecvTensorAsync(call_opts, &call->request, &call->response,
@@ -290,13 +396,61 @@ class GrpcWorkerService : public AsyncServiceInterface {
                                        delete call_opts;
                                        call->SendResponse(ToGrpcStatus(s));
                                      });
+      };
+      if (inline_recv_tensor_) {
+        EnqueueRecvTensorRequestRaw();
+        RunInline(GrpcWorkerMethod::kRecvTensor, handle);
+      } else {
+        Schedule(GrpcWorkerMethod::kRecvTensor, std::move(handle));
+        EnqueueRecvTensorRequestRaw();
+      }
+    }
+
+    void RecvTensorStreamHandlerRaw(
+        ServerStreamingCall<GrpcWorkerServiceThread,
+                            grpc::WorkerService::AsyncService,
+                            RecvTensorRequest, ::grpc::ByteBuffer>* call) {
+      Schedule(GrpcWorkerMethod::kRecvTensorStream, [this, call]() {
+        CallOptions* call_opts = new CallOptions;
+        std::vector<::grpc::ByteBuffer>* responses =
+            new std::vector<::grpc::ByteBuffer>;
+        call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+        worker_->GrpcRecvTensorStreamAsync(
+            call_opts, &call->request, responses,
+            [call, call_opts, responses](const Status& s) {
+              call->ClearCancelCallback();
+              delete call_opts;
+              call->SendResponses(std::move(*responses), ToGrpcStatus(s));
+              delete responses;
+            });
       });
-      EnqueueRecvTensorRequestRaw();
+      EnqueueRecvTensorStreamRequestRaw();
+    }
+
+    void RecvTensorBatchHandlerRaw(
+        ServerStreamingCall<GrpcWorkerServiceThread,
+                            grpc::WorkerService::AsyncService,
+                            RecvTensorBatchRequest, ::grpc::ByteBuffer>* call) {
+      Schedule(GrpcWorkerMethod::kRecvTensorBatch, [this, call]() {
+        CallOptions* call_opts = new CallOptions;
+        call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+        worker_->GrpcRecvTensorBatchAsync(
+            call_opts, &call->request,
+            [call](int index, ::grpc::ByteBuffer* response) {
+              call->WriteResponse(std::move(*response));
+            },
+            [call, call_opts](const Status& s) {
+              call->ClearCancelCallback();
+              delete call_opts;
+              call->Finish(ToGrpcStatus(s));
+            });
+      });
+      EnqueueRecvTensorBatchRequestRaw();
     }
 
     void CleanupGraphHandler(
         WorkerCall<CleanupGraphRequest, CleanupGraphResponse>* call) {
-      Schedule([this, call]() {
+      Schedule(GrpcWorkerMethod::kCleanupGraph, [this, call]() {
         Status s = worker_->CleanupGraph(&call->request, &call->response);
         call->SendResponse(ToGrpcStatus(s));
       });
@@ -304,7 +458,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
     }
 
     void LoggingHandler(WorkerCall<LoggingRequest, LoggingResponse>* call) {
-      Schedule([this, call]() {
+      Schedule(GrpcWorkerMethod::kLogging, [this, call]() {
         Status s = worker_->Logging(&call->request, &call->response);
         call->SendResponse(ToGrpcStatus(s));
       });
@@ -312,7 +466,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
     }
 
     void TracingHandler(WorkerCall<TracingRequest, TracingResponse>* call) {
-      Schedule([this, call]() {
+      Schedule(GrpcWorkerMethod::kTracing, [this, call]() {
         Status s = worker_->Tracing(&call->request, &call->response);
         call->SendResponse(ToGrpcStatus(s));
       });
@@ -333,10 +487,41 @@ class GrpcWorkerService : public AsyncServiceInterface {
       }
     }
 
+    void EnqueueRecvTensorStreamRequestRaw() {
+      mutex_lock l(shutdown_mu_);
+      if (!is_shutdown_) {
+        ServerStreamingCall<GrpcWorkerServiceThread,
+                            grpc::WorkerService::AsyncService,
+                            RecvTensorRequest, ::grpc::ByteBuffer>::
+            EnqueueRequestForMethod(
+                worker_service_, cq_.get(),
+                static_cast<int>(GrpcWorkerMethod::kRecvTensorStream),
+                &GrpcWorkerServiceThread::RecvTensorStreamHandlerRaw,
+                true /* supports cancel*/);
+      }
+    }
+
+    void EnqueueRecvTensorBatchRequestRaw() {
+      mutex_lock l(shutdown_mu_);
+      if (!is_shutdown_) {
+        ServerStreamingCall<GrpcWorkerServiceThread,
+                            grpc::WorkerService::AsyncService,
+                            RecvTensorBatchRequest, ::grpc::ByteBuffer>::
+            EnqueueRequestForMethod(
+                worker_service_, cq_.get(),
+                static_cast<int>(GrpcWorkerMethod::kRecvTensorBatch),
+                &GrpcWorkerServiceThread::RecvTensorBatchHandlerRaw,
+                true /* supports cancel*/);
+      }
+    }
+
     GrpcWorker* const worker_ = nullptr;  // Not owned.
     std::unique_ptr<::grpc::ServerCompletionQueue> cq_;
     std::unique_ptr<Thread> thread_;
     grpc::WorkerService::AsyncService* const worker_service_;
+    // Indexed by GrpcWorkerMethod.
+    const std::vector<int> queue_depths_;
+    const bool inline_recv_tensor_;
 
     mutex shutdown_mu_;
     bool is_shutdown_ GUARDED_BY(shutdown_mu_);
@@ -364,10 +549,99 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
                                      const RecvTensorRequest* request,
                                      ::grpc::ByteBuffer* response,
                                      StatusCallback done) {
-  Status s = recv_tensor_recent_request_ids_.TrackUnique(
-      request->request_id(), "RecvTensor (GrpcWorker)", *request);
+  RecvHostTensorAsync(
+      opts, request, "RecvTensor (GrpcWorker)",
+      [response, done](const Status& s, const Tensor& val, bool is_dead) {
+        if (s.ok()) {
+          grpc::EncodeTensorToByteBuffer(is_dead, val, response);
+        }
+        done(s);
+      });
+}
+
+// GrpcRecvTensorStreamAsync: like GrpcRecvTensorAsync, but splits the
+// content of large tensors across several responses, none of which copies
+// it.
+void GrpcWorker::GrpcRecvTensorStreamAsync(
+    CallOptions* opts, const RecvTensorRequest* request,
+    std::vector<::grpc::ByteBuffer>* responses, StatusCallback done) {
+  RecvHostTensorAsync(
+      opts, request, "RecvTensorStream (GrpcWorker)",
+      [responses, done](const Status& s, const Tensor& val, bool is_dead) {
+        if (s.ok()) {
+          grpc::EncodeTensorToByteBuffers(is_dead, val, kRecvTensorChunkBytes,
+                                          responses);
+        }
+        done(s);
+      });
+}
+
+// GrpcRecvTensorBatchAsync: receives each tensor of the batch like
+// GrpcRecvTensorAsync, and hands it over as soon as it is available, since
+// the client may only produce the other tensors of the batch once it has
+// received this one.
+void GrpcWorker::GrpcRecvTensorBatchAsync(
+    CallOptions* opts, const RecvTensorBatchRequest* request,
+    std::function<void(int, ::grpc::ByteBuffer*)> tensor_done,
+    StatusCallback done) {
+  struct BatchState {
+    explicit BatchState(int num_tensors)
+        : pending(num_tensors), opts(num_tensors) {}
+
+    mutex mu;
+    int pending GUARDED_BY(mu);
+    Status status GUARDED_BY(mu);
+    // Each tensor is received with its own CallOptions, all of which are
+    // cancelled with "opts".
+    std::vector<CallOptions> opts;
+  };
+
+  const int num_tensors = request->request_size();
+  if (num_tensors == 0) {
+    done(Status::OK());
+    return;
+  }
+  BatchState* state = new BatchState(num_tensors);
+  opts->SetCancelCallback([state]() {
+    for (CallOptions& tensor_opts : state->opts) {
+      tensor_opts.StartCancel();
+    }
+  });
+  for (int i = 0; i < num_tensors; ++i) {
+    RecvHostTensorAsync(
+        &state->opts[i], &request->request(i), "RecvTensorBatch (GrpcWorker)",
+        [opts, tensor_done, done, state, i](const Status& s, const Tensor& val,
+                                            bool is_dead) {
+          if (s.ok()) {
+            ::grpc::ByteBuffer tensor_response;
+            grpc::EncodeTensorToByteBuffer(is_dead, val, &tensor_response);
+            ::grpc::ByteBuffer response;
+            grpc::EncodeRecvTensorBatchResponseToByteBuffer(
+                i, &tensor_response, &response);
+            tensor_done(i, &response);
+          }
+          Status status;
+          {
+            mutex_lock l(state->mu);
+            state->status.Update(s);
+            if (--state->pending > 0) return;
+            status = state->status;
+          }
+          opts->ClearCancelCallback();
+          delete state;
+          done(status);
+        });
+  }
+}
+
+void GrpcWorker::RecvHostTensorAsync(CallOptions* opts,
+                                     const RecvTensorRequest* request,
+                                     const char* method,
+                                     HostTensorCallback done) {
+  Status s = recv_tensor_recent_request_ids_.TrackUnique(request->request_id(),
+                                                         method, *request);
   if (!s.ok()) {
-    done(s);
+    done(s, Tensor(), false);
     return;
   }
 
@@ -381,7 +655,7 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
     s = PrepareRecvTensor(parsed, &src_dev);
   }
   if (!s.ok()) {
-    done(s);
+    done(s, Tensor(), false);
     return;
   }
 
@@ -392,10 +666,10 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   opts->SetCancelCallback([this, step_id]() { AbortStep(step_id); });
   env_->rendezvous_mgr->RecvLocalAsync(
       step_id, parsed,
-      [opts, response, done, src_dev](const Status& status,
-                                      const Rendezvous::Args& send_args,
-                                      const Rendezvous::Args& recv_args,
-                                      const Tensor& val, const bool is_dead) {
+      [opts, done, src_dev](const Status& status,
+                            const Rendezvous::Args& send_args,
+                            const Rendezvous::Args& recv_args,
+                            const Tensor& val, const bool is_dead) {
         opts->ClearCancelCallback();
         if (status.ok()) {
           // DMA can only be used for Tensors that do not fall into
@@ -419,27 +693,26 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
                   << "send dev name: " << src_dev->name()
                   << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
               // "val" is on a GPU. Uses GPUUtil to fill the copy on host.
-              StatusCallback copy_ready = [response, done, copy,
+              StatusCallback copy_ready = [done, copy,
                                            is_dead](const Status& s) {
                 // The value is now ready to be returned on the wire.
-                grpc::EncodeTensorToByteBuffer(is_dead, *copy, response);
-                done(s);
+                done(s, *copy, is_dead);
                 delete copy;
               };
 
               GPUUtil::CopyGPUTensorToCPU(src_dev, send_dev_context, &val, copy,
                                           copy_ready);
 #else
-              done(errors::Internal("No GPU device in process"));
+              done(errors::Internal("No GPU device in process"), Tensor(),
+                   false);
 #endif  // GOOGLE_CUDA
             } else {
-              grpc::EncodeTensorToByteBuffer(is_dead, val, response);
-              done(Status::OK());
+              done(Status::OK(), val, is_dead);
             }
           }
         } else {
           //  !s.ok()
-          done(status);
+          done(status, Tensor(), false);
         }
       });
 }
@@ -465,7 +738,17 @@ void GrpcWorker::LoggingAsync(const LoggingRequest* request,
 WorkerEnv* GrpcWorker::env() { return env_; }
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* env) {
-  return std::unique_ptr<GrpcWorker>(new GrpcWorker(env));
+  std::unique_ptr<GrpcWorker> worker(new GrpcWorker(env));
+  // The RecvTensor handler of the base GrpcWorker only looks up the
+  // rendezvous: a tensor that is already there is sent right away, and
+  // otherwise the response is sent by the thread that produces it.
+  Status s = ReadBoolFromEnvVar("TF_GRPC_WORKER_INLINE_RECV_TENSOR", true,
+                                &worker->recv_tensor_inline_);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+    worker->recv_tensor_inline_ = true;
+  }
+  return worker;
 }
 
 std::unique_ptr<AsyncServiceInterface> NewGrpcWorkerService(
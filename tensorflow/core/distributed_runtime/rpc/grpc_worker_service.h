@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_WORKER_SERVICE_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_WORKER_SERVICE_H_
 
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/distributed_runtime/recent_request_ids.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 
@@ -40,13 +43,46 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  // Specialized version of RecvTensor for the RecvTensorStream method, which
+  // splits large tensors across several responses.
+  virtual void GrpcRecvTensorStreamAsync(
+      CallOptions* opts, const RecvTensorRequest* request,
+      std::vector<::grpc::ByteBuffer>* responses, StatusCallback done);
+
+  // Specialized version of RecvTensorBatch for gRPC, which avoids a copy.
+  // "tensor_done" is called with the index and the encoded
+  // RecvTensorBatchResponse of each tensor as soon as that tensor is
+  // available, and "done" once all of them have been, or on failure.
+  virtual void GrpcRecvTensorBatchAsync(
+      CallOptions* opts, const RecvTensorBatchRequest* request,
+      std::function<void(int, ::grpc::ByteBuffer*)> tensor_done,
+      StatusCallback done);
+
   virtual void LoggingAsync(const LoggingRequest* request,
                             LoggingResponse* response, StatusCallback done);
 
   WorkerEnv* env();
 
+  // Returns true if the worker service calls GrpcRecvTensorAsync() on its
+  // gRPC polling threads rather than on the compute pool.  This is only the
+  // case for the workers created by NewGrpcWorker(), unless the
+  // TF_GRPC_WORKER_INLINE_RECV_TENSOR environment variable is false:
+  // subclasses may override GrpcRecvTensorAsync() with work that blocks.
+  bool recv_tensor_inline() const { return recv_tensor_inline_; }
+
  private:
+  friend std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env);
+
+  typedef std::function<void(const Status&, const Tensor&, bool is_dead)>
+      HostTensorCallback;
+
+  // Calls "done" with the tensor that "request" asks for, copied to host
+  // memory if needed.  "method" names the RPC in error messages.
+  void RecvHostTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
+                           const char* method, HostTensorCallback done);
+
   RecentRequestIds recv_tensor_recent_request_ids_;
+  bool recv_tensor_inline_ = false;
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env);
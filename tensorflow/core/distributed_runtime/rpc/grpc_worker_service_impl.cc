@@ -46,6 +46,10 @@ const char* GrpcWorkerMethodName(GrpcWorkerMethod id) {
       return "/tensorflow.WorkerService/CleanupAll";
     case GrpcWorkerMethod::kRecvTensor:
       return "/tensorflow.WorkerService/RecvTensor";
+    case GrpcWorkerMethod::kRecvTensorStream:
+      return "/tensorflow.WorkerService/RecvTensorStream";
+    case GrpcWorkerMethod::kRecvTensorBatch:
+      return "/tensorflow.WorkerService/RecvTensorBatch";
     case GrpcWorkerMethod::kLogging:
       return "/tensorflow.WorkerService/Logging";
     case GrpcWorkerMethod::kTracing:
@@ -60,9 +64,14 @@ namespace grpc {
 
 WorkerService::AsyncService::AsyncService() {
   for (int i = 0; i < kGrpcNumWorkerMethods; ++i) {
+    const GrpcWorkerMethod id = static_cast<GrpcWorkerMethod>(i);
     AddMethod(new ::grpc::internal::RpcServiceMethod(
-        GrpcWorkerMethodName(static_cast<GrpcWorkerMethod>(i)),
-        ::grpc::internal::RpcMethod::NORMAL_RPC, nullptr));
+        GrpcWorkerMethodName(id),
+        id == GrpcWorkerMethod::kRecvTensorStream ||
+                id == GrpcWorkerMethod::kRecvTensorBatch
+            ? ::grpc::internal::RpcMethod::SERVER_STREAMING
+            : ::grpc::internal::RpcMethod::NORMAL_RPC,
+        nullptr));
     ::grpc::Service::MarkMethodAsync(i);
   }
 }
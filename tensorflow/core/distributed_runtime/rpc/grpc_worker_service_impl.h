@@ -81,6 +81,8 @@ enum class GrpcWorkerMethod {
   kCleanupGraph,
   kCleanupAll,
   kRecvTensor,
+  kRecvTensorStream,
+  kRecvTensorBatch,
   kLogging,
   kTracing,
 };
@@ -102,7 +104,9 @@ class WorkerService final {
     AsyncService();
     virtual ~AsyncService();
 
-    // Make RequestAsyncUnary public for grpc_call.h
+    // Make RequestAsyncUnary and RequestAsyncServerStreaming public for
+    // grpc_call.h
+    using ::grpc::Service::RequestAsyncServerStreaming;
     using ::grpc::Service::RequestAsyncUnary;
   };
 };
@@ -0,0 +1,243 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
+
+#include <stdlib.h>
+
+#include "grpc++/support/byte_buffer.h"
+
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/worker_cache.h"
+#include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/distributed_runtime/worker_session.h"
+#include "tensorflow/core/framework/control_flow.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+const char kWorkerName[] = "/job:worker/replica:0/task:0";
+
+// Fake cache implementation for WorkerSession.
+class DummyWorkerCache : public WorkerCacheInterface {
+  void ListWorkers(std::vector<string>* workers) const override {}
+  WorkerInterface* CreateWorker(const string& target) override {
+    return nullptr;
+  }
+  bool GetDeviceLocalityNonBlocking(const string& device,
+                                    DeviceLocality* locality) override {
+    return false;
+  }
+  void GetDeviceLocalityAsync(const string& device, DeviceLocality* locality,
+                              StatusCallback done) override {}
+};
+
+class GrpcWorkerTest : public ::testing::Test {
+ protected:
+  GrpcWorkerTest()
+      : device_(DeviceFactory::NewDevice("CPU", SessionOptions(), kWorkerName)),
+        device_mgr_({device_}),
+        rendezvous_mgr_(&env_) {
+    env_.env = Env::Default();
+    env_.device_mgr = &device_mgr_;
+    env_.local_devices = device_mgr_.ListDevices();
+    env_.rendezvous_mgr = &rendezvous_mgr_;
+    worker_session_ = WorkerSession::CreateWithBorrowedDeviceMgr(
+        "worker_session", kWorkerName,
+        std::unique_ptr<WorkerCacheInterface>(new DummyWorkerCache),
+        &device_mgr_, std::unique_ptr<GraphMgr>());
+    worker_ = NewGrpcWorker(&env_);
+  }
+
+  // Returns the key of a tensor sent from this worker to another one.
+  Rendezvous::ParsedKey Key(const string& name, uint64 incarnation) {
+    Rendezvous::ParsedKey key;
+    TF_CHECK_OK(Rendezvous::ParseKey(
+        Rendezvous::CreateKey(strings::StrCat(kWorkerName, "/device:CPU:0"),
+                              incarnation,
+                              "/job:worker/replica:0/task:1/device:CPU:0",
+                              name, FrameAndIter(0, 0)),
+        &key));
+    return key;
+  }
+  Rendezvous::ParsedKey Key(const string& name) {
+    return Key(name, device_->attributes().incarnation());
+  }
+
+  // Adds a request for the tensor with "key" to "request".
+  void AddRequest(const Rendezvous::ParsedKey& key,
+                  RecvTensorBatchRequest* request) {
+    RecvTensorRequest* tensor_request = request->add_request();
+    tensor_request->set_step_id(kStepId);
+    tensor_request->set_rendezvous_key(key.FullKey().ToString());
+    tensor_request->set_request_id(request->request_size());
+  }
+
+  static const int64 kStepId = 123;
+
+  Device* device_;  // Owned by device_mgr_.
+  DeviceMgr device_mgr_;
+  WorkerEnv env_;
+  RpcRendezvousMgr rendezvous_mgr_;
+  std::shared_ptr<WorkerSession> worker_session_;
+  std::unique_ptr<GrpcWorker> worker_;
+};
+
+// Collects the tensors that GrpcRecvTensorBatchAsync hands over.
+class BatchReceiver {
+ public:
+  BatchReceiver(Device* device, int num_tensors) : storage_(num_tensors) {
+    for (TensorResponse& response : storage_) {
+      response.InitAlloc(device, AllocatorAttributes());
+      responses_.push_back(&response);
+    }
+  }
+
+  std::function<void(int, ::grpc::ByteBuffer*)> tensor_done() {
+    return [this](int index, ::grpc::ByteBuffer* response) {
+      int parsed_index = -1;
+      EXPECT_TRUE(GrpcMaybeParseProto(response, &responses_, &parsed_index));
+      EXPECT_EQ(index, parsed_index);
+      mutex_lock l(mu_);
+      indices_.push_back(index);
+      cond_.notify_all();
+    };
+  }
+
+  void WaitForTensors(int num_tensors) {
+    mutex_lock l(mu_);
+    while (indices_.size() < num_tensors) {
+      cond_.wait(l);
+    }
+  }
+
+  std::vector<int> indices() {
+    mutex_lock l(mu_);
+    return indices_;
+  }
+
+  const Tensor& tensor(int index) const { return storage_[index].tensor(); }
+
+ private:
+  std::vector<TensorResponse> storage_;
+  std::vector<TensorResponse*> responses_;
+  mutex mu_;
+  condition_variable cond_;
+  std::vector<int> indices_ GUARDED_BY(mu_);
+};
+
+TEST_F(GrpcWorkerTest, RecvTensorBatchSendsEachTensorWhenReady) {
+  RemoteRendezvous* rendez = rendezvous_mgr_.Find(kStepId);
+  core::ScopedUnref unref(rendez);
+  TF_ASSERT_OK(rendez->Initialize(worker_session_.get()));
+
+  RecvTensorBatchRequest request;
+  AddRequest(Key("a"), &request);
+  AddRequest(Key("b"), &request);
+  BatchReceiver receiver(device_, 2);
+  Notification done;
+  Status status;
+  CallOptions opts;
+  worker_->GrpcRecvTensorBatchAsync(&opts, &request, receiver.tensor_done(),
+                                    [&done, &status](const Status& s) {
+                                      status = s;
+                                      done.Notify();
+                                    });
+
+  // "b" is only produced once "a" has been handed over, as when the two
+  // workers exchange tensors back and forth within a step.
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez->Send(Key("a"), args,
+                            test::AsTensor<float>({1.0, 2.0}), false));
+  receiver.WaitForTensors(1);
+  EXPECT_FALSE(done.HasBeenNotified());
+  TF_ASSERT_OK(
+      rendez->Send(Key("b"), args, test::AsTensor<float>({3.0}), false));
+
+  done.WaitForNotification();
+  TF_EXPECT_OK(status);
+  EXPECT_EQ(std::vector<int>({0, 1}), receiver.indices());
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({1.0, 2.0}),
+                                 receiver.tensor(0));
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({3.0}),
+                                 receiver.tensor(1));
+  rendezvous_mgr_.Cleanup(kStepId);
+}
+
+TEST_F(GrpcWorkerTest, RecvTensorBatchFailure) {
+  RemoteRendezvous* rendez = rendezvous_mgr_.Find(kStepId);
+  core::ScopedUnref unref(rendez);
+  TF_ASSERT_OK(rendez->Initialize(worker_session_.get()));
+
+  // The second tensor comes from a previous incarnation of the device,
+  // which fails it without holding back the first one.
+  RecvTensorBatchRequest request;
+  AddRequest(Key("a"), &request);
+  AddRequest(Key("b", device_->attributes().incarnation() + 1), &request);
+  BatchReceiver receiver(device_, 2);
+  Notification done;
+  Status status;
+  CallOptions opts;
+  worker_->GrpcRecvTensorBatchAsync(&opts, &request, receiver.tensor_done(),
+                                    [&done, &status](const Status& s) {
+                                      status = s;
+                                      done.Notify();
+                                    });
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez->Send(Key("a"), args,
+                            test::AsTensor<float>({1.0, 2.0}), false));
+
+  done.WaitForNotification();
+  EXPECT_TRUE(errors::IsAborted(status)) << status;
+  EXPECT_EQ(std::vector<int>({0}), receiver.indices());
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({1.0, 2.0}),
+                                 receiver.tensor(0));
+  rendezvous_mgr_.Cleanup(kStepId);
+}
+
+// Stands for the GrpcWorker subclasses of other transports.
+class SubclassGrpcWorker : public GrpcWorker {
+ public:
+  explicit SubclassGrpcWorker(WorkerEnv* env) : GrpcWorker(env) {}
+};
+
+TEST_F(GrpcWorkerTest, RecvTensorInline) {
+  setenv("TF_GRPC_WORKER_INLINE_RECV_TENSOR", "false", 1 /* overwrite */);
+  EXPECT_FALSE(NewGrpcWorker(&env_)->recv_tensor_inline());
+  EXPECT_FALSE(SubclassGrpcWorker(&env_).recv_tensor_inline());
+
+  setenv("TF_GRPC_WORKER_INLINE_RECV_TENSOR", "true", 1 /* overwrite */);
+  EXPECT_TRUE(NewGrpcWorker(&env_)->recv_tensor_inline());
+  // Subclasses may block in GrpcRecvTensorAsync(), so they are always served
+  // on the compute pool.
+  EXPECT_FALSE(SubclassGrpcWorker(&env_).recv_tensor_inline());
+
+  unsetenv("TF_GRPC_WORKER_INLINE_RECV_TENSOR");
+  EXPECT_TRUE(NewGrpcWorker(&env_)->recv_tensor_inline());
+}
+
+}  // namespace
+}  // namespace tensorflow
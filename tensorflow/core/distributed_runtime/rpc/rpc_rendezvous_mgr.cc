@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <unordered_map>
 #include <unordered_set>
 
 #include "tensorflow/core/common_runtime/device.h"
@@ -27,20 +28,30 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+// Largest number of tensors received in a single RecvTensorBatch RPC.
+const size_t kMaxRecvTensorBatchSize = 128;
+
+class RpcRecvTensorBatch;
+class RpcRecvTensorCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id,
+                      int64 batch_window_micros)
+      : BaseRemoteRendezvous(env, step_id),
+        batch_window_micros_(batch_window_micros) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -50,6 +61,22 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Adds "call" to the batch of calls to its source worker, which is sent
+  // "batch_window_micros_" after its first call was added, or once it is
+  // full.
+  void AddToBatch(RpcRecvTensorCall* call, std::function<void()> recv_done);
+
+  // Sends "batch" unless it has already been sent because it was full.
+  void FlushBatch(RpcRecvTensorBatch* batch);
+
+  const int64 batch_window_micros_;
+
+  mutex batches_mu_;
+  // Batch being filled, per source worker.  Each batch holds one
+  // reference on behalf of this map.
+  std::unordered_map<string, RpcRecvTensorBatch*> batches_
+      GUARDED_BY(batches_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -83,6 +110,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     {
       mutex_lock l(mu_);
       status_ = Status::OK();
+      batch_ = nullptr;
     }
     done_ = nullptr;
   }
@@ -100,13 +128,10 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     StartRTCall(std::move(recv_done));
   }
 
-  void StartAbort(const Status& s) override {
-    {
-      mutex_lock l(mu_);
-      status_.Update(s);
-    }
-    opts_.StartCancel();
-  }
+  void StartAbort(const Status& s) override;
+
+  // Makes this call part of "batch", which is aborted along with it.
+  void SetBatch(RpcRecvTensorBatch* batch);
 
   Status status() const override {
     mutex_lock l(mu_);
@@ -122,6 +147,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   const Rendezvous::DoneCallback& done() const { return done_; }
 
  private:
+  friend class RpcRecvTensorBatch;
   friend class RpcRemoteRendezvous;
 
   // Start the main RecvTensor call, checking for an async abort.
@@ -155,10 +181,132 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
   mutable mutex mu_;
   Status status_ GUARDED_BY(mu_);
+  // Set if this call is sent as part of a RecvTensorBatch RPC.
+  RpcRecvTensorBatch* batch_ GUARDED_BY(mu_) = nullptr;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorCall);
 };
 
+// A set of RpcRecvTensorCalls of the same step and source worker that are
+// sent in a single RecvTensorBatch RPC, to save the per-RPC overhead of many
+// small tensors.
+class RpcRecvTensorBatch : public core::RefCounted {
+ public:
+  explicit RpcRecvTensorBatch(const string& src_worker)
+      : src_worker_(src_worker) {}
+
+  const string& src_worker() const { return src_worker_; }
+  size_t size() const { return calls_.size(); }
+
+  // Adds "call", whose "recv_done" is invoked once its tensor has been
+  // received, even if the others of the batch are not available yet.
+  //
+  // REQUIRES: Start() has not been called.
+  void Add(RpcRecvTensorCall* call, std::function<void()> recv_done) {
+    calls_.push_back(call);
+    recv_dones_.push_back(std::move(recv_done));
+    call->SetBatch(this);
+  }
+
+  // Sends the calls, as a plain RecvTensor RPC if there is only one.
+  void Start() {
+    Ref();  // Released once every call is done.
+    bool aborted;
+    {
+      mutex_lock l(mu_);
+      aborted = aborted_;
+    }
+    if (aborted) {
+      // The calls already hold the abort status.
+      for (size_t i = 0; i < calls_.size(); ++i) {
+        CallDone(i, Status::OK());
+      }
+      Unref();
+      return;
+    }
+    for (RpcRecvTensorCall* call : calls_) {
+      call->resp_.InitAlloc(call->dst_device_, call->alloc_attrs_);
+    }
+    WorkerInterface* wi = calls_[0]->wi_;
+    if (calls_.size() == 1) {
+      wi->RecvTensorAsync(&opts_, &calls_[0]->req_, &calls_[0]->resp_,
+                          [this](const Status& s) {
+                            CallDone(0, s);
+                            Unref();
+                          });
+      return;
+    }
+    for (RpcRecvTensorCall* call : calls_) {
+      *req_.add_request() = call->req_;
+      resps_.push_back(&call->resp_);
+    }
+    // Each call completes as soon as its own tensor has arrived: a batch
+    // may hold a recv whose tensor the source worker only produces after
+    // this worker has used another tensor of the same batch.
+    wi->RecvTensorBatchAsync(
+        &opts_, &req_, &resps_,
+        [this](int index, const Status& s) { CallDone(index, s); },
+        [this](const Status& s) { Unref(); });
+  }
+
+  void StartAbort() {
+    {
+      mutex_lock l(mu_);
+      aborted_ = true;
+    }
+    opts_.StartCancel();
+  }
+
+ private:
+  ~RpcRecvTensorBatch() override {}
+
+  void CallDone(int index, const Status& s) {
+    if (!s.ok()) {
+      mutex_lock l(calls_[index]->mu_);
+      calls_[index]->status_.Update(s);
+    }
+    recv_dones_[index]();
+  }
+
+  const string src_worker_;
+  std::vector<RpcRecvTensorCall*> calls_;
+  std::vector<std::function<void()>> recv_dones_;
+  CallOptions opts_;
+  RecvTensorBatchRequest req_;
+  std::vector<TensorResponse*> resps_;
+
+  mutex mu_;
+  bool aborted_ GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorBatch);
+};
+
+void RpcRecvTensorCall::StartAbort(const Status& s) {
+  RpcRecvTensorBatch* batch;
+  {
+    mutex_lock l(mu_);
+    status_.Update(s);
+    batch = batch_;
+  }
+  if (batch != nullptr) {
+    batch->StartAbort();
+  } else {
+    opts_.StartCancel();
+  }
+}
+
+void RpcRecvTensorCall::SetBatch(RpcRecvTensorBatch* batch) {
+  bool aborted;
+  {
+    mutex_lock l(mu_);
+    batch_ = batch;
+    aborted = !status_.ok();
+  }
+  if (aborted) {
+    batch->StartAbort();
+  }
+}
+
 class RpcRecvTensorFreeList {
  public:
   RpcRecvTensorFreeList() {}
@@ -246,7 +394,7 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 
   // Start "call".
   Ref();
-  call->Start([this, call]() {
+  std::function<void()> recv_done = [this, call]() {
     // Removes "call" from active_. Prevent StartAbort().
     DeregisterCall(call);
     // If StartAbort was called prior to DeregisterCall, then the
@@ -257,17 +405,70 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     call->wi_ = nullptr;
     get_call_freelist()->Release(call, session()->worker_cache.get());
     Unref();
-  });
+  };
+  if (batch_window_micros_ > 0) {
+    AddToBatch(call, std::move(recv_done));
+  } else {
+    call->Start(std::move(recv_done));
+  }
+}
+
+void RpcRemoteRendezvous::AddToBatch(RpcRecvTensorCall* call,
+                                     std::function<void()> recv_done) {
+  RpcRecvTensorBatch* full_batch = nullptr;
+  {
+    mutex_lock l(batches_mu_);
+    RpcRecvTensorBatch*& batch = batches_[call->src_worker_];
+    if (batch == nullptr) {
+      batch = new RpcRecvTensorBatch(call->src_worker_);
+      RpcRecvTensorBatch* new_batch = batch;
+      new_batch->Ref();
+      Ref();
+      env_->env->SchedClosureAfter(batch_window_micros_, [this, new_batch]() {
+        FlushBatch(new_batch);
+        new_batch->Unref();
+        Unref();
+      });
+    }
+    batch->Add(call, std::move(recv_done));
+    if (batch->size() >= kMaxRecvTensorBatchSize) {
+      full_batch = batch;
+      batches_.erase(call->src_worker_);
+    }
+  }
+  if (full_batch != nullptr) {
+    full_batch->Start();
+    full_batch->Unref();
+  }
+}
+
+void RpcRemoteRendezvous::FlushBatch(RpcRecvTensorBatch* batch) {
+  {
+    mutex_lock l(batches_mu_);
+    auto it = batches_.find(batch->src_worker());
+    if (it == batches_.end() || it->second != batch) {
+      return;  // Already sent because it was full.
+    }
+    batches_.erase(it);
+  }
+  batch->Start();
+  batch->Unref();
 }
 
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+    : BaseRendezvousMgr(env) {
+  Status s = ReadInt64FromEnvVar("TF_RECV_TENSOR_BATCH_WINDOW_MICROS", 0,
+                                 &batch_window_micros_);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+  }
+}
 
 BaseRemoteRendezvous* RpcRendezvousMgr::Create(int64 step_id,
                                                const WorkerEnv* worker_env) {
-  return new RpcRemoteRendezvous(worker_env, step_id);
+  return new RpcRemoteRendezvous(worker_env, step_id, batch_window_micros_);
 }
 
 }  // end namespace tensorflow
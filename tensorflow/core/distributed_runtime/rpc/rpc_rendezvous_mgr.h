@@ -42,6 +42,10 @@ class DeviceMgr;
 //
 // Tensors sent and recved through rendezvous managed by this
 // RendezvousMgr must have keys generated by Rendezvous::CreateKey.
+//
+// If the TF_RECV_TENSOR_BATCH_WINDOW_MICROS environment variable is set,
+// the remote recvs of a step from the same worker that start within that
+// many microseconds of each other are sent in a single RecvTensorBatch RPC.
 class RpcRendezvousMgr : public BaseRendezvousMgr {
  public:
   explicit RpcRendezvousMgr(const WorkerEnv* env);
@@ -50,6 +54,8 @@ class RpcRendezvousMgr : public BaseRendezvousMgr {
   BaseRemoteRendezvous* Create(int64 step_id, const WorkerEnv* worker_env);
 
  private:
+  int64 batch_window_micros_ = 0;
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRendezvousMgr);
 };
 
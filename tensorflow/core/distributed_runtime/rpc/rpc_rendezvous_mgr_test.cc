@@ -15,7 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <stdlib.h>
+#include <atomic>
+
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/worker_cache.h"
+#include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/control_flow.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
@@ -23,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
 
@@ -198,6 +207,187 @@ TEST_F(RpcRendezvousMgrTest, TransferDummyDeviceContext) {
   dc->Unref();
 }
 
+namespace {
+// Serves the tensors sent to "remote" as a remote worker would.
+class FakeRemoteWorker : public WorkerInterface {
+ public:
+  explicit FakeRemoteWorker(Rendezvous* remote) : remote_(remote) {}
+
+  int num_batches() const { return num_batches_; }
+
+  void RecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
+                       TensorResponse* response, StatusCallback done) override {
+    Rendezvous::ParsedKey key;
+    Status s = Rendezvous::ParseKey(request->rendezvous_key(), &key);
+    if (!s.ok()) {
+      done(s);
+      return;
+    }
+    remote_->RecvAsync(
+        key, Rendezvous::Args(),
+        [response, done](const Status& s, const Rendezvous::Args& send_args,
+                         const Rendezvous::Args& recv_args, const Tensor& val,
+                         bool is_dead) {
+          if (!s.ok()) {
+            done(s);
+            return;
+          }
+          RecvTensorResponse proto;
+          proto.set_is_dead(is_dead);
+          val.AsProtoField(proto.mutable_tensor());
+          done(response->InitFrom(&proto));
+        });
+  }
+
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            std::vector<TensorResponse*>* responses,
+                            std::function<void(int, const Status&)> tensor_done,
+                            StatusCallback done) override {
+    ++num_batches_;
+    WorkerInterface::RecvTensorBatchAsync(opts, request, responses,
+                                          std::move(tensor_done),
+                                          std::move(done));
+  }
+
+  // Not used by the rendezvous.
+  void GetStatusAsync(const GetStatusRequest* request,
+                      GetStatusResponse* response,
+                      StatusCallback done) override {}
+  void CreateWorkerSessionAsync(const CreateWorkerSessionRequest* request,
+                                CreateWorkerSessionResponse* response,
+                                StatusCallback done) override {}
+  void DeleteWorkerSessionAsync(CallOptions* opts,
+                                const DeleteWorkerSessionRequest* request,
+                                DeleteWorkerSessionResponse* response,
+                                StatusCallback done) override {}
+  void RegisterGraphAsync(const RegisterGraphRequest* request,
+                          RegisterGraphResponse* response,
+                          StatusCallback done) override {}
+  void DeregisterGraphAsync(const DeregisterGraphRequest* request,
+                            DeregisterGraphResponse* response,
+                            StatusCallback done) override {}
+  void RunGraphAsync(CallOptions* opts, RunGraphRequestWrapper* request,
+                     MutableRunGraphResponseWrapper* response,
+                     StatusCallback done) override {}
+  void CleanupGraphAsync(const CleanupGraphRequest* request,
+                         CleanupGraphResponse* response,
+                         StatusCallback done) override {}
+  void CleanupAllAsync(const CleanupAllRequest* request,
+                       CleanupAllResponse* response,
+                       StatusCallback done) override {}
+  void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
+                    StatusCallback done) override {}
+  void TracingAsync(const TracingRequest* request, TracingResponse* response,
+                    StatusCallback done) override {}
+
+ private:
+  Rendezvous* const remote_;  // Not owned.
+  std::atomic<int> num_batches_{0};
+};
+
+// Worker cache that knows a single remote worker.
+class FakeWorkerCache : public WorkerCacheInterface {
+ public:
+  FakeWorkerCache(const string& target, WorkerInterface* worker)
+      : target_(target), worker_(worker) {}
+
+  void ListWorkers(std::vector<string>* workers) const override {
+    workers->push_back(target_);
+  }
+  WorkerInterface* CreateWorker(const string& target) override {
+    return target == target_ ? worker_ : nullptr;
+  }
+  void ReleaseWorker(const string& target, WorkerInterface* worker) override {}
+  bool GetDeviceLocalityNonBlocking(const string& device,
+                                    DeviceLocality* locality) override {
+    return false;
+  }
+  void GetDeviceLocalityAsync(const string& device, DeviceLocality* locality,
+                              StatusCallback done) override {}
+
+ private:
+  const string target_;
+  WorkerInterface* const worker_;  // Not owned.
+};
+}  // namespace
+
+class RpcRendezvousMgrBatchTest : public ::testing::Test {
+ protected:
+  RpcRendezvousMgrBatchTest()
+      : remote_(NewLocalRendezvous()),
+        remote_worker_(remote_),
+        worker_session_(
+            "rpc_session", "/job:mnist/replica:1/task:2",
+            std::unique_ptr<WorkerCacheInterface>(new FakeWorkerCache(
+                "/job:worker/replica:0/task:0", &remote_worker_)),
+            std::unique_ptr<DeviceMgr>(new DeviceMgr({DeviceFactory::NewDevice(
+                "CPU", SessionOptions(), "/job:mnist/replica:1/task:2")})),
+            std::unique_ptr<GraphMgr>()) {
+    env_.env = Env::Default();
+  }
+
+  ~RpcRendezvousMgrBatchTest() override { remote_->Unref(); }
+
+  Rendezvous::ParsedKey RemoteKey(const string& name) {
+    return MakeKey(Rendezvous::CreateKey(
+        "/job:worker/replica:0/task:0/device:CPU:0", 7890,
+        "/job:mnist/replica:1/task:2/device:CPU:0", name, FrameAndIter(0, 0)));
+  }
+
+  Rendezvous* remote_;
+  FakeRemoteWorker remote_worker_;
+  WorkerSession worker_session_;
+  WorkerEnv env_;
+};
+
+// The source worker only produces "b" once "a" has been received, as when
+// the two workers exchange tensors back and forth within a step.  "b" must
+// not wait for the batch it shares with "a" to complete.
+TEST_F(RpcRendezvousMgrBatchTest, CrossDependency) {
+  setenv("TF_RECV_TENSOR_BATCH_WINDOW_MICROS", "100000", 1 /* overwrite */);
+  RpcRendezvousMgr rmgr(&env_);
+  unsetenv("TF_RECV_TENSOR_BATCH_WINDOW_MICROS");
+
+  const int64 step_id = 123;
+  RemoteRendezvous* rendez = rmgr.Find(step_id);
+  core::ScopedUnref unref(rendez);
+  TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+
+  const Rendezvous::ParsedKey key_a = RemoteKey("a");
+  const Rendezvous::ParsedKey key_b = RemoteKey("b");
+  Rendezvous::Args args;
+  Notification b_received;
+  Status b_status;
+  string b_value;
+  rendez->RecvAsync(key_b, args,
+                    [&](const Status& s, const Rendezvous::Args& send_args,
+                        const Rendezvous::Args& recv_args, const Tensor& val,
+                        bool is_dead) {
+                      b_status = s;
+                      if (s.ok()) b_value = V(val);
+                      b_received.Notify();
+                    });
+  rendez->RecvAsync(key_a, args,
+                    [&](const Status& s, const Rendezvous::Args& send_args,
+                        const Rendezvous::Args& recv_args, const Tensor& val,
+                        bool is_dead) {
+                      TF_EXPECT_OK(s);
+                      if (s.ok()) {
+                        TF_EXPECT_OK(remote_->Send(
+                            key_b, args, V(V(val) + " banana"), false));
+                      }
+                    });
+  TF_ASSERT_OK(remote_->Send(key_a, args, V("apple"), false));
+
+  b_received.WaitForNotification();
+  TF_EXPECT_OK(b_status);
+  EXPECT_EQ("apple banana", b_value);
+  // Both recvs went in the same batch.
+  EXPECT_EQ(1, remote_worker_.num_batches());
+  rmgr.Cleanup(step_id);
+}
+
 // NOTE: Remote Send/Recv is better tested in worker_test.cc
 
 }  // namespace tensorflow
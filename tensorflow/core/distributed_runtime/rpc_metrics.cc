@@ -0,0 +1,290 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc_metrics.h"
+
+#include <atomic>
+#include <deque>
+#include <unordered_map>
+
+#include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace rpc_metrics {
+
+namespace {
+
+const char kMetricPrefix[] = "/tensorflow/core/rpc/";
+
+// Buckets of the latency histograms: 10us to ~160s.
+std::unique_ptr<monitoring::Buckets> LatencyBuckets() {
+  return monitoring::Buckets::Exponential(10, 2, 24);
+}
+
+auto* client_latency = monitoring::Sampler<2>::New(
+    {"/tensorflow/core/rpc/client_latency",
+     "Latency in microseconds of the RPCs issued by this task.", "method",
+     "peer"},
+    LatencyBuckets());
+
+auto* client_bytes_sent = monitoring::Counter<1>::New(
+    "/tensorflow/core/rpc/client_bytes_sent",
+    "Bytes of the requests of the RPCs issued by this task.", "method");
+
+auto* client_bytes_received = monitoring::Counter<1>::New(
+    "/tensorflow/core/rpc/client_bytes_received",
+    "Bytes of the responses of the RPCs issued by this task.", "method");
+
+auto* server_queueing = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/rpc/server_queueing_delay",
+     "Time in microseconds the RPCs served by this task waited for a "
+     "handler thread.",
+     "method"},
+    LatencyBuckets());
+
+auto* rendezvous_wait = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/rpc/rendezvous_wait",
+     "Time in microseconds tensors were waited for in the rendezvous.",
+     "kind"},
+    LatencyBuckets());
+
+const char* RendezvousWaitName(RendezvousWait kind) {
+  switch (kind) {
+    case RendezvousWait::kLocal:
+      return "local";
+    case RendezvousWait::kRemote:
+      return "remote";
+    case RendezvousWait::kServe:
+      return "serve";
+  }
+  return "unknown";
+}
+
+// Returns the last component of a gRPC method name, e.g. "RunGraph".
+string ShortMethodName(const string& method) {
+  const size_t pos = method.rfind('/');
+  return pos == string::npos ? method : method.substr(pos + 1);
+}
+
+// A bounded buffer of Chrome trace "complete" events.
+class TraceBuffer {
+ public:
+  static TraceBuffer* Get() {
+    static TraceBuffer* buffer = new TraceBuffer;
+    return buffer;
+  }
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  void set_enabled(bool enabled) { enabled_.store(enabled); }
+
+  void Add(string name, string category, string track, int64 start_micros,
+           int64 end_micros) {
+    mutex_lock l(mu_);
+    if (events_.size() >= kMaxEvents) events_.pop_front();
+    events_.push_back({std::move(name), std::move(category), std::move(track),
+                       start_micros, end_micros - start_micros});
+  }
+
+  string CollectJson() {
+    std::deque<Event> events;
+    {
+      mutex_lock l(mu_);
+      events.swap(events_);
+    }
+    // Every track, e.g. a peer, is shown as a thread of a single process.
+    std::unordered_map<string, int> tids;
+    string json = "{\"traceEvents\":[";
+    bool first = true;
+    for (const Event& event : events) {
+      auto it = tids.find(event.track);
+      if (it == tids.end()) {
+        it = tids.insert({event.track, tids.size()}).first;
+        strings::StrAppend(&json, first ? "" : ",",
+                           "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                           "\"tid\":",
+                           it->second, ",\"args\":{\"name\":\"",
+                           str_util::CEscape(event.track), "\"}}");
+        first = false;
+      }
+      strings::StrAppend(&json, first ? "" : ",", "{\"name\":\"",
+                         str_util::CEscape(event.name), "\",\"cat\":\"",
+                         event.category, "\",\"ph\":\"X\",\"pid\":0,\"tid\":",
+                         it->second, ",\"ts\":", event.start_micros,
+                         ",\"dur\":", event.duration_micros, "}");
+      first = false;
+    }
+    strings::StrAppend(&json, "]}");
+    return json;
+  }
+
+ private:
+  static const size_t kMaxEvents = 1 << 16;
+
+  struct Event {
+    string name;
+    string category;
+    string track;
+    int64 start_micros;
+    int64 duration_micros;
+  };
+
+  std::atomic<bool> enabled_{false};
+  mutex mu_;
+  std::deque<Event> events_ GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+void RecordClientCall(const string& method, const string& peer,
+                      int64 start_micros, int64 end_micros, int64 bytes_sent,
+                      int64 bytes_received) {
+  const string short_method = ShortMethodName(method);
+  client_latency->GetCell(short_method, peer)->Add(end_micros - start_micros);
+  client_bytes_sent->GetCell(short_method)->IncrementBy(bytes_sent);
+  client_bytes_received->GetCell(short_method)->IncrementBy(bytes_received);
+  TraceBuffer* trace = TraceBuffer::Get();
+  if (trace->enabled()) {
+    trace->Add(short_method, "rpc", strings::StrCat("client to ", peer),
+               start_micros, end_micros);
+  }
+}
+
+void RecordServerQueueing(const string& method, int64 arrival_micros,
+                          int64 start_micros) {
+  const string short_method = ShortMethodName(method);
+  server_queueing->GetCell(short_method)->Add(start_micros - arrival_micros);
+  TraceBuffer* trace = TraceBuffer::Get();
+  if (trace->enabled()) {
+    trace->Add(short_method, "queueing", "server queueing", arrival_micros,
+               start_micros);
+  }
+}
+
+void RecordRendezvousWait(RendezvousWait kind, int64 start_micros,
+                          int64 end_micros) {
+  const char* name = RendezvousWaitName(kind);
+  rendezvous_wait->GetCell(name)->Add(end_micros - start_micros);
+  TraceBuffer* trace = TraceBuffer::Get();
+  if (trace->enabled()) {
+    trace->Add(name, "rendezvous", strings::StrCat("rendezvous ", name),
+               start_micros, end_micros);
+  }
+}
+
+void SetTracing(bool enabled) { TraceBuffer::Get()->set_enabled(enabled); }
+
+string CollectTraceEvents() { return TraceBuffer::Get()->CollectJson(); }
+
+string Snapshot() {
+  monitoring::CollectionRegistry::CollectMetricsOptions options;
+  options.collect_metric_descriptors = false;
+  std::unique_ptr<monitoring::CollectedMetrics> metrics =
+      monitoring::CollectionRegistry::Default()->CollectMetrics(options);
+  string snapshot;
+  for (const auto& name_and_points : metrics->point_set_map) {
+    if (!str_util::StartsWith(name_and_points.first, kMetricPrefix)) continue;
+    for (const auto& point : name_and_points.second->points) {
+      strings::StrAppend(&snapshot, name_and_points.first, "{");
+      for (size_t i = 0; i < point->labels.size(); ++i) {
+        strings::StrAppend(&snapshot, i > 0 ? "," : "", point->labels[i].name,
+                           "=", point->labels[i].value);
+      }
+      strings::StrAppend(&snapshot, "} ");
+      if (point->value_type == monitoring::ValueType::kHistogram) {
+        histogram::Histogram h;
+        h.DecodeFromProto(point->histogram_value);
+        const HistogramProto& proto = point->histogram_value;
+        strings::StrAppend(
+            &snapshot, "count=", proto.num(),
+            " mean=", proto.num() > 0 ? proto.sum() / proto.num() : 0.0,
+            " p50=", h.Percentile(50), " p99=", h.Percentile(99),
+            " max=", proto.max(), "\n");
+      } else {
+        strings::StrAppend(&snapshot, point->int64_value, "\n");
+      }
+    }
+  }
+  return snapshot;
+}
+
+PeriodicExporter::PeriodicExporter(Env* env, int64 interval_micros,
+                                   const string& trace_path)
+    : env_(env), interval_micros_(interval_micros), trace_path_(trace_path) {
+  if (!trace_path_.empty()) SetTracing(true);
+  thread_.reset(env_->StartThread(ThreadOptions(), "rpc_metrics_exporter",
+                                  [this]() { Run(); }));
+}
+
+PeriodicExporter::~PeriodicExporter() {
+  {
+    mutex_lock l(mu_);
+    stopping_ = true;
+    cond_var_.notify_all();
+  }
+  thread_.reset();
+  if (!trace_path_.empty()) SetTracing(false);
+}
+
+void PeriodicExporter::Run() {
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      const int64 deadline = env_->NowMicros() + interval_micros_;
+      while (!stopping_ && env_->NowMicros() < deadline) {
+        cond_var_.wait_for(
+            l, std::chrono::microseconds(deadline - env_->NowMicros()));
+      }
+      if (stopping_) return;
+    }
+    Export();
+  }
+}
+
+void PeriodicExporter::Export() {
+  LOG(INFO) << "RPC metrics:\n" << Snapshot();
+  if (trace_path_.empty()) return;
+  const string path = strings::StrCat(trace_path_, ".", num_traces_++, ".json");
+  Status s = WriteStringToFile(env_, path, CollectTraceEvents());
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to write RPC trace events to " << path << ": "
+                 << s;
+  }
+}
+
+std::unique_ptr<PeriodicExporter> MaybeCreateExporterFromEnv(Env* env) {
+  int64 interval_secs = 0;
+  Status s =
+      ReadInt64FromEnvVar("TF_RPC_METRICS_EXPORT_SECS", 0, &interval_secs);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+    return nullptr;
+  }
+  if (interval_secs <= 0) return nullptr;
+  string trace_path;
+  s = ReadStringFromEnvVar("TF_RPC_METRICS_TRACE_PATH", "", &trace_path);
+  if (!s.ok()) LOG(WARNING) << s;
+  return std::unique_ptr<PeriodicExporter>(
+      new PeriodicExporter(env, interval_secs * 1000000, trace_path));
+}
+
+}  // namespace rpc_metrics
+}  // namespace tensorflow
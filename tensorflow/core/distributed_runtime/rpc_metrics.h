@@ -0,0 +1,109 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_METRICS_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_METRICS_H_
+
+#include <memory>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Always-on metrics of the RPCs exchanged by the tasks of a cluster, kept in
+// the monitoring CollectionRegistry under "/tensorflow/core/rpc/".  Unlike
+// the WorkerCacheLogger, which only records RecvTensor calls of the steps
+// that ask for step stats, these cover every call, so that network stalls
+// can be told apart from compute stalls in production.
+//
+// All times are in microseconds, as returned by Env::NowMicros().
+namespace rpc_metrics {
+
+// Records a client call of `method` (a gRPC method name such as
+// "/tensorflow.WorkerService/RunGraph") to `peer`.
+void RecordClientCall(const string& method, const string& peer,
+                      int64 start_micros, int64 end_micros, int64 bytes_sent,
+                      int64 bytes_received);
+
+// Records the time a server call of `method` waited between its arrival and
+// the start of its handler.
+void RecordServerQueueing(const string& method, int64 arrival_micros,
+                          int64 start_micros);
+
+// Kinds of rendezvous waits.
+enum class RendezvousWait {
+  // A Recv of a tensor produced by the same worker.
+  kLocal,
+  // A Recv of a tensor produced by another worker: the network time plus
+  // the time the other worker took to produce the tensor.
+  kRemote,
+  // A RecvTensor call from another worker waiting for the tensor to be
+  // produced here.
+  kServe,
+};
+
+// Records a wait of the given kind in the rendezvous.
+void RecordRendezvousWait(RendezvousWait kind, int64 start_micros,
+                          int64 end_micros);
+
+// While enabled, the calls above also record Chrome trace events, up to a
+// bounded number.
+void SetTracing(bool enabled);
+
+// Returns the trace events recorded so far in the Chrome trace JSON format,
+// and discards them.
+string CollectTraceEvents();
+
+// Returns a text snapshot of the current value of the metrics, one line per
+// metric and label values.
+string Snapshot();
+
+// Periodically logs a snapshot of the metrics, and if `trace_path` is not
+// empty, writes the trace events recorded since the last period to
+// `trace_path`.<n>.json.
+class PeriodicExporter {
+ public:
+  PeriodicExporter(Env* env, int64 interval_micros, const string& trace_path);
+  ~PeriodicExporter();
+
+ private:
+  void Run();
+  void Export();
+
+  Env* const env_;
+  const int64 interval_micros_;
+  const string trace_path_;
+  int64 num_traces_ = 0;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  bool stopping_ GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PeriodicExporter);
+};
+
+// Returns a PeriodicExporter configured by the environment variables
+// TF_RPC_METRICS_EXPORT_SECS and TF_RPC_METRICS_TRACE_PATH, or nullptr if
+// the former is not positive.
+std::unique_ptr<PeriodicExporter> MaybeCreateExporterFromEnv(Env* env);
+
+}  // namespace rpc_metrics
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_METRICS_H_
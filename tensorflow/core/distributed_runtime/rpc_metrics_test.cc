@@ -0,0 +1,90 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc_metrics.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace rpc_metrics {
+namespace {
+
+bool Contains(const string& s, const string& part) {
+  return s.find(part) != string::npos;
+}
+
+TEST(RpcMetricsTest, Snapshot) {
+  RecordClientCall("/tensorflow.WorkerService/RunGraph", "ipv4:10.0.0.1:2222",
+                   1000, 1500, 100, 20);
+  RecordClientCall("/tensorflow.WorkerService/RunGraph", "ipv4:10.0.0.1:2222",
+                   2000, 2100, 50, 30);
+  RecordServerQueueing("/tensorflow.WorkerService/RecvTensor", 1000, 1040);
+  RecordRendezvousWait(RendezvousWait::kRemote, 1000, 3000);
+
+  const string snapshot = Snapshot();
+  EXPECT_TRUE(Contains(snapshot,
+                       "/tensorflow/core/rpc/client_latency{method=RunGraph,"
+                       "peer=ipv4:10.0.0.1:2222} count=2 mean=300"))
+      << snapshot;
+  EXPECT_TRUE(Contains(
+      snapshot, "/tensorflow/core/rpc/client_bytes_sent{method=RunGraph} 150"))
+      << snapshot;
+  EXPECT_TRUE(Contains(
+      snapshot,
+      "/tensorflow/core/rpc/client_bytes_received{method=RunGraph} 50"))
+      << snapshot;
+  EXPECT_TRUE(Contains(snapshot,
+                       "/tensorflow/core/rpc/server_queueing_delay{method="
+                       "RecvTensor} count=1 mean=40"))
+      << snapshot;
+  EXPECT_TRUE(Contains(
+      snapshot,
+      "/tensorflow/core/rpc/rendezvous_wait{kind=remote} count=1 mean=2000"))
+      << snapshot;
+}
+
+TEST(RpcMetricsTest, TraceEvents) {
+  // Nothing is recorded while tracing is disabled.
+  RecordRendezvousWait(RendezvousWait::kLocal, 0, 10);
+  EXPECT_EQ("{\"traceEvents\":[]}", CollectTraceEvents());
+
+  SetTracing(true);
+  RecordClientCall("/tensorflow.WorkerService/RecvTensor", "ipv4:10.0.0.2:2222",
+                   100, 150, 10, 10);
+  RecordRendezvousWait(RendezvousWait::kServe, 120, 130);
+  SetTracing(false);
+
+  const string trace = CollectTraceEvents();
+  EXPECT_TRUE(Contains(trace,
+                       "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                       "\"tid\":0,\"args\":{\"name\":\"client to "
+                       "ipv4:10.0.0.2:2222\"}}"))
+      << trace;
+  EXPECT_TRUE(Contains(trace,
+                       "{\"name\":\"RecvTensor\",\"cat\":\"rpc\",\"ph\":\"X\","
+                       "\"pid\":0,\"tid\":0,\"ts\":100,\"dur\":50}"))
+      << trace;
+  EXPECT_TRUE(Contains(trace,
+                       "{\"name\":\"serve\",\"cat\":\"rendezvous\",\"ph\":"
+                       "\"X\",\"pid\":0,\"tid\":1,\"ts\":120,\"dur\":10}"))
+      << trace;
+
+  // The events are only returned once.
+  EXPECT_EQ("{\"traceEvents\":[]}", CollectTraceEvents());
+}
+
+}  // namespace
+}  // namespace rpc_metrics
+}  // namespace tensorflow
@@ -260,6 +260,12 @@ bool TensorResponse::ParseFast(Source* source) {
           return false;
         break;
       }
+      case RecvTensorResponse::kContentChunkBytesFieldNumber: {
+        protobuf_uint64 v;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint64(&v)) return false;
+        meta_.set_content_chunk_bytes(static_cast<int64>(v));
+        break;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
@@ -291,4 +297,49 @@ bool TensorResponse::ParseSlow(Source* source) {
   return true;
 }
 
+Status TensorResponse::ParseChunkFrom(Source* source, int64* offset) {
+  if (!on_host_ || meta_.content_chunk_bytes() <= 0) {
+    return errors::FailedPrecondition(
+        "Received a tensor content chunk without a chunked response");
+  }
+  protobuf::io::CodedInputStream input(source->contents());
+  input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
+
+  // The chunk is a RecvTensorResponse whose only field is
+  // tensor().tensor_content(), which we read straight into tensor_.
+  uint32 tag = input.ReadTag();
+  int length;
+  if (GetTagFieldNumber(tag) != RecvTensorResponse::kTensorFieldNumber ||
+      GetTagWireType(tag) != WIRETYPE_LENGTH_DELIMITED ||
+      !ReadVarintSizeAsInt(&input, &length)) {
+    return errors::InvalidArgument("Cannot parse tensor chunk from response");
+  }
+  std::pair<protobuf::io::CodedInputStream::Limit, int> p =
+      input.IncrementRecursionDepthAndPushLimit(length);
+  tag = input.ReadTag();
+  int num_bytes;
+  if (p.second < 0 ||
+      GetTagFieldNumber(tag) != TensorProto::kTensorContentFieldNumber ||
+      GetTagWireType(tag) != WIRETYPE_LENGTH_DELIMITED ||
+      !ReadVarintSizeAsInt(&input, &num_bytes)) {
+    return errors::InvalidArgument("Cannot parse tensor chunk from response");
+  }
+  StringPiece buf = tensor_.tensor_data();
+  if (num_bytes > meta_.content_chunk_bytes() ||
+      *offset + num_bytes > static_cast<int64>(buf.size())) {
+    return errors::InvalidArgument("Tensor chunk of ", num_bytes,
+                                   " bytes at offset ", *offset,
+                                   " does not fit a tensor of ", buf.size(),
+                                   " bytes");
+  }
+  if (!input.ReadRaw(const_cast<char*>(buf.data()) + *offset, num_bytes) ||
+      input.BytesUntilLimit() != 0 ||
+      !input.DecrementRecursionDepthAndPopLimit(p.first) ||
+      input.ReadTag() != 0) {
+    return errors::InvalidArgument("Cannot parse tensor chunk from response");
+  }
+  *offset += num_bytes;
+  return Status::OK();
+}
+
 }  // namespace tensorflow
@@ -70,6 +70,15 @@ class TensorResponse {
   // source->contents() into *this.
   Status ParseFrom(Source* source);
 
+  // Parse a response of RecvTensorStream that follows one with a non-zero
+  // "content_chunk_bytes", i.e. that holds only a piece of the tensor
+  // content, and copy that piece into tensor() at byte "*offset".  Advances
+  // "*offset" past the piece.
+  //
+  // REQUIRES: ParseFrom() was last called on the first response of the
+  // stream.
+  Status ParseChunkFrom(Source* source, int64* offset);
+
   // Initialize tensor from *response.
   // Leaves *response with unspecified contents.
   Status InitFrom(RecvTensorResponse* response);
@@ -78,6 +87,9 @@ class TensorResponse {
   // uninitialized backing storage for actual contents.
   void InitPartial(const RecvTensorResponse& response);
 
+  // Return true if the tensor is allocated in host memory.
+  bool on_host() const { return on_host_; }
+
   // Return a reference to the parsed tensor.  The tensor will remain
   // live only until *this is destroyed or modified.
   const Tensor& tensor() const { return tensor_; }
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -156,6 +157,53 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, ParseChunks) {
+  const int kElems = 1000;
+  const int kChunkBytes = 1000;
+  Tensor src(DT_INT32, TensorShape({10, kElems / 10}));
+  for (int i = 0; i < kElems; ++i) {
+    src.flat<int32>()(i) = i;
+  }
+  StringPiece content = src.tensor_data();
+
+  RecvTensorResponse header;
+  header.set_send_start_micros(123456);
+  header.set_content_chunk_bytes(kChunkBytes);
+  header.mutable_tensor()->set_dtype(src.dtype());
+  src.shape().AsProto(header.mutable_tensor()->mutable_tensor_shape());
+  string encoded;
+  header.AppendToString(&encoded);
+
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  StringSource header_source(&encoded, 1024);
+  TF_ASSERT_OK(response.ParseFrom(&header_source));
+  EXPECT_EQ(kChunkBytes, response.metadata().content_chunk_bytes());
+
+  int64 offset = 0;
+  for (size_t pos = 0; pos < content.size(); pos += kChunkBytes) {
+    RecvTensorResponse chunk;
+    chunk.mutable_tensor()->set_tensor_content(
+        content.substr(pos, kChunkBytes).ToString());
+    encoded.clear();
+    chunk.AppendToString(&encoded);
+    StringSource chunk_source(&encoded, 100);
+    TF_ASSERT_OK(response.ParseChunkFrom(&chunk_source, &offset));
+  }
+  EXPECT_EQ(content.size(), offset);
+  EXPECT_EQ(src.DebugString(), response.tensor().DebugString());
+  test::ExpectTensorEqual<int32>(src, response.tensor());
+
+  // A chunk past the end of the tensor is rejected.
+  RecvTensorResponse extra;
+  extra.mutable_tensor()->set_tensor_content("abcd");
+  encoded.clear();
+  extra.AppendToString(&encoded);
+  StringSource extra_source(&encoded, -1);
+  EXPECT_FALSE(response.ParseChunkFrom(&extra_source, &offset).ok());
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
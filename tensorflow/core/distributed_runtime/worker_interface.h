@@ -17,11 +17,14 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_INTERFACE_H_
 
 #include <functional>
+#include <vector>
 
 #include "tensorflow/core/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/message_wrappers.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
@@ -106,6 +109,20 @@ class WorkerInterface {
                                TensorResponse* response,
                                StatusCallback done) = 0;
 
+  // Receives the tensors asked for by "request" into "*responses", which
+  // holds one TensorResponse per RecvTensorRequest.  "tensor_done" is
+  // called with the index and status of each tensor as soon as that tensor
+  // has been received or has failed, without waiting for the others.
+  // "done" is called once "tensor_done" has been called for every tensor.
+  //
+  // The default implementation issues one RecvTensorAsync() call per
+  // tensor.
+  virtual void RecvTensorBatchAsync(
+      CallOptions* opts, const RecvTensorBatchRequest* request,
+      std::vector<TensorResponse*>* responses,
+      std::function<void(int, const Status&)> tensor_done,
+      StatusCallback done);
+
   virtual void LoggingAsync(const LoggingRequest* request,
                             LoggingResponse* response, StatusCallback done) = 0;
 
@@ -199,6 +216,52 @@ class WorkerInterface {
   }
 };
 
+inline void WorkerInterface::RecvTensorBatchAsync(
+    CallOptions* opts, const RecvTensorBatchRequest* request,
+    std::vector<TensorResponse*>* responses,
+    std::function<void(int, const Status&)> tensor_done, StatusCallback done) {
+  struct BatchState {
+    explicit BatchState(int num_tensors)
+        : pending(num_tensors), opts(num_tensors) {}
+
+    mutex mu;
+    int pending GUARDED_BY(mu);
+    Status status GUARDED_BY(mu);
+    // Each tensor is received with its own CallOptions, all of which are
+    // cancelled with "opts".
+    std::vector<CallOptions> opts;
+  };
+
+  const int num_tensors = request->request_size();
+  CHECK_EQ(num_tensors, responses->size());
+  if (num_tensors == 0) {
+    done(Status::OK());
+    return;
+  }
+  BatchState* state = new BatchState(num_tensors);
+  opts->SetCancelCallback([state]() {
+    for (CallOptions& tensor_opts : state->opts) {
+      tensor_opts.StartCancel();
+    }
+  });
+  for (int i = 0; i < num_tensors; ++i) {
+    RecvTensorAsync(&state->opts[i], &request->request(i), (*responses)[i],
+                    [opts, tensor_done, done, state, i](const Status& s) {
+                      tensor_done(i, s);
+                      Status status;
+                      {
+                        mutex_lock l(state->mu);
+                        state->status.Update(s);
+                        if (--state->pending > 0) return;
+                        status = state->status;
+                      }
+                      opts->ClearCancelCallback();
+                      delete state;
+                      done(status);
+                    });
+  }
+}
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_INTERFACE_H_
@@ -50,6 +50,9 @@ CollInstanceParams& CollInstanceParams::operator=(
     impl_details.subdiv_source_rank.assign(
         other.impl_details.subdiv_source_rank.begin(),
         other.impl_details.subdiv_source_rank.end());
+    impl_details.reduction_algorithm = other.impl_details.reduction_algorithm;
+    compression = other.compression;
+    top_k_fraction = other.top_k_fraction;
   }
   return *this;
 }
@@ -85,6 +88,16 @@ string CollInstanceParams::ToString() const {
     strings::StrAppend(&v, "}");
   }
   strings::StrAppend(&v, "}");  // all subdivs
+  if (type == REDUCTION_COLLECTIVE) {
+    strings::StrAppend(&v, " reduction_algorithm=",
+                       impl_details.reduction_algorithm);
+    if (compression != NO_COMPRESSION) {
+      strings::StrAppend(&v, " compression=", compression);
+      if (compression == TOP_K_COMPRESSION) {
+        strings::StrAppend(&v, " top_k_fraction=", top_k_fraction);
+      }
+    }
+  }
   return v;
 }
 
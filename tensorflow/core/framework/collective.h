@@ -43,6 +43,32 @@ enum CollectiveType {
   UNDEFINED_COLLECTIVE,
 };
 
+// Algorithms that may implement a REDUCTION_COLLECTIVE.
+enum CollectiveReductionAlgorithm {
+  // Bandwidth-optimal ring, best for large tensors.
+  RING_REDUCTION = 0,
+  // Recursive halving-doubling, best for latency-bound small tensors.
+  RECURSIVE_HALVING_DOUBLING_REDUCTION,
+  // Intra-task reduction followed by inter-task recursive
+  // halving-doubling among one device per task.
+  HIERARCHICAL_REDUCTION,
+};
+
+// Lossy encodings of the values that a reduction moves between devices,
+// trading precision for bandwidth.
+enum CollectiveCompression {
+  NO_COMPRESSION = 0,
+  // Values are sent as IEEE half precision floats.
+  FP16_COMPRESSION,
+  // Values are sent as bfloat16.
+  BFLOAT16_COMPRESSION,
+  // Values are quantized to 8 bits with one scale per chunk.
+  INT8_COMPRESSION,
+  // Only the largest values of a chunk by magnitude are sent, with their
+  // indices.
+  TOP_K_COMPRESSION,
+};
+
 // Data common to all members of a device group.
 // All members share the same device set but its order is
 // particular to an instance so it is stored there.
@@ -67,6 +93,8 @@ struct CollImplDetails {
   std::vector<int> subdiv_offsets;
   // broadcast only: rank of source in each subdiv
   std::vector<int> subdiv_source_rank;
+  // reduction only: algorithm used to carry out the reduction
+  CollectiveReductionAlgorithm reduction_algorithm = RING_REDUCTION;
 };
 
 // Data common to all members of a collective instance.
@@ -82,6 +110,10 @@ struct CollInstanceParams {
   // True if every task has the same number of devices.
   bool same_num_devices_per_task;
   CollImplDetails impl_details;
+  // reduction only: encoding of the values exchanged between devices
+  CollectiveCompression compression = NO_COMPRESSION;
+  // reduction only: with TOP_K_COMPRESSION, the fraction of each chunk sent
+  float top_k_fraction = 0.01f;
   string ToString() const;
   CollInstanceParams& operator=(const struct CollInstanceParams& other);
 };
@@ -106,6 +138,10 @@ struct CollectiveParams {
   std::vector<int> subdiv_rank;
   std::unique_ptr<OpKernel> merge_op;  // reduction only
   std::unique_ptr<OpKernel> final_op;  // reduction only
+  // reduction with compression only: holds the compression error to be fed
+  // back into the next execution, of the same shape as the input.  Owned by
+  // the op.
+  Tensor* residual = nullptr;
   string ToString() const;
 };
 
@@ -0,0 +1,152 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace graph_utils {
+
+NodeDef* AddNode(const string& op, const std::vector<string>& inputs,
+                 const std::vector<std::pair<string, AttrValue>>& attributes,
+                 GraphDef* graph) {
+  const string name = UniqueNodeName(op, *graph);
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op(op);
+  for (const string& input : inputs) {
+    node->add_input(input);
+  }
+  for (const auto& attr : attributes) {
+    (*node->mutable_attr())[attr.first] = attr.second;
+  }
+  return node;
+}
+
+namespace {
+
+template <typename T>
+NodeDef* AddScalarConstNodeHelper(DataType dtype, const T& v,
+                                  GraphDef* graph) {
+  Tensor tensor(dtype, TensorShape({}));
+  tensor.scalar<T>()() = v;
+  AttrValue value;
+  tensor.AsProtoTensorContent(value.mutable_tensor());
+  AttrValue type;
+  type.set_type(dtype);
+  return AddNode("Const", {}, {{"value", value}, {"dtype", type}}, graph);
+}
+
+}  // namespace
+
+NodeDef* AddScalarConstNode(bool v, GraphDef* graph) {
+  return AddScalarConstNodeHelper<bool>(DT_BOOL, v, graph);
+}
+
+NodeDef* AddScalarConstNode(int64 v, GraphDef* graph) {
+  return AddScalarConstNodeHelper<int64>(DT_INT64, v, graph);
+}
+
+bool GetScalarConstNodeValue(const NodeDef& node, int64* value) {
+  if (node.op() != "Const" || node.attr().count("value") == 0) {
+    return false;
+  }
+  Tensor tensor;
+  if (!tensor.FromProto(node.attr().at("value").tensor()) ||
+      tensor.dtype() != DT_INT64 || tensor.dims() != 0) {
+    return false;
+  }
+  *value = tensor.scalar<int64>()();
+  return true;
+}
+
+int FindNodeWithName(const string& name, const GraphDef& graph) {
+  for (int i = 0; i < graph.node_size(); ++i) {
+    if (graph.node(i).name() == name) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool ContainsNodeWithName(const string& name, const GraphDef& graph) {
+  return FindNodeWithName(name, graph) != -1;
+}
+
+bool ContainsFunctionWithName(const string& name,
+                              const FunctionDefLibrary& library) {
+  for (const FunctionDef& function : library.function()) {
+    if (function.signature().name() == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+string UniqueNodeName(const string& prefix, const GraphDef& graph) {
+  string name = prefix;
+  for (int id = 0; ContainsNodeWithName(name, graph); ++id) {
+    name = strings::StrCat(prefix, "/_", id);
+  }
+  return name;
+}
+
+string UniqueFunctionName(const string& prefix,
+                          const FunctionDefLibrary& library) {
+  string name = prefix;
+  for (int id = 0; ContainsFunctionWithName(name, library); ++id) {
+    name = strings::StrCat(prefix, "_", id);
+  }
+  return name;
+}
+
+void ReplaceInput(const NodeDef& old_input, const NodeDef& new_input,
+                  GraphDef* graph) {
+  for (NodeDef& node : *graph->mutable_node()) {
+    for (string& input : *node.mutable_input()) {
+      if (NodeName(input) != old_input.name()) {
+        continue;
+      }
+      if (IsControlInput(input)) {
+        input = AsControlDependency(new_input.name());
+      } else {
+        const int position = NodePosition(input);
+        input = position > 0 ? strings::StrCat(new_input.name(), ":", position)
+                             : new_input.name();
+      }
+    }
+  }
+}
+
+void DeleteNodes(const std::set<string>& nodes_to_delete, GraphDef* graph) {
+  int last = graph->node_size() - 1;
+  for (int i = last; i >= 0; --i) {
+    if (nodes_to_delete.count(graph->node(i).name()) > 0) {
+      graph->mutable_node()->SwapElements(i, last);
+      --last;
+    }
+  }
+  graph->mutable_node()->DeleteSubrange(last + 1,
+                                        graph->node_size() - last - 1);
+}
+
+}  // end namespace graph_utils
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,80 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_GRAPH_UTILS_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_GRAPH_UTILS_H_
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace graph_utils {
+
+// Adds a node to the graph. The name of the node is derived from `op` and made
+// unique within the graph.
+NodeDef* AddNode(const string& op, const std::vector<string>& inputs,
+                 const std::vector<std::pair<string, AttrValue>>& attributes,
+                 GraphDef* graph);
+
+// Adds a Const node with the given scalar value to the graph.
+NodeDef* AddScalarConstNode(bool v, GraphDef* graph);
+NodeDef* AddScalarConstNode(int64 v, GraphDef* graph);
+
+// Retrieves the value of a scalar int64 Const node. Returns false if the node
+// is not a scalar int64 constant.
+bool GetScalarConstNodeValue(const NodeDef& node, int64* value);
+
+// Returns the index of the node with the given name, or -1 if the node does
+// not exist.
+int FindNodeWithName(const string& name, const GraphDef& graph);
+
+// Returns true if the graph contains a node with the given name.
+bool ContainsNodeWithName(const string& name, const GraphDef& graph);
+
+// Returns true if the library contains a function with the given name.
+bool ContainsFunctionWithName(const string& name,
+                              const FunctionDefLibrary& library);
+
+// Returns a node name that does not exist in the graph yet, derived from
+// `prefix`.
+string UniqueNodeName(const string& prefix, const GraphDef& graph);
+
+// Returns a function name that does not exist in the library yet, derived
+// from `prefix`.
+string UniqueFunctionName(const string& prefix,
+                          const FunctionDefLibrary& library);
+
+// Makes all the consumers of `old_input` (including control dependencies)
+// consume `new_input` instead.
+void ReplaceInput(const NodeDef& old_input, const NodeDef& new_input,
+                  GraphDef* graph);
+
+// Removes the nodes with the given names from the graph.
+void DeleteNodes(const std::set<string>& nodes_to_delete, GraphDef* graph);
+
+}  // end namespace graph_utils
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_GRAPH_UTILS_H_
@@ -0,0 +1,67 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace graph_utils {
+namespace {
+
+TEST(GraphUtilsTest, AddScalarConstNode) {
+  GraphDef graph;
+  NodeDef* int_node = AddScalarConstNode(static_cast<int64>(42), &graph);
+  NodeDef* bool_node = AddScalarConstNode(true, &graph);
+  EXPECT_NE(int_node->name(), bool_node->name());
+  EXPECT_EQ(DT_BOOL, bool_node->attr().at("dtype").type());
+  int64 value;
+  ASSERT_TRUE(GetScalarConstNodeValue(*int_node, &value));
+  EXPECT_EQ(42, value);
+  EXPECT_FALSE(GetScalarConstNodeValue(*bool_node, &value));
+}
+
+TEST(GraphUtilsTest, UniqueNodeName) {
+  GraphDef graph;
+  EXPECT_EQ("A", UniqueNodeName("A", graph));
+  AddNode("A", {}, {}, &graph);
+  AddNode("A", {}, {}, &graph);
+  EXPECT_TRUE(ContainsNodeWithName("A", graph));
+  EXPECT_TRUE(ContainsNodeWithName("A/_0", graph));
+  EXPECT_EQ("A/_1", UniqueNodeName("A", graph));
+}
+
+TEST(GraphUtilsTest, ReplaceInputAndDeleteNodes) {
+  GraphDef graph;
+  NodeDef* a = AddNode("A", {}, {}, &graph);
+  NodeDef* b = AddNode("B", {}, {}, &graph);
+  AddNode("C", {a->name(), "A:1", "^A"}, {}, &graph);
+  ReplaceInput(*a, *b, &graph);
+  const NodeDef& c = graph.node(FindNodeWithName("C", graph));
+  EXPECT_EQ("B", c.input(0));
+  EXPECT_EQ("B:1", c.input(1));
+  EXPECT_EQ("^B", c.input(2));
+
+  DeleteNodes({"A", "C"}, &graph);
+  EXPECT_EQ(1, graph.node_size());
+  EXPECT_EQ("B", graph.node(0).name());
+}
+
+}  // namespace
+}  // namespace graph_utils
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,107 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_and_batch_fusion.h"
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace grappler {
+
+Status MapAndBatchFusion::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                   GraphDef* output) {
+  *output = item.graph;
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  NodeMap node_map(output);
+  std::set<string> nodes_to_delete;
+  // New nodes are appended to the graph, so only visit the original ones.
+  const int num_nodes = output->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& batch_node = output->node(i);
+    if (batch_node.op() != "BatchDataset" ||
+        nodes_to_preserve.count(batch_node.name()) > 0) {
+      continue;
+    }
+    const NodeDef* map_node = node_map.GetNode(batch_node.input(0));
+    if (map_node == nullptr || (map_node->op() != "MapDataset" &&
+                                map_node->op() != "ParallelMapDataset")) {
+      continue;
+    }
+    // The map must not be observable from anywhere else than the batch.
+    if (node_map.GetOutputs(map_node->name()).size() != 1 ||
+        nodes_to_preserve.count(map_node->name()) > 0) {
+      continue;
+    }
+
+    // MapAndBatchDataset(input_dataset, other_arguments, batch_size,
+    //                    num_parallel_batches, drop_remainder)
+    std::vector<string> inputs;
+    inputs.push_back(map_node->input(0));
+    // Forward the captured arguments of the map function. ParallelMapDataset
+    // has an additional num_parallel_calls input which is dropped.
+    const int num_other_arguments =
+        map_node->attr().at("Targuments").list().type_size();
+    for (int j = 1; j <= num_other_arguments; ++j) {
+      inputs.push_back(map_node->input(j));
+    }
+    inputs.push_back(batch_node.input(1));
+    NodeDef* num_parallel_batches =
+        graph_utils::AddScalarConstNode(static_cast<int64>(1), output);
+    NodeDef* drop_remainder = graph_utils::AddScalarConstNode(false, output);
+    inputs.push_back(num_parallel_batches->name());
+    inputs.push_back(drop_remainder->name());
+
+    NodeDef* map_and_batch = graph_utils::AddNode(
+        "MapAndBatchDataset", inputs,
+        {{"f", map_node->attr().at("f")},
+         {"Targuments", map_node->attr().at("Targuments")},
+         {"output_types", batch_node.attr().at("output_types")},
+         {"output_shapes", batch_node.attr().at("output_shapes")}},
+        output);
+    map_and_batch->set_device(batch_node.device());
+    // Control dependencies of the fused nodes are kept on the new node.
+    for (const NodeDef* fused : {map_node, &batch_node}) {
+      for (const string& input : fused->input()) {
+        if (IsControlInput(input)) {
+          map_and_batch->add_input(input);
+        }
+      }
+    }
+
+    graph_utils::ReplaceInput(batch_node, *map_and_batch, output);
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+  }
+  graph_utils::DeleteNodes(nodes_to_delete, output);
+  return Status::OK();
+}
+
+void MapAndBatchFusion::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                 const GraphDef& optimize_output,
+                                 double result) {
+  // no-op
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapAndBatchFusion, "map_and_batch_fusion");
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,124 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_and_batch_fusion.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+NodeDef DatasetNode(const string& name, const string& op,
+                    const std::vector<string>& inputs) {
+  return NDef(name, op, inputs,
+              {{"output_shapes", gtl::ArraySlice<TensorShape>{{}}},
+               {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}});
+}
+
+NodeDef ConstNode(const string& name, int64 value) {
+  return NDef(name, "Const", {},
+              {{"value", test::AsScalar<int64>(value)}, {"dtype", DT_INT64}});
+}
+
+NodeDef MapNode(const string& name, const string& op,
+                const std::vector<string>& inputs) {
+  NodeDef node = DatasetNode(name, op, inputs);
+  (*node.mutable_attr())["f"].mutable_func()->set_name("XTimesTwo");
+  (*node.mutable_attr())["Targuments"].mutable_list();
+  return node;
+}
+
+void CheckFused(const GraphDef& output) {
+  EXPECT_FALSE(graph_utils::ContainsNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithName("batch", output));
+  const int fused = graph_utils::FindNodeWithName("MapAndBatchDataset", output);
+  ASSERT_NE(-1, fused);
+  const NodeDef& node = output.node(fused);
+  ASSERT_EQ(4, node.input_size());
+  EXPECT_EQ("range", node.input(0));
+  EXPECT_EQ("batch_size", node.input(1));
+  EXPECT_EQ("XTimesTwo", node.attr().at("f").func().name());
+  EXPECT_EQ(node.name(),
+            output.node(graph_utils::FindNodeWithName("sink", output)).input(0));
+}
+
+TEST(MapAndBatchFusionTest, FuseMapAndBatch) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {ConstNode("start", 0), ConstNode("stop", 10), ConstNode("step", 1),
+       DatasetNode("range", "RangeDataset", {"start", "stop", "step"}),
+       MapNode("map", "MapDataset", {"range"}), ConstNode("batch_size", 5),
+       DatasetNode("batch", "BatchDataset", {"map", "batch_size"}),
+       NDef("sink", "Identity", {"batch"}, {{"T", DT_VARIANT}})},
+      {test::function::XTimesTwo()});
+  item.fetch = {"sink"};
+
+  MapAndBatchFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  CheckFused(output);
+}
+
+TEST(MapAndBatchFusionTest, FuseParallelMapAndBatch) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {ConstNode("start", 0), ConstNode("stop", 10), ConstNode("step", 1),
+       DatasetNode("range", "RangeDataset", {"start", "stop", "step"}),
+       NDef("num_parallel_calls", "Const", {},
+            {{"value", test::AsScalar<int32>(2)}, {"dtype", DT_INT32}}),
+       MapNode("map", "ParallelMapDataset", {"range", "num_parallel_calls"}),
+       ConstNode("batch_size", 5),
+       DatasetNode("batch", "BatchDataset", {"map", "batch_size"}),
+       NDef("sink", "Identity", {"batch"}, {{"T", DT_VARIANT}})},
+      {test::function::XTimesTwo()});
+  item.fetch = {"sink"};
+
+  MapAndBatchFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  CheckFused(output);
+}
+
+TEST(MapAndBatchFusionTest, NoFusionWhenMapIsShared) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {ConstNode("start", 0), ConstNode("stop", 10), ConstNode("step", 1),
+       DatasetNode("range", "RangeDataset", {"start", "stop", "step"}),
+       MapNode("map", "MapDataset", {"range"}), ConstNode("batch_size", 5),
+       DatasetNode("batch", "BatchDataset", {"map", "batch_size"}),
+       NDef("sink", "Identity", {"batch"}, {{"T", DT_VARIANT}}),
+       NDef("other_sink", "Identity", {"map"}, {{"T", DT_VARIANT}})},
+      {test::function::XTimesTwo()});
+  item.fetch = {"sink", "other_sink"};
+
+  MapAndBatchFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsNodeWithName("batch", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,225 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_fusion.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+const FunctionDef* FindFunction(const string& name,
+                                const FunctionDefLibrary& library) {
+  for (const FunctionDef& function : library.function()) {
+    if (function.signature().name() == name) {
+      return &function;
+    }
+  }
+  return nullptr;
+}
+
+// Returns the function called by a map node, or nullptr if the map can't be
+// fused (e.g. because it captures arguments or calls a polymorphic function).
+const FunctionDef* GetFusableFunction(const NodeDef& map_node,
+                                      const FunctionDefLibrary& library) {
+  if (map_node.op() != "MapDataset" || HasControlInputs(map_node) ||
+      map_node.attr().at("Targuments").list().type_size() > 0) {
+    return nullptr;
+  }
+  const NameAttrList& func = map_node.attr().at("f").func();
+  if (func.attr_size() > 0) {
+    return nullptr;
+  }
+  const FunctionDef* function = FindFunction(func.name(), library);
+  if (function == nullptr || function->signature().attr_size() > 0) {
+    return nullptr;
+  }
+  return function;
+}
+
+// Returns the node (or argument) name of a function input or return value,
+// e.g. "mul" for "mul:z:0" or "^mul".
+string FunctionNodeName(const string& input) {
+  const string name = IsControlInput(input) ? input.substr(1) : input;
+  return name.substr(0, name.find(':'));
+}
+
+// Returns the function g(f(x)). The outputs of `f` are fed to the inputs of
+// `g`, which must have the same arity.
+FunctionDef ComposeFunctions(const FunctionDef& f, const FunctionDef& g,
+                             const string& name) {
+  FunctionDef fused;
+  OpDef* signature = fused.mutable_signature();
+  signature->set_name(name);
+  *signature->mutable_input_arg() = f.signature().input_arg();
+  *signature->mutable_output_arg() = g.signature().output_arg();
+  signature->set_is_stateful(f.signature().is_stateful() ||
+                             g.signature().is_stateful());
+  signature->set_description(strings::StrCat(
+      "Composition of ", f.signature().name(), " and ", g.signature().name()));
+  *fused.mutable_node_def() = f.node_def();
+
+  // The inputs of g are replaced by the corresponding return values of f.
+  std::unordered_map<string, string> g_args;
+  for (int i = 0; i < g.signature().input_arg_size(); ++i) {
+    g_args[g.signature().input_arg(i).name()] =
+        f.ret().at(f.signature().output_arg(i).name());
+  }
+  // The nodes of g are renamed if they collide with names used in f.
+  std::unordered_set<string> used_names;
+  for (const OpDef::ArgDef& arg : f.signature().input_arg()) {
+    used_names.insert(arg.name());
+  }
+  for (const NodeDef& node : f.node_def()) {
+    used_names.insert(node.name());
+  }
+  std::unordered_map<string, string> g_nodes;
+  for (const NodeDef& node : g.node_def()) {
+    string new_name = node.name();
+    for (int id = 0; used_names.count(new_name) > 0; ++id) {
+      new_name = strings::StrCat(node.name(), "_", id);
+    }
+    used_names.insert(new_name);
+    g_nodes[node.name()] = new_name;
+  }
+  auto rewrite = [&g_args, &g_nodes](const string& input) -> string {
+    const string node_name = FunctionNodeName(input);
+    auto arg = g_args.find(node_name);
+    if (arg != g_args.end()) {
+      if (!IsControlInput(input)) {
+        return arg->second;
+      }
+      // Arguments are always available: a control dependency on an argument
+      // becomes a control dependency on the node that produces it, if any.
+      const string producer = FunctionNodeName(arg->second);
+      return producer == arg->second ? "" : AsControlDependency(producer);
+    }
+    auto node = g_nodes.find(node_name);
+    if (node == g_nodes.end()) {
+      return input;
+    }
+    if (IsControlInput(input)) {
+      return AsControlDependency(node->second);
+    }
+    return strings::StrCat(node->second, input.substr(node_name.size()));
+  };
+
+  for (const NodeDef& node : g.node_def()) {
+    NodeDef* fused_node = fused.add_node_def();
+    *fused_node = node;
+    fused_node->set_name(g_nodes[node.name()]);
+    fused_node->clear_input();
+    for (const string& input : node.input()) {
+      const string new_input = rewrite(input);
+      if (!new_input.empty()) {
+        fused_node->add_input(new_input);
+      }
+    }
+  }
+  for (const auto& ret : g.ret()) {
+    (*fused.mutable_ret())[ret.first] = rewrite(ret.second);
+  }
+  return fused;
+}
+
+}  // namespace
+
+Status MapFusion::Optimize(Cluster* cluster, const GrapplerItem& item,
+                           GraphDef* output) {
+  *output = item.graph;
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  NodeMap node_map(output);
+  std::set<string> nodes_to_delete;
+  // New nodes are appended to the graph, so only visit the original ones.
+  const int num_nodes = output->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& second_map = output->node(i);
+    const FunctionDef* g = GetFusableFunction(second_map, output->library());
+    if (g == nullptr || nodes_to_preserve.count(second_map.name()) > 0 ||
+        nodes_to_delete.count(second_map.name()) > 0) {
+      continue;
+    }
+    const NodeDef* first_map = node_map.GetNode(second_map.input(0));
+    if (first_map == nullptr ||
+        node_map.GetOutputs(first_map->name()).size() != 1 ||
+        nodes_to_preserve.count(first_map->name()) > 0 ||
+        nodes_to_delete.count(first_map->name()) > 0) {
+      continue;
+    }
+    const FunctionDef* f = GetFusableFunction(*first_map, output->library());
+    if (f == nullptr ||
+        f->signature().output_arg_size() != g->signature().input_arg_size()) {
+      continue;
+    }
+
+    const string fused_name = graph_utils::UniqueFunctionName(
+        strings::StrCat("fused_", f->signature().name(), "_",
+                        g->signature().name()),
+        output->library());
+    FunctionDef fused_function = ComposeFunctions(*f, *g, fused_name);
+    *output->mutable_library()->add_function() = std::move(fused_function);
+
+    AttrValue fused_func;
+    fused_func.mutable_func()->set_name(fused_name);
+    NodeDef* fused_map = graph_utils::AddNode(
+        "MapDataset", {first_map->input(0)},
+        {{"f", fused_func},
+         {"Targuments", first_map->attr().at("Targuments")},
+         {"output_types", second_map.attr().at("output_types")},
+         {"output_shapes", second_map.attr().at("output_shapes")}},
+        output);
+    fused_map->set_device(second_map.device());
+
+    // Keep the fanouts up to date, so that a following map can be fused with
+    // the result.
+    node_map.AddNode(fused_map->name(), fused_map);
+    node_map.UpdateOutput(NodeName(first_map->input(0)), first_map->name(),
+                          fused_map->name());
+    const std::set<NodeDef*> consumers =
+        node_map.GetOutputs(second_map.name());
+    for (NodeDef* consumer : consumers) {
+      node_map.UpdateInput(consumer->name(), second_map.name(),
+                           fused_map->name());
+    }
+    graph_utils::ReplaceInput(second_map, *fused_map, output);
+    nodes_to_delete.insert(first_map->name());
+    nodes_to_delete.insert(second_map.name());
+  }
+  graph_utils::DeleteNodes(nodes_to_delete, output);
+  return Status::OK();
+}
+
+void MapFusion::Feedback(Cluster* cluster, const GrapplerItem& item,
+                         const GraphDef& optimize_output, double result) {
+  // no-op
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapFusion, "map_fusion");
+
+}  // end namespace grappler
+}  // end namespace tensorflow
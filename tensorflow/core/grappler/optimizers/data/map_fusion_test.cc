@@ -0,0 +1,143 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_fusion.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+NodeDef DatasetNode(const string& name, const string& op,
+                    const std::vector<string>& inputs) {
+  return NDef(name, op, inputs,
+              {{"output_shapes", gtl::ArraySlice<TensorShape>{{}}},
+               {"output_types", gtl::ArraySlice<DataType>{DT_INT32}}});
+}
+
+NodeDef ConstNode(const string& name, int64 value) {
+  return NDef(name, "Const", {},
+              {{"value", test::AsScalar<int64>(value)}, {"dtype", DT_INT64}});
+}
+
+NodeDef MapNode(const string& name, const string& input,
+                const string& function) {
+  NodeDef node = DatasetNode(name, "MapDataset", {input});
+  (*node.mutable_attr())["f"].mutable_func()->set_name(function);
+  (*node.mutable_attr())["Targuments"].mutable_list();
+  return node;
+}
+
+GraphDef TwoMaps(const string& function) {
+  return test::function::GDef(
+      {ConstNode("start", 0), ConstNode("stop", 10), ConstNode("step", 1),
+       DatasetNode("range", "RangeDataset", {"start", "stop", "step"}),
+       MapNode("map1", "range", function), MapNode("map2", "map1", function),
+       NDef("sink", "Identity", {"map2"}, {{"T", DT_VARIANT}})},
+      {test::function::XTimesTwo(), test::function::XTimesTwoInt32()});
+}
+
+TEST(MapFusionTest, FuseTwoMaps) {
+  GrapplerItem item;
+  item.graph = TwoMaps("XTimesTwoInt32");
+  item.fetch = {"sink"};
+
+  MapFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithName("map1", output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithName("map2", output));
+  const int fused = graph_utils::FindNodeWithName("MapDataset", output);
+  ASSERT_NE(-1, fused);
+  const NodeDef& fused_map = output.node(fused);
+  EXPECT_EQ("range", fused_map.input(0));
+  EXPECT_EQ(fused_map.name(),
+            output.node(graph_utils::FindNodeWithName("sink", output)).input(0));
+
+  const string& fused_name = fused_map.attr().at("f").func().name();
+  const FunctionDef* fused_function = nullptr;
+  for (const FunctionDef& function : output.library().function()) {
+    if (function.signature().name() == fused_name) {
+      fused_function = &function;
+    }
+  }
+  ASSERT_NE(nullptr, fused_function);
+  EXPECT_EQ(1, fused_function->signature().input_arg_size());
+  EXPECT_EQ("x", fused_function->signature().input_arg(0).name());
+  EXPECT_EQ(1, fused_function->signature().output_arg_size());
+  // Both functions have 3 nodes; the nodes of the second one are renamed.
+  ASSERT_EQ(6, fused_function->node_def_size());
+  std::set<string> names;
+  for (const NodeDef& node : fused_function->node_def()) {
+    EXPECT_TRUE(names.insert(node.name()).second) << node.name();
+  }
+  // The second Mul consumes the output of the first one.
+  const NodeDef& second_mul = fused_function->node_def(5);
+  EXPECT_EQ("Mul", second_mul.op());
+  EXPECT_EQ("y:z:0", second_mul.input(0));
+  EXPECT_EQ(strings::StrCat(second_mul.name(), ":z:0"),
+            fused_function->ret().at("y"));
+}
+
+TEST(MapFusionTest, FuseThreeMaps) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {ConstNode("start", 0), ConstNode("stop", 10), ConstNode("step", 1),
+       DatasetNode("range", "RangeDataset", {"start", "stop", "step"}),
+       MapNode("map1", "range", "XTimesTwoInt32"),
+       MapNode("map2", "map1", "XTimesTwoInt32"),
+       MapNode("map3", "map2", "XTimesTwoInt32"),
+       NDef("sink", "Identity", {"map3"}, {{"T", DT_VARIANT}})},
+      {test::function::XTimesTwoInt32()});
+  item.fetch = {"sink"};
+
+  MapFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  // The map fused from the first two is fused with the third one.
+  std::vector<const NodeDef*> maps;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "MapDataset") maps.push_back(&node);
+  }
+  ASSERT_EQ(1, maps.size());
+  EXPECT_EQ("range", maps[0]->input(0));
+  EXPECT_EQ(maps[0]->name(),
+            output.node(graph_utils::FindNodeWithName("sink", output)).input(0));
+}
+
+TEST(MapFusionTest, NoFusionOfPolymorphicFunctions) {
+  GrapplerItem item;
+  item.graph = TwoMaps("XTimesTwo");
+  item.fetch = {"sink"};
+
+  MapFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsNodeWithName("map1", output));
+  EXPECT_TRUE(graph_utils::ContainsNodeWithName("map2", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
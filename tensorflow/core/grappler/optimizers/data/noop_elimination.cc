@@ -0,0 +1,86 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/noop_elimination.h"
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+bool IsNoOp(const NodeDef& node, const NodeMap& node_map) {
+  if (node.op() != "TakeDataset" && node.op() != "SkipDataset" &&
+      node.op() != "RepeatDataset") {
+    return false;
+  }
+  const NodeDef* count_node = node_map.GetNode(node.input(1));
+  int64 count;
+  if (count_node == nullptr ||
+      !graph_utils::GetScalarConstNodeValue(*count_node, &count)) {
+    return false;
+  }
+  if (node.op() == "TakeDataset") {
+    // A negative count takes all the elements.
+    return count < 0;
+  } else if (node.op() == "SkipDataset") {
+    return count == 0;
+  }
+  return count == 1;
+}
+
+}  // namespace
+
+Status NoOpElimination::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output) {
+  *output = item.graph;
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  NodeMap node_map(output);
+  std::set<string> nodes_to_delete;
+  for (const NodeDef& node : output->node()) {
+    if (nodes_to_preserve.count(node.name()) > 0 || HasControlInputs(node) ||
+        !IsNoOp(node, node_map)) {
+      continue;
+    }
+    // Chains of no-ops are collapsed one link at a time: the consumers of
+    // `node` are rewired to its (possibly also removed) input, whose own
+    // consumers are rewired in turn when it is visited.
+    NodeDef* input = node_map.GetNode(node.input(0));
+    if (input == nullptr) {
+      continue;
+    }
+    graph_utils::ReplaceInput(node, *input, output);
+    nodes_to_delete.insert(node.name());
+  }
+  graph_utils::DeleteNodes(nodes_to_delete, output);
+  return Status::OK();
+}
+
+void NoOpElimination::Feedback(Cluster* cluster, const GrapplerItem& item,
+                               const GraphDef& optimize_output,
+                               double result) {
+  // no-op
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(NoOpElimination, "noop_elimination");
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,113 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/noop_elimination.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+NodeDef DatasetNode(const string& name, const string& op,
+                    const std::vector<string>& inputs) {
+  return NDef(name, op, inputs,
+              {{"output_shapes", gtl::ArraySlice<TensorShape>{{}}},
+               {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}});
+}
+
+NodeDef ConstNode(const string& name, int64 value) {
+  return NDef(name, "Const", {},
+              {{"value", test::AsScalar<int64>(value)}, {"dtype", DT_INT64}});
+}
+
+GraphDef RangeAnd(const string& op, int64 count) {
+  return test::function::GDef(
+      {ConstNode("start", 0), ConstNode("stop", 10), ConstNode("step", 1),
+       DatasetNode("range", "RangeDataset", {"start", "stop", "step"}),
+       ConstNode("count", count),
+       DatasetNode("noop", op, {"range", "count"}),
+       NDef("sink", "Identity", {"noop"}, {{"T", DT_VARIANT}})});
+}
+
+TEST(NoOpEliminationTest, RemovesNoOps) {
+  for (const auto& op_and_count :
+       std::vector<std::pair<string, int64>>{{"TakeDataset", -1},
+                                             {"SkipDataset", 0},
+                                             {"RepeatDataset", 1}}) {
+    GrapplerItem item;
+    item.graph = RangeAnd(op_and_count.first, op_and_count.second);
+    item.fetch = {"sink"};
+
+    NoOpElimination optimizer;
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+    EXPECT_FALSE(graph_utils::ContainsNodeWithName("noop", output))
+        << op_and_count.first;
+    const int sink = graph_utils::FindNodeWithName("sink", output);
+    ASSERT_NE(-1, sink);
+    EXPECT_EQ("range", output.node(sink).input(0));
+  }
+}
+
+TEST(NoOpEliminationTest, KeepsTransformations) {
+  for (const auto& op_and_count :
+       std::vector<std::pair<string, int64>>{{"TakeDataset", 3},
+                                             {"SkipDataset", 3},
+                                             {"RepeatDataset", 3},
+                                             {"RepeatDataset", -1}}) {
+    GrapplerItem item;
+    item.graph = RangeAnd(op_and_count.first, op_and_count.second);
+    item.fetch = {"sink"};
+
+    NoOpElimination optimizer;
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+    EXPECT_TRUE(graph_utils::ContainsNodeWithName("noop", output))
+        << op_and_count.first;
+  }
+}
+
+TEST(NoOpEliminationTest, RemovesChainsOfNoOps) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {ConstNode("start", 0), ConstNode("stop", 10), ConstNode("step", 1),
+       DatasetNode("range", "RangeDataset", {"start", "stop", "step"}),
+       ConstNode("minus_one", -1), ConstNode("one", 1),
+       DatasetNode("take", "TakeDataset", {"range", "minus_one"}),
+       DatasetNode("repeat", "RepeatDataset", {"take", "one"}),
+       NDef("sink", "Identity", {"repeat"}, {{"T", DT_VARIANT}})});
+  item.fetch = {"sink"};
+
+  NoOpElimination optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithName("take", output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithName("repeat", output));
+  EXPECT_EQ("range",
+            output.node(graph_utils::FindNodeWithName("sink", output)).input(0));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,94 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/shuffle_and_repeat_fusion.h"
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+
+Status ShuffleAndRepeatFusion::Optimize(Cluster* cluster,
+                                        const GrapplerItem& item,
+                                        GraphDef* output) {
+  *output = item.graph;
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  NodeMap node_map(output);
+  std::set<string> nodes_to_delete;
+  // New nodes are appended to the graph, so only visit the original ones.
+  const int num_nodes = output->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& repeat_node = output->node(i);
+    if (repeat_node.op() != "RepeatDataset" ||
+        nodes_to_preserve.count(repeat_node.name()) > 0) {
+      continue;
+    }
+    const NodeDef* shuffle_node = node_map.GetNode(repeat_node.input(0));
+    if (shuffle_node == nullptr || shuffle_node->op() != "ShuffleDataset" ||
+        node_map.GetOutputs(shuffle_node->name()).size() != 1 ||
+        nodes_to_preserve.count(shuffle_node->name()) > 0) {
+      continue;
+    }
+    // ShuffleAndRepeatDataset reshuffles the elements at every epoch, so only
+    // shuffles that do the same can be fused.
+    auto reshuffle = shuffle_node->attr().find("reshuffle_each_iteration");
+    if (reshuffle != shuffle_node->attr().end() && !reshuffle->second.b()) {
+      continue;
+    }
+
+    // ShuffleAndRepeatDataset(input_dataset, buffer_size, seed, seed2, count)
+    NodeDef* shuffle_and_repeat = graph_utils::AddNode(
+        "ShuffleAndRepeatDataset",
+        {shuffle_node->input(0), shuffle_node->input(1),
+         shuffle_node->input(2), shuffle_node->input(3),
+         repeat_node.input(1)},
+        {{"output_types", repeat_node.attr().at("output_types")},
+         {"output_shapes", repeat_node.attr().at("output_shapes")}},
+        output);
+    shuffle_and_repeat->set_device(repeat_node.device());
+    for (const NodeDef* fused : {shuffle_node, &repeat_node}) {
+      for (const string& input : fused->input()) {
+        if (IsControlInput(input)) {
+          shuffle_and_repeat->add_input(input);
+        }
+      }
+    }
+
+    graph_utils::ReplaceInput(repeat_node, *shuffle_and_repeat, output);
+    nodes_to_delete.insert(shuffle_node->name());
+    nodes_to_delete.insert(repeat_node.name());
+  }
+  graph_utils::DeleteNodes(nodes_to_delete, output);
+  return Status::OK();
+}
+
+void ShuffleAndRepeatFusion::Feedback(Cluster* cluster,
+                                      const GrapplerItem& item,
+                                      const GraphDef& optimize_output,
+                                      double result) {
+  // no-op
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(ShuffleAndRepeatFusion,
+                            "shuffle_and_repeat_fusion");
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,96 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/shuffle_and_repeat_fusion.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+NodeDef DatasetNode(const string& name, const string& op,
+                    const std::vector<string>& inputs) {
+  return NDef(name, op, inputs,
+              {{"output_shapes", gtl::ArraySlice<TensorShape>{{}}},
+               {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}});
+}
+
+NodeDef ConstNode(const string& name, int64 value) {
+  return NDef(name, "Const", {},
+              {{"value", test::AsScalar<int64>(value)}, {"dtype", DT_INT64}});
+}
+
+GraphDef ShuffleAndRepeat(bool reshuffle_each_iteration) {
+  NodeDef shuffle = DatasetNode("shuffle", "ShuffleDataset",
+                                {"range", "buffer_size", "seed", "seed2"});
+  (*shuffle.mutable_attr())["reshuffle_each_iteration"].set_b(
+      reshuffle_each_iteration);
+  return test::function::GDef(
+      {ConstNode("start", 0), ConstNode("stop", 10), ConstNode("step", 1),
+       DatasetNode("range", "RangeDataset", {"start", "stop", "step"}),
+       ConstNode("buffer_size", 128), ConstNode("seed", -1),
+       ConstNode("seed2", -1), shuffle, ConstNode("count", -1),
+       DatasetNode("repeat", "RepeatDataset", {"shuffle", "count"}),
+       NDef("sink", "Identity", {"repeat"}, {{"T", DT_VARIANT}})});
+}
+
+TEST(ShuffleAndRepeatFusionTest, FuseShuffleAndRepeat) {
+  GrapplerItem item;
+  item.graph = ShuffleAndRepeat(true);
+  item.fetch = {"sink"};
+
+  ShuffleAndRepeatFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithName("shuffle", output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithName("repeat", output));
+  const int fused =
+      graph_utils::FindNodeWithName("ShuffleAndRepeatDataset", output);
+  ASSERT_NE(-1, fused);
+  const NodeDef& node = output.node(fused);
+  ASSERT_EQ(5, node.input_size());
+  EXPECT_EQ("range", node.input(0));
+  EXPECT_EQ("buffer_size", node.input(1));
+  EXPECT_EQ("seed", node.input(2));
+  EXPECT_EQ("seed2", node.input(3));
+  EXPECT_EQ("count", node.input(4));
+  EXPECT_EQ(node.name(),
+            output.node(graph_utils::FindNodeWithName("sink", output)).input(0));
+}
+
+TEST(ShuffleAndRepeatFusionTest, NoFusionWithoutReshuffling) {
+  GrapplerItem item;
+  item.graph = ShuffleAndRepeat(false);
+  item.fetch = {"sink"};
+
+  ShuffleAndRepeatFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsNodeWithName("shuffle", output));
+  EXPECT_TRUE(graph_utils::ContainsNodeWithName("repeat", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
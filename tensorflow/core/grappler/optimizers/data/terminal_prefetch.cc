@@ -0,0 +1,82 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/terminal_prefetch.h"
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Buffer size that lets the PrefetchDataset tune its own buffer size.
+constexpr int64 kAutoTune = -1;
+
+bool IsDatasetOp(const NodeDef& node) {
+  return str_util::EndsWith(node.op(), "Dataset") &&
+         node.attr().count("output_types") > 0 &&
+         node.attr().count("output_shapes") > 0;
+}
+
+}  // namespace
+
+Status TerminalPrefetch::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                  GraphDef* output) {
+  *output = item.graph;
+  NodeMap node_map(output);
+  for (const string& fetch : item.fetch) {
+    NodeDef* fetch_node = node_map.GetNode(fetch);
+    if (fetch_node == nullptr) {
+      continue;
+    }
+    // Only datasets that are fetched through an Identity node (as added by
+    // OptimizeDataset) can be rewired: the fetched node itself must be kept.
+    if (fetch_node->op() != "Identity" || fetch_node->input_size() == 0) {
+      continue;
+    }
+    NodeDef* terminal = node_map.GetNode(fetch_node->input(0));
+    if (terminal == nullptr || !IsDatasetOp(*terminal) ||
+        terminal->op() == "PrefetchDataset") {
+      continue;
+    }
+    NodeDef* buffer_size = graph_utils::AddScalarConstNode(kAutoTune, output);
+    NodeDef* prefetch = graph_utils::AddNode(
+        "PrefetchDataset", {terminal->name(), buffer_size->name()},
+        {{"output_types", terminal->attr().at("output_types")},
+         {"output_shapes", terminal->attr().at("output_shapes")}},
+        output);
+    prefetch->set_device(terminal->device());
+    *fetch_node->mutable_input(0) = prefetch->name();
+  }
+  return Status::OK();
+}
+
+void TerminalPrefetch::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                const GraphDef& optimize_output,
+                                double result) {
+  // no-op
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(TerminalPrefetch, "terminal_prefetch");
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,104 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/terminal_prefetch.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+NodeDef DatasetNode(const string& name, const string& op,
+                    const std::vector<string>& inputs) {
+  return NDef(name, op, inputs,
+              {{"output_shapes", gtl::ArraySlice<TensorShape>{{}}},
+               {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}});
+}
+
+NodeDef ConstNode(const string& name, int64 value) {
+  return NDef(name, "Const", {},
+              {{"value", test::AsScalar<int64>(value)}, {"dtype", DT_INT64}});
+}
+
+GraphDef Range(const string& last_op) {
+  std::vector<NodeDef> nodes = {
+      ConstNode("start", 0), ConstNode("stop", 10), ConstNode("step", 1),
+      DatasetNode("range", "RangeDataset", {"start", "stop", "step"})};
+  string last = "range";
+  if (!last_op.empty()) {
+    nodes.push_back(ConstNode("buffer_size", 4));
+    nodes.push_back(DatasetNode("last", last_op, {"range", "buffer_size"}));
+    last = "last";
+  }
+  nodes.push_back(NDef("sink", "Identity", {last}, {{"T", DT_VARIANT}}));
+  return test::function::GDef(nodes);
+}
+
+TEST(TerminalPrefetchTest, AddsPrefetch) {
+  GrapplerItem item;
+  item.graph = Range("");
+  item.fetch = {"sink"};
+
+  TerminalPrefetch optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  const int prefetch = graph_utils::FindNodeWithName("PrefetchDataset", output);
+  ASSERT_NE(-1, prefetch);
+  EXPECT_EQ("range", output.node(prefetch).input(0));
+  const NodeDef* buffer_size = &output.node(
+      graph_utils::FindNodeWithName(output.node(prefetch).input(1), output));
+  int64 value;
+  ASSERT_TRUE(graph_utils::GetScalarConstNodeValue(*buffer_size, &value));
+  EXPECT_EQ(-1, value);
+  EXPECT_EQ("PrefetchDataset",
+            output.node(graph_utils::FindNodeWithName("sink", output)).input(0));
+}
+
+TEST(TerminalPrefetchTest, KeepsExistingPrefetch) {
+  GrapplerItem item;
+  item.graph = Range("PrefetchDataset");
+  item.fetch = {"sink"};
+
+  TerminalPrefetch optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  EXPECT_EQ("last",
+            output.node(graph_utils::FindNodeWithName("sink", output)).input(0));
+}
+
+TEST(TerminalPrefetchTest, OnlyRewiresIdentityFetches) {
+  GrapplerItem item;
+  item.graph = Range("");
+  item.fetch = {"range"};
+
+  TerminalPrefetch optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/function_optimizer.h"
 #include <unordered_map>
+#include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -537,6 +539,209 @@ Status InlineSymbolicGradient(const NodeDef& node, SymbolicGradientEnv* env,
   return Status::OK();
 }
 
+// Rename the references to the functions in `renamed`, both from the graph
+// nodes and from the function bodies: function calls and function attributes.
+void RenameFunctionReferences(
+    const std::unordered_map<string, string>& renamed, GraphDef* graph) {
+  const auto rename_func = [&renamed](NameAttrList* func) {
+    auto it = renamed.find(func->name());
+    if (it != renamed.end()) func->set_name(it->second);
+  };
+  const auto rename_in_node = [&](NodeDef* node) {
+    auto it = renamed.find(node->op());
+    if (it != renamed.end()) node->set_op(it->second);
+    for (auto& attr : *node->mutable_attr()) {
+      AttrValue& attr_value = attr.second;
+      if (attr_value.has_func()) {
+        rename_func(attr_value.mutable_func());
+      }
+      if (attr_value.has_list()) {
+        for (auto& func : *attr_value.mutable_list()->mutable_func()) {
+          rename_func(&func);
+        }
+      }
+    }
+  };
+  for (NodeDef& node : *graph->mutable_node()) {
+    rename_in_node(&node);
+  }
+  for (FunctionDef& func : *graph->mutable_library()->mutable_function()) {
+    for (NodeDef& node : *func.mutable_node_def()) {
+      rename_in_node(&node);
+    }
+  }
+}
+
+// Remove the functions whose definition, up to the function name, is
+// identical to the definition of another function in the library, and redirect
+// their references to the function that is kept. Function specialization in
+// particular creates one identical copy per call site. Functions with a
+// registered gradient are kept, since the gradient is looked up by name.
+// Returns the number of removed functions.
+int DedupFunctionLibrary(GraphDef* optimized_graph) {
+  FunctionDefLibrary* library = optimized_graph->mutable_library();
+  std::unordered_set<string> with_gradient;
+  for (const GradientDef& grad : library->gradient()) {
+    with_gradient.insert(grad.function_name());
+    with_gradient.insert(grad.gradient_func());
+  }
+
+  int num_removed = 0;
+  bool changed = true;
+  // Renaming the references inside function bodies can make more functions
+  // identical, so iterate until a fixed point is reached.
+  while (changed) {
+    changed = false;
+    std::unordered_multimap<uint64, const FunctionDef*> unique_funcs;
+    std::vector<FunctionDef> anonymous_funcs(library->function_size());
+    std::unordered_map<string, string> renamed;
+    for (int i = 0; i < library->function_size(); ++i) {
+      const FunctionDef& func = library->function(i);
+      if (with_gradient.count(func.signature().name()) > 0) continue;
+      FunctionDef& anonymous = anonymous_funcs[i];
+      anonymous = func;
+      anonymous.mutable_signature()->clear_name();
+      const uint64 hash = FunctionDefHash(anonymous);
+      const FunctionDef* rep = nullptr;
+      auto range = unique_funcs.equal_range(hash);
+      for (auto it = range.first; it != range.second; ++it) {
+        if (FunctionDefsEqual(*it->second, anonymous)) {
+          rep = it->second;
+          break;
+        }
+      }
+      if (rep == nullptr) {
+        unique_funcs.emplace(hash, &anonymous);
+      } else {
+        const int rep_index = rep - anonymous_funcs.data();
+        renamed[func.signature().name()] =
+            library->function(rep_index).signature().name();
+      }
+    }
+    if (renamed.empty()) break;
+
+    VLOG(2) << "Dedup " << renamed.size() << " identical functions";
+    auto* funcs = library->mutable_function();
+    funcs->erase(std::remove_if(funcs->begin(), funcs->end(),
+                                [&renamed](const FunctionDef& func) {
+                                  return renamed.count(
+                                             func.signature().name()) > 0;
+                                }),
+                 funcs->end());
+    RenameFunctionReferences(renamed, optimized_graph);
+    num_removed += renamed.size();
+    changed = true;
+  }
+  return num_removed;
+}
+
+// Return true if calling the function has no side effects: the function is
+// not stateful and all the nodes in its body are free of side effects.
+bool IsFunctionFreeOfSideEffect(
+    const FunctionLibraryDefinition& flib, const string& func_name,
+    std::unordered_map<string, bool>* side_effect_free) {
+  auto it = side_effect_free->find(func_name);
+  if (it != side_effect_free->end()) return it->second;
+  // Treat recursive calls conservatively.
+  (*side_effect_free)[func_name] = false;
+
+  const FunctionDef* func = flib.Find(func_name);
+  if (func == nullptr || func->signature().is_stateful()) return false;
+  for (const NodeDef& node : func->node_def()) {
+    if (flib.Find(node.op()) != nullptr) {
+      if (!IsFunctionFreeOfSideEffect(flib, node.op(), side_effect_free)) {
+        return false;
+      }
+    } else if (!IsFreeOfSideEffect(node)) {
+      return false;
+    }
+  }
+  (*side_effect_free)[func_name] = true;
+  return true;
+}
+
+bool AreNodeAttrsEqual(const NodeDef& a, const NodeDef& b) {
+  if (a.attr_size() != b.attr_size()) return false;
+  for (const auto& attr : a.attr()) {
+    auto it = b.attr().find(attr.first);
+    if (it == b.attr().end() || !AreAttrValuesEqual(attr.second, it->second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Remove the calls to side-effect free functions that have the same inputs,
+// attributes and device as another call to the same function, and forward
+// their consumers to the call that is kept. Calls with identical data and
+// control inputs always belong to the same frame. Returns the number of
+// removed nodes.
+int DedupFunctionCalls(const std::unordered_set<string>& nodes_to_preserve,
+                       GraphDef* optimized_graph) {
+  FunctionLibraryDefinition flib(OpRegistry::Global(),
+                                 optimized_graph->library());
+  std::unordered_map<string, bool> side_effect_free;
+
+  int num_removed = 0;
+  bool changed = true;
+  // Forwarding the consumers can make more calls identical.
+  while (changed) {
+    changed = false;
+    std::unordered_map<string, std::vector<const NodeDef*>> calls;
+    std::unordered_map<string, string> duplicates;
+    for (const NodeDef& node : optimized_graph->node()) {
+      if (nodes_to_preserve.count(node.name()) > 0 ||
+          flib.Find(node.op()) == nullptr ||
+          !IsFunctionFreeOfSideEffect(flib, node.op(), &side_effect_free)) {
+        continue;
+      }
+      const string key =
+          strings::StrCat(node.op(), "|", node.device(), "|",
+                          str_util::Join(node.input(), ","));
+      std::vector<const NodeDef*>& same_inputs = calls[key];
+      const NodeDef* rep = nullptr;
+      for (const NodeDef* candidate : same_inputs) {
+        if (AreNodeAttrsEqual(*candidate, node)) {
+          rep = candidate;
+          break;
+        }
+      }
+      if (rep == nullptr) {
+        same_inputs.push_back(&node);
+      } else {
+        duplicates[node.name()] = rep->name();
+      }
+    }
+    if (duplicates.empty()) break;
+
+    VLOG(2) << "Dedup " << duplicates.size() << " identical function calls";
+    for (NodeDef& node : *optimized_graph->mutable_node()) {
+      for (int i = 0; i < node.input_size(); ++i) {
+        int position;
+        const string input = ParseNodeName(node.input(i), &position);
+        auto it = duplicates.find(input);
+        if (it == duplicates.end()) continue;
+        if (position > 0) {
+          node.set_input(i, strings::StrCat(it->second, ":", position));
+        } else if (position == 0) {
+          node.set_input(i, it->second);
+        } else {
+          node.set_input(i, AsControlDependency(it->second));
+        }
+      }
+    }
+    auto* nodes = optimized_graph->mutable_node();
+    nodes->erase(std::remove_if(nodes->begin(), nodes->end(),
+                                [&duplicates](const NodeDef& node) {
+                                  return duplicates.count(node.name()) > 0;
+                                }),
+                 nodes->end());
+    num_removed += duplicates.size();
+    changed = true;
+  }
+  return num_removed;
+}
+
 }  // namespace
 
 Status FunctionOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
@@ -602,6 +807,14 @@ Status FunctionOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
           ? TrimFunctionLibrary(ctx.function_library(), *optimized_graph)
           : ctx.function_library().ToProto();
 
+  if (options_.enable_function_deduplication) {
+    DedupFunctionLibrary(optimized_graph);
+    // Duplicate calls can only be removed if the fetch nodes are known.
+    if (!item.fetch.empty()) {
+      DedupFunctionCalls(item.NodesToPreserve(), optimized_graph);
+    }
+  }
+
   return Status::OK();
 }
 
@@ -657,5 +657,94 @@ TEST_F(FunctionOptimizerTest, SpecializeFunction_XTimesTwo) {
   test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
 }
 
+TEST_F(FunctionOptimizerTest, DedupFunctions_IdenticalSpecializations) {
+  using test::function::NDef;
+
+  FunctionOptimizer optimizer(RewriterConfig::DEFAULT);
+
+  // Mark XTimesTwo as noinline.
+  FunctionDef x_times_two = test::function::XTimesTwo();
+  (*x_times_two.mutable_attr())["_noinline"].set_b(true);
+  std::vector<FunctionDef> function_library = {x_times_two};
+
+  // Both calls are specialized for the same type, which yields two identical
+  // specialized functions.
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("x1", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("x2", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("y1", "XTimesTwo", {"x1"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("y2", "XTimesTwo", {"x2"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("z", "Add", {"y1", "y2"}, {{"T", DT_FLOAT}}, kDevice)},
+      function_library);
+  item.fetch = {"z"};
+
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  ASSERT_EQ(1, output.library().function_size());
+  const string& func_name = output.library().function(0).signature().name();
+  int count = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "y1" || node.name() == "y2") {
+      ++count;
+      EXPECT_EQ(func_name, node.op());
+    }
+  }
+  EXPECT_EQ(2, count);
+
+  Tensor x1 = test::AsScalar<float>(3.14f);
+  Tensor x2 = test::AsScalar<float>(2.72f);
+  item.feed.emplace_back("x1", x1);
+  item.feed.emplace_back("x2", x2);
+
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized(item, std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+}
+
+TEST_F(FunctionOptimizerTest, DedupFunctions_IdenticalCalls) {
+  using test::function::NDef;
+
+  FunctionOptimizer optimizer(RewriterConfig::DEFAULT);
+  DisableFunctionSpecialization(&optimizer);
+
+  // Mark XTimesTwoInt32 as noinline.
+  FunctionDef x_times_two = test::function::XTimesTwoInt32();
+  (*x_times_two.mutable_attr())["_noinline"].set_b(true);
+  std::vector<FunctionDef> function_library = {x_times_two};
+
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("x", "Placeholder", {}, {{"dtype", DT_INT32}}, kDevice),
+       NDef("y1", "XTimesTwoInt32", {"x"}, {}, kDevice),
+       NDef("y2", "XTimesTwoInt32", {"x"}, {}, kDevice),
+       NDef("z", "Add", {"y1", "y2"}, {{"T", DT_INT32}}, kDevice)},
+      function_library);
+  item.fetch = {"z"};
+
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The second call is removed and its consumer reads the first call.
+  EXPECT_EQ(3, output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("y2", node.name());
+    if (node.name() == "z") {
+      EXPECT_EQ("y1", node.input(0));
+      EXPECT_EQ("y1", node.input(1));
+    }
+  }
+
+  Tensor x = test::AsScalar<int32>(7);
+  item.feed.emplace_back("x", x);
+
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized(item, std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorEqual<int32>(tensors_expected[0], tensors[0]);
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <deque>
+#include <functional>
 #include <unordered_set>
 
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -35,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/port.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -80,6 +82,28 @@ std::set<string> GetOpsFormatSupported() {
   return ops_format_supported;
 }
 
+// The subset of GetOpsFormatSupported() whose CPU kernels accept NCHW. These
+// are the ops that the MKL layout pass rewrites into MKL kernels.
+std::set<string> GetOpsFormatSupportedOnCPU() {
+  std::set<string> ops_format_supported = {"AvgPool",
+                                           "AvgPoolGrad",
+                                           "Conv2D",
+                                           "Conv2DBackpropFilter",
+                                           "Conv2DBackpropInput",
+                                           "BiasAdd",
+                                           "BiasAddGrad",
+                                           "FusedBatchNorm",
+                                           "FusedBatchNormGrad",
+                                           "MaxPool",
+                                           "MaxPoolGrad"};
+  return ops_format_supported;
+}
+
+// A region of CPU ops is only converted if it contains at least this many
+// format-supported ops. A lone op would pay for two transposes, which is no
+// cheaper than the reorders the MKL kernel performs internally.
+const int kMinCPURegionSize = 2;
+
 std::set<string> GetOpsFormatAgnostic() {
   std::set<string> ops_format_agnostic = {"Abs",
                                           "Add",
@@ -468,14 +492,15 @@ struct OptimizeContext {
                   const GraphProperties& graph_properties,
                   const VirtualPlacer& virtual_placer,
                   const std::unordered_set<string>& nodes_to_preserve,
-                  bool is_in_frame)
+                  bool is_in_frame, bool convert_cpu_nodes)
       : graph(graph),
         node(node),
         node_map(node_map),
         graph_properties(graph_properties),
         virtual_placer(virtual_placer),
         nodes_to_preserve(nodes_to_preserve),
-        is_in_frame(is_in_frame) {}
+        is_in_frame(is_in_frame),
+        convert_cpu_nodes(convert_cpu_nodes) {}
   GraphDef* graph;
   NodeDef* node;
   NodeMap* node_map;
@@ -483,6 +508,7 @@ struct OptimizeContext {
   const VirtualPlacer& virtual_placer;
   const std::unordered_set<string>& nodes_to_preserve;
   bool is_in_frame;
+  bool convert_cpu_nodes;
 };
 
 class NodeProcessor : public GraphProcessor {
@@ -492,7 +518,8 @@ class NodeProcessor : public GraphProcessor {
                        opt_cxt.nodes_to_preserve, opt_cxt.graph,
                        opt_cxt.node_map),
         node_(opt_cxt.node),
-        is_in_frame_(opt_cxt.is_in_frame) {}
+        is_in_frame_(opt_cxt.is_in_frame),
+        convert_cpu_nodes_(opt_cxt.convert_cpu_nodes) {}
   virtual ~NodeProcessor() {}
   virtual Status ConvertNode() {
     if (ShouldProcess()) {
@@ -563,7 +590,7 @@ class NodeProcessor : public GraphProcessor {
     return nodes_to_preserve_.find(node_->name()) != nodes_to_preserve_.end();
   }
 
-  bool IsOnGPU() const {
+  bool IsOnDevice(const char* device_type) const {
     string device_name;
     if (node_->device().empty()) {
       device_name = virtual_placer_.get_canonical_device_name(*node_);
@@ -574,15 +601,21 @@ class NodeProcessor : public GraphProcessor {
     string not_used;
     if (DeviceNameUtils::SplitDeviceName(device_name, &not_used, &device) &&
         str_util::StrContains(str_util::Lowercase(device),
-                              str_util::Lowercase(DEVICE_GPU))) {
+                              str_util::Lowercase(device_type))) {
       return true;
     }
     return false;
   }
 
+  // Returns true if the node is placed on the device type being converted:
+  // CPU if convert_cpu_nodes is set in the tuning config, GPU otherwise.
+  bool IsOnTargetDevice() const {
+    return convert_cpu_nodes_ ? IsOnDevice(DEVICE_CPU) : IsOnDevice(DEVICE_GPU);
+  }
+
   virtual bool ShouldProcess() const {
     return !MustPreserve() && IsNHWC() && IsPortZeroDimsFour(*node_) &&
-           HasOutputs() && IsOnGPU();
+           HasOutputs() && IsOnTargetDevice();
   }
 
   virtual void UpdateAttrShape() {
@@ -726,6 +759,7 @@ class NodeProcessor : public GraphProcessor {
 
   NodeDef* node_;
   bool is_in_frame_;
+  bool convert_cpu_nodes_;
 
  private:
   void UpdateAttrKSize() {
@@ -991,7 +1025,7 @@ class BiasAddGradProcessor : public NodeProcessor {
     if (MustPreserve()) {
       return false;
     }
-    if (!IsOnGPU()) {
+    if (!IsOnTargetDevice()) {
       return false;
     }
     auto input = node_map_->GetNode(node_->input(0));
@@ -1016,7 +1050,7 @@ class Conv2DProcessor : public NodeProcessor {
  protected:
   bool ShouldProcess() const override {
     return !MustPreserve() && IsNHWC() && IsPortZeroDimsFour(*node_) &&
-           HasOutputs() && (!IsGemmUsed() || no_gemm_) && IsOnGPU();
+           HasOutputs() && (!IsGemmUsed() || no_gemm_) && IsOnTargetDevice();
   }
 
   TensorShapeProto GetShape(const string& input_name) const {
@@ -1178,7 +1212,7 @@ class MaxPoolV2Processor : public NodeProcessor {
     int port;
     ParseNodeName(node_->input(0), &port);
     return !MustPreserve() && IsNHWC() && IsPortDimsFour(*data_input, port) &&
-           HasOutputs() && IsOnGPU();
+           HasOutputs() && IsOnTargetDevice();
   }
 
   Status CustomizedProcessing() override {
@@ -1198,7 +1232,7 @@ class AgnosticNodeProcessor : public NodeProcessor {
  protected:
   bool ShouldProcess() const override {
     return !MustPreserve() && IsPortZeroDimsFour(*node_) && HasOutputs() &&
-           IsNodeAfterNCHWToNHWC() && IsOnGPU();
+           IsNodeAfterNCHWToNHWC() && IsOnTargetDevice();
   }
 
   bool IsNodeAfterNCHWToNHWC(const NodeDef& node) const {
@@ -1264,7 +1298,7 @@ class BinaryOpProcessor : public AgnosticNodeProcessor {
            (IsNDOperateWithMD(4, 0) || IsNDOperateWithMD(4, 1) ||
             IsNDOperateWithMD(4, 4) || IsNDOperateWithMD(0, 4) ||
             IsNDOperateWithMD(1, 4)) &&
-           IsOnGPU();
+           IsOnTargetDevice();
   }
 
   std::vector<int> GetInputPos() const override {
@@ -1439,7 +1473,7 @@ class HistogramSummaryProcessor : public AgnosticNodeProcessor {
     int port;
     ParseNodeName(node_->input(1), &port);
     return !MustPreserve() && HasOutputs() && IsNodeAfterNCHWToNHWC() &&
-           IsPortDimsFour(*input1, port) && IsOnGPU();
+           IsPortDimsFour(*input1, port) && IsOnTargetDevice();
   }
 
   std::vector<int> GetInputPos() const override { return {1}; }
@@ -1472,7 +1506,7 @@ class IdentityNProcessor : public AgnosticNodeProcessor {
  protected:
   bool ShouldProcess() const override {
     return !MustPreserve() && HasOutputs() && IsNodeAfterNCHWToNHWC() &&
-           IsOnGPU();
+           IsOnTargetDevice();
   }
 
   std::vector<int> GetInputPos() const override { return input_pos_; }
@@ -1510,7 +1544,7 @@ class MergeProcessor : public AgnosticNodeProcessor {
  protected:
   bool ShouldProcess() const override {
     return !MustPreserve() && IsPortZeroDimsFour(*node_) && HasOutputs() &&
-           IsEveryInputAfterNCHWToNHWC() && IsOnGPU();
+           IsEveryInputAfterNCHWToNHWC() && IsOnTargetDevice();
   }
 
   std::vector<int> GetInputPos() const override {
@@ -1770,7 +1804,7 @@ class SqueezeProcessor : public AgnosticNodeProcessor {
     bool is_dims_supported = (IsPortZeroDimsN(*node_, 2) && IsAlongHW()) ||
                              (IsPortZeroDimsN(*node_, 1) && IsAlongNHW());
     return !MustPreserve() && HasOutputs() && IsNodeAfterNCHWToNHWC() &&
-           IsInputConvertible() && is_dims_supported && IsOnGPU();
+           IsInputConvertible() && is_dims_supported && IsOnTargetDevice();
   }
 
   Status AddLayoutTransposeToOutputs() override { return Status::OK(); }
@@ -1840,7 +1874,7 @@ class ReduceProcessor : public AgnosticNodeProcessor {
     ParseNodeName(node_->input(0), &port);
     return !MustPreserve() && HasOutputs() && IsNodeAfterNCHWToNHWC() &&
            IsPortDimsFour(*input0, port) && IsReduceAxisSupported() &&
-           IsOnGPU();
+           IsOnTargetDevice();
   }
 
   Status CustomizedProcessing() override {
@@ -1954,6 +1988,91 @@ class DataLayoutOptimizer : GraphProcessor {
                             {0, 2, 3, 1});
   }
 
+  // Returns true if the CPU kernel of the node accepts NCHW.
+  bool IsFormatSupportedOnCPU(
+      const NodeDef& node, const std::set<string>& ops_format_supported) const {
+    if (ops_format_supported.find(node.op()) == ops_format_supported.end()) {
+      return false;
+    }
+    // The MKL kernels are only registered for float.
+    if (node.attr().find("T") == node.attr().end() ||
+        node.attr().at("T").type() != DT_FLOAT) {
+      return false;
+    }
+    // Depth-wise and batch-wise max pooling are not rewritten into MKL
+    // kernels, and the default CPU kernels only support NHWC.
+    if (node.op() == "MaxPool" || IsMaxPoolGradV1(node)) {
+      for (const string& attr : {"ksize", "strides"}) {
+        if (node.attr().find(attr) == node.attr().end()) {
+          return false;
+        }
+        const auto& list = node.attr().at(attr).list();
+        if (list.i_size() != 4 || list.i(0) != 1 || list.i(3) != 1) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // Groups the CPU ops whose kernels accept NCHW into regions connected
+  // directly or through layout-agnostic ops, and returns the ops of the
+  // regions that contain at least kMinCPURegionSize of them. Converting a
+  // whole region leaves transposes only at its boundaries.
+  std::unordered_set<string> GetCPURegionNodes() {
+    std::set<string> ops_format_supported = GetOpsFormatSupportedOnCPU();
+    std::set<string> ops_format_agnostic = GetOpsFormatAgnostic();
+    std::unordered_map<string, int> node_index;
+    std::vector<int> region(graph_->node_size());
+    std::vector<bool> is_supported(graph_->node_size());
+    for (int i = 0; i < graph_->node_size(); i++) {
+      const NodeDef& node = graph_->node(i);
+      node_index[node.name()] = i;
+      region[i] = i;
+      is_supported[i] = IsFormatSupportedOnCPU(node, ops_format_supported);
+    }
+    std::function<int(int)> find_region = [&](int i) {
+      if (region[i] != i) {
+        region[i] = find_region(region[i]);
+      }
+      return region[i];
+    };
+    auto is_region_member = [&](int i) {
+      return is_supported[i] ||
+             ops_format_agnostic.find(graph_->node(i).op()) !=
+                 ops_format_agnostic.end();
+    };
+    for (int i = 0; i < graph_->node_size(); i++) {
+      if (!is_region_member(i)) {
+        continue;
+      }
+      for (const string& input : graph_->node(i).input()) {
+        if (IsControlInput(input)) {
+          continue;
+        }
+        auto it = node_index.find(NodeName(input));
+        if (it != node_index.end() && is_region_member(it->second)) {
+          region[find_region(it->second)] = find_region(i);
+        }
+      }
+    }
+    std::unordered_map<int, int> region_size;
+    for (int i = 0; i < graph_->node_size(); i++) {
+      if (is_supported[i]) {
+        region_size[find_region(i)]++;
+      }
+    }
+    std::unordered_set<string> nodes;
+    for (int i = 0; i < graph_->node_size(); i++) {
+      if (is_supported[i] &&
+          region_size[find_region(i)] >= kMinCPURegionSize) {
+        nodes.insert(graph_->node(i).name());
+      }
+    }
+    VLOG(1) << "Number of CPU nodes in convertible regions: " << nodes.size();
+    return nodes;
+  }
+
   // Expand all nodes which is in NHWC, but supports NCHW or is layout agnostic.
   Status Expand() {
     int node_size_original = graph_->node_size();
@@ -1963,18 +2082,27 @@ class DataLayoutOptimizer : GraphProcessor {
 
     // This is the first pass where we expand the nodes which support NCHW.
     std::set<string> ops_format_supported = GetOpsFormatSupported();
+    std::unordered_set<string> cpu_region_nodes;
+    if (config_.convert_cpu_nodes) {
+      cpu_region_nodes = GetCPURegionNodes();
+    }
     for (int i = 0; i < node_size_original; i++) {
       if (IsNodeByLayoutOptimizer(graph_->node(i).name())) {
         return Status(error::INVALID_ARGUMENT,
                       "The graph is already optimized by layout optimizer.");
       }
+      if (config_.convert_cpu_nodes &&
+          cpu_region_nodes.find(graph_->node(i).name()) ==
+              cpu_region_nodes.end()) {
+        continue;
+      }
       if (ops_format_supported.find(graph_->node(i).op()) !=
           ops_format_supported.end()) {
         auto node = graph_->mutable_node(i);
         bool is_in_frame = !frames[node].empty();
         OptimizeContext opt_cxt(graph_, node, node_map_, graph_properties_,
                                 virtual_placer_, nodes_to_preserve_,
-                                is_in_frame);
+                                is_in_frame, config_.convert_cpu_nodes);
         std::unique_ptr<NodeProcessor> node_processor;
         if (IsAvgPoolGrad(*node)) {
           node_processor.reset(new AvgPoolGradProcessor(opt_cxt));
@@ -2024,7 +2152,7 @@ class DataLayoutOptimizer : GraphProcessor {
           bool is_in_frame = !frames[node].empty();
           OptimizeContext opt_cxt(graph_, node, node_map_, graph_properties_,
                                   virtual_placer_, nodes_to_preserve_,
-                                  is_in_frame);
+                                  is_in_frame, config_.convert_cpu_nodes);
           std::unique_ptr<NodeProcessor> node_processor;
           if (IsAddN(*node)) {
             node_processor.reset(new AddNProcessor(opt_cxt));
@@ -2142,6 +2270,8 @@ int GetNumGPUs(const Cluster& cluster) {
 }
 }  // namespace
 
+LayoutOptimizer::LayoutOptimizer() : convert_cpu_nodes_(IsMklEnabled()) {}
+
 Status LayoutOptimizer::Tune(const GrapplerItem& item,
                              const GraphProperties& graph_properties,
                              const TuningConfig& config, GraphDef* output) {
@@ -2165,8 +2295,9 @@ Status LayoutOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     return errors::InvalidArgument("cluster == nullptr");
   }
 
-  if (GetNumGPUs(*cluster) < 1) {
-    // LayoutOptimizer is currently only tuned for GPU.
+  const bool convert_cpu_nodes = GetNumGPUs(*cluster) < 1;
+  if (convert_cpu_nodes && !convert_cpu_nodes_) {
+    // Without GPUs, NCHW only pays off when the CPU kernels support it.
     *output = item.graph;
     return Status::OK();
   }
@@ -2183,6 +2314,7 @@ Status LayoutOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
 
   TuningConfig config;
   config.no_gemm = true;
+  config.convert_cpu_nodes = convert_cpu_nodes;
   // TODO(yaozhang): Enable tuning with various TuningConfig choices wtih
   // the measurement-based estimator.
   status = Tune(item, graph_properties, config, output);
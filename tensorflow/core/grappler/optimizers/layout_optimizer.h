@@ -22,10 +22,16 @@ limitations under the License.
 
 namespace tensorflow {
 namespace grappler {
-// Convert the NHWC layout to NCHW for Conv-related ops on GPUs.
+// Convert the NHWC layout to NCHW for Conv-related ops on GPUs. On clusters
+// without GPUs, Conv-related ops on CPU are converted instead when the CPU
+// kernels accept NCHW (i.e. in MKL builds).
 class LayoutOptimizer : public GraphOptimizer {
  public:
-  LayoutOptimizer() {}
+  LayoutOptimizer();
+  // If `convert_cpu_nodes` is true, the optimizer also runs on clusters
+  // without GPUs and converts regions of CPU ops.
+  explicit LayoutOptimizer(bool convert_cpu_nodes)
+      : convert_cpu_nodes_(convert_cpu_nodes) {}
   ~LayoutOptimizer() override {}
 
   string name() const override { return "layout"; };
@@ -39,6 +45,10 @@ class LayoutOptimizer : public GraphOptimizer {
     // might result in more non-cancellable layout conversion nodes (implemented
     // by the Transpose op).
     bool no_gemm;
+    // If true, convert the ops placed on CPU rather than on GPU. Only the ops
+    // with NCHW-capable MKL kernels are converted, and only when they form a
+    // region large enough to amortize the transposes at its boundaries.
+    bool convert_cpu_nodes;
   };
 
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
@@ -48,6 +58,7 @@ class LayoutOptimizer : public GraphOptimizer {
                 const GraphDef& optimize_output, double result) override;
 
  private:
+  const bool convert_cpu_nodes_;
   std::unique_ptr<VirtualPlacer> virtual_placer_;
   std::unordered_set<string> nodes_to_preserve_;
   Status Tune(const GrapplerItem& item, const GraphProperties& graph_properties,
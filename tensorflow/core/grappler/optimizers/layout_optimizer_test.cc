@@ -1176,6 +1176,81 @@ TEST_F(LayoutOptimizerTest, DevicePlacement) {
       node_map.GetNode("s-0-0-VecPermuteNCHWToNHWC-LayoutOptimizer");
   EXPECT_EQ(vec_permute->attr().at("_kernel").s(), "host");
 }
+
+TEST_F(LayoutOptimizerTest, CPURegion) {
+  DeviceProperties device_properties;
+  device_properties.set_type("CPU");
+  VirtualCluster cpu_cluster(
+      {{"/job:localhost/replica:0/task:0/device:CPU:0", device_properties}});
+  TF_CHECK_OK(cpu_cluster.Provision());
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto conv = SimpleConv2D(&s, 8, 2, "SAME");
+  auto relu = ops::Relu(s.WithOpName("Relu"), conv);
+  auto max_pool = ops::MaxPool(s.WithOpName("MaxPool"), relu, {1, 2, 2, 1},
+                               {1, 2, 2, 1}, "VALID");
+  Output fetch = ops::Identity(s.WithOpName("Fetch"), {max_pool});
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  LayoutOptimizer optimizer(/*convert_cpu_nodes=*/true);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(&cpu_cluster, item, &output));
+  NodeMap node_map(&output);
+  auto conv_node = node_map.GetNode("Conv2D");
+  EXPECT_EQ("NCHW", conv_node->attr().at("data_format").s());
+  EXPECT_EQ("Conv2D-0-TransposeNHWCToNCHW-LayoutOptimizer",
+            conv_node->input(0));
+  // The transposes between the ops of the region cancel out.
+  EXPECT_EQ("Conv2D", node_map.GetNode("Relu")->input(0));
+  auto max_pool_node = node_map.GetNode("MaxPool");
+  EXPECT_EQ("NCHW", max_pool_node->attr().at("data_format").s());
+  EXPECT_EQ("Relu", max_pool_node->input(0));
+  EXPECT_EQ("MaxPool-0-0-TransposeNCHWToNHWC-LayoutOptimizer",
+            node_map.GetNode("Fetch")->input(0));
+  TF_CHECK_OK(cpu_cluster.Shutdown());
+}
+
+TEST_F(LayoutOptimizerTest, CPUSingleOpNotConverted) {
+  DeviceProperties device_properties;
+  device_properties.set_type("CPU");
+  VirtualCluster cpu_cluster(
+      {{"/job:localhost/replica:0/task:0/device:CPU:0", device_properties}});
+  TF_CHECK_OK(cpu_cluster.Provision());
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto conv = SimpleConv2D(&s, 8, 2, "SAME");
+  Output fetch = ops::Identity(s.WithOpName("Fetch"), {conv});
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  LayoutOptimizer optimizer(/*convert_cpu_nodes=*/true);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(&cpu_cluster, item, &output));
+  NodeMap node_map(&output);
+  EXPECT_EQ("NHWC", node_map.GetNode("Conv2D")->attr().at("data_format").s());
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  TF_CHECK_OK(cpu_cluster.Shutdown());
+}
+
+TEST_F(LayoutOptimizerTest, CPUNotConvertedByDefault) {
+  DeviceProperties device_properties;
+  device_properties.set_type("CPU");
+  VirtualCluster cpu_cluster(
+      {{"/job:localhost/replica:0/task:0/device:CPU:0", device_properties}});
+  TF_CHECK_OK(cpu_cluster.Provision());
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto conv = SimpleConv2D(&s, 8, 2, "SAME");
+  auto relu = ops::Relu(s.WithOpName("Relu"), conv);
+  auto max_pool = ops::MaxPool(s.WithOpName("MaxPool"), relu, {1, 2, 2, 1},
+                               {1, 2, 2, 1}, "VALID");
+  Output fetch = ops::Identity(s.WithOpName("Fetch"), {max_pool});
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  LayoutOptimizer optimizer(/*convert_cpu_nodes=*/false);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(&cpu_cluster, item, &output));
+  NodeMap node_map(&output);
+  EXPECT_EQ("NHWC", node_map.GetNode("Conv2D")->attr().at("data_format").s());
+  EXPECT_EQ("NHWC", node_map.GetNode("MaxPool")->attr().at("data_format").s());
+  TF_CHECK_OK(cpu_cluster.Shutdown());
+}
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -324,7 +324,9 @@ Status LoopInvariantNodeMotionOptimizer::FindInvariantNodes(NodeDef* node) {
   auto consumers = node_map_->GetOutputs(node->name());
   invariant_nodes_.insert(std::make_pair(node, consumers.size()));
   for (auto* consumer : consumers) {
-    if (invariant_nodes_.count(consumer) || ModifiesFrameInfo(*consumer)) {
+    // Stateful nodes must run once per iteration, so they are never hoisted.
+    if (invariant_nodes_.count(consumer) || ModifiesFrameInfo(*consumer) ||
+        !IsFreeOfSideEffect(*consumer)) {
       continue;
     }
     bool is_invariant = true;
@@ -466,10 +468,11 @@ std::vector<int> GetStackPushNodesToConvert(
   return nodes_to_convert;
 }
 
-Status RemoveStackOps(const GrapplerItem& item, GraphDef* optimized_graph) {
-  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
-  const GraphDef& graph = item.graph;
-  *optimized_graph = graph;
+Status RemoveStackOps(const std::unordered_set<string>& nodes_to_preserve,
+                      GraphDef* optimized_graph) {
+  // The graph view is built from a copy, since the rewrites below add
+  // control dependencies to the optimized graph.
+  const GraphDef graph = *optimized_graph;
   NodeMap node_map(optimized_graph);
   SimpleGraphView graph_view;
   TF_RETURN_IF_ERROR(graph_view.Initialize(graph));
@@ -509,7 +512,8 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     TF_RETURN_IF_ERROR(linm_optimizer.Optimize());
   }
   if (options_.enable_stack_push_removal) {
-    TF_RETURN_IF_ERROR(RemoveStackOps(item, optimized_graph));
+    TF_RETURN_IF_ERROR(
+        RemoveStackOps(item.NodesToPreserve(), optimized_graph));
   }
 
   return Status::OK();
@@ -28,6 +28,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/costs/graph_memory.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/virtual_placer.h"
 #include "tensorflow/core/grappler/graph_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
@@ -412,6 +414,42 @@ void RecomputeSubgraph(
   }
 }
 
+// Duplicates the `recomputed_subgraphs` of `graph`, which must be sorted
+// topologically, and sets up control dependencies.
+void RecomputeSubgraphs(
+    const std::vector<RecomputedSubGraph>& recomputed_subgraphs,
+    const NodeMap& node_map, GraphDef* graph) {
+  if (recomputed_subgraphs.empty()) {
+    return;
+  }
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  for (int node_number = 0; node_number < graph->node().size();
+       ++node_number) {
+    topological_numbering[graph->mutable_node(node_number)] =
+        graph->node().size() - node_number - 1;
+  }
+  for (const RecomputedSubGraph& subgraph : recomputed_subgraphs) {
+    RecomputeSubgraph(subgraph.recomputed_source_nodes, subgraph.target_nodes,
+                      node_map, topological_numbering, graph);
+  }
+}
+
+bool IsRecomputedNode(const NodeDef& node) {
+  return node.name().find(strings::StrCat(kRecomputedNodePrefix, "/")) == 0 ||
+         node.name().find(strings::StrCat(kRecomputeTriggerNodePrefix, "/")) ==
+             0;
+}
+
+// Matches node names that contain `recomputation_targets_name_scope` as a name
+// scope, meaning it either begins with or contains the name scope.
+std::function<bool(const NodeDef&)> RecomputationTargetMatcher(
+    const string& recomputation_targets_name_scope) {
+  return [recomputation_targets_name_scope](const NodeDef& node) {
+    return node.name().find(recomputation_targets_name_scope) == 0 ||
+           node.name().find("/" + recomputation_targets_name_scope) != -1;
+  };
+}
+
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
                                 GraphDef* graph, const GrapplerItem& item) {
@@ -437,16 +475,11 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
   for (const auto& feed : item.feed) {
     feeds.insert(NodeName(feed.first));
   }
+  // Nodes whose inputs we may want to recompute. Defaults to "gradients/" which
+  // will match any node names that begins with "gradients/" or contains
+  // "/gradients/".
   std::function<bool(const NodeDef&)> is_target =
-      [&recomputation_targets_name_scope](const NodeDef& node) {
-        // Nodes whose inputs we may want to recompute. This matches node names
-        // that contain recomputation_targets_name_scope as a name scope,
-        // meaning it either begins with or contains the name scope.
-        // Defaults to "gradients/" which will match any node names that begins
-        // with "gradients/" or contains "/gradients/".
-        return node.name().find(recomputation_targets_name_scope) == 0 ||
-               node.name().find("/" + recomputation_targets_name_scope) != -1;
-      };
+      RecomputationTargetMatcher(recomputation_targets_name_scope);
 
   if (optimization_level == RewriterConfig::RECOMPUTATION_HEURISTICS ||
       optimization_level == RewriterConfig::HEURISTICS) {
@@ -473,19 +506,140 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
         },
         is_target);
   }
-  if (!recomputed_subgraphs.empty()) {
-    std::unordered_map<const NodeDef*, int> topological_numbering;
-    for (int node_number = 0; node_number < graph->node().size();
-         ++node_number) {
-      topological_numbering[graph->mutable_node(node_number)] =
-          graph->node().size() - node_number - 1;
-    }
-    // Duplicate the indicated sub-graphs and set up control dependencies
-    for (const RecomputedSubGraph& subgraph : recomputed_subgraphs) {
-      RecomputeSubgraph(subgraph.recomputed_source_nodes, subgraph.target_nodes,
-                        node_map, topological_numbering, graph);
+  RecomputeSubgraphs(recomputed_subgraphs, node_map, graph);
+}
+
+// Estimated savings of recomputing a node whose outputs are live at the memory
+// peak of a device.
+struct RecomputeCandidate {
+  const NodeDef* node;
+  int64 freed_memory;
+  Costs::NanoSeconds recompute_time;
+};
+
+// Recomputes activations based on the memory timeline estimated by GraphMemory.
+// For each device whose estimated peak memory usage exceeds the budget, the
+// candidate nodes whose outputs are live at the peak are ranked by the amount
+// of memory they free per unit of recomputation time (similar to XLA's
+// HloRematerialization), and the best ones are selected until the peak fits in
+// the budget. Returns true if the graph was updated.
+bool BudgetedRecomputationPass(Cluster* cluster, int64 memory_budget,
+                               const string& recomputation_targets_name_scope,
+                               GrapplerItem* item) {
+  GraphMemory memory(*item);
+  const std::unordered_map<string, DeviceProperties>& devices =
+      cluster->GetDevices();
+  Status s = memory.InferStatically(devices);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+    return false;
+  }
+  GraphProperties properties(*item);
+  s = properties.InferStatically(false);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer shapes: " << s.error_message();
+    return false;
+  }
+
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+  std::function<bool(const NodeDef&)> is_target =
+      RecomputationTargetMatcher(recomputation_targets_name_scope);
+  std::unordered_set<string> cheap_to_recompute_ops = GetCheapToRecomputeOps();
+  std::function<bool(const NodeDef&)> is_candidate =
+      [&cheap_to_recompute_ops, &feeds, &is_target](const NodeDef& node) {
+        return !is_target(node) && feeds.count(node.name()) == 0 &&
+               !IsRecomputedNode(node) &&
+               (cheap_to_recompute_ops.count(node.op()) > 0 ||
+                node.attr().count(kRecomputeHint) > 0);
+      };
+  NodeMap node_map(&item->graph);
+  std::unordered_set<const NodeDef*> candidates = FindCandidateRecomputeNodes(
+      node_map, &item->graph, is_candidate, is_target);
+  if (candidates.empty()) {
+    return false;
+  }
+
+  OpLevelCostEstimator estimator;
+  VirtualPlacer placer(cluster);
+  std::unordered_set<string> nodes_to_recompute;
+  for (const auto& device : devices) {
+    const string& name = device.first;
+    int64 budget = memory_budget;
+    if (budget <= 0) {
+      budget = device.second.memory_size() * 0.8;
+    }
+    if (budget <= 0) {
+      VLOG(1) << "Memory budget unknown for device " << name;
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    int64 excess = mem_usage.used_memory - budget;
+    if (excess <= 0) {
+      continue;
+    }
+
+    std::unordered_map<const NodeDef*, int64> freed_memory;
+    for (const auto& live : mem_usage.live_tensors) {
+      const NodeDef* node = node_map.GetNode(live.node);
+      if (node != nullptr && candidates.count(node) > 0) {
+        freed_memory[node] += live.memory_used;
+      }
+    }
+    std::vector<RecomputeCandidate> ranked;
+    for (const auto& freed : freed_memory) {
+      if (freed.second <= 0 ||
+          nodes_to_recompute.count(freed.first->name()) > 0) {
+        continue;
+      }
+      ranked.push_back({freed.first, freed.second,
+                        PredictExecutionTime(properties, estimator, placer,
+                                             *freed.first)});
+    }
+    std::sort(ranked.begin(), ranked.end(),
+              [](const RecomputeCandidate& a, const RecomputeCandidate& b) {
+                // Compare a.freed_memory / a.recompute_time with
+                // b.freed_memory / b.recompute_time without dividing.
+                double lhs = static_cast<double>(a.freed_memory) *
+                             b.recompute_time.count();
+                double rhs = static_cast<double>(b.freed_memory) *
+                             a.recompute_time.count();
+                return lhs > rhs ||
+                       (lhs == rhs && a.node->name() < b.node->name());
+              });
+    for (const RecomputeCandidate& candidate : ranked) {
+      if (excess <= 0) {
+        break;
+      }
+      VLOG(2) << "Recomputing " << candidate.node->name() << " frees "
+              << candidate.freed_memory << " bytes on " << name << " for "
+              << candidate.recompute_time.count() << "ns";
+      nodes_to_recompute.insert(candidate.node->name());
+      excess -= candidate.freed_memory;
+    }
+    if (excess > 0) {
+      VLOG(1) << "Recomputation can't bring the peak memory usage of " << name
+              << " under " << budget << " bytes";
     }
   }
+  if (nodes_to_recompute.empty()) {
+    return false;
+  }
+
+  // The NodeDef pointers collected above are invalidated by the topological
+  // sort, so we only rely on node names from here on.
+  TF_CHECK_OK(TopologicalSort(&item->graph));
+  NodeMap sorted_node_map(&item->graph);
+  std::vector<RecomputedSubGraph> recomputed_subgraphs = GetOpGroupsToRecompute(
+      &item->graph, sorted_node_map,
+      [&nodes_to_recompute](const NodeDef& node) {
+        return nodes_to_recompute.count(node.name()) > 0;
+      },
+      is_target);
+  RecomputeSubgraphs(recomputed_subgraphs, sorted_node_map, &item->graph);
+  return !recomputed_subgraphs.empty();
 }
 
 bool SchedulingPass(Cluster* cluster, GrapplerItem* item) {
@@ -1228,6 +1382,19 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                              item);
 
   GrapplerItem optimized_item(item, optimized_graph);
+  if (optimization_level_ == RewriterConfig::BUDGETED_RECOMPUTATION &&
+      cluster != nullptr) {
+    // Each rewrite changes the memory timeline, so re-estimate it until the
+    // peak fits in the budget or there is nothing left to recompute.
+    for (int i = 0; i < 5; ++i) {
+      if (!BudgetedRecomputationPass(cluster, memory_budget_,
+                                     recomputation_targets_name_scope_,
+                                     &optimized_item)) {
+        break;
+      }
+    }
+  }
+
   std::unordered_set<string> skip_list;
   // Bound the number of rewrite passes to avoid long processing times on graphs
   // that simply won't fit in memory.
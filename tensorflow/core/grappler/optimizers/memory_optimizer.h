@@ -30,11 +30,16 @@ class MemoryOptimizer : public GraphOptimizer {
   // recomputation_targets_name_scope: Name scope for potential outputs of
   //   recomputations. See
   //   RewriterConfig::memory_optimizer_target_node_name_scope.
+  // memory_budget: Peak memory usage per device targeted by the
+  //   BUDGETED_RECOMPUTATION level. See
+  //   RewriterConfig::memory_optimizer_memory_budget.
   explicit MemoryOptimizer(
       RewriterConfig::MemOptType optimization_level,
-      const string& recomputation_targets_name_scope = "gradients/")
+      const string& recomputation_targets_name_scope = "gradients/",
+      int64 memory_budget = 0)
       : optimization_level_(optimization_level),
-        recomputation_targets_name_scope_(recomputation_targets_name_scope) {}
+        recomputation_targets_name_scope_(recomputation_targets_name_scope),
+        memory_budget_(memory_budget) {}
   ~MemoryOptimizer() override {}
 
   string name() const override { return "memory_optimizer"; };
@@ -48,6 +53,7 @@ class MemoryOptimizer : public GraphOptimizer {
  private:
   RewriterConfig::MemOptType optimization_level_;
   string recomputation_targets_name_scope_;
+  int64 memory_budget_;
 };
 
 }  // end namespace grappler
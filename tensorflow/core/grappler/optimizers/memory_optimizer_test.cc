@@ -217,6 +217,71 @@ class MemoryOptimizerTest : public GrapplerTest {
   }
 };
 
+TEST_F(MemoryOptimizerTest, BudgetedRecomputation) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::RandomNormal(s.WithOpName("a").WithDevice("/cpu:0"),
+                               {128, 128, 8}, DT_FLOAT);
+  Output b = ops::Sigmoid(s.WithOpName("b").WithDevice("/cpu:0"), a);
+  Output c = ops::Relu(s.WithOpName("c").WithDevice("/cpu:0"), b);
+  Output d =
+      ops::AddN(s.WithOpName("gradients/d").WithDevice("/cpu:0"), {c, c});
+  Output e =
+      ops::AddN(s.WithOpName("gradients/e").WithDevice("/cpu:0"), {d, b});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/e"};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  // The activations don't fit in a 1KB budget: 'b' must be recomputed.
+  MemoryOptimizer optimizer(RewriterConfig::BUDGETED_RECOMPUTATION,
+                            "gradients/", 1024);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* recomputed_b = node_map.GetNode("Recomputed/b");
+  ASSERT_NE(nullptr, recomputed_b);
+  EXPECT_EQ("Sigmoid", recomputed_b->op());
+  EXPECT_EQ("a", recomputed_b->input(0));
+  const NodeDef* transformed_e = node_map.GetNode("gradients/e");
+  EXPECT_EQ("gradients/d", transformed_e->input(0));
+  EXPECT_EQ("Recomputed/b", transformed_e->input(1));
+
+  auto tensors_expected = EvaluateNodes(item.graph, {"gradients/e"}, {});
+  auto tensors = EvaluateNodes(output, {"gradients/e"}, {});
+  EXPECT_EQ(1, tensors.size());
+  EXPECT_EQ(tensors_expected[0].shape(), tensors[0].shape());
+}
+
+TEST_F(MemoryOptimizerTest, BudgetedRecomputationUnderBudget) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::RandomNormal(s.WithOpName("a").WithDevice("/cpu:0"),
+                               {128, 128, 8}, DT_FLOAT);
+  Output b = ops::Sigmoid(s.WithOpName("b").WithDevice("/cpu:0"), a);
+  Output c = ops::Relu(s.WithOpName("c").WithDevice("/cpu:0"), b);
+  Output d =
+      ops::AddN(s.WithOpName("gradients/d").WithDevice("/cpu:0"), {c, c});
+  Output e =
+      ops::AddN(s.WithOpName("gradients/e").WithDevice("/cpu:0"), {d, b});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/e"};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  // Everything fits in 1GB: nothing should be recomputed.
+  MemoryOptimizer optimizer(RewriterConfig::BUDGETED_RECOMPUTATION,
+                            "gradients/", 1024 * 1024 * 1024);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_EQ(string::npos, node.name().find("Recomputed"));
+  }
+}
+
 TEST_F(MemoryOptimizerTest, SimpleSwapping) {
   // Build a simple graph with an op that's marked for swapping.
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
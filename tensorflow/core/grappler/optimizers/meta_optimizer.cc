@@ -29,6 +29,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
+#include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/static_shape_annotator.h"
 #include "tensorflow/core/grappler/utils/colocation.h"
 #include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
@@ -82,6 +84,9 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
   MK_OPT("loop", new LoopOptimizer(cfg_.loop_optimization()));
   MK_OPT("dependency", new DependencyOptimizer(cfg_.dependency_optimization()));
   MK_OPT("debug_stripper", new DebugStripper());
+  MK_OPT("static_shape_annotator", new StaticShapeAnnotator());
+  MK_OPT("scoped_allocator",
+         new ScopedAllocatorOptimizer(cfg_.scoped_allocator_opts()));
 
   return std::unique_ptr<GraphOptimizer>();
 #undef MK_OPT
@@ -121,17 +126,27 @@ Status MetaOptimizer::InitializeOptimizers(
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
       optimizers->emplace_back(
           // Use the default target node name prefix "gradients/"
-          new MemoryOptimizer(cfg_.memory_optimization()));
+          new MemoryOptimizer(cfg_.memory_optimization(), "gradients/",
+                              cfg_.memory_optimizer_memory_budget()));
     } else {
       optimizers->emplace_back(
           new MemoryOptimizer(cfg_.memory_optimization(),
-                              cfg_.memory_optimizer_target_node_name_scope()));
+                              cfg_.memory_optimizer_target_node_name_scope(),
+                              cfg_.memory_optimizer_memory_budget()));
     }
   }
   if (cfg_.auto_parallel().enable()) {
     optimizers->emplace_back(
         new AutoParallel(cfg_.auto_parallel().num_replicas()));
   }
+  if (cfg_.scoped_allocator_optimization() == RewriterConfig::ON) {
+    optimizers->emplace_back(
+        new ScopedAllocatorOptimizer(cfg_.scoped_allocator_opts()));
+  }
+  // Runs last so that the annotated shapes reflect all the other rewrites.
+  if (cfg_.static_shape_annotation() == RewriterConfig::ON) {
+    optimizers->emplace_back(new StaticShapeAnnotator());
+  }
   return Status::OK();
 }
 
@@ -325,6 +340,8 @@ bool MetaOptimizerEnabled(const RewriterConfig& cfg) {
          cfg.auto_parallel().enable() ||
          cfg.memory_optimization() != RewriterConfig::NO_MEM_OPT ||
          cfg.debug_stripper() == RewriterConfig::ON ||
+         cfg.static_shape_annotation() == RewriterConfig::ON ||
+         cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
          !cfg.optimizers().empty();
 }
 
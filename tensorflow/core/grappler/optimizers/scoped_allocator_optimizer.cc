@@ -0,0 +1,518 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr int64 kDefaultBucketSizeBytes = 4 << 20;
+
+// A CollectiveReduce node whose input may be allocated from a
+// ScopedAllocator region.
+struct Candidate {
+  string collective;
+  // The node and output port that produce the input of the collective.
+  string producer;
+  int port;
+  TensorShape shape;
+  int64 instance_key;
+  int64 bytes;
+};
+
+// The CollectiveReduce nodes of the graph that share an instance_key, one
+// per device. They run as one all-reduce, so they are merged into the same
+// bucket on every device or not at all.
+struct Instance {
+  int64 instance_key;
+  int64 bytes;
+  // In device order.
+  std::vector<Candidate> members;
+};
+
+// Returns true if the output tensors of node are freshly allocated by its
+// kernel, i.e. the kernel never hands out a buffer it did not allocate
+// itself. Only such outputs can be placed in a ScopedAllocator region. The
+// check is conservative: an op that can forward an input buffer is fine, as
+// the executor prevents forwarding for outputs in the region, but ops that
+// pass an input tensor through unchanged are not.
+bool AllocatesItsOutputs(const NodeDef& node) {
+  if (IsConstant(node) || IsVariable(node) || IsPlaceholder(node) ||
+      IsIdentity(node) || IsIdentityN(node) || IsStopGradient(node) ||
+      IsReshape(node) || IsSqueeze(node) || IsBitcast(node) ||
+      IsCheckNumerics(node) || IsRecv(node) || IsSwitch(node) ||
+      IsMerge(node) || IsEnter(node) || IsExit(node) ||
+      IsNextIteration(node) || IsDequeueOp(node)) {
+    return false;
+  }
+  static const std::unordered_set<string>* const kPassThroughOps =
+      new std::unordered_set<string>({"_Arg",
+                                      "_ScopedAllocatorConcat",
+                                      "_ScopedAllocatorSplit",
+                                      "CollectiveBcastRecv",
+                                      "CollectiveReduce",
+                                      "ExpandDims",
+                                      "PreventGradient",
+                                      "Snapshot"});
+  return kPassThroughOps->count(node.op()) == 0;
+}
+
+// Returns the key shared by the collectives that can be reduced together on
+// a device.
+string GroupingKey(const NodeDef& collective) {
+  string key;
+  for (const char* attr :
+       {"T", "group_size", "group_key", "merge_op", "final_op",
+        "subdiv_offsets"}) {
+    auto it = collective.attr().find(attr);
+    strings::StrAppend(&key, "|", attr, "=",
+                       it == collective.attr().end()
+                           ? ""
+                           : it->second.SerializeAsString());
+  }
+  return key;
+}
+
+// For each candidate, computes the set of candidate collectives that its
+// producer depends on, directly or not. The sets are bitmaps indexed by
+// position in candidates.
+Status ComputeProducerAncestors(const GraphDef& graph,
+                                const std::vector<Candidate>& candidates,
+                                std::vector<std::vector<uint64>>* ancestors) {
+  std::unordered_map<const NodeDef*, int> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(graph, &topo_order));
+  std::vector<const NodeDef*> ordered(graph.node_size());
+  std::unordered_map<string, int> position;
+  for (const auto& entry : topo_order) {
+    ordered[entry.second] = entry.first;
+    position[entry.first->name()] = entry.second;
+  }
+  std::unordered_map<string, int> collective_index;
+  for (int i = 0; i < candidates.size(); ++i) {
+    collective_index[candidates[i].collective] = i;
+  }
+
+  const int num_words = (candidates.size() + 63) / 64;
+  std::vector<std::vector<uint64>> node_bits(ordered.size());
+  for (int i = 0; i < ordered.size(); ++i) {
+    std::vector<uint64>& bits = node_bits[i];
+    bits.assign(num_words, 0);
+    for (const string& input : ordered[i]->input()) {
+      const string input_node = NodeName(input);
+      auto pos = position.find(input_node);
+      // Skips the back edges of loops, which come later in the order.
+      if (pos == position.end() || pos->second >= i) continue;
+      const std::vector<uint64>& input_bits = node_bits[pos->second];
+      for (int w = 0; w < num_words; ++w) {
+        bits[w] |= input_bits[w];
+      }
+      auto index = collective_index.find(input_node);
+      if (index != collective_index.end()) {
+        bits[index->second / 64] |= uint64{1} << (index->second % 64);
+      }
+    }
+  }
+
+  ancestors->clear();
+  for (const Candidate& candidate : candidates) {
+    auto pos = position.find(candidate.producer);
+    if (pos == position.end()) {
+      return errors::Internal("Producer ", candidate.producer, " not found");
+    }
+    ancestors->push_back(node_bits[pos->second]);
+  }
+  return Status::OK();
+}
+
+bool HasBit(const std::vector<uint64>& bits, int index) {
+  return (bits[index / 64] >> (index % 64)) & 1;
+}
+
+bool Intersects(const std::vector<uint64>& a, const std::vector<uint64>& b) {
+  for (int w = 0; w < a.size(); ++w) {
+    if (a[w] & b[w]) return true;
+  }
+  return false;
+}
+
+// Replaces the collectives of bucket with a single one that reduces a
+// ScopedAllocator region holding all of their inputs.
+Status RewriteBucket(const std::vector<Candidate>& bucket, DataType dtype,
+                     int32 scope_id, GraphDef* graph) {
+  NodeMap node_map(graph);
+  const NodeDef* first = node_map.GetNode(bucket[0].collective);
+  const string& device = first->device();
+  const string sa_name = strings::StrCat("scoped_allocator_", scope_id);
+  const int num_fields = bucket.size();
+
+  std::vector<TensorShape> shapes;
+  for (const Candidate& candidate : bucket) {
+    shapes.push_back(candidate.shape);
+  }
+  // The backing tensor is laid out by the _ScopedAllocator kernel the same
+  // way, with each field aligned.
+  std::vector<ScopedAllocator::Field> fields;
+  ScopedAllocatorMgr::PopulateFields(scope_id, shapes, dtype, &fields);
+  const int64 num_elements =
+      (fields.back().offset + fields.back().bytes) / DataTypeSize(dtype);
+
+  NodeDef* alloc = graph->add_node();
+  alloc->set_name(strings::StrCat(sa_name, "/_ScopedAllocator"));
+  alloc->set_op("_ScopedAllocator");
+  alloc->set_device(device);
+  AttrValue shapes_attr;
+  for (const TensorShape& shape : shapes) {
+    shape.AsProto(shapes_attr.mutable_list()->add_shape());
+  }
+  (*alloc->mutable_attr())["shapes"] = shapes_attr;
+  (*alloc->mutable_attr())["T"].set_type(dtype);
+  (*alloc->mutable_attr())["sa_name"].set_s(sa_name);
+  (*alloc->mutable_attr())["id"].set_i(scope_id);
+  (*alloc->mutable_attr())["expected_call_count"].set_i(num_fields);
+
+  NodeDef* concat = graph->add_node();
+  concat->set_name(strings::StrCat(sa_name, "/_ScopedAllocatorConcat"));
+  concat->set_op("_ScopedAllocatorConcat");
+  concat->set_device(device);
+  concat->add_input(alloc->name());
+  TensorShape({num_elements})
+      .AsProto((*concat->mutable_attr())["shape"].mutable_shape());
+  (*concat->mutable_attr())["T"].set_type(dtype);
+  (*concat->mutable_attr())["sa_name"].set_s(sa_name);
+  (*concat->mutable_attr())["id"].set_i(scope_id);
+  (*concat->mutable_attr())["N"].set_i(num_fields);
+
+  // The merged collective takes the attributes of the first one, which has
+  // the smallest instance key, and reduces the region in place.
+  NodeDef* reduce = graph->add_node();
+  *reduce = *first;
+  reduce->set_name(strings::StrCat(sa_name, "/CollectiveReduce"));
+  reduce->clear_input();
+  reduce->add_input(concat->name());
+  AttrValue forward_attr;
+  forward_attr.mutable_list()->add_i(0);
+  forward_attr.mutable_list()->add_i(0);
+  (*reduce->mutable_attr())[kForwardInputAttr] = forward_attr;
+
+  NodeDef* split = graph->add_node();
+  split->set_name(strings::StrCat(sa_name, "/_ScopedAllocatorSplit"));
+  split->set_op("_ScopedAllocatorSplit");
+  split->set_device(device);
+  split->add_input(reduce->name());
+  (*split->mutable_attr())["T"].set_type(dtype);
+  (*split->mutable_attr())["sa_name"].set_s(sa_name);
+  (*split->mutable_attr())["id"].set_i(scope_id);
+  (*split->mutable_attr())["N"].set_i(num_fields);
+
+  std::unordered_set<string> members;
+  for (int i = 0; i < num_fields; ++i) {
+    const Candidate& candidate = bucket[i];
+    members.insert(candidate.collective);
+
+    // Allocate the input of the collective as field i of the region.
+    NodeDef* producer = node_map.GetNode(candidate.producer);
+    producer->add_input(AsControlDependency(alloc->name()));
+    AttrValue* sa_attr = &(*producer->mutable_attr())[kScopedAllocatorAttr];
+    sa_attr->mutable_list()->add_i(candidate.port);
+    sa_attr->mutable_list()->add_i(fields[i].scope_id);
+    const string field = strings::StrCat(candidate.producer, ":",
+                                         candidate.port);
+    concat->add_input(field);
+    split->add_input(field);
+
+    const NodeDef* collective = node_map.GetNode(candidate.collective);
+    for (const string& input : collective->input()) {
+      if (IsControlInput(input)) {
+        reduce->add_input(input);
+      }
+    }
+  }
+  DedupControlInputs(reduce);
+
+  // Hand the fields, which now hold the reduced values, to the consumers of
+  // the original collectives.
+  for (int i = 0; i < num_fields; ++i) {
+    const string& name = bucket[i].collective;
+    const string output = strings::StrCat(split->name(), ":", i);
+    const std::set<NodeDef*> consumers = node_map.GetOutputs(name);
+    for (NodeDef* consumer : consumers) {
+      for (int j = 0; j < consumer->input_size(); ++j) {
+        const string& input = consumer->input(j);
+        if (NodeName(input) != name) continue;
+        if (IsControlInput(input)) {
+          *consumer->mutable_input(j) = AsControlDependency(split->name());
+        } else {
+          *consumer->mutable_input(j) = output;
+        }
+      }
+      DedupControlInputs(consumer);
+    }
+  }
+
+  // Delete the original collectives, keeping the order of the other nodes.
+  auto* nodes = graph->mutable_node();
+  int num_kept = 0;
+  for (int i = 0; i < nodes->size(); ++i) {
+    if (members.count(nodes->Get(i).name()) > 0) continue;
+    if (i != num_kept) {
+      nodes->SwapElements(i, num_kept);
+    }
+    ++num_kept;
+  }
+  nodes->DeleteSubrange(num_kept, nodes->size() - num_kept);
+  return Status::OK();
+}
+
+}  // namespace
+
+Status ScopedAllocatorOptimizer::Optimize(Cluster* cluster,
+                                          const GrapplerItem& item,
+                                          GraphDef* output) {
+  *output = item.graph;
+  bool has_collectives = false;
+  for (const NodeDef& node : output->node()) {
+    if (node.op() == "CollectiveReduce") {
+      has_collectives = true;
+      break;
+    }
+  }
+  if (!has_collectives) {
+    return Status::OK();
+  }
+
+  const int64 bucket_size = opts_.bucket_size_bytes() > 0
+                                ? opts_.bucket_size_bytes()
+                                : kDefaultBucketSizeBytes;
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(false));
+  NodeMap node_map(output);
+  FrameMap frame_map;
+  int num_frames;
+  TF_RETURN_IF_ERROR(
+      IdentifyFramesWithNodeMap(*output, node_map, &frame_map, &num_frames));
+
+  // Scope ids must be unique per device and step, so start past the ones
+  // already in the graph.
+  int32 next_scope_id = 1;
+  for (const NodeDef& node : output->node()) {
+    if (node.op() == "_ScopedAllocator") {
+      next_scope_id = std::max<int32>(
+          next_scope_id, node.attr().at("id").i() +
+                             node.attr().at("expected_call_count").i() + 1);
+    }
+  }
+
+  // Returns true if the input of the CollectiveReduce node may be allocated
+  // from a ScopedAllocator region, and fills candidate.
+  std::unordered_set<string> claimed_producers;
+  auto make_candidate = [&](const NodeDef& node, Candidate* candidate) {
+    if (nodes_to_preserve.count(node.name()) > 0 ||
+        NumNonControlInputs(node) != 1 || !frame_map[&node].empty() ||
+        !properties.HasInputProperties(node.name())) {
+      return false;
+    }
+    const auto& input_props = properties.GetInputProperties(node.name());
+    if (input_props.size() != 1 ||
+        !PartialTensorShape(input_props[0].shape()).IsFullyDefined()) {
+      return false;
+    }
+    candidate->collective = node.name();
+    candidate->producer = ParseNodeName(node.input(0), &candidate->port);
+    candidate->shape = TensorShape(input_props[0].shape());
+    candidate->instance_key = node.attr().at("instance_key").i();
+    candidate->bytes = candidate->shape.num_elements() *
+                       DataTypeSize(node.attr().at("T").type());
+    if (candidate->bytes <= 0 || candidate->bytes > bucket_size) {
+      return false;
+    }
+    const NodeDef* producer = node_map.GetNode(candidate->producer);
+    if (producer == nullptr || candidate->port < 0 ||
+        producer->device() != node.device() ||
+        nodes_to_preserve.count(producer->name()) > 0 ||
+        !frame_map[producer].empty() || !AllocatesItsOutputs(*producer) ||
+        producer->attr().count(kScopedAllocatorAttr) > 0 ||
+        claimed_producers.count(producer->name()) > 0) {
+      return false;
+    }
+    // The collective must be the only consumer of the field, since it
+    // overwrites it with the reduced value.
+    int num_uses = 0;
+    for (const NodeDef* consumer : node_map.GetOutputs(producer->name())) {
+      for (const string& input : consumer->input()) {
+        int port;
+        if (ParseNodeName(input, &port) == producer->name() &&
+            port == candidate->port) {
+          ++num_uses;
+        }
+      }
+    }
+    return num_uses == 1;
+  };
+
+  std::map<int64, std::vector<const NodeDef*>> collectives;
+  for (const NodeDef& node : output->node()) {
+    if (node.op() == "CollectiveReduce") {
+      collectives[node.attr().at("instance_key").i()].push_back(&node);
+    }
+  }
+
+  // Visit the instances in instance key order, so that every device makes
+  // the same choices. An instance is only merged if all its members can be,
+  // otherwise the devices would disagree on the buckets and the merged
+  // collectives would not match.
+  std::map<string, std::vector<Instance>> groups;
+  std::map<string, DataType> group_types;
+  for (auto& entry : collectives) {
+    std::vector<const NodeDef*>& nodes = entry.second;
+    std::sort(nodes.begin(), nodes.end(),
+              [](const NodeDef* a, const NodeDef* b) {
+                return a->device() < b->device();
+              });
+    Instance instance;
+    instance.instance_key = entry.first;
+    string key = GroupingKey(*nodes[0]);
+    bool eligible = true;
+    for (int i = 0; i < nodes.size() && eligible; ++i) {
+      Candidate candidate;
+      eligible = make_candidate(*nodes[i], &candidate) &&
+                 (i == 0 || (nodes[i]->device() != nodes[i - 1]->device() &&
+                             GroupingKey(*nodes[i]) == GroupingKey(*nodes[0]) &&
+                             candidate.bytes == instance.bytes));
+      instance.bytes = candidate.bytes;
+      instance.members.push_back(candidate);
+      strings::StrAppend(&key, "|", nodes[i]->device());
+    }
+    if (!eligible) {
+      continue;
+    }
+    for (const Candidate& member : instance.members) {
+      claimed_producers.insert(member.producer);
+    }
+    groups[key].push_back(instance);
+    group_types[key] = nodes[0]->attr().at("T").type();
+  }
+
+  int num_buckets = 0;
+  for (auto& group : groups) {
+    std::vector<Instance>& remaining = group.second;
+    while (remaining.size() >= 2) {
+      // Reachability changes with each rewrite, so recompute it before
+      // forming each bucket. It covers the members on all devices: the
+      // merged collectives of a bucket run as one all-reduce, so none of
+      // their inputs may depend on another one of them, on any device.
+      std::vector<Candidate> candidates;
+      std::vector<int> first_candidate;
+      for (const Instance& instance : remaining) {
+        first_candidate.push_back(candidates.size());
+        candidates.insert(candidates.end(), instance.members.begin(),
+                          instance.members.end());
+      }
+      std::vector<std::vector<uint64>> ancestors;
+      TF_RETURN_IF_ERROR(
+          ComputeProducerAncestors(*output, candidates, &ancestors));
+
+      // Fill the bucket greedily in instance key order. An instance whose
+      // producers depend on a collective of the bucket, or the reverse,
+      // would create a cycle and is left for a later bucket.
+      std::vector<uint64> bucket_bits(ancestors[0].size(), 0);
+      std::vector<uint64> bucket_ancestors(ancestors[0].size(), 0);
+      auto conflicts = [&](int i) {
+        for (int j = 0; j < remaining[i].members.size(); ++j) {
+          const int c = first_candidate[i] + j;
+          if (Intersects(ancestors[c], bucket_bits) ||
+              HasBit(bucket_ancestors, c)) {
+            return true;
+          }
+        }
+        return false;
+      };
+      auto add = [&](int i) {
+        for (int j = 0; j < remaining[i].members.size(); ++j) {
+          const int c = first_candidate[i] + j;
+          bucket_bits[c / 64] |= uint64{1} << (c % 64);
+          for (int w = 0; w < bucket_ancestors.size(); ++w) {
+            bucket_ancestors[w] |= ancestors[c][w];
+          }
+        }
+      };
+      std::vector<int> bucket = {0};
+      add(0);
+      int64 bucket_bytes = remaining[0].bytes;
+      for (int i = 1; i < remaining.size(); ++i) {
+        if (bucket_bytes + remaining[i].bytes > bucket_size) break;
+        if (conflicts(i)) continue;
+        bucket.push_back(i);
+        add(i);
+        bucket_bytes += remaining[i].bytes;
+      }
+
+      std::vector<Instance> instances;
+      for (int i : bucket) {
+        instances.push_back(remaining[i]);
+      }
+      for (auto it = bucket.rbegin(); it != bucket.rend(); ++it) {
+        remaining.erase(remaining.begin() + *it);
+      }
+      if (instances.size() < 2) {
+        continue;
+      }
+      // All the instances of a group have one member per device, in the
+      // same device order.
+      for (int d = 0; d < instances[0].members.size(); ++d) {
+        std::vector<Candidate> members;
+        for (const Instance& instance : instances) {
+          members.push_back(instance.members[d]);
+        }
+        TF_RETURN_IF_ERROR(RewriteBucket(members, group_types[group.first],
+                                         next_scope_id, output));
+        next_scope_id += members.size() + 1;
+      }
+      ++num_buckets;
+    }
+  }
+  VLOG(1) << "Merged CollectiveReduce ops into " << num_buckets
+          << " ScopedAllocator buckets";
+  return Status::OK();
+}
+
+void ScopedAllocatorOptimizer::Feedback(Cluster* cluster,
+                                        const GrapplerItem& item,
+                                        const GraphDef& optimize_output,
+                                        double result) {
+  // Takes no feedback.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
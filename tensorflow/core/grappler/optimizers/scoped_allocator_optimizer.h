@@ -0,0 +1,63 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_SCOPED_ALLOCATOR_OPTIMIZER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_SCOPED_ALLOCATOR_OPTIMIZER_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Names of the node attributes read by the executor: "_scoped_allocator"
+// holds (output_index, scope_id) pairs for the outputs to allocate from a
+// ScopedAllocator, and "_forward_input" holds (input_index, output_index)
+// pairs for the outputs that must reuse the buffer of an input.
+constexpr char kScopedAllocatorAttr[] = "_scoped_allocator";
+constexpr char kForwardInputAttr[] = "_forward_input";
+
+// ScopedAllocatorOptimizer merges the CollectiveReduce ops of a step that
+// could share a single all-reduce: same device, data type, group and
+// reduction ops. Their inputs are allocated back to back from one
+// ScopedAllocator region, a single CollectiveReduce reduces the whole region
+// in place, and a _ScopedAllocatorSplit hands the reduced fields to the
+// consumers of the original ops. The ops are bucketed in instance_key order,
+// and the ops sharing an instance_key on different devices are bucketed
+// together or left alone together, so that every member of the group makes
+// the same choices.
+class ScopedAllocatorOptimizer : public GraphOptimizer {
+ public:
+  ScopedAllocatorOptimizer() {}
+  explicit ScopedAllocatorOptimizer(const ScopedAllocatorOptions& opts)
+      : opts_(opts) {}
+  ~ScopedAllocatorOptimizer() override {}
+
+  string name() const override { return "scoped_allocator_optimizer"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+
+ private:
+  ScopedAllocatorOptions opts_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_SCOPED_ALLOCATOR_OPTIMIZER_H_
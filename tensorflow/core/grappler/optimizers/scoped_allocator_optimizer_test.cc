@@ -0,0 +1,292 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class ScopedAllocatorOptimizerTest : public GrapplerTest {
+ protected:
+  // Adds a CollectiveReduce of input to graph.
+  void AddCollective(const string& name, const string& input, int group_key,
+                     int instance_key, GraphDef* graph) {
+    AttrValue type, group_size, group, instance, merge_op, final_op, offsets;
+    SetAttrValue(DT_FLOAT, &type);
+    SetAttrValue(2, &group_size);
+    SetAttrValue(group_key, &group);
+    SetAttrValue(instance_key, &instance);
+    SetAttrValue("Add", &merge_op);
+    SetAttrValue("Div", &final_op);
+    SetAttrValue(gtl::ArraySlice<int>({0}), &offsets);
+    AddNode(name, "CollectiveReduce", {input},
+            {{"T", type},
+             {"group_size", group_size},
+             {"group_key", group},
+             {"instance_key", instance},
+             {"merge_op", merge_op},
+             {"final_op", final_op},
+             {"subdiv_offsets", offsets}},
+            graph);
+  }
+
+  const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return &node;
+    }
+    return nullptr;
+  }
+};
+
+TEST_F(ScopedAllocatorOptimizerTest, MergeCollectivesInInstanceKeyOrder) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Placeholder(s.WithOpName("a"), DT_FLOAT,
+                              ops::Placeholder::Shape({2, 3}));
+  Output b = ops::Placeholder(s.WithOpName("b"), DT_FLOAT,
+                              ops::Placeholder::Shape({4}));
+  Output c = ops::Placeholder(s.WithOpName("c"), DT_FLOAT,
+                              ops::Placeholder::Shape({5}));
+  Output grad_a = ops::Neg(s.WithOpName("grad_a"), a);
+  Output grad_b = ops::Neg(s.WithOpName("grad_b"), b);
+  Output grad_c = ops::Neg(s.WithOpName("grad_c"), c);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  AddCollective("reduce_a", "grad_a", 1, 3, &item.graph);
+  AddCollective("reduce_b", "grad_b", 1, 1, &item.graph);
+  AddCollective("reduce_c", "grad_c", 1, 2, &item.graph);
+  AddNode("out_a", "Identity", {"reduce_a"}, {}, &item.graph);
+  AddNode("out_b", "Identity", {"reduce_b"}, {}, &item.graph);
+  AddNode("out_c", "Identity", {"reduce_c", "^reduce_a"}, {}, &item.graph);
+  item.fetch = {"out_a", "out_b", "out_c"};
+
+  ScopedAllocatorOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(1, CountOpNodes(output, "CollectiveReduce"));
+  EXPECT_EQ(1, CountOpNodes(output, "_ScopedAllocator"));
+  EXPECT_EQ(1, CountOpNodes(output, "_ScopedAllocatorConcat"));
+  EXPECT_EQ(1, CountOpNodes(output, "_ScopedAllocatorSplit"));
+  EXPECT_EQ(nullptr, FindNode(output, "reduce_a"));
+
+  const NodeDef* alloc =
+      FindNode(output, "scoped_allocator_1/_ScopedAllocator");
+  ASSERT_NE(nullptr, alloc);
+  EXPECT_EQ(3, alloc->attr().at("expected_call_count").i());
+  const auto& shapes = alloc->attr().at("shapes").list();
+  ASSERT_EQ(3, shapes.shape_size());
+  EXPECT_EQ("[4]", PartialTensorShape(shapes.shape(0)).DebugString());
+  EXPECT_EQ("[5]", PartialTensorShape(shapes.shape(1)).DebugString());
+  EXPECT_EQ("[2,3]", PartialTensorShape(shapes.shape(2)).DebugString());
+
+  // Fields are numbered after the id of the region, in instance key order.
+  const std::vector<std::pair<string, int>> fields = {
+      {"grad_b", 2}, {"grad_c", 3}, {"grad_a", 4}};
+  for (const auto& field : fields) {
+    const NodeDef* producer = FindNode(output, field.first);
+    ASSERT_NE(nullptr, producer);
+    const auto& attr = producer->attr().at(kScopedAllocatorAttr).list();
+    ASSERT_EQ(2, attr.i_size());
+    EXPECT_EQ(0, attr.i(0));
+    EXPECT_EQ(field.second, attr.i(1));
+    EXPECT_EQ("^scoped_allocator_1/_ScopedAllocator",
+              producer->input(producer->input_size() - 1));
+  }
+
+  const NodeDef* reduce =
+      FindNode(output, "scoped_allocator_1/CollectiveReduce");
+  ASSERT_NE(nullptr, reduce);
+  EXPECT_EQ(1, reduce->attr().at("instance_key").i());
+  ASSERT_EQ(1, reduce->input_size());
+  EXPECT_EQ("scoped_allocator_1/_ScopedAllocatorConcat", reduce->input(0));
+  const auto& forward = reduce->attr().at(kForwardInputAttr).list();
+  ASSERT_EQ(2, forward.i_size());
+  EXPECT_EQ(0, forward.i(0));
+  EXPECT_EQ(0, forward.i(1));
+
+  const NodeDef* split =
+      FindNode(output, "scoped_allocator_1/_ScopedAllocatorSplit");
+  ASSERT_NE(nullptr, split);
+  ASSERT_EQ(4, split->input_size());
+  EXPECT_EQ("scoped_allocator_1/CollectiveReduce", split->input(0));
+  EXPECT_EQ("grad_b:0", split->input(1));
+  EXPECT_EQ("grad_c:0", split->input(2));
+  EXPECT_EQ("grad_a:0", split->input(3));
+
+  EXPECT_EQ("scoped_allocator_1/_ScopedAllocatorSplit:2",
+            FindNode(output, "out_a")->input(0));
+  EXPECT_EQ("scoped_allocator_1/_ScopedAllocatorSplit:0",
+            FindNode(output, "out_b")->input(0));
+  const NodeDef* out_c = FindNode(output, "out_c");
+  ASSERT_EQ(2, out_c->input_size());
+  EXPECT_EQ("scoped_allocator_1/_ScopedAllocatorSplit:1", out_c->input(0));
+  EXPECT_EQ("^scoped_allocator_1/_ScopedAllocatorSplit", out_c->input(1));
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, SplitBuckets) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  GrapplerItem item;
+  for (int i = 0; i < 5; ++i) {
+    const string index = strings::StrCat(i);
+    ops::Neg(s.WithOpName("grad_" + index),
+             ops::Placeholder(s.WithOpName("x_" + index), DT_FLOAT,
+                              ops::Placeholder::Shape({6})));
+  }
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < 5; ++i) {
+    const string index = strings::StrCat(i);
+    AddCollective("reduce_" + index, "grad_" + index, 1, i, &item.graph);
+    AddNode("out_" + index, "Identity", {"reduce_" + index}, {}, &item.graph);
+    item.fetch.push_back("out_" + index);
+  }
+
+  // Each input takes 24 bytes, so a bucket holds two of them and the last
+  // one is left alone.
+  ScopedAllocatorOptions opts;
+  opts.set_bucket_size_bytes(48);
+  ScopedAllocatorOptimizer optimizer(opts);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(2, CountOpNodes(output, "_ScopedAllocator"));
+  EXPECT_EQ(3, CountOpNodes(output, "CollectiveReduce"));
+  EXPECT_NE(nullptr, FindNode(output, "reduce_4"));
+  // The second region takes ids past the fields of the first one.
+  EXPECT_NE(nullptr, FindNode(output, "scoped_allocator_1/_ScopedAllocator"));
+  EXPECT_NE(nullptr, FindNode(output, "scoped_allocator_4/_ScopedAllocator"));
+  EXPECT_EQ("scoped_allocator_4/_ScopedAllocatorSplit:1",
+            FindNode(output, "out_3")->input(0));
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, SkipIneligibleCollectives) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Placeholder(s.WithOpName("a"), DT_FLOAT,
+                              ops::Placeholder::Shape({4}));
+  Output b = ops::Placeholder(s.WithOpName("b"), DT_FLOAT,
+                              ops::Placeholder::Shape({4}));
+  Output unknown = ops::Placeholder(s.WithOpName("unknown"), DT_FLOAT,
+                                    ops::Placeholder::Shape({-1}));
+  Output grad_a = ops::Neg(s.WithOpName("grad_a"), a);
+  Output grad_b = ops::Neg(s.WithOpName("grad_b"), b);
+  Output grad_shared = ops::Neg(s.WithOpName("grad_shared"), b);
+  Output grad_unknown = ops::Neg(s.WithOpName("grad_unknown"), unknown);
+  Output other_use = ops::Square(s.WithOpName("other_use"), grad_shared);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  AddCollective("reduce_a", "grad_a", 1, 1, &item.graph);
+  // The input of grad_dep depends on reduce_a.
+  AddNode("grad_dep", "Neg", {"reduce_a"}, {}, &item.graph);
+  AddCollective("reduce_dep", "grad_dep", 1, 2, &item.graph);
+  // Different group.
+  AddCollective("reduce_b", "grad_b", 2, 3, &item.graph);
+  // The input has another consumer.
+  AddCollective("reduce_shared", "grad_shared", 1, 4, &item.graph);
+  // The input shape is not known.
+  AddCollective("reduce_unknown", "grad_unknown", 1, 5, &item.graph);
+  // The input is not allocated by its producer.
+  AddCollective("reduce_placeholder", "a", 1, 6, &item.graph);
+  item.fetch = {"other_use"};
+  for (const string& name : {"reduce_dep", "reduce_b", "reduce_shared",
+                             "reduce_unknown", "reduce_placeholder"}) {
+    AddNode(strings::StrCat("out_", name), "Identity", {name}, {}, &item.graph);
+    item.fetch.push_back(strings::StrCat("out_", name));
+  }
+
+  ScopedAllocatorOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(0, CountOpNodes(output, "_ScopedAllocator"));
+  EXPECT_EQ(6, CountOpNodes(output, "CollectiveReduce"));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_EQ(0, node.attr().count(kScopedAllocatorAttr)) << node.name();
+  }
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, SameBucketsOnAllDevices) {
+  const std::vector<string> devices = {"/job:w/replica:0/task:0/cpu:0",
+                                       "/job:w/replica:0/task:1/cpu:0"};
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  for (int d = 0; d < 2; ++d) {
+    for (int i = 0; i < 4; ++i) {
+      const string index = strings::StrCat(d, "_", i);
+      Output x = ops::Placeholder(
+          s.WithOpName("x_" + index).WithDevice(devices[d]), DT_FLOAT,
+          ops::Placeholder::Shape({4}));
+      ops::Neg(s.WithOpName("grad_" + index).WithDevice(devices[d]), x);
+    }
+  }
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  for (int d = 0; d < 2; ++d) {
+    for (int i = 0; i < 4; ++i) {
+      const string index = strings::StrCat(d, "_", i);
+      string input = "grad_" + index;
+      if (d == 1 && i == 1) {
+        // The input of this member is not allocated by its producer.
+        input = "x_" + index;
+      } else if (d == 1 && i == 3) {
+        // The input of this member depends on instance 0 on the other
+        // device.
+        AddNode("dep", "Neg", {"reduce_0_0"}, {}, &item.graph);
+        item.graph.mutable_node(item.graph.node_size() - 1)
+            ->set_device(devices[d]);
+        input = "dep";
+      }
+      AddCollective("reduce_" + index, input, 1, i, &item.graph);
+      item.graph.mutable_node(item.graph.node_size() - 1)
+          ->set_device(devices[d]);
+      AddNode("out_" + index, "Identity", {"reduce_" + index}, {},
+              &item.graph);
+      item.fetch.push_back("out_" + index);
+    }
+  }
+
+  ScopedAllocatorOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // Instance 1 is left alone on both devices, and instance 3 can't join
+  // instance 0, so each device merges instances 0 and 2 only.
+  EXPECT_EQ(2, CountOpNodes(output, "_ScopedAllocator"));
+  EXPECT_EQ(6, CountOpNodes(output, "CollectiveReduce"));
+  for (int d = 0; d < 2; ++d) {
+    for (int i = 0; i < 4; ++i) {
+      const string name = strings::StrCat("reduce_", d, "_", i);
+      const bool merged = i == 0 || i == 2;
+      EXPECT_EQ(merged, FindNode(output, name) == nullptr) << name;
+    }
+  }
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "_ScopedAllocator") {
+      EXPECT_EQ(2, node.attr().at("expected_call_count").i()) << node.name();
+    }
+  }
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
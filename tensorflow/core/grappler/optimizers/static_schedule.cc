@@ -27,9 +27,10 @@ limitations under the License.
 namespace tensorflow {
 namespace grappler {
 
-static Costs::NanoSeconds PredictExecutionTime(
-    const GraphProperties& properties, const OpLevelCostEstimator& estimator,
-    const VirtualPlacer& placer, const NodeDef& node) {
+Costs::NanoSeconds PredictExecutionTime(const GraphProperties& properties,
+                                        const OpLevelCostEstimator& estimator,
+                                        const VirtualPlacer& placer,
+                                        const NodeDef& node) {
   OpContext op_context;
   op_context.op_info.set_op(node.op());
   *op_context.op_info.mutable_attr() = node.attr();
@@ -21,11 +21,21 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/virtual_placer.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 
 namespace tensorflow {
 namespace grappler {
 
+// Estimate the time it takes to execute the specified node once. The estimate
+// is at least one nanosecond.
+Costs::NanoSeconds PredictExecutionTime(const GraphProperties& properties,
+                                        const OpLevelCostEstimator& estimator,
+                                        const VirtualPlacer& placer,
+                                        const NodeDef& node);
+
 // Compute the earliest time at which the execution of each node in the graph
 // can complete.
 // In our estimation, we ensure that each node takes at least one nanosecond to
@@ -0,0 +1,120 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/static_shape_annotator.h"
+
+#include <unordered_set>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Ops implemented with BinaryOp (kernels/cwise_ops_common.h), which computes
+// the broadcast of its inputs once if the node carries kStaticInputShapesAttr.
+bool IsBroadcastingBinaryOp(const NodeDef& node) {
+  static const std::unordered_set<string>* const kOps =
+      new std::unordered_set<string>({"Add",
+                                      "AddV2",
+                                      "Atan2",
+                                      "BitwiseAnd",
+                                      "BitwiseOr",
+                                      "BitwiseXor",
+                                      "Complex",
+                                      "Div",
+                                      "Equal",
+                                      "FloorDiv",
+                                      "FloorMod",
+                                      "Greater",
+                                      "GreaterEqual",
+                                      "Igamma",
+                                      "Igammac",
+                                      "LeftShift",
+                                      "Less",
+                                      "LessEqual",
+                                      "LogicalAnd",
+                                      "LogicalOr",
+                                      "Maximum",
+                                      "Minimum",
+                                      "Mod",
+                                      "Mul",
+                                      "NotEqual",
+                                      "Polygamma",
+                                      "Pow",
+                                      "RealDiv",
+                                      "RightShift",
+                                      "SquaredDifference",
+                                      "Sub",
+                                      "TruncateDiv",
+                                      "TruncateMod",
+                                      "Zeta"});
+  return kOps->count(node.op()) > 0;
+}
+
+}  // namespace
+
+Status StaticShapeAnnotator::Optimize(Cluster* cluster,
+                                      const GrapplerItem& item,
+                                      GraphDef* output) {
+  *output = item.graph;
+  GraphProperties properties(item);
+  // The kernels verify the annotated shapes, so it is safe to assume that the
+  // feeds match the shapes of their placeholders.
+  TF_RETURN_IF_ERROR(properties.InferStatically(/*assume_valid_feeds=*/true));
+
+  int num_annotated = 0;
+  for (NodeDef& node : *output->mutable_node()) {
+    // Drop the annotations from a previous run, they may be stale.
+    node.mutable_attr()->erase(kStaticInputShapesAttr);
+    if (!IsBroadcastingBinaryOp(node) ||
+        !properties.HasInputProperties(node.name())) {
+      continue;
+    }
+    const auto& inputs = properties.GetInputProperties(node.name());
+    if (inputs.size() != 2) {
+      continue;
+    }
+    AttrValue shapes;
+    bool fully_defined = true;
+    for (const auto& input : inputs) {
+      if (!PartialTensorShape(input.shape()).IsFullyDefined()) {
+        fully_defined = false;
+        break;
+      }
+      *shapes.mutable_list()->add_shape() = input.shape();
+    }
+    if (fully_defined) {
+      (*node.mutable_attr())[kStaticInputShapesAttr] = shapes;
+      ++num_annotated;
+    }
+  }
+  VLOG(1) << "Annotated " << num_annotated << " nodes with static shapes";
+  return Status::OK();
+}
+
+void StaticShapeAnnotator::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                    const GraphDef& optimize_output,
+                                    double result) {
+  // Takes no feedback.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
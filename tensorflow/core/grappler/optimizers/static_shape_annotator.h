@@ -0,0 +1,49 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_STATIC_SHAPE_ANNOTATOR_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_STATIC_SHAPE_ANNOTATOR_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Name of the attribute holding the statically inferred input shapes.
+constexpr char kStaticInputShapesAttr[] = "_static_input_shapes";
+
+// StaticShapeAnnotator records the input shapes that can be inferred
+// statically on the nodes whose kernels can use them to skip per-step shape
+// logic, e.g. the broadcasting of coefficient-wise binary ops. The kernels
+// check the actual shapes against the annotation, so a stale annotation only
+// disables the shortcut.
+class StaticShapeAnnotator : public GraphOptimizer {
+ public:
+  StaticShapeAnnotator() {}
+  ~StaticShapeAnnotator() override {}
+
+  string name() const override { return "static_shape_annotator"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_STATIC_SHAPE_ANNOTATOR_H_
@@ -0,0 +1,113 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/static_shape_annotator.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class StaticShapeAnnotatorTest : public GrapplerTest {};
+
+TEST_F(StaticShapeAnnotatorTest, AnnotateFullyDefinedShapes) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({2, 3}));
+  Output y = ops::Placeholder(s.WithOpName("y"), DT_FLOAT,
+                              ops::Placeholder::Shape({3}));
+  Output add = ops::Add(s.WithOpName("add"), x, y);
+  Output neg = ops::Neg(s.WithOpName("neg"), add);
+  GrapplerItem item;
+  item.fetch = {"neg"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  StaticShapeAnnotator optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "add") {
+      ASSERT_EQ(1, node.attr().count(kStaticInputShapesAttr));
+      const auto& shapes = node.attr().at(kStaticInputShapesAttr).list();
+      ASSERT_EQ(2, shapes.shape_size());
+      EXPECT_EQ("[2,3]", PartialTensorShape(shapes.shape(0)).DebugString());
+      EXPECT_EQ("[3]", PartialTensorShape(shapes.shape(1)).DebugString());
+    } else {
+      // Only the broadcasting binary ops are annotated.
+      EXPECT_EQ(0, node.attr().count(kStaticInputShapesAttr)) << node.name();
+    }
+  }
+}
+
+TEST_F(StaticShapeAnnotatorTest, SkipPartiallyKnownShapes) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 3}));
+  Output y = ops::Placeholder(s.WithOpName("y"), DT_FLOAT,
+                              ops::Placeholder::Shape({3}));
+  Output mul = ops::Mul(s.WithOpName("mul"), x, y);
+  GrapplerItem item;
+  item.fetch = {"mul"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  // An annotation left by a previous run must not survive.
+  AttrValue stale;
+  *stale.mutable_list()->add_shape() = TensorShape({2, 3}).AsProto();
+  *stale.mutable_list()->add_shape() = TensorShape({3}).AsProto();
+  for (NodeDef& node : *item.graph.mutable_node()) {
+    if (node.name() == "mul") {
+      (*node.mutable_attr())[kStaticInputShapesAttr] = stale;
+    }
+  }
+
+  StaticShapeAnnotator optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  for (const NodeDef& node : output.node()) {
+    EXPECT_EQ(0, node.attr().count(kStaticInputShapesAttr)) << node.name();
+  }
+}
+
+TEST_F(StaticShapeAnnotatorTest, SameResults) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Const(s.WithOpName("x"), {1.0f, 2.0f, 3.0f, 4.0f}, {2, 2});
+  Output y = ops::Const(s.WithOpName("y"), {10.0f, 20.0f}, {2});
+  Output sub = ops::Sub(s.WithOpName("sub"), x, y);
+  GrapplerItem item;
+  item.fetch = {"sub"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  StaticShapeAnnotator optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(1, tensors.size());
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -87,6 +87,31 @@ class CollectiveReduceOpKernel : public CollectiveOpKernel {
                     "final_op must be one of {\"Id\", \"Div\"} but got ",
                     final_op_name));
     OP_REQUIRES_OK(c, c->GetAttr("T", &col_params_.instance.data_type));
+    string compression;
+    OP_REQUIRES_OK(c, c->GetAttr("compression", &compression));
+    if (compression == "fp16") {
+      col_params_.instance.compression = FP16_COMPRESSION;
+    } else if (compression == "bfloat16") {
+      col_params_.instance.compression = BFLOAT16_COMPRESSION;
+    } else if (compression == "int8") {
+      col_params_.instance.compression = INT8_COMPRESSION;
+    } else if (compression == "top_k") {
+      col_params_.instance.compression = TOP_K_COMPRESSION;
+    }
+    OP_REQUIRES_OK(c, c->GetAttr("top_k_fraction",
+                                 &col_params_.instance.top_k_fraction));
+    OP_REQUIRES(c,
+                col_params_.instance.top_k_fraction > 0 &&
+                    col_params_.instance.top_k_fraction <= 1,
+                errors::InvalidArgument("top_k_fraction must be in (0, 1] ",
+                                        "but got ",
+                                        col_params_.instance.top_k_fraction));
+    OP_REQUIRES(c,
+                col_params_.instance.compression == NO_COMPRESSION ||
+                    col_params_.instance.data_type == DT_FLOAT,
+                errors::InvalidArgument("compression ", compression,
+                                        " requires T to be float"));
+    col_params_.residual = &residual_;
 
     const NodeDef& real_node = c->def();
     col_params_.name = strings::StrCat(real_node.name(), ": Reduce(",
@@ -132,7 +157,21 @@ class CollectiveReduceOpKernel : public CollectiveOpKernel {
             "Failed to get CollectiveExecutor from OpKernelContext for Op ",
             col_params_.name),
         done);
+    if (col_params_.group.group_size >
+        col_params_.instance.device_names.size()) {
+      // Record the shape so that the param resolver can choose a reduction
+      // algorithm suited to the size of the tensor.
+      col_params_.instance.shape = c->input(0).shape();
+    }
     if (!CanProceedWithCompute(c, col_exec, done)) return;
+    if (col_params_.instance.compression != NO_COMPRESSION &&
+        (!residual_.IsInitialized() ||
+         residual_.shape() != c->input(0).shape())) {
+      // The compression error of the previous executions is fed back into
+      // the next one, starting from zero.
+      residual_ = Tensor(DT_FLOAT, c->input(0).shape());
+      residual_.flat<float>().setZero();
+    }
     // Allocate the output tensor, trying to reuse the input.
     Tensor* output = nullptr;
     OP_REQUIRES_OK_ASYNC(c,
@@ -148,6 +187,9 @@ class CollectiveReduceOpKernel : public CollectiveOpKernel {
   }
 
  private:
+  // Error-feedback state of a compressed reduction, persisting across steps.
+  Tensor residual_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(CollectiveReduceOpKernel);
 };
 
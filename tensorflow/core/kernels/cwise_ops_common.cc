@@ -23,6 +23,27 @@ BinaryOpShared::BinaryOpShared(OpKernelConstruction* ctx, DataType out,
 #ifndef INTEL_MKL
   OP_REQUIRES_OK(ctx, ctx->MatchSignature({in, in}, {out}));
 #endif
+  if (HasNodeAttr(def(), "_static_input_shapes")) {
+    std::vector<TensorShape> shapes;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("_static_input_shapes", &shapes));
+    if (shapes.size() == 2) {
+      static_broadcast_.reset(new StaticBroadcast(shapes[0], shapes[1]));
+      if (!static_broadcast_->bcast.IsValid()) {
+        // Leave it to Compute() to report the incompatible shapes.
+        static_broadcast_.reset();
+      }
+    }
+  }
+}
+
+BinaryOpShared::StaticBroadcast::StaticBroadcast(const TensorShape& in0_shape,
+                                                 const TensorShape& in1_shape)
+    : in0_shape(in0_shape),
+      in1_shape(in1_shape),
+      bcast(BCast::FromShape(in0_shape), BCast::FromShape(in1_shape)) {
+  if (bcast.IsValid()) {
+    output_shape = BCast::ToShape(bcast.output_shape());
+  }
 }
 
 void BinaryOpShared::SetUnimplementedError(OpKernelContext* ctx) {
@@ -52,24 +73,41 @@ void BinaryOpShared::SetComputeError(OpKernelContext* ctx) {
   }
 }
 
-BinaryOpShared::BinaryOpState::BinaryOpState(OpKernelContext* ctx)
-    : in0(ctx->input(0)),
-      in1(ctx->input(1)),
-      bcast(BCast::FromShape(in0.shape()), BCast::FromShape(in1.shape())) {
-  if (!bcast.IsValid()) {
+BinaryOpShared::BinaryOpState::BinaryOpState(
+    OpKernelContext* ctx, const StaticBroadcast* static_broadcast)
+    : in0(ctx->input(0)), in1(ctx->input(1)) {
+  // The static shapes are only a hint: fall back to computing the broadcast
+  // if the actual input shapes differ.
+  if (static_broadcast != nullptr &&
+      in0.shape() == static_broadcast->in0_shape &&
+      in1.shape() == static_broadcast->in1_shape) {
+    bcast = &static_broadcast->bcast;
+    out_num_elements = static_broadcast->output_shape.num_elements();
+    in0_num_elements = in0.NumElements();
+    in1_num_elements = in1.NumElements();
+    OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                            {0, 1}, 0, static_broadcast->output_shape, &out));
+    ndims = static_cast<int>(bcast->x_reshape().size());
+    return;
+  }
+
+  dynamic_bcast.emplace(BCast::FromShape(in0.shape()),
+                        BCast::FromShape(in1.shape()));
+  bcast = &*dynamic_bcast;
+  if (!bcast->IsValid()) {
     ctx->SetStatus(errors::InvalidArgument(
         "Incompatible shapes: ", in0.shape().DebugString(), " vs. ",
         in1.shape().DebugString()));
     return;
   }
-  const TensorShape output_shape = BCast::ToShape(bcast.output_shape());
+  const TensorShape output_shape = BCast::ToShape(bcast->output_shape());
   out_num_elements = output_shape.num_elements();
   in0_num_elements = in0.NumElements();
   in1_num_elements = in1.NumElements();
   OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
                           {0, 1}, 0, output_shape, &out));
 
-  ndims = static_cast<int>(bcast.x_reshape().size());
+  ndims = static_cast<int>(bcast->x_reshape().size());
 }
 
 }  // namespace tensorflow
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
+#include "tensorflow/core/lib/gtl/optional.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/bcast.h"
 
@@ -49,19 +50,34 @@ class BinaryOpShared : public OpKernel {
   explicit BinaryOpShared(OpKernelConstruction* ctx, DataType out, DataType in);
 
  protected:
+  // The broadcast for the input shapes that were inferred statically and
+  // recorded in the "_static_input_shapes" attribute of the node (see
+  // grappler/optimizers/static_shape_annotator.h). It is computed once when
+  // the kernel is constructed.
+  struct StaticBroadcast {
+    StaticBroadcast(const TensorShape& in0_shape, const TensorShape& in1_shape);
+
+    const TensorShape in0_shape;
+    const TensorShape in1_shape;
+    const BCast bcast;
+    TensorShape output_shape;
+  };
+
   struct BinaryOpState {
     // Sets up bcast with the shape of in0 and in1, ensures that the bcast
     // is valid, and if so, set out, either by allocating a new buffer using
     // ctx->output(...) or by creating an alias for an owned input buffer for
-    // in-place computation.
+    // in-place computation. If the input shapes match those of
+    // static_broadcast, its precomputed bcast is used instead.
     // Caller must check ctx->status() upon return for non-ok status.
     // If ctx->status().ok() is true, then out is guaranteed to be allocated.
-    BinaryOpState(OpKernelContext* ctx);
+    BinaryOpState(OpKernelContext* ctx,
+                  const StaticBroadcast* static_broadcast = nullptr);
 
     const Tensor& in0;
     const Tensor& in1;
 
-    BCast bcast;
+    const BCast* bcast = nullptr;
     Tensor* out = nullptr;
     int64 out_num_elements;
 
@@ -69,10 +85,16 @@ class BinaryOpShared : public OpKernel {
     int64 in1_num_elements;
 
     int ndims;
+
+   private:
+    gtl::optional<BCast> dynamic_bcast;
   };
 
   void SetUnimplementedError(OpKernelContext* ctx);
   void SetComputeError(OpKernelContext* ctx);
+
+  // Null unless the node carries valid static input shapes.
+  std::unique_ptr<StaticBroadcast> static_broadcast_;
 };
 
 // Coefficient-wise binary operations:
@@ -90,10 +112,10 @@ class BinaryOp : public BinaryOpShared {
 
   void Compute(OpKernelContext* ctx) override {
     // 'state': Shared helper not dependent on T to reduce code size
-    BinaryOpState state(ctx);
+    BinaryOpState state(ctx, static_broadcast_.get());
     if (!ctx->status().ok()) return;
     Tensor* out = state.out;
-    BCast* bcast = &state.bcast;
+    const BCast* bcast = state.bcast;
     auto& in0 = state.in0;
     auto& in1 = state.in1;
     if (state.out_num_elements == 0) {
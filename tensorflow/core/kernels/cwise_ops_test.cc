@@ -14,9 +14,15 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/util/tensor_format.h"
@@ -360,5 +366,52 @@ BM_BCAST_ADD_CROSS_CR_ALL(sycl);
 #undef BM_BCAST_ADD_CROSS_CR_ALL
 #undef BM_BCAST_ADD_CROSS_CR
 
+class BinaryOpStaticShapesTest : public OpsTestBase {
+ protected:
+  void MakeAddOp(const std::vector<TensorShape>& static_shapes) {
+    AttrValue shapes;
+    SetAttrValue(static_shapes, &shapes);
+    TF_ASSERT_OK(NodeDefBuilder("add", "Add")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("_static_input_shapes", shapes)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(BinaryOpStaticShapesTest, MatchingShapes) {
+  MakeAddOp({TensorShape({2, 3}), TensorShape({3})});
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({3}), {10, 20, 30});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&expected, {11, 22, 33, 14, 25, 36});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(BinaryOpStaticShapesTest, StaleShapes) {
+  // The annotated shapes do not match the inputs: the broadcast is computed
+  // from the actual shapes.
+  MakeAddOp({TensorShape({2, 3}), TensorShape({3})});
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<float>(TensorShape({2}), {10, 20});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {11, 21, 12, 22});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(BinaryOpStaticShapesTest, IncompatibleShapes) {
+  MakeAddOp({TensorShape({2, 3}), TensorShape({3})});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({3}), {10, 20, 30});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(StringPiece(s.ToString()).contains("Incompatible shapes"))
+      << s;
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,247 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/common_runtime/graph_runner.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph_constructor.h"
+#include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
+#include "tensorflow/core/kernels/data/dataset.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class OptimizeDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit OptimizeDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx),
+        graph_def_version_(ctx->graph_def_version()) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    const Tensor* optimizations_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("optimizations", &optimizations_tensor));
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsVector(optimizations_tensor->shape()),
+        errors::InvalidArgument("`optimizations` must be a vector, got shape ",
+                                optimizations_tensor->shape().DebugString()));
+    std::vector<string> optimizations;
+    for (int i = 0; i < optimizations_tensor->NumElements(); ++i) {
+      optimizations.push_back(optimizations_tensor->flat<string>()(i));
+    }
+    Dataset* dataset =
+        new Dataset(ctx, input, optimizations, output_types_, output_shapes_);
+    Status s = dataset->Optimize(ctx, graph_def_version_);
+    if (!s.ok()) {
+      dataset->Unref();
+    }
+    OP_REQUIRES_OK(ctx, s);
+    *output = dataset;
+  }
+
+ private:
+  class Dataset : public GraphDatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const DatasetBase* input,
+            const std::vector<string>& optimizations,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : GraphDatasetBase(ctx),
+          input_(input),
+          optimizations_(optimizations),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {
+      input_->Ref();
+    }
+
+    ~Dataset() override {
+      input_->Unref();
+      if (optimized_input_) {
+        optimized_input_->Unref();
+      }
+    }
+
+    std::unique_ptr<IteratorBase> MakeIterator(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::Optimize")}));
+    }
+
+    // Serializes the input dataset, rewrites the resulting graph with the
+    // requested Grappler optimizations and instantiates the optimized dataset.
+    Status Optimize(OpKernelContext* ctx, int graph_def_version) {
+      GraphDefBuilder b;
+      DatasetGraphDefBuilder db(&b);
+      Node* input_node = nullptr;
+      TF_RETURN_IF_ERROR(db.AddParentDataset(ctx, input_, &input_node));
+      // The dataset is fetched through an Identity node, so that optimizations
+      // are free to replace the last transformation of the input.
+      Node* sink = ops::UnaryOp("Identity", input_node,
+                                b.opts().WithName("OptimizeDataset/sink"));
+      GraphDef graph_def;
+      TF_RETURN_IF_ERROR(b.ToGraphDef(&graph_def));
+      graph_def.mutable_versions()->set_producer(graph_def_version);
+
+      TF_RETURN_IF_ERROR(ApplyOptimizations(ctx, sink->name(), &graph_def));
+
+      // The optimized graph may call functions created by the optimizations,
+      // so it runs with (and its iterators use) a runtime that knows about
+      // them.
+      std::unique_ptr<FunctionLibraryDefinition> flib_def;
+      TF_RETURN_IF_ERROR(
+          ctx->function_library()->Clone(&flib_def, &pflr_, &lib_));
+      TF_RETURN_IF_ERROR(flib_def->AddLibrary(graph_def.library()));
+      flib_def_ = std::move(flib_def);
+
+      Graph graph(OpRegistry::Global());
+      TF_RETURN_IF_ERROR(ImportGraphDef({}, graph_def, &graph, nullptr));
+      std::vector<Tensor> outputs;
+      GraphRunner graph_runner(ctx->env());
+      TF_RETURN_IF_ERROR(
+          graph_runner.Run(&graph, lib_, {}, {sink->name()}, &outputs));
+      TF_RETURN_IF_ERROR(
+          GetDatasetFromVariantTensor(outputs[0], &optimized_input_));
+      optimized_input_->Ref();
+      return Status::OK();
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() override { return "OptimizeDatasetOp::Dataset"; }
+
+   protected:
+    Status AsGraphDefInternal(OpKernelContext* ctx, DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      // The unoptimized input is serialized: the optimizations are applied
+      // again when the graph is restored.
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddParentDataset(ctx, input_, &input_graph_node));
+      Node* optimizations_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(optimizations_, &optimizations_node));
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this, {input_graph_node, optimizations_node}, output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            input_impl_(
+                params.dataset->optimized_input_->MakeIterator(params.prefix)) {
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        IteratorContext optimized_ctx(dataset()->OptimizedContext(ctx));
+        return input_impl_->GetNext(&optimized_ctx, out_tensors,
+                                    end_of_sequence);
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        TF_RETURN_IF_ERROR(SaveParent(writer, input_impl_));
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        IteratorContext optimized_ctx(dataset()->OptimizedContext(ctx));
+        TF_RETURN_IF_ERROR(RestoreParent(&optimized_ctx, reader, input_impl_));
+        return Status::OK();
+      }
+
+     private:
+      const std::unique_ptr<IteratorBase> input_impl_;
+    };
+
+    Status ApplyOptimizations(OpKernelContext* ctx, const string& fetch,
+                              GraphDef* graph_def) {
+      grappler::GrapplerItem item;
+      item.id = "tf_data_graph";
+      item.graph = *graph_def;
+      item.fetch.push_back(fetch);
+
+      RewriterConfig rewriter_config;
+      for (const string& optimization : optimizations_) {
+        rewriter_config.add_optimizers(optimization);
+      }
+      rewriter_config.set_meta_optimizer_iterations(RewriterConfig::ONE);
+
+      GraphDef optimized_graph;
+      Status s = grappler::RunMetaOptimizer(item, rewriter_config, ctx->device(),
+                                            nullptr, &optimized_graph);
+      if (!s.ok()) {
+        // The input pipeline still works without the optimizations.
+        LOG(WARNING) << "Failed to optimize the input pipeline: " << s;
+        return Status::OK();
+      }
+      graph_def->Swap(&optimized_graph);
+      return Status::OK();
+    }
+
+    // Returns a context whose function calls are dispatched to the runtime
+    // that knows about the functions created by the optimizations.
+    IteratorContext::Params OptimizedContext(IteratorContext* ctx) const {
+      IteratorContext::Params params;
+      params.env = ctx->env();
+      params.runner = *(ctx->runner());
+      params.stats_aggregator_getter = ctx->stats_aggregator_getter();
+      params.lib = lib_;
+      params.function_library = flib_def_;
+      params.allocator_getter = ctx->allocator_getter();
+      return params;
+    }
+
+    const DatasetBase* input_;
+    DatasetBase* optimized_input_ = nullptr;
+    const std::vector<string> optimizations_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+    std::shared_ptr<FunctionLibraryDefinition> flib_def_;
+    std::unique_ptr<ProcessFunctionLibraryRuntime> pflr_;
+    FunctionLibraryRuntime* lib_ = nullptr;
+  };
+
+  const int graph_def_version_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("OptimizeDataset").Device(DEVICE_CPU),
+                        OptimizeDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
@@ -63,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_op_helpers.h"
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -653,6 +654,200 @@ class ResourceScatterUpdateOp : public OpKernel {
   }
 };
 
+// Adds `updates` (num_indices x row size) to the rows of `params` named by
+// `indices`.
+template <typename T, typename Index>
+Status ScatterAddRows(OpKernelContext* c, typename TTypes<T>::Matrix params,
+                      const Tensor& indices, const Tensor& updates) {
+  const Index N = static_cast<Index>(indices.NumElements());
+  auto indices_flat = indices.flat<Index>();
+  auto updates_flat = updates.shaped<T, 2>({N, updates.NumElements() / N});
+  functor::ScatterFunctor<CPUDevice, T, Index, scatter_op::UpdateOp::ADD>
+      functor;
+  const Index bad_i = functor(c, c->eigen_device<CPUDevice>(), params,
+                              updates_flat, indices_flat);
+  if (bad_i >= 0) {
+    return errors::InvalidArgument(
+        "indices", SliceDebugString(indices.shape(), bad_i), " = ",
+        indices_flat(bad_i), " is not in [0, ", params.dimension(0), ")");
+  }
+  return Status::OK();
+}
+
+template <typename Index>
+Status CheckScatterAddIndices(const Tensor& indices, int64 limit) {
+  auto indices_flat = indices.flat<Index>();
+  for (int64 i = 0; i < indices_flat.size(); ++i) {
+    const Index index = internal::SubtleMustCopy(indices_flat(i));
+    if (!FastBoundsCheck(index, limit)) {
+      return errors::InvalidArgument(
+          "indices", SliceDebugString(indices.shape(), i), " = ", index,
+          " is not in [0, ", limit, ")");
+    }
+  }
+  return Status::OK();
+}
+
+// Applies `adds` to `params` and records the outcome of each.  When there is
+// more than one, the rows they update are first summed in a scratch tensor,
+// so that a row updated by several of them is read and written once.
+template <typename T>
+void ApplyScatterAdds(OpKernelContext* c, Tensor* params,
+                      const std::vector<PendingScatterAdd*>& adds) {
+  Status s = PrepareToUpdateVariable<CPUDevice, T>(c, params);
+  auto params_flat = params->flat_outer_dims<T>();
+  const int64 limit = params_flat.dimension(0);
+  const int64 row_size = params_flat.dimension(1);
+  if (s.ok() && adds.size() == 1) {
+    PendingScatterAdd* add = adds[0];
+    if (add->indices->dtype() == DT_INT64) {
+      add->status = ScatterAddRows<T, int64>(c, params_flat, *add->indices,
+                                             *add->updates);
+      add->done = true;
+      return;
+    }
+    if (limit <= std::numeric_limits<int32>::max()) {
+      add->status = ScatterAddRows<T, int32>(c, params_flat, *add->indices,
+                                             *add->updates);
+      add->done = true;
+      return;
+    }
+  }
+
+  // Assigns a row of the scratch tensor to every row of `params` updated.
+  gtl::FlatMap<int64, int64> slots;
+  std::vector<int64> rows;
+  for (PendingScatterAdd* add : adds) {
+    if (!s.ok()) {
+      add->status = s;
+      continue;
+    }
+    const Tensor& indices = *add->indices;
+    const int64 N = indices.NumElements();
+    if (add->updates->NumElements() != N * row_size) {
+      add->status = errors::InvalidArgument(
+          "shape of indices (", indices.shape().DebugString(),
+          ") is not compatible with the shape of updates (",
+          add->updates->shape().DebugString(), ")");
+      continue;
+    }
+    add->status = indices.dtype() == DT_INT32
+                      ? CheckScatterAddIndices<int32>(indices, limit)
+                      : CheckScatterAddIndices<int64>(indices, limit);
+    if (!add->status.ok()) continue;
+    for (int64 i = 0; i < N; ++i) {
+      const int64 index = indices.dtype() == DT_INT32
+                              ? indices.flat<int32>()(i)
+                              : indices.flat<int64>()(i);
+      if (slots.insert({index, rows.size()}).second) rows.push_back(index);
+    }
+  }
+
+  Tensor merged;
+  Tensor merged_indices;
+  if (s.ok() && !rows.empty()) {
+    const int64 num_rows = rows.size();
+    s = c->allocate_temp(DataTypeToEnum<T>::v(),
+                         TensorShape({num_rows, row_size}), &merged);
+    if (s.ok()) {
+      s = c->allocate_temp(DT_INT64, TensorShape({num_rows}),
+                           &merged_indices);
+    }
+  }
+  if (s.ok() && !rows.empty()) {
+    auto merged_flat = merged.matrix<T>();
+    merged_flat.setZero();
+    for (PendingScatterAdd* add : adds) {
+      if (!add->status.ok()) continue;
+      const Tensor& indices = *add->indices;
+      const int64 N = indices.NumElements();
+      auto updates_flat = add->updates->shaped<T, 2>({N, row_size});
+      for (int64 i = 0; i < N; ++i) {
+        const int64 index = indices.dtype() == DT_INT32
+                                ? indices.flat<int32>()(i)
+                                : indices.flat<int64>()(i);
+        merged_flat.template chip<0>(slots[index]) +=
+            updates_flat.template chip<0>(i);
+      }
+    }
+    std::copy(rows.begin(), rows.end(), merged_indices.flat<int64>().data());
+    s = ScatterAddRows<T, int64>(c, params_flat, merged_indices, merged);
+  }
+  for (PendingScatterAdd* add : adds) {
+    if (add->status.ok()) add->status = s;
+    add->done = true;
+  }
+}
+
+// ResourceScatterAdd on CPU.  A parameter server holding an embedding gets
+// sparse gradients from many workers at once; rather than serializing them
+// on the lock of the variable, the waiter that gets the lock applies every
+// add queued meanwhile in one pass, and the others return.
+template <typename T, typename Index>
+class ResourceScatterAddOp : public OpKernel {
+ public:
+  explicit ResourceScatterAddOp(OpKernelConstruction* c) : OpKernel(c) {}
+
+  void Compute(OpKernelContext* c) override {
+    Var* v = nullptr;
+    OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
+    core::ScopedUnref unref_v(v);
+    const Tensor& indices = c->input(1);
+    const Tensor& updates = c->input(2);
+
+    // Check that we have enough index space
+    const int64 N_big = indices.NumElements();
+    OP_REQUIRES(
+        c, N_big <= std::numeric_limits<Index>::max(),
+        errors::InvalidArgument("indices has too many elements for ",
+                                DataTypeString(DataTypeToEnum<Index>::v()),
+                                " indexing: ", N_big, " > ",
+                                std::numeric_limits<Index>::max()));
+    if (N_big == 0 || TensorShapeUtils::IsScalar(updates.shape())) {
+      mutex_lock ml(*v->mu());
+      Tensor* params = v->tensor();
+      OP_REQUIRES_OK(c, PrepareToUpdateVariable<CPUDevice, T>(c, params));
+      if (N_big == 0) return;
+      auto indices_flat = indices.flat<Index>();
+      functor::ScatterScalarFunctor<CPUDevice, T, Index,
+                                    scatter_op::UpdateOp::ADD>
+          functor;
+      const Index bad_i =
+          functor(c, c->eigen_device<CPUDevice>(), params->flat_outer_dims<T>(),
+                  updates.scalar<T>(), indices_flat);
+      OP_REQUIRES(c, bad_i < 0,
+                  errors::InvalidArgument(
+                      "indices", SliceDebugString(indices.shape(), bad_i),
+                      " = ", indices_flat(bad_i), " is not in [0, ",
+                      params->dim_size(0), ")"));
+      return;
+    }
+    OP_REQUIRES(c, updates.NumElements() % N_big == 0,
+                errors::InvalidArgument(
+                    "shape of indices (", indices.shape().DebugString(),
+                    ") is not compatible with the shape of updates (",
+                    updates.shape().DebugString(), ")"));
+
+    PendingScatterAdd add;
+    add.indices = &indices;
+    add.updates = &updates;
+    {
+      mutex_lock l(*v->pending_mu());
+      v->pending_scatter_adds()->push_back(&add);
+    }
+    mutex_lock ml(*v->mu());
+    std::vector<PendingScatterAdd*> adds;
+    if (!add.done) {
+      {
+        mutex_lock l(*v->pending_mu());
+        adds.swap(*v->pending_scatter_adds());
+      }
+      ApplyScatterAdds<T>(c, v->tensor(), adds);
+    }
+    OP_REQUIRES_OK(c, add.status);
+  }
+};
+
 #define REGISTER_SCATTER_KERNEL_INDEX(type, index_type, dev, name, op) \
   REGISTER_KERNEL_BUILDER(                                             \
       Name(name)                                                       \
@@ -666,9 +861,7 @@ class ResourceScatterUpdateOp : public OpKernel {
   REGISTER_SCATTER_KERNEL_INDEX(type, int32, dev, name, op); \
   REGISTER_SCATTER_KERNEL_INDEX(type, int64, dev, name, op);
 
-#define REGISTER_SCATTER_ARITHMETIC(type, dev)                \
-  REGISTER_SCATTER_KERNEL(type, dev, "ResourceScatterAdd",    \
-                          scatter_op::UpdateOp::ADD);         \
+#define REGISTER_SCATTER_ARITHMETIC_NO_ADD(type, dev)         \
   REGISTER_SCATTER_KERNEL(type, dev, "ResourceScatterSub",    \
                           scatter_op::UpdateOp::SUB);         \
   REGISTER_SCATTER_KERNEL(type, dev, "ResourceScatterMul",    \
@@ -677,6 +870,10 @@ class ResourceScatterUpdateOp : public OpKernel {
                           scatter_op::UpdateOp::DIV);         \
   REGISTER_SCATTER_KERNEL(type, dev, "ResourceScatterUpdate", \
                           scatter_op::UpdateOp::ASSIGN);
+#define REGISTER_SCATTER_ARITHMETIC(type, dev)             \
+  REGISTER_SCATTER_KERNEL(type, dev, "ResourceScatterAdd", \
+                          scatter_op::UpdateOp::ADD);      \
+  REGISTER_SCATTER_ARITHMETIC_NO_ADD(type, dev);
 #define REGISTER_SCATTER_MINMAX(type, dev)                 \
   REGISTER_SCATTER_KERNEL(type, dev, "ResourceScatterMin", \
                           scatter_op::UpdateOp::MIN);      \
@@ -684,8 +881,17 @@ class ResourceScatterUpdateOp : public OpKernel {
                           scatter_op::UpdateOp::MAX);
 
 // Registers CPU kernels.
-#define REGISTER_SCATTER_ARITHMETIC_CPU(type) \
-  REGISTER_SCATTER_ARITHMETIC(type, CPU);
+#define REGISTER_SCATTER_ADD_CPU_INDEX(type, index_type)                 \
+  REGISTER_KERNEL_BUILDER(Name("ResourceScatterAdd")                     \
+                              .Device(DEVICE_CPU)                        \
+                              .HostMemory("resource")                    \
+                              .TypeConstraint<type>("dtype")             \
+                              .TypeConstraint<index_type>("Tindices"),   \
+                          ResourceScatterAddOp<type, index_type>)
+#define REGISTER_SCATTER_ARITHMETIC_CPU(type)  \
+  REGISTER_SCATTER_ADD_CPU_INDEX(type, int32); \
+  REGISTER_SCATTER_ADD_CPU_INDEX(type, int64); \
+  REGISTER_SCATTER_ARITHMETIC_NO_ADD(type, CPU);
 #define REGISTER_SCATTER_MINMAX_CPU(type) REGISTER_SCATTER_MINMAX(type, CPU);
 
 TF_CALL_NUMBER_TYPES(REGISTER_SCATTER_ARITHMETIC_CPU);
@@ -727,7 +933,9 @@ REGISTER_KERNEL_BUILDER(Name("ResourceScatterUpdate")
 #endif  // GOOGLE_CUDA
 
 #undef REGISTER_SCATTER_ARITHMETIC
+#undef REGISTER_SCATTER_ARITHMETIC_NO_ADD
 #undef REGISTER_SCATTER_ARITHMETIC_CPU
+#undef REGISTER_SCATTER_ADD_CPU_INDEX
 #undef REGISTER_SCATTER_MINMAX
 #undef REGISTER_SCATTER_MINMAX_CPU
 #undef REGISTER_SCATTER_KERNEL
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_VARIABLE_OPS_H_
 #define TENSORFLOW_KERNELS_VARIABLE_OPS_H_
 
+#include <vector>
+
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -27,6 +29,18 @@ limitations under the License.
 
 namespace tensorflow {
 
+// A ResourceScatterAdd waiting for the lock of its variable.  Whichever
+// waiter gets the lock first applies all the pending adds at once, see
+// resource_variable_ops.cc.
+struct PendingScatterAdd {
+  const Tensor* indices = nullptr;
+  const Tensor* updates = nullptr;
+  // Set by the waiter that applied the add, while holding the lock of the
+  // variable.
+  bool done = false;
+  Status status;
+};
+
 // Resource stored by variables in the resource manager
 // (new, resource-style version).
 class Var : public ResourceBase {
@@ -40,6 +54,12 @@ class Var : public ResourceBase {
   mutex* mu() { return &mu_; }
   Tensor* tensor() { return &tensor_; }
 
+  // ResourceScatterAdd calls queued for mu().
+  mutex* pending_mu() { return &pending_mu_; }
+  std::vector<PendingScatterAdd*>* pending_scatter_adds() {
+    return &pending_scatter_adds_;
+  }
+
   string DebugString() override {
     return strings::StrCat(DataTypeString(tensor_.dtype()), "/",
                            tensor_.shape().DebugString());
@@ -57,6 +77,9 @@ class Var : public ResourceBase {
   mutex mu_;
   Tensor tensor_;
 
+  mutex pending_mu_;
+  std::vector<PendingScatterAdd*> pending_scatter_adds_;
+
   ~Var() override {}
 };
 
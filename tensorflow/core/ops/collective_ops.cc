@@ -28,6 +28,8 @@ REGISTER_OP("CollectiveReduce")
     .Attr("merge_op: {'Min', 'Max', 'Mul', 'Add'}")
     .Attr("final_op: {'Id', 'Div'}")
     .Attr("subdiv_offsets: list(int)")
+    .Attr("compression: {'none', 'fp16', 'bfloat16', 'int8', 'top_k'} = 'none'")
+    .Attr("top_k_fraction: float = 0.01")
     .SetIsStateful()
     .SetShapeFn(shape_inference::UnchangedShape);
 
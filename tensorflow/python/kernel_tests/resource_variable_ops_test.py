@@ -190,6 +190,45 @@ class ResourceVariableOpsTest(test_util.TensorFlowTestCase):
     read = resource_variable_ops.read_variable_op(handle, dtype=dtypes.int32)
     self.assertEqual(self.evaluate(read), [[3]])
 
+  def testScatterAddConcurrent(self):
+    with self.test_session() as sess:
+      handle = resource_variable_ops.var_handle_op(
+          dtype=dtypes.float32, shape=[4, 2])
+      sess.run(
+          resource_variable_ops.assign_variable_op(
+              handle, array_ops.zeros([4, 2], dtype=dtypes.float32)))
+      # Duplicate rows, within and across the concurrent updates.
+      adds = [
+          resource_variable_ops.resource_scatter_add(
+              handle, constant_op.constant([i % 4, 3, 3], dtype=dtypes.int64),
+              array_ops.ones([3, 2], dtype=dtypes.float32))
+          for i in range(32)
+      ]
+      bad_add = resource_variable_ops.resource_scatter_add(
+          handle, [4, 0], array_ops.ones([2, 2], dtype=dtypes.float32))
+
+      def scatter_add(op):
+        for _ in range(10):
+          sess.run(op)
+
+      def bad_scatter_add():
+        for _ in range(10):
+          with self.assertRaisesOpError(r"indices\[0\] = 4 is not in"):
+            sess.run(bad_add)
+
+      threads = [self.checkedThread(target=scatter_add, args=(op,))
+                 for op in adds]
+      threads.append(self.checkedThread(target=bad_scatter_add))
+      for t in threads:
+        t.start()
+      for t in threads:
+        t.join()
+      read = resource_variable_ops.read_variable_op(
+          handle, dtype=dtypes.float32)
+      self.assertAllEqual(
+          sess.run(read),
+          [[80, 80], [80, 80], [80, 80], [720, 720]])
+
   @test_util.run_in_graph_and_eager_modes()
   def testScatterSub(self):
     handle = resource_variable_ops.var_handle_op(
@@ -140,6 +140,11 @@ def _embedding_lookup_and_transform(params,
       #   We must flatten in this case because transform_fn expects a flat
       #   tensor of embeddings.
       flat_ids = array_ops.reshape(ids, [-1])
+      if np > 1:
+        # Ask each partition for every id once; the rows are copied back to
+        # the positions of the duplicates after the lookups. This also makes
+        # the gradients sent to the partitions have one row per id.
+        flat_ids, unique_idx = array_ops.unique(flat_ids)
       original_indices = math_ops.range(array_ops.size(flat_ids))
 
       # Create p_assignments and set new_ids depending on the strategy.
@@ -203,6 +208,8 @@ def _embedding_lookup_and_transform(params,
       # Stitch these back together
       ret = data_flow_ops.parallel_dynamic_stitch(
           pindices, partitioned_result, name=name)
+      if np > 1:
+        ret = array_ops.gather(ret, unique_idx)
 
       # Determine the static element shape.
       if transform_fn is None: